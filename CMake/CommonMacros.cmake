@@ -53,6 +53,13 @@ MACRO(SET_COMPILER_AND_LINKER_FLAGS)
 		# -std=c++11 -stdlib=libc++ 
 		SET(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -Wno-inconsistent-missing-override -Wunreachable-code-aggressive -Wunused")
 	ENDIF()
+
+	IF( ISEG_ENABLE_THREAD_SANITIZER AND NOT MSVC )
+		SET(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -fsanitize=thread -fno-omit-frame-pointer")
+		SET(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -fsanitize=thread -fno-omit-frame-pointer")
+		SET(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} -fsanitize=thread")
+		SET(CMAKE_SHARED_LINKER_FLAGS "${CMAKE_SHARED_LINKER_FLAGS} -fsanitize=thread")
+	ENDIF()
 ENDMACRO()
 
 MACRO(ADD_TESTSUITE project_name)
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace iseg {
+
+/** \brief Permutes the axes of a volume stored as an array of slices
+
+	Axis j of the permuted volume is axis order[j] of the input, e.g. {1, 0, 2} swaps x and y,
+	the same convention as used for the spacing and directions. The output is traversed in
+	blocks of a few slices of kBlockSize x kBlockSize voxels, such that the input and output
+	lines touched by a block stay in the cache, and the blocks are distributed over all cores.
+*/
+class AxisPermutation
+{
+public:
+	/// Edge of a block within a slice, and number of slices of a block
+	static unsigned const kBlockSize = 32;
+	static unsigned const kBlockSlices = 16;
+
+	using order_type = std::array<unsigned int, 3>;
+
+	/// Dimensions of the permuted volume
+	static std::array<unsigned, 3> Dims(unsigned width, unsigned height, unsigned nrslices, const order_type& order)
+	{
+		unsigned const dims[3] = {width, height, nrslices};
+		return {dims[order[0]], dims[order[1]], dims[order[2]]};
+	}
+
+	/** Writes the output slices [first, first + count) of the permuted volume to dst[0], ..., dst[count - 1]
+		\param src the nrslices input slices of width x height voxels
+	*/
+	template<typename T>
+	static void Permute(const T* const* src, unsigned width, unsigned height, unsigned nrslices, const order_type& order, T* const* dst, unsigned first, unsigned count)
+	{
+		unsigned const dims[3] = {width, height, nrslices};
+		auto const out_dims = Dims(width, height, nrslices, order);
+		// step in the input slice along the first output axis, if it is an axis within the slice
+		size_t const step = (order[0] == 0) ? 1 : static_cast<size_t>(width);
+
+		long long const nb0 = (out_dims[0] + kBlockSize - 1) / kBlockSize;
+		long long const nb1 = (out_dims[1] + kBlockSize - 1) / kBlockSize;
+		long long const nb2 = (count + kBlockSlices - 1) / kBlockSlices;
+		long long const nblocks = nb0 * nb1 * nb2;
+
+#pragma omp parallel for schedule(dynamic)
+		for (long long b = 0; b < nblocks; b++)
+		{
+			unsigned const i0_begin = static_cast<unsigned>(b % nb0) * kBlockSize;
+			unsigned const i1_begin = static_cast<unsigned>((b / nb0) % nb1) * kBlockSize;
+			unsigned const k_begin = static_cast<unsigned>(b / (nb0 * nb1)) * kBlockSlices;
+			unsigned const i0_end = std::min(i0_begin + kBlockSize, out_dims[0]);
+			unsigned const i1_end = std::min(i1_begin + kBlockSize, out_dims[1]);
+			unsigned const k_end = std::min(k_begin + kBlockSlices, count);
+
+			for (unsigned k = k_begin; k < k_end; k++)
+			{
+				for (unsigned i1 = i1_begin; i1 < i1_end; i1++)
+				{
+					unsigned c[3];
+					c[order[0]] = i0_begin;
+					c[order[1]] = i1;
+					c[order[2]] = first + k;
+
+					T* out = dst[k] + static_cast<size_t>(i1) * out_dims[0];
+					size_t const offset = c[0] + static_cast<size_t>(c[1]) * dims[0];
+					if (order[0] == 2)
+					{
+						// consecutive output voxels come from consecutive slices
+						for (unsigned i0 = i0_begin; i0 < i0_end; i0++)
+						{
+							out[i0] = src[i0][offset];
+						}
+					}
+					else
+					{
+						const T* in = src[c[2]] + offset;
+						for (unsigned i0 = i0_begin; i0 < i0_end; i0++, in += step)
+						{
+							out[i0] = *in;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/// Writes all slices of the permuted volume
+	template<typename T>
+	static void Permute(const T* const* src, unsigned width, unsigned height, unsigned nrslices, const order_type& order, T* const* dst)
+	{
+		Permute(src, width, height, nrslices, order, dst, 0, Dims(width, height, nrslices, order)[2]);
+	}
+};
+
+} // namespace iseg
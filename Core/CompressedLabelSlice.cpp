@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include "Precompiled.h"
+
+#include "CompressedLabelSlice.h"
+
+#include <algorithm>
+
+namespace iseg {
+
+namespace {
+
+std::uint8_t IndexBits(size_t palette_size)
+{
+	if (palette_size <= 2)
+		return 1;
+	if (palette_size <= 4)
+		return 2;
+	if (palette_size <= 16)
+		return 4;
+	return 8;
+}
+
+} // namespace
+
+void CompressedLabelSlice::Compress(const tissues_size_t* labels, unsigned width, unsigned height)
+{
+	m_Width = width;
+	m_Height = height;
+
+	unsigned const nx = (width + k_TileSize - 1) / k_TileSize;
+	unsigned const ny = (height + k_TileSize - 1) / k_TileSize;
+	m_Tiles.assign(static_cast<size_t>(nx) * ny, Tile());
+
+	for (unsigned ty = 0; ty < ny; ++ty)
+	{
+		for (unsigned tx = 0; tx < nx; ++tx)
+		{
+			unsigned const x0 = tx * k_TileSize;
+			unsigned const y0 = ty * k_TileSize;
+			EncodeTile(labels, x0, y0, std::min(k_TileSize, width - x0), std::min(k_TileSize, height - y0), m_Tiles[ty * nx + tx]);
+		}
+	}
+}
+
+void CompressedLabelSlice::Decompress(tissues_size_t* labels) const
+{
+	unsigned const nx = (m_Width + k_TileSize - 1) / k_TileSize;
+	for (size_t i = 0; i < m_Tiles.size(); ++i)
+	{
+		unsigned const x0 = static_cast<unsigned>(i % nx) * k_TileSize;
+		unsigned const y0 = static_cast<unsigned>(i / nx) * k_TileSize;
+		DecodeTile(m_Tiles[i], x0, y0, std::min(k_TileSize, m_Width - x0), std::min(k_TileSize, m_Height - y0), labels);
+	}
+}
+
+tissues_size_t CompressedLabelSlice::Value(unsigned x, unsigned y) const
+{
+	unsigned const nx = (m_Width + k_TileSize - 1) / k_TileSize;
+	unsigned const x0 = x / k_TileSize * k_TileSize;
+	unsigned const y0 = y / k_TileSize * k_TileSize;
+	const Tile& tile = m_Tiles[static_cast<size_t>(y / k_TileSize) * nx + x / k_TileSize];
+	// tiles are stored in row-major order
+	size_t const i = static_cast<size_t>(y - y0) * std::min(k_TileSize, m_Width - x0) + (x - x0);
+	switch (tile.m_Encoding)
+	{
+	case kPalette: {
+		unsigned const mask = (1u << tile.m_Bits) - 1;
+		size_t const bit = i * tile.m_Bits;
+		return tile.m_Values[(tile.m_Indices[bit / 8] >> (bit % 8)) & mask];
+	}
+	case kRunLength: {
+		size_t end = 0;
+		for (size_t run = 0; run < tile.m_Runs.size(); ++run)
+		{
+			end += tile.m_Runs[run];
+			if (i < end)
+				return tile.m_Values[run];
+		}
+		return tile.m_Values.back();
+	}
+	default:
+		return tile.m_Values.front();
+	}
+}
+
+void CompressedLabelSlice::Clear()
+{
+	m_Width = m_Height = 0;
+	m_Tiles.clear();
+	m_Tiles.shrink_to_fit();
+}
+
+size_t CompressedLabelSlice::MemoryUsage() const
+{
+	size_t bytes = sizeof(*this) + m_Tiles.capacity() * sizeof(Tile);
+	for (const auto& tile : m_Tiles)
+	{
+		bytes += tile.m_Values.capacity() * sizeof(tissues_size_t);
+		bytes += tile.m_Indices.capacity();
+		bytes += tile.m_Runs.capacity() * sizeof(std::uint16_t);
+	}
+	return bytes;
+}
+
+void CompressedLabelSlice::EncodeTile(const tissues_size_t* labels, unsigned x0, unsigned y0, unsigned tw, unsigned th, Tile& tile) const
+{
+	std::vector<tissues_size_t> values;
+	values.reserve(static_cast<size_t>(tw) * th);
+	for (unsigned y = y0; y < y0 + th; ++y)
+	{
+		const tissues_size_t* row = labels + static_cast<size_t>(y) * m_Width + x0;
+		values.insert(values.end(), row, row + tw);
+	}
+
+	// run-length encoding over the tile in row-major order
+	std::vector<tissues_size_t> run_values;
+	std::vector<std::uint16_t> runs;
+	for (size_t i = 0; i < values.size();)
+	{
+		size_t j = i + 1;
+		while (j < values.size() && values[j] == values[i])
+			++j;
+		run_values.push_back(values[i]);
+		runs.push_back(static_cast<std::uint16_t>(j - i));
+		i = j;
+	}
+
+	if (runs.size() == 1)
+	{
+		tile.m_Encoding = kUniform;
+		tile.m_Values.assign(1, values.front());
+		return;
+	}
+
+	std::vector<tissues_size_t> palette(values);
+	std::sort(palette.begin(), palette.end());
+	palette.erase(std::unique(palette.begin(), palette.end()), palette.end());
+
+	size_t const rle_bytes = runs.size() * (sizeof(tissues_size_t) + sizeof(std::uint16_t));
+	if (palette.size() <= 256)
+	{
+		std::uint8_t const bits = IndexBits(palette.size());
+		size_t const palette_bytes = palette.size() * sizeof(tissues_size_t) + (values.size() * bits + 7) / 8;
+		if (palette_bytes < rle_bytes)
+		{
+			tile.m_Encoding = kPalette;
+			tile.m_Bits = bits;
+			tile.m_Indices.assign((values.size() * bits + 7) / 8, 0);
+			for (size_t i = 0; i < values.size(); ++i)
+			{
+				auto const index = static_cast<unsigned>(std::lower_bound(palette.begin(), palette.end(), values[i]) - palette.begin());
+				size_t const bit = i * bits;
+				tile.m_Indices[bit / 8] |= static_cast<std::uint8_t>(index << (bit % 8));
+			}
+			tile.m_Values.swap(palette);
+			return;
+		}
+	}
+
+	tile.m_Encoding = kRunLength;
+	tile.m_Values.swap(run_values);
+	tile.m_Runs.swap(runs);
+}
+
+void CompressedLabelSlice::DecodeTile(const Tile& tile, unsigned x0, unsigned y0, unsigned tw, unsigned th, tissues_size_t* labels) const
+{
+	switch (tile.m_Encoding)
+	{
+	case kUniform:
+		for (unsigned y = y0; y < y0 + th; ++y)
+		{
+			tissues_size_t* row = labels + static_cast<size_t>(y) * m_Width + x0;
+			std::fill(row, row + tw, tile.m_Values.front());
+		}
+		break;
+	case kPalette: {
+		unsigned const mask = (1u << tile.m_Bits) - 1;
+		size_t bit = 0;
+		for (unsigned y = y0; y < y0 + th; ++y)
+		{
+			tissues_size_t* row = labels + static_cast<size_t>(y) * m_Width + x0;
+			for (unsigned x = 0; x < tw; ++x, bit += tile.m_Bits)
+			{
+				row[x] = tile.m_Values[(tile.m_Indices[bit / 8] >> (bit % 8)) & mask];
+			}
+		}
+		break;
+	}
+	case kRunLength: {
+		size_t run = 0;
+		unsigned remaining = tile.m_Runs.front();
+		for (unsigned y = y0; y < y0 + th; ++y)
+		{
+			tissues_size_t* row = labels + static_cast<size_t>(y) * m_Width + x0;
+			for (unsigned x = 0; x < tw;)
+			{
+				if (remaining == 0)
+					remaining = tile.m_Runs[++run];
+				unsigned const n = std::min(remaining, tw - x);
+				std::fill(row + x, row + x + n, tile.m_Values[run]);
+				x += n;
+				remaining -= n;
+			}
+		}
+		break;
+	}
+	}
+}
+
+} // namespace iseg
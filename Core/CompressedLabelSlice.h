@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include "iSegCore.h"
+
+#include "Data/Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace iseg {
+
+/** \brief Compressed copy of a tissue label slice
+
+	The slice is split into square tiles of k_TileSize x k_TileSize pixels. Each tile
+	is stored as a single value (uniform), as a palette with bit-packed indices
+	or as run-length encoded rows, whichever is smallest. Label fields consist
+	mostly of large uniform regions, i.e. most tiles reduce to a single value.
+*/
+class ISEG_CORE_API CompressedLabelSlice
+{
+public:
+	static const unsigned k_TileSize = 64;
+
+	enum eEncoding : std::uint8_t {
+		kUniform,
+		kPalette,
+		kRunLength
+	};
+
+	/// Replace the content by the compressed labels of a width x height slice
+	void Compress(const tissues_size_t* labels, unsigned width, unsigned height);
+	/// Write the labels into a buffer of Width() * Height() values
+	void Decompress(tissues_size_t* labels) const;
+	/// Label at (x, y), decoding only the tile which holds it
+	tissues_size_t Value(unsigned x, unsigned y) const;
+	void Clear();
+
+	bool Empty() const { return m_Tiles.empty(); }
+	unsigned Width() const { return m_Width; }
+	unsigned Height() const { return m_Height; }
+
+	/// Approximate memory used by the compressed slice in bytes
+	size_t MemoryUsage() const;
+
+private:
+	struct Tile
+	{
+		eEncoding m_Encoding = kUniform;
+		/// bits per palette index
+		std::uint8_t m_Bits = 0;
+		/// uniform value, palette or run values
+		std::vector<tissues_size_t> m_Values;
+		/// bit-packed palette indices
+		std::vector<std::uint8_t> m_Indices;
+		/// run lengths
+		std::vector<std::uint16_t> m_Runs;
+	};
+
+	void EncodeTile(const tissues_size_t* labels, unsigned x0, unsigned y0, unsigned tw, unsigned th, Tile& tile) const;
+	void DecodeTile(const Tile& tile, unsigned x0, unsigned y0, unsigned tw, unsigned th, tissues_size_t* labels) const;
+
+	unsigned m_Width = 0;
+	unsigned m_Height = 0;
+	std::vector<Tile> m_Tiles;
+};
+
+} // namespace iseg
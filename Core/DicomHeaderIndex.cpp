@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include "Precompiled.h"
+
+#include "DicomHeaderIndex.h"
+
+#include "Data/Logger.h"
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace iseg {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const char* const k_Magic = "iSeg DICOM index 1";
+
+std::uint32_t FloatBits(float f)
+{
+	std::uint32_t bits;
+	std::memcpy(&bits, &f, sizeof(bits));
+	return bits;
+}
+
+float BitsFloat(std::uint32_t bits)
+{
+	float f;
+	std::memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+} // namespace
+
+DicomHeaderIndex::DicomHeaderIndex(const std::string& directory)
+{
+	m_Directory = fs::absolute(directory).string();
+
+	if (!Read((fs::path(m_Directory) / SidecarName()).string()))
+	{
+		Read(FallbackFileName());
+	}
+}
+
+const char* DicomHeaderIndex::SidecarName()
+{
+	return ".iseg-dicom-index";
+}
+
+std::string DicomHeaderIndex::FallbackFileName() const
+{
+	std::ostringstream name;
+	name << "iseg-dicom-index-" << std::hex << std::hash<std::string>()(m_Directory);
+	boost::system::error_code ec;
+	return (fs::temp_directory_path(ec) / name.str()).string();
+}
+
+std::vector<DicomHeaderIndex::Header> DicomHeaderIndex::Lookup(const std::vector<std::string>& files, const parser_type& parse)
+{
+	int const n = static_cast<int>(files.size());
+	std::vector<Header> headers(n);
+	std::vector<Entry> stats(n);
+	// 0: not indexable, 1: parsed, 2: found in the index
+	std::vector<char> state(n, 0);
+
+	// the map is only read here, i.e. the files are checked and parsed concurrently
+#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < n; i++)
+	{
+		fs::path const path(files[i]);
+		boost::system::error_code ec_size, ec_time;
+		auto const size = fs::file_size(path, ec_size);
+		auto const time = fs::last_write_time(path, ec_time);
+		if (!ec_size && !ec_time)
+		{
+			stats[i].m_Size = static_cast<std::uint64_t>(size);
+			stats[i].m_Time = static_cast<std::int64_t>(time);
+			state[i] = 1;
+
+			auto found = m_Entries.find(path.filename().string());
+			if (found != m_Entries.end() && found->second.m_Size == stats[i].m_Size && found->second.m_Time == stats[i].m_Time)
+			{
+				headers[i] = found->second.m_Header;
+				state[i] = 2;
+				continue;
+			}
+		}
+		headers[i] = parse(files[i]);
+	}
+
+	for (int i = 0; i < n; i++)
+	{
+		if (state[i] == 2)
+			continue;
+
+		m_NumParsed++;
+		if (state[i] == 1)
+		{
+			stats[i].m_Header = headers[i];
+			m_Entries[fs::path(files[i]).filename().string()] = stats[i];
+			m_Modified = true;
+		}
+	}
+	return headers;
+}
+
+bool DicomHeaderIndex::Save()
+{
+	if (!m_Modified)
+		return true;
+
+	for (auto it = m_Entries.begin(); it != m_Entries.end();)
+	{
+		boost::system::error_code ec;
+		if (fs::exists(fs::path(m_Directory) / it->first, ec))
+			++it;
+		else
+			it = m_Entries.erase(it);
+	}
+
+	// e.g. the directory is on a read-only share
+	bool const ok = Write((fs::path(m_Directory) / SidecarName()).string()) || Write(FallbackFileName());
+	m_Modified = !ok;
+	return ok;
+}
+
+bool DicomHeaderIndex::Read(const std::string& filename)
+{
+	std::ifstream in(filename.c_str());
+	std::string line;
+	if (!std::getline(in, line) || line != k_Magic)
+		return false;
+
+	std::map<std::string, Entry> entries;
+	while (std::getline(in, line))
+	{
+		std::istringstream fields(line);
+		Entry entry;
+		std::uint32_t pos;
+		std::string name;
+		if (!(fields >> entry.m_Size >> entry.m_Time >> entry.m_Header.m_SeriesNr >> pos) || fields.get() != ' ' || !std::getline(fields, name) || name.empty())
+		{
+			ISEG_WARNING("ignoring corrupt DICOM index " << filename);
+			return false;
+		}
+		entry.m_Header.m_SlicePos = BitsFloat(pos);
+		entries[name] = entry;
+	}
+
+	m_Entries.swap(entries);
+	return true;
+}
+
+bool DicomHeaderIndex::Write(const std::string& filename) const
+{
+	// written next to the index and renamed, i.e. readers never see a partial index
+	std::string const temp = filename + ".tmp";
+	{
+		std::ofstream out(temp.c_str(), std::ios::trunc);
+		if (!out)
+			return false;
+
+		out << k_Magic << "\n";
+		for (const auto& entry : m_Entries)
+		{
+			if (entry.first.find('\n') != std::string::npos)
+				continue;
+			out << entry.second.m_Size << " " << entry.second.m_Time << " " << entry.second.m_Header.m_SeriesNr << " "
+					<< FloatBits(entry.second.m_Header.m_SlicePos) << " " << entry.first << "\n";
+		}
+		if (!out.flush())
+		{
+			out.close();
+			boost::system::error_code ec;
+			fs::remove(temp, ec);
+			return false;
+		}
+	}
+
+	boost::system::error_code ec;
+	fs::rename(temp, filename, ec);
+	if (ec)
+	{
+		fs::remove(temp, ec);
+		return false;
+	}
+	return true;
+}
+
+} // namespace iseg
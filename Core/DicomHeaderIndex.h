@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include "iSegCore.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace iseg {
+
+/** \brief On-disk cache of the DICOM header fields needed to group and sort the files of a directory
+
+	The index is a small sidecar file in the directory, or in the temporary directory if the
+	directory is read-only. Entries are keyed by file name, modification time and size, i.e.
+	reopening the same or a grown directory only parses the new or changed files.
+*/
+class ISEG_CORE_API DicomHeaderIndex
+{
+public:
+	struct Header
+	{
+		unsigned m_SeriesNr = 0;
+		float m_SlicePos = 0.f;
+	};
+	using parser_type = std::function<Header(const std::string&)>;
+
+	/// Loads the index of the directory, a missing or unreadable index is empty
+	DicomHeaderIndex(const std::string& directory);
+
+	/// Headers of the files, which must be in the directory. Files which are not indexed or have changed are parsed concurrently.
+	std::vector<Header> Lookup(const std::vector<std::string>& files, const parser_type& parse);
+
+	/// Writes the index if Lookup parsed any file, entries of deleted files are dropped
+	bool Save();
+
+	/// Number of files parsed by Lookup, i.e. which were not found in the index
+	size_t NumParsed() const { return m_NumParsed; }
+	size_t NumEntries() const { return m_Entries.size(); }
+
+	/// Name of the index inside the directory
+	static const char* SidecarName();
+
+private:
+	struct Entry
+	{
+		std::uint64_t m_Size = 0;
+		std::int64_t m_Time = 0;
+		Header m_Header;
+	};
+
+	bool Read(const std::string& filename);
+	bool Write(const std::string& filename) const;
+	std::string FallbackFileName() const;
+
+	std::string m_Directory;
+	std::map<std::string, Entry> m_Entries;
+	size_t m_NumParsed = 0;
+	bool m_Modified = false;
+};
+
+} // namespace iseg
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include "Precompiled.h"
+
+#include "HDF5ChunkReader.h"
+#include "HDF5ChunkWriter.h"
+
+#include "Data/Logger.h"
+
+#include <itk_zlib.h>
+#ifdef USE_HDF5_BLOSC
+#	include <blosc.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// H5Dread_chunk was added in HDF5 1.10.3
+#if H5_VERSION_GE(1, 10, 3)
+#	define ISEG_HDF5_DIRECT_CHUNK_READ
+#endif
+
+namespace iseg {
+
+namespace {
+
+struct Job
+{
+	size_t m_Index;
+	std::vector<std::uint8_t> m_Data;
+};
+
+/// Reads one slice through the filter pipeline, e.g. for chunks which were never written
+bool ReadHyperslab(hid_t dataset, hid_t type, hsize_t offset, hsize_t length, void* data)
+{
+	hid_t dataspace = H5Dget_space(dataset);
+	hid_t memspace = H5Screate_simple(1, &length, nullptr);
+	herr_t status = H5Sselect_hyperslab(dataspace, H5S_SELECT_SET, &offset, nullptr, &length, nullptr);
+	if (status >= 0)
+		status = H5Dread(dataset, type, memspace, dataspace, H5P_DEFAULT, data);
+	H5Sclose(memspace);
+	H5Sclose(dataspace);
+	return status >= 0;
+}
+
+} // namespace
+
+HDF5ChunkReader::HDF5ChunkReader(unsigned num_threads) : m_NumThreads(num_threads)
+{
+	if (m_NumThreads == 0)
+		m_NumThreads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool HDF5ChunkReader::Decompress(const void* data, size_t bytes, H5Z_filter_t filter, void* out, size_t out_bytes)
+{
+	if (filter == H5Z_FILTER_DEFLATE)
+	{
+		uLongf size = static_cast<uLongf>(out_bytes);
+		return uncompress(static_cast<Bytef*>(out), &size, static_cast<const Bytef*>(data), static_cast<uLong>(bytes)) == Z_OK && size == out_bytes;
+	}
+#ifdef USE_HDF5_BLOSC
+	if (filter == FILTER_BLOSC)
+	{
+		size_t nbytes = 0, cbytes = 0, blocksize = 0;
+		blosc_cbuffer_sizes(data, &nbytes, &cbytes, &blocksize);
+		if (nbytes != out_bytes || cbytes > bytes)
+			return false;
+		return blosc_decompress_ctx(data, out, out_bytes, 1) == static_cast<int>(out_bytes);
+	}
+#endif
+	return false;
+}
+
+bool HDF5ChunkReader::ReadSlices(HDF5IO::handle_id_type file, const std::string& name, HDF5IO::handle_id_type type, size_t type_size, void** slices, size_t num_slices, size_t slice_size, size_t offset)
+{
+	m_Fallback = false;
+#ifndef ISEG_HDF5_DIRECT_CHUNK_READ
+	m_Fallback = true;
+	return false;
+#else
+	if (slices == nullptr || num_slices == 0 || slice_size == 0 || offset % slice_size != 0 || H5Lexists(file, name.c_str(), H5P_DEFAULT) <= 0)
+	{
+		m_Fallback = true;
+		return false;
+	}
+
+	// same layout as written by HDF5ChunkWriter and HDF5IO::WriteData
+	hid_t dataset = H5Dopen2(file, name.c_str(), H5P_DEFAULT);
+	H5Z_filter_t filter = -1;
+	if (dataset >= 0)
+	{
+		hid_t plist = H5Dget_create_plist(dataset);
+		hid_t datatype = H5Dget_type(dataset);
+		hid_t dataspace = H5Dget_space(dataset);
+		hsize_t dims[1] = {0}, chunk_dims[1] = {0};
+		bool const supported = H5Tequal(datatype, type) > 0 && H5Sget_simple_extent_ndims(dataspace) == 1 &&
+													 H5Sget_simple_extent_dims(dataspace, dims, nullptr) == 1 && dims[0] >= offset + num_slices * slice_size &&
+													 H5Pget_layout(plist) == H5D_CHUNKED && H5Pget_chunk(plist, 1, chunk_dims) == 1 && chunk_dims[0] == slice_size;
+		filter = supported ? HDF5ChunkWriter::SupportedFilter(plist) : -1;
+		H5Tclose(datatype);
+		H5Sclose(dataspace);
+		H5Pclose(plist);
+	}
+	if (filter < 0)
+	{
+		if (dataset >= 0)
+			H5Dclose(dataset);
+		m_Fallback = true;
+		return false;
+	}
+
+	size_t const chunk_bytes = slice_size * type_size;
+	unsigned const num_threads = filter == H5Z_FILTER_NONE ? 0 : static_cast<unsigned>(std::min<size_t>(m_NumThreads, num_slices));
+	// bounds the memory of the compressed chunks waiting to be decompressed
+	size_t const max_in_flight = 2 * static_cast<size_t>(num_threads);
+
+	std::mutex mutex;
+	std::condition_variable ready, space;
+	std::deque<Job> queue;
+	bool finished = false;
+	std::atomic<bool> failed(false);
+
+	auto decompress = [&]() {
+		while (true)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				ready.wait(lock, [&] { return finished || !queue.empty(); });
+				if (queue.empty())
+					return;
+				job = std::move(queue.front());
+				queue.pop_front();
+			}
+			space.notify_one();
+
+			if (!failed && !Decompress(job.m_Data.data(), job.m_Data.size(), filter, slices[job.m_Index], chunk_bytes))
+			{
+				ISEG_ERROR("decompressing chunk " << job.m_Index << " of " << name << " failed");
+				failed = true;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned t = 0; t < num_threads; ++t)
+	{
+		threads.emplace_back(decompress);
+	}
+
+	// only this thread calls into HDF5, i.e. reading overlaps with decompression
+	bool ok = true;
+	for (size_t i = 0; i < num_slices && ok && !failed; ++i)
+	{
+		if (slices[i] == nullptr)
+			continue;
+
+		hsize_t chunk_offset[1] = {offset + i * slice_size};
+		hsize_t bytes = 0;
+		herr_t status = -1;
+		// fails for chunks which are not allocated
+		H5E_BEGIN_TRY
+		{
+			status = H5Dget_chunk_storage_size(dataset, chunk_offset, &bytes);
+		}
+		H5E_END_TRY;
+		if (status < 0 || bytes == 0)
+		{
+			// not allocated, reads the fill value
+			ok = ReadHyperslab(dataset, type, chunk_offset[0], slice_size, slices[i]);
+			continue;
+		}
+
+		// the filter mask marks the filters which were not applied to the chunk
+		uint32_t filter_mask = 0;
+		Job job;
+		job.m_Index = i;
+		if (bytes == chunk_bytes)
+		{
+			ok = H5Dread_chunk(dataset, H5P_DEFAULT, chunk_offset, &filter_mask, slices[i]) >= 0;
+			if (!ok || filter == H5Z_FILTER_NONE || (filter_mask & 1) != 0)
+				continue;
+			job.m_Data.assign(static_cast<std::uint8_t*>(slices[i]), static_cast<std::uint8_t*>(slices[i]) + chunk_bytes);
+		}
+		else
+		{
+			job.m_Data.resize(bytes);
+			ok = H5Dread_chunk(dataset, H5P_DEFAULT, chunk_offset, &filter_mask, job.m_Data.data()) >= 0 &&
+					 filter != H5Z_FILTER_NONE && (filter_mask & 1) == 0;
+			if (!ok)
+				continue;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			space.wait(lock, [&] { return queue.size() < max_in_flight; });
+			queue.push_back(std::move(job));
+		}
+		ready.notify_one();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		finished = true;
+	}
+	ready.notify_all();
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	H5Dclose(dataset);
+	ok = ok && !failed;
+	if (!ok)
+	{
+		ISEG_ERROR("reading dataset " << name << " failed");
+	}
+	return ok;
+#endif
+}
+
+} // namespace iseg
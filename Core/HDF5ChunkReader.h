@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include "iSegCore.h"
+
+#include "HDF5IO.h"
+
+#include <string>
+
+namespace iseg {
+
+/** \brief Reads a 1D dataset with one chunk per slice into slice buffers
+
+	Counterpart of HDF5ChunkWriter: the calling thread, which is the only one calling
+	into HDF5, reads the raw chunks while a pool of threads decompresses them straight
+	into the slices. Only a few chunks per thread are in flight. Unfiltered chunks are
+	read directly into the slice. If the dataset uses another layout or type, or direct
+	chunk reads are not supported, Read returns false and Fallback() is set, i.e. the
+	caller should read the data through the HDF5 filter pipeline instead.
+*/
+class ISEG_CORE_API HDF5ChunkReader
+{
+public:
+	/// num_threads = 0 uses all cores
+	HDF5ChunkReader(unsigned num_threads = 0);
+
+	template<typename T>
+	bool Read(HDF5IO::handle_id_type file, const std::string& name, T** slices, size_t num_slices, size_t slice_size, size_t offset = 0)
+	{
+		HDF5IO io;
+		return ReadSlices(file, name, io.GetTypeValue<T>(), sizeof(T), reinterpret_cast<void**>(slices), num_slices, slice_size, offset);
+	}
+
+	/// True if the last Read failed because the dataset cannot be read chunk by chunk
+	bool Fallback() const { return m_Fallback; }
+
+	/// Decompress one chunk written by the HDF5 filter (deflate or blosc). Returns false unless exactly out_bytes are produced.
+	static bool Decompress(const void* data, size_t bytes, H5Z_filter_t filter, void* out, size_t out_bytes);
+
+private:
+	bool ReadSlices(HDF5IO::handle_id_type file, const std::string& name, HDF5IO::handle_id_type type, size_t type_size, void** slices, size_t num_slices, size_t slice_size, size_t offset);
+
+	unsigned m_NumThreads;
+	bool m_Fallback = false;
+};
+
+} // namespace iseg
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include "Precompiled.h"
+
+#include "HDF5ChunkWriter.h"
+
+#include "Data/Logger.h"
+#include "Data/ProgressInfo.h"
+
+#include <itk_zlib.h>
+#ifdef USE_HDF5_BLOSC
+#	include <blosc.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// H5Dwrite_chunk was added in HDF5 1.10.3
+#if H5_VERSION_GE(1, 10, 3)
+#	define ISEG_HDF5_DIRECT_CHUNK_WRITE
+#endif
+
+namespace iseg {
+
+namespace {
+
+struct Chunk
+{
+	std::vector<std::uint8_t> m_Data;
+	bool m_Filtered = false;
+};
+
+} // namespace
+
+HDF5ChunkWriter::HDF5ChunkWriter(int compression, unsigned num_threads)
+		: m_Compression(compression), m_NumThreads(num_threads)
+{
+	if (m_NumThreads == 0)
+		m_NumThreads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+H5Z_filter_t HDF5ChunkWriter::SupportedFilter(HDF5IO::handle_id_type plist)
+{
+	int const nfilters = H5Pget_nfilters(plist);
+	if (nfilters == 0)
+		return H5Z_FILTER_NONE;
+	if (nfilters != 1)
+		return -1;
+
+	unsigned flags = 0;
+	size_t nelements = 0;
+	unsigned filter_config = 0;
+	H5Z_filter_t filter = H5Pget_filter2(plist, 0, &flags, &nelements, nullptr, 0, nullptr, &filter_config);
+#ifdef USE_HDF5_BLOSC
+	if (filter == FILTER_BLOSC)
+		return filter;
+#endif
+	return filter == H5Z_FILTER_DEFLATE ? filter : -1;
+}
+
+bool HDF5ChunkWriter::Compress(const void* data, size_t bytes, size_t type_size, H5Z_filter_t filter, int level, std::vector<std::uint8_t>& out)
+{
+	if (filter == H5Z_FILTER_DEFLATE)
+	{
+		// same stream format as the HDF5 deflate filter
+		uLongf size = compressBound(static_cast<uLong>(bytes));
+		out.resize(size);
+		if (compress2(out.data(), &size, static_cast<const Bytef*>(data), static_cast<uLong>(bytes), std::min(std::max(level, 1), 9)) != Z_OK || size >= bytes)
+			return false;
+		out.resize(size);
+		return true;
+	}
+#ifdef USE_HDF5_BLOSC
+	if (filter == FILTER_BLOSC)
+	{
+		out.resize(bytes + BLOSC_MAX_OVERHEAD);
+		int const size = blosc_compress_ctx(std::min(std::max(level, 1), 9), 1, type_size, bytes, data, out.data(), out.size(), "blosclz", 0, 1);
+		if (size <= 0 || static_cast<size_t>(size) >= bytes)
+			return false;
+		out.resize(size);
+		return true;
+	}
+#endif
+	return false;
+}
+
+bool HDF5ChunkWriter::WriteSlices(HDF5IO::handle_id_type file, const std::string& name, HDF5IO::handle_id_type type, size_t type_size, const void* const* slices, size_t num_slices, size_t slice_size, size_t offset)
+{
+	m_Fallback = false;
+#ifndef ISEG_HDF5_DIRECT_CHUNK_WRITE
+	m_Fallback = true;
+	return false;
+#else
+	if (slices == nullptr || num_slices == 0 || slice_size == 0)
+	{
+		m_Fallback = true;
+		return false;
+	}
+
+	size_t const chunk_bytes = slice_size * type_size;
+	hsize_t const giga = 1024 * 1024 * 1024;
+	if (chunk_bytes > giga || offset % slice_size != 0 || H5Tget_order(type) != H5T_ORDER_LE)
+	{
+		m_Fallback = true;
+		return false;
+	}
+
+	hid_t dataset = -1, plist = -1;
+	H5Z_filter_t filter = H5Z_FILTER_NONE;
+	if (H5Lexists(file, name.c_str(), H5P_DEFAULT) <= 0)
+	{
+		if (offset != 0)
+		{
+			m_Fallback = true;
+			return false;
+		}
+
+		// same layout as HDF5IO::WriteData
+		hsize_t dims[1] = {num_slices * slice_size};
+		hsize_t chunk_dims[1] = {slice_size};
+		hid_t dataspace = H5Screate_simple(1, dims, nullptr);
+		plist = H5Pcreate(H5P_DATASET_CREATE);
+		H5Pset_chunk(plist, 1, chunk_dims);
+		if (m_Compression > 0)
+		{
+#ifdef USE_HDF5_BLOSC
+			if (BloscEnabled())
+			{
+				unsigned int cd_values[7];
+				cd_values[4] = std::min(m_Compression, 9); /* compression level */
+				cd_values[5] = 1;													 /* 0: shuffle not active, 1: shuffle active */
+				cd_values[6] = BLOSC_BLOSCLZ;							 /* the actual compressor to use */
+				H5Pset_filter(plist, FILTER_BLOSC, H5Z_FLAG_OPTIONAL, 7, cd_values);
+				filter = FILTER_BLOSC;
+			}
+			else
+#endif
+			{
+				H5Pset_deflate(plist, std::min(m_Compression, 9));
+				filter = H5Z_FILTER_DEFLATE;
+			}
+		}
+		hid_t datatype = H5Tcopy(type);
+		H5Tset_order(datatype, H5T_ORDER_LE);
+		dataset = H5Dcreate2(file, name.c_str(), datatype, dataspace, H5P_DEFAULT, plist, H5P_DEFAULT);
+		H5Tclose(datatype);
+		H5Sclose(dataspace);
+	}
+	else
+	{
+		// e.g. when merging projects, only chunks with one slice each can be written directly
+		dataset = H5Dopen2(file, name.c_str(), H5P_DEFAULT);
+		if (dataset >= 0)
+		{
+			plist = H5Dget_create_plist(dataset);
+			hid_t datatype = H5Dget_type(dataset);
+			hid_t dataspace = H5Dget_space(dataset);
+			hsize_t dims[1] = {0}, chunk_dims[1] = {0};
+			bool const supported = H5Tequal(datatype, type) > 0 && H5Sget_simple_extent_ndims(dataspace) == 1 &&
+														 H5Sget_simple_extent_dims(dataspace, dims, nullptr) == 1 && dims[0] >= offset + num_slices * slice_size &&
+														 H5Pget_layout(plist) == H5D_CHUNKED && H5Pget_chunk(plist, 1, chunk_dims) == 1 && chunk_dims[0] == slice_size;
+			filter = supported ? SupportedFilter(plist) : -1;
+			H5Tclose(datatype);
+			H5Sclose(dataspace);
+		}
+		if (dataset < 0 || filter < 0)
+		{
+			if (plist >= 0)
+				H5Pclose(plist);
+			if (dataset >= 0)
+				H5Dclose(dataset);
+			m_Fallback = true;
+			return false;
+		}
+	}
+	if (plist >= 0)
+		H5Pclose(plist);
+	if (dataset < 0)
+	{
+		ISEG_ERROR("could not create dataset " << name);
+		return false;
+	}
+
+	int const level = m_Compression > 0 ? m_Compression : 1;
+	unsigned const num_threads = filter == H5Z_FILTER_NONE ? 0 : static_cast<unsigned>(std::min<size_t>(m_NumThreads, num_slices));
+	// bounds the memory of the compressed chunks waiting to be written
+	size_t const max_in_flight = 2 * static_cast<size_t>(num_threads);
+
+	std::mutex mutex;
+	std::condition_variable ready, space;
+	std::map<size_t, Chunk> done;
+	size_t written = 0;
+	bool abort = false;
+	std::atomic<size_t> next(0);
+
+	auto compress = [&]() {
+		for (size_t i = next++; i < num_slices; i = next++)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				space.wait(lock, [&] { return abort || i < written + max_in_flight; });
+				if (abort)
+					return;
+			}
+
+			Chunk chunk;
+			if (slices[i] != nullptr)
+			{
+				try
+				{
+					chunk.m_Filtered = Compress(slices[i], chunk_bytes, type_size, filter, level, chunk.m_Data);
+				}
+				catch (std::bad_alloc&)
+				{
+					// stored without filter
+					chunk.m_Filtered = false;
+				}
+				if (!chunk.m_Filtered)
+					chunk.m_Data.clear();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				done.emplace(i, std::move(chunk));
+			}
+			ready.notify_all();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned t = 0; t < num_threads; ++t)
+	{
+		threads.emplace_back(compress);
+	}
+
+	// only this thread calls into HDF5
+	bool ok = true;
+	for (size_t i = 0; i < num_slices && ok; ++i)
+	{
+		Chunk chunk;
+		if (num_threads > 0)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			ready.wait(lock, [&] { return done.count(i) != 0; });
+			chunk = std::move(done[i]);
+			done.erase(i);
+		}
+
+		// unwritten chunks read as zero
+		if (slices[i] != nullptr)
+		{
+			hsize_t chunk_offset[1] = {offset + i * slice_size};
+			// the filter mask marks the filters which were not applied to the chunk
+			uint32_t const filter_mask = (chunk.m_Filtered || filter == H5Z_FILTER_NONE) ? 0 : 1;
+			const void* data = chunk.m_Filtered ? chunk.m_Data.data() : slices[i];
+			size_t const bytes = chunk.m_Filtered ? chunk.m_Data.size() : chunk_bytes;
+			ok = H5Dwrite_chunk(dataset, H5P_DEFAULT, filter_mask, chunk_offset, bytes, data) >= 0;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			written = i + 1;
+			abort = !ok;
+		}
+		space.notify_all();
+		if (m_Progress)
+			m_Progress->Increment();
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	H5Dclose(dataset);
+	if (!ok)
+	{
+		ISEG_ERROR("writing dataset " << name << " failed");
+	}
+	return ok;
+#endif
+}
+
+} // namespace iseg
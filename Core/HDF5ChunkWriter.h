@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include "iSegCore.h"
+
+#include "HDF5IO.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace iseg {
+
+class ProgressInfo;
+
+/** \brief Writes slices into a 1D dataset with one chunk per slice
+
+	The chunks are compressed by a pool of threads while the calling thread, which is
+	the only one calling into HDF5, stores the finished chunks with direct chunk writes.
+	Only a few chunks per thread are in flight, i.e. no buffer for the whole volume is
+	needed. The file layout is the same as with HDF5IO::WriteData. If the dataset
+	exists and uses another layout, or direct chunk writes are not supported, the
+	writer falls back to HDF5IO::WriteData.
+*/
+class ISEG_CORE_API HDF5ChunkWriter
+{
+public:
+	/// compression <= 0 disables the filter, num_threads = 0 uses all cores
+	HDF5ChunkWriter(int compression = 1, unsigned num_threads = 0);
+
+	/// Incremented for every slice which is stored, e.g. for writing on a worker thread
+	void SetProgress(ProgressInfo* progress) { m_Progress = progress; }
+
+	template<typename T>
+	bool Write(HDF5IO::handle_id_type file, const std::string& name, T** const slices, size_t num_slices, size_t slice_size, size_t offset = 0)
+	{
+		HDF5IO io(m_Compression);
+		return WriteSlices(file, name, io.GetTypeValue<T>(), sizeof(T), reinterpret_cast<const void* const*>(slices), num_slices, slice_size, offset) || (m_Fallback && io.WriteData(file, name, slices, num_slices, slice_size, offset));
+	}
+
+	/// Returns the filter (none, deflate or blosc) of a dataset creation property list, or -1 if it is not supported
+	static H5Z_filter_t SupportedFilter(HDF5IO::handle_id_type plist);
+
+	/// Compress one chunk like the HDF5 filter (deflate or blosc) does. Returns false if the data does not shrink.
+	static bool Compress(const void* data, size_t bytes, size_t type_size, H5Z_filter_t filter, int level, std::vector<std::uint8_t>& out);
+
+private:
+	/// Returns false and sets m_Fallback if the direct chunk writes cannot be used
+	bool WriteSlices(HDF5IO::handle_id_type file, const std::string& name, HDF5IO::handle_id_type type, size_t type_size, const void* const* slices, size_t num_slices, size_t slice_size, size_t offset);
+
+	int m_Compression;
+	unsigned m_NumThreads;
+	bool m_Fallback = false;
+	ProgressInfo* m_Progress = nullptr;
+};
+
+} // namespace iseg
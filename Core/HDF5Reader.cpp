@@ -9,9 +9,11 @@
  */
 #include "Precompiled.h"
 
+#include "HDF5ChunkReader.h"
 #include "HDF5IO.h"
 #include "HDF5Reader.h"
 #include "Log.h"
+#include "VolumeRegion.h"
 
 #include <hdf5.h>
 
@@ -408,6 +410,36 @@ int HDF5Reader::Read(unsigned short* data, size_type offset, size_type length, c
 	return HDF5IO().ReadData(m_File, name, offset, length, data) ? 1 : 0;
 }
 
+int HDF5Reader::Read(float** slices, const unsigned dims[3], const VolumeRegion& region, const std::string& name) const
+{
+	return ReadRegion(slices, dims, region, name);
+}
+
+int HDF5Reader::Read(unsigned char** slices, const unsigned dims[3], const VolumeRegion& region, const std::string& name) const
+{
+	return ReadRegion(slices, dims, region, name);
+}
+
+int HDF5Reader::Read(unsigned short** slices, const unsigned dims[3], const VolumeRegion& region, const std::string& name) const
+{
+	return ReadRegion(slices, dims, region, name);
+}
+
+int HDF5Reader::ReadChunks(float** slices, size_type num_slices, size_type slice_size, const std::string& name, size_type offset) const
+{
+	return HDF5ChunkReader().Read(m_File, name, slices, num_slices, slice_size, offset) ? 1 : 0;
+}
+
+int HDF5Reader::ReadChunks(unsigned char** slices, size_type num_slices, size_type slice_size, const std::string& name, size_type offset) const
+{
+	return HDF5ChunkReader().Read(m_File, name, slices, num_slices, slice_size, offset) ? 1 : 0;
+}
+
+int HDF5Reader::ReadChunks(unsigned short** slices, size_type num_slices, size_type slice_size, const std::string& name, size_type offset) const
+{
+	return HDF5ChunkReader().Read(m_File, name, slices, num_slices, slice_size, offset) ? 1 : 0;
+}
+
 template<typename T>
 int HDF5Reader::ReadData(T* Array, const std::string& name)
 {
@@ -468,4 +500,69 @@ int HDF5Reader::ReadData(T* Array, const std::string& name)
 	return ok ? 1 : 0;
 }
 
+template<typename T>
+int HDF5Reader::ReadRegion(T** slices, const unsigned dims[3], const VolumeRegion& region, const std::string& name) const
+{
+	if (m_File < 0)
+	{
+		std::cerr << "HDF5Reader::readRegion() : no file open" << std::endl;
+		return 0;
+	}
+
+	hsize_t const width = dims[0];
+	hsize_t const area = width * dims[1];
+	hsize_t const step = region.m_Step;
+	hsize_t const row_length = region.m_Size[0];
+	unsigned const nx = region.Dim(0), ny = region.Dim(1), nz = region.Dim(2);
+
+	bool ok = false;
+
+	hid_t dataset = H5Dopen2(m_File, name.c_str(), H5P_DEFAULT);
+	if (dataset >= 0)
+	{
+		hid_t dataspace = H5Dget_space(dataset);
+		hsize_t extent = 0;
+		if (dataspace >= 0 && H5Sget_simple_extent_ndims(dataspace) == 1 &&
+				H5Sget_simple_extent_dims(dataspace, &extent, nullptr) >= 0 && extent >= area * dims[2])
+		{
+			// the selected rows of a slice are read as one block per row into a contiguous buffer
+			hsize_t const mem_size = row_length * ny;
+			hid_t memoryspace = H5Screate_simple(1, &mem_size, nullptr);
+			std::vector<T> buffer(step == 1 ? 0 : mem_size);
+
+			ok = true;
+			for (unsigned k = 0; k < nz && ok; k++)
+			{
+				hsize_t const z = region.m_Start[2] + k * step;
+				hsize_t const start = z * area + region.m_Start[1] * width + region.m_Start[0];
+				hsize_t const stride = width * step;
+				hsize_t const count = ny;
+				ok = H5Sselect_hyperslab(dataspace, H5S_SELECT_SET, &start, &stride, &count, &row_length) >= 0;
+
+				T* out = (step == 1) ? slices[k] : buffer.data();
+				ok = ok && H5Dread(dataset, HdfType<T>::Type(), memoryspace, dataspace, H5P_DEFAULT, out) >= 0;
+
+				if (ok && step != 1)
+				{
+					for (unsigned j = 0; j < ny; j++)
+					{
+						const T* row = buffer.data() + j * row_length;
+						T* dst = slices[k] + static_cast<size_t>(j) * nx;
+						for (unsigned i = 0; i < nx; i++)
+						{
+							dst[i] = row[i * step];
+						}
+					}
+				}
+			}
+			H5Sclose(memoryspace);
+		}
+		if (dataspace >= 0)
+			H5Sclose(dataspace);
+		H5Dclose(dataset);
+	}
+
+	return ok ? 1 : 0;
+}
+
 } // namespace iseg
@@ -18,6 +18,8 @@
 
 namespace iseg {
 
+struct VolumeRegion;
+
 class ISEG_CORE_API HDF5Reader
 {
 public:
@@ -58,6 +60,22 @@ public:
 	int Read(float* data, size_type offset, size_type length, const std::string& name) const;
 	int Read(unsigned short* data, size_type offset, size_type length, const std::string& name) const;
 
+	// Description:
+	// Read a box of a 1D dataset holding a volume of dims[0] x dims[1] x dims[2] voxels, slice by slice.
+	// Each output slice holds region.Dim(0) x region.Dim(1) voxels, the region must be clipped to dims.
+	// Only the rows within the box are selected in the file, columns are decimated after reading.
+	int Read(float** slices, const unsigned dims[3], const VolumeRegion& region, const std::string& name) const;
+	int Read(unsigned char** slices, const unsigned dims[3], const VolumeRegion& region, const std::string& name) const;
+	int Read(unsigned short** slices, const unsigned dims[3], const VolumeRegion& region, const std::string& name) const;
+
+	// Description:
+	// Read a dataset stored with one chunk per slice, decompressing the chunks in parallel.
+	// The first slice starts at offset, i.e. a range of slices may be read.
+	// Returns 0 if the dataset has another layout or type, see HDF5ChunkReader.
+	int ReadChunks(float** slices, size_type num_slices, size_type slice_size, const std::string& name, size_type offset = 0) const;
+	int ReadChunks(unsigned char** slices, size_type num_slices, size_type slice_size, const std::string& name, size_type offset = 0) const;
+	int ReadChunks(unsigned short** slices, size_type num_slices, size_type slice_size, const std::string& name, size_type offset = 0) const;
+
 	template<class T>
 	static int Read2(std::vector<T>& array, const std::string& path)
 	{
@@ -91,6 +109,9 @@ private:
 	template<typename T>
 	int ReadData(T* data, const std::string& name);
 
+	template<typename T>
+	int ReadRegion(T** slices, const unsigned dims[3], const VolumeRegion& region, const std::string& name) const;
+
 	hid_type m_File = -1;
 };
 
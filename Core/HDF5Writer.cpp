@@ -10,6 +10,7 @@
 #include "Precompiled.h"
 
 #include "HDF5Blosc.h"
+#include "HDF5ChunkWriter.h"
 #include "HDF5IO.h"
 #include "HDF5Writer.h"
 #include "Log.h"
@@ -42,6 +43,7 @@ HDF5Writer::HDF5Writer()
 	static_assert(std::is_same<size_type, hsize_t>::value, "type mismatch");
 	m_Compression = 1;
 	m_Loud = false;
+	m_Progress = nullptr;
 	m_File = -1;
 	m_Bufsize = 1024 * 1024;
 }
@@ -181,14 +183,64 @@ int HDF5Writer::CreateGroup(const std::string& gname)
 	return 1;
 }
 
+int HDF5Writer::Remove(const std::string& name)
+{
+	if (m_File < 0)
+	{
+		if (m_Loud)
+		{
+			std::cerr << "HDF5Writer::remove() : no files open" << std::endl;
+		}
+		return 0;
+	}
+
+	if (H5Ldelete(m_File, name.c_str(), H5P_DEFAULT) < 0)
+	{
+		std::cerr << "HDF5Writer::remove() : removing " << name << " failed\n";
+		return 0;
+	}
+	return 1;
+}
+
+int HDF5Writer::Copy(const std::string& fname, const std::string& name)
+{
+	if (m_File < 0)
+	{
+		if (m_Loud)
+		{
+			std::cerr << "HDF5Writer::copy() : no files open" << std::endl;
+		}
+		return 0;
+	}
+
+	hid_t const file = H5Fopen(fname.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+	if (file < 0)
+	{
+		std::cerr << "HDF5Writer::copy() : opening " << fname << " failed\n";
+		return 0;
+	}
+	herr_t const status = H5Ocopy(file, name.c_str(), m_File, name.c_str(), H5P_DEFAULT, H5P_DEFAULT);
+	H5Fclose(file);
+	if (status < 0)
+	{
+		std::cerr << "HDF5Writer::copy() : copying " << name << " failed\n";
+		return 0;
+	}
+	return 1;
+}
+
 int HDF5Writer::Write(float** const slice_data, size_type num_slices, size_type slice_size, const std::string& name, size_t offset)
 {
-	return HDF5IO(m_Compression).WriteData(m_File, name, slice_data, num_slices, slice_size, offset) ? 1 : 0;
+	HDF5ChunkWriter writer(m_Compression);
+	writer.SetProgress(m_Progress);
+	return writer.Write(m_File, name, slice_data, num_slices, slice_size, offset) ? 1 : 0;
 }
 
 int HDF5Writer::Write(unsigned short** const slice_data, size_type num_slices, size_type slice_size, const std::string& name, size_t offset)
 {
-	return HDF5IO(m_Compression).WriteData(m_File, name, slice_data, num_slices, slice_size, offset) ? 1 : 0;
+	HDF5ChunkWriter writer(m_Compression);
+	writer.SetProgress(m_Progress);
+	return writer.Write(m_File, name, slice_data, num_slices, slice_size, offset) ? 1 : 0;
 }
 
 int HDF5Writer::Write(const double* data, const std::vector<size_type>& dims, const std::string& name)
@@ -17,6 +17,8 @@
 
 namespace iseg {
 
+class ProgressInfo;
+
 class ISEG_CORE_API HDF5Writer
 {
 public:
@@ -27,6 +29,10 @@ public:
 
 	static std::vector<std::string> Tokenize(std::string&, char = '/');
 	int CreateGroup(const std::string&);
+	/// Unlink a dataset or group, e.g. before it is written again into an existing file
+	int Remove(const std::string&);
+	/// Copy the object 'name' of the h5 file 'fname' into this file. Chunked datasets are copied without decompressing them.
+	int Copy(const std::string& fname, const std::string& name);
 	int Open(const std::string&, const std::string& = "overwrite");
 	int Open(const char* fn, const std::string& = "overwrite");
 	int Close();
@@ -53,6 +59,8 @@ public:
 	bool m_Loud;
 	std::string m_Ordering;
 	std::vector<int> m_ChunkSize;
+	/// Incremented for every slice written by Write(slices, ...)
+	ProgressInfo* m_Progress;
 
 private:
 	int WriteData(const void*, const std::string&, const std::vector<size_type>&, const std::string&) const;
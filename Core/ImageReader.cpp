@@ -13,43 +13,66 @@
 
 #include "ImageReader.h"
 #include "VTIreader.h"
+#include "VolumeRegion.h"
 
 #include "itkDICOMOrientImageFilter.h"
 
 #include <itkImage.h>
 #include <itkImageFileReader.h>
 #include <itkRGBPixel.h>
-#include <itkUnaryFunctorImageFilter.h>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 namespace iseg {
 
 namespace {
-template<typename TComponent, typename TOutput>
-class RGBToValue
+/// Maps a row of colors to values. Neighboring pixels often share the color, e.g. in label images, and reuse the value.
+void ConvertRow(const itk::RGBPixel<unsigned char>* in, float* out, unsigned n, const std::function<float(unsigned char, unsigned char, unsigned char)>& color2grey)
 {
-public:
-	RGBToValue() = default;
-	~RGBToValue() = default;
-
-	std::function<float(unsigned char, unsigned char, unsigned char)> m_Functor;
+	if (n == 0)
+		return;
 
-	bool operator==(const RGBToValue& other) const
+	unsigned char r = in[0][0], g = in[0][1], b = in[0][2];
+	float value = color2grey(r, g, b);
+	for (unsigned i = 0; i < n; ++i)
 	{
-		return (&m_Functor == &other.m_Functor);
-	}
-	bool operator!=(const RGBToValue& other) const
-	{
-		return !(*this == other);
+		if (in[i][0] != r || in[i][1] != g || in[i][2] != b)
+		{
+			r = in[i][0];
+			g = in[i][1];
+			b = in[i][2];
+			value = color2grey(r, g, b);
+		}
+		out[i] = value;
 	}
+}
 
-	inline TOutput operator()(const itk::RGBPixel<TComponent>& A) const
+/// Copies every region.m_Step-th voxel of the region from a buffer holding the box [begin, begin + size)
+void CopyRegion(const float* buffer, const unsigned begin[3], const unsigned size[3], const VolumeRegion& region, float** slices)
+{
+	unsigned const nx = region.Dim(0), ny = region.Dim(1);
+	int const nz = static_cast<int>(region.Dim(2));
+#pragma omp parallel for
+	for (int k = 0; k < nz; k++)
 	{
-		return static_cast<TOutput>(m_Functor(A[0], A[1], A[2]));
+		size_t const z = region.m_Start[2] + k * region.m_Step - begin[2];
+		float* out = slices[k];
+		for (unsigned j = 0; j < ny; j++)
+		{
+			size_t const y = region.m_Start[1] + j * region.m_Step - begin[1];
+			const float* in = buffer + (z * size[1] + y) * size[0] + region.m_Start[0] - begin[0];
+			for (unsigned i = 0; i < nx; i++)
+			{
+				*out++ = in[i * region.m_Step];
+			}
+		}
 	}
-};
+}
 } // namespace
 
 bool ImageReader::GetInfo2D(const std::string& filename, unsigned& width, unsigned& height)
@@ -63,47 +86,64 @@ bool ImageReader::GetInfo2D(const std::string& filename, unsigned& width, unsign
 bool ImageReader::GetImageStack(const std::vector<std::string>& filenames, float** img_stack, unsigned width, unsigned height, const std::function<float(unsigned char, unsigned char, unsigned char)>& color2grey)
 {
 	using rgbpixel_type = itk::RGBPixel<unsigned char>;
-	using input_image_type = itk::Image<rgbpixel_type, 3>;
-	using output_image_type = itk::Image<float, 3>;
-
-	using reader_type = itk::ImageFileReader<input_image_type>;
-	using functor_type = RGBToValue<unsigned char, float>;
-	using rgbmapper_type = itk::UnaryFunctorImageFilter<input_image_type, output_image_type, functor_type>;
-
-	auto reader = reader_type::New();
+	using image_type = itk::Image<rgbpixel_type, 2>;
+	using reader_type = itk::ImageFileReader<image_type>;
 
-	functor_type functor;
-	functor.m_Functor = color2grey;
+	size_t const area = static_cast<size_t>(width) * height;
+	int const nrfiles = static_cast<int>(filenames.size());
 
-	auto mapper = rgbmapper_type::New();
-	mapper->SetInput(reader->GetOutput());
-	mapper->SetFunctor(functor);
+	// the files are decoded in batches of a few images per thread, which bounds the
+	// memory held by decoded color images independent of the stack size
+	int const batch_size = 2 * static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<image_type::Pointer> decoded(batch_size);
+	std::atomic<bool> ok(true);
 
-	for (size_t i = 0, iend = filenames.size(); i < iend; ++i)
+	for (int first = 0; first < nrfiles && ok; first += batch_size)
 	{
-		reader->SetFileName(filenames[i]);
+		int const nrbatch = std::min(batch_size, nrfiles - first);
 
-		try
-		{
-			mapper->Update();
-		}
-		catch (itk::ExceptionObject& e)
+#pragma omp parallel for schedule(dynamic)
+		for (int k = 0; k < nrbatch; ++k)
 		{
-			ISEG_ERROR("an exception occurred " << e.what());
-			return false;
+			decoded[k] = nullptr;
+			if (!ok)
+				continue;
+
+			auto reader = reader_type::New();
+			reader->SetFileName(filenames[first + k]);
+			try
+			{
+				reader->Update();
+			}
+			catch (itk::ExceptionObject& e)
+			{
+				ISEG_ERROR("an exception occurred " << e.what());
+				ok = false;
+				continue;
+			}
+
+			if (reader->GetOutput()->GetPixelContainer()->Size() != area)
+			{
+				ok = false;
+				continue;
+			}
+			decoded[k] = reader->GetOutput();
 		}
 
-		auto container = mapper->GetOutput()->GetPixelContainer();
-		size_t size = static_cast<size_t>(width) * height;
+		if (!ok)
+			break;
 
-		if (size != container->Size())
+		// the rows of the whole batch are converted in parallel, so a single large image uses all cores as well
+		int const nrrows = nrbatch * static_cast<int>(height);
+#pragma omp parallel for
+		for (int row = 0; row < nrrows; ++row)
 		{
-			return false;
+			int const k = row / static_cast<int>(height);
+			size_t const offset = static_cast<size_t>(row % height) * width;
+			ConvertRow(decoded[k]->GetBufferPointer() + offset, img_stack[first + k] + offset, width, color2grey);
 		}
-		auto buffer = container->GetImportPointer();
-		std::copy(buffer, buffer + size, img_stack[i]);
 	}
-	return true;
+	return ok;
 }
 
 bool ImageReader::GetSlice(const std::string& filename, float* slice, unsigned slicenr, unsigned width, unsigned height)
@@ -182,6 +222,79 @@ bool ImageReader::GetVolume(const std::string& filename, float** slices, unsigne
 	return true;
 }
 
+bool ImageReader::GetVolume(const std::string& filename, float** slices, const VolumeRegion& region)
+{
+	// ITK does not know how to load VTI, the reader decodes the whole file and the slice range is cropped
+	boost::filesystem::path path(filename);
+	std::string extension = boost::algorithm::to_lower_copy(path.has_extension() ? path.extension().string() : "");
+	if (extension == ".vti")
+	{
+		unsigned w, h, n;
+		float s[3], o[3];
+		std::vector<std::string> array_names;
+		if (!VTIreader::GetInfo(filename, w, h, n, s, o, array_names) || array_names.empty())
+		{
+			return false;
+		}
+
+		size_t const area = static_cast<size_t>(w) * h;
+		std::vector<float> buffer(area * region.m_Size[2]);
+		std::vector<float*> range(region.m_Size[2]);
+		for (unsigned k = 0; k < region.m_Size[2]; k++)
+		{
+			range[k] = buffer.data() + k * area;
+		}
+		if (!VTIreader::GetVolume(filename, range.data(), region.m_Start[2], region.m_Size[2], w, h, array_names[0]))
+		{
+			return false;
+		}
+		unsigned const begin[3] = {0, 0, region.m_Start[2]};
+		unsigned const size[3] = {w, h, region.m_Size[2]};
+		CopyRegion(buffer.data(), begin, size, region, slices);
+		return true;
+	}
+
+	using image_type = itk::Image<float, 3>;
+	using reader_type = itk::ImageFileReader<image_type>;
+
+	auto reader = reader_type::New();
+	reader->SetFileName(filename);
+	try
+	{
+		reader->UpdateOutputInformation();
+
+		image_type::RegionType requested;
+		for (unsigned r = 0; r < 3; r++)
+		{
+			requested.SetIndex(r, region.m_Start[r]);
+			requested.SetSize(r, region.m_Size[r]);
+		}
+		if (!reader->GetOutput()->GetLargestPossibleRegion().IsInside(requested))
+		{
+			return false;
+		}
+		reader->GetOutput()->SetRequestedRegion(requested);
+		reader->Update();
+	}
+	catch (itk::ExceptionObject& e)
+	{
+		ISEG_ERROR("an exception occurred " << e.what());
+		return false;
+	}
+
+	// the IO may buffer more than requested if it cannot stream
+	auto image = reader->GetOutput();
+	auto const buffered = image->GetBufferedRegion();
+	unsigned begin[3], size[3];
+	for (unsigned r = 0; r < 3; r++)
+	{
+		begin[r] = static_cast<unsigned>(buffered.GetIndex(r));
+		size[r] = static_cast<unsigned>(buffered.GetSize(r));
+	}
+	CopyRegion(image->GetBufferPointer(), begin, size, region, slices);
+	return true;
+}
+
 bool ImageReader::GetInfo(const std::string& filename, unsigned& width, unsigned& height, unsigned& nrslices, float spacing[3], Transform& transform)
 {
 	auto image_io = itk::ImageIOFactory::CreateImageIO(filename.c_str(), itk::ImageIOFactory::ReadMode);
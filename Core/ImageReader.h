@@ -18,6 +18,7 @@
 namespace iseg {
 
 class Transform;
+struct VolumeRegion;
 
 enum class eOrientation {
 	noChange = 0, // don't permute axes, preserve file ordering
@@ -35,7 +36,7 @@ class ISEG_CORE_API ImageReader
 public:
 	static bool GetInfo2D(const std::string& filename, unsigned& width, unsigned& height);
 
-	/// loads 2D image into pre-allocated memory
+	/// loads 2D images into pre-allocated memory, decoding several files concurrently. color2grey is called from multiple threads.
 	static bool GetImageStack(const std::vector<std::string>& filenames, float** img_stack, unsigned width, unsigned height, const std::function<float(unsigned char, unsigned char, unsigned char)>& color2grey);
 
 	/// get image size, spacing and transform
@@ -51,6 +52,10 @@ public:
 	static bool GetVolume(const std::string& filename, float** slices, unsigned nrslices, unsigned width, unsigned height);
 	static bool GetVolume(const std::string& filename, float** slices, unsigned startslice, unsigned nrslices, unsigned width, unsigned height);
 
+	/// loads a region, clipped to the image dimensions, into pre-allocated slices of region.Dim(0) x region.Dim(1) voxels.
+	/// Only the region is requested from the image IO, i.e. formats which support streaming do not decode the whole image.
+	static bool GetVolume(const std::string& filename, float** slices, const VolumeRegion& region);
+
 	/// loads image into buffer with optional orientation resampling
 	static bool GetVolume(const std::string& filename, std::vector<float>& buffer,
 			unsigned& width, unsigned& height, unsigned& nrslices,
@@ -0,0 +1,459 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include "Precompiled.h"
+
+#include "ImageStack.h"
+
+#include "Data/Logger.h"
+
+#include <boost/filesystem.hpp>
+
+#ifdef USE_HDF5_BLOSC
+#	include <blosc.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+namespace iseg {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+// PackBits style run-length encoding: a control byte c < 128 is followed by c+1 literal bytes,
+// otherwise the next byte is repeated c-125 times
+void EncodeRuns(const unsigned char* src, size_t n, std::vector<char>& dst)
+{
+	size_t i = 0;
+	while (i < n)
+	{
+		size_t run = 1;
+		while (i + run < n && run < 130 && src[i + run] == src[i])
+			++run;
+		if (run >= 3)
+		{
+			dst.push_back(static_cast<char>(run + 125));
+			dst.push_back(static_cast<char>(src[i]));
+			i += run;
+			continue;
+		}
+
+		size_t const start = i;
+		while (i < n && i - start < 128)
+		{
+			if (i + 2 < n && src[i] == src[i + 1] && src[i] == src[i + 2])
+				break;
+			++i;
+		}
+		dst.push_back(static_cast<char>(i - start - 1));
+		dst.insert(dst.end(), src + start, src + i);
+	}
+}
+
+bool DecodeRuns(const unsigned char* src, size_t n, unsigned char* dst, size_t size)
+{
+	size_t out = 0;
+	for (size_t i = 0; i < n;)
+	{
+		unsigned const c = src[i++];
+		if (c < 128)
+		{
+			size_t const len = c + 1;
+			if (i + len > n || out + len > size)
+				return false;
+			std::memcpy(dst + out, src + i, len);
+			i += len;
+			out += len;
+		}
+		else
+		{
+			size_t const len = c - 125;
+			if (i >= n || out + len > size)
+				return false;
+			std::memset(dst + out, src[i++], len);
+			out += len;
+		}
+	}
+	return out == size;
+}
+
+} // namespace
+
+std::vector<char> ImageStack::Compress(const float* bits, size_t area, bool allow_blosc)
+{
+	size_t const nbytes = area * sizeof(float);
+	std::vector<char> data;
+
+#ifdef USE_HDF5_BLOSC
+	if (allow_blosc)
+	{
+		data.resize(1 + nbytes + BLOSC_MAX_OVERHEAD);
+		data[0] = kBlosc;
+		int const n = blosc_compress_ctx(5, BLOSC_SHUFFLE, sizeof(float), nbytes, bits, data.data() + 1, nbytes + BLOSC_MAX_OVERHEAD, "lz4", 0, 1);
+		if (n > 0 && static_cast<size_t>(n) < nbytes)
+		{
+			data.resize(1 + n);
+			data.shrink_to_fit();
+			return data;
+		}
+		data.clear();
+	}
+#endif
+
+	// byte shuffle, such that the exponent and high mantissa bytes form long runs
+	std::vector<unsigned char> shuffled(nbytes);
+	const unsigned char* src = reinterpret_cast<const unsigned char*>(bits);
+	for (size_t i = 0; i < area; ++i)
+	{
+		for (size_t b = 0; b < sizeof(float); ++b)
+		{
+			shuffled[b * area + i] = src[i * sizeof(float) + b];
+		}
+	}
+
+	data.reserve(nbytes / 4);
+	data.push_back(kShuffleRLE);
+	EncodeRuns(shuffled.data(), nbytes, data);
+	if (data.size() > nbytes)
+	{
+		data.resize(1 + nbytes);
+		data[0] = kRaw;
+		std::memcpy(data.data() + 1, bits, nbytes);
+	}
+	data.shrink_to_fit();
+	return data;
+}
+
+bool ImageStack::Decompress(const char* data, size_t size, float* bits, size_t area)
+{
+	if (size == 0)
+		return false;
+
+	size_t const nbytes = area * sizeof(float);
+	switch (static_cast<std::uint8_t>(data[0]))
+	{
+	case kRaw:
+		if (size != 1 + nbytes)
+			return false;
+		std::memcpy(bits, data + 1, nbytes);
+		return true;
+	case kShuffleRLE: {
+		std::vector<unsigned char> shuffled(nbytes);
+		if (!DecodeRuns(reinterpret_cast<const unsigned char*>(data + 1), size - 1, shuffled.data(), nbytes))
+			return false;
+		unsigned char* dst = reinterpret_cast<unsigned char*>(bits);
+		for (size_t i = 0; i < area; ++i)
+		{
+			for (size_t b = 0; b < sizeof(float); ++b)
+			{
+				dst[i * sizeof(float) + b] = shuffled[b * area + i];
+			}
+		}
+		return true;
+	}
+	case kBlosc:
+#ifdef USE_HDF5_BLOSC
+		return blosc_decompress_ctx(data + 1, bits, nbytes, 1) == static_cast<int>(nbytes);
+#else
+		ISEG_ERROR_MSG("image stack entry is compressed with Blosc, which is not available in this build");
+		return false;
+#endif
+	default:
+		return false;
+	}
+}
+
+ImageStack::~ImageStack()
+{
+	CloseSpillFile();
+}
+
+unsigned ImageStack::Push(const float* bits, size_t area, unsigned char mode)
+{
+	return Push(1, area, mode, [bits](unsigned) { return bits; });
+}
+
+unsigned ImageStack::Push(unsigned nrslices, size_t area, unsigned char mode, const SliceFunction& slice)
+{
+	if (nrslices == 0)
+		return 0;
+	return Add(0, nrslices, area, mode, slice);
+}
+
+bool ImageStack::Insert(unsigned id, const float* bits, size_t area, unsigned char mode)
+{
+	if (id == 0 || Contains(id))
+		return false;
+	return Add(id, 1, area, mode, [bits](unsigned) { return bits; }) == id;
+}
+
+unsigned ImageStack::Add(unsigned first_id, unsigned nrslices, size_t area, unsigned char mode, const SliceFunction& slice)
+{
+	// compress without holding the lock
+	Entry entry;
+	entry.m_Area = area;
+	entry.m_Modes.assign(nrslices, mode);
+	entry.m_Live = nrslices;
+	entry.m_Offsets.push_back(0);
+	for (unsigned k = 0; k < nrslices; ++k)
+	{
+		auto data = Compress(slice(k), area);
+		entry.m_Data.insert(entry.m_Data.end(), data.begin(), data.end());
+		entry.m_Offsets.push_back(entry.m_Data.size());
+	}
+	entry.m_Data.shrink_to_fit();
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (first_id == 0)
+	{
+		first_id = m_NextId;
+	}
+	else if (m_Slices.count(first_id))
+	{
+		return 0;
+	}
+	m_NextId = std::max(m_NextId, first_id + nrslices);
+
+	for (unsigned k = 0; k < nrslices; ++k)
+	{
+		m_Slices[first_id + k] = SliceRef{first_id, k};
+	}
+	m_MemoryUsage += entry.m_Data.size();
+	m_Entries[first_id] = std::move(entry);
+
+	EnforceBudget();
+	return first_id;
+}
+
+bool ImageStack::Read(const Entry& entry, unsigned index, std::vector<char>& buffer) const
+{
+	size_t const begin = entry.m_Offsets[index];
+	size_t const size = entry.m_Offsets[index + 1] - begin;
+	buffer.resize(size);
+	if (entry.m_FileOffset < 0)
+	{
+		std::memcpy(buffer.data(), entry.m_Data.data() + begin, size);
+		return true;
+	}
+
+	m_SpillFile.clear();
+	m_SpillFile.seekg(entry.m_FileOffset + static_cast<std::int64_t>(begin));
+	m_SpillFile.read(buffer.data(), size);
+	return !m_SpillFile.fail();
+}
+
+bool ImageStack::Get(unsigned id, float* bits, unsigned char& mode) const
+{
+	std::vector<char> buffer;
+	size_t area = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto it = m_Slices.find(id);
+		if (it == m_Slices.end())
+			return false;
+		const Entry& entry = m_Entries.at(it->second.m_Entry);
+		if (!Read(entry, it->second.m_Index, buffer))
+		{
+			ISEG_ERROR("could not read image stack entry " << id << " from " << m_SpillFileName);
+			return false;
+		}
+		area = entry.m_Area;
+		mode = entry.m_Modes[it->second.m_Index];
+	}
+	return Decompress(buffer.data(), buffer.size(), bits, area);
+}
+
+bool ImageStack::Pop(float* bits, unsigned char& mode)
+{
+	unsigned const id = Back();
+	if (id == 0 || !Get(id, bits, mode))
+		return false;
+	Remove(id);
+	return true;
+}
+
+void ImageStack::Remove(unsigned id)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	RemoveLocked(id);
+}
+
+void ImageStack::RemoveLocked(unsigned id)
+{
+	auto it = m_Slices.find(id);
+	if (it == m_Slices.end())
+		return;
+
+	auto entry = m_Entries.find(it->second.m_Entry);
+	m_Slices.erase(it);
+	if (--entry->second.m_Live == 0)
+	{
+		bool const spilled = entry->second.m_FileOffset >= 0;
+		if (!spilled)
+		{
+			m_MemoryUsage -= entry->second.m_Data.size();
+		}
+		m_Entries.erase(entry);
+
+		if (spilled && std::none_of(m_Entries.begin(), m_Entries.end(), [](const std::pair<const unsigned, Entry>& e) { return e.second.m_FileOffset >= 0; }))
+		{
+			CloseSpillFile();
+		}
+	}
+}
+
+void ImageStack::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Entries.clear();
+	m_Slices.clear();
+	m_MemoryUsage = 0;
+	CloseSpillFile();
+}
+
+bool ImageStack::Contains(unsigned id) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Slices.count(id) != 0;
+}
+
+size_t ImageStack::Area(unsigned id) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto it = m_Slices.find(id);
+	return it != m_Slices.end() ? m_Entries.at(it->second.m_Entry).m_Area : 0;
+}
+
+bool ImageStack::SetMode(unsigned id, unsigned char mode)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto it = m_Slices.find(id);
+	if (it == m_Slices.end())
+		return false;
+	m_Entries.at(it->second.m_Entry).m_Modes[it->second.m_Index] = mode;
+	return true;
+}
+
+unsigned ImageStack::Back() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Slices.empty() ? 0 : m_Slices.rbegin()->first;
+}
+
+std::vector<unsigned> ImageStack::Ids() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	std::vector<unsigned> ids;
+	ids.reserve(m_Slices.size());
+	for (const auto& slice : m_Slices)
+	{
+		ids.push_back(slice.first);
+	}
+	return ids;
+}
+
+size_t ImageStack::Size() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Slices.size();
+}
+
+void ImageStack::SetNextId(unsigned id)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	unsigned const min_id = m_Slices.empty() ? 1 : m_Slices.rbegin()->first + 1;
+	m_NextId = std::max(id, min_id);
+}
+
+void ImageStack::SetMemoryBudget(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_MemoryBudget = bytes;
+	EnforceBudget();
+}
+
+size_t ImageStack::MemoryUsage() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_MemoryUsage;
+}
+
+size_t ImageStack::SpilledBytes() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	size_t bytes = 0;
+	for (const auto& entry : m_Entries)
+	{
+		if (entry.second.m_FileOffset >= 0)
+			bytes += entry.second.m_Offsets.back();
+	}
+	return bytes;
+}
+
+void ImageStack::EnforceBudget()
+{
+	// move the oldest entries to disk first, recent entries are more likely to be popped
+	for (auto it = m_Entries.begin(); m_MemoryBudget != 0 && m_MemoryUsage > m_MemoryBudget && it != m_Entries.end(); ++it)
+	{
+		if (it->second.m_FileOffset < 0 && !Spill(it->second))
+			break;
+	}
+}
+
+bool ImageStack::Spill(Entry& entry)
+{
+	if (!m_SpillFile.is_open())
+	{
+		boost::system::error_code ec;
+		auto path = fs::temp_directory_path(ec) / fs::unique_path("iseg-stack-%%%%-%%%%-%%%%.bin");
+		m_SpillFileName = path.string();
+		m_SpillFile.open(m_SpillFileName, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+		m_SpillFileSize = 0;
+		if (!m_SpillFile.is_open())
+		{
+			ISEG_ERROR("could not create image stack file " << m_SpillFileName);
+			return false;
+		}
+	}
+
+	m_SpillFile.clear();
+	m_SpillFile.seekp(m_SpillFileSize);
+	m_SpillFile.write(entry.m_Data.data(), entry.m_Data.size());
+	m_SpillFile.flush();
+	if (m_SpillFile.fail())
+	{
+		ISEG_ERROR("could not write image stack file " << m_SpillFileName);
+		return false;
+	}
+
+	entry.m_FileOffset = m_SpillFileSize;
+	m_SpillFileSize += static_cast<std::int64_t>(entry.m_Data.size());
+	m_MemoryUsage -= entry.m_Data.size();
+	std::vector<char>().swap(entry.m_Data);
+	return true;
+}
+
+void ImageStack::CloseSpillFile()
+{
+	if (m_SpillFile.is_open())
+	{
+		m_SpillFile.close();
+	}
+	if (!m_SpillFileName.empty())
+	{
+		boost::system::error_code ec;
+		fs::remove(m_SpillFileName, ec);
+		m_SpillFileName.clear();
+	}
+	m_SpillFileSize = 0;
+}
+
+} // namespace iseg
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include "iSegCore.h"
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace iseg {
+
+/** \brief Compressed stack of float images with a memory budget
+
+	Every pushed slice gets a unique id (> 0). Slices pushed together, e.g. a slice range,
+	form one entry and get consecutive ids. Each slice is compressed individually, such that
+	single slices can be retrieved without decompressing the whole entry.
+
+	If the compressed entries exceed the memory budget, the oldest entries are moved to a
+	temporary file. Space in the file is reclaimed once all spilled entries are removed.
+*/
+class ISEG_CORE_API ImageStack
+{
+public:
+	/// Returns the slice k of a push, the pointer must remain valid until the next call
+	using SliceFunction = std::function<const float*(unsigned k)>;
+
+	ImageStack() = default;
+	~ImageStack();
+
+	ImageStack(const ImageStack&) = delete;
+	ImageStack& operator=(const ImageStack&) = delete;
+
+	/// Push nrslices slices of size area as one entry. Returns the id of the first slice.
+	unsigned Push(unsigned nrslices, size_t area, unsigned char mode, const SliceFunction& slice);
+	unsigned Push(const float* bits, size_t area, unsigned char mode);
+	/// Add a slice with a given id, e.g. when restoring the stack from a project file
+	bool Insert(unsigned id, const float* bits, size_t area, unsigned char mode);
+
+	/// Decompress slice into bits, which must hold Area(id) values
+	bool Get(unsigned id, float* bits, unsigned char& mode) const;
+	/// Get and remove the most recently pushed slice
+	bool Pop(float* bits, unsigned char& mode);
+	void Remove(unsigned id);
+	void Clear();
+
+	bool Contains(unsigned id) const;
+	size_t Area(unsigned id) const;
+	bool SetMode(unsigned id, unsigned char mode);
+	/// Most recently pushed slice, 0 if the stack is empty
+	unsigned Back() const;
+	/// Ids of all slices, in the order they were pushed
+	std::vector<unsigned> Ids() const;
+	size_t Size() const;
+	bool Empty() const { return Size() == 0; }
+
+	unsigned NextId() const { return m_NextId; }
+	void SetNextId(unsigned id);
+
+	/// Maximum size of the compressed slices kept in memory, 0 means no limit
+	void SetMemoryBudget(size_t bytes);
+	size_t MemoryBudget() const { return m_MemoryBudget; }
+	/// Bytes of compressed slices in memory
+	size_t MemoryUsage() const;
+	/// Bytes of compressed slices moved to the temporary file
+	size_t SpilledBytes() const;
+
+	enum eCodec : std::uint8_t {
+		kRaw = 0,
+		kShuffleRLE = 1,
+		kBlosc = 2
+	};
+
+	/// Compress a float image. Blosc (LZ4) is only used if allowed and available, since the result must be readable in builds without Blosc.
+	static std::vector<char> Compress(const float* bits, size_t area, bool allow_blosc = true);
+	static bool Decompress(const char* data, size_t size, float* bits, size_t area);
+
+private:
+	struct Entry
+	{
+		size_t m_Area = 0;
+		/// compressed slices, slice k is in [m_Offsets[k], m_Offsets[k+1])
+		std::vector<char> m_Data;
+		std::vector<size_t> m_Offsets;
+		std::vector<unsigned char> m_Modes;
+		unsigned m_Live = 0;
+		/// offset in the spill file, or -1 if the data is in memory
+		std::int64_t m_FileOffset = -1;
+	};
+
+	struct SliceRef
+	{
+		unsigned m_Entry;
+		unsigned m_Index;
+	};
+
+	unsigned Add(unsigned first_id, unsigned nrslices, size_t area, unsigned char mode, const SliceFunction& slice);
+	bool Read(const Entry& entry, unsigned index, std::vector<char>& buffer) const;
+	void RemoveLocked(unsigned id);
+	void EnforceBudget();
+	bool Spill(Entry& entry);
+	void CloseSpillFile();
+
+	mutable std::mutex m_Mutex;
+	/// entries by id of their first slice
+	std::map<unsigned, Entry> m_Entries;
+	std::map<unsigned, SliceRef> m_Slices;
+	unsigned m_NextId = 1;
+	size_t m_MemoryBudget = 0;
+	size_t m_MemoryUsage = 0;
+
+	mutable std::fstream m_SpillFile;
+	std::string m_SpillFileName;
+	std::int64_t m_SpillFileSize = 0;
+};
+
+} // namespace iseg
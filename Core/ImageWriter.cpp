@@ -10,6 +10,7 @@
 #include "Precompiled.h"
 
 #include "ImageWriter.h"
+#include "ParallelGzip.h"
 #include "VtkGlue/itkImageToVTKImageFilter.h"
 
 #include "Data/Logger.h"
@@ -30,8 +31,69 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <fstream>
+
 namespace iseg {
 
+namespace fs = boost::filesystem;
+
+namespace {
+
+// the ITK writer requests slabs of about this size from the caster, if the format supports streaming
+size_t const kSlabBytes = 64 * 1024 * 1024;
+
+/// Replaces the uncompressed data of a MetaImage by a zlib stream, like MetaImageIO does when compression is enabled
+bool CompressMetaImage(const std::string& src, const std::string& dst)
+{
+	std::ifstream in(src, std::ios::binary);
+	std::vector<std::string> header;
+	std::string line;
+	while (std::getline(in, line))
+	{
+		if (boost::algorithm::starts_with(line, "CompressedData"))
+			continue;
+		header.push_back(line);
+		if (boost::algorithm::starts_with(line, "ElementDataFile"))
+			break;
+	}
+	if (header.empty() || !boost::algorithm::starts_with(header.back(), "ElementDataFile") ||
+			!boost::algorithm::ends_with(boost::algorithm::trim_copy(header.back()), "LOCAL"))
+	{
+		ISEG_ERROR("no local data in " << src);
+		return false;
+	}
+
+	// the size of the compressed data goes into the header, so it is compressed to a temporary file first
+	auto const data_path = fs::path(src).parent_path() / fs::unique_path("iseg-data-%%%%-%%%%.zraw");
+	bool ok = false;
+	{
+		std::ofstream data(data_path.string(), std::ios::binary | std::ios::trunc);
+		ok = data && ParallelGzip(ParallelGzip::kZlib).Compress(in, data);
+	}
+	boost::system::error_code ec;
+	auto const data_size = fs::file_size(data_path, ec);
+	if (ok && !ec)
+	{
+		std::ofstream out(dst, std::ios::binary | std::ios::trunc);
+		for (size_t i = 0; i + 1 < header.size(); i++)
+		{
+			out << header[i] << "\n";
+		}
+		out << "CompressedData = True\n";
+		out << "CompressedDataSize = " << data_size << "\n";
+		out << header.back() << "\n";
+
+		std::ifstream data(data_path.string(), std::ios::binary);
+		out << data.rdbuf();
+		ok = out.good();
+	}
+	fs::remove(data_path, ec);
+	return ok;
+}
+
+} // namespace
+
 template<typename T>
 bool ImageWriter::WriteVolume(const std::string& filename, const std::vector<T*>& all_slices, eSliceSelection selection, const SlicesHandlerInterface* handler)
 {
@@ -54,7 +116,7 @@ bool ImageWriter::WriteVolume(const std::string& filename, const std::vector<T*>
 	auto image = wrapToITK(all_slices, dims, start, end, handler->Spacing(), handler->ImageTransform());
 	if (image)
 	{
-		boost::filesystem::path path(filename);
+		fs::path path(filename);
 		std::string ext = boost::algorithm::to_lower_copy(path.has_extension() ? path.extension().string() : "");
 		if (ext == ".vti" || ext == ".vtk")
 		{
@@ -136,18 +198,44 @@ bool ImageWriter::WriteVolume(const std::string& filename, const std::vector<T*>
 			auto caster = caster_type::New();
 			caster->SetInput(image);
 
+			// the caster only copies the slab of slices which the writer requests
+			size_t const bytes = sizeof(T) * dims[0] * dims[1] * (end - start);
+			unsigned const divisions = static_cast<unsigned>(std::min<size_t>((bytes + kSlabBytes - 1) / kSlabBytes, end - start));
+
+			// ITK writes the data uncompressed, and it is deflated on all cores afterwards
+			bool const nifti_gz = (ext == ".gz" && boost::algorithm::to_lower_copy(path.stem().extension().string()) == ".nii");
+			bool const meta_image = (ext == ".mha");
+			fs::path write_path = path;
+			if (nifti_gz || meta_image)
+			{
+				write_path = path.parent_path() / fs::unique_path(path.stem().stem().string() + "-%%%%-%%%%" + (nifti_gz ? ".nii" : ".mha"));
+			}
+
 			auto writer = writer_type::New();
 			writer->SetInput(caster->GetOutput());
-			writer->SetFileName(filename);
+			writer->SetFileName(write_path.string());
+			writer->SetNumberOfStreamDivisions(std::max(divisions, 1u));
+			bool ok = false;
 			try
 			{
 				writer->Update();
-				return true;
+				ok = true;
 			}
 			catch (const itk::ExceptionObject& e)
 			{
 				ISEG_ERROR(e.GetDescription());
 			}
+
+			if (write_path != path)
+			{
+				if (ok)
+				{
+					ok = nifti_gz ? ParallelGzip().CompressFile(write_path.string(), filename) : CompressMetaImage(write_path.string(), filename);
+				}
+				boost::system::error_code ec;
+				fs::remove(write_path, ec);
+			}
+			return ok;
 		}
 	}
 	return false;
@@ -161,9 +249,11 @@ bool ImageWriter::WriteVolume(const std::string& file_path, SlicesHandlerInterfa
 		return WriteVolume<float>(file_path, handler->SourceSlices(), slice_selection, handler);
 	case eImageSelection::kTarget:
 		return WriteVolume<float>(file_path, handler->TargetSlices(), slice_selection, handler);
-	case eImageSelection::kTissue:
+	case eImageSelection::kTissue: {
+		TissuesPin pin(handler);
 		return WriteVolume<tissues_size_t>(file_path, handler->TissueSlices(handler->ActiveTissuelayer()), slice_selection, handler);
 	}
+	}
 	return false;
 }
 
@@ -22,6 +22,9 @@ namespace iseg {
 class SlicesHandlerInterface;
 
 /** \brief Image writer based on ITK image writer factory
+
+	Volumes are streamed to the ITK writer in slabs of slices, if the format supports it.
+	NIfTI (.nii.gz) and MetaImage (.mha) files are compressed on all cores.
 	*/
 class ImageWriter
 {
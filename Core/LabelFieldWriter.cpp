@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include "Precompiled.h"
+
+#include "LabelFieldWriter.h"
+#include "ParallelGzip.h"
+#include "SliceStreamBuffer.h"
+
+#include "Data/Logger.h"
+#include "Data/ProgressInfo.h"
+
+#include <itk_zlib.h>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace iseg {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+// slices, or blocks of the VTK XML files, which are compressed concurrently per thread
+size_t const kBatchPerThread = 2;
+
+void AppendUInt(std::string& out, unsigned value)
+{
+	char digits[16];
+	int n = 0;
+	do
+	{
+		digits[n++] = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	while (n > 0)
+	{
+		out += digits[--n];
+	}
+}
+
+void AppendUInt64(std::string& out, std::uint64_t value) { out.append(reinterpret_cast<const char*>(&value), 8); }
+
+/// Removes the file of a failed or canceled export
+bool Finish(bool ok, const std::string& filename)
+{
+	if (!ok)
+	{
+		ISEG_ERROR("could not write " << filename);
+		boost::system::error_code ec;
+		fs::remove(filename, ec);
+	}
+	return ok;
+}
+
+size_t BatchSize()
+{
+	return kBatchPerThread * std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+LabelFieldWriter::LabelFieldWriter(const tissues_size_t* const* slices, unsigned width, unsigned height, unsigned nrslices, const float spacing[3], tissues_size_t max_label)
+		: m_Slices(slices), m_Width(width), m_Height(height), m_NrSlices(nrslices), m_MaxLabel(max_label)
+{
+	std::copy(spacing, spacing + 3, m_Spacing);
+}
+
+void LabelFieldWriter::EncodeByteRLE(const std::uint8_t* data, size_t size, std::vector<std::uint8_t>& out)
+{
+	// a control byte c < 128 repeats the next byte c times, else c & 0x7f bytes follow literally
+	size_t i = 0;
+	while (i < size)
+	{
+		size_t run = 1;
+		while (i + run < size && run < 127 && data[i + run] == data[i])
+		{
+			run++;
+		}
+		if (run >= 3)
+		{
+			out.push_back(static_cast<std::uint8_t>(run));
+			out.push_back(data[i]);
+			i += run;
+			continue;
+		}
+
+		size_t j = i;
+		while (j < size && j - i < 127 && !(j + 2 < size && data[j] == data[j + 1] && data[j] == data[j + 2]))
+		{
+			j++;
+		}
+		out.push_back(static_cast<std::uint8_t>(0x80 | (j - i)));
+		out.insert(out.end(), data + i, data + j);
+		i = j;
+	}
+}
+
+void LabelFieldWriter::CopyLabels(std::uint64_t first, size_t count, bool big_endian, std::uint8_t* out) const
+{
+	size_t const area = Area();
+	while (count > 0)
+	{
+		unsigned const slice = static_cast<unsigned>(first / area);
+		size_t const offset = static_cast<size_t>(first % area);
+		size_t const n = std::min(count, area - offset);
+		const tissues_size_t* in = m_Slices[slice] + offset;
+		if (ByteLabels())
+		{
+			for (size_t i = 0; i < n; i++)
+			{
+				out[i] = static_cast<std::uint8_t>(in[i]);
+			}
+			out += n;
+		}
+		else
+		{
+			int const hi = big_endian ? 0 : 1;
+			for (size_t i = 0; i < n; i++)
+			{
+				out[2 * i + hi] = static_cast<std::uint8_t>(in[i] >> 8);
+				out[2 * i + 1 - hi] = static_cast<std::uint8_t>(in[i] & 0xff);
+			}
+			out += 2 * n;
+		}
+		first += n;
+		count -= n;
+	}
+}
+
+bool LabelFieldWriter::Step() const
+{
+	if (m_Progress == nullptr)
+		return true;
+	m_Progress->Increment();
+	return !m_Progress->WasCanceled();
+}
+
+bool LabelFieldWriter::WriteSlices(std::ostream& out, bool big_endian) const
+{
+	std::vector<std::uint8_t> buffer(Area() * LabelBytes());
+	bool ok = true;
+	for (unsigned k = 0; ok && k < m_NrSlices; k++)
+	{
+		CopyLabels(static_cast<std::uint64_t>(k) * Area(), Area(), big_endian, buffer.data());
+		out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+		ok = out.good() && Step();
+	}
+	return ok;
+}
+
+bool LabelFieldWriter::WriteAmiraMesh(const std::string& filename, const std::vector<Material>& materials, bool ascii) const
+{
+	if (m_Progress)
+		m_Progress->SetNumberOfSteps(m_NrSlices);
+
+	std::ofstream out(filename, std::ios_base::binary | std::ios_base::trunc);
+	if (!out.good())
+		return false;
+
+	char const* type = ByteLabels() ? "byte" : "ushort";
+	std::ostringstream header;
+	header << "# AmiraMesh " << (ascii ? "3D ASCII 2.0" : "BINARY-LITTLE-ENDIAN 2.1") << "\n\n";
+	header << "# CreationDate: Fri Jun 16 14:24:32 2006\n\n\n";
+	header << "define Lattice " << m_Width << " " << m_Height << " " << m_NrSlices << "\n\n";
+	header << "Parameters {\n";
+	header << "    Materials {\n";
+	header << "        Exterior {\n";
+	header << "            Id 1\n";
+	header << "        }\n";
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		header << "        " << materials[i].m_Name << " {\n";
+		header << "            Color " << materials[i].m_Color[0] << " " << materials[i].m_Color[1] << " " << materials[i].m_Color[2] << ",\n";
+		header << "            Id " << i + 2 << "\n";
+		header << "        }\n";
+	}
+	header << "    }\n";
+	header << "    Content \"" << m_Width << "x" << m_Height << "x" << m_NrSlices << " " << type << ", uniform coordinates\",\n";
+	header << "    BoundingBox 0 " << m_Width * m_Spacing[0] << " 0 " << m_Height * m_Spacing[1] << " 0 " << m_NrSlices * m_Spacing[2] << ",\n";
+	header << "    CoordType \"uniform\"\n";
+	header << "}\n\n";
+	header << "Lattice { " << type << " Labels } @1";
+
+	bool ok = false;
+	if (ascii || !m_Compression)
+	{
+		out << header.str() << "\n\n# Data section follows\n@1\n";
+		ok = ascii ? WriteAmiraAscii(out) : WriteSlices(out, false);
+		out << "\n";
+	}
+	else if (ByteLabels())
+	{
+		ok = WriteAmiraRLE(out, header.str());
+	}
+	else
+	{
+		ok = WriteAmiraZip(out, header.str(), filename);
+	}
+	out.close();
+	return Finish(ok && out.good(), filename);
+}
+
+bool LabelFieldWriter::WriteAmiraAscii(std::ostream& out) const
+{
+	std::string text;
+	bool ok = true;
+	for (unsigned k = 0; ok && k < m_NrSlices; k++)
+	{
+		text.clear();
+		const tissues_size_t* labels = m_Slices[k];
+		for (size_t i = 0, area = Area(); i < area; i++)
+		{
+			AppendUInt(text, labels[i]);
+			text += " \n";
+		}
+		out.write(text.data(), text.size());
+		ok = out.good() && Step();
+	}
+	return ok;
+}
+
+bool LabelFieldWriter::WriteAmiraRLE(std::ostream& out, const std::string& header) const
+{
+	// the encoded size goes into the header, so the slices are encoded twice, in batches on all cores
+	size_t const batch_size = BatchSize();
+	size_t const slice_bytes = Area();
+	int const nrslices = static_cast<int>(m_NrSlices);
+	std::vector<std::vector<std::uint8_t>> labels(batch_size), encoded(batch_size);
+
+	auto encode_batch = [&](int first, int n) {
+#pragma omp parallel for schedule(dynamic)
+		for (int i = 0; i < n; i++)
+		{
+			labels[i].resize(slice_bytes);
+			CopyLabels(static_cast<std::uint64_t>(first + i) * Area(), Area(), false, labels[i].data());
+			encoded[i].clear();
+			EncodeByteRLE(labels[i].data(), slice_bytes, encoded[i]);
+		}
+	};
+
+	std::uint64_t encoded_size = 0;
+	for (int first = 0; first < nrslices; first += static_cast<int>(batch_size))
+	{
+		int const n = std::min(static_cast<int>(batch_size), nrslices - first);
+		encode_batch(first, n);
+		for (int i = 0; i < n; i++)
+		{
+			encoded_size += encoded[i].size();
+		}
+	}
+
+	out << header << "(HxByteRLE," << encoded_size << ")\n\n# Data section follows\n@1\n";
+	bool ok = true;
+	for (int first = 0; ok && first < nrslices; first += static_cast<int>(batch_size))
+	{
+		int const n = std::min(static_cast<int>(batch_size), nrslices - first);
+		encode_batch(first, n);
+		for (int i = 0; ok && i < n; i++)
+		{
+			out.write(reinterpret_cast<const char*>(encoded[i].data()), encoded[i].size());
+			ok = out.good() && Step();
+		}
+	}
+	out << "\n";
+	return ok;
+}
+
+bool LabelFieldWriter::WriteAmiraZip(std::ostream& out, const std::string& header, const std::string& filename) const
+{
+	// the size of the zlib stream goes into the header, so it is compressed to a temporary file first
+	auto const data_path = fs::path(filename).parent_path() / fs::unique_path("iseg-labels-%%%%-%%%%.zip");
+	SliceStreamBuffer slices(m_Progress);
+	std::vector<std::vector<std::uint8_t>> converted;
+	if (sizeof(tissues_size_t) != 2)
+	{
+		converted.resize(m_NrSlices, std::vector<std::uint8_t>(Area() * 2));
+	}
+	for (unsigned k = 0; k < m_NrSlices; k++)
+	{
+		if (converted.empty())
+		{
+			slices.Add(m_Slices[k], Area() * 2, true);
+		}
+		else
+		{
+			CopyLabels(static_cast<std::uint64_t>(k) * Area(), Area(), false, converted[k].data());
+			slices.Add(converted[k].data(), converted[k].size(), true);
+		}
+	}
+
+	bool ok = false;
+	{
+		std::ofstream data(data_path.string(), std::ios::binary | std::ios::trunc);
+		std::istream in(&slices);
+		ok = data && ParallelGzip(ParallelGzip::kZlib).Compress(in, data) && !slices.Canceled();
+	}
+	boost::system::error_code ec;
+	auto const data_size = fs::file_size(data_path, ec);
+	if (ok && !ec)
+	{
+		out << header << "(HxZip," << data_size << ")\n\n# Data section follows\n@1\n";
+		std::ifstream data(data_path.string(), std::ios::binary);
+		out << data.rdbuf();
+		out << "\n";
+		ok = out.good();
+	}
+	fs::remove(data_path, ec);
+	return ok;
+}
+
+bool LabelFieldWriter::WriteVtk(const std::string& filename) const
+{
+	if (m_Progress)
+		m_Progress->SetNumberOfSteps(m_NrSlices);
+
+	std::ofstream out(filename, std::ios_base::binary | std::ios_base::trunc);
+	if (!out.good())
+		return false;
+
+	out << "# vtk DataFile Version 3.0\n";
+	out << "iSEG label field\n";
+	out << "BINARY\n";
+	out << "DATASET STRUCTURED_POINTS\n";
+	out << "DIMENSIONS " << m_Width << " " << m_Height << " " << m_NrSlices << "\n";
+	out << "SPACING " << m_Spacing[0] << " " << m_Spacing[1] << " " << m_Spacing[2] << "\n";
+	out << "ORIGIN 0 0 0\n";
+	out << "POINT_DATA " << static_cast<std::uint64_t>(Area()) * m_NrSlices << "\n";
+	out << "SCALARS Labels " << (ByteLabels() ? "unsigned_char" : "unsigned_short") << " 1\n";
+	out << "LOOKUP_TABLE default\n";
+	bool const ok = WriteSlices(out, true);
+	out << "\n";
+	out.close();
+	return Finish(ok && out.good(), filename);
+}
+
+bool LabelFieldWriter::WriteVti(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios_base::binary | std::ios_base::trunc);
+	if (!out.good())
+		return false;
+
+	std::uint64_t const num_labels = static_cast<std::uint64_t>(Area()) * m_NrSlices;
+	std::uint64_t const total_bytes = num_labels * LabelBytes();
+	std::ostringstream extent;
+	extent << "0 " << m_Width - 1 << " 0 " << m_Height - 1 << " 0 " << m_NrSlices - 1;
+
+	out << "<?xml version=\"1.0\"?>\n";
+	out << "<VTKFile type=\"ImageData\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\"" << (m_Compression ? " compressor=\"vtkZLibDataCompressor\"" : "") << ">\n";
+	out << "  <ImageData WholeExtent=\"" << extent.str() << "\" Origin=\"0 0 0\" Spacing=\"" << m_Spacing[0] << " " << m_Spacing[1] << " " << m_Spacing[2] << "\">\n";
+	out << "    <Piece Extent=\"" << extent.str() << "\">\n";
+	out << "      <PointData Scalars=\"Labels\">\n";
+	out << "        <DataArray type=\"" << (ByteLabels() ? "UInt8" : "UInt16") << "\" Name=\"Labels\" format=\"appended\" RangeMin=\"0\" RangeMax=\"" << m_MaxLabel << "\" offset=\"0\"/>\n";
+	out << "      </PointData>\n";
+	out << "      <CellData>\n";
+	out << "      </CellData>\n";
+	out << "    </Piece>\n";
+	out << "  </ImageData>\n";
+	out << "  <AppendedData encoding=\"raw\">\n";
+	out << "   _";
+
+	bool ok = true;
+	if (!m_Compression)
+	{
+		if (m_Progress)
+			m_Progress->SetNumberOfSteps(m_NrSlices);
+		std::string size;
+		AppendUInt64(size, total_bytes);
+		out << size;
+		ok = WriteSlices(out, false);
+	}
+	else
+	{
+		// independently compressed blocks, the header lists the compressed size of each block
+		std::uint64_t const block_bytes = ParallelGzip::kBlockSize;
+		std::uint64_t const num_blocks = (total_bytes + block_bytes - 1) / block_bytes;
+		if (m_Progress)
+			m_Progress->SetNumberOfSteps(static_cast<int>(num_blocks));
+
+		std::vector<std::uint64_t> block_header = {num_blocks, block_bytes, total_bytes % block_bytes};
+		block_header.resize(3 + num_blocks, 0);
+		auto const header_pos = out.tellp();
+		out.write(reinterpret_cast<const char*>(block_header.data()), block_header.size() * 8);
+
+		size_t const batch_size = BatchSize();
+		std::vector<std::vector<std::uint8_t>> input(batch_size), output(batch_size);
+		for (std::uint64_t first = 0; ok && first < num_blocks; first += batch_size)
+		{
+			int const n = static_cast<int>(std::min<std::uint64_t>(batch_size, num_blocks - first));
+			int failed = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+ : failed)
+			for (int i = 0; i < n; i++)
+			{
+				std::uint64_t const begin = (first + i) * block_bytes;
+				size_t const bytes = static_cast<size_t>(std::min(block_bytes, total_bytes - begin));
+				input[i].resize(bytes);
+				CopyLabels(begin / LabelBytes(), bytes / LabelBytes(), false, input[i].data());
+
+				uLongf size = compressBound(static_cast<uLong>(bytes));
+				output[i].resize(size);
+				if (compress2(output[i].data(), &size, input[i].data(), static_cast<uLong>(bytes), Z_DEFAULT_COMPRESSION) != Z_OK)
+					failed++;
+				output[i].resize(size);
+			}
+			ok = (failed == 0);
+			for (int i = 0; ok && i < n; i++)
+			{
+				block_header[3 + first + i] = output[i].size();
+				out.write(reinterpret_cast<const char*>(output[i].data()), output[i].size());
+				ok = out.good() && Step();
+			}
+		}
+
+		auto const end_pos = out.tellp();
+		out.seekp(header_pos);
+		out.write(reinterpret_cast<const char*>(block_header.data()), block_header.size() * 8);
+		out.seekp(end_pos);
+	}
+
+	out << "\n  </AppendedData>\n";
+	out << "</VTKFile>\n";
+	out.close();
+	return Finish(ok && out.good(), filename);
+}
+
+bool LabelFieldWriter::Write(const std::string& filename, const std::vector<Material>& materials) const
+{
+	fs::path const path(filename);
+	std::string const ext = boost::algorithm::to_lower_copy(path.has_extension() ? path.extension().string() : "");
+	if (ext == ".vtk")
+		return WriteVtk(filename);
+	if (ext == ".vti")
+		return WriteVti(filename);
+	return WriteAmiraMesh(filename, materials);
+}
+
+} // namespace iseg
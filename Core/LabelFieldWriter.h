@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include "iSegCore.h"
+
+#include "Data/Types.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace iseg {
+
+class ProgressInfo;
+
+/** \brief Writes a label field as AmiraMesh (.am), legacy VTK (.vtk) or VTK XML image (.vti) file
+
+	The labels are stored as bytes if the largest label fits, else as unsigned short. Each slice
+	is converted into a buffer which is written with a single call, and compression runs on all
+	cores: AmiraMesh files use HxByteRLE for bytes and HxZip for unsigned short, VTK XML files
+	use zlib compressed blocks. Legacy VTK files are big-endian and never compressed.
+*/
+class ISEG_CORE_API LabelFieldWriter
+{
+public:
+	struct Material
+	{
+		std::string m_Name;
+		float m_Color[3];
+	};
+
+	LabelFieldWriter(const tissues_size_t* const* slices, unsigned width, unsigned height, unsigned nrslices, const float spacing[3], tissues_size_t max_label);
+
+	void SetCompression(bool on) { m_Compression = on; }
+
+	/// Incremented for every slice written, the file is removed if the export is canceled
+	void SetProgress(ProgressInfo* progress) { m_Progress = progress; }
+
+	/// Materials are listed after Exterior (label 0), i.e. materials[i] has label i + 1
+	bool WriteAmiraMesh(const std::string& filename, const std::vector<Material>& materials, bool ascii = false) const;
+
+	bool WriteVtk(const std::string& filename) const;
+
+	bool WriteVti(const std::string& filename) const;
+
+	/// Picks the format by the extension, AmiraMesh unless it is .vtk or .vti
+	bool Write(const std::string& filename, const std::vector<Material>& materials) const;
+
+	/// Amira's HxByteRLE, appends the encoded data to out
+	static void EncodeByteRLE(const std::uint8_t* data, size_t size, std::vector<std::uint8_t>& out);
+
+private:
+	bool ByteLabels() const { return m_MaxLabel <= 255; }
+	size_t LabelBytes() const { return ByteLabels() ? 1 : 2; }
+	size_t Area() const { return static_cast<size_t>(m_Width) * m_Height; }
+
+	/// Copies count labels starting at voxel first of the volume as bytes or unsigned short, which are big-endian if requested
+	void CopyLabels(std::uint64_t first, size_t count, bool big_endian, std::uint8_t* out) const;
+
+	/// Increments the progress, false if the export is canceled
+	bool Step() const;
+
+	bool WriteAmiraAscii(std::ostream& out) const;
+	bool WriteAmiraRLE(std::ostream& out, const std::string& header) const;
+	bool WriteAmiraZip(std::ostream& out, const std::string& header, const std::string& filename) const;
+	bool WriteSlices(std::ostream& out, bool big_endian) const;
+
+	const tissues_size_t* const* m_Slices;
+	unsigned m_Width;
+	unsigned m_Height;
+	unsigned m_NrSlices;
+	float m_Spacing[3];
+	tissues_size_t m_MaxLabel;
+	bool m_Compression = true;
+	ProgressInfo* m_Progress = nullptr;
+};
+
+} // namespace iseg
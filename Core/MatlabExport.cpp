@@ -10,618 +10,332 @@
 #include "Precompiled.h"
 
 #include "MatlabExport.h"
+#include "ParallelGzip.h"
+#include "SliceStreamBuffer.h"
 
-#include <cstdio>
+#include "Data/Logger.h"
+#include "Data/ProgressInfo.h"
+
+#include <hdf5.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace iseg {
 
-bool matexport::print_mat(const char* filename, float* matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength, bool complex)
+namespace {
+
+// MATLAB -v7 files hold variables of up to 2 GB
+std::uint64_t const kMaxLevel5Bytes = 0x7fffffff;
+std::atomic<std::uint64_t> max_level5_bytes(kMaxLevel5Bytes);
+// HDF5 chunks must be smaller than 4 GB
+std::uint64_t const kMaxChunkBytes = 1024 * 1024 * 1024;
+
+enum eDataType : std::int32_t {
+	kMiInt8 = 1,
+	kMiInt32 = 5,
+	kMiUInt32 = 6,
+	kMiMatrix = 14,
+	kMiCompressed = 15
+};
+
+template<typename T>
+struct MatType;
+
+template<>
+struct MatType<float>
 {
-	FILE* fp;
-	fp = fopen(filename, "wb");
-	if (fp == nullptr)
-		return false;
+	static std::int32_t DataType() { return 7; } // miSINGLE
+	static unsigned char ArrayClass() { return 7; } // mxSINGLE_CLASS
+	static const char* ClassName() { return "single"; }
+	static hid_t H5Type() { return H5T_NATIVE_FLOAT; }
+};
 
-	unsigned char header[128];
-	{
-		unsigned char i = 0;
-		while (i < 116 && i < commentlength)
-		{
-			header[i] = comment[i];
-			i++;
-		}
-		while (i < 124)
-		{
-			header[i] = ' ';
-			i++;
-		}
-		header[124] = 0;
-		header[125] = 1;
-		header[126] = 'I';
-		header[127] = 'M';
-	}
+template<>
+struct MatType<unsigned char>
+{
+	static std::int32_t DataType() { return 2; } // miUINT8
+	static unsigned char ArrayClass() { return 9; } // mxUINT8_CLASS
+	static const char* ClassName() { return "uint8"; }
+	static hid_t H5Type() { return H5T_NATIVE_UCHAR; }
+};
 
-	fwrite(header, 128, 1, fp);
-	std::int32_t val = 14;
-	fwrite(&val, 4, 1, fp);
-	int namefieldlength = varnamelength;
-	if (varnamelength % 8 != 0)
-		namefieldlength += 8 - varnamelength % 8;
-	if (complex)
-		val = 64 + 2 * 4 * nx * ny * nz + namefieldlength;
-	else
-		val = 56 + 4 * nx * ny * nz + namefieldlength;
-	fwrite(&val, 4, 1, fp);
-	val = 6;
-	fwrite(&val, 4, 1, fp);
-	val = 8;
-	fwrite(&val, 4, 1, fp);
-	unsigned char c1 = 7;
-	fwrite(&c1, 1, 1, fp);
-	if (complex)
-		c1 = 8;
-	else
-		c1 = 0;
-	fwrite(&c1, 1, 1, fp);
-	c1 = 0;
-	fwrite(&c1, 1, 1, fp);
-	fwrite(&c1, 1, 1, fp);
-	val = 0;
-	fwrite(&val, 4, 1, fp);
-	val = 5;
-	fwrite(&val, 4, 1, fp);
-	val = 12;
-	fwrite(&val, 4, 1, fp);
-	val = nx;
-	fwrite(&val, 4, 1, fp);
-	val = ny;
-	fwrite(&val, 4, 1, fp);
-	val = nz;
-	fwrite(&val, 4, 1, fp);
-	val = 0;
-	fwrite(&val, 4, 1, fp);
-	val = 1;
-	fwrite(&val, 4, 1, fp);
-	val = varnamelength;
-	fwrite(&val, 4, 1, fp);
-	fwrite(varname, varnamelength, 1, fp);
-	c1 = 0;
-	{
-		for (int i = varnamelength; i % 8 != 0; i++)
-		{
-			fwrite(&c1, 1, 1, fp);
-		}
-	}
-	val = 7;
-	fwrite(&val, 4, 1, fp);
-	val = nx * ny * nz * 4;
-	fwrite(&val, 4, 1, fp);
-	fwrite(matrix, nx * ny * nz * 4, 1, fp);
-	if (nx % 2 == 1 && ny % 2 == 1 && nz % 2 == 1)
-		fwrite(&val, 4, 1, fp);
-	if (complex)
-	{
-		val = 7;
-		fwrite(&val, 4, 1, fp);
-		val = nx * ny * nz * 4;
-		fwrite(&val, 4, 1, fp);
-		fwrite(&matrix[nx * ny * nz], nx * ny * nz * 4, 1, fp);
-		if (nx % 2 == 1 && ny % 2 == 1 && nz % 2 == 1)
-			fwrite(&val, 4, 1, fp);
-	}
-	fclose(fp);
-	return true;
+template<>
+struct MatType<unsigned short>
+{
+	static std::int32_t DataType() { return 4; } // miUINT16
+	static unsigned char ArrayClass() { return 11; } // mxUINT16_CLASS
+	static const char* ClassName() { return "uint16"; }
+	static hid_t H5Type() { return H5T_NATIVE_USHORT; }
+};
+
+/// The 128 byte header of a MAT-file, version is 0x0100 for level 5 and 0x0200 for v7.3 files
+std::string FileHeader(const std::string& comment, unsigned char version)
+{
+	std::string header = comment.substr(0, 116);
+	header.resize(124, ' ');
+	header += static_cast<char>(0);
+	header += static_cast<char>(version);
+	header += "IM";
+	return header;
 }
 
-bool matexport::print_matslices(const char* filename, float** matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength, bool complex)
+void AppendTag(std::string& out, std::int32_t type, std::uint32_t bytes)
 {
-	FILE* fp;
-	fp = fopen(filename, "wb");
-	if (fp == nullptr)
-		return false;
+	out.append(reinterpret_cast<const char*>(&type), 4);
+	out.append(reinterpret_cast<const char*>(&bytes), 4);
+}
+
+size_t Padding(std::uint64_t bytes) { return static_cast<size_t>((8 - bytes % 8) % 8); }
+
+/// Writes a compressed level 5 MAT-file, i.e. a single miCOMPRESSED element holding the miMATRIX element
+template<typename T>
+bool WriteLevel5(const char* filename, const T* const* real, const T* const* imag, int nx, int ny, int nz, const std::string& comment, const std::string& varname, ProgressInfo* progress)
+{
+	std::uint64_t const slice_bytes = static_cast<std::uint64_t>(nx) * ny * sizeof(T);
+	std::uint64_t const data_bytes = slice_bytes * nz;
+	static char const zeros[8] = {};
 
-	unsigned char header[128];
+	std::string header;
+	AppendTag(header, kMiMatrix, 0);
+	// array flags
+	AppendTag(header, kMiUInt32, 8);
+	unsigned char const flags[8] = {MatType<T>::ArrayClass(), static_cast<unsigned char>(imag ? 8 : 0), 0, 0, 0, 0, 0, 0};
+	header.append(reinterpret_cast<const char*>(flags), 8);
+	// dimensions
+	AppendTag(header, kMiInt32, 12);
+	std::int32_t const dims[4] = {nx, ny, nz, 0};
+	header.append(reinterpret_cast<const char*>(dims), 16);
+	// array name
+	AppendTag(header, kMiInt8, static_cast<std::uint32_t>(varname.size()));
+	header += varname;
+	header.append(zeros, Padding(varname.size()));
+	// real part
+	AppendTag(header, MatType<T>::DataType(), static_cast<std::uint32_t>(data_bytes));
+
+	std::string imag_tag;
+	AppendTag(imag_tag, MatType<T>::DataType(), static_cast<std::uint32_t>(data_bytes));
+
+	std::uint64_t const matrix_bytes = header.size() - 8 + (data_bytes + Padding(data_bytes)) * (imag ? 2 : 1) + (imag ? imag_tag.size() : 0);
+	std::uint32_t const matrix_size = static_cast<std::uint32_t>(matrix_bytes);
+	std::memcpy(&header[4], &matrix_size, 4);
+
+	// the uncompressed miMATRIX element, assembled without copying the slices
+	SliceStreamBuffer element(progress);
+	element.Add(header.data(), header.size());
+	for (int k = 0; k < nz; k++)
 	{
-		unsigned char i = 0;
-		while (i < 116 && i < commentlength)
-		{
-			header[i] = comment[i];
-			i++;
-		}
-		while (i < 124)
-		{
-			header[i] = ' ';
-			i++;
-		}
-		header[124] = 0;
-		header[125] = 1;
-		header[126] = 'I';
-		header[127] = 'M';
+		element.Add(real[k], slice_bytes, true);
 	}
-
-	fwrite(header, 128, 1, fp);
-	std::int32_t val = 14;
-	fwrite(&val, 4, 1, fp);
-	int namefieldlength = varnamelength;
-	if (varnamelength % 8 != 0)
-		namefieldlength += 8 - varnamelength % 8;
-	if (complex)
-		val = 64 + 2 * 4 * nx * ny * nz + namefieldlength;
-	else
-		val = 56 + 4 * nx * ny * nz + namefieldlength;
-	fwrite(&val, 4, 1, fp);
-	val = 6;
-	fwrite(&val, 4, 1, fp);
-	val = 8;
-	fwrite(&val, 4, 1, fp);
-	unsigned char c1 = 7;
-	fwrite(&c1, 1, 1, fp);
-	if (complex)
-		c1 = 8;
-	else
-		c1 = 0;
-	fwrite(&c1, 1, 1, fp);
-	c1 = 0;
-	fwrite(&c1, 1, 1, fp);
-	fwrite(&c1, 1, 1, fp);
-	val = 0;
-	fwrite(&val, 4, 1, fp);
-	val = 5;
-	fwrite(&val, 4, 1, fp);
-	val = 12;
-	fwrite(&val, 4, 1, fp);
-	val = nx;
-	fwrite(&val, 4, 1, fp);
-	val = ny;
-	fwrite(&val, 4, 1, fp);
-	val = nz;
-	fwrite(&val, 4, 1, fp);
-	val = 0;
-	fwrite(&val, 4, 1, fp);
-	val = 1;
-	fwrite(&val, 4, 1, fp);
-	val = varnamelength;
-	fwrite(&val, 4, 1, fp);
-	fwrite(varname, varnamelength, 1, fp);
-	c1 = 0;
+	element.Add(zeros, Padding(data_bytes));
+	if (imag)
 	{
-		for (int i = varnamelength; i % 8 != 0; i++)
+		element.Add(imag_tag.data(), imag_tag.size());
+		for (int k = 0; k < nz; k++)
 		{
-			fwrite(&c1, 1, 1, fp);
+			element.Add(imag[k], slice_bytes, true);
 		}
+		element.Add(zeros, Padding(data_bytes));
 	}
-	val = 7;
-	fwrite(&val, 4, 1, fp);
-	val = nx * ny * nz * 4;
-	fwrite(&val, 4, 1, fp);
-	for (int i = 0; i < nz; i++)
-	{
-		fwrite(matrix[i], nx * ny * 4, 1, fp);
-	}
-	if (nx % 2 == 1 && ny % 2 == 1 && nz % 2 == 1)
-		fwrite(&val, 4, 1, fp);
-	if (complex)
-	{
-		val = 7;
-		fwrite(&val, 4, 1, fp);
-		val = nx * ny * nz * 4;
-		fwrite(&val, 4, 1, fp);
-		fwrite(&matrix[nx * ny * nz], nx * ny * nz * 4, 1, fp);
-		if (nx % 2 == 1 && ny % 2 == 1 && nz % 2 == 1)
-			fwrite(&val, 4, 1, fp);
-	}
-	fclose(fp);
-	return true;
+
+	std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+	if (!out)
+		return false;
+	out << FileHeader(comment, 1);
+
+	// the size of the compressed element is known once it is written
+	std::string tag;
+	AppendTag(tag, kMiCompressed, 0);
+	auto const tag_pos = out.tellp();
+	out << tag;
+
+	std::istream in(&element);
+	if (!ParallelGzip(ParallelGzip::kZlib).Compress(in, out) || element.Canceled())
+		return false;
+
+	std::uint32_t const compressed_size = static_cast<std::uint32_t>(out.tellp() - tag_pos) - 8;
+	out.seekp(tag_pos + std::streamoff(4));
+	out.write(reinterpret_cast<const char*>(&compressed_size), 4);
+	return out.good();
 }
 
-bool matexport::print_mat(const char* filename, unsigned char* matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength)
+/// Writes a MAT-file of version 7.3, i.e. an HDF5 file with the MAT-file header in its user block
+template<typename T>
+bool WriteV73(const char* filename, const T* const* real, const T* const* imag, int nx, int ny, int nz, const std::string& comment, const std::string& varname, ProgressInfo* progress)
 {
-	FILE* fp;
-	fp = fopen(filename, "wb");
-	if (fp == nullptr)
+	hid_t plist = H5Pcreate(H5P_FILE_CREATE);
+	H5Pset_userblock(plist, 512);
+	hid_t file = H5Fcreate(filename, H5F_ACC_TRUNC, plist, H5P_DEFAULT);
+	H5Pclose(plist);
+	if (file < 0)
 		return false;
 
-	unsigned char header[128];
+	// MATLAB arrays are column-major, the x axis varies fastest
+	size_t const element_size = (imag ? 2 : 1) * sizeof(T);
+	hsize_t const rows_per_chunk = std::max<hsize_t>(1, std::min<hsize_t>(ny, kMaxChunkBytes / (static_cast<std::uint64_t>(nx) * element_size)));
+	hsize_t const dims[3] = {static_cast<hsize_t>(nz), static_cast<hsize_t>(ny), static_cast<hsize_t>(nx)};
+	hsize_t const chunk_dims[3] = {1, rows_per_chunk, static_cast<hsize_t>(nx)};
+
+	hid_t type = H5Tcopy(MatType<T>::H5Type());
+	if (imag)
 	{
-		unsigned char i = 0;
-		while (i < 116 && i < commentlength)
-		{
-			header[i] = comment[i];
-			i++;
-		}
-		while (i < 124)
-		{
-			header[i] = ' ';
-			i++;
-		}
-		header[124] = 0;
-		header[125] = 1;
-		header[126] = 'I';
-		header[127] = 'M';
+		H5Tclose(type);
+		type = H5Tcreate(H5T_COMPOUND, element_size);
+		H5Tinsert(type, "real", 0, MatType<T>::H5Type());
+		H5Tinsert(type, "imag", sizeof(T), MatType<T>::H5Type());
 	}
 
-	fwrite(header, 128, 1, fp);
-	std::int32_t val = 14;
-	fwrite(&val, 4, 1, fp);
-	int namefieldlength = varnamelength;
-	if (varnamelength % 8 != 0)
-		namefieldlength += 8 - varnamelength % 8;
-	int padding = 0;
-	if (nx * ny * nz % 8 != 0)
-		padding = 8 - nx * ny * nz % 8;
-	val = 56 + nx * ny * nz + namefieldlength + padding;
-	fwrite(&val, 4, 1, fp);
-	val = 6;
-	fwrite(&val, 4, 1, fp);
-	val = 8;
-	fwrite(&val, 4, 1, fp);
-	unsigned char c1 = 9;
-	fwrite(&c1, 1, 1, fp);
-	c1 = 0;
-	fwrite(&c1, 1, 1, fp);
-	fwrite(&c1, 1, 1, fp);
-	fwrite(&c1, 1, 1, fp);
-	val = 0;
-	fwrite(&val, 4, 1, fp);
-	val = 5;
-	fwrite(&val, 4, 1, fp);
-	val = 12;
-	fwrite(&val, 4, 1, fp);
-	val = nx;
-	fwrite(&val, 4, 1, fp);
-	val = ny;
-	fwrite(&val, 4, 1, fp);
-	val = nz;
-	fwrite(&val, 4, 1, fp);
-	val = 0;
-	fwrite(&val, 4, 1, fp);
-	val = 1;
-	fwrite(&val, 4, 1, fp);
-	val = varnamelength;
-	fwrite(&val, 4, 1, fp);
-	fwrite(varname, varnamelength, 1, fp);
-	c1 = 0;
+	hid_t filespace = H5Screate_simple(3, dims, nullptr);
+	plist = H5Pcreate(H5P_DATASET_CREATE);
+	H5Pset_chunk(plist, 3, chunk_dims);
+	H5Pset_deflate(plist, 3);
+	hid_t dataset = H5Dcreate2(file, varname.c_str(), type, filespace, H5P_DEFAULT, plist, H5P_DEFAULT);
+	H5Pclose(plist);
+
+	bool ok = dataset >= 0;
+	if (ok)
 	{
-		for (int i = varnamelength; i % 8 != 0; i++)
-		{
-			fwrite(&c1, 1, 1, fp);
-		}
+		std::string const class_name = MatType<T>::ClassName();
+		hid_t string_type = H5Tcopy(H5T_C_S1);
+		H5Tset_size(string_type, class_name.size());
+		hid_t scalar = H5Screate(H5S_SCALAR);
+		hid_t attribute = H5Acreate2(dataset, "MATLAB_class", string_type, scalar, H5P_DEFAULT, H5P_DEFAULT);
+		ok = attribute >= 0 && H5Awrite(attribute, string_type, class_name.c_str()) >= 0;
+		if (attribute >= 0)
+			H5Aclose(attribute);
+		H5Sclose(scalar);
+		H5Tclose(string_type);
 	}
-	val = 2;
-	fwrite(&val, 4, 1, fp);
-	val = nx * ny * nz;
-	fwrite(&val, 4, 1, fp);
-	fwrite(matrix, nx * ny * nz, 1, fp);
-	c1 = 0;
-	{
-		for (int i = nx * ny * nz; i % 8 != 0; i++)
-		{
-			fwrite(&c1, 1, 1, fp);
-		}
-	}
-	fclose(fp);
-	return true;
-}
-bool matexport::print_matslices(const char* filename, unsigned char** matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength)
-{
-	FILE* fp;
-	fp = fopen(filename, "wb");
-	if (fp == nullptr)
-		return false;
 
-	unsigned char header[128];
+	size_t const slice_size = static_cast<size_t>(nx) * ny;
+	hsize_t const count[3] = {1, dims[1], dims[2]};
+	hid_t memspace = H5Screate_simple(3, count, nullptr);
+	std::vector<T> interleaved(imag ? 2 * slice_size : 0);
+	for (int k = 0; ok && k < nz; k++)
 	{
-		unsigned char i = 0;
-		while (i < 116 && i < commentlength)
+		const void* data = real[k];
+		if (imag)
 		{
-			header[i] = comment[i];
-			i++;
+			for (size_t i = 0; i < slice_size; i++)
+			{
+				interleaved[2 * i] = real[k][i];
+				interleaved[2 * i + 1] = imag[k][i];
+			}
+			data = interleaved.data();
 		}
-		while (i < 124)
+
+		hsize_t const start[3] = {static_cast<hsize_t>(k), 0, 0};
+		H5Sselect_hyperslab(filespace, H5S_SELECT_SET, start, nullptr, count, nullptr);
+		ok = H5Dwrite(dataset, type, memspace, filespace, H5P_DEFAULT, data) >= 0;
+
+		if (progress)
 		{
-			header[i] = ' ';
-			i++;
+			// the steps count real and imaginary slices, as for level 5 files
+			progress->Increment();
+			if (imag)
+				progress->Increment();
+			ok = ok && !progress->WasCanceled();
 		}
-		header[124] = 0;
-		header[125] = 1;
-		header[126] = 'I';
-		header[127] = 'M';
 	}
+	H5Sclose(memspace);
+	H5Sclose(filespace);
+	H5Tclose(type);
+	if (dataset >= 0)
+		H5Dclose(dataset);
+	ok = H5Fclose(file) >= 0 && ok;
 
-	fwrite(header, 128, 1, fp);
-	std::int32_t val = 14;
-	fwrite(&val, 4, 1, fp);
-	int namefieldlength = varnamelength;
-	if (varnamelength % 8 != 0)
-		namefieldlength += 8 - varnamelength % 8;
-	int padding = 0;
-	if (nx * ny * nz % 8 != 0)
-		padding = 8 - nx * ny * nz % 8;
-	val = 56 + nx * ny * nz + namefieldlength + padding;
-	fwrite(&val, 4, 1, fp);
-	val = 6;
-	fwrite(&val, 4, 1, fp);
-	val = 8;
-	fwrite(&val, 4, 1, fp);
-	unsigned char c1 = 9;
-	fwrite(&c1, 1, 1, fp);
-	c1 = 0;
-	fwrite(&c1, 1, 1, fp);
-	fwrite(&c1, 1, 1, fp);
-	fwrite(&c1, 1, 1, fp);
-	val = 0;
-	fwrite(&val, 4, 1, fp);
-	val = 5;
-	fwrite(&val, 4, 1, fp);
-	val = 12;
-	fwrite(&val, 4, 1, fp);
-	val = nx;
-	fwrite(&val, 4, 1, fp);
-	val = ny;
-	fwrite(&val, 4, 1, fp);
-	val = nz;
-	fwrite(&val, 4, 1, fp);
-	val = 0;
-	fwrite(&val, 4, 1, fp);
-	val = 1;
-	fwrite(&val, 4, 1, fp);
-	val = varnamelength;
-	fwrite(&val, 4, 1, fp);
-	fwrite(varname, varnamelength, 1, fp);
-	c1 = 0;
-	for (int i = varnamelength; i % 8 != 0; i++)
-	{
-		fwrite(&c1, 1, 1, fp);
-	}
-	val = 2;
-	fwrite(&val, 4, 1, fp);
-	val = nx * ny * nz;
-	fwrite(&val, 4, 1, fp);
-	for (int i = 0; i < nz; i++)
+	if (ok)
 	{
-		fwrite(matrix[i], nx * ny, 1, fp);
+		std::fstream out(filename, std::ios::binary | std::ios::in | std::ios::out);
+		out << FileHeader("MATLAB 7.3 MAT-file, HDF5 schema 1.00 . " + comment, 2);
+		ok = out.good();
 	}
-	c1 = 0;
-	for (int i = nx * ny * nz; i % 8 != 0; i++)
-	{
-		fwrite(&c1, 1, 1, fp);
-	}
-	fclose(fp);
-	return true;
+	return ok;
 }
 
-#ifdef TISSUES_SIZE_TYPEDEF
-bool matexport::print_mat(const char* filename, tissues_size_t* matrix, int nx, int ny, int nz, char* comment, int commentlength, char* varname, int varnamelength)
+template<typename T>
+bool WriteMat(const char* filename, const T* const* real, const T* const* imag, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength, ProgressInfo* progress)
 {
-	FILE* fp;
-	fp = fopen(filename, "wb");
-	if (fp == nullptr)
+	if (nx <= 0 || ny <= 0 || nz <= 0)
 		return false;
 
-	// Header
-	unsigned char header[128];
-	unsigned char i = 0;
-	while (i < 116 && i < commentlength)
-	{
-		header[i] = comment[i];
-		i++;
-	}
-	while (i < 124)
-	{
-		header[i] = ' ';
-		i++;
-	}
-	header[124] = 0;
-	header[125] = 1;
-	header[126] = 'I';
-	header[127] = 'M';
-	fwrite(header, 128, 1, fp);
-
-	// Data type: miMATRIX
-	std::int32_t val = 14;
-	fwrite(&val, 4, 1, fp);
-
-	// Number of bytes
-	int namefieldlength = varnamelength;
-	if (varnamelength % 8 != 0)
-		namefieldlength += 8 - varnamelength % 8;
-	int padding = 0;
-	if (nx * ny * nz * sizeof(tissues_size_t) % 8 != 0)
-		padding = 8 - nx * ny * nz * sizeof(tissues_size_t) % 8;
-	val =
-			56 + nx * ny * nz * sizeof(tissues_size_t) + namefieldlength + padding;
-	fwrite(&val, 4, 1, fp);
-
-	// Array flags
-	val = 6; // miUINT32
-	fwrite(&val, 4, 1, fp);
-	val = 8; // Number of bytes
-	fwrite(&val, 4, 1, fp);
-	unsigned char c1;
-	switch (sizeof(tissues_size_t))
-	{
-	case 1:
-		c1 = 9; // mxUINT8_CLASS
-		break;
-	case 2:
-		c1 = 11; // mxUINT16_CLASS
-		break;
-	default: return false;
-	}
-	fwrite(&c1, 1, 1, fp);
-	c1 = 0;
-	fwrite(&c1, 1, 1, fp);
-	fwrite(&c1, 1, 1, fp);
-	fwrite(&c1, 1, 1, fp);
-	val = 0;
-	fwrite(&val, 4, 1, fp);
-
-	// Dimensions array
-	val = 5; // miINT32
-	fwrite(&val, 4, 1, fp);
-	val = 12; // Number of bytes
-	fwrite(&val, 4, 1, fp);
-	val = nx;
-	fwrite(&val, 4, 1, fp);
-	val = ny;
-	fwrite(&val, 4, 1, fp);
-	val = nz;
-	fwrite(&val, 4, 1, fp);
-	val = 0;
-	fwrite(&val, 4, 1, fp);
-
-	// Array name
-	val = 1; // miINT8
-	fwrite(&val, 4, 1, fp);
-	val = varnamelength; // Number of bytes
-	fwrite(&val, 4, 1, fp);
-	fwrite(varname, varnamelength, 1, fp);
-	c1 = 0;
-	for (int i = varnamelength; i % 8 != 0; i++)
-	{
-		fwrite(&c1, 1, 1, fp);
-	}
+	std::string const comment_str(comment, comment + commentlength);
+	std::string const varname_str(varname, varname + varnamelength);
+	if (progress)
+		progress->SetNumberOfSteps(imag ? 2 * nz : nz);
 
-	// Real part
-	switch (sizeof(tissues_size_t))
+	std::uint64_t const bytes = static_cast<std::uint64_t>(nx) * ny * nz * sizeof(T) * (imag ? 2 : 1);
+	bool const ok = (bytes + 128 <= max_level5_bytes) ? WriteLevel5(filename, real, imag, nx, ny, nz, comment_str, varname_str, progress)
+																										: WriteV73(filename, real, imag, nx, ny, nz, comment_str, varname_str, progress);
+	if (!ok)
 	{
-	case 1:
-		val = 2; // miUINT8
-		break;
-	case 2:
-		val = 4; // miUINT16
-		break;
-	default: return false;
+		ISEG_ERROR("could not write " << filename);
+		boost::system::error_code ec;
+		boost::filesystem::remove(filename, ec);
 	}
-	fwrite(&val, 4, 1, fp);
-	val = nx * ny * nz * sizeof(tissues_size_t);
-	fwrite(&val, 4, 1, fp); // Number of bytes
-	fwrite(matrix, nx * ny * nz * sizeof(tissues_size_t), 1, fp);
-	c1 = 0;
-	for (int i = nx * ny * nz * sizeof(tissues_size_t); i % 8 != 0; i++)
+	return ok;
+}
+
+/// Slices of a contiguous volume
+template<typename T>
+std::vector<const T*> Slices(const T* matrix, int nx, int ny, int nz)
+{
+	std::vector<const T*> slices(nz);
+	for (int k = 0; k < nz; k++)
 	{
-		fwrite(&c1, 1, 1, fp);
+		slices[k] = matrix + static_cast<size_t>(k) * nx * ny;
 	}
+	return slices;
+}
+
+} // namespace
 
-	fclose(fp);
-	return true;
+void matexport::set_max_level5_bytes(std::uint64_t bytes)
+{
+	max_level5_bytes = std::min(bytes, kMaxLevel5Bytes);
 }
-bool matexport::print_matslices(const char* filename, tissues_size_t** matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength)
+
+bool matexport::print_mat(const char* filename, float* matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength, bool complex)
 {
-	FILE* fp;
-	fp = fopen(filename, "wb");
-	if (fp == nullptr)
-		return false;
+	auto const real = Slices<float>(matrix, nx, ny, nz);
+	auto const imag = complex ? Slices<float>(matrix + static_cast<size_t>(nx) * ny * nz, nx, ny, nz) : std::vector<const float*>();
+	return WriteMat<float>(filename, real.data(), complex ? imag.data() : nullptr, nx, ny, nz, comment, commentlength, varname, varnamelength, nullptr);
+}
 
-	// Header
-	unsigned char header[128];
-	unsigned char i = 0;
-	while (i < 116 && i < commentlength)
-	{
-		header[i] = comment[i];
-		i++;
-	}
-	while (i < 124)
-	{
-		header[i] = ' ';
-		i++;
-	}
-	header[124] = 0;
-	header[125] = 1;
-	header[126] = 'I';
-	header[127] = 'M';
-	fwrite(header, 128, 1, fp);
-
-	// Data type: miMATRIX
-	std::int32_t val = 14;
-	fwrite(&val, 4, 1, fp);
-
-	// Number of bytes
-	int namefieldlength = varnamelength;
-	if (varnamelength % 8 != 0)
-		namefieldlength += 8 - varnamelength % 8;
-	int padding = 0;
-	if (nx * ny * nz * sizeof(tissues_size_t) % 8 != 0)
-		padding = 8 - nx * ny * nz * sizeof(tissues_size_t) % 8;
-	val =
-			56 + nx * ny * nz * sizeof(tissues_size_t) + namefieldlength + padding;
-	fwrite(&val, 4, 1, fp);
-
-	// Array flags
-	val = 6; // miUINT32
-	fwrite(&val, 4, 1, fp);
-	val = 8; // Number of bytes
-	fwrite(&val, 4, 1, fp);
-	unsigned char c1;
-	switch (sizeof(tissues_size_t))
-	{
-	case 1:
-		c1 = 9; // mxUINT8_CLASS
-		break;
-	case 2:
-		c1 = 11; // mxUINT16_CLASS
-		break;
-	default: return false;
-	}
-	fwrite(&c1, 1, 1, fp);
-	c1 = 0;
-	fwrite(&c1, 1, 1, fp);
-	fwrite(&c1, 1, 1, fp);
-	fwrite(&c1, 1, 1, fp);
-	val = 0;
-	fwrite(&val, 4, 1, fp);
-
-	// Dimensions array
-	val = 5; // miINT32
-	fwrite(&val, 4, 1, fp);
-	val = 12; // Number of bytes
-	fwrite(&val, 4, 1, fp);
-	val = nx;
-	fwrite(&val, 4, 1, fp);
-	val = ny;
-	fwrite(&val, 4, 1, fp);
-	val = nz;
-	fwrite(&val, 4, 1, fp);
-	val = 0;
-	fwrite(&val, 4, 1, fp);
-
-	// Array name
-	val = 1; // miINT8
-	fwrite(&val, 4, 1, fp);
-	val = varnamelength; // Number of bytes
-	fwrite(&val, 4, 1, fp);
-	fwrite(varname, varnamelength, 1, fp);
-	c1 = 0;
-	for (int i = varnamelength; i % 8 != 0; i++)
-	{
-		fwrite(&c1, 1, 1, fp);
-	}
+bool matexport::print_matslices(const char* filename, float** matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength, bool complex, ProgressInfo* progress)
+{
+	return WriteMat<float>(filename, matrix, complex ? matrix + nz : nullptr, nx, ny, nz, comment, commentlength, varname, varnamelength, progress);
+}
 
-	// Real part
-	switch (sizeof(tissues_size_t))
-	{
-	case 1:
-		val = 2; // miUINT8
-		break;
-	case 2:
-		val = 4; // miUINT16
-		break;
-	default: return false;
-	}
-	fwrite(&val, 4, 1, fp);
-	val = nx * ny * nz * sizeof(tissues_size_t);
-	fwrite(&val, 4, 1, fp); // Number of bytes
-	for (int i = 0; i < nz; i++)
-	{
-		fwrite(matrix[i], nx * ny * sizeof(tissues_size_t), 1, fp);
-	}
-	c1 = 0;
-	for (int i = nx * ny * nz * sizeof(tissues_size_t); i % 8 != 0; i++)
-	{
-		fwrite(&c1, 1, 1, fp);
-	}
-	fclose(fp);
-	return true;
+bool matexport::print_mat(const char* filename, unsigned char* matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength)
+{
+	auto const slices = Slices<unsigned char>(matrix, nx, ny, nz);
+	return WriteMat<unsigned char>(filename, slices.data(), nullptr, nx, ny, nz, comment, commentlength, varname, varnamelength, nullptr);
+}
+
+bool matexport::print_matslices(const char* filename, unsigned char** matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength, ProgressInfo* progress)
+{
+	return WriteMat<unsigned char>(filename, matrix, nullptr, nx, ny, nz, comment, commentlength, varname, varnamelength, progress);
+}
+
+#ifdef TISSUES_SIZE_TYPEDEF
+bool matexport::print_mat(const char* filename, tissues_size_t* matrix, int nx, int ny, int nz, char* comment, int commentlength, char* varname, int varnamelength)
+{
+	auto const slices = Slices<tissues_size_t>(matrix, nx, ny, nz);
+	return WriteMat<tissues_size_t>(filename, slices.data(), nullptr, nx, ny, nz, comment, commentlength, varname, varnamelength, nullptr);
+}
+
+bool matexport::print_matslices(const char* filename, tissues_size_t** matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength, ProgressInfo* progress)
+{
+	return WriteMat<tissues_size_t>(filename, matrix, nullptr, nx, ny, nz, comment, commentlength, varname, varnamelength, progress);
 }
 #endif // TISSUES_SIZE_TYPEDEF
 
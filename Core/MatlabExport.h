@@ -13,18 +13,41 @@
 
 #include "Data/Types.h"
 
-namespace iseg { namespace matexport {
+#include <cstdint>
+
+namespace iseg {
+
+class ProgressInfo;
+
+/** \brief Export of volumes as MAT-files
+
+	Variables of up to 2 GB are written as compressed level 5 MAT-files (MATLAB -v7), where the
+	slices are streamed through a deflate running on all cores. Larger variables are written as
+	MAT-files of version 7.3, i.e. HDF5 files with one compressed chunk per slice. The functions
+	share no state, such that they can run on a worker thread, but v7.3 files are written with
+	HDF5, which must not be used by another thread meanwhile. The progress is incremented for
+	each slice written, and the file is removed if the export is canceled.
+
+	For complex data, the imaginary part follows the real part, i.e. for print_matslices the
+	imaginary part of slice i is matrix[nz + i].
+*/
+namespace matexport {
+
+/// Variables larger than this are written as v7.3 MAT-files, at most 2 GB, e.g. lowered to test the v7.3 writer
+ISEG_CORE_API void set_max_level5_bytes(std::uint64_t bytes);
 
 ISEG_CORE_API bool print_mat(const char* filename, float* matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength, bool complex = false);
-ISEG_CORE_API bool print_matslices(const char* filename, float** matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength, bool complex = false);
+ISEG_CORE_API bool print_matslices(const char* filename, float** matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength, bool complex = false, ProgressInfo* progress = nullptr);
 ISEG_CORE_API bool print_mat(const char* filename, unsigned char* matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength);
-ISEG_CORE_API bool print_matslices(const char* filename, unsigned char** matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength);
+ISEG_CORE_API bool print_matslices(const char* filename, unsigned char** matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength, ProgressInfo* progress = nullptr);
 
 #ifdef TISSUES_SIZE_TYPEDEF
 
 ISEG_CORE_API bool print_mat(const char* filename, tissues_size_t* matrix, int nx, int ny, int nz, char* comment, int commentlength, char* varname, int varnamelength);
-ISEG_CORE_API bool print_matslices(const char* filename, tissues_size_t** matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength);
+ISEG_CORE_API bool print_matslices(const char* filename, tissues_size_t** matrix, int nx, int ny, int nz, const char* comment, int commentlength, const char* varname, int varnamelength, ProgressInfo* progress = nullptr);
 
 #endif // TISSUES_SIZE_TYPEDEF
 
-}} // namespace iseg::matexport
+} // namespace matexport
+
+} // namespace iseg
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include "Precompiled.h"
+
+#include "ParallelGzip.h"
+
+#include "Data/Logger.h"
+
+#include <itk_zlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace iseg {
+
+namespace {
+
+// maximum distance of a back reference in a deflate stream
+size_t const kWindowSize = 32 * 1024;
+
+using buffer_type = std::vector<Bytef>;
+
+/// Raw deflate of one block, ending with a sync flush, or with the final block if last is set
+bool DeflateBlock(const buffer_type& in, const Bytef* dictionary, size_t dictionary_size, int level, bool last, buffer_type& out)
+{
+	z_stream strm = {};
+	if (deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	bool ok = dictionary_size == 0 || deflateSetDictionary(&strm, dictionary, static_cast<uInt>(dictionary_size)) == Z_OK;
+
+	// the bound does not account for the empty stored block of the sync flush
+	out.resize(deflateBound(&strm, static_cast<uLong>(in.size())) + 16);
+	strm.next_in = const_cast<Bytef*>(in.data());
+	strm.avail_in = static_cast<uInt>(in.size());
+	strm.next_out = out.data();
+	strm.avail_out = static_cast<uInt>(out.size());
+
+	if (ok)
+	{
+		int const ret = deflate(&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+		ok = last ? (ret == Z_STREAM_END) : (ret == Z_OK && strm.avail_in == 0 && strm.avail_out != 0);
+	}
+	out.resize(strm.total_out);
+	deflateEnd(&strm);
+	return ok;
+}
+
+void WriteLittleEndian(std::ostream& out, std::uint32_t value)
+{
+	char const bytes[4] = {static_cast<char>(value & 0xff), static_cast<char>((value >> 8) & 0xff), static_cast<char>((value >> 16) & 0xff), static_cast<char>((value >> 24) & 0xff)};
+	out.write(bytes, 4);
+}
+
+void WriteBigEndian(std::ostream& out, std::uint32_t value)
+{
+	char const bytes[4] = {static_cast<char>((value >> 24) & 0xff), static_cast<char>((value >> 16) & 0xff), static_cast<char>((value >> 8) & 0xff), static_cast<char>(value & 0xff)};
+	out.write(bytes, 4);
+}
+
+} // namespace
+
+ParallelGzip::ParallelGzip(eFormat format, int level, unsigned num_threads)
+		: m_Format(format), m_Level(std::min(std::max(level, 1), 9)), m_NumThreads(num_threads)
+{
+	if (m_NumThreads == 0)
+		m_NumThreads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool ParallelGzip::Compress(std::istream& in, std::ostream& out) const
+{
+	bool const gzip = (m_Format == kGzip);
+	if (gzip)
+	{
+		// no file name and no modification time, operating system unknown
+		char const header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'};
+		out.write(header, 10);
+	}
+	else
+	{
+		unsigned const cmf = 0x78;
+		unsigned flg = (m_Level == 1 ? 0 : m_Level < 6 ? 1 : m_Level == 6 ? 2 : 3) << 6;
+		flg += 31 - (cmf * 256 + flg) % 31;
+		char const header[2] = {static_cast<char>(cmf), static_cast<char>(flg)};
+		out.write(header, 2);
+	}
+
+	size_t const batch_size = 2 * static_cast<size_t>(m_NumThreads);
+	std::vector<buffer_type> input(batch_size), output(batch_size);
+	std::vector<uLong> checks(batch_size);
+	buffer_type dictionary;
+
+	uLong check = gzip ? crc32(0L, Z_NULL, 0) : adler32(0L, Z_NULL, 0);
+	std::uint64_t total = 0;
+	bool last = false;
+	while (!last)
+	{
+		int n = 0;
+		while (n < static_cast<int>(batch_size) && !last)
+		{
+			auto& block = input[n++];
+			block.resize(kBlockSize);
+			in.read(reinterpret_cast<char*>(block.data()), kBlockSize);
+			block.resize(static_cast<size_t>(in.gcount()));
+			last = block.size() < kBlockSize || in.peek() == std::char_traits<char>::eof();
+		}
+		if (in.bad())
+		{
+			ISEG_ERROR_MSG("could not read data to compress");
+			return false;
+		}
+
+		int failed = 0;
+#pragma omp parallel for schedule(dynamic) num_threads(m_NumThreads) reduction(+ : failed)
+		for (int i = 0; i < n; i++)
+		{
+			const auto& block = input[i];
+			const buffer_type& previous = (i == 0) ? dictionary : input[i - 1];
+			size_t const dictionary_size = std::min(previous.size(), kWindowSize);
+			if (!DeflateBlock(block, previous.data() + previous.size() - dictionary_size, dictionary_size, m_Level, last && i + 1 == n, output[i]))
+			{
+				failed++;
+			}
+			checks[i] = gzip ? crc32(crc32(0L, Z_NULL, 0), block.data(), static_cast<uInt>(block.size()))
+											 : adler32(adler32(0L, Z_NULL, 0), block.data(), static_cast<uInt>(block.size()));
+		}
+		if (failed != 0)
+		{
+			ISEG_ERROR_MSG("deflate failed");
+			return false;
+		}
+
+		for (int i = 0; i < n; i++)
+		{
+			out.write(reinterpret_cast<const char*>(output[i].data()), output[i].size());
+			check = gzip ? crc32_combine(check, checks[i], static_cast<z_off_t>(input[i].size()))
+									 : adler32_combine(check, checks[i], static_cast<z_off_t>(input[i].size()));
+			total += input[i].size();
+		}
+
+		const auto& tail = input[n - 1];
+		size_t const tail_size = std::min(tail.size(), kWindowSize);
+		dictionary.assign(tail.end() - tail_size, tail.end());
+	}
+
+	if (gzip)
+	{
+		WriteLittleEndian(out, static_cast<std::uint32_t>(check));
+		WriteLittleEndian(out, static_cast<std::uint32_t>(total & 0xffffffff));
+	}
+	else
+	{
+		WriteBigEndian(out, static_cast<std::uint32_t>(check));
+	}
+	return out.good();
+}
+
+bool ParallelGzip::CompressFile(const std::string& src, const std::string& dst) const
+{
+	std::ifstream in(src, std::ios::binary);
+	std::ofstream out(dst, std::ios::binary | std::ios::trunc);
+	if (!in || !out)
+	{
+		ISEG_ERROR("could not open " << (!in ? src : dst));
+		return false;
+	}
+	return Compress(in, out);
+}
+
+} // namespace iseg
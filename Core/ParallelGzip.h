@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include "iSegCore.h"
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace iseg {
+
+/** \brief Deflate compression of large files on all cores
+
+	The input is split into blocks of kBlockSize bytes which are deflated independently, each
+	primed with the last 32 kB of the previous block, and concatenated into a single gzip or
+	zlib stream, like pigz does. All blocks but the last end with a sync flush, such that the
+	concatenation is a valid deflate stream, and the checksum is combined from the checksums of
+	the blocks. The output can be read by any gzip/zlib reader, e.g. the NIfTI and MetaImage IO.
+	Only two blocks per thread are held in memory.
+*/
+class ISEG_CORE_API ParallelGzip
+{
+public:
+	enum eFormat {
+		kGzip = 0,
+		kZlib = 1
+	};
+
+	static size_t const kBlockSize = 1024 * 1024;
+
+	/// level is the zlib compression level, num_threads = 0 uses all cores
+	ParallelGzip(eFormat format = kGzip, int level = 6, unsigned num_threads = 0);
+
+	/// Compresses everything from the current position of in up to its end into out
+	bool Compress(std::istream& in, std::ostream& out) const;
+
+	/// Compresses the file src into the file dst
+	bool CompressFile(const std::string& src, const std::string& dst) const;
+
+private:
+	eFormat m_Format;
+	int m_Level;
+	unsigned m_NumThreads;
+};
+
+} // namespace iseg
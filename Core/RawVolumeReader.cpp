@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include "Precompiled.h"
+
+#include "RawVolumeReader.h"
+
+#include "Data/Logger.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace iseg {
+
+namespace ipc = boost::interprocess;
+
+struct RawVolumeReader::Mapping
+{
+	ipc::file_mapping m_File;
+	ipc::mapped_region m_Region;
+};
+
+RawVolumeReader::RawVolumeReader(const std::string& filename, unsigned width, unsigned height, unsigned bitdepth)
+		: m_Width(width), m_Height(height)
+{
+	unsigned const bytedepth = (bitdepth + 7) / 8;
+	if (bytedepth == 1 || bytedepth == 2 || bitdepth == 32)
+	{
+		m_Bytes = bytedepth;
+	}
+	else
+	{
+		ISEG_ERROR("unsupported bit depth " << bitdepth << " of raw file " << filename);
+		return;
+	}
+
+	// an empty file cannot be mapped
+	boost::system::error_code ec;
+	if (width == 0 || height == 0 || boost::filesystem::file_size(filename, ec) == 0 || ec)
+	{
+		return;
+	}
+
+	try
+	{
+		auto mapping = std::make_unique<Mapping>();
+		mapping->m_File = ipc::file_mapping(filename.c_str(), ipc::read_only);
+		mapping->m_Region = ipc::mapped_region(mapping->m_File, ipc::read_only);
+		m_Data = static_cast<const char*>(mapping->m_Region.get_address());
+		m_Size = mapping->m_Region.get_size();
+		m_Mapping = std::move(mapping);
+	}
+	catch (const ipc::interprocess_exception& e)
+	{
+		ISEG_ERROR("could not map raw file " << filename << ": " << e.what());
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+}
+
+RawVolumeReader::~RawVolumeReader() = default;
+
+unsigned RawVolumeReader::NumSlices() const
+{
+	size_t const slice_bytes = static_cast<size_t>(m_Width) * m_Height * m_Bytes;
+	return Valid() ? static_cast<unsigned>(std::min<size_t>(m_Size / slice_bytes, std::numeric_limits<unsigned>::max())) : 0;
+}
+
+bool RawVolumeReader::Read(float** slices, unsigned first, unsigned nrslices) const
+{
+	Point p;
+	p.px = p.py = 0;
+	return Read(slices, first, nrslices, p, m_Width, m_Height);
+}
+
+bool RawVolumeReader::Read(float** slices, unsigned first, unsigned nrslices, Point p, unsigned dx, unsigned dy) const
+{
+	if (!Valid() || p.px < 0 || p.py < 0 || p.px + static_cast<size_t>(dx) > m_Width || p.py + static_cast<size_t>(dy) > m_Height ||
+			static_cast<size_t>(first) + nrslices > NumSlices())
+	{
+		return false;
+	}
+
+	size_t const area = static_cast<size_t>(m_Width) * m_Height;
+	// the rows of full-width regions are contiguous
+	size_t const run = (dx == m_Width) ? static_cast<size_t>(dx) * dy : dx;
+	unsigned const nruns = (dx == m_Width) ? 1 : dy;
+
+	int const n = static_cast<int>(nrslices);
+#pragma omp parallel for schedule(dynamic)
+	for (int k = 0; k < n; k++)
+	{
+		float* out = slices[k];
+		if (out == nullptr)
+			continue;
+
+		for (unsigned y = 0; y < nruns; y++)
+		{
+			size_t const offset = (first + k) * area + (p.py + static_cast<size_t>(y)) * m_Width + p.px;
+			const char* in = m_Data + offset * m_Bytes;
+			if (m_Bytes == 1)
+				Convert(reinterpret_cast<const unsigned char*>(in), out + y * run, run);
+			else if (m_Bytes == 2)
+				Convert(reinterpret_cast<const unsigned short*>(in), out + y * run, run);
+			else
+				Convert(reinterpret_cast<const float*>(in), out + y * run, run);
+		}
+	}
+	return true;
+}
+
+const float* RawVolumeReader::Slice(unsigned slicenr) const
+{
+	if (m_Bytes != 4 || slicenr >= NumSlices())
+		return nullptr;
+	return reinterpret_cast<const float*>(m_Data) + static_cast<size_t>(slicenr) * m_Width * m_Height;
+}
+
+void RawVolumeReader::Convert(const unsigned char* in, float* out, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		out[i] = static_cast<float>(in[i]);
+	}
+}
+
+void RawVolumeReader::Convert(const unsigned short* in, float* out, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		out[i] = static_cast<float>(in[i]);
+	}
+}
+
+void RawVolumeReader::Convert(const float* in, float* out, size_t n)
+{
+	std::copy(in, in + n, out);
+}
+
+} // namespace iseg
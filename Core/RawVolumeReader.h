@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include "iSegCore.h"
+
+#include "Data/Point.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace iseg {
+
+/** \brief Reads slices of a raw volume through a read-only memory mapping
+
+	The file holds width x height voxels per slice, stored as 8 or 16 bit unsigned
+	integers or as 32 bit floats in native byte order. Read converts a range of slices,
+	optionally a subregion of each slice, to float on all cores. The slices of a float
+	file can also be used in place through Slice(), i.e. without any copy.
+*/
+class ISEG_CORE_API RawVolumeReader
+{
+public:
+	/// bitdepth 1-8 and 9-16 are unsigned integers, 32 is float
+	RawVolumeReader(const std::string& filename, unsigned width, unsigned height, unsigned bitdepth);
+	~RawVolumeReader();
+
+	RawVolumeReader(const RawVolumeReader&) = delete;
+	RawVolumeReader& operator=(const RawVolumeReader&) = delete;
+
+	/// false if the file could not be mapped or the bit depth is not supported
+	bool Valid() const { return m_Data != nullptr; }
+	/// Number of complete slices in the file
+	unsigned NumSlices() const;
+
+	/// Converts the slices [first, first + nrslices) into the buffers, which hold width x height voxels. Null buffers are skipped.
+	bool Read(float** slices, unsigned first, unsigned nrslices) const;
+	/// Same for the dx x dy voxels starting at p, which must lie within the slice
+	bool Read(float** slices, unsigned first, unsigned nrslices, Point p, unsigned dx, unsigned dy) const;
+
+	/// The slice inside the mapping, valid as long as the reader. nullptr unless the file holds floats.
+	const float* Slice(unsigned slicenr) const;
+
+	/// Conversion of n contiguous values, written such that the compiler vectorizes them
+	static void Convert(const unsigned char* in, float* out, size_t n);
+	static void Convert(const unsigned short* in, float* out, size_t n);
+	static void Convert(const float* in, float* out, size_t n);
+
+private:
+	struct Mapping;
+
+	unsigned m_Width;
+	unsigned m_Height;
+	unsigned m_Bytes = 0;
+	std::unique_ptr<Mapping> m_Mapping;
+	const char* m_Data = nullptr;
+	size_t m_Size = 0;
+};
+
+} // namespace iseg
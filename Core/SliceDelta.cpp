@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include "Precompiled.h"
+
+#include "SliceDelta.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace iseg {
+
+namespace {
+
+// a run of unchanged bytes shorter than this is stored as part of the changed range
+const size_t k_MinGap = 8;
+// a repeating pattern shorter than this is stored as literal bytes
+const size_t k_MinRun = 16;
+const size_t k_Period = 4;
+
+enum eFormat : std::uint8_t {
+	kSparse = 0,
+	kFull = 1
+};
+
+void PutVarint(std::vector<std::uint8_t>& data, size_t v)
+{
+	while (v >= 0x80)
+	{
+		data.push_back(static_cast<std::uint8_t>(v | 0x80));
+		v >>= 7;
+	}
+	data.push_back(static_cast<std::uint8_t>(v));
+}
+
+size_t GetVarint(const std::uint8_t*& p)
+{
+	size_t v = 0;
+	for (unsigned shift = 0;; shift += 7)
+	{
+		std::uint8_t const b = *p++;
+		v |= static_cast<size_t>(b & 0x7f) << shift;
+		if ((b & 0x80) == 0)
+			return v;
+	}
+}
+
+} // namespace
+
+void SliceDelta::Encode(const void* before, const void* after, size_t bytes)
+{
+	const std::uint8_t* a = static_cast<const std::uint8_t*>(before);
+	const std::uint8_t* b = static_cast<const std::uint8_t*>(after);
+	auto x = [a, b](size_t k) { return static_cast<std::uint8_t>(a[k] ^ b[k]); };
+
+	m_Data.clear();
+	m_Data.push_back(kSparse);
+	size_t last_end = 0;
+	size_t i = 0;
+	while (i < bytes)
+	{
+		// skip unchanged data a word at a time
+		while (i + 8 <= bytes && std::memcmp(a + i, b + i, 8) == 0)
+			i += 8;
+		while (i < bytes && a[i] == b[i])
+			++i;
+		if (i == bytes)
+			break;
+
+		size_t const start = i;
+		size_t end = i + 1;
+		for (++i; i < bytes && i - end < k_MinGap; ++i)
+		{
+			if (a[i] != b[i])
+				end = i + 1;
+		}
+
+		// split the changed range into literal bytes and runs of a repeating pattern
+		size_t skip = start - last_end;
+		size_t literal = start;
+		size_t k = start;
+		while (k < end)
+		{
+			size_t j = k + k_Period;
+			while (j < end && x(j) == x(j - k_Period))
+				++j;
+			if (j - k < k_MinRun)
+			{
+				++k;
+				continue;
+			}
+
+			if (literal < k)
+			{
+				PutVarint(m_Data, skip);
+				PutVarint(m_Data, (k - literal) << 1);
+				for (size_t m = literal; m < k; ++m)
+					m_Data.push_back(x(m));
+				skip = 0;
+			}
+			PutVarint(m_Data, skip);
+			PutVarint(m_Data, ((j - k) << 1) | 1);
+			for (size_t m = k; m < k + k_Period; ++m)
+				m_Data.push_back(x(m));
+			skip = 0;
+			literal = k = j;
+		}
+		if (literal < end)
+		{
+			PutVarint(m_Data, skip);
+			PutVarint(m_Data, (end - literal) << 1);
+			for (size_t m = literal; m < end; ++m)
+				m_Data.push_back(x(m));
+		}
+		last_end = i = end;
+	}
+
+	if (m_Data.size() == 1)
+	{
+		m_Data.clear();
+	}
+	else if (m_Data.size() > bytes)
+	{
+		// e.g. a filter changed every voxel, the sparse format would only add overhead
+		m_Data.resize(bytes + 1);
+		m_Data[0] = kFull;
+		for (size_t m = 0; m < bytes; ++m)
+			m_Data[m + 1] = x(m);
+	}
+	m_Data.shrink_to_fit();
+}
+
+void SliceDelta::Apply(void* data) const
+{
+	if (m_Data.empty())
+		return;
+
+	std::uint8_t* out = static_cast<std::uint8_t*>(data);
+	const std::uint8_t* p = m_Data.data() + 1;
+	const std::uint8_t* const p_end = m_Data.data() + m_Data.size();
+	if (m_Data[0] == kFull)
+	{
+		while (p < p_end)
+		{
+			*out++ ^= *p++;
+		}
+		return;
+	}
+
+	while (p < p_end)
+	{
+		out += GetVarint(p);
+		size_t const header = GetVarint(p);
+		size_t const len = header >> 1;
+		if (header & 1)
+		{
+			for (size_t k = 0; k < len; ++k)
+			{
+				*out++ ^= p[k % k_Period];
+			}
+			p += k_Period;
+		}
+		else
+		{
+			for (size_t k = 0; k < len; ++k)
+			{
+				*out++ ^= *p++;
+			}
+		}
+	}
+}
+
+bool SliceDelta::Write(std::ostream& out) const
+{
+	std::uint64_t const size = m_Data.size();
+	out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+	out.write(reinterpret_cast<const char*>(m_Data.data()), m_Data.size());
+	return !out.fail();
+}
+
+bool SliceDelta::Read(std::istream& in)
+{
+	std::uint64_t size = 0;
+	if (!in.read(reinterpret_cast<char*>(&size), sizeof(size)))
+		return false;
+	m_Data.resize(size);
+	m_Data.shrink_to_fit();
+	return !in.read(reinterpret_cast<char*>(m_Data.data()), m_Data.size()).fail();
+}
+
+} // namespace iseg
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include "iSegCore.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace iseg {
+
+/** \brief Compressed difference between two versions of a slice
+
+	Stores the XOR of the two versions, skipping unchanged bytes. Since the XOR is
+	symmetric, applying the delta to either version yields the other one, i.e. the
+	same delta is used for undo and redo.
+
+	Repeating XOR patterns with a period of 4 bytes, e.g. a region filled with the
+	same float or tissue value, are run-length encoded. If the delta would still be
+	as large as the slice, the plain XOR of the whole slice is stored instead.
+*/
+class ISEG_CORE_API SliceDelta
+{
+public:
+	SliceDelta() = default;
+	SliceDelta(const void* before, const void* after, size_t bytes) { Encode(before, after, bytes); }
+
+	void Encode(const void* before, const void* after, size_t bytes);
+	/// Turns one version of the slice into the other
+	void Apply(void* data) const;
+
+	/// true if both versions are identical
+	bool Empty() const { return m_Data.empty(); }
+	size_t MemoryUsage() const { return m_Data.capacity(); }
+
+	/// Serialize, e.g. to move the delta out of memory
+	bool Write(std::ostream& out) const;
+	bool Read(std::istream& in);
+
+private:
+	/// format byte, followed by the XOR of the whole slice, or by a sequence of
+	/// (skip, header, payload). Skip and header are varints, header is (length << 1 | run).
+	/// The payload of a run is its 4 byte pattern, otherwise the 'length' xor-ed bytes.
+	std::vector<std::uint8_t> m_Data;
+};
+
+} // namespace iseg
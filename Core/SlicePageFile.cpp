@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include "Precompiled.h"
+
+#include "SlicePageFile.h"
+
+#include "HDF5Reader.h"
+
+#include "Data/Logger.h"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+
+namespace iseg {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const char* const k_Source = "Source";
+const char* const k_Target = "Target";
+const char* const k_Tissue = "Tissue";
+
+void HashBytes(std::uint64_t& h, const void* data, size_t bytes)
+{
+	if (data == nullptr)
+		return;
+
+	// FNV-1a over 8 byte words
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i + 8 <= bytes; i += 8)
+	{
+		std::uint64_t word;
+		std::copy(p + i, p + i + 8, reinterpret_cast<unsigned char*>(&word));
+		h = (h ^ word) * 1099511628211ull;
+	}
+	for (size_t i = bytes - bytes % 8; i < bytes; ++i)
+	{
+		h = (h ^ p[i]) * 1099511628211ull;
+	}
+}
+
+} // namespace
+
+SlicePageFile::SlicePageFile(unsigned width, unsigned height, unsigned nrslices)
+		: m_Width(width), m_Height(height), m_Stored(nrslices, false)
+{
+	boost::system::error_code ec;
+	auto path = fs::temp_directory_path(ec) / fs::unique_path("iseg-pages-%%%%-%%%%-%%%%.h5");
+	m_FileName = path.string();
+
+	// no compression, slices are paged in and out interactively
+	HDF5IO io(0);
+	io.m_ChunkSize = static_cast<int>(Area());
+	m_File = io.Create(m_FileName);
+	if (m_File < 0)
+	{
+		ISEG_ERROR("could not create page file " << m_FileName);
+		return;
+	}
+
+	// create the datasets without writing any data
+	bool ok = io.WriteData<float>(m_File, k_Source, nullptr, nrslices, Area());
+	ok = ok && io.WriteData<float>(m_File, k_Target, nullptr, nrslices, Area());
+	ok = ok && io.WriteData<tissues_size_t>(m_File, k_Tissue, nullptr, nrslices, Area());
+	if (!ok)
+	{
+		ISEG_ERROR("could not create datasets in page file " << m_FileName);
+		io.Close(m_File);
+		m_File = -1;
+	}
+}
+
+SlicePageFile::~SlicePageFile()
+{
+	ResetOrigin();
+	if (m_File >= 0)
+	{
+		HDF5IO().Close(m_File);
+	}
+	boost::system::error_code ec;
+	fs::remove(m_FileName, ec);
+}
+
+bool SlicePageFile::SetOrigin(const std::string& filename, const std::string& source, const std::string& target, const std::string& tissue)
+{
+	ResetOrigin();
+
+	auto reader = std::make_unique<HDF5Reader>();
+	if (!reader->Open(filename))
+		return false;
+
+	size_t const n = Area() * NumSlices();
+	auto matches = [&](const std::string& name, const std::string& expected_type) {
+		std::string type;
+		std::vector<HDF5Reader::size_type> dims;
+		if (!reader->Exists(name))
+			return true;
+		return reader->GetDatasetInfo(type, dims, name) && type == expected_type && HDF5Reader::TotalSize(dims) == n;
+	};
+	if (!matches(source, "float") || !matches(target, "float") || !matches(tissue, "unsigned short"))
+	{
+		ISEG_WARNING("cannot page slices from " << filename << ", datasets have an unexpected type or size");
+		return false;
+	}
+
+	m_OriginSource = reader->Exists(source) ? source : std::string();
+	m_OriginTarget = reader->Exists(target) ? target : std::string();
+	m_OriginTissue = reader->Exists(tissue) ? tissue : std::string();
+	m_Origin = std::move(reader);
+	std::fill(m_Stored.begin(), m_Stored.end(), false);
+	return true;
+}
+
+void SlicePageFile::ResetOrigin()
+{
+	if (m_Origin)
+	{
+		m_Origin->Close();
+		m_Origin.reset();
+	}
+}
+
+bool SlicePageFile::Contains(unsigned slicenr) const
+{
+	return slicenr < m_Stored.size() && (m_Stored[slicenr] || m_Origin);
+}
+
+bool SlicePageFile::Read(unsigned slicenr, float* bmp, float* work, tissues_size_t* tissues) const
+{
+	if (!Valid() || !Contains(slicenr))
+		return false;
+
+	size_t const area = Area();
+	size_t const offset = slicenr * area;
+	if (m_Stored[slicenr])
+	{
+		HDF5IO io;
+		return io.ReadData(m_File, k_Source, offset, area, bmp) &&
+					 io.ReadData(m_File, k_Target, offset, area, work) &&
+					 io.ReadData(m_File, k_Tissue, offset, area, tissues);
+	}
+
+	// datasets missing in the origin are initialized to 0, as when loading the file
+	bool ok = true;
+	if (m_OriginSource.empty())
+		std::fill(bmp, bmp + area, 0.f);
+	else
+		ok = ok && m_Origin->Read(bmp, offset, area, m_OriginSource);
+	if (m_OriginTarget.empty())
+		std::fill(work, work + area, 0.f);
+	else
+		ok = ok && m_Origin->Read(work, offset, area, m_OriginTarget);
+	if (m_OriginTissue.empty())
+		std::fill(tissues, tissues + area, 0);
+	else
+		ok = ok && m_Origin->Read(tissues, offset, area, m_OriginTissue);
+	return ok;
+}
+
+bool SlicePageFile::Write(unsigned slicenr, const float* bmp, const float* work, const tissues_size_t* tissues)
+{
+	if (!Valid() || slicenr >= m_Stored.size())
+		return false;
+
+	// HDF5IO only reads from the slices
+	float* bmp_slice = const_cast<float*>(bmp);
+	float* work_slice = const_cast<float*>(work);
+	tissues_size_t* tissue_slice = const_cast<tissues_size_t*>(tissues);
+
+	size_t const area = Area();
+	size_t const offset = slicenr * area;
+	HDF5IO io(0);
+	bool ok = io.WriteData(m_File, k_Source, &bmp_slice, 1, area, offset) &&
+						io.WriteData(m_File, k_Target, &work_slice, 1, area, offset) &&
+						io.WriteData(m_File, k_Tissue, &tissue_slice, 1, area, offset);
+	if (ok)
+	{
+		m_Stored[slicenr] = true;
+	}
+	return ok;
+}
+
+std::uint64_t SlicePageFile::Hash(const float* bmp, const float* work, const tissues_size_t* tissues, size_t area)
+{
+	std::uint64_t h = 14695981039346656037ull;
+	HashBytes(h, bmp, area * sizeof(float));
+	HashBytes(h, work, area * sizeof(float));
+	HashBytes(h, tissues, area * sizeof(tissues_size_t));
+	return h;
+}
+
+} // namespace iseg
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include "iSegCore.h"
+
+#include "HDF5IO.h"
+
+#include "Data/Types.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace iseg {
+
+class HDF5Reader;
+
+/** \brief Backing store for slices which are paged out of memory
+
+	Slices are written to a temporary HDF5 file with one chunk per slice. Slices
+	which have never been written are read from the origin, i.e. the Source,
+	Target and Tissue datasets of the HDF5 file the project was loaded from.
+*/
+class ISEG_CORE_API SlicePageFile
+{
+public:
+	/// Creates a temporary page file, which is deleted again in the destructor
+	SlicePageFile(unsigned width, unsigned height, unsigned nrslices);
+	~SlicePageFile();
+
+	SlicePageFile(const SlicePageFile&) = delete;
+	SlicePageFile& operator=(const SlicePageFile&) = delete;
+
+	bool Valid() const { return m_File >= 0; }
+	unsigned Width() const { return m_Width; }
+	unsigned Height() const { return m_Height; }
+	unsigned NumSlices() const { return static_cast<unsigned>(m_Stored.size()); }
+	const std::string& FileName() const { return m_FileName; }
+
+	/// Read all slices from these datasets, slices written before are discarded. Fails if the datasets don't match the volume.
+	bool SetOrigin(const std::string& filename, const std::string& source, const std::string& target, const std::string& tissue);
+	/// Forget the origin, e.g. because the file is about to be overwritten
+	void ResetOrigin();
+	bool HasOrigin() const { return m_Origin.get() != nullptr; }
+
+	/// true if the slice can be restored by Read
+	bool Contains(unsigned slicenr) const;
+	bool Read(unsigned slicenr, float* bmp, float* work, tissues_size_t* tissues) const;
+	bool Write(unsigned slicenr, const float* bmp, const float* work, const tissues_size_t* tissues);
+
+	/// Fingerprint of the slice content, used to detect modified slices. Null buffers are skipped.
+	static std::uint64_t Hash(const float* bmp, const float* work, const tissues_size_t* tissues, size_t area);
+
+private:
+	size_t Area() const { return static_cast<size_t>(m_Width) * m_Height; }
+
+	unsigned m_Width;
+	unsigned m_Height;
+	std::string m_FileName;
+	HDF5IO::handle_id_type m_File = -1;
+	std::vector<bool> m_Stored;
+
+	std::unique_ptr<HDF5Reader> m_Origin;
+	std::string m_OriginSource;
+	std::string m_OriginTarget;
+	std::string m_OriginTissue;
+};
+
+} // namespace iseg
@@ -12,6 +12,8 @@
 #include "SliceProvider.h"
 
 #include <cstdlib>
+#include <iostream>
+#include <map>
 
 namespace iseg {
 
@@ -19,56 +21,115 @@ SliceProvider::SliceProvider(unsigned area1) { m_Area = area1; }
 
 SliceProvider::~SliceProvider()
 {
-	while (!m_Slicestack.empty())
+	for (auto& shard : m_Shards)
 	{
-		free(m_Slicestack.top());
-		m_Slicestack.pop();
+		for (auto slice : shard.m_Slices)
+			free(slice);
 	}
 }
 
+unsigned SliceProvider::ThreadShard()
+{
+	static std::atomic<unsigned> next_shard{0};
+	thread_local unsigned shard = next_shard++ % k_NumShards;
+	return shard;
+}
+
+bool SliceProvider::Pop(unsigned shard, float*& slice)
+{
+	std::lock_guard<std::mutex> lock(m_Shards[shard].m_Mutex);
+	auto& slices = m_Shards[shard].m_Slices;
+	if (slices.empty())
+		return false;
+	slice = slices.back();
+	slices.pop_back();
+	return true;
+}
+
 float* SliceProvider::GiveMe()
 {
-	if (m_Slicestack.empty())
+	float* result = nullptr;
+	if (m_Pooled > 0)
 	{
-		return (float*)malloc(sizeof(float) * m_Area);
+		unsigned const own = ThreadShard();
+		for (unsigned i = 0; i < k_NumShards; ++i)
+		{
+			if (Pop((own + i) % k_NumShards, result))
+			{
+				--m_Pooled;
+				break;
+			}
+		}
 	}
-	else
+	if (result == nullptr)
+	{
+		result = (float*)malloc(sizeof(float) * m_Area);
+		if (result == nullptr)
+			return nullptr;
+	}
+
+	size_t const in_use = ++m_InUse;
+	size_t high = m_HighWaterMark;
+	while (in_use > high && !m_HighWaterMark.compare_exchange_weak(high, in_use))
 	{
-		float* result = m_Slicestack.top();
-		m_Slicestack.pop();
-		return result;
 	}
+	return result;
 }
 
 void SliceProvider::TakeBack(float* slice)
 {
 	if (slice != nullptr)
-		m_Slicestack.push(slice);
+	{
+		{
+			auto& shard = m_Shards[ThreadShard()];
+			std::lock_guard<std::mutex> lock(shard.m_Mutex);
+			shard.m_Slices.push_back(slice);
+		}
+		++m_Pooled;
+		// slices which were not handed out by this pool (e.g. merged) are not counted
+		size_t in_use = m_InUse;
+		while (in_use > 0 && !m_InUse.compare_exchange_weak(in_use, in_use - 1))
+		{
+		}
+	}
 }
 
 void SliceProvider::Merge(SliceProvider* sp)
 {
 	if (m_Area == sp->ReturnArea())
 	{
-		while (!m_Slicestack.empty())
-			sp->TakeBack(GiveMe());
+		for (auto& shard : m_Shards)
+		{
+			std::vector<float*> slices;
+			{
+				std::lock_guard<std::mutex> lock(shard.m_Mutex);
+				slices.swap(shard.m_Slices);
+			}
+			m_Pooled -= slices.size();
+			for (auto slice : slices)
+			{
+				sp->TakeBack(slice);
+			}
+		}
 	}
 }
 
 unsigned SliceProvider::ReturnArea() const { return m_Area; }
 
-unsigned short SliceProvider::ReturnNrslices()
+unsigned SliceProvider::ReturnNrslices() const
 {
-	return (unsigned short)m_Slicestack.size();
+	return (unsigned)m_Pooled;
 }
 
 SliceProviderInstaller* SliceProviderInstaller::inst = nullptr;
 
-unsigned short SliceProviderInstaller::counter = 0;
+std::atomic<unsigned> SliceProviderInstaller::counter{0};
 
 SliceProviderInstaller* SliceProviderInstaller::Getinst()
 {
 	static Waechter w;
+	static std::mutex inst_mutex;
+	std::lock_guard<std::mutex> lock(inst_mutex);
 	if (inst == nullptr)
 		inst = new SliceProviderInstaller;
 
@@ -87,6 +148,7 @@ bool SliceProviderInstaller::Unused() { return counter == 0; }
 
 SliceProvider* SliceProviderInstaller::Install(unsigned area1)
 {
+	std::lock_guard<std::mutex> lock(m_Mutex);
 	auto it = m_Splist.begin();
 
 	while (it != m_Splist.end() && (it->m_Area != area1))
@@ -110,6 +172,7 @@ SliceProvider* SliceProviderInstaller::Install(unsigned area1)
 
 void SliceProviderInstaller::Uninstall(SliceProvider* sp)
 {
+	std::lock_guard<std::mutex> lock(m_Mutex);
 	auto it = m_Splist.begin();
 	while (it != m_Splist.end() && (it->m_Area != sp->ReturnArea()))
 		it++;
@@ -129,7 +192,7 @@ SliceProviderInstaller::~SliceProviderInstaller()
 {
 	for (auto it = m_Splist.begin(); it != m_Splist.end(); it++)
 	{
-		free(it->m_Spp);
+		delete it->m_Spp;
 	}
 
 	inst = nullptr;
@@ -137,6 +200,7 @@ SliceProviderInstaller::~SliceProviderInstaller()
 
 void SliceProviderInstaller::Report() const
 {
+	std::lock_guard<std::mutex> lock(m_Mutex);
 	std::map<int, int> area_counts;
 	std::map<int, int> area_counts_empty;
 	for (auto sp : m_Splist)
@@ -157,6 +221,13 @@ void SliceProviderInstaller::Report() const
 	{
 		std::cerr << "area=" << v.first << " -> " << v.second << "\n";
 	}
+	for (const auto& sp : m_Splist)
+	{
+		if (sp.m_Installnr && sp.m_Spp)
+		{
+			std::cerr << "area=" << sp.m_Area << " in use=" << sp.m_Spp->InUse() << " high water mark=" << sp.m_Spp->HighWaterMark() << "\n";
+		}
+	}
 	std::cerr << "Debug: dead sliceproviders\n";
 	for (auto v : area_counts_empty)
 	{
@@ -11,33 +11,62 @@
 
 #include "iSegCore.h"
 
+#include <atomic>
 #include <cstdlib>
 #include <list>
-#include <stack>
+#include <mutex>
+#include <vector>
 
 namespace iseg {
 
+/** \brief Pool of slice buffers with a fixed area
+
+	The pool can be used concurrently, e.g. by slice filters running in an OpenMP loop.
+	Returned slices are kept in a small number of shards, each with its own lock. A thread
+	uses the shard assigned to it and only looks into the other shards if its own is empty,
+	i.e. threads rarely contend for the same lock.
+*/
 class ISEG_CORE_API SliceProvider
 {
 public:
 	SliceProvider(unsigned area1);
 	~SliceProvider();
 	unsigned ReturnArea() const;
-	unsigned short ReturnNrslices();
+	/// Number of pooled slices
+	unsigned ReturnNrslices() const;
 	float* GiveMe();
 	void Merge(SliceProvider* sp);
 	void TakeBack(float* slice);
 
+	/// Number of slices currently handed out by GiveMe
+	size_t InUse() const { return m_InUse; }
+	/// Maximum number of slices handed out at the same time
+	size_t HighWaterMark() const { return m_HighWaterMark; }
+
 private:
+	static const unsigned k_NumShards = 16;
+
+	struct alignas(64) Shard
+	{
+		std::mutex m_Mutex;
+		std::vector<float*> m_Slices;
+	};
+
+	static unsigned ThreadShard();
+	bool Pop(unsigned shard, float*& slice);
+
 	unsigned m_Area;
-	std::stack<float*> m_Slicestack;
+	Shard m_Shards[k_NumShards];
+	std::atomic<size_t> m_Pooled{0};
+	std::atomic<size_t> m_InUse{0};
+	std::atomic<size_t> m_HighWaterMark{0};
 };
 
 struct Spobj
 {
 	unsigned m_Area;
 	SliceProvider* m_Spp;
-	unsigned short m_Installnr;
+	unsigned m_Installnr;
 };
 
 class ISEG_CORE_API SliceProviderInstaller
@@ -54,7 +83,8 @@ public:
 
 private:
 	static SliceProviderInstaller* inst;
-	static unsigned short counter;
+	static std::atomic<unsigned> counter;
+	mutable std::mutex m_Mutex;
 	std::list<Spobj> m_Splist;
 	bool m_DeleteUnused = true;
 	SliceProviderInstaller() = default;
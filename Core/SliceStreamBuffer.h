@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include "Data/ProgressInfo.h"
+
+#include <cstddef>
+#include <streambuf>
+#include <vector>
+
+namespace iseg {
+
+/** \brief Input stream buffer reading a sequence of memory pieces, e.g. a header followed by the slices of a volume
+
+	The pieces are not copied, e.g. to feed the slices to ParallelGzip. The progress is incremented
+	whenever a slice has been read, and if it is canceled the stream ends early.
+*/
+class SliceStreamBuffer : public std::streambuf
+{
+public:
+	SliceStreamBuffer(ProgressInfo* progress = nullptr) : m_Progress(progress) {}
+
+	void Add(const void* data, size_t size, bool slice = false) { m_Pieces.push_back({static_cast<const char*>(data), size, slice}); }
+
+	bool Canceled() const { return m_Canceled; }
+
+protected:
+	int_type underflow() override
+	{
+		while (gptr() == egptr())
+		{
+			if (m_Next > 0 && m_Pieces[m_Next - 1].m_Slice && m_Progress && !m_Counted)
+			{
+				m_Progress->Increment();
+				m_Canceled = m_Canceled || m_Progress->WasCanceled();
+			}
+			m_Counted = true;
+			if (m_Canceled || m_Next == m_Pieces.size())
+				return traits_type::eof();
+
+			const auto& piece = m_Pieces[m_Next++];
+			char* data = const_cast<char*>(piece.m_Data);
+			setg(data, data, data + piece.m_Size);
+			m_Counted = false;
+		}
+		return traits_type::to_int_type(*gptr());
+	}
+
+private:
+	struct Piece
+	{
+		const char* m_Data;
+		size_t m_Size;
+		bool m_Slice;
+	};
+	std::vector<Piece> m_Pieces;
+	size_t m_Next = 0;
+	bool m_Counted = false;
+	ProgressInfo* m_Progress;
+	bool m_Canceled = false;
+};
+
+} // namespace iseg
@@ -12,10 +12,38 @@
 #include "UndoElem.h"
 
 #include <cstdlib>
+#include <initializer_list>
+#include <iostream>
 #include <vector>
 
 namespace iseg {
 
+namespace {
+
+size_t Bytes(const std::vector<Point>& points)
+{
+	return points.capacity() * sizeof(Point);
+}
+
+size_t Bytes(const std::vector<Mark>& marks)
+{
+	size_t bytes = marks.capacity() * sizeof(Mark);
+	for (const auto& m : marks)
+		bytes += m.name.capacity();
+	return bytes;
+}
+
+template<typename T>
+size_t Bytes(const std::vector<std::vector<T>>& v)
+{
+	size_t bytes = v.capacity() * sizeof(std::vector<T>);
+	for (const auto& x : v)
+		bytes += Bytes(x);
+	return bytes;
+}
+
+} // namespace
+
 UndoElem::UndoElem()
 {
 	m_BmpOld = m_WorkOld = m_BmpNew = m_WorkNew = nullptr;
@@ -41,12 +69,16 @@ UndoElem::~UndoElem()
 
 void UndoElem::Merge(UndoElem* ue)
 {
+	// the images are moved from 'ue', the intermediate state in between is dropped
 	if (m_DataSelection.sliceNr == ue->m_DataSelection.sliceNr && !Multi())
 	{
 		if (ue->m_DataSelection.bmp)
 		{
 			if (m_DataSelection.bmp)
+			{
 				free(m_BmpNew);
+				free(ue->m_BmpOld);
+			}
 			else
 			{
 				m_BmpOld = ue->m_BmpOld;
@@ -54,11 +86,15 @@ void UndoElem::Merge(UndoElem* ue)
 			}
 			m_Mode1New = ue->m_Mode1New;
 			m_BmpNew = ue->m_BmpNew;
+			ue->m_BmpOld = ue->m_BmpNew = nullptr;
 		}
 		if (ue->m_DataSelection.work)
 		{
 			if (m_DataSelection.work)
+			{
 				free(m_WorkNew);
+				free(ue->m_WorkOld);
+			}
 			else
 			{
 				m_WorkOld = ue->m_WorkOld;
@@ -66,14 +102,19 @@ void UndoElem::Merge(UndoElem* ue)
 			}
 			m_Mode2New = ue->m_Mode2New;
 			m_WorkNew = ue->m_WorkNew;
+			ue->m_WorkOld = ue->m_WorkNew = nullptr;
 		}
 		if (ue->m_DataSelection.tissues)
 		{
 			if (m_DataSelection.tissues)
+			{
 				free(m_TissueNew);
+				free(ue->m_TissueOld);
+			}
 			else
 				m_TissueOld = ue->m_TissueOld;
 			m_TissueNew = ue->m_TissueNew;
+			ue->m_TissueOld = ue->m_TissueNew = nullptr;
 		}
 		if (ue->m_DataSelection.vvm)
 		{
@@ -121,30 +162,31 @@ void UndoElem::Merge(UndoElem* ue)
 		marks_new=ue->marks_new;*/
 }
 
-unsigned UndoElem::Arraynr()
+bool UndoElem::Multi() const
 {
-	unsigned i = 0;
-	const unsigned added = 1;
+	return false;
+}
 
-	if (m_DataSelection.bmp)
-	{
-		i += added;
-	}
-	if (m_DataSelection.work)
+size_t UndoElem::MemoryUsage() const
+{
+	size_t const image_bytes = m_Area * sizeof(float);
+	size_t const tissue_bytes = m_Area * sizeof(tissues_size_t);
+
+	size_t bytes = sizeof(*this);
+	for (const float* bits : {m_BmpOld, m_WorkOld, m_BmpNew, m_WorkNew})
 	{
-		i += added;
+		if (bits != nullptr)
+			bytes += image_bytes;
 	}
-	if (m_DataSelection.tissues)
+	for (const tissues_size_t* bits : {m_TissueOld, m_TissueNew})
 	{
-		i += added;
+		if (bits != nullptr)
+			bytes += tissue_bytes;
 	}
-
-	return i;
-}
-
-bool UndoElem::Multi() const
-{
-	return false;
+	bytes += Bytes(m_VvmOld) + Bytes(m_VvmNew);
+	bytes += Bytes(m_LimitsOld) + Bytes(m_LimitsNew);
+	bytes += Bytes(m_MarksOld) + Bytes(m_MarksNew);
+	return bytes;
 }
 
 MultiUndoElem::MultiUndoElem() = default;
@@ -170,25 +212,58 @@ MultiUndoElem::~MultiUndoElem()
 
 void MultiUndoElem::Merge(UndoElem* ue) {}
 
-unsigned MultiUndoElem::Arraynr()
+void MultiUndoElem::RemoveUnchanged()
 {
-	unsigned i = 0;
-	const unsigned added = 1;
+	// contours, limits and marks are not compared, slices with such data are kept
+	if (!m_Deltas || m_DataSelection.vvm || m_DataSelection.limits || m_DataSelection.marks)
+		return;
 
+	size_t n = 0;
+	for (size_t i = 0; i < m_Vslicenr.size(); ++i)
+	{
+		bool const changed = (m_DataSelection.bmp && (!m_VbmpDelta[i].Empty() || m_Vmode1Old[i] != m_Vmode1New[i])) ||
+												 (m_DataSelection.work && (!m_VworkDelta[i].Empty() || m_Vmode2Old[i] != m_Vmode2New[i])) ||
+												 (m_DataSelection.tissues && !m_VtissueDelta[i].Empty());
+		if (!changed)
+			continue;
+
+		m_Vslicenr[n] = m_Vslicenr[i];
+		if (m_DataSelection.bmp)
+		{
+			m_VbmpDelta[n] = std::move(m_VbmpDelta[i]);
+			m_Vmode1Old[n] = m_Vmode1Old[i];
+			m_Vmode1New[n] = m_Vmode1New[i];
+		}
+		if (m_DataSelection.work)
+		{
+			m_VworkDelta[n] = std::move(m_VworkDelta[i]);
+			m_Vmode2Old[n] = m_Vmode2Old[i];
+			m_Vmode2New[n] = m_Vmode2New[i];
+		}
+		if (m_DataSelection.tissues)
+		{
+			m_VtissueDelta[n] = std::move(m_VtissueDelta[i]);
+		}
+		++n;
+	}
+
+	m_Vslicenr.resize(n);
 	if (m_DataSelection.bmp)
 	{
-		i += added;
+		m_VbmpDelta.resize(n);
+		m_Vmode1Old.resize(n);
+		m_Vmode1New.resize(n);
 	}
 	if (m_DataSelection.work)
 	{
-		i += added;
+		m_VworkDelta.resize(n);
+		m_Vmode2Old.resize(n);
+		m_Vmode2New.resize(n);
 	}
 	if (m_DataSelection.tissues)
 	{
-		i += added;
+		m_VtissueDelta.resize(n);
 	}
-
-	return i * m_Vslicenr.size();
 }
 
 bool MultiUndoElem::Multi() const
@@ -196,4 +271,75 @@ bool MultiUndoElem::Multi() const
 	return true;
 }
 
+size_t MultiUndoElem::MemoryUsage() const
+{
+	size_t const image_bytes = m_Area * sizeof(float);
+	size_t const tissue_bytes = m_Area * sizeof(tissues_size_t);
+
+	size_t bytes = sizeof(*this) + m_Vslicenr.capacity() * sizeof(unsigned);
+	for (const auto* images : {&m_VbmpOld, &m_VworkOld, &m_VbmpNew, &m_VworkNew})
+	{
+		bytes += images->size() * image_bytes;
+	}
+	for (const auto* tissues : {&m_VtissueOld, &m_VtissueNew})
+	{
+		bytes += tissues->size() * tissue_bytes;
+	}
+	for (const auto* deltas : {&m_VbmpDelta, &m_VworkDelta, &m_VtissueDelta})
+	{
+		bytes += deltas->capacity() * sizeof(SliceDelta);
+		for (const auto& delta : *deltas)
+			bytes += delta.MemoryUsage();
+	}
+	bytes += Bytes(m_VvvmOld) + Bytes(m_VvvmNew);
+	bytes += Bytes(m_VlimitsOld) + Bytes(m_VlimitsNew);
+	bytes += Bytes(m_VmarksOld) + Bytes(m_VmarksNew);
+	return bytes;
+}
+
+bool MultiUndoElem::PageOut(std::ostream& out)
+{
+	if (!m_Deltas || PagedOut())
+		return false;
+
+	std::int64_t const offset = out.tellp();
+	for (auto* deltas : {&m_VbmpDelta, &m_VworkDelta, &m_VtissueDelta})
+	{
+		for (const auto& delta : *deltas)
+			delta.Write(out);
+	}
+	out.flush();
+	if (!out || offset < 0)
+		return false;
+
+	m_PageOffset = offset;
+	m_PagedBytes = static_cast<size_t>(static_cast<std::int64_t>(out.tellp()) - offset);
+	for (auto* deltas : {&m_VbmpDelta, &m_VworkDelta, &m_VtissueDelta})
+	{
+		for (auto& delta : *deltas)
+			delta = SliceDelta();
+	}
+	return true;
+}
+
+bool MultiUndoElem::PageIn(std::istream& in)
+{
+	if (!PagedOut())
+		return true;
+
+	in.clear();
+	in.seekg(m_PageOffset);
+	for (auto* deltas : {&m_VbmpDelta, &m_VworkDelta, &m_VtissueDelta})
+	{
+		for (auto& delta : *deltas)
+		{
+			if (!delta.Read(in))
+				return false;
+		}
+	}
+	m_PageOffset = -1;
+	m_PagedBytes = 0;
+	return true;
+}
+
 } // namespace iseg
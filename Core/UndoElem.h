@@ -11,11 +11,15 @@
 
 #include "iSegCore.h"
 
+#include "SliceDelta.h"
+
 #include "Data/DataSelection.h"
 #include "Data/Mark.h"
 #include "Data/Point.h"
 #include "Data/Types.h"
 
+#include <cstdint>
+#include <iosfwd>
 #include <vector>
 
 namespace iseg {
@@ -26,10 +30,19 @@ public:
 	UndoElem();
 	virtual ~UndoElem();
 	virtual void Merge(UndoElem* ue);
-	virtual unsigned Arraynr();
 	virtual bool Multi() const;
+	/// Bytes held in memory, including contours, limits and marks
+	virtual size_t MemoryUsage() const;
+
+	/// Move the bulk of the data to a file, only supported by some elements
+	virtual bool PageOut(std::ostream& out) { return false; }
+	virtual bool PageIn(std::istream& in) { return true; }
+	virtual bool PagedOut() const { return false; }
+	virtual size_t PagedBytes() const { return 0; }
 
 	DataSelection m_DataSelection;
+	/// Number of pixels of the images
+	size_t m_Area = 0;
 	float* m_BmpOld;
 	float* m_WorkOld;
 	tissues_size_t* m_TissueOld;
@@ -54,8 +67,14 @@ public:
 	MultiUndoElem();
 	~MultiUndoElem() override;
 	void Merge(UndoElem* ue) override;
-	unsigned Arraynr() override;
 	bool Multi() const override;
+	size_t MemoryUsage() const override;
+
+	/// Writes the deltas to the stream and releases them, the other data is small and stays in memory
+	bool PageOut(std::ostream& out) override;
+	bool PageIn(std::istream& in) override;
+	bool PagedOut() const override { return m_PageOffset >= 0; }
+	size_t PagedBytes() const override { return m_PagedBytes; }
 
 	std::vector<unsigned> m_Vslicenr;
 	std::vector<float*> m_VbmpOld;
@@ -74,6 +93,19 @@ public:
 	std::vector<unsigned char> m_Vmode1New;
 	std::vector<unsigned char> m_Vmode2Old;
 	std::vector<unsigned char> m_Vmode2New;
+
+	/// Differences between the old and new images, replacing the full copies once the step is complete
+	std::vector<SliceDelta> m_VbmpDelta;
+	std::vector<SliceDelta> m_VworkDelta;
+	std::vector<SliceDelta> m_VtissueDelta;
+	bool m_Deltas = false;
+
+	/// Drop slices where neither the images nor the modes changed, only valid once the deltas are computed
+	void RemoveUnchanged();
+
+private:
+	std::int64_t m_PageOffset = -1;
+	size_t m_PagedBytes = 0;
 };
 
 } // namespace iseg
@@ -1,9 +1,9 @@
 /*
  * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
- * 
+ *
  * This file is part of iSEG
  * (see https://github.com/ITISFoundation/osparc-iseg).
- * 
+ *
  * This software is released under the MIT License.
  *  https://opensource.org/licenses/MIT
  */
@@ -11,59 +11,78 @@
 
 #include "UndoQueue.h"
 
+#include "Data/Logger.h"
+
+#include <boost/filesystem.hpp>
+
 namespace iseg {
 
+namespace fs = boost::filesystem;
+
 UndoQueue::UndoQueue()
 {
-	m_First = m_Nrnow = m_Nrin = m_Nrundoarrays = 0;
+	m_First = m_Nrnow = m_Nrin = 0;
 	m_Nrundo = 50;
-	m_Nrundoarraysmax = 20;
 	m_Undos.resize(m_Nrundo);
 }
 
 UndoQueue::~UndoQueue()
 {
-	for (unsigned i = 0; i < m_Nrin; i++)
-		delete m_Undos[(m_First + i) % m_Nrundo];
+	ClearUndo();
 }
 
 void UndoQueue::SubAddUndo(UndoElem* ue)
 {
+	// the redo steps are lost
+	for (unsigned i = m_Nrnow; i < m_Nrin; i++)
+		delete At(i);
+	m_Nrin = m_Nrnow;
+
 	if (m_Nrnow == m_Nrundo)
 	{
-		m_Nrundoarrays = (m_Nrundoarrays + ue->Arraynr()) - m_Undos[m_First]->Arraynr();
-		delete m_Undos[m_First];
-		m_Undos[m_First] = ue;
-		m_First = (m_First + 1) % m_Nrundo;
-		while (m_Nrundoarrays > m_Nrundoarraysmax)
-		{
-			m_Nrundoarrays -= m_Undos[m_First]->Arraynr();
-			delete m_Undos[m_First];
-			m_First = (m_First + 1) % m_Nrundo;
-			m_Nrnow--;
-		}
+		DropOldest();
 	}
-	else
+	At(m_Nrnow) = ue;
+	m_Nrnow++;
+	m_Nrin = m_Nrnow;
+
+	EnforceBudget();
+}
+
+void UndoQueue::DropOldest()
+{
+	delete m_Undos[m_First];
+	m_Undos[m_First] = nullptr;
+	m_First = (m_First + 1) % m_Nrundo;
+	if (m_Nrnow > 0)
+		m_Nrnow--;
+	m_Nrin--;
+}
+
+void UndoQueue::EnforceBudget()
+{
+	if (m_MemoryBudget != 0)
 	{
-		m_Nrundoarrays += ue->Arraynr();
+		size_t usage = MemoryUsage();
 
-		for (unsigned i = m_Nrnow; i < m_Nrin; i++)
+		// move the oldest steps to disk first, recent steps are the most likely to be undone
+		for (unsigned i = 0; m_SpillToDisk && usage > m_MemoryBudget && i < m_Nrin; i++)
 		{
-			m_Nrundoarrays -= m_Undos[(m_First + i) % m_Nrundo]->Arraynr();
-			delete m_Undos[(m_First + i) % m_Nrundo];
+			size_t const bytes = At(i)->MemoryUsage();
+			if (!At(i)->PagedOut() && PageOut(At(i)))
+			{
+				usage -= bytes - At(i)->MemoryUsage();
+			}
 		}
-		m_Undos[(m_First + m_Nrnow) % m_Nrundo] = ue;
-		m_Nrnow++;
 
-		while (m_Nrundoarrays > m_Nrundoarraysmax)
+		while (usage > m_MemoryBudget && m_Nrnow > 0)
 		{
-			m_Nrundoarrays -= m_Undos[m_First]->Arraynr();
-			delete m_Undos[m_First];
-			m_First = (m_First + 1) % m_Nrundo;
-			m_Nrnow--;
+			usage -= m_Undos[m_First]->MemoryUsage();
+			DropOldest();
 		}
 	}
-	m_Nrin = m_Nrnow;
+
+	ReleaseSpillFile();
 }
 
 void UndoQueue::MergeUndo(UndoElem* ue)
@@ -72,17 +91,8 @@ void UndoQueue::MergeUndo(UndoElem* ue)
 	{
 		if (m_Nrin > 0)
 		{
-			m_Nrundoarrays -= m_Undos[(m_First + m_Nrin - 1) % m_Nrundo]->Arraynr();
-			m_Undos[(m_First + m_Nrin - 1) % m_Nrundo]->Merge(ue);
-			m_Nrundoarrays += m_Undos[(m_First + m_Nrin - 1) % m_Nrundo]->Arraynr();
-
-			while (m_Nrundoarrays > m_Nrundoarraysmax)
-			{
-				m_Nrundoarrays -= m_Undos[m_First]->Arraynr();
-				delete m_Undos[m_First];
-				m_First = (m_First + 1) % m_Nrundo;
-				m_Nrnow--;
-			}
+			At(m_Nrin - 1)->Merge(ue);
+			EnforceBudget();
 		}
 		m_Nrin = m_Nrnow;
 	}
@@ -92,22 +102,24 @@ void UndoQueue::AddUndo(UndoElem* ue) { SubAddUndo(ue); }
 
 bool UndoQueue::AddUndo(MultiUndoElem* ue)
 {
-	if (ue->Arraynr() < m_Nrundoarraysmax)
-	{
-		SubAddUndo(ue);
-		return true;
-	}
-	else
+	// a step which does not fit into memory is only accepted if it can be moved to disk
+	if (m_MemoryBudget != 0 && !m_SpillToDisk && ue->MemoryUsage() > m_MemoryBudget)
 	{
 		return false;
 	}
+	SubAddUndo(ue);
+	return true;
 }
 
 UndoElem* UndoQueue::Undo()
 {
 	if (m_Nrnow > 0)
 	{
-		return m_Undos[((--m_Nrnow) + m_First) % m_Nrundo];
+		UndoElem* ue = At(m_Nrnow - 1);
+		if (!PageIn(ue))
+			return nullptr;
+		--m_Nrnow;
+		return ue;
 	}
 	else
 		return nullptr;
@@ -117,7 +129,11 @@ UndoElem* UndoQueue::Redo()
 {
 	if (m_Nrnow < m_Nrin)
 	{
-		return m_Undos[((m_Nrnow++) + m_First) % m_Nrundo];
+		UndoElem* ue = At(m_Nrnow);
+		if (!PageIn(ue))
+			return nullptr;
+		++m_Nrnow;
+		return ue;
 	}
 	else
 		return nullptr;
@@ -126,40 +142,108 @@ UndoElem* UndoQueue::Redo()
 void UndoQueue::ClearUndo()
 {
 	for (unsigned i = 0; i < m_Nrin; i++)
-		delete m_Undos[(m_First + i) % m_Nrundo];
-	m_First = m_Nrnow = m_Nrin = m_Nrundoarrays = 0;
+		delete At(i);
+	m_First = m_Nrnow = m_Nrin = 0;
+	ReleaseSpillFile();
 }
 
 unsigned UndoQueue::ReturnNrundo() const { return m_Nrnow; }
 
 unsigned UndoQueue::ReturnNrredo() const { return m_Nrin - m_Nrnow; }
 
-unsigned UndoQueue::ReturnNrundoarraysmax() const { return m_Nrundoarraysmax; }
-
 unsigned UndoQueue::ReturnNrundomax() const { return m_Nrundo; }
 
-void UndoQueue::SetNrundoarraysmax(unsigned nr)
+void UndoQueue::SetMemoryBudget(size_t bytes)
 {
-	if (m_Nrundoarraysmax != nr)
-	{
-		m_Nrundoarraysmax = nr;
+	m_MemoryBudget = bytes;
+	EnforceBudget();
+}
 
-		while (m_Nrundoarrays > m_Nrundoarraysmax && m_Nrnow > 0)
+void UndoQueue::SetSpillToDisk(bool on)
+{
+	m_SpillToDisk = on;
+	if (!on)
+	{
+		// keep only the steps which fit into memory
+		for (unsigned i = 0; i < m_Nrin; i++)
 		{
-			m_Nrundoarrays -= m_Undos[m_First]->Arraynr();
-			delete m_Undos[m_First];
-			m_First = (m_First + 1) % m_Nrundo;
-			m_Nrin--;
-			m_Nrnow--;
+			if (At(i)->PagedOut() && !PageIn(At(i)))
+			{
+				ClearUndo();
+				return;
+			}
 		}
+	}
+	EnforceBudget();
+}
 
-		while (m_Nrundoarrays > m_Nrundoarraysmax && m_Nrin > 0)
+size_t UndoQueue::MemoryUsage() const
+{
+	size_t bytes = 0;
+	for (unsigned i = 0; i < m_Nrin; i++)
+		bytes += m_Undos[(m_First + i) % m_Nrundo]->MemoryUsage();
+	return bytes;
+}
+
+size_t UndoQueue::DiskUsage() const
+{
+	size_t bytes = 0;
+	for (unsigned i = 0; i < m_Nrin; i++)
+		bytes += m_Undos[(m_First + i) % m_Nrundo]->PagedBytes();
+	return bytes;
+}
+
+bool UndoQueue::PageOut(UndoElem* ue)
+{
+	if (!m_SpillFile.is_open())
+	{
+		boost::system::error_code ec;
+		auto path = fs::temp_directory_path(ec) / fs::unique_path("iseg-undo-%%%%-%%%%-%%%%.bin");
+		m_SpillFileName = path.string();
+		m_SpillFile.open(m_SpillFileName, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+		m_SpillFileSize = 0;
+		if (!m_SpillFile.is_open())
 		{
-			m_Nrin--;
-			m_Nrundoarrays -= m_Undos[(m_First + m_Nrin) % m_Nrundo]->Arraynr();
-			delete m_Undos[(m_First + m_Nrin) % m_Nrundo];
+			ISEG_ERROR("could not create undo file " << m_SpillFileName);
+			m_SpillFileName.clear();
+			return false;
 		}
 	}
+
+	m_SpillFile.clear();
+	m_SpillFile.seekp(m_SpillFileSize);
+	if (!ue->PageOut(m_SpillFile))
+	{
+		ISEG_WARNING("could not write undo step to " << m_SpillFileName);
+		return false;
+	}
+	m_SpillFileSize = m_SpillFile.tellp();
+	return true;
+}
+
+bool UndoQueue::PageIn(UndoElem* ue)
+{
+	if (!ue->PagedOut())
+		return true;
+	if (!ue->PageIn(m_SpillFile))
+	{
+		ISEG_ERROR("could not read undo step from " << m_SpillFileName);
+		return false;
+	}
+	return true;
+}
+
+void UndoQueue::ReleaseSpillFile()
+{
+	// the space is only reclaimed once no step refers to the file anymore
+	if (m_SpillFileName.empty() || DiskUsage() != 0)
+		return;
+
+	m_SpillFile.close();
+	boost::system::error_code ec;
+	fs::remove(m_SpillFileName, ec);
+	m_SpillFileName.clear();
+	m_SpillFileSize = 0;
 }
 
 void UndoQueue::SetNrundo(unsigned nr)
@@ -168,18 +252,13 @@ void UndoQueue::SetNrundo(unsigned nr)
 	{
 		while (m_Nrin > nr && m_Nrnow > 0)
 		{
-			m_Nrundoarrays -= m_Undos[m_First]->Arraynr();
-			delete m_Undos[m_First];
-			m_First = (m_First + 1) % m_Nrundo;
-			m_Nrnow--;
-			m_Nrin--;
+			DropOldest();
 		}
 
 		while (m_Nrin > nr)
 		{
 			m_Nrin--;
-			m_Nrundoarrays -= m_Undos[(m_First + m_Nrin) % m_Nrundo]->Arraynr();
-			delete m_Undos[(m_First + m_Nrin) % m_Nrundo];
+			delete At(m_Nrin);
 		}
 
 		std::vector<UndoElem*> vue;
@@ -196,13 +275,14 @@ void UndoQueue::SetNrundo(unsigned nr)
 		this->m_Nrundo = nr;
 
 		m_First = 0;
+		ReleaseSpillFile();
 	}
 }
 
 void UndoQueue::ReverseUndosliceorder(unsigned short nrslices)
 {
 	for (unsigned i = 0; i < m_Nrin; i++)
-		m_Undos[i]->m_DataSelection.sliceNr = nrslices - 1 - m_Undos[i]->m_DataSelection.sliceNr;
+		At(i)->m_DataSelection.sliceNr = nrslices - 1 - At(i)->m_DataSelection.sliceNr;
 }
 
 } // namespace iseg
@@ -1,9 +1,9 @@
 /*
  * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
- * 
+ *
  * This file is part of iSEG
  * (see https://github.com/ITISFoundation/osparc-iseg).
- * 
+ *
  * This software is released under the MIT License.
  *  https://opensource.org/licenses/MIT
  */
@@ -13,6 +13,10 @@
 
 #include "UndoElem.h"
 
+#include <cstdint>
+#include <fstream>
+#include <string>
+
 namespace iseg {
 
 class ISEG_CORE_API UndoQueue
@@ -28,21 +32,39 @@ public:
 	void ClearUndo();
 	unsigned ReturnNrredo() const;
 	unsigned ReturnNrundo() const;
-	unsigned ReturnNrundoarraysmax() const;
 	unsigned ReturnNrundomax() const;
-	void SetNrundoarraysmax(unsigned nr);
 	void SetNrundo(unsigned nr);
 	void ReverseUndosliceorder(unsigned short nrslices);
 
+	/// Maximum bytes of undo data kept in memory, 0 means no limit
+	size_t MemoryBudget() const { return m_MemoryBudget; }
+	void SetMemoryBudget(size_t bytes);
+	/// If enabled, the oldest steps are moved to a temporary file instead of being discarded when the budget is exceeded
+	bool SpillToDisk() const { return m_SpillToDisk; }
+	void SetSpillToDisk(bool on);
+	size_t MemoryUsage() const;
+	size_t DiskUsage() const;
+
 private:
-	unsigned m_Nrundo;
-	unsigned m_Nrundoarraysmax;
+	UndoElem*& At(unsigned i) { return m_Undos[(m_First + i) % m_Nrundo]; }
 	void SubAddUndo(UndoElem* ue);
-	unsigned m_Nrundoarrays;
+	void DropOldest();
+	void EnforceBudget();
+	bool PageOut(UndoElem* ue);
+	bool PageIn(UndoElem* ue);
+	void ReleaseSpillFile();
+
+	unsigned m_Nrundo;
 	std::vector<UndoElem*> m_Undos;
 	unsigned m_First;
 	unsigned m_Nrnow;
 	unsigned m_Nrin;
+
+	size_t m_MemoryBudget = 1024ull * 1024 * 1024;
+	bool m_SpillToDisk = true;
+	std::fstream m_SpillFile;
+	std::string m_SpillFileName;
+	std::int64_t m_SpillFileSize = 0;
 };
 
 } // namespace iseg
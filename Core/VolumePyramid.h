@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace iseg {
+
+/** \brief Downsampled copies of a volume stored as an array of slices
+
+	Level l of the pyramid is the volume downsampled by 2^l along each axis, each level is computed
+	from the previous one by reducing blocks of 2 x 2 x 2 voxels. Images are averaged, while labels
+	take the most frequent label of the block, such that no new labels appear at tissue boundaries.
+	Blocks at the upper border of an odd sized axis are truncated.
+*/
+class VolumePyramid
+{
+public:
+	/// Levels 1, 2 and 3, i.e. downsampled by 2, 4 and 8
+	static int const kMaxLevels = 3;
+
+	using dims_type = std::array<unsigned, 3>;
+
+	/// Dimensions of a level, level 0 is the volume itself
+	static dims_type Dims(const dims_type& dims, int level)
+	{
+		dims_type result;
+		for (int i = 0; i < 3; i++)
+		{
+			result[i] = ((dims[i] - 1) >> level) + 1;
+		}
+		return result;
+	}
+
+	/// Number of levels worth storing, i.e. up to kMaxLevels, stopping once a level is a single voxel
+	static int NumLevels(const dims_type& dims)
+	{
+		int levels = 0;
+		while (levels < kMaxLevels && std::max({dims[0], dims[1], dims[2]}) > (1u << levels))
+		{
+			levels++;
+		}
+		return levels;
+	}
+
+	/// Averages blocks of 2 x 2 x 2 voxels of src into dst, which holds Dims(dims, 1)
+	template<typename T>
+	static void Average(const T* const* src, const dims_type& dims, T* const* dst)
+	{
+		Reduce(src, dims, dst, [](const T* values, int n) {
+			double sum = 0;
+			for (int i = 0; i < n; i++)
+			{
+				sum += values[i];
+			}
+			return static_cast<T>(sum / n);
+		});
+	}
+
+	/// Most frequent label of blocks of 2 x 2 x 2 voxels, on ties the label which comes first in the block
+	template<typename T>
+	static void Mode(const T* const* src, const dims_type& dims, T* const* dst)
+	{
+		Reduce(src, dims, dst, [](const T* values, int n) {
+			T mode = values[0];
+			int mode_count = 0;
+			for (int i = 0; i < n && mode_count < n - i; i++)
+			{
+				int const count = static_cast<int>(std::count(values + i, values + n, values[i]));
+				if (count > mode_count)
+				{
+					mode = values[i];
+					mode_count = count;
+				}
+			}
+			return mode;
+		});
+	}
+
+private:
+	template<typename T, typename F>
+	static void Reduce(const T* const* src, const dims_type& dims, T* const* dst, const F& reduce)
+	{
+		auto const out_dims = Dims(dims, 1);
+		size_t const width = dims[0];
+
+#pragma omp parallel for
+		for (int k = 0; k < static_cast<int>(out_dims[2]); k++)
+		{
+			unsigned const z0 = 2 * static_cast<unsigned>(k), z1 = std::min(z0 + 2, dims[2]);
+			T values[8];
+			T* out = dst[k];
+			for (unsigned j = 0; j < out_dims[1]; j++)
+			{
+				unsigned const y0 = 2 * j, y1 = std::min(y0 + 2, dims[1]);
+				for (unsigned i = 0; i < out_dims[0]; i++)
+				{
+					unsigned const x0 = 2 * i, x1 = std::min(x0 + 2, dims[0]);
+					int n = 0;
+					for (unsigned z = z0; z < z1; z++)
+					{
+						for (unsigned y = y0; y < y1; y++)
+						{
+							for (unsigned x = x0; x < x1; x++)
+							{
+								values[n++] = src[z][y * width + x];
+							}
+						}
+					}
+					*out++ = reduce(values, n);
+				}
+			}
+		}
+	}
+};
+
+} // namespace iseg
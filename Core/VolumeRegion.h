@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include "Data/Transform.h"
+#include "Data/Vec3.h"
+
+namespace iseg {
+
+/** \brief Box of voxels to load from a volume, e.g. an XY region of interest and a range of slices
+
+	Only every m_Step-th voxel along each axis is loaded, starting with the first voxel of the box.
+	The default region is the whole volume.
+*/
+struct VolumeRegion
+{
+	unsigned m_Start[3] = {0, 0, 0};
+	/// Extent of the box before downsampling, 0 extends it to the end of the volume
+	unsigned m_Size[3] = {0, 0, 0};
+	unsigned m_Step = 1;
+
+	/// Limits the box to a volume of the given dimensions, false if they do not overlap
+	bool Clip(const unsigned dims[3])
+	{
+		if (m_Step == 0)
+			m_Step = 1;
+		for (int i = 0; i < 3; i++)
+		{
+			if (m_Start[i] >= dims[i])
+				return false;
+			if (m_Size[i] == 0 || m_Size[i] > dims[i] - m_Start[i])
+				m_Size[i] = dims[i] - m_Start[i];
+		}
+		return true;
+	}
+
+	/// Number of loaded voxels along the axis, the box must be clipped
+	unsigned Dim(int axis) const { return (m_Size[axis] + m_Step - 1) / m_Step; }
+
+	/// True if the clipped box is the whole volume at full resolution
+	bool IsWhole(const unsigned dims[3]) const
+	{
+		return m_Step == 1 && m_Start[0] == 0 && m_Start[1] == 0 && m_Start[2] == 0 &&
+					 m_Size[0] == dims[0] && m_Size[1] == dims[1] && m_Size[2] == dims[2];
+	}
+
+	/// Updates the spacing and transform of the volume to those of the loaded box
+	void Apply(float spacing[3], Transform& transform) const
+	{
+		int const shift[3] = {-static_cast<int>(m_Start[0]), -static_cast<int>(m_Start[1]), -static_cast<int>(m_Start[2])};
+		transform.PaddingUpdateTransform(shift, Vec3(spacing[0], spacing[1], spacing[2]));
+		for (int i = 0; i < 3; i++)
+		{
+			spacing[i] *= static_cast<float>(m_Step);
+		}
+	}
+};
+
+} // namespace iseg
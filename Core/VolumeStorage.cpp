@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include "Precompiled.h"
+
+#include "VolumeStorage.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef _WIN32
+#	include <malloc.h>
+#endif
+
+namespace iseg {
+
+void* AlignedMalloc(size_t size, size_t alignment)
+{
+	if (size == 0)
+		return nullptr;
+#ifdef _WIN32
+	return _aligned_malloc(size, alignment);
+#else
+	void* ptr = nullptr;
+	if (posix_memalign(&ptr, alignment, size) != 0)
+		return nullptr;
+	return ptr;
+#endif
+}
+
+void AlignedFree(void* ptr)
+{
+#ifdef _WIN32
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+VolumeStorage::VolumeStorage(unsigned width, unsigned height, unsigned nrslices, tissuelayers_size_t nrlayers)
+		: m_Width(width), m_Height(height), m_Nrslices(nrslices)
+{
+	size_t const n = Area() * nrslices;
+	m_Source = static_cast<float*>(AlignedMalloc(n * sizeof(float), k_Alignment));
+	m_Target = static_cast<float*>(AlignedMalloc(n * sizeof(float), k_Alignment));
+	for (tissuelayers_size_t idx = 0; idx < nrlayers; ++idx)
+	{
+		m_Tissues.push_back(static_cast<tissues_size_t*>(AlignedMalloc(n * sizeof(tissues_size_t), k_Alignment)));
+	}
+}
+
+VolumeStorage::~VolumeStorage()
+{
+	AlignedFree(m_Source);
+	AlignedFree(m_Target);
+	for (auto tissues : m_Tissues)
+	{
+		AlignedFree(tissues);
+	}
+}
+
+bool VolumeStorage::Valid() const
+{
+	return m_Source != nullptr && m_Target != nullptr &&
+				 std::none_of(m_Tissues.begin(), m_Tissues.end(), [](tissues_size_t* p) { return p == nullptr; });
+}
+
+tissues_size_t* VolumeStorage::Tissues(tissuelayers_size_t layeridx)
+{
+	return layeridx < m_Tissues.size() ? m_Tissues[layeridx] : nullptr;
+}
+
+const tissues_size_t* VolumeStorage::Tissues(tissuelayers_size_t layeridx) const
+{
+	return layeridx < m_Tissues.size() ? m_Tissues[layeridx] : nullptr;
+}
+
+tissues_size_t* VolumeStorage::Tissues(tissuelayers_size_t layeridx, unsigned slicenr)
+{
+	auto tissues = Tissues(layeridx);
+	return tissues ? tissues + slicenr * Area() : nullptr;
+}
+
+size_t VolumeStorage::MemoryUsage() const
+{
+	size_t const n = Area() * m_Nrslices;
+	return n * (2 * sizeof(float) + m_Tissues.size() * sizeof(tissues_size_t));
+}
+
+} // namespace iseg
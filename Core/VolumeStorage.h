@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#pragma once
+
+#include "iSegCore.h"
+
+#include "Data/Types.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace iseg {
+
+ISEG_CORE_API void* AlignedMalloc(size_t size, size_t alignment);
+ISEG_CORE_API void AlignedFree(void* ptr);
+
+/** \brief Contiguous storage for source, target and tissue layers of a volume
+
+	Each image is kept in a single 64-byte aligned block with the slices stored
+	back to back, i.e. slice 'z' of the source starts at Source() + z * Area().
+	The slices of a SlicesHandler can be attached to these blocks, which allows
+	ITK filters to operate on a plain itk::Image without copying the data.
+*/
+class ISEG_CORE_API VolumeStorage
+{
+public:
+	static const size_t k_Alignment = 64;
+
+	VolumeStorage(unsigned width, unsigned height, unsigned nrslices, tissuelayers_size_t nrlayers = 1);
+	~VolumeStorage();
+
+	VolumeStorage(const VolumeStorage&) = delete;
+	VolumeStorage& operator=(const VolumeStorage&) = delete;
+
+	unsigned Width() const { return m_Width; }
+	unsigned Height() const { return m_Height; }
+	unsigned NumSlices() const { return m_Nrslices; }
+	size_t Area() const { return static_cast<size_t>(m_Width) * m_Height; }
+	tissuelayers_size_t NumTissueLayers() const { return static_cast<tissuelayers_size_t>(m_Tissues.size()); }
+
+	/// true if all buffers could be allocated
+	bool Valid() const;
+
+	float* Source() { return m_Source; }
+	const float* Source() const { return m_Source; }
+	float* Target() { return m_Target; }
+	const float* Target() const { return m_Target; }
+	tissues_size_t* Tissues(tissuelayers_size_t layeridx);
+	const tissues_size_t* Tissues(tissuelayers_size_t layeridx) const;
+
+	float* Source(unsigned slicenr) { return m_Source + slicenr * Area(); }
+	float* Target(unsigned slicenr) { return m_Target + slicenr * Area(); }
+	tissues_size_t* Tissues(tissuelayers_size_t layeridx, unsigned slicenr);
+
+	/// Allocated memory in bytes
+	size_t MemoryUsage() const;
+
+private:
+	unsigned m_Width;
+	unsigned m_Height;
+	unsigned m_Nrslices;
+	float* m_Source;
+	float* m_Target;
+	std::vector<tissues_size_t*> m_Tissues;
+};
+
+} // namespace iseg
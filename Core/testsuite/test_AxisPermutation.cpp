@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../AxisPermutation.h"
+
+#include <vector>
+
+namespace iseg {
+
+namespace {
+
+template<typename T>
+class Volume
+{
+public:
+	Volume(unsigned w, unsigned h, unsigned n) : m_Dims{w, h, n}, m_Data(static_cast<size_t>(w) * h * n)
+	{
+		for (unsigned k = 0; k < n; k++)
+		{
+			m_Slices.push_back(m_Data.data() + static_cast<size_t>(k) * w * h);
+		}
+	}
+
+	T& At(unsigned x, unsigned y, unsigned z) { return m_Slices[z][static_cast<size_t>(y) * m_Dims[0] + x]; }
+
+	std::array<unsigned, 3> m_Dims;
+	std::vector<T> m_Data;
+	std::vector<T*> m_Slices;
+};
+
+template<typename T>
+void CheckPermutation(Volume<T>& in, const AxisPermutation::order_type& order)
+{
+	auto const dims = AxisPermutation::Dims(in.m_Dims[0], in.m_Dims[1], in.m_Dims[2], order);
+	Volume<T> out(dims[0], dims[1], dims[2]);
+	AxisPermutation::Permute<T>(in.m_Slices.data(), in.m_Dims[0], in.m_Dims[1], in.m_Dims[2], order, out.m_Slices.data());
+
+	bool ok = true;
+	for (unsigned z = 0; z < in.m_Dims[2]; z++)
+	{
+		for (unsigned y = 0; y < in.m_Dims[1]; y++)
+		{
+			for (unsigned x = 0; x < in.m_Dims[0]; x++)
+			{
+				unsigned const c[3] = {x, y, z};
+				ok = ok && out.At(c[order[0]], c[order[1]], c[order[2]]) == in.At(x, y, z);
+			}
+		}
+	}
+	BOOST_CHECK_MESSAGE(ok, "permutation " << order[0] << order[1] << order[2] << " differs");
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(AxisPermutation_suite);
+
+BOOST_AUTO_TEST_CASE(AllOrders)
+{
+	// sizes which are not multiples of the block size
+	Volume<float> volume(37, 70, 19);
+	for (size_t i = 0; i < volume.m_Data.size(); i++)
+	{
+		volume.m_Data[i] = static_cast<float>(i);
+	}
+
+	std::vector<AxisPermutation::order_type> orders = {{0, 1, 2}, {1, 0, 2}, {0, 2, 1}, {2, 1, 0}, {1, 2, 0}, {2, 0, 1}};
+	for (const auto& order : orders)
+	{
+		CheckPermutation(volume, order);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(SlabOfSlices)
+{
+	Volume<unsigned short> volume(5, 3, 40);
+	for (size_t i = 0; i < volume.m_Data.size(); i++)
+	{
+		volume.m_Data[i] = static_cast<unsigned short>(i);
+	}
+
+	// swapping x and z, the output slices 1 and 2 are slices x=1 and x=2 of the input
+	AxisPermutation::order_type const order = {2, 1, 0};
+	std::vector<unsigned short> slab(2 * 40 * 3);
+	unsigned short* dst[] = {slab.data(), slab.data() + 40 * 3};
+	AxisPermutation::Permute<unsigned short>(volume.m_Slices.data(), 5, 3, 40, order, dst, 1, 2);
+
+	for (unsigned k = 0; k < 2; k++)
+	{
+		for (unsigned y = 0; y < 3; y++)
+		{
+			for (unsigned z = 0; z < 40; z++)
+			{
+				BOOST_CHECK_EQUAL(dst[k][y * 40 + z], volume.At(1 + k, y, z));
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
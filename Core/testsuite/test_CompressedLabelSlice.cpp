@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../CompressedLabelSlice.h"
+
+#include <vector>
+
+namespace iseg {
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(CompressedLabelSlice_suite);
+
+namespace {
+
+std::vector<tissues_size_t> RoundTrip(const std::vector<tissues_size_t>& labels, unsigned w, unsigned h, CompressedLabelSlice& compressed)
+{
+	compressed.Compress(labels.data(), w, h);
+	std::vector<tissues_size_t> result(labels.size(), 0);
+	compressed.Decompress(result.data());
+	return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Uniform)
+{
+	unsigned const w = 512, h = 512;
+	std::vector<tissues_size_t> labels(w * h, 7);
+
+	CompressedLabelSlice compressed;
+	BOOST_CHECK(RoundTrip(labels, w, h, compressed) == labels);
+	BOOST_CHECK_LT(compressed.MemoryUsage() * 50, labels.size() * sizeof(tissues_size_t));
+}
+
+BOOST_AUTO_TEST_CASE(Regions)
+{
+	// odd size, so that border tiles are partial
+	unsigned const w = 203, h = 131;
+	std::vector<tissues_size_t> labels(w * h, 0);
+	for (unsigned y = 0; y < h; ++y)
+	{
+		for (unsigned x = 0; x < w; ++x)
+		{
+			// a few blobs and a checkerboard region, which is cheaper as palette than as runs
+			if ((x - 100) * (x - 100) + (y - 60) * (y - 60) < 900)
+				labels[y * w + x] = 120;
+			else if (x < 40 && y < 40)
+				labels[y * w + x] = ((x + y) % 2) ? 3 : 5;
+			else if (x > 150)
+				labels[y * w + x] = static_cast<tissues_size_t>(1 + y / 20);
+		}
+	}
+
+	CompressedLabelSlice compressed;
+	BOOST_CHECK(RoundTrip(labels, w, h, compressed) == labels);
+	BOOST_CHECK_EQUAL(compressed.Width(), w);
+	BOOST_CHECK_EQUAL(compressed.Height(), h);
+	BOOST_CHECK_LT(compressed.MemoryUsage(), labels.size() * sizeof(tissues_size_t));
+
+	// single values are read from their tile, also in partial border tiles
+	size_t mismatches = 0;
+	for (unsigned y = 0; y < h; ++y)
+	{
+		for (unsigned x = 0; x < w; ++x)
+		{
+			if (compressed.Value(x, y) != labels[y * w + x])
+				++mismatches;
+		}
+	}
+	BOOST_CHECK_EQUAL(mismatches, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ManyLabels)
+{
+	// more than 256 labels per tile can only be stored run-length encoded
+	unsigned const w = 64, h = 64;
+	std::vector<tissues_size_t> labels(w * h);
+	for (size_t i = 0; i < labels.size(); ++i)
+	{
+		labels[i] = static_cast<tissues_size_t>(i % 1000);
+	}
+
+	CompressedLabelSlice compressed;
+	BOOST_CHECK(RoundTrip(labels, w, h, compressed) == labels);
+	BOOST_CHECK_EQUAL(compressed.Value(17, 0), labels[17]);
+	BOOST_CHECK_EQUAL(compressed.Value(5, 63), labels[63 * w + 5]);
+
+	compressed.Clear();
+	BOOST_CHECK(compressed.Empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
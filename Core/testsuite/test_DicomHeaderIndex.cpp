@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../DicomHeaderIndex.h"
+
+#include <boost/filesystem.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace iseg {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+void WriteFile(const fs::path& path, const std::string& content)
+{
+	std::ofstream out(path.string().c_str(), std::ios::binary | std::ios::trunc);
+	out << content;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(DicomHeaderIndex_suite);
+
+BOOST_AUTO_TEST_CASE(ParseOnlyNewOrChanged)
+{
+	auto dir = fs::temp_directory_path() / fs::unique_path("iseg-dicom-%%%%-%%%%");
+	fs::create_directories(dir);
+
+	std::vector<std::string> files;
+	for (int i = 0; i < 4; ++i)
+	{
+		auto path = dir / ("IM" + std::to_string(i) + ".dcm");
+		WriteFile(path, std::string(10 + i, 'x'));
+		files.push_back(path.string());
+	}
+
+	// the header is derived from the content, i.e. the size
+	std::atomic<int> parsed(0);
+	auto parse = [&parsed](const std::string& fname) {
+		parsed++;
+		DicomHeaderIndex::Header header;
+		header.m_SeriesNr = static_cast<unsigned>(fs::file_size(fname) % 2);
+		header.m_SlicePos = -0.1f * static_cast<float>(fs::file_size(fname));
+		return header;
+	};
+
+	std::vector<DicomHeaderIndex::Header> first;
+	{
+		DicomHeaderIndex index(dir.string());
+		first = index.Lookup(files, parse);
+		BOOST_CHECK_EQUAL(index.NumParsed(), 4);
+		BOOST_CHECK(index.Save());
+	}
+	BOOST_CHECK_EQUAL(parsed, 4);
+	BOOST_CHECK(fs::exists(dir / DicomHeaderIndex::SidecarName()));
+
+	{
+		DicomHeaderIndex index(dir.string());
+		auto headers = index.Lookup(files, parse);
+		BOOST_CHECK_EQUAL(index.NumParsed(), 0);
+		BOOST_REQUIRE_EQUAL(headers.size(), first.size());
+		for (size_t i = 0; i < headers.size(); ++i)
+		{
+			BOOST_CHECK_EQUAL(headers[i].m_SeriesNr, first[i].m_SeriesNr);
+			BOOST_CHECK_EQUAL(headers[i].m_SlicePos, first[i].m_SlicePos);
+		}
+	}
+	BOOST_CHECK_EQUAL(parsed, 4);
+
+	// the directory grows, one file changes and one is deleted
+	auto added = dir / "IM4.dcm";
+	WriteFile(added, std::string(30, 'y'));
+	files.push_back(added.string());
+	WriteFile(files[1], std::string(50, 'z'));
+	fs::remove(files[3]);
+	files.erase(files.begin() + 3);
+	{
+		DicomHeaderIndex index(dir.string());
+		auto headers = index.Lookup(files, parse);
+		BOOST_CHECK_EQUAL(index.NumParsed(), 2);
+		BOOST_CHECK_EQUAL(headers[1].m_SlicePos, -5.f);
+		BOOST_CHECK(index.Save());
+		BOOST_CHECK_EQUAL(index.NumEntries(), 4);
+	}
+	BOOST_CHECK_EQUAL(parsed, 6);
+
+	boost::system::error_code ec;
+	fs::remove_all(dir, ec);
+}
+
+BOOST_AUTO_TEST_CASE(CorruptIndex)
+{
+	auto dir = fs::temp_directory_path() / fs::unique_path("iseg-dicom-%%%%-%%%%");
+	fs::create_directories(dir);
+	WriteFile(dir / DicomHeaderIndex::SidecarName(), "iSeg DICOM index 1\nnot an entry\n");
+	auto file = dir / "IM0.dcm";
+	WriteFile(file, "dicom");
+
+	DicomHeaderIndex index(dir.string());
+	BOOST_CHECK_EQUAL(index.NumEntries(), 0);
+	auto headers = index.Lookup({file.string()}, [](const std::string&) {
+		DicomHeaderIndex::Header header;
+		header.m_SeriesNr = 7;
+		return header;
+	});
+	BOOST_CHECK_EQUAL(headers.at(0).m_SeriesNr, 7);
+	BOOST_CHECK_EQUAL(index.NumParsed(), 1);
+
+	boost::system::error_code ec;
+	fs::remove_all(dir, ec);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../HDF5ChunkReader.h"
+#include "../HDF5ChunkWriter.h"
+
+#include <boost/filesystem.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace iseg {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+std::string TempFile()
+{
+	return (fs::temp_directory_path() / fs::unique_path("iseg-chunks-%%%%-%%%%.h5")).string();
+}
+
+template<typename T>
+std::vector<T*> Pointers(std::vector<std::vector<T>>& data)
+{
+	std::vector<T*> slices;
+	for (auto& d : data)
+		slices.push_back(d.data());
+	return slices;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(HDF5ChunkReader_suite);
+
+BOOST_AUTO_TEST_CASE(ReadWritten)
+{
+	size_t const slice_size = 64 * 48;
+	size_t const num_slices = 9;
+
+	// noise is stored without filter and read directly into the slice
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> noise(0.f, 1.f);
+	std::vector<std::vector<float>> data(num_slices, std::vector<float>(slice_size));
+	for (size_t k = 0; k < num_slices; ++k)
+	{
+		for (size_t i = 0; i < slice_size; ++i)
+		{
+			data[k][i] = (k % 3 == 1) ? noise(rng) : static_cast<float>((i / 64 + k) % 5);
+		}
+	}
+	auto slices = Pointers(data);
+	// never written, i.e. reads the fill value
+	slices[6] = nullptr;
+
+	for (int compression : {0, 1, 9})
+	{
+		std::string fname = TempFile();
+		HDF5IO io;
+		auto fid = io.Create(fname);
+		BOOST_REQUIRE(fid >= 0);
+		BOOST_CHECK(HDF5ChunkWriter(compression, 2).Write(fid, "Source", slices.data(), num_slices, slice_size));
+		io.Close(fid);
+
+		std::vector<std::vector<float>> result(num_slices, std::vector<float>(slice_size, -1.f));
+		auto result_slices = Pointers(result);
+		fid = io.Open(fname);
+		HDF5ChunkReader reader(3);
+		BOOST_CHECK(reader.Read(fid, "Source", result_slices.data(), num_slices, slice_size));
+		BOOST_CHECK(!reader.Fallback());
+		io.Close(fid);
+
+		for (size_t k = 0; k < num_slices; ++k)
+		{
+			if (k == 6)
+				BOOST_CHECK(result[k] == std::vector<float>(slice_size, 0.f));
+			else
+				BOOST_CHECK(result[k] == data[k]);
+		}
+
+		boost::system::error_code ec;
+		fs::remove(fname, ec);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ReadFilterPipeline)
+{
+	// written through the HDF5 filter pipeline, e.g. by older versions
+	size_t const slice_size = 1000;
+	std::vector<std::vector<unsigned short>> data(5, std::vector<unsigned short>(slice_size));
+	for (size_t k = 0; k < data.size(); ++k)
+	{
+		for (size_t i = 0; i < slice_size; ++i)
+			data[k][i] = static_cast<unsigned short>((i / 10) * k);
+	}
+	auto slices = Pointers(data);
+
+	std::string fname = TempFile();
+	HDF5IO io(1);
+	auto fid = io.Create(fname);
+	BOOST_REQUIRE(fid >= 0);
+	BOOST_CHECK(io.WriteData(fid, "Tissue", slices.data(), slices.size(), slice_size));
+	io.Close(fid);
+
+	std::vector<std::vector<unsigned short>> result(data.size(), std::vector<unsigned short>(slice_size));
+	auto result_slices = Pointers(result);
+	fid = io.Open(fname);
+	HDF5ChunkReader reader(2);
+	// the second half of the volume
+	BOOST_CHECK(reader.Read(fid, "Tissue", result_slices.data(), 2, slice_size, 3 * slice_size));
+	io.Close(fid);
+
+	BOOST_CHECK(result[0] == data[3]);
+	BOOST_CHECK(result[1] == data[4]);
+
+	boost::system::error_code ec;
+	fs::remove(fname, ec);
+}
+
+BOOST_AUTO_TEST_CASE(Fallback)
+{
+	size_t const slice_size = 100;
+	std::vector<std::vector<unsigned short>> data(4, std::vector<unsigned short>(slice_size, 7));
+	auto slices = Pointers(data);
+
+	std::string fname = TempFile();
+	HDF5IO io(1);
+	// chunks do not correspond to slices
+	io.m_ChunkSize = 3 * slice_size;
+	auto fid = io.Create(fname);
+	BOOST_REQUIRE(fid >= 0);
+	BOOST_CHECK(io.WriteData(fid, "Tissue", slices.data(), slices.size(), slice_size));
+	io.Close(fid);
+
+	fid = io.Open(fname);
+	HDF5ChunkReader reader;
+	BOOST_CHECK(!reader.Read(fid, "Tissue", slices.data(), slices.size(), slice_size));
+	BOOST_CHECK(reader.Fallback());
+	// other type
+	std::vector<float> buffer(slice_size);
+	float* float_slices[] = {buffer.data()};
+	BOOST_CHECK(!reader.Read(fid, "Tissue", float_slices, 1, slice_size));
+	BOOST_CHECK(reader.Fallback());
+	io.Close(fid);
+
+	boost::system::error_code ec;
+	fs::remove(fname, ec);
+}
+
+BOOST_AUTO_TEST_CASE(Decompress)
+{
+	std::vector<int> data(5000);
+	for (size_t i = 0; i < data.size(); ++i)
+		data[i] = static_cast<int>(i % 17);
+	size_t const bytes = data.size() * sizeof(int);
+
+	std::vector<std::uint8_t> compressed;
+	BOOST_REQUIRE(HDF5ChunkWriter::Compress(data.data(), bytes, sizeof(int), H5Z_FILTER_DEFLATE, 6, compressed));
+
+	std::vector<int> result(data.size());
+	BOOST_CHECK(HDF5ChunkReader::Decompress(compressed.data(), compressed.size(), H5Z_FILTER_DEFLATE, result.data(), bytes));
+	BOOST_CHECK(result == data);
+	// the chunk must fill the slice exactly
+	BOOST_CHECK(!HDF5ChunkReader::Decompress(compressed.data(), compressed.size(), H5Z_FILTER_DEFLATE, result.data(), bytes - 4));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../HDF5ChunkWriter.h"
+
+#include "Data/ProgressInfo.h"
+
+#include <boost/filesystem.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace iseg {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+std::string TempFile()
+{
+	return (fs::temp_directory_path() / fs::unique_path("iseg-chunks-%%%%-%%%%.h5")).string();
+}
+
+template<typename T>
+std::vector<T> ReadAll(const std::string& fname, const std::string& name, size_t size)
+{
+	HDF5IO io;
+	auto fid = io.Open(fname);
+	std::vector<T> data(size);
+	BOOST_CHECK(io.ReadData(fid, name, 0, size, data.data()));
+	io.Close(fid);
+	return data;
+}
+
+class CountingProgress : public ProgressInfo
+{
+public:
+	void Increment() override { m_Count++; }
+
+	int m_Count = 0;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(HDF5ChunkWriter_suite);
+
+BOOST_AUTO_TEST_CASE(WriteRead)
+{
+	size_t const slice_size = 64 * 48;
+	size_t const num_slices = 9;
+
+	// smooth slices compress well, noise does not and is stored without filter
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> noise(0.f, 1.f);
+	std::vector<std::vector<float>> data(num_slices, std::vector<float>(slice_size));
+	for (size_t k = 0; k < num_slices; ++k)
+	{
+		for (size_t i = 0; i < slice_size; ++i)
+		{
+			data[k][i] = (k % 3 == 2) ? noise(rng) : static_cast<float>((i / 64 + k) % 7);
+		}
+	}
+	std::vector<float*> slices;
+	for (auto& d : data)
+		slices.push_back(d.data());
+	// a missing slice reads as zero
+	slices[4] = nullptr;
+
+	for (int compression : {0, 1, 9})
+	{
+		std::string fname = TempFile();
+		HDF5IO io;
+		auto fid = io.Create(fname);
+		BOOST_REQUIRE(fid >= 0);
+		BOOST_CHECK(HDF5ChunkWriter(compression, 3).Write(fid, "Source", slices.data(), num_slices, slice_size));
+		if (compression > 0)
+		{
+			hid_t dataset = H5Dopen2(fid, "Source", H5P_DEFAULT);
+			BOOST_CHECK_LT(H5Dget_storage_size(dataset), num_slices * slice_size * sizeof(float) / 2);
+			H5Dclose(dataset);
+		}
+		io.Close(fid);
+
+		auto result = ReadAll<float>(fname, "Source", num_slices * slice_size);
+		for (size_t k = 0; k < num_slices; ++k)
+		{
+			std::vector<float> slice(result.begin() + k * slice_size, result.begin() + (k + 1) * slice_size);
+			if (k == 4)
+				BOOST_CHECK(slice == std::vector<float>(slice_size, 0.f));
+			else
+				BOOST_CHECK(slice == data[k]);
+		}
+
+		boost::system::error_code ec;
+		fs::remove(fname, ec);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(WriteExisting)
+{
+	size_t const slice_size = 100;
+	std::vector<unsigned short> a(slice_size, 3), b(slice_size, 7);
+	std::vector<unsigned short*> first = {a.data(), nullptr};
+	std::vector<unsigned short*> second = {b.data()};
+
+	std::string fname = TempFile();
+	HDF5IO io;
+	auto fid = io.Create(fname);
+	BOOST_REQUIRE(fid >= 0);
+	HDF5ChunkWriter writer(1, 2);
+	BOOST_CHECK(writer.Write(fid, "Tissue", first.data(), 2, slice_size));
+	// fill in the second slice, e.g. when merging projects
+	BOOST_CHECK(writer.Write(fid, "Tissue", second.data(), 1, slice_size, slice_size));
+	io.Close(fid);
+
+	auto result = ReadAll<unsigned short>(fname, "Tissue", 2 * slice_size);
+	BOOST_CHECK(std::vector<unsigned short>(result.begin(), result.begin() + slice_size) == a);
+	BOOST_CHECK(std::vector<unsigned short>(result.begin() + slice_size, result.end()) == b);
+
+	boost::system::error_code ec;
+	fs::remove(fname, ec);
+}
+
+BOOST_AUTO_TEST_CASE(Progress)
+{
+	size_t const slice_size = 200;
+	std::vector<std::vector<float>> data(6, std::vector<float>(slice_size, 1.f));
+	std::vector<float*> slices;
+	for (auto& d : data)
+		slices.push_back(d.data());
+	slices[2] = nullptr;
+
+	std::string fname = TempFile();
+	HDF5IO io;
+	auto fid = io.Create(fname);
+	BOOST_REQUIRE(fid >= 0);
+	CountingProgress progress;
+	HDF5ChunkWriter writer(1, 2);
+	writer.SetProgress(&progress);
+	BOOST_CHECK(writer.Write(fid, "Target", slices.data(), slices.size(), slice_size));
+	io.Close(fid);
+	// skipped slices count as well
+	BOOST_CHECK_EQUAL(progress.m_Count, 6);
+
+	boost::system::error_code ec;
+	fs::remove(fname, ec);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
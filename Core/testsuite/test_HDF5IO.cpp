@@ -13,6 +13,7 @@
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <string>
 
@@ -81,6 +82,73 @@ BOOST_AUTO_TEST_CASE(WriteRead)
 	}
 }
 
+BOOST_AUTO_TEST_CASE(LargeOffsets)
+{
+	boost::system::error_code ec;
+	std::string fname = (fs::temp_directory_path() / fs::path("foo_large.h5")).string();
+	if (fs::exists(fname, ec))
+	{
+		fs::remove(fname, ec);
+	}
+
+	// 300 slices of 4096x4096 voxels, i.e. more than 2^32 voxels. Only a few slices are written,
+	// chunks which are never written are not allocated in the file.
+	std::string dname = "MyArray";
+	size_t const slice_size = 4096 * 4096;
+	size_t const num_slices = 300;
+	size_t const first_above = (size_t(1) << 32) / slice_size;
+	BOOST_REQUIRE(num_slices * slice_size > (size_t(1) << 32));
+
+	std::vector<float> data1(slice_size);
+	std::vector<float> data2(slice_size);
+	for (size_t i = 0; i < slice_size; ++i)
+	{
+		data1[i] = static_cast<float>(i % 251);
+		data2[i] = static_cast<float>(i % 127) + 0.5f;
+	}
+	std::vector<float*> slices(num_slices, nullptr);
+	slices[first_above] = data1.data();
+	slices[num_slices - 1] = data2.data();
+
+	iseg::HDF5IO io(1);
+	{
+		auto fid = io.Create(fname, false);
+		BOOST_REQUIRE(fid >= 0);
+		BOOST_CHECK(io.WriteData(fid, dname, slices.data(), num_slices, slice_size));
+		BOOST_CHECK(io.Close(fid));
+	}
+
+	{
+		auto fid = io.Open(fname);
+		BOOST_REQUIRE(fid >= 0);
+
+		std::vector<float> data(slice_size);
+		BOOST_CHECK(io.ReadData(fid, dname, first_above * slice_size, slice_size, data.data()));
+		BOOST_CHECK(data == data1);
+
+		BOOST_CHECK(io.ReadData(fid, dname, (num_slices - 1) * slice_size, slice_size, data.data()));
+		BOOST_CHECK(data == data2);
+
+		// the slice below 2^32 was not written, i.e. it must not alias one of the slices above
+		BOOST_CHECK(io.ReadData(fid, dname, (first_above - 1) * slice_size, slice_size, data.data()));
+		BOOST_CHECK(std::all_of(data.begin(), data.end(), [](float v) { return v == 0.f; }));
+
+		// a range crossing the 2^32 boundary
+		size_t const n = 64;
+		std::vector<float> cross(2 * n);
+		BOOST_CHECK(io.ReadData(fid, dname, first_above * slice_size - n, 2 * n, cross.data()));
+		BOOST_CHECK(std::all_of(cross.begin(), cross.begin() + n, [](float v) { return v == 0.f; }));
+		BOOST_CHECK(std::equal(cross.begin() + n, cross.end(), data1.begin()));
+
+		BOOST_CHECK(io.Close(fid));
+	}
+
+	if (fs::exists(fname, ec))
+	{
+		fs::remove(fname, ec);
+	}
+}
+
 BOOST_AUTO_TEST_CASE(IO_Performance)
 {
 	std::string dname = "MyArray";
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../HDF5IO.h"
+#include "../HDF5Reader.h"
+#include "../VolumeRegion.h"
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <vector>
+
+namespace iseg {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+template<typename T>
+std::vector<T*> Pointers(std::vector<std::vector<T>>& data)
+{
+	std::vector<T*> slices;
+	for (auto& d : data)
+		slices.push_back(d.data());
+	return slices;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(HDF5Reader_suite);
+
+BOOST_AUTO_TEST_CASE(ReadRegion)
+{
+	unsigned const dims[3] = {11, 9, 7};
+	size_t const area = dims[0] * dims[1];
+	std::vector<std::vector<unsigned short>> data(dims[2], std::vector<unsigned short>(area));
+	for (size_t k = 0; k < data.size(); ++k)
+	{
+		for (size_t i = 0; i < area; ++i)
+			data[k][i] = static_cast<unsigned short>(k * area + i);
+	}
+	auto slices = Pointers(data);
+
+	std::string fname = (fs::temp_directory_path() / fs::unique_path("iseg-region-%%%%-%%%%.h5")).string();
+	HDF5IO io(1);
+	auto fid = io.Create(fname);
+	BOOST_REQUIRE(fid >= 0);
+	BOOST_CHECK(io.WriteData(fid, "Tissue", slices.data(), slices.size(), area));
+	io.Close(fid);
+
+	HDF5Reader reader;
+	BOOST_REQUIRE(reader.Open(fname));
+
+	for (unsigned step : {1, 2, 3})
+	{
+		VolumeRegion region;
+		region.m_Start[0] = 2;
+		region.m_Start[1] = 3;
+		region.m_Start[2] = 1;
+		region.m_Size[0] = 8;
+		region.m_Step = step;
+		BOOST_REQUIRE(region.Clip(dims));
+		BOOST_CHECK_EQUAL(region.m_Size[0], 8);
+		BOOST_CHECK_EQUAL(region.m_Size[1], 6);
+		BOOST_CHECK_EQUAL(region.m_Size[2], 6);
+		BOOST_CHECK(!region.IsWhole(dims));
+
+		unsigned const nx = region.Dim(0), ny = region.Dim(1), nz = region.Dim(2);
+		std::vector<std::vector<float>> result(nz, std::vector<float>(nx * ny, -1.f));
+		auto result_slices = Pointers(result);
+		BOOST_CHECK(reader.Read(result_slices.data(), dims, region, "Tissue"));
+
+		bool ok = true;
+		for (unsigned k = 0; k < nz; ++k)
+		{
+			for (unsigned j = 0; j < ny; ++j)
+			{
+				for (unsigned i = 0; i < nx; ++i)
+				{
+					size_t const x = region.m_Start[0] + i * step, y = region.m_Start[1] + j * step;
+					ok = ok && result[k][j * nx + i] == static_cast<float>(data[region.m_Start[2] + k * step][y * dims[0] + x]);
+				}
+			}
+		}
+		BOOST_CHECK_MESSAGE(ok, "region read with step " << step << " differs");
+	}
+
+	// the dataset is smaller than the volume
+	unsigned const larger[3] = {11, 9, 8};
+	VolumeRegion whole;
+	BOOST_REQUIRE(whole.Clip(larger));
+	BOOST_CHECK(whole.IsWhole(larger));
+	std::vector<std::vector<unsigned short>> result(8, std::vector<unsigned short>(area));
+	auto result_slices = Pointers(result);
+	BOOST_CHECK(!reader.Read(result_slices.data(), larger, whole, "Tissue"));
+
+	reader.Close();
+
+	boost::system::error_code ec;
+	fs::remove(fname, ec);
+}
+
+BOOST_AUTO_TEST_CASE(ClipRegion)
+{
+	unsigned const dims[3] = {4, 4, 4};
+	VolumeRegion region;
+	region.m_Start[2] = 4;
+	BOOST_CHECK(!region.Clip(dims));
+
+	region.m_Start[2] = 1;
+	region.m_Size[2] = 10;
+	region.m_Step = 0;
+	BOOST_CHECK(region.Clip(dims));
+	BOOST_CHECK_EQUAL(region.m_Size[2], 3);
+	BOOST_CHECK_EQUAL(region.m_Step, 1);
+	BOOST_CHECK_EQUAL(region.Dim(2), 3);
+
+	float spacing[3] = {0.5f, 1.f, 2.f};
+	Transform transform;
+	region.m_Step = 2;
+	region.Apply(spacing, transform);
+	BOOST_CHECK_EQUAL(spacing[0], 1.f);
+	BOOST_CHECK_EQUAL(spacing[2], 4.f);
+	float offset[3];
+	transform.GetOffset(offset);
+	BOOST_CHECK_EQUAL(offset[2], 2.f);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
@@ -30,13 +30,13 @@ namespace {
 
 class TestHandler : public SlicesHandlerInterface
 {
-	unsigned short m_Dims[3];
-	unsigned short m_Start;
-	unsigned short m_End;
-	unsigned short m_ActiveSlice = 0;
+	unsigned m_Dims[3];
+	unsigned m_Start;
+	unsigned m_End;
+	unsigned m_ActiveSlice = 0;
 
 public:
-	TestHandler(unsigned short w, unsigned short h, unsigned short nrslices, unsigned short start = 0, unsigned short end = 0)
+	TestHandler(unsigned w, unsigned h, unsigned nrslices, unsigned start = 0, unsigned end = 0)
 	{
 		m_Dims[0] = w;
 		m_Dims[1] = h;
@@ -44,8 +44,8 @@ public:
 		m_Start = start;
 		m_End = (end == 0) ? nrslices : end;
 
-		m_FloatData.resize(m_Dims[0] * m_Dims[1] * m_Dims[2], 1.3f);
-		m_TissueData.resize(m_Dims[0] * m_Dims[1] * m_Dims[2], tissues_size_t(3));
+		m_FloatData.resize(static_cast<size_t>(m_Dims[0]) * m_Dims[1] * m_Dims[2], 1.3f);
+		m_TissueData.resize(static_cast<size_t>(m_Dims[0]) * m_Dims[1] * m_Dims[2], tissues_size_t(3));
 	}
 
 	std::vector<float> m_FloatData;
@@ -53,14 +53,14 @@ public:
 	Transform m_Transform;
 	Vec3 m_Spacing;
 
-	unsigned short Width() const override { return m_Dims[0]; }
-	unsigned short Height() const override { return m_Dims[1]; }
-	unsigned short NumSlices() const override { return m_Dims[2]; }
-	unsigned short StartSlice() const override { return m_Start; }
-	unsigned short EndSlice() const override { return m_End; }
+	unsigned Width() const override { return m_Dims[0]; }
+	unsigned Height() const override { return m_Dims[1]; }
+	unsigned NumSlices() const override { return m_Dims[2]; }
+	unsigned StartSlice() const override { return m_Start; }
+	unsigned EndSlice() const override { return m_End; }
 
-	unsigned short ActiveSlice() const override { return m_ActiveSlice; }
-	void SetActiveSlice(unsigned short slice, bool signal_change) override { m_ActiveSlice = slice; }
+	unsigned ActiveSlice() const override { return m_ActiveSlice; }
+	void SetActiveSlice(unsigned slice, bool signal_change) override { m_ActiveSlice = slice; }
 
 	Transform ImageTransform() const override { return m_Transform; }
 	Vec3 Spacing() const override { return m_Spacing; }
@@ -161,12 +161,12 @@ public:
 class TestIO
 {
 public:
-	TestIO(const std::string& fname, bool non_trivial_transform, float tolerance = 1e-2f)
+	TestIO(const std::string& fname, bool non_trivial_transform, float tolerance = 1e-2f, unsigned nrslices = 3)
 			: m_FileName(fname), m_Tolerance(tolerance)
 	{
 		m_Dims[0] = 4;
 		m_Dims[1] = 7;
-		m_Dims[2] = 3;
+		m_Dims[2] = nrslices;
 
 		m_Spacing[0] = 0.5;
 		m_Spacing[1] = 1.0;
@@ -249,7 +249,7 @@ public:
 			std::vector<float*> slices(m_Dims[2]);
 			for (unsigned s = 0; s < m_Dims[2]; s++)
 			{
-				slices[s] = data.data() + s * m_Dims[0] * m_Dims[1];
+				slices[s] = data.data() + static_cast<size_t>(s) * m_Dims[0] * m_Dims[1];
 			}
 			BOOST_REQUIRE(ImageReader::GetVolume(m_FileName.string().c_str(), slices.data(), 0, nrslices, width, height));
 
@@ -318,15 +318,48 @@ public:
 		}
 	}
 
+	void TestStack(const std::string& extension, unsigned nrslices)
+	{
+		// more files than are decoded concurrently, each with its own color
+		std::vector<std::string> files;
+		for (unsigned i = 0; i < nrslices; i++)
+		{
+			files.push_back("temp_stack" + std::to_string(i) + extension);
+			WriteRGBImage(files.back(), static_cast<unsigned char>(i));
+		}
+
+		unsigned w, h;
+		BOOST_REQUIRE(ImageReader::GetInfo2D(files[0], w, h));
+
+		std::vector<std::vector<float>> data(nrslices, std::vector<float>(w * h, -1.f));
+		std::vector<float*> stack;
+		for (auto& slice : data)
+		{
+			stack.push_back(slice.data());
+		}
+		BOOST_REQUIRE(ImageReader::GetImageStack(files, stack.data(), w, h, [](unsigned char, unsigned char g, unsigned char) { return static_cast<float>(g); }));
+
+		for (unsigned i = 0; i < nrslices; i++)
+		{
+			BOOST_CHECK(data[i] == std::vector<float>(w * h, static_cast<float>(i)));
+		}
+
+		boost::system::error_code ec;
+		for (const auto& file_path : files)
+		{
+			boost::filesystem::remove(file_path, ec);
+		}
+	}
+
 private:
-	itk::Image<itk::RGBPixel<unsigned char>, 2>::Pointer WriteRGBImage(const std::string& file_path)
+	itk::Image<itk::RGBPixel<unsigned char>, 2>::Pointer WriteRGBImage(const std::string& file_path, unsigned char green = 234)
 	{
 		using rgb_type = itk::RGBPixel<unsigned char>;
 		using rgb_image_type = itk::Image<rgb_type, 2>;
 
 		rgb_type val;
 		val[0] = 1;
-		val[1] = 234;
+		val[1] = green;
 		val[2] = 171;
 
 		rgb_image_type::SizeType size;
@@ -363,6 +396,14 @@ BOOST_AUTO_TEST_CASE(Metaheader)
 	test.Read();
 }
 
+// the data is compressed after writing
+BOOST_AUTO_TEST_CASE(MetaImage)
+{
+	TestIO test("temp.mha", true);
+	test.Write();
+	test.Read();
+}
+
 BOOST_AUTO_TEST_CASE(Nifti)
 {
 	// BL TODO why is this SOO bad at serializing the transform?
@@ -392,6 +433,14 @@ BOOST_AUTO_TEST_CASE(VTI)
 	test.Read();
 }
 
+// more slices than fit into 16-bit extents
+BOOST_AUTO_TEST_CASE(LargeSliceCount)
+{
+	TestIO test("temp_large.mhd", false, 1e-2f, 70000);
+	test.Write();
+	test.Read();
+}
+
 // --run_test=iSeg_suite/ImageIO_suite/PNG --log_level=message
 //BOOST_AUTO_TEST_CASE(PNG)
 //{
@@ -410,6 +459,12 @@ BOOST_AUTO_TEST_CASE(ColorImages)
 	test.Test("temp.jpg");
 }
 
+BOOST_AUTO_TEST_CASE(ColorImageStack)
+{
+	TestColorImageIO test;
+	test.TestStack(".png", 67);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 BOOST_AUTO_TEST_SUITE_END();
 
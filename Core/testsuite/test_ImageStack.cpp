@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../ImageStack.h"
+
+#include <vector>
+
+namespace iseg {
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(ImageStack_suite);
+
+namespace {
+
+std::vector<float> MakeImage(size_t area, int seed)
+{
+	// piecewise constant, like a typical target or tissue image
+	std::vector<float> bits(area);
+	for (size_t i = 0; i < area; ++i)
+	{
+		bits[i] = (i / 97 + seed) % 3 == 0 ? 255.f : static_cast<float>(seed);
+	}
+	return bits;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Codec)
+{
+	size_t const area = 300 * 200;
+	auto bits = MakeImage(area, 4);
+
+	auto data = ImageStack::Compress(bits.data(), area, false);
+	BOOST_CHECK_LT(data.size() * 10, area * sizeof(float));
+
+	std::vector<float> result(area, -1.f);
+	BOOST_CHECK(ImageStack::Decompress(data.data(), data.size(), result.data(), area));
+	BOOST_CHECK(result == bits);
+
+	// poorly compressible data never grows beyond the raw size
+	std::vector<float> noise(area);
+	unsigned state = 1;
+	for (auto& v : noise)
+	{
+		state = state * 1664525u + 1013904223u;
+		v = static_cast<float>(state) / 7.f;
+	}
+	data = ImageStack::Compress(noise.data(), area, false);
+	BOOST_CHECK_LE(data.size(), 1 + area * sizeof(float));
+	BOOST_CHECK(ImageStack::Decompress(data.data(), data.size(), result.data(), area));
+	BOOST_CHECK(result == noise);
+}
+
+BOOST_AUTO_TEST_CASE(PushGetPop)
+{
+	size_t const area = 64 * 64;
+	auto a = MakeImage(area, 1);
+	auto b = MakeImage(area, 2);
+
+	ImageStack stack;
+	unsigned const ia = stack.Push(a.data(), area, 1);
+	unsigned const ib = stack.Push(b.data(), area, 2);
+	BOOST_CHECK_GT(ia, 0);
+	BOOST_CHECK_EQUAL(ib, ia + 1);
+	BOOST_CHECK_EQUAL(stack.Back(), ib);
+
+	std::vector<float> result(area);
+	unsigned char mode = 0;
+	BOOST_CHECK(stack.Get(ia, result.data(), mode));
+	BOOST_CHECK(result == a);
+	BOOST_CHECK_EQUAL(mode, 1);
+
+	BOOST_CHECK(stack.Pop(result.data(), mode));
+	BOOST_CHECK(result == b);
+	BOOST_CHECK_EQUAL(mode, 2);
+	BOOST_CHECK_EQUAL(stack.Size(), 1);
+
+	stack.Remove(ia);
+	BOOST_CHECK(stack.Empty());
+	BOOST_CHECK(!stack.Pop(result.data(), mode));
+	BOOST_CHECK_EQUAL(stack.MemoryUsage(), 0);
+
+	// ids are not reused
+	BOOST_CHECK_GT(stack.Push(a.data(), area, 1), ib);
+}
+
+BOOST_AUTO_TEST_CASE(MultiSliceEntry)
+{
+	size_t const area = 50 * 40;
+	std::vector<std::vector<float>> slices;
+	for (int k = 0; k < 5; ++k)
+	{
+		slices.push_back(MakeImage(area, k));
+	}
+
+	ImageStack stack;
+	unsigned const first = stack.Push(5, area, 1, [&](unsigned k) { return slices[k].data(); });
+	BOOST_CHECK_EQUAL(stack.Size(), 5);
+	BOOST_CHECK_EQUAL(stack.Back(), first + 4);
+
+	std::vector<float> result(area);
+	unsigned char mode = 0;
+	for (unsigned k = 0; k < 5; ++k)
+	{
+		BOOST_CHECK(stack.Get(first + k, result.data(), mode));
+		BOOST_CHECK(result == slices[k]);
+	}
+
+	// removing single slices of an entry keeps the others
+	stack.Remove(first + 2);
+	BOOST_CHECK(!stack.Contains(first + 2));
+	BOOST_CHECK(stack.Get(first + 3, result.data(), mode));
+	BOOST_CHECK(result == slices[3]);
+
+	BOOST_CHECK(stack.Insert(first + 2, slices[0].data(), area, 3));
+	BOOST_CHECK(!stack.Insert(first + 2, slices[0].data(), area, 3));
+	BOOST_CHECK(stack.SetMode(first + 2, 4));
+	BOOST_CHECK(stack.Get(first + 2, result.data(), mode));
+	BOOST_CHECK(result == slices[0]);
+	BOOST_CHECK_EQUAL(mode, 4);
+}
+
+BOOST_AUTO_TEST_CASE(Spill)
+{
+	size_t const area = 128 * 128;
+	ImageStack stack;
+
+	std::vector<std::vector<float>> images;
+	std::vector<unsigned> ids;
+	for (int k = 0; k < 8; ++k)
+	{
+		images.push_back(MakeImage(area, k));
+		ids.push_back(stack.Push(images.back().data(), area, 1));
+	}
+	size_t const total = stack.MemoryUsage();
+	BOOST_CHECK_EQUAL(stack.SpilledBytes(), 0);
+
+	stack.SetMemoryBudget(total / 3);
+	BOOST_CHECK_LE(stack.MemoryUsage(), total / 3);
+	BOOST_CHECK_EQUAL(stack.MemoryUsage() + stack.SpilledBytes(), total);
+
+	std::vector<float> result(area);
+	unsigned char mode = 0;
+	for (size_t k = 0; k < ids.size(); ++k)
+	{
+		BOOST_CHECK(stack.Get(ids[k], result.data(), mode));
+		BOOST_CHECK(result == images[k]);
+	}
+
+	for (auto id : ids)
+	{
+		stack.Remove(id);
+	}
+	BOOST_CHECK_EQUAL(stack.SpilledBytes(), 0);
+	BOOST_CHECK_EQUAL(stack.MemoryUsage(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../LabelFieldWriter.h"
+
+#include <itk_zlib.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace iseg {
+
+namespace {
+
+std::vector<std::uint8_t> DecodeByteRLE(const std::uint8_t* data, size_t size)
+{
+	std::vector<std::uint8_t> out;
+	size_t i = 0;
+	while (i < size)
+	{
+		unsigned const c = data[i++];
+		if (c & 0x80)
+		{
+			out.insert(out.end(), data + i, data + i + (c & 0x7f));
+			i += c & 0x7f;
+		}
+		else
+		{
+			out.insert(out.end(), c, data[i++]);
+		}
+	}
+	return out;
+}
+
+class Volume
+{
+public:
+	Volume(unsigned w, unsigned h, unsigned n, unsigned max_label) : m_Dims{w, h, n}, m_Data(static_cast<size_t>(w) * h * n)
+	{
+		for (size_t i = 0; i < m_Data.size(); i++)
+		{
+			// runs of labels with some noise
+			m_Data[i] = static_cast<tissues_size_t>((i % 97 < 5 ? i * 31 : i / 40) % (max_label + 1));
+		}
+		for (unsigned k = 0; k < n; k++)
+		{
+			m_Slices.push_back(m_Data.data() + static_cast<size_t>(k) * w * h);
+		}
+	}
+
+	unsigned m_Dims[3];
+	std::vector<tissues_size_t> m_Data;
+	std::vector<const tissues_size_t*> m_Slices;
+};
+
+class TempFile
+{
+public:
+	TempFile(const std::string& ext) : m_Path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("iseg-%%%%-%%%%" + ext)) {}
+	~TempFile()
+	{
+		boost::system::error_code ec;
+		boost::filesystem::remove(m_Path, ec);
+	}
+
+	std::string Name() const { return m_Path.string(); }
+
+	std::string Read() const
+	{
+		std::ifstream in(Name(), std::ios::binary);
+		return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	}
+
+private:
+	boost::filesystem::path m_Path;
+};
+
+/// Returns the data after the line "@1" of the data section, and checks the encoding in the header
+std::string AmiraData(const std::string& file, const std::string& encoding)
+{
+	size_t const section = file.find("# Data section follows\n@1\n");
+	BOOST_REQUIRE(section != std::string::npos);
+	BOOST_CHECK(file.find("@1" + encoding + "\n") != std::string::npos);
+	return file.substr(section + 26);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(LabelFieldWriter_suite);
+
+BOOST_AUTO_TEST_CASE(ByteRLE)
+{
+	std::vector<std::uint8_t> data(1000, 7);
+	for (size_t i = 300; i < 600; i++)
+	{
+		data[i] = static_cast<std::uint8_t>(i * 13);
+	}
+	data[700] = 1;
+	data[701] = 1;
+
+	std::vector<std::uint8_t> encoded;
+	LabelFieldWriter::EncodeByteRLE(data.data(), data.size(), encoded);
+	BOOST_CHECK(encoded.size() < data.size() / 2);
+	BOOST_CHECK(DecodeByteRLE(encoded.data(), encoded.size()) == data);
+}
+
+BOOST_AUTO_TEST_CASE(AmiraMeshRLE)
+{
+	Volume volume(31, 17, 5, 40);
+	float const spacing[3] = {0.5f, 1.f, 2.f};
+	LabelFieldWriter writer(volume.m_Slices.data(), 31, 17, 5, spacing, 40);
+
+	TempFile file(".am");
+	BOOST_REQUIRE(writer.WriteAmiraMesh(file.Name(), {{"Bone", {1.f, 1.f, 1.f}}}));
+	auto const content = file.Read();
+	BOOST_CHECK(content.find("# AmiraMesh BINARY-LITTLE-ENDIAN 2.1") == 0);
+	BOOST_CHECK(content.find("Bone {") != std::string::npos);
+
+	auto const data = AmiraData(content, "(HxByteRLE," + std::to_string(content.size() - content.find("# Data section follows") - 27) + ")");
+	auto const labels = DecodeByteRLE(reinterpret_cast<const std::uint8_t*>(data.data()), data.size() - 1);
+	BOOST_CHECK(std::vector<tissues_size_t>(labels.begin(), labels.end()) == volume.m_Data);
+}
+
+BOOST_AUTO_TEST_CASE(AmiraMeshZip)
+{
+	Volume volume(31, 17, 5, 400);
+	float const spacing[3] = {1.f, 1.f, 1.f};
+	LabelFieldWriter writer(volume.m_Slices.data(), 31, 17, 5, spacing, 400);
+
+	TempFile file(".am");
+	BOOST_REQUIRE(writer.WriteAmiraMesh(file.Name(), {}));
+	auto const content = file.Read();
+	BOOST_CHECK(content.find("Lattice { ushort Labels } @1(HxZip,") != std::string::npos);
+
+	auto const data = AmiraData(content, "");
+	std::vector<std::uint16_t> labels(volume.m_Data.size());
+	uLongf size = static_cast<uLongf>(labels.size() * 2);
+	BOOST_REQUIRE(uncompress(reinterpret_cast<Bytef*>(labels.data()), &size, reinterpret_cast<const Bytef*>(data.data()), static_cast<uLong>(data.size() - 1)) == Z_OK);
+	BOOST_CHECK_EQUAL(size, labels.size() * 2);
+	BOOST_CHECK(std::vector<tissues_size_t>(labels.begin(), labels.end()) == volume.m_Data);
+}
+
+BOOST_AUTO_TEST_CASE(LegacyVtk)
+{
+	Volume volume(6, 4, 3, 1000);
+	float const spacing[3] = {1.f, 1.f, 1.f};
+	LabelFieldWriter writer(volume.m_Slices.data(), 6, 4, 3, spacing, 1000);
+
+	TempFile file(".vtk");
+	BOOST_REQUIRE(writer.WriteVtk(file.Name()));
+	auto const content = file.Read();
+	std::string const table = "LOOKUP_TABLE default\n";
+	size_t const pos = content.find(table);
+	BOOST_REQUIRE(pos != std::string::npos);
+	BOOST_CHECK(content.find("SCALARS Labels unsigned_short 1") != std::string::npos);
+
+	// big-endian
+	auto const* data = reinterpret_cast<const std::uint8_t*>(content.data() + pos + table.size());
+	bool ok = true;
+	for (size_t i = 0; i < volume.m_Data.size(); i++)
+	{
+		ok = ok && (data[2 * i] << 8 | data[2 * i + 1]) == volume.m_Data[i];
+	}
+	BOOST_CHECK(ok);
+}
+
+BOOST_AUTO_TEST_CASE(CompressedVti)
+{
+	// more than one compressed block
+	Volume volume(600, 500, 5, 200);
+	float const spacing[3] = {1.f, 1.f, 1.f};
+	LabelFieldWriter writer(volume.m_Slices.data(), 600, 500, 5, spacing, 200);
+
+	TempFile file(".vti");
+	BOOST_REQUIRE(writer.WriteVti(file.Name()));
+	auto const content = file.Read();
+	BOOST_CHECK(content.find("compressor=\"vtkZLibDataCompressor\"") != std::string::npos);
+	size_t const pos = content.find("   _");
+	BOOST_REQUIRE(pos != std::string::npos);
+
+	const char* header = content.data() + pos + 4;
+	std::uint64_t values[3];
+	std::memcpy(values, header, 24);
+	BOOST_REQUIRE_EQUAL(values[0], 2);
+	BOOST_CHECK_EQUAL(values[2], volume.m_Data.size() % values[1]);
+
+	std::vector<std::uint8_t> labels;
+	const char* block = header + 8 * (3 + values[0]);
+	for (std::uint64_t b = 0; b < values[0]; b++)
+	{
+		std::uint64_t compressed = 0;
+		std::memcpy(&compressed, header + 8 * (3 + b), 8);
+		std::vector<std::uint8_t> out(values[1]);
+		uLongf size = static_cast<uLongf>(out.size());
+		BOOST_REQUIRE(uncompress(out.data(), &size, reinterpret_cast<const Bytef*>(block), static_cast<uLong>(compressed)) == Z_OK);
+		labels.insert(labels.end(), out.begin(), out.begin() + size);
+		block += compressed;
+	}
+	BOOST_CHECK(std::vector<tissues_size_t>(labels.begin(), labels.end()) == volume.m_Data);
+	BOOST_CHECK(std::string(block, 18) == "\n  </AppendedData>");
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
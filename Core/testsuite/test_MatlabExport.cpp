@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../MatlabExport.h"
+
+#include "Data/ProgressInfo.h"
+
+#include <itk_zlib.h>
+
+#include <hdf5.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace iseg {
+
+namespace {
+
+std::int32_t Int32(const std::string& data, size_t pos)
+{
+	std::int32_t value = 0;
+	std::memcpy(&value, data.data() + pos, 4);
+	return value;
+}
+
+/// Returns the uncompressed miMATRIX element of a compressed level 5 MAT-file
+std::string ReadMatrixElement(const std::string& filename)
+{
+	std::ifstream in(filename, std::ios::binary);
+	std::string const file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	BOOST_REQUIRE(file.size() > 136);
+	BOOST_CHECK(file.substr(124, 4) == std::string("\0\1IM", 4));
+	BOOST_CHECK_EQUAL(Int32(file, 128), 15);
+	BOOST_CHECK_EQUAL(Int32(file, 132), static_cast<std::int32_t>(file.size() - 136));
+
+	std::string element(1024 * 1024, '\0');
+	uLongf size = static_cast<uLongf>(element.size());
+	BOOST_REQUIRE(uncompress(reinterpret_cast<Bytef*>(&element[0]), &size, reinterpret_cast<const Bytef*>(file.data() + 136), static_cast<uLong>(file.size() - 136)) == Z_OK);
+	element.resize(size);
+	BOOST_CHECK_EQUAL(Int32(element, 0), 14);
+	BOOST_CHECK_EQUAL(Int32(element, 4), static_cast<std::int32_t>(element.size() - 8));
+	return element;
+}
+
+/// Checks the header of a v7.3 MAT-file and returns the dimensions and MATLAB_class of the variable, which is read into data
+template<typename T>
+std::string ReadV73(const std::string& filename, const char* varname, hid_t type, std::vector<T>& data, hsize_t dims[3])
+{
+	std::ifstream in(filename, std::ios::binary);
+	std::string header(128, '\0');
+	in.read(&header[0], 128);
+	BOOST_CHECK_EQUAL(header.substr(0, 10), "MATLAB 7.3");
+	BOOST_CHECK(header.substr(124, 4) == std::string("\0\2IM", 4));
+	in.close();
+
+	hid_t file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+	BOOST_REQUIRE(file >= 0);
+	hid_t dataset = H5Dopen2(file, varname, H5P_DEFAULT);
+	BOOST_REQUIRE(dataset >= 0);
+	hid_t space = H5Dget_space(dataset);
+	BOOST_REQUIRE_EQUAL(H5Sget_simple_extent_ndims(space), 3);
+	H5Sget_simple_extent_dims(space, dims, nullptr);
+	H5Sclose(space);
+
+	data.resize(dims[0] * dims[1] * dims[2] * (H5Tget_size(type) / sizeof(T)));
+	BOOST_CHECK(H5Dread(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data.data()) >= 0);
+
+	std::string class_name;
+	hid_t attribute = H5Aopen(dataset, "MATLAB_class", H5P_DEFAULT);
+	if (attribute >= 0)
+	{
+		hid_t string_type = H5Aget_type(attribute);
+		class_name.resize(H5Tget_size(string_type));
+		H5Aread(attribute, string_type, &class_name[0]);
+		H5Tclose(string_type);
+		H5Aclose(attribute);
+	}
+	H5Dclose(dataset);
+	H5Fclose(file);
+	return class_name;
+}
+
+class CountSteps : public ProgressInfo
+{
+public:
+	void SetNumberOfSteps(int N) override { m_Steps = N; }
+	void Increment() override { m_Done++; }
+
+	int m_Steps = 0;
+	int m_Done = 0;
+};
+
+class CancelAfter : public ProgressInfo
+{
+public:
+	CancelAfter(int steps) : m_Steps(steps) {}
+	void Increment() override { m_Steps--; }
+	bool WasCanceled() const override { return m_Steps <= 0; }
+
+private:
+	int m_Steps;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(MatlabExport_suite);
+
+BOOST_AUTO_TEST_CASE(TissueSlices)
+{
+	int const nx = 5, ny = 3, nz = 3;
+	std::vector<std::vector<tissues_size_t>> data(nz, std::vector<tissues_size_t>(nx * ny));
+	std::vector<tissues_size_t*> slices;
+	for (int k = 0; k < nz; k++)
+	{
+		for (int i = 0; i < nx * ny; i++)
+		{
+			data[k][i] = static_cast<tissues_size_t>(300 + k * nx * ny + i);
+		}
+		slices.push_back(data[k].data());
+	}
+
+	auto const path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("iseg-%%%%-%%%%.mat");
+	BOOST_REQUIRE(matexport::print_matslices(path.string().c_str(), slices.data(), nx, ny, nz, "iSeg tissue data v1.0", 21, "tissuedistrib", 13));
+	auto const element = ReadMatrixElement(path.string());
+
+	// array flags, dimensions and name
+	BOOST_CHECK_EQUAL(static_cast<int>(element[16]), 11);
+	BOOST_CHECK_EQUAL(static_cast<int>(element[17]), 0);
+	BOOST_CHECK_EQUAL(Int32(element, 32), nx);
+	BOOST_CHECK_EQUAL(Int32(element, 36), ny);
+	BOOST_CHECK_EQUAL(Int32(element, 40), nz);
+	BOOST_CHECK_EQUAL(Int32(element, 52), 13);
+	BOOST_CHECK_EQUAL(element.substr(56, 13), "tissuedistrib");
+
+	// real part, padded to 8 bytes
+	size_t const bytes = nx * ny * nz * sizeof(tissues_size_t);
+	BOOST_CHECK_EQUAL(Int32(element, 72), 4);
+	BOOST_CHECK_EQUAL(Int32(element, 76), static_cast<std::int32_t>(bytes));
+	BOOST_REQUIRE_EQUAL(element.size(), 80 + bytes + (8 - bytes % 8) % 8);
+	for (int k = 0; k < nz; k++)
+	{
+		BOOST_CHECK(std::memcmp(element.data() + 80 + k * nx * ny * sizeof(tissues_size_t), data[k].data(), nx * ny * sizeof(tissues_size_t)) == 0);
+	}
+
+	boost::system::error_code ec;
+	boost::filesystem::remove(path, ec);
+}
+
+BOOST_AUTO_TEST_CASE(Complex)
+{
+	int const nx = 3, ny = 1, nz = 1;
+	std::vector<float> data = {1.f, 2.f, 3.f, -1.f, -2.f, -3.f};
+
+	auto const path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("iseg-%%%%-%%%%.mat");
+	BOOST_REQUIRE(matexport::print_mat(path.string().c_str(), data.data(), nx, ny, nz, "", 0, "z", 1, true));
+	auto const element = ReadMatrixElement(path.string());
+
+	BOOST_CHECK_EQUAL(static_cast<int>(element[16]), 7);
+	BOOST_CHECK_EQUAL(static_cast<int>(element[17]), 8);
+	// real part of 12 bytes padded to 16, followed by the imaginary part
+	BOOST_CHECK_EQUAL(Int32(element, 64), 7);
+	BOOST_CHECK_EQUAL(Int32(element, 68), 12);
+	BOOST_CHECK(std::memcmp(element.data() + 72, data.data(), 12) == 0);
+	BOOST_CHECK_EQUAL(Int32(element, 88), 7);
+	BOOST_CHECK(std::memcmp(element.data() + 96, data.data() + 3, 12) == 0);
+	BOOST_CHECK_EQUAL(element.size(), 112);
+
+	boost::system::error_code ec;
+	boost::filesystem::remove(path, ec);
+}
+
+BOOST_AUTO_TEST_CASE(V73)
+{
+	int const nx = 5, ny = 3, nz = 4;
+	std::vector<std::vector<tissues_size_t>> data(nz, std::vector<tissues_size_t>(nx * ny));
+	std::vector<tissues_size_t*> slices;
+	for (int k = 0; k < nz; k++)
+	{
+		for (int i = 0; i < nx * ny; i++)
+		{
+			data[k][i] = static_cast<tissues_size_t>(300 + k * nx * ny + i);
+		}
+		slices.push_back(data[k].data());
+	}
+
+	auto const path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("iseg-%%%%-%%%%.mat");
+	CountSteps progress;
+	matexport::set_max_level5_bytes(0);
+	bool const ok = matexport::print_matslices(path.string().c_str(), slices.data(), nx, ny, nz, "iSeg tissue data v1.0", 21, "tissuedistrib", 13, &progress);
+	matexport::set_max_level5_bytes(0x7fffffff);
+	BOOST_REQUIRE(ok);
+	BOOST_CHECK_EQUAL(progress.m_Done, progress.m_Steps);
+
+	std::vector<tissues_size_t> read;
+	hsize_t dims[3];
+	BOOST_CHECK_EQUAL(ReadV73(path.string(), "tissuedistrib", sizeof(tissues_size_t) == 1 ? H5T_NATIVE_UCHAR : H5T_NATIVE_USHORT, read, dims), sizeof(tissues_size_t) == 1 ? "uint8" : "uint16");
+	// MATLAB arrays are column-major, i.e. the dimensions are reversed in HDF5
+	BOOST_CHECK_EQUAL(dims[0], static_cast<hsize_t>(nz));
+	BOOST_CHECK_EQUAL(dims[1], static_cast<hsize_t>(ny));
+	BOOST_CHECK_EQUAL(dims[2], static_cast<hsize_t>(nx));
+	BOOST_REQUIRE_EQUAL(read.size(), nx * ny * nz);
+	for (int k = 0; k < nz; k++)
+	{
+		BOOST_CHECK(std::equal(data[k].begin(), data[k].end(), read.begin() + k * nx * ny));
+	}
+
+	boost::system::error_code ec;
+	boost::filesystem::remove(path, ec);
+}
+
+BOOST_AUTO_TEST_CASE(V73Complex)
+{
+	int const nx = 3, ny = 1, nz = 2;
+	std::vector<float> real = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+	std::vector<float> imag = {-1.f, -2.f, -3.f, -4.f, -5.f, -6.f};
+	std::vector<float*> slices = {real.data(), real.data() + 3, imag.data(), imag.data() + 3};
+
+	auto const path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("iseg-%%%%-%%%%.mat");
+	CountSteps progress;
+	matexport::set_max_level5_bytes(0);
+	bool const ok = matexport::print_matslices(path.string().c_str(), slices.data(), nx, ny, nz, "", 0, "z", 1, true, &progress);
+	matexport::set_max_level5_bytes(0x7fffffff);
+	BOOST_REQUIRE(ok);
+	BOOST_CHECK_EQUAL(progress.m_Steps, 2 * nz);
+	BOOST_CHECK_EQUAL(progress.m_Done, progress.m_Steps);
+
+	hid_t type = H5Tcreate(H5T_COMPOUND, 2 * sizeof(float));
+	H5Tinsert(type, "real", 0, H5T_NATIVE_FLOAT);
+	H5Tinsert(type, "imag", sizeof(float), H5T_NATIVE_FLOAT);
+	std::vector<float> read;
+	hsize_t dims[3];
+	BOOST_CHECK_EQUAL(ReadV73(path.string(), "z", type, read, dims), "single");
+	H5Tclose(type);
+	BOOST_CHECK_EQUAL(dims[0], static_cast<hsize_t>(nz));
+	BOOST_CHECK_EQUAL(dims[1], static_cast<hsize_t>(ny));
+	BOOST_CHECK_EQUAL(dims[2], static_cast<hsize_t>(nx));
+	BOOST_REQUIRE_EQUAL(read.size(), 2 * real.size());
+	for (size_t i = 0; i < real.size(); i++)
+	{
+		BOOST_CHECK_EQUAL(read[2 * i], real[i]);
+		BOOST_CHECK_EQUAL(read[2 * i + 1], imag[i]);
+	}
+
+	boost::system::error_code ec;
+	boost::filesystem::remove(path, ec);
+}
+
+BOOST_AUTO_TEST_CASE(Cancel)
+{
+	int const nx = 4, ny = 4, nz = 8;
+	std::vector<unsigned char> data(nx * ny * nz, 1);
+	std::vector<unsigned char*> slices;
+	for (int k = 0; k < nz; k++)
+	{
+		slices.push_back(data.data() + k * nx * ny);
+	}
+
+	auto const path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("iseg-%%%%-%%%%.mat");
+	CancelAfter progress(3);
+	BOOST_CHECK(!matexport::print_matslices(path.string().c_str(), slices.data(), nx, ny, nz, "", 0, "a", 1, &progress));
+	BOOST_CHECK(!boost::filesystem::exists(path));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../ParallelGzip.h"
+
+#include <itk_zlib.h>
+
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace iseg {
+
+namespace {
+
+/// Label field with a few large regions, similar to a segmentation
+std::vector<std::uint16_t> Labels(size_t count)
+{
+	std::vector<std::uint16_t> labels(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		labels[i] = static_cast<std::uint16_t>((i / 1000 + (i % 1000) / 300) % 7);
+	}
+	return labels;
+}
+
+std::string Compress(const std::string& data, ParallelGzip::eFormat format, unsigned num_threads)
+{
+	std::istringstream in(data);
+	std::ostringstream out;
+	BOOST_REQUIRE(ParallelGzip(format, 6, num_threads).Compress(in, out));
+	return out.str();
+}
+
+/// Decompresses a gzip (windowBits 31) or zlib (windowBits 15) stream, which must end with the input
+std::string Inflate(const std::string& compressed, int window_bits, size_t size)
+{
+	std::string data(size + 1, '\0');
+	z_stream strm = {};
+	BOOST_REQUIRE(inflateInit2(&strm, window_bits) == Z_OK);
+	strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+	strm.avail_in = static_cast<uInt>(compressed.size());
+	strm.next_out = reinterpret_cast<Bytef*>(&data[0]);
+	strm.avail_out = static_cast<uInt>(data.size());
+	BOOST_CHECK_EQUAL(inflate(&strm, Z_FINISH), Z_STREAM_END);
+	BOOST_CHECK_EQUAL(strm.avail_in, 0);
+	data.resize(strm.total_out);
+	inflateEnd(&strm);
+	return data;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(ParallelGzip_suite);
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+	size_t const block_size = ParallelGzip::kBlockSize;
+	// empty, exactly one block, and more blocks than are compressed in one batch
+	for (size_t size : {size_t(0), block_size, 9 * block_size + 1234})
+	{
+		std::string data(size, '\0');
+		for (size_t i = 0; i < size; i++)
+		{
+			data[i] = static_cast<char>((i * 7) % 251 + (i / 100000));
+		}
+
+		for (unsigned num_threads : {1u, 3u})
+		{
+			BOOST_CHECK(Inflate(Compress(data, ParallelGzip::kGzip, num_threads), 16 + MAX_WBITS, size) == data);
+			BOOST_CHECK(Inflate(Compress(data, ParallelGzip::kZlib, num_threads), MAX_WBITS, size) == data);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(CompressFile)
+{
+	auto const labels = Labels(3 * ParallelGzip::kBlockSize);
+	auto const src = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("iseg-gzip-%%%%-%%%%.raw");
+	auto const dst = boost::filesystem::path(src.string() + ".gz");
+	{
+		std::ofstream out(src.string(), std::ios::binary);
+		out.write(reinterpret_cast<const char*>(labels.data()), labels.size() * sizeof(std::uint16_t));
+	}
+	BOOST_REQUIRE(ParallelGzip().CompressFile(src.string(), dst.string()));
+
+	// the stream is one gzip member, as written by gzwrite
+	std::vector<std::uint16_t> data(labels.size() + 1);
+	gzFile file = gzopen(dst.string().c_str(), "rb");
+	BOOST_REQUIRE(file != nullptr);
+	int const bytes = gzread(file, data.data(), static_cast<unsigned>(data.size() * sizeof(std::uint16_t)));
+	gzclose(file);
+	BOOST_CHECK_EQUAL(bytes, static_cast<int>(labels.size() * sizeof(std::uint16_t)));
+	data.resize(labels.size());
+	BOOST_CHECK(data == labels);
+
+	boost::system::error_code ec;
+	boost::filesystem::remove(src, ec);
+	boost::filesystem::remove(dst, ec);
+}
+
+// compares the throughput with gzwrite, which the NIfTI IO uses for .nii.gz
+// --run_test=iSeg_suite/ParallelGzip_suite/Throughput --log_level=message
+BOOST_AUTO_TEST_CASE(Throughput)
+{
+	auto const labels = Labels(32 * ParallelGzip::kBlockSize);
+	std::string const data(reinterpret_cast<const char*>(labels.data()), labels.size() * sizeof(std::uint16_t));
+	double const megabytes = data.size() / (1024.0 * 1024.0);
+
+	using clock_type = std::chrono::steady_clock;
+	auto seconds = [](clock_type::time_point start) {
+		return std::chrono::duration<double>(clock_type::now() - start).count();
+	};
+
+	auto const path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("iseg-gzip-%%%%-%%%%.gz");
+	auto start = clock_type::now();
+	gzFile file = gzopen(path.string().c_str(), "wb6");
+	BOOST_REQUIRE(file != nullptr);
+	gzwrite(file, data.data(), static_cast<unsigned>(data.size()));
+	gzclose(file);
+	double const gzwrite_seconds = seconds(start);
+	boost::system::error_code ec;
+	boost::filesystem::remove(path, ec);
+
+	start = clock_type::now();
+	auto const serial = Compress(data, ParallelGzip::kGzip, 1);
+	double const serial_seconds = seconds(start);
+
+	start = clock_type::now();
+	auto const parallel = Compress(data, ParallelGzip::kGzip, 0);
+	double const parallel_seconds = seconds(start);
+
+	BOOST_TEST_MESSAGE("gzwrite: " << megabytes / gzwrite_seconds << " MB/s");
+	BOOST_TEST_MESSAGE("ParallelGzip, 1 thread: " << megabytes / serial_seconds << " MB/s, ratio " << data.size() / double(serial.size()));
+	BOOST_TEST_MESSAGE("ParallelGzip, all cores: " << megabytes / parallel_seconds << " MB/s, ratio " << data.size() / double(parallel.size()));
+
+	// the output does not depend on the number of threads
+	BOOST_CHECK(serial == parallel);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../RawVolumeReader.h"
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace iseg {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+template<typename T>
+std::string WriteRaw(const std::vector<T>& data)
+{
+	auto path = fs::temp_directory_path() / fs::unique_path("iseg-raw-%%%%-%%%%.raw");
+	std::ofstream out(path.string().c_str(), std::ios::binary);
+	out.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(T));
+	return path.string();
+}
+
+template<typename T>
+std::vector<T> Ramp(size_t n, T modulo)
+{
+	std::vector<T> data(n);
+	for (size_t i = 0; i < n; ++i)
+		data[i] = static_cast<T>((i * 7) % static_cast<size_t>(modulo));
+	return data;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(RawVolumeReader_suite);
+
+BOOST_AUTO_TEST_CASE(ReadSlices)
+{
+	unsigned const w = 13, h = 7, n = 5;
+	size_t const area = w * h;
+	auto data = Ramp<unsigned short>(area * n, 60000);
+	// a truncated last slice is ignored
+	data.resize(data.size() + 3, 1);
+	std::string fname = WriteRaw(data);
+
+	{
+		RawVolumeReader reader(fname, w, h, 16);
+		BOOST_REQUIRE(reader.Valid());
+		BOOST_CHECK_EQUAL(reader.NumSlices(), n);
+		BOOST_CHECK(reader.Slice(0) == nullptr);
+
+		std::vector<std::vector<float>> result(3, std::vector<float>(area, -1.f));
+		std::vector<float*> slices = {result[0].data(), nullptr, result[2].data()};
+		BOOST_CHECK(reader.Read(slices.data(), 2, 3));
+		for (size_t i = 0; i < area; ++i)
+		{
+			BOOST_CHECK_EQUAL(result[0][i], static_cast<float>(data[2 * area + i]));
+			BOOST_CHECK_EQUAL(result[2][i], static_cast<float>(data[4 * area + i]));
+		}
+		BOOST_CHECK(result[1] == std::vector<float>(area, -1.f));
+
+		// beyond the end of the file
+		BOOST_CHECK(!reader.Read(slices.data(), 3, 3));
+	}
+
+	boost::system::error_code ec;
+	fs::remove(fname, ec);
+}
+
+BOOST_AUTO_TEST_CASE(ReadSubregion)
+{
+	unsigned const w = 10, h = 8, n = 3;
+	auto data = Ramp<unsigned char>(w * h * n, 255);
+	std::string fname = WriteRaw(data);
+
+	{
+		RawVolumeReader reader(fname, w, h, 8);
+		BOOST_REQUIRE(reader.Valid());
+
+		Point p;
+		p.px = 2;
+		p.py = 3;
+		unsigned const dx = 5, dy = 4;
+		std::vector<float> result(dx * dy);
+		float* slices[] = {result.data()};
+		BOOST_CHECK(reader.Read(slices, 1, 1, p, dx, dy));
+		for (unsigned y = 0; y < dy; ++y)
+		{
+			for (unsigned x = 0; x < dx; ++x)
+			{
+				BOOST_CHECK_EQUAL(result[y * dx + x], static_cast<float>(data[w * h + (p.py + y) * w + p.px + x]));
+			}
+		}
+
+		// the region must lie within the slice
+		p.px = 6;
+		BOOST_CHECK(!reader.Read(slices, 1, 1, p, dx, dy));
+	}
+
+	boost::system::error_code ec;
+	fs::remove(fname, ec);
+}
+
+BOOST_AUTO_TEST_CASE(FloatInPlace)
+{
+	unsigned const w = 4, h = 3, n = 2;
+	std::vector<float> data(w * h * n);
+	for (size_t i = 0; i < data.size(); ++i)
+		data[i] = 0.5f * static_cast<float>(i) - 3.f;
+	std::string fname = WriteRaw(data);
+
+	{
+		RawVolumeReader reader(fname, w, h, 32);
+		BOOST_REQUIRE(reader.Valid());
+		const float* slice = reader.Slice(1);
+		BOOST_REQUIRE(slice != nullptr);
+		BOOST_CHECK(std::vector<float>(slice, slice + w * h) == std::vector<float>(data.begin() + w * h, data.end()));
+		BOOST_CHECK(reader.Slice(2) == nullptr);
+	}
+
+	BOOST_CHECK(!RawVolumeReader(fname, w, h, 24).Valid());
+
+	boost::system::error_code ec;
+	fs::remove(fname, ec);
+	BOOST_CHECK(!RawVolumeReader(fname, w, h, 32).Valid());
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../SliceDelta.h"
+
+#include "Data/Types.h"
+
+#include <vector>
+
+namespace iseg {
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(SliceDelta_suite);
+
+BOOST_AUTO_TEST_CASE(Unchanged)
+{
+	std::vector<float> slice(1000, 3.f);
+	SliceDelta delta(slice.data(), slice.data(), slice.size() * sizeof(float));
+	BOOST_CHECK(delta.Empty());
+
+	auto copy = slice;
+	delta.Apply(copy.data());
+	BOOST_CHECK(copy == slice);
+}
+
+BOOST_AUTO_TEST_CASE(UndoRedo)
+{
+	size_t const area = 256 * 256;
+	std::vector<float> before(area, 0.f);
+	for (size_t i = 0; i < area; ++i)
+	{
+		before[i] = static_cast<float>(i % 17);
+	}
+	auto after = before;
+	// a brush stroke and a few scattered edits, including the last value
+	for (size_t i = 1000; i < 1400; ++i)
+	{
+		after[i] = 255.f;
+	}
+	after[5] = -1.f;
+	after[20000] = 7.5f;
+	after[area - 1] = 1.f;
+
+	SliceDelta delta(before.data(), after.data(), area * sizeof(float));
+	BOOST_CHECK(!delta.Empty());
+	BOOST_CHECK_LT(delta.MemoryUsage() * 20, area * sizeof(float));
+
+	auto data = after;
+	delta.Apply(data.data());
+	BOOST_CHECK(data == before);
+	delta.Apply(data.data());
+	BOOST_CHECK(data == after);
+}
+
+BOOST_AUTO_TEST_CASE(Tissues)
+{
+	size_t const area = 100 * 80;
+	std::vector<tissues_size_t> before(area, 0), after(area, 0);
+	for (size_t i = 0; i < area; ++i)
+	{
+		after[i] = static_cast<tissues_size_t>((i / 3) % 5 == 0 ? 300 : 0);
+	}
+
+	SliceDelta delta(before.data(), after.data(), area * sizeof(tissues_size_t));
+	auto data = before;
+	delta.Apply(data.data());
+	BOOST_CHECK(data == after);
+}
+
+BOOST_AUTO_TEST_CASE(FullSliceEdit)
+{
+	// e.g. 'clear target' or a threshold which sets every voxel
+	size_t const area = 512 * 512;
+	std::vector<float> before(area, 0.f), after(area, 255.f);
+
+	SliceDelta delta(before.data(), after.data(), area * sizeof(float));
+	BOOST_CHECK(!delta.Empty());
+	BOOST_CHECK_LT(delta.MemoryUsage() * 1000, area * sizeof(float));
+
+	auto data = before;
+	delta.Apply(data.data());
+	BOOST_CHECK(data == after);
+	delta.Apply(data.data());
+	BOOST_CHECK(data == before);
+}
+
+BOOST_AUTO_TEST_CASE(Incompressible)
+{
+	size_t const area = 128 * 128;
+	std::vector<float> before(area), after(area);
+	unsigned state = 12345;
+	for (size_t i = 0; i < area; ++i)
+	{
+		state = state * 1103515245u + 12345u;
+		before[i] = static_cast<float>(state % 1000);
+		after[i] = before[i] + 0.5f + static_cast<float>(i % 7);
+	}
+
+	// never larger than the slice itself, plus the format byte
+	SliceDelta delta(before.data(), after.data(), area * sizeof(float));
+	BOOST_CHECK_LE(delta.MemoryUsage(), area * sizeof(float) + 1);
+
+	auto data = before;
+	delta.Apply(data.data());
+	BOOST_CHECK(data == after);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../HDF5IO.h"
+#include "../SlicePageFile.h"
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace iseg {
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(SlicePageFile_suite);
+
+BOOST_AUTO_TEST_CASE(WriteRead)
+{
+	unsigned const w = 7, h = 5, n = 4;
+	size_t const area = w * h;
+
+	std::string fname;
+	{
+		SlicePageFile pages(w, h, n);
+		BOOST_REQUIRE(pages.Valid());
+		fname = pages.FileName();
+		BOOST_CHECK(fs::exists(fname));
+		BOOST_CHECK(!pages.Contains(2));
+
+		std::vector<float> bmp(area, 1.5f), work(area, 2.5f);
+		std::vector<tissues_size_t> tissues(area, 3);
+		tissues[4] = 7;
+		BOOST_REQUIRE(pages.Write(2, bmp.data(), work.data(), tissues.data()));
+		BOOST_CHECK(pages.Contains(2));
+		BOOST_CHECK(!pages.Contains(1));
+
+		std::vector<float> bmp2(area), work2(area);
+		std::vector<tissues_size_t> tissues2(area);
+		BOOST_REQUIRE(pages.Read(2, bmp2.data(), work2.data(), tissues2.data()));
+		BOOST_CHECK(bmp == bmp2);
+		BOOST_CHECK(work == work2);
+		BOOST_CHECK(tissues == tissues2);
+		BOOST_CHECK(!pages.Read(1, bmp2.data(), work2.data(), tissues2.data()));
+
+		auto hash = SlicePageFile::Hash(bmp.data(), work.data(), tissues.data(), area);
+		BOOST_CHECK_EQUAL(hash, SlicePageFile::Hash(bmp2.data(), work2.data(), tissues2.data(), area));
+		tissues2[3] = 9;
+		BOOST_CHECK_NE(hash, SlicePageFile::Hash(bmp2.data(), work2.data(), tissues2.data(), area));
+
+		// fingerprint of a single array, e.g. to find the modified chunks of a dataset
+		auto tissue_hash = SlicePageFile::Hash(nullptr, nullptr, tissues.data(), area);
+		BOOST_CHECK_EQUAL(tissue_hash, SlicePageFile::Hash(nullptr, nullptr, tissues.data(), area));
+		BOOST_CHECK_NE(tissue_hash, SlicePageFile::Hash(nullptr, nullptr, tissues2.data(), area));
+		BOOST_CHECK_NE(tissue_hash, hash);
+	}
+	// the page file is temporary
+	BOOST_CHECK(!fs::exists(fname));
+}
+
+BOOST_AUTO_TEST_CASE(Origin)
+{
+	unsigned const w = 6, h = 3, n = 3;
+	size_t const area = w * h;
+
+	boost::system::error_code ec;
+	std::string fname = (fs::temp_directory_path() / fs::path("page_origin.h5")).string();
+
+	std::vector<std::vector<float>> source(n, std::vector<float>(area));
+	std::vector<std::vector<tissues_size_t>> tissue(n, std::vector<tissues_size_t>(area));
+	std::vector<float*> source_slices;
+	std::vector<tissues_size_t*> tissue_slices;
+	for (unsigned k = 0; k < n; ++k)
+	{
+		for (size_t i = 0; i < area; ++i)
+		{
+			source[k][i] = static_cast<float>(k * area + i);
+			tissue[k][i] = static_cast<tissues_size_t>(k + 1);
+		}
+		source_slices.push_back(source[k].data());
+		tissue_slices.push_back(tissue[k].data());
+	}
+
+	{
+		HDF5IO io(1);
+		auto fid = io.Create(fname, false);
+		BOOST_REQUIRE(fid >= 0);
+		BOOST_REQUIRE(io.WriteData(fid, "/Source", source_slices.data(), n, area));
+		BOOST_REQUIRE(io.WriteData(fid, "/Tissue", tissue_slices.data(), n, area));
+		io.Close(fid);
+	}
+
+	{
+		SlicePageFile pages(w, h, n);
+		BOOST_REQUIRE(pages.SetOrigin(fname, "/Source", "/Target", "/Tissue"));
+		BOOST_CHECK(pages.Contains(1));
+
+		std::vector<float> bmp(area), work(area, 5.f);
+		std::vector<tissues_size_t> tissues(area);
+		BOOST_REQUIRE(pages.Read(1, bmp.data(), work.data(), tissues.data()));
+		BOOST_CHECK(bmp == source[1]);
+		BOOST_CHECK(tissues == tissue[1]);
+		// there is no target in the file
+		BOOST_CHECK(work == std::vector<float>(area, 0.f));
+
+		// written slices take precedence over the origin
+		std::fill(tissues.begin(), tissues.end(), 8);
+		BOOST_REQUIRE(pages.Write(1, bmp.data(), work.data(), tissues.data()));
+		std::vector<tissues_size_t> tissues2(area);
+		BOOST_REQUIRE(pages.Read(1, bmp.data(), work.data(), tissues2.data()));
+		BOOST_CHECK(tissues2 == tissues);
+
+		pages.ResetOrigin();
+		BOOST_CHECK(pages.Contains(1));
+		BOOST_CHECK(!pages.Contains(0));
+
+		// volume size mismatch
+		SlicePageFile other(w, h, n + 1);
+		BOOST_CHECK(!other.SetOrigin(fname, "/Source", "/Target", "/Tissue"));
+	}
+
+	fs::remove(fname, ec);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../SliceProvider.h"
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace iseg {
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(SliceProvider_suite);
+
+BOOST_AUTO_TEST_CASE(Reuse)
+{
+	SliceProvider sp(16);
+	float* a = sp.GiveMe();
+	float* b = sp.GiveMe();
+	BOOST_CHECK_EQUAL(sp.InUse(), 2);
+	sp.TakeBack(a);
+	sp.TakeBack(b);
+	sp.TakeBack(nullptr);
+	BOOST_CHECK_EQUAL(sp.InUse(), 0);
+	BOOST_CHECK_EQUAL(sp.ReturnNrslices(), 2);
+	BOOST_CHECK_EQUAL(sp.HighWaterMark(), 2);
+
+	std::set<float*> pooled = {sp.GiveMe(), sp.GiveMe()};
+	BOOST_CHECK(pooled == std::set<float*>({a, b}));
+	BOOST_CHECK_EQUAL(sp.ReturnNrslices(), 0);
+
+	SliceProvider other(16);
+	for (auto slice : pooled)
+		sp.TakeBack(slice);
+	sp.Merge(&other);
+	BOOST_CHECK_EQUAL(sp.ReturnNrslices(), 0);
+	BOOST_CHECK_EQUAL(other.ReturnNrslices(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(Concurrent)
+{
+	// meant to be run with ThreadSanitizer, see ISEG_ENABLE_THREAD_SANITIZER
+	unsigned const area = 64;
+	unsigned const num_threads = std::max(4u, std::thread::hardware_concurrency());
+	unsigned const held = 3;
+	unsigned const iterations = 2000;
+
+	SliceProvider sp(area);
+	std::atomic<bool> overlap{false};
+	auto kernel = [&](unsigned id) {
+		std::vector<float*> slices(held, nullptr);
+		for (unsigned it = 0; it < iterations; ++it)
+		{
+			for (auto& slice : slices)
+			{
+				slice = sp.GiveMe();
+				std::fill(slice, slice + area, static_cast<float>(id));
+			}
+			for (auto slice : slices)
+			{
+				// a slice handed out twice would have been overwritten by another thread
+				if (std::any_of(slice, slice + area, [id](float v) { return v != static_cast<float>(id); }))
+					overlap = true;
+				sp.TakeBack(slice);
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned id = 0; id < num_threads; ++id)
+		threads.emplace_back(kernel, id);
+	for (auto& t : threads)
+		t.join();
+
+	BOOST_CHECK(!overlap);
+	BOOST_CHECK_EQUAL(sp.InUse(), 0);
+	BOOST_CHECK_LE(sp.HighWaterMark(), num_threads * held);
+	// all slices are back in the pool
+	BOOST_CHECK_GE(sp.ReturnNrslices(), sp.HighWaterMark());
+}
+
+BOOST_AUTO_TEST_CASE(Installer)
+{
+	auto installer = SliceProviderInstaller::Getinst();
+	std::vector<std::thread> threads;
+	for (unsigned id = 0; id < 8; ++id)
+	{
+		threads.emplace_back([installer]() {
+			for (unsigned it = 0; it < 200; ++it)
+			{
+				auto sp = installer->Install(1000);
+				sp->TakeBack(sp->GiveMe());
+				installer->Uninstall(sp);
+			}
+		});
+	}
+	for (auto& t : threads)
+		t.join();
+	installer->ReturnInstance();
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../UndoQueue.h"
+
+#include <vector>
+
+namespace iseg {
+
+namespace {
+
+// a 3D step which changed all pixels of nslices slices to distinct values, i.e. the deltas do not compress
+MultiUndoElem* MakeStep(size_t area, unsigned nslices, float value)
+{
+	auto ue = new MultiUndoElem;
+	ue->m_DataSelection.work = true;
+	ue->m_Area = area;
+	ue->m_Deltas = true;
+
+	std::vector<float> before(area, 0.f), after(area);
+	for (size_t i = 0; i < area; ++i)
+	{
+		after[i] = value + static_cast<float>((i * 2654435761u) % 1000003);
+	}
+	for (unsigned i = 0; i < nslices; ++i)
+	{
+		ue->m_Vslicenr.push_back(i);
+		ue->m_VworkDelta.emplace_back(before.data(), after.data(), area * sizeof(float));
+	}
+	return ue;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(UndoQueue_suite);
+
+BOOST_AUTO_TEST_CASE(MemoryUsage)
+{
+	UndoQueue queue;
+	queue.SetMemoryBudget(0);
+	BOOST_CHECK_EQUAL(queue.MemoryUsage(), 0);
+
+	auto ue = MakeStep(1000, 4, 1.f);
+	size_t const bytes = ue->MemoryUsage();
+	size_t delta_bytes = 0;
+	for (const auto& delta : ue->m_VworkDelta)
+	{
+		delta_bytes += delta.MemoryUsage();
+	}
+	BOOST_CHECK_GE(delta_bytes, 4 * 1000 * sizeof(float));
+	BOOST_CHECK_GT(bytes, delta_bytes);
+
+	BOOST_CHECK(queue.AddUndo(ue));
+	BOOST_CHECK_EQUAL(queue.MemoryUsage(), bytes);
+	BOOST_CHECK_EQUAL(queue.DiskUsage(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SpillToDisk)
+{
+	size_t const area = 10000;
+	UndoQueue queue;
+	queue.SetSpillToDisk(true);
+
+	auto oldest = MakeStep(area, 4, 2.f);
+	std::vector<float> reference(area, 0.f);
+	oldest->m_VworkDelta[0].Apply(reference.data());
+
+	BOOST_CHECK(queue.AddUndo(oldest));
+	size_t const step_bytes = queue.MemoryUsage();
+	queue.SetMemoryBudget(step_bytes + step_bytes / 2);
+
+	// the second step exceeds the budget, the oldest is moved to disk and not dropped
+	BOOST_CHECK(queue.AddUndo(MakeStep(area, 4, 3.f)));
+	BOOST_REQUIRE_EQUAL(queue.ReturnNrundo(), 2);
+	BOOST_REQUIRE(oldest->PagedOut());
+	BOOST_CHECK_GT(queue.DiskUsage(), 0);
+	BOOST_CHECK_LE(queue.MemoryUsage(), queue.MemoryBudget());
+
+	// undoing restores the data from disk
+	BOOST_CHECK(queue.Undo() != nullptr);
+	auto ue = dynamic_cast<MultiUndoElem*>(queue.Undo());
+	BOOST_REQUIRE(ue == oldest);
+	BOOST_CHECK(!ue->PagedOut());
+
+	std::vector<float> data(area, 0.f);
+	ue->m_VworkDelta[0].Apply(data.data());
+	BOOST_CHECK(data == reference);
+}
+
+BOOST_AUTO_TEST_CASE(Evict)
+{
+	size_t const area = 10000;
+	UndoQueue queue;
+	queue.SetSpillToDisk(false);
+
+	BOOST_CHECK(queue.AddUndo(MakeStep(area, 4, 2.f)));
+	size_t const step_bytes = queue.MemoryUsage();
+	queue.SetMemoryBudget(2 * step_bytes + step_bytes / 2);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		BOOST_CHECK(queue.AddUndo(MakeStep(area, 4, 3.f + i)));
+	}
+	BOOST_CHECK_EQUAL(queue.ReturnNrundo(), 2);
+	BOOST_CHECK_EQUAL(queue.DiskUsage(), 0);
+	BOOST_CHECK_LE(queue.MemoryUsage(), queue.MemoryBudget());
+
+	// a step larger than the budget is rejected if it cannot be moved to disk
+	queue.SetMemoryBudget(step_bytes / 2);
+	auto ue = MakeStep(area, 4, 1.f);
+	BOOST_CHECK(!queue.AddUndo(ue));
+	delete ue;
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
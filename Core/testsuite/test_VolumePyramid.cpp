@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../VolumePyramid.h"
+
+#include <vector>
+
+namespace iseg {
+
+namespace {
+
+template<typename T>
+std::vector<T*> Slices(std::vector<T>& data, const VolumePyramid::dims_type& dims)
+{
+	std::vector<T*> slices;
+	for (unsigned k = 0; k < dims[2]; k++)
+		slices.push_back(data.data() + static_cast<size_t>(k) * dims[0] * dims[1]);
+	return slices;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(VolumePyramid_suite);
+
+BOOST_AUTO_TEST_CASE(Levels)
+{
+	VolumePyramid::dims_type const dims = {5, 4, 1};
+	auto const level1 = VolumePyramid::Dims(dims, 1);
+	BOOST_CHECK_EQUAL(level1[0], 3);
+	BOOST_CHECK_EQUAL(level1[1], 2);
+	BOOST_CHECK_EQUAL(level1[2], 1);
+	auto const level3 = VolumePyramid::Dims(dims, 3);
+	BOOST_CHECK_EQUAL(level3[0], 1);
+	BOOST_CHECK_EQUAL(level3[1], 1);
+
+	// the third level would be a single voxel
+	BOOST_CHECK_EQUAL(VolumePyramid::NumLevels(dims), 3);
+	BOOST_CHECK_EQUAL(VolumePyramid::NumLevels({4, 3, 2}), 2);
+	BOOST_CHECK_EQUAL(VolumePyramid::NumLevels({1, 1, 1}), 0);
+	int const max_levels = VolumePyramid::kMaxLevels;
+	BOOST_CHECK_EQUAL(VolumePyramid::NumLevels({512, 512, 300}), max_levels);
+}
+
+BOOST_AUTO_TEST_CASE(Average)
+{
+	VolumePyramid::dims_type const dims = {3, 2, 3};
+	std::vector<float> data(18);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = static_cast<float>(i);
+	auto const out_dims = VolumePyramid::Dims(dims, 1);
+	std::vector<float> result(out_dims[0] * out_dims[1] * out_dims[2], -1.f);
+	VolumePyramid::Average(Slices(data, dims).data(), dims, Slices(result, out_dims).data());
+
+	// full block: voxels 0, 1, 3, 4, 6, 7, 9, 10
+	BOOST_CHECK_EQUAL(result[0], 5.f);
+	// truncated in x: voxels 2, 5, 8, 11
+	BOOST_CHECK_EQUAL(result[1], 6.5f);
+	// truncated in z: voxels 12, 13, 15, 16
+	BOOST_CHECK_EQUAL(result[2], 14.f);
+	// truncated in x and z: voxels 14, 17
+	BOOST_CHECK_EQUAL(result[3], 15.5f);
+}
+
+BOOST_AUTO_TEST_CASE(Mode)
+{
+	VolumePyramid::dims_type const dims = {4, 2, 2};
+	// the left blocks have 5 voxels of label 3, the right blocks are a tie of labels 1 and 2
+	std::vector<unsigned short> data = {
+			3, 0, 1, 2, //
+			3, 3, 2, 1, //
+			0, 3, 1, 2, //
+			3, 0, 2, 1};
+	auto const out_dims = VolumePyramid::Dims(dims, 1);
+	std::vector<unsigned short> result(2, 9);
+	VolumePyramid::Mode(Slices(data, dims).data(), dims, Slices(result, out_dims).data());
+
+	BOOST_CHECK_EQUAL(result[0], 3);
+	BOOST_CHECK_EQUAL(result[1], 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
@@ -47,7 +47,7 @@ struct DataSelection
 	bool tissueHierarchy = false; // NOLINT
 
 	bool allSlices = false;			// NOLINT
-	unsigned short sliceNr = 0; // NOLINT
+	unsigned sliceNr = 0; // NOLINT
 };
 
 } // namespace iseg
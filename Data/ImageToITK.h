@@ -139,4 +139,50 @@ typename itk::SliceContiguousImage<T>::Pointer wrapToITK(const std::vector<T*>&
 	return image;
 }
 
+/// Wrap contiguous volume buffer (slice after slice) as itk::Image without copying
+template<typename T>
+typename itk::Image<T, 3>::Pointer wrapContiguousToITK(T* volume, const unsigned dims[3], unsigned start_slice, unsigned end_slice, const Vec3& spacing, const Transform& transform)
+{
+	using image_type = itk::Image<T, 3>;
+	using region_type = typename image_type::RegionType;
+
+	typename image_type::IndexType start;
+	start.Fill(0);
+
+	typename image_type::SizeType size;
+	size[0] = dims[0];
+	size[1] = dims[1];
+	size[2] = dims[2];
+
+	assert(end_slice > start_slice);
+	if (end_slice > start_slice)
+	{
+		start[2] = start_slice;
+		size[2] = end_slice - start_slice;
+	}
+
+	// the view only covers [start_slice, end_slice), so this is also the largest possible region
+	region_type buffered_region(start, size);
+
+	itk::Point<itk::SpacePrecisionType, 3> origin;
+	transform.GetOffset(origin);
+
+	itk::Matrix<itk::SpacePrecisionType, 3, 3> direction;
+	transform.GetRotation(direction);
+
+	auto image = image_type::New();
+	image->SetOrigin(origin);
+	image->SetSpacing(spacing.v);
+	image->SetDirection(direction);
+	image->SetLargestPossibleRegion(buffered_region);
+	image->SetBufferedRegion(buffered_region);
+	image->SetRequestedRegion(buffered_region);
+
+	size_t const area = static_cast<size_t>(size[0]) * size[1];
+	bool const manage_memory = false;
+	image->GetPixelContainer()->SetImportPointer(volume + start[2] * area, area * size[2], manage_memory);
+
+	return image;
+}
+
 } // namespace iseg
@@ -40,7 +40,7 @@ struct Mark
 struct AugmentedMark
 {
 	Point p;								// NOLINT
-	unsigned short slicenr; // NOLINT
+	unsigned slicenr;				// NOLINT
 	unsigned mark;					// NOLINT
 	std::string name;				// NOLINT
 };
@@ -43,10 +43,19 @@ itk::SliceContiguousImage<tissues_size_t>::Pointer SlicesHandlerITKInterface::Ge
 itk::SliceContiguousImage<tissues_size_t>::Pointer SlicesHandlerITKInterface::GetTissues(size_t start_slice, size_t end_slice)
 {
 	unsigned dims[3] = {m_Handler->Width(), m_Handler->Height(), m_Handler->NumSlices()};
+	PinTissues();
 	auto all_slices = m_Handler->TissueSlices(m_Handler->ActiveTissuelayer());
 	return wrapToITK(all_slices, dims, start_slice, end_slice, m_Handler->Spacing(), m_Handler->ImageTransform());
 }
 
+void SlicesHandlerITKInterface::PinTissues()
+{
+	if (!m_TissuesPin)
+	{
+		m_TissuesPin = std::make_shared<TissuesPin>(m_Handler);
+	}
+}
+
 template<typename T>
 typename itk::Image<T>::Pointer _GetITKView2D(T* slice, size_t dims[2], double spacing[2])
 {
@@ -102,6 +111,7 @@ itk::Image<tissues_size_t, 2>::Pointer SlicesHandlerITKInterface::GetTissuesSlic
 	auto spacing3d = m_Handler->Spacing();
 	double spacing[2] = {spacing3d[0], spacing3d[1]};
 
+	PinTissues();
 	auto all_slices = m_Handler->TissueSlices(m_Handler->ActiveTissuelayer());
 	slice = (slice == kActiveSlice) ? m_Handler->ActiveSlice() : slice;
 	return _GetITKView2D(all_slices.at(slice), dims, spacing);
@@ -114,6 +124,34 @@ itk::ImageRegion<3> SlicesHandlerITKInterface::GetActiveRegion() const
 	return itk::ImageRegion<3>(start, size);
 }
 
+itk::Image<float, 3>::Pointer SlicesHandlerITKInterface::GetImage(eImageType type, bool active_slices)
+{
+	float* volume = (type == eImageType::kSource) ? m_Handler->SourceVolume() : m_Handler->TargetVolume();
+	if (volume == nullptr)
+	{
+		return GetImageDeprecated(type, active_slices);
+	}
+
+	unsigned dims[3] = {m_Handler->Width(), m_Handler->Height(), m_Handler->NumSlices()};
+	unsigned start_slice = active_slices ? m_Handler->StartSlice() : 0;
+	unsigned end_slice = active_slices ? m_Handler->EndSlice() : m_Handler->NumSlices();
+	return wrapContiguousToITK(volume, dims, start_slice, end_slice, m_Handler->Spacing(), m_Handler->ImageTransform());
+}
+
+itk::Image<tissues_size_t, 3>::Pointer SlicesHandlerITKInterface::GetTissuesImage(bool active_slices)
+{
+	tissues_size_t* volume = m_Handler->TissueVolume(m_Handler->ActiveTissuelayer());
+	if (volume == nullptr)
+	{
+		return GetTissuesDeprecated(active_slices);
+	}
+
+	unsigned dims[3] = {m_Handler->Width(), m_Handler->Height(), m_Handler->NumSlices()};
+	unsigned start_slice = active_slices ? m_Handler->StartSlice() : 0;
+	unsigned end_slice = active_slices ? m_Handler->EndSlice() : m_Handler->NumSlices();
+	return wrapContiguousToITK(volume, dims, start_slice, end_slice, m_Handler->Spacing(), m_Handler->ImageTransform());
+}
+
 itk::Image<float, 3>::Pointer SlicesHandlerITKInterface::GetImageDeprecated(eImageType type, bool active_slices)
 {
 	using input_image_type = itk::SliceContiguousImage<float>;
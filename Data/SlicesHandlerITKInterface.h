@@ -13,6 +13,8 @@
 #include "SlicesHandlerInterface.h"
 #include "iSegData.h"
 
+#include <memory>
+
 namespace iseg {
 
 class ISEG_DATA_API SlicesHandlerITKInterface
@@ -46,11 +48,19 @@ public:
 		kTarget
 	};
 
+	/// Returns a view if the handler provides contiguous volume buffers, else a copy
+	itk::Image<pixel_type, 3>::Pointer GetImage(eImageType type, bool active_slices);
+	itk::Image<tissue_type, 3>::Pointer GetTissuesImage(bool active_slices);
+
 	itk::Image<pixel_type, 3>::Pointer GetImageDeprecated(eImageType type, bool active_slices);
 	itk::Image<tissue_type, 3>::Pointer GetTissuesDeprecated(bool active_slices);
 
 private:
+	void PinTissues();
+
 	SlicesHandlerInterface* m_Handler;
+	/// The tissue images are views on the slices, which stay pinned while this interface (or a copy of it) exists
+	std::shared_ptr<TissuesPin> m_TissuesPin;
 };
 
 } // namespace iseg
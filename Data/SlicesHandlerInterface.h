@@ -24,15 +24,15 @@ public:
 	using tissue_type = tissues_size_t;
 	using pixel_type = float;
 
-	virtual unsigned short Width() const = 0;
-	virtual unsigned short Height() const = 0;
-	virtual unsigned short NumSlices() const = 0;
+	virtual unsigned Width() const = 0;
+	virtual unsigned Height() const = 0;
+	virtual unsigned NumSlices() const = 0;
 
-	virtual unsigned short StartSlice() const = 0;
-	virtual unsigned short EndSlice() const = 0;
+	virtual unsigned StartSlice() const = 0;
+	virtual unsigned EndSlice() const = 0;
 
-	virtual unsigned short ActiveSlice() const = 0;
-	virtual void SetActiveSlice(unsigned short slice, bool signal_change) = 0;
+	virtual unsigned ActiveSlice() const = 0;
+	virtual void SetActiveSlice(unsigned slice, bool signal_change) = 0;
 
 	virtual Transform ImageTransform() const = 0;
 	virtual Vec3 Spacing() const = 0;
@@ -40,6 +40,9 @@ public:
 	virtual tissuelayers_size_t ActiveTissuelayer() const = 0;
 	virtual std::vector<const tissues_size_t*> TissueSlices(tissuelayers_size_t layeridx) const = 0;
 	virtual std::vector<tissues_size_t*> TissueSlices(tissuelayers_size_t layeridx) = 0;
+	/// The tissue pointers may be invalidated, e.g. when the slices are compressed, unless they are pinned (see TissuesPin)
+	virtual void PinTissues() {}
+	virtual void UnpinTissues() {}
 
 	virtual std::vector<const float*> SourceSlices() const = 0;
 	virtual std::vector<float*> SourceSlices() = 0;
@@ -47,6 +50,11 @@ public:
 	virtual std::vector<const float*> TargetSlices() const = 0;
 	virtual std::vector<float*> TargetSlices() = 0;
 
+	/// Returns contiguous volume buffers (slice after slice) if available, else nullptr
+	virtual float* SourceVolume() { return nullptr; }
+	virtual float* TargetVolume() { return nullptr; }
+	virtual tissues_size_t* TissueVolume(tissuelayers_size_t layeridx) { return nullptr; }
+
 	virtual std::vector<std::string> TissueNames() const = 0;
 	virtual std::vector<bool> TissueLocks() const = 0;
 	virtual std::vector<tissues_size_t> TissueSelection() const = 0;
@@ -69,4 +77,18 @@ private:
 	TimeStamp m_ModifyTime;
 };
 
+/// Keeps the pointers returned by TissueSlices valid while in scope. Acquire it before fetching the pointers.
+class TissuesPin
+{
+public:
+	explicit TissuesPin(SlicesHandlerInterface* handler) : m_Handler(handler) { m_Handler->PinTissues(); }
+	~TissuesPin() { m_Handler->UnpinTissues(); }
+
+	TissuesPin(const TissuesPin&) = delete;
+	TissuesPin& operator=(const TissuesPin&) = delete;
+
+private:
+	SlicesHandlerInterface* m_Handler;
+};
+
 } // namespace iseg
@@ -0,0 +1,37 @@
+#include "ProgressBar.h"
+
+#include "QtConnect.h"
+
+#include <qprogressbar.h>
+
+namespace iseg {
+
+ProgressBar::ProgressBar(QProgressBar* bar, QObject* parent /*= 0*/)
+		: QObject(parent)
+{
+	m_Count.store(0);
+
+	// queued if the progress is reported from another thread
+	QObject_connect(this, SIGNAL(OnNumberOfStepsChanged(int)), bar, SLOT(setMaximum(int)));
+	QObject_connect(this, SIGNAL(OnValueChanged(int)), bar, SLOT(setValue(int)));
+}
+
+void ProgressBar::SetNumberOfSteps(int N)
+{
+	m_Count = 0;
+	OnNumberOfStepsChanged(N);
+	OnValueChanged(0);
+}
+
+void ProgressBar::Increment()
+{
+	OnValueChanged(++m_Count);
+}
+
+void ProgressBar::SetValue(int percent)
+{
+	m_Count = percent;
+	OnValueChanged(percent);
+}
+
+} // namespace iseg
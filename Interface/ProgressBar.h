@@ -0,0 +1,49 @@
+/*
+* Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+*
+* This file is part of iSEG
+* (see https://github.com/ITISFoundation/osparc-iseg).
+*
+* This software is released under the MIT License.
+*  https://opensource.org/licenses/MIT
+*/
+#pragma once
+
+#include "iSegInterface.h"
+
+#include "../Data/ProgressInfo.h"
+
+#include <qobject.h>
+
+#include <atomic>
+
+class QProgressBar;
+
+namespace iseg {
+
+/** \brief Progress shown in a (non-modal) progress bar, e.g. in the status bar
+
+	Unlike ProgressDialog, all methods may be called from a worker thread, the
+	progress bar is updated in the thread it belongs to.
+*/
+class ISEG_INTERFACE_API ProgressBar
+		: public QObject
+		, public ProgressInfo
+{
+	Q_OBJECT
+public:
+	ProgressBar(QProgressBar* bar, QObject* parent = nullptr);
+
+	void SetNumberOfSteps(int N) override;
+	void Increment() override;
+	void SetValue(int percent) override;
+
+signals:
+	void OnNumberOfStepsChanged(int);
+	void OnValueChanged(int);
+
+private:
+	std::atomic<int> m_Count;
+};
+
+} // namespace iseg
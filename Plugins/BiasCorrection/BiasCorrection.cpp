@@ -152,7 +152,7 @@ void BiasCorrectionWidget::DoWork()
 	using input_image_type = itk::Image<float, 3>;
 
 	iseg::SlicesHandlerITKInterface wrapper(m_Handler3D);
-	input_image_type::Pointer input = wrapper.GetImageDeprecated(iseg::SlicesHandlerITKInterface::kSource, true);
+	input_image_type::Pointer input = wrapper.GetImage(iseg::SlicesHandlerITKInterface::kSource, true);
 
 	//Ensure that it is a 3D image for the 3D image filter ! Else it does nothing
 	if (input->GetLargestPossibleRegion().GetSize(2) > 1)
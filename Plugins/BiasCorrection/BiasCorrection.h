@@ -41,7 +41,7 @@ private:
 	ImagePointer DoBiasCorrection(ImagePointer inputImage, ImagePointer maskImage, const std::vector<unsigned int>& numIters, int shrinkFactor, double convergenceThreshold);
 
 	iseg::SlicesHandlerInterface* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	QSpinBox* m_NumberLevels;
 	QSpinBox* m_ShrinkFactor;
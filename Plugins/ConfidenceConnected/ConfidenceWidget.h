@@ -46,7 +46,7 @@ protected:
 
 private:
 	iseg::SlicesHandlerInterface* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	QCheckBox* m_AllSlices;
 	QSpinBox* m_Iterations;
@@ -159,7 +159,7 @@ void BoneSegmentationWidget::DoWork()
 
 	// get input image
 	iseg::SlicesHandlerITKInterface itk_wrapper(m_Handler3D);
-	auto input = itk_wrapper.GetImageDeprecated(iseg::SlicesHandlerITKInterface::kSource, m_UseSliceRange->Value());
+	auto input = itk_wrapper.GetImage(iseg::SlicesHandlerITKInterface::kSource, m_UseSliceRange->Value());
 
 	// setup algorithm
 	auto graph_cut_filter = graph_cut_filter_type::New();
@@ -35,7 +35,7 @@ private:
 	void Showsliders();
 
 	iseg::SlicesHandlerInterface* m_Handler3D;
-	unsigned short m_CurrentSlice;
+	unsigned m_CurrentSlice;
 
 	std::shared_ptr<iseg::PropertyEnum> m_MaxFlowAlgorithm;
 	std::shared_ptr<iseg::PropertyBool> m_M6Connectivity;
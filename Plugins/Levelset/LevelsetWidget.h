@@ -47,7 +47,7 @@ private:
 	void GuessThresholdsNd(TInput* source);
 
 	iseg::SlicesHandlerInterface* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	QCheckBox* m_AllSlices;
 	QCheckBox* m_InitFromTarget;
@@ -948,13 +948,14 @@ bool gdcmvtk_rtstruct::GetSizeUsingGDCM(const std::vector<std::string>& filename
     reader->SetFileNames(files);
   }
   int xm, xp, ym, yp, zm, zp;
-  reader->Update();
+  // the headers are enough, i.e. the pixel data is not decoded
+  reader->UpdateInformation();
   reader->GetDataExtent(xm, xp, ym, yp, zm, zp);
   h = yp - ym + 1;
   w = xp - xm + 1;
   nrslices = zp - zm + 1;
   double a[3];
-  reader->GetOutput()->GetSpacing(a); // GetDataSpacing(a);
+  reader->GetOutputInformation(0)->Get(vtkDataObject::SPACING(), a);
   dx = a[0];
   dy = a[1];
   dz = a[2];
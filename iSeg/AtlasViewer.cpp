@@ -198,9 +198,9 @@ void AtlasViewer::GetSlice()
 			m_Slicenr = m_Dimx - 1;
 		unsigned pos = 0;
 		unsigned pos1 = unsigned(m_Slicenr);
-		for (unsigned short i = 0; i < m_Height; i++)
+		for (unsigned i = 0; i < m_Height; i++)
 		{
-			for (unsigned short j = 0; j < m_Width; j++, pos++, pos1 += m_Dimx)
+			for (unsigned j = 0; j < m_Width; j++, pos++, pos1 += m_Dimx)
 			{
 				m_CurrentTissue[pos] = m_Tissue[pos1];
 				m_CurrentBmpbits[pos] = m_Bmpbits[pos1];
@@ -213,10 +213,10 @@ void AtlasViewer::GetSlice()
 			m_Slicenr = m_Dimy - 1;
 		unsigned pos = 0;
 		unsigned pos1 = unsigned(m_Slicenr) * m_Width;
-		for (unsigned short i = 0; i < m_Height;
+		for (unsigned i = 0; i < m_Height;
 				 i++, pos1 += unsigned(m_Dimy - 1) * m_Dimx)
 		{
-			for (unsigned short j = 0; j < m_Width; j++, pos++, pos1++)
+			for (unsigned j = 0; j < m_Width; j++, pos++, pos1++)
 			{
 				m_CurrentTissue[pos] = m_Tissue[pos1];
 				m_CurrentBmpbits[pos] = m_Bmpbits[pos1];
@@ -229,9 +229,9 @@ void AtlasViewer::GetSlice()
 			m_Slicenr = m_Dimz - 1;
 		unsigned pos = 0;
 		unsigned pos1 = unsigned(m_Slicenr) * unsigned(m_Dimy) * m_Dimx;
-		for (unsigned short i = 0; i < m_Height; i++)
+		for (unsigned i = 0; i < m_Height; i++)
 		{
-			for (unsigned short j = 0; j < m_Width; j++, pos++, pos1++)
+			for (unsigned j = 0; j < m_Width; j++, pos++, pos1++)
 			{
 				m_CurrentTissue[pos] = m_Tissue[pos1];
 				m_CurrentBmpbits[pos] = m_Bmpbits[pos1];
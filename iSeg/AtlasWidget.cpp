@@ -187,7 +187,7 @@ bool AtlasWidget::Loadfile(const char* filename)
 	int area = m_Dimx * (int)m_Dimy;
 	if (tissues_version > 0)
 	{
-		for (unsigned short i = 0; i < m_Dimz; i++)
+		for (unsigned i = 0; i < m_Dimz; i++)
 		{
 			in.readRawData((char*)&(m_Image[area * i]), area * sizeof(float));
 			in.readRawData((char*)&(m_Tissue[area * i]), area * sizeof(tissues_size_t));
@@ -196,7 +196,7 @@ bool AtlasWidget::Loadfile(const char* filename)
 	else
 	{
 		char* char_buffer = new char[area];
-		for (unsigned short i = 0; i < m_Dimz; i++)
+		for (unsigned i = 0; i < m_Dimz; i++)
 		{
 			in.readRawData((char*)&(m_Image[area * i]), area * sizeof(float));
 			in.readRawData(char_buffer, area);
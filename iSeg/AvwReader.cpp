@@ -69,7 +69,7 @@ std::ifstream& ReadLineIntoIStringStream(std::ifstream& file, std::istringstream
 	return file;
 }
 
-bool iseg::avw::ReadHeader(const char* filename, unsigned short& w, unsigned short& h, unsigned short& nrofslices, float& dx1, float& dy1, float& thickness1, eDataType& type)
+bool iseg::avw::ReadHeader(const char* filename, unsigned& w, unsigned& h, unsigned& nrofslices, float& dx1, float& dy1, float& thickness1, eDataType& type)
 {
 	bool ok = false;
 
@@ -139,7 +139,7 @@ bool iseg::avw::ReadHeader(const char* filename, unsigned short& w, unsigned sho
 	return ok;
 }
 
-void* iseg::avw::ReadData(const char* filename, unsigned short slicenr, unsigned short& w, unsigned short& h, eDataType& type)
+void* iseg::avw::ReadData(const char* filename, unsigned slicenr, unsigned& w, unsigned& h, eDataType& type)
 {
 	void* returnval = nullptr;
 
@@ -187,14 +187,14 @@ void* iseg::avw::ReadData(const char* filename, unsigned short slicenr, unsigned
 			ReadLineIntoIStringStream(file, line);
 			h = ReadValueFromLine<int>(line.str(), '=');
 
-			unsigned slicedim = 0;
+			size_t slicedim = 0;
 			if (type == uchar || type == schar)
 			{
-				slicedim = (unsigned)w * h * sizeof(char);
+				slicedim = (size_t)w * h * sizeof(char);
 			}
 			else if (type == ushort || type == sshort)
 			{
-				slicedim = (unsigned)w * h * sizeof(short);
+				slicedim = (size_t)w * h * sizeof(short);
 			}
 
 			returnval = malloc(slicedim + 1);
@@ -17,8 +17,8 @@ enum eDataType { ushort = 0,
 	uchar = 1,
 	sshort = 2,
 	schar = 3 };
-bool ReadHeader(const char* filename, unsigned short& w, unsigned short& h, unsigned short& nrofslices, float& dx1, float& dy1, float& thickness1, eDataType& type);
-void* ReadData(const char* filename, unsigned short slicenr, unsigned short& w, unsigned short& h, eDataType& type);
+bool ReadHeader(const char* filename, unsigned& w, unsigned& h, unsigned& nrofslices, float& dx1, float& dy1, float& thickness1, eDataType& type);
+void* ReadData(const char* filename, unsigned slicenr, unsigned& w, unsigned& h, eDataType& type);
 
 template<typename T>
 static T ReadValueFromLine(const std::string& line, const char separator)
@@ -97,9 +97,9 @@ bool DicomReader::LoadPicture(float* bits)
 					{
 						unsigned k = unsigned(m_Width) * (m_Height - 1);
 						unsigned j = 0;
-						for (unsigned short h = 0; h < m_Height; h++)
+						for (unsigned h = 0; h < m_Height; h++)
 						{
-							for (unsigned short w = 0; w < m_Width; w++)
+							for (unsigned w = 0; w < m_Width; w++)
 							{
 								bits[k] = float(bits1[j]);
 								k++;
@@ -114,9 +114,9 @@ bool DicomReader::LoadPicture(float* bits)
 					{
 						unsigned k = unsigned(m_Width) * (m_Height - 1);
 						unsigned j = 0;
-						for (unsigned short h = 0; h < m_Height; h++)
+						for (unsigned h = 0; h < m_Height; h++)
 						{
-							for (unsigned short w = 0; w < m_Width; w++)
+							for (unsigned w = 0; w < m_Width; w++)
 							{
 								if (j < readnr)
 									bits[k] = float(bits1[j]);
@@ -139,9 +139,9 @@ bool DicomReader::LoadPicture(float* bits)
 					{
 						unsigned k = 0;
 						unsigned j = unsigned(m_Width) * (m_Height - 1);
-						for (unsigned short h = 0; h < m_Height; h++)
+						for (unsigned h = 0; h < m_Height; h++)
 						{
-							for (unsigned short w = 0; w < m_Width; w++)
+							for (unsigned w = 0; w < m_Width; w++)
 							{
 								bits[j] = float(bits1[k]);
 								k++;
@@ -159,9 +159,9 @@ bool DicomReader::LoadPicture(float* bits)
 					{
 						unsigned k = 0;
 						unsigned j = unsigned(m_Width) * (m_Height - 1);
-						for (unsigned short h = 0; h < m_Height; h++)
+						for (unsigned h = 0; h < m_Height; h++)
 						{
-							for (unsigned short w = 0; w < m_Width; w++)
+							for (unsigned w = 0; w < m_Width; w++)
 							{
 								if (k + 1 < readnr)
 								{
@@ -954,7 +954,7 @@ void DicomReader::Dsarray2float(float* vals, unsigned short nrvals)
 {
 	int pos = 0;
 	unsigned short counter = 0;
-	for (unsigned short i = 0; i < nrvals; i++)
+	for (unsigned i = 0; i < nrvals; i++)
 		vals[i] = 0;
 	while (counter < nrvals)
 	{
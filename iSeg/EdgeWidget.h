@@ -44,7 +44,7 @@ private:
 
 	Bmphandler* m_Bmphand = nullptr;
 	SlicesHandler* m_Handler3D = nullptr;
-	unsigned short m_Activeslice = 0;
+	unsigned m_Activeslice = 0;
 	bool m_BlockExecute = false;
 
 	enum eModeType {
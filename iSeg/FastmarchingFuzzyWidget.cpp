@@ -336,8 +336,8 @@ void FastmarchingFuzzyWidget::OnMouseMoved(Point p)
 	if (m_RbDrag->isChecked())
 	{
 		m_VpdynArg.clear();
-		unsigned short width = m_Bmphand->ReturnWidth();
-		unsigned short height = m_Bmphand->ReturnHeight();
+		unsigned width = m_Bmphand->ReturnWidth();
+		unsigned height = m_Bmphand->ReturnHeight();
 		m_Extend = m_Map[(unsigned)width * p.py + p.px];
 
 		Point p;
@@ -352,7 +352,7 @@ void FastmarchingFuzzyWidget::OnMouseMoved(Point p)
 			m_VpdynArg.push_back(p);
 		}
 		pos++;
-		for (unsigned short j = 1; j + 1 < width; j++)
+		for (unsigned j = 1; j + 1 < width; j++)
 		{
 			if ((m_Map[pos] <= m_Extend && m_Map[pos + 1] > m_Extend) ||
 					(m_Map[pos] <= m_Extend && m_Map[pos - 1] > m_Extend) ||
@@ -373,7 +373,7 @@ void FastmarchingFuzzyWidget::OnMouseMoved(Point p)
 		}
 		pos++;
 
-		for (unsigned short i = 1; i + 1 < height; i++)
+		for (unsigned i = 1; i + 1 < height; i++)
 		{
 			if ((m_Map[pos] <= m_Extend && m_Map[pos + 1] > m_Extend) ||
 					(m_Map[pos] <= m_Extend && m_Map[pos + width] > m_Extend) ||
@@ -384,7 +384,7 @@ void FastmarchingFuzzyWidget::OnMouseMoved(Point p)
 				m_VpdynArg.push_back(p);
 			}
 			pos++;
-			for (unsigned short j = 1; j + 1 < width; j++)
+			for (unsigned j = 1; j + 1 < width; j++)
 			{
 				if ((m_Map[pos] <= m_Extend && m_Map[pos + 1] > m_Extend) ||
 						(m_Map[pos] <= m_Extend && m_Map[pos - 1] > m_Extend) ||
@@ -415,7 +415,7 @@ void FastmarchingFuzzyWidget::OnMouseMoved(Point p)
 			m_VpdynArg.push_back(p);
 		}
 		pos++;
-		for (unsigned short j = 1; j + 1 < width; j++)
+		for (unsigned j = 1; j + 1 < width; j++)
 		{
 			if ((m_Map[pos] <= m_Extend && m_Map[pos + 1] > m_Extend) ||
 					(m_Map[pos] <= m_Extend && m_Map[pos - 1] > m_Extend) ||
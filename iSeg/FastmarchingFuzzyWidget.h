@@ -56,7 +56,7 @@ private:
 	ImageForestingTransformAdaptFuzzy* m_IfTfuzzy;
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	QStackedLayout* m_ParamsStackLayout;
 	QSlider* m_SlSigma;
@@ -40,7 +40,7 @@ private:
 	std::vector<Point> m_Dynamic;
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	QLabel* m_LbMap;
 	QLabel* m_LbAv;
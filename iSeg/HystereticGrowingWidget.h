@@ -50,7 +50,7 @@ private:
 	Point m_LastPt;
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 	float m_UpperLimit;
 	float m_LowerLimit;
 	bool m_Limitdrawing;
@@ -54,7 +54,7 @@ private:
 	Point m_LastPt;
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	QSlider* m_SlThresh;
 	QPushButton* m_Pushexec;
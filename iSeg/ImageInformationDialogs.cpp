@@ -51,7 +51,7 @@ bool orthonormalize(float* vecA, float* vecB)
 	vtkMath::Cross(vecA, vecB, cross);
 
 	float a[3][3];
-	for (unsigned short i = 0; i < 3; ++i)
+	for (unsigned i = 0; i < 3; ++i)
 	{
 		a[0][i] = vecA[i];
 		a[1][i] = vecB[i];
@@ -60,7 +60,7 @@ bool orthonormalize(float* vecA, float* vecB)
 
 	float b[3][3];
 	vtkMath::Orthogonalize3x3(a, b);
-	for (unsigned short i = 0; i < 3; ++i)
+	for (unsigned i = 0; i < 3; ++i)
 	{
 		vecA[i] = b[0][i];
 		vecB[i] = b[1][i];
@@ -421,9 +421,9 @@ ResizeDialog::ResizeDialog(SlicesHandler* hand3D, eResizeType type1, QWidget* pa
 	m_ImageSourceLabel = new ImagePVLabel;
 	// TODO BL: m_ImageSourceLabel->setFixedSize(m_VImagebox1->size());
 
-	unsigned short active_slice = hand3D->ActiveSlice();
-	unsigned short source_width = hand3D->Width();
-	unsigned short source_height = hand3D->Height();
+	unsigned active_slice = hand3D->ActiveSlice();
+	unsigned source_width = hand3D->Width();
+	unsigned source_height = hand3D->Height();
 	float* data = hand3D->ReturnBmp(active_slice);
 
 	QImage small_image(source_width, source_height, 32);
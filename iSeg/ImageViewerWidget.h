@@ -115,7 +115,7 @@ private:
 	unsigned short m_Width, m_Height;
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 	float** m_Bmpbits;
 	float* m_Overlaybits;
 	tissues_size_t** m_Tissue;
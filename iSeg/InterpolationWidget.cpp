@@ -244,7 +244,7 @@ void InterpolationWidget::Execute()
 	const bool connected = m_CbConnectedshapebased->Visible() && m_CbConnectedshapebased->Value();
 	const bool chess_connectivity = (m_Connectivitygroup->Value() == eConnectivityType::kChess);
 
-	unsigned short current = m_Handler3D->ActiveSlice();
+	unsigned current = m_Handler3D->ActiveSlice();
 	if (current != m_Startnr)
 	{
 		DataSelection data_selection;
@@ -76,8 +76,8 @@ private:
 
 	PropertyButton_ptr m_Pushexec;
 
-	unsigned short m_Startnr;
-	unsigned short m_Nrslices;
+	unsigned m_Startnr;
+	unsigned m_Nrslices;
 	unsigned short m_Tissuenr;
 
 public slots:
@@ -174,9 +174,9 @@ void Levelset::Diffx(float* input, float* output) const
 {
 	unsigned k = 1;
 
-	for (unsigned short j = 0; j < m_Height; ++j)
+	for (unsigned j = 0; j < m_Height; ++j)
 	{
-		for (unsigned short i = 1; i < m_Width - 1; ++i)
+		for (unsigned i = 1; i < m_Width - 1; ++i)
 		{
 			output[k] = (input[k + 1] - input[k - 1]) / 2;
 			++k;
@@ -193,9 +193,9 @@ void Levelset::Diffx(float* input, float* output) const
 void Levelset::Diffy(float* input, float* output) const
 {
 	unsigned k = m_Width;
-	for (unsigned short j = 1; j < m_Height - 1; ++j)
+	for (unsigned j = 1; j < m_Height - 1; ++j)
 	{
-		for (unsigned short i = 0; i < m_Width; ++i)
+		for (unsigned i = 0; i < m_Width; ++i)
 		{
 			output[k] = (input[k + m_Width] - input[k - m_Width]) / 2;
 			++k;
@@ -211,9 +211,9 @@ void Levelset::Diffy(float* input, float* output) const
 void Levelset::Diffxx(float* input, float* output) const
 {
 	unsigned k = 1;
-	for (unsigned short j = 0; j < m_Height; ++j)
+	for (unsigned j = 0; j < m_Height; ++j)
 	{
-		for (unsigned short i = 1; i < m_Width - 1; ++i)
+		for (unsigned i = 1; i < m_Width - 1; ++i)
 		{
 			output[k] = input[k + 1] - input[k] + input[k - 1];
 			++k;
@@ -230,9 +230,9 @@ void Levelset::Diffxx(float* input, float* output) const
 void Levelset::Diffxy(float* input, float* output) const
 {
 	unsigned k = m_Width + 1;
-	for (unsigned short j = 1; j < m_Height - 1; ++j)
+	for (unsigned j = 1; j < m_Height - 1; ++j)
 	{
-		for (unsigned short i = 1; i < m_Width - 1; ++i)
+		for (unsigned i = 1; i < m_Width - 1; ++i)
 		{
 			output[k] = (input[k + 1 + m_Width] - input[k - 1 + m_Width] -
 											input[k + 1 - m_Width] + input[k - m_Width - 1]) /
@@ -255,9 +255,9 @@ void Levelset::Diffxy(float* input, float* output) const
 void Levelset::Diffyy(float* input, float* output) const
 {
 	unsigned k = m_Width;
-	for (unsigned short j = 1; j < m_Height - 1; ++j)
+	for (unsigned j = 1; j < m_Height - 1; ++j)
 	{
-		for (unsigned short i = 0; i < m_Width; ++i)
+		for (unsigned i = 0; i < m_Width; ++i)
 		{
 			output[k] = input[k + m_Width] - input[k] + input[k - m_Width];
 			++k;
@@ -67,7 +67,7 @@ private:
 	bool m_Cooling;
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	QRadioButton* m_Autotrace;
 	QRadioButton* m_Straight;
@@ -53,6 +53,7 @@
 #include "RadiotherapyStructureSetImporter.h"
 
 #include "Interface/Plugin.h"
+#include "Interface/ProgressBar.h"
 #include "Interface/ProgressDialog.h"
 #include "Interface/RecentPlaces.h"
 
@@ -61,6 +62,7 @@
 #include "Core/HDF5Blosc.h"
 #include "Core/LoadPlugin.h"
 #include "Core/ProjectVersion.h"
+#include "Core/VolumePyramid.h"
 #include "Core/VotingReplaceLabel.h"
 
 #include <boost/filesystem.hpp>
@@ -76,8 +78,10 @@
 #include <QApplication>
 #include <QDockWidget>
 #include <QMenuBar>
+#include <QProgressBar>
 #include <QProgressDialog>
 #include <QSettings>
+#include <QTimer>
 #include <QTextEdit>
 #include <QToolTip>
 
@@ -317,6 +321,13 @@ MainWindow::MainWindow(SlicesHandler* hand3D, const QString& locationstring, con
 	log_button->setMinimumWidth(100);
 	statusBar()->addPermanentWidget(log_button);
 
+	// progress of saving the project in the background
+	m_SaveProgressBar = new QProgressBar;
+	m_SaveProgressBar->setMaximumWidth(200);
+	m_SaveProgressBar->hide();
+	statusBar()->addPermanentWidget(m_SaveProgressBar);
+	m_SaveProgress = new ProgressBar(m_SaveProgressBar, this);
+
 	m_UndoStarted = false;
 	setContentsMargins(9, 4, 9, 4);
 	m_MPicpath = picpath;
@@ -358,7 +369,7 @@ MainWindow::MainWindow(SlicesHandler* hand3D, const QString& locationstring, con
 		m_TissueTreeWidget->scrollToItem(first);
 	});
 
-	m_Handler3D->m_OnActiveSliceChanged.connect([this](unsigned short slice) {
+	m_Handler3D->m_OnActiveSliceChanged.connect([this](unsigned slice) {
 		SliceChanged();
 	});
 
@@ -563,7 +574,7 @@ MainWindow::MainWindow(SlicesHandler* hand3D, const QString& locationstring, con
 	m_PbMask = new QPushButton("Mask Source", this);
 	m_PbMask->setToolTip(Format("Mask source image based on target. The source image is set to zero at zero target pixels."));
 
-	unsigned short slicenr = m_Handler3D->ActiveSlice() + 1;
+	unsigned slicenr = m_Handler3D->ActiveSlice() + 1;
 	m_PbFirst = new QPushButton("|<<", this);
 	m_ScbSlicenr = new QScrollBar(Qt::Horizontal, this);
 	m_ScbSlicenr->setRange(1, m_Handler3D->NumSlices());
@@ -639,7 +650,7 @@ MainWindow::MainWindow(SlicesHandler* hand3D, const QString& locationstring, con
 	m_ShowpbTab.resize(nrtabbuttons);
 	m_ShowtabAction.resize(nrtabbuttons);
 
-	for (unsigned short i = 0; i < nrtabbuttons; i++)
+	for (unsigned i = 0; i < nrtabbuttons; i++)
 	{
 		m_ShowpbTab[i] = true;
 
@@ -850,7 +861,7 @@ MainWindow::MainWindow(SlicesHandler* hand3D, const QString& locationstring, con
 	QVBoxLayout* vboxtabs1 = new QVBoxLayout;
 	vboxtabs1->setSpacing(0);
 	vboxtabs1->setMargin(0);
-	for (unsigned short i = 0; i < (nrtabbuttons + 1) / 2; i++)
+	for (unsigned i = 0; i < (nrtabbuttons + 1) / 2; i++)
 	{
 		add_widget_filter(vboxtabs1, m_PbTab[i], i);
 	}
@@ -858,7 +869,7 @@ MainWindow::MainWindow(SlicesHandler* hand3D, const QString& locationstring, con
 	QVBoxLayout* vboxtabs2 = new QVBoxLayout;
 	vboxtabs2->setSpacing(0);
 	vboxtabs2->setMargin(0);
-	for (unsigned short i = (nrtabbuttons + 1) / 2; i < nrtabbuttons; i++)
+	for (unsigned i = (nrtabbuttons + 1) / 2; i < nrtabbuttons; i++)
 	{
 		add_widget_filter(vboxtabs2, m_PbTab[i], i);
 	}
@@ -1086,6 +1097,7 @@ MainWindow::MainWindow(SlicesHandler* hand3D, const QString& locationstring, con
 		m_Loadmenu->addAction("Open Analyze Direct (.avw...)", this, SLOT(ExecuteLoadavw()));
 		m_Loadmenu->addAction("Open VTK...", this, SLOT(ExecuteLoadvtk()));
 		m_Loadmenu->addAction("Open RTdose...", this, SLOT(ExecuteLoadrtdose()));
+		m_Loadmenu->addAction("Open Project Preview (.prj)...", this, SLOT(ExecuteLoadProjectPreview()));
 	}
 	m_Reloadmenu = m_File->addMenu("&Reopen");
 	m_Reloadmenu->addAction("Reopen Dicom (.dcm...)", this, SLOT(ExecuteReloaddicom()));
@@ -1120,7 +1132,7 @@ MainWindow::MainWindow(SlicesHandler* hand3D, const QString& locationstring, con
 	m_File->addAction("Export &Contour...", this, SLOT(ExecuteSaveContours()));
 
 	m_Exportmenu = m_File->addMenu("Export Tissue Distr.");
-	m_Exportmenu->addAction("Export &Labelfield...(am)", this, SLOT(ExecuteExportlabelfield()));
+	m_Exportmenu->addAction("Export &Labelfield...(am, vtk)", this, SLOT(ExecuteExportlabelfield()));
 	m_Exportmenu->addAction("Export vtk-ascii...(vti/vtk)", this, SLOT(ExecuteExportvtkascii()));
 	m_Exportmenu->addAction("Export vtk-binary...(vti/vtk)", this, SLOT(ExecuteExportvtkbinary()));
 	m_Exportmenu->addAction("Export vtk-compressed-ascii...(vti)", this, SLOT(ExecuteExportvtkcompressedascii()));
@@ -1242,7 +1254,7 @@ MainWindow::MainWindow(SlicesHandler* hand3D, const QString& locationstring, con
 	m_Hidecopyswap->setChecked(true);
 	QObject_connect(m_Hidecopyswap, SIGNAL(toggled(bool)), this, SLOT(ExecuteHidecopyswap(bool)));
 	m_Hidemenu->addAction(m_Hidecopyswap);
-	for (unsigned short i = 0; i < nrtabbuttons; i++)
+	for (unsigned i = 0; i < nrtabbuttons; i++)
 	{
 		m_ShowtabAction[i] = new QAction(m_Tabwidgets[i]->GetName().c_str(), this);
 		m_ShowtabAction[i]->setCheckable(true);
@@ -1525,6 +1537,8 @@ void MainWindow::closeEvent(QCloseEvent* qce)
 {
 	if (MaybeSafe())
 	{
+		WaitForBackgroundSave();
+
 		if (m_Xsliceshower != nullptr)
 		{
 			m_Xsliceshower->close();
@@ -1675,7 +1689,7 @@ void MainWindow::ExecuteSwapxy()
 	bool swap_extra_datasets = false;
 	if (m_MultidatasetWidget->isVisible() && swap_extra_datasets)
 	{
-		unsigned short w, h, nrslices;
+		unsigned w, h, nrslices;
 		w = m_Handler3D->Height();
 		h = m_Handler3D->Width();
 		nrslices = m_Handler3D->NumSlices();
@@ -1722,7 +1736,7 @@ void MainWindow::ExecuteSwapxz()
 	bool swap_extra_datasets = false;
 	if (m_MultidatasetWidget->isVisible() && swap_extra_datasets)
 	{
-		unsigned short w, h, nrslices;
+		unsigned w, h, nrslices;
 		w = m_Handler3D->NumSlices();
 		h = m_Handler3D->Height();
 		nrslices = m_Handler3D->Width();
@@ -1769,7 +1783,7 @@ void MainWindow::ExecuteSwapyz()
 	bool swap_extra_datasets = false;
 	if (m_MultidatasetWidget->isVisible() && swap_extra_datasets)
 	{
-		unsigned short w, h, nrslices;
+		unsigned w, h, nrslices;
 		w = m_Handler3D->Width();
 		h = m_Handler3D->NumSlices();
 		nrslices = m_Handler3D->Height();
@@ -1821,7 +1835,7 @@ void MainWindow::ExecuteResize(int resizetype)
 	int dxm, dxp, dym, dyp, dzm, dzp;
 	rd.ReturnPadding(dxm, dxp, dym, dyp, dzm, dzp);
 
-	unsigned short w, h, nrslices;
+	unsigned w, h, nrslices;
 	w = m_Handler3D->Width();
 	h = m_Handler3D->Height();
 	nrslices = m_Handler3D->NumSlices();
@@ -2287,8 +2301,8 @@ void MainWindow::ExecuteReloadbmp()
 	QStringList files = QFileDialog::getOpenFileNames(
 			this, "Select one or more files to open", QString::null, "Images (*.bmp)\nAll (*.*)");
 
-	if ((unsigned short)files.size() == m_Handler3D->NumSlices() ||
-			(unsigned short)files.size() == (m_Handler3D->EndSlice() - m_Handler3D->StartSlice()))
+	if ((unsigned)files.size() == m_Handler3D->NumSlices() ||
+			(unsigned)files.size() == (m_Handler3D->EndSlice() - m_Handler3D->StartSlice()))
 	{
 		files.sort();
 
@@ -2577,13 +2591,24 @@ void MainWindow::ExecuteSaveprojas()
 		if (after_dot != -1)
 			temp_file_name_without_extension = temp_file_name.mid(0, after_dot);
 
+		// the slices are written in the background if possible, otherwise the user has to wait
+		bool const background = m_Handler3D->CanSaveInBackground();
 		int num_tasks = 3;
-		QProgressDialog progress("Save in progress...", "Cancel", 0, num_tasks, this);
-		progress.show();
-		QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-		progress.setWindowModality(Qt::WindowModal);
-		progress.setModal(true);
-		progress.setValue(1);
+		std::unique_ptr<QProgressDialog> progress;
+		if (background)
+		{
+			m_SaveProgressBar->show();
+			statusBar()->showMessage("Saving project...");
+		}
+		else
+		{
+			progress = std::make_unique<QProgressDialog>("Save in progress...", "Cancel", 0, num_tasks, this);
+			progress->show();
+			QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+			progress->setWindowModality(Qt::WindowModal);
+			progress->setModal(true);
+			progress->setValue(1);
+		}
 
 		setWindowTitle(QString(" iSeg ") + QString(xstr(ISEG_VERSION)) +
 							 QString(" - ") + TruncateFileName(savefilename));
@@ -2591,7 +2616,9 @@ void MainWindow::ExecuteSaveprojas()
 		//m_saveprojfilename = tempFileName;
 		//AddLoadProj(tempFileName);
 		AddLoadProj(m_MSaveprojfilename);
-		FILE* fp = m_Handler3D->SaveProject(temp_file_name.toAscii(), "xmf");
+		FILE* fp = m_Handler3D->SaveProject(temp_file_name.toAscii(), "xmf", m_SaveProgress, [this](bool) {
+			QMetaObject::invokeMethod(this, "BackgroundSaveFinished", Qt::QueuedConnection);
+		});
 		fp = m_BitstackWidget->SaveProj(fp);
 		unsigned short save_proj_version = 12;
 		fp = TissueInfos::SaveTissues(fp, save_proj_version);
@@ -2622,21 +2649,22 @@ void MainWindow::ExecuteSaveprojas()
 
 		fclose(fp);
 
-		progress.setValue(2);
-
-		if (QFile::exists(source_file_name_without_extension + ".xmf"))
-			QFile::remove(source_file_name_without_extension + ".xmf");
-		QFile::rename(temp_file_name_without_extension + ".xmf", source_file_name_without_extension + ".xmf");
-
-		if (QFile::exists(source_file_name_without_extension + ".prj"))
-			QFile::remove(source_file_name_without_extension + ".prj");
-		QFile::rename(temp_file_name_without_extension + ".prj", source_file_name_without_extension + ".prj");
-
-		if (QFile::exists(source_file_name_without_extension + ".h5"))
-			QFile::remove(source_file_name_without_extension + ".h5");
-		QFile::rename(temp_file_name_without_extension + ".h5", source_file_name_without_extension + ".h5");
-
-		progress.setValue(num_tasks);
+		if (m_Handler3D->BackgroundSavePending())
+		{
+			// replaced when the slices are written, see BackgroundSaveFinished
+			m_PendingSaveTemp = temp_file_name_without_extension;
+			m_PendingSaveTarget = source_file_name_without_extension;
+			m_PendingSaveAsk = false;
+		}
+		else
+		{
+			m_SaveProgressBar->hide();
+			if (progress)
+				progress->setValue(2);
+			ReplaceProjectFiles(temp_file_name_without_extension, source_file_name_without_extension, false);
+			if (progress)
+				progress->setValue(num_tasks);
+		}
 
 		emit EndDataexport(this);
 	}
@@ -2657,7 +2685,14 @@ void MainWindow::ExecuteSavecopyas()
 		if (!savefilename.endsWith(QString(".prj")))
 			savefilename.append(".prj");
 
-		FILE* fp = m_Handler3D->SaveProject(savefilename.toAscii(), "xmf");
+		if (m_Handler3D->CanSaveInBackground())
+		{
+			m_SaveProgressBar->show();
+			statusBar()->showMessage("Saving project...");
+		}
+		FILE* fp = m_Handler3D->SaveProject(savefilename.toAscii(), "xmf", m_SaveProgress, [this](bool) {
+			QMetaObject::invokeMethod(this, "BackgroundSaveFinished", Qt::QueuedConnection);
+		});
 		fp = m_BitstackWidget->SaveProj(fp);
 		unsigned short save_proj_version = 12;
 		fp = TissueInfos::SaveTissues(fp, save_proj_version);
@@ -2687,6 +2722,8 @@ void MainWindow::ExecuteSavecopyas()
 		fp = SaveNotes(fp, save_proj_version);
 
 		fclose(fp);
+		if (!m_Handler3D->BackgroundSavePending())
+			m_SaveProgressBar->hide();
 
 		emit EndDataexport(this);
 	}
@@ -2716,7 +2753,7 @@ void MainWindow::SaveSettings()
 	fwrite(&flag, 1, sizeof(bool), fp);
 	flag = !m_Hidecopyswap->isChecked();
 	fwrite(&flag, 1, sizeof(bool), fp);
-	for (unsigned short i = 0; i < 16; i++)
+	for (unsigned i = 0; i < 16; i++)
 	{
 		flag = true;
 		if (i < m_ShowtabAction.size() && m_ShowtabAction[i])
@@ -2748,11 +2785,16 @@ void MainWindow::SaveSettings()
 	settings.setValue("geometry", saveGeometry());
 	settings.setValue("state", saveState());
 	settings.setValue("NumberOfUndoSteps", this->m_Handler3D->GetNumberOfUndoSteps());
-	settings.setValue("NumberOfUndoArrays", this->m_Handler3D->GetNumberOfUndoArrays());
+	settings.setValue("UndoMemoryBudgetMB", static_cast<int>(this->m_Handler3D->GetUndoMemoryBudget() / (1024 * 1024)));
+	settings.setValue("UndoSpillToDisk", this->m_Handler3D->GetUndoSpillToDisk());
 	settings.setValue("Compression", this->m_Handler3D->GetCompression());
 	settings.setValue("ContiguousMemory", this->m_Handler3D->GetContiguousMemory());
 	settings.setValue("BloscEnabled", BloscEnabled());
 	settings.setValue("SaveTarget", this->m_Handler3D->SaveTarget());
+	settings.setValue("ContiguousStorage", this->m_Handler3D->GetContiguousStorage());
+	settings.setValue("CompressedTissues", this->m_Handler3D->GetCompressedTissues());
+	settings.setValue("PagingBudgetMB", static_cast<int>(this->m_Handler3D->GetPagingBudget() / (1024 * 1024)));
+	settings.setValue("StackBudgetMB", static_cast<int>(this->m_Handler3D->GetStackBudget() / (1024 * 1024)));
 	settings.endGroup();
 	settings.beginGroup("RecentPlaces");
 	auto places = RecentPlaces::RecentDirectories();
@@ -2827,7 +2869,7 @@ void MainWindow::LoadSettings(const std::string& loadfilename)
 	}
 
 	// load visibility settings from file
-	for (unsigned short i = 0; i < 14; i++)
+	for (unsigned i = 0; i < 14; i++)
 	{
 		fread(&flag, sizeof(bool), 1, fp);
 		if (i < nrtabbuttons)
@@ -2889,11 +2931,16 @@ void MainWindow::LoadSettings(const std::string& loadfilename)
 		restoreGeometry(settings.value("geometry").toByteArray());
 		restoreState(settings.value("state").toByteArray());
 		this->m_Handler3D->SetNumberOfUndoSteps(settings.value("NumberOfUndoSteps", 50).toUInt());
-		this->m_Handler3D->SetNumberOfUndoArrays(settings.value("NumberOfUndoArrays", 20).toUInt());
+		this->m_Handler3D->SetUndoMemoryBudget(static_cast<size_t>(settings.value("UndoMemoryBudgetMB", 1024).toInt()) * 1024 * 1024);
+		this->m_Handler3D->SetUndoSpillToDisk(settings.value("UndoSpillToDisk", true).toBool());
 		this->m_Handler3D->SetCompression(settings.value("Compression", 0).toInt());
 		this->m_Handler3D->SetContiguousMemory(settings.value("ContiguousMemory", true).toBool());
 		SetBloscEnabled(settings.value("BloscEnabled", false).toBool());
 		this->m_Handler3D->SetSaveTarget(settings.value("SaveTarget", false).toBool());
+		this->m_Handler3D->SetContiguousStorage(settings.value("ContiguousStorage", false).toBool());
+		this->m_Handler3D->SetCompressedTissues(settings.value("CompressedTissues", false).toBool());
+		this->m_Handler3D->SetPagingBudget(static_cast<size_t>(settings.value("PagingBudgetMB", 0).toInt()) * 1024 * 1024);
+		this->m_Handler3D->SetStackBudget(static_cast<size_t>(settings.value("StackBudgetMB", 512).toInt()) * 1024 * 1024);
 		settings.endGroup();
 
 		settings.beginGroup("RecentPlaces");
@@ -3001,13 +3048,24 @@ void MainWindow::ExecuteSaveproj()
 			if (after_dot != -1)
 				temp_file_name_without_extension = temp_file_name.mid(0, after_dot);
 
+			// the slices are written in the background if possible, otherwise the user has to wait
+			bool const background = m_Handler3D->CanSaveInBackground();
 			int num_tasks = 3;
-			QProgressDialog progress("Save in progress...", "Cancel", 0, num_tasks, this);
-			progress.show();
-			QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-			progress.setWindowModality(Qt::WindowModal);
-			progress.setModal(true);
-			progress.setValue(1);
+			std::unique_ptr<QProgressDialog> progress;
+			if (background)
+			{
+				m_SaveProgressBar->show();
+				statusBar()->showMessage("Saving project...");
+			}
+			else
+			{
+				progress = std::make_unique<QProgressDialog>("Save in progress...", "Cancel", 0, num_tasks, this);
+				progress->show();
+				QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+				progress->setWindowModality(Qt::WindowModal);
+				progress->setModal(true);
+				progress->setValue(1);
+			}
 
 			setWindowTitle(QString(" iSeg ") + QString(xstr(ISEG_VERSION)) +
 								 QString(" - ") + TruncateFileName(m_MSaveprojfilename));
@@ -3015,7 +3073,9 @@ void MainWindow::ExecuteSaveproj()
 			m_MSaveprojfilename = temp_file_name;
 
 			//FILE *fp=handler3D->SaveProject(m_saveprojfilename.toAscii(),"xmf");
-			FILE* fp = m_Handler3D->SaveProject(temp_file_name.toAscii(), "xmf");
+			FILE* fp = m_Handler3D->SaveProject(temp_file_name.toAscii(), "xmf", m_SaveProgress, [this](bool) {
+				QMetaObject::invokeMethod(this, "BackgroundSaveFinished", Qt::QueuedConnection);
+			});
 			fp = m_BitstackWidget->SaveProj(fp);
 			unsigned short save_proj_version = 12;
 			fp = TissueInfos::SaveTissues(fp, save_proj_version);
@@ -3046,66 +3106,24 @@ void MainWindow::ExecuteSaveproj()
 
 			fclose(fp);
 
-			progress.setValue(2);
-
-			QMessageBox m_box;
-			m_box.setWindowTitle("Saving project");
-			m_box.setText("The project you are trying to save is open somewhere else. "
-										"Please, close it before continuing and press OK or press "
-										"Cancel to stop saving process.");
-			m_box.addButton(QMessageBox::Ok);
-			m_box.addButton(QMessageBox::Cancel);
-
-			if (QFile::exists(source_file_name_without_extension + ".xmf"))
+			if (m_Handler3D->BackgroundSavePending())
 			{
-				bool remove_success =
-						QFile::remove(source_file_name_without_extension + ".xmf");
-				while (!remove_success)
-				{
-					int ret = m_box.exec();
-					if (ret == QMessageBox::Cancel)
-						return;
-
-					remove_success =
-							QFile::remove(source_file_name_without_extension + ".xmf");
-				}
+				// replaced when the slices are written, see BackgroundSaveFinished
+				m_PendingSaveTemp = temp_file_name_without_extension;
+				m_PendingSaveTarget = source_file_name_without_extension;
+				m_PendingSaveAsk = true;
 			}
-			QFile::rename(temp_file_name_without_extension + ".xmf", source_file_name_without_extension + ".xmf");
-
-			if (QFile::exists(source_file_name_without_extension + ".prj"))
-			{
-				bool remove_success =
-						QFile::remove(source_file_name_without_extension + ".prj");
-				while (!remove_success)
-				{
-					int ret = m_box.exec();
-					if (ret == QMessageBox::Cancel)
-						return;
-
-					remove_success =
-							QFile::remove(source_file_name_without_extension + ".prj");
-				}
-			}
-			QFile::rename(temp_file_name_without_extension + ".prj", source_file_name_without_extension + ".prj");
-
-			if (QFile::exists(source_file_name_without_extension + ".h5"))
+			else
 			{
-				bool remove_success =
-						QFile::remove(source_file_name_without_extension + ".h5");
-				while (!remove_success)
-				{
-					int ret = m_box.exec();
-					if (ret == QMessageBox::Cancel)
-						return;
-
-					remove_success = QFile::remove(source_file_name_without_extension + ".h5");
-				}
+				m_SaveProgressBar->hide();
+				if (progress)
+					progress->setValue(2);
+				ReplaceProjectFiles(temp_file_name_without_extension, source_file_name_without_extension, true);
+				if (progress)
+					progress->setValue(num_tasks);
 			}
-			QFile::rename(temp_file_name_without_extension + ".h5", source_file_name_without_extension + ".h5");
 
 			m_MSaveprojfilename = source_file_name_without_extension + ".prj";
-
-			progress.setValue(num_tasks);
 		}
 		else
 		{
@@ -3118,6 +3136,70 @@ void MainWindow::ExecuteSaveproj()
 	emit EndDataexport(this);
 }
 
+void MainWindow::BackgroundSaveFinished()
+{
+	WaitForBackgroundSave();
+}
+
+void MainWindow::WaitForBackgroundSave()
+{
+	if (!m_Handler3D->BackgroundSavePending())
+		return;
+
+	QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+	bool const ok = m_Handler3D->FinishBackgroundSave();
+	QApplication::restoreOverrideCursor();
+	m_SaveProgressBar->hide();
+
+	// cleared first, replacing the files may ask the user, i.e. run an event loop
+	QString const temp_base = m_PendingSaveTemp;
+	QString const base = m_PendingSaveTarget;
+	m_PendingSaveTemp.clear();
+	m_PendingSaveTarget.clear();
+	if (!ok)
+	{
+		statusBar()->clearMessage();
+		QMessageBox::warning(this, "iSeg", "Saving the project failed.\n", QMessageBox::Ok | QMessageBox::Default);
+	}
+	else if (temp_base.isEmpty() || ReplaceProjectFiles(temp_base, base, m_PendingSaveAsk))
+	{
+		statusBar()->showMessage("Project saved", 5000);
+	}
+	else
+	{
+		statusBar()->showMessage("Saving the project was canceled", 5000);
+	}
+}
+
+bool MainWindow::ReplaceProjectFiles(const QString& temp_base, const QString& base, bool ask)
+{
+	QMessageBox m_box;
+	m_box.setWindowTitle("Saving project");
+	m_box.setText("The project you are trying to save is open somewhere else. "
+								"Please, close it before continuing and press OK or press "
+								"Cancel to stop saving process.");
+	m_box.addButton(QMessageBox::Ok);
+	m_box.addButton(QMessageBox::Cancel);
+
+	for (const QString& extension : {".xmf", ".prj", ".h5"})
+	{
+		if (QFile::exists(base + extension))
+		{
+			bool remove_success = QFile::remove(base + extension);
+			while (!remove_success && ask)
+			{
+				int ret = m_box.exec();
+				if (ret == QMessageBox::Cancel)
+					return false;
+
+				remove_success = QFile::remove(base + extension);
+			}
+		}
+		QFile::rename(temp_base + extension, base + extension);
+	}
+	return true;
+}
+
 void MainWindow::LoadAny(const QString& loadfilename)
 {
 	const auto file_path = boost::filesystem::path(loadfilename.toStdString());
@@ -3170,6 +3252,8 @@ void MainWindow::Loadproj(const QString& loadfilename)
 	}
 	bool stillopen = false;
 
+	WaitForBackgroundSave();
+
 	DataSelection data_selection;
 	data_selection.allSlices = true;
 	data_selection.bmp = true;
@@ -3248,6 +3332,8 @@ void MainWindow::LoadS4Llink(const QString& loadfilename)
 		return;
 	}
 
+	WaitForBackgroundSave();
+
 	DataSelection data_selection;
 	data_selection.allSlices = true;
 	data_selection.bmp = true;
@@ -3373,6 +3459,70 @@ void MainWindow::ExecuteLoadproj()
 	}
 }
 
+void MainWindow::ExecuteLoadProjectPreview()
+{
+	if (!MaybeSafe())
+	{
+		return;
+	}
+
+	QString loadfilename = RecentPlaces::GetOpenFileName(this, "Open file", QString(), "Projects (*.prj)\nAll (*.*)");
+	if (loadfilename.isEmpty())
+	{
+		return;
+	}
+
+	bool ok = false;
+	int const level = QInputDialog::getInt(this, "Open Project Preview", "Downsample by 2^level:", 1, 1, VolumePyramid::kMaxLevels, 1, &ok);
+	if (!ok)
+	{
+		return;
+	}
+
+	WaitForBackgroundSave();
+
+	DataSelection data_selection;
+	data_selection.allSlices = true;
+	data_selection.bmp = true;
+	data_selection.work = true;
+	data_selection.tissues = true;
+	emit BeginDatachange(data_selection, this, false);
+
+	// the coarse volume must not be saved over the project
+	m_MSaveprojfilename = "";
+	setWindowTitle(QString(" iSeg ") + QString(xstr(ISEG_VERSION)) + QString(" - No Filename"));
+
+	bool const res = m_Handler3D->LoadPreview(loadfilename.toAscii(), level);
+	if (res)
+	{
+		QFileInfo file_info(loadfilename);
+		QString const h5file = file_info.dir().absoluteFilePath(file_info.completeBaseName() + ".h5");
+		TissueInfos::LoadTissuesHDF(h5file.toAscii(), 0);
+	}
+
+	emit EndDatachange(this, iseg::ClearUndo);
+	tissues_size_t m;
+	m_Handler3D->GetRangetissue(&m);
+	m_Handler3D->Buildmissingtissues(m);
+	m_TissueTreeWidget->UpdateTreeWidget();
+	TissuenrChanged(m_TissueTreeWidget->GetCurrentType() - 1);
+
+	PixelsizeChanged();
+	SlicethicknessChanged();
+
+	m_TissueTreeWidget->UpdateTissueIcons();
+	m_TissueTreeWidget->UpdateFolderIcons();
+
+	ResetBrightnesscontrast();
+
+	EnableActionsAfterPrjLoaded(true);
+
+	if (!res)
+	{
+		QMessageBox::warning(this, "iSeg", "The project has no preview.\nIt is stored when the project is saved again.", QMessageBox::Ok | QMessageBox::Default);
+	}
+}
+
 void MainWindow::ExecuteLoadproj1()
 {
 	if (!MaybeSafe())
@@ -3599,14 +3749,15 @@ void MainWindow::ExecuteExportlabelfield()
 	data_selection.tissues = true;
 	emit BeginDataexport(data_selection, this);
 
-	QString savefilename = RecentPlaces::GetSaveFileName(this, "Save as", QString::null, "AmiraMesh Ascii (*.am)");
+	QString savefilename = RecentPlaces::GetSaveFileName(this, "Save as", QString::null, "AmiraMesh (*.am);;VTK (*.vtk *.vti)");
 
-	if (savefilename.length() > 4 && !savefilename.endsWith(QString(".am")))
+	if (savefilename.length() > 4 && !savefilename.endsWith(QString(".am")) && !savefilename.endsWith(QString(".vtk")) && !savefilename.endsWith(QString(".vti")))
 		savefilename.append(".am");
 
 	if (!savefilename.isEmpty())
 	{
-		m_Handler3D->PrintAmascii(savefilename.toAscii());
+		ProgressDialog progress("Export labelfield ...", this);
+		m_Handler3D->ExportLabelField(savefilename.toAscii(), false, &progress);
 	}
 
 	emit EndDataexport(this);
@@ -3627,7 +3778,8 @@ void MainWindow::ExecuteExportmat()
 
 	if (!savefilename.isEmpty())
 	{
-		m_Handler3D->PrintTissuemat(savefilename.toAscii());
+		ProgressDialog progress("Export Matlab ...", this);
+		m_Handler3D->PrintTissuemat(savefilename.toAscii(), &progress);
 	}
 
 	emit EndDataexport(this);
@@ -4295,7 +4447,7 @@ void MainWindow::ExecuteActiveslicesconf()
 	ac.move(QCursor::pos());
 	ac.exec();
 
-	unsigned short slicenr = m_Handler3D->ActiveSlice() + 1;
+	unsigned slicenr = m_Handler3D->ActiveSlice() + 1;
 	if (m_Handler3D->StartSlice() >= slicenr ||
 			m_Handler3D->EndSlice() + 1 <= slicenr)
 	{
@@ -4461,7 +4613,7 @@ void MainWindow::ExecuteHidenotes(bool checked)
 void MainWindow::ExecuteShowtabtoggled(bool)
 {
 	auto nrtabbuttons = (unsigned short)m_Tabwidgets.size();
-	for (unsigned short i = 0; i < nrtabbuttons; i++)
+	for (unsigned i = 0; i < nrtabbuttons; i++)
 	{
 		m_ShowpbTab[i] = m_ShowtabAction[i]->isChecked();
 	}
@@ -4727,7 +4879,7 @@ void MainWindow::NextFeaturingSlice()
 	}
 
 	bool found;
-	unsigned short nextslice = m_Handler3D->GetNextFeaturingSlice(type, found);
+	unsigned nextslice = m_Handler3D->GetNextFeaturingSlice(type, found);
 	if (found)
 	{
 		m_Handler3D->SetActiveSlice(nextslice);
@@ -5649,7 +5801,7 @@ void MainWindow::SliceChanged()
 	WidgetInterface* qw = (WidgetInterface*)m_MethodTab->currentWidget();
 	qw->OnSlicenrChanged();
 
-	unsigned short slicenr = m_Handler3D->ActiveSlice() + 1;
+	unsigned slicenr = m_Handler3D->ActiveSlice() + 1;
 	QObject_disconnect(m_ScbSlicenr, SIGNAL(valueChanged(int)), this, SLOT(ScbSlicenrChanged()));
 	m_ScbSlicenr->setValue(int(slicenr));
 	QObject_connect(m_ScbSlicenr, SIGNAL(valueChanged(int)), this, SLOT(ScbSlicenrChanged()));
@@ -5679,6 +5831,17 @@ void MainWindow::SliceChanged()
 	{
 		m_Ysliceshower->ZposChanged();
 	}
+
+	if (m_Handler3D->GetCompressedTissues())
+	{
+		// deferred to the event loop, i.e. the new slice is shown first. Slices which are pinned by a tool are skipped.
+		QTimer::singleShot(0, this, SLOT(PackTissues()));
+	}
+}
+
+void MainWindow::PackTissues()
+{
+	m_Handler3D->PackTissues();
 }
 
 void MainWindow::Slices3dChanged(bool new_bitstack)
@@ -5711,7 +5874,7 @@ void MainWindow::Slices3dChanged(bool new_bitstack)
 		m_Nrslices = m_Handler3D->NumSlices();
 	}
 
-	unsigned short slicenr = m_Handler3D->ActiveSlice() + 1;
+	unsigned slicenr = m_Handler3D->ActiveSlice() + 1;
 	QObject_disconnect(m_ScbSlicenr, SIGNAL(valueChanged(int)), this, SLOT(ScbSlicenrChanged()));
 	m_ScbSlicenr->setValue(int(slicenr));
 	QObject_connect(m_ScbSlicenr, SIGNAL(valueChanged(int)), this, SLOT(ScbSlicenrChanged()));
@@ -5734,6 +5897,11 @@ void MainWindow::Slices3dChanged(bool new_bitstack)
 		m_Ysliceshower->ZposChanged();
 
 	qw->Init();
+
+	if (m_Handler3D->GetCompressedTissues())
+	{
+		QTimer::singleShot(0, this, SLOT(PackTissues()));
+	}
 }
 
 void MainWindow::ZoomIn()
@@ -6195,13 +6363,13 @@ void MainWindow::UpdateTabvisibility()
 {
 	auto nrtabbuttons = (unsigned short)m_Tabwidgets.size();
 	unsigned short counter = 0;
-	for (unsigned short i = 0; i < nrtabbuttons; i++)
+	for (unsigned i = 0; i < nrtabbuttons; i++)
 	{
 		if (m_ShowpbTab[i])
 			counter++;
 	}
 	unsigned short counter1 = 0;
-	for (unsigned short i = 0; i < nrtabbuttons; i++)
+	for (unsigned i = 0; i < nrtabbuttons; i++)
 	{
 		if (m_ShowpbTab[i])
 		{
@@ -6236,7 +6404,7 @@ void MainWindow::UpdateMethodButtonsPressed(WidgetInterface* qw)
 	auto nrtabbuttons = (unsigned short)m_Tabwidgets.size();
 	unsigned short counter = 0;
 	unsigned short pos = nrtabbuttons;
-	for (unsigned short i = 0; i < nrtabbuttons; i++)
+	for (unsigned i = 0; i < nrtabbuttons; i++)
 	{
 		if (m_ShowpbTab[i])
 		{
@@ -6247,7 +6415,7 @@ void MainWindow::UpdateMethodButtonsPressed(WidgetInterface* qw)
 	}
 
 	unsigned short counter1 = 0;
-	for (unsigned short i = 0; i < (counter + 1) / 2; i++, counter1++)
+	for (unsigned i = 0; i < (counter + 1) / 2; i++, counter1++)
 	{
 		if (counter1 == pos)
 			m_PbTab[i]->setChecked(true);
@@ -6255,7 +6423,7 @@ void MainWindow::UpdateMethodButtonsPressed(WidgetInterface* qw)
 			m_PbTab[i]->setChecked(false);
 	}
 
-	for (unsigned short i = (nrtabbuttons + 1) / 2; counter1 < counter;
+	for (unsigned i = (nrtabbuttons + 1) / 2; counter1 < counter;
 			 i++, counter1++)
 	{
 		if (counter1 == pos)
@@ -6366,12 +6534,12 @@ void MainWindow::PbTabPressed(int nr)
 {
 	auto nrtabbuttons = (unsigned short)m_Tabwidgets.size();
 	unsigned short tabnr = nr + 1;
-	for (unsigned short tabnr1 = 0; tabnr1 < m_PbTab.size(); tabnr1++)
+	for (unsigned tabnr1 = 0; tabnr1 < m_PbTab.size(); tabnr1++)
 	{
 		m_PbTab[tabnr1]->setChecked(tabnr == tabnr1 + 1);
 	}
 	unsigned short pos1 = 0;
-	for (unsigned short i = 0; i < nrtabbuttons; i++)
+	for (unsigned i = 0; i < nrtabbuttons; i++)
 		if (m_ShowpbTab[i])
 			pos1++;
 	if ((tabnr > (nrtabbuttons + 1) / 2))
@@ -6517,7 +6685,7 @@ void MainWindow::ExecuteCleanup()
 {
 	tissues_size_t** slices = new tissues_size_t*[m_Handler3D->EndSlice() - m_Handler3D->StartSlice()];
 	tissuelayers_size_t activelayer = m_Handler3D->ActiveTissuelayer();
-	for (unsigned short i = m_Handler3D->StartSlice(); i < m_Handler3D->EndSlice(); i++)
+	for (unsigned i = m_Handler3D->StartSlice(); i < m_Handler3D->EndSlice(); i++)
 	{
 		slices[i - m_Handler3D->StartSlice()] = m_Handler3D->ReturnTissues(activelayer, i);
 	}
@@ -6819,6 +6987,9 @@ void MainWindow::CancelTransformHelper()
 
 void MainWindow::HandleBeginDataexport(DataSelection& dataSelection, QWidget* sender)
 {
+	// the files must not be written while the project is saved
+	WaitForBackgroundSave();
+
 	// Handle pending transforms
 	if (m_MethodTab->currentWidget() == m_TransformWidget && (dataSelection.bmp || dataSelection.work || dataSelection.tissues))
 	{
@@ -28,6 +28,7 @@ class QTextEdit;
 class QLineEdit;
 class QMenuBar;
 class QHBoxLayout;
+class QProgressBar;
 class QPushButton;
 class QStackedWidget;
 class QSpinBox;
@@ -44,6 +45,7 @@ class QLogTable;
 
 namespace iseg {
 
+class ProgressBar;
 class SlicesHandler;
 class WidgetInterface;
 class TissueTreeWidget;
@@ -125,6 +127,10 @@ protected:
 	void UpdateBrightnesscontrast(bool bmporwork, bool paint = true);
 	FILE* SaveNotes(FILE* fp, unsigned short version);
 	FILE* LoadNotes(FILE* fp, unsigned short version);
+	/// Wait for a project which is saved in the background, e.g. before other files are read or written, and replace the project files by the saved ones
+	void WaitForBackgroundSave();
+	/// Replace the project files base.xmf/.prj/.h5 by the temp_base ones. With ask, the user may close files which are open elsewhere.
+	bool ReplaceProjectFiles(const QString& temp_base, const QString& base, bool ask);
 
 signals:
 	void BmpChanged();
@@ -257,7 +263,7 @@ private:
 	QCheckBox* m_CbWorkpicturevisible;
 	void ClearStack();
 	void SliceChanged();
-	unsigned short m_Nrslices;
+	unsigned m_Nrslices;
 	void Slices3dChanged(bool new_bitstack);
 	QLabel* m_LbSlicenr;
 	QLabel* m_LbInactivewarning;
@@ -284,6 +290,12 @@ private:
 	QAction* m_Redonr = nullptr;
 	QString m_MSaveprojfilename;
 	QString m_S4Lcommunicationfilename;
+	QProgressBar* m_SaveProgressBar = nullptr;
+	ProgressBar* m_SaveProgress = nullptr;
+	/// files of the project saved in the background (without extension), replaced when it is written
+	QString m_PendingSaveTemp;
+	QString m_PendingSaveTarget;
+	bool m_PendingSaveAsk = false;
 	Project m_MLoadprojfilename;
 	Atlas m_MAtlasfilename;
 	QLabel* m_LbContrastbmp;
@@ -323,6 +335,7 @@ private:
 	bool m_NewDataAfterSwap;
 
 private slots:
+	void PackTissues();
 	void UpdateBmp();
 	void UpdateWork();
 	void UpdateTissue();
@@ -356,9 +369,11 @@ private slots:
 	void ExecuteSavecopyas();
 	void ExecuteSaveactiveslicesas();
 	void ExecuteSaveproj();
+	void BackgroundSaveFinished();
 	void ExecuteMergeprojects();
 	void ExecuteBoneconnectivity();
 	void ExecuteLoadproj();
+	void ExecuteLoadProjectPreview();
 	void ExecuteLoadproj1();
 	void ExecuteLoadproj2();
 	void ExecuteLoadproj3();
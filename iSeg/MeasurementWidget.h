@@ -56,7 +56,7 @@ private:
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
 	std::vector<AugmentedMark> m_Labels;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	QRadioButton* m_RbVector;
 	QRadioButton* m_RbDist;
@@ -41,7 +41,7 @@ private:
 
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	QRadioButton* m_RbOpen;
 	QRadioButton* m_RbClose;
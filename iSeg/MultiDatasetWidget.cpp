@@ -112,9 +112,9 @@ void MultiDatasetWidget::NewLoaded()
 
 	Initialize();
 
-	const unsigned short w_loaded = m_Handler3D->Width();
-	const unsigned short h_loaded = m_Handler3D->Height();
-	const unsigned short nrofslices_loaded = m_Handler3D->NumSlices();
+	const unsigned w_loaded = m_Handler3D->Width();
+	const unsigned h_loaded = m_Handler3D->Height();
+	const unsigned nrofslices_loaded = m_Handler3D->NumSlices();
 
 	// TODO BL ?
 	const bool check_match = true;
@@ -350,9 +350,9 @@ void MultiDatasetWidget::AddDatasetPressed()
 bool MultiDatasetWidget::CheckInfoAndAddToList(MultiDatasetWidget::SDatasetInfo& newRadioButton, QStringList loadfilenames, unsigned short width, unsigned short height, unsigned short nrofslices)
 {
 	// check whether the new dataset matches the dataset loaded
-	const unsigned short w_loaded = m_Handler3D->Width();
-	const unsigned short h_loaded = m_Handler3D->Height();
-	const unsigned short nrofslices_loaded = m_Handler3D->NumSlices();
+	const unsigned w_loaded = m_Handler3D->Width();
+	const unsigned h_loaded = m_Handler3D->Height();
+	const unsigned nrofslices_loaded = m_Handler3D->NumSlices();
 
 	if (w_loaded == width && h_loaded == height && nrofslices_loaded == nrofslices)
 	{
@@ -198,7 +198,7 @@ void OutlineCorrectionWidget::DrawGuide()
 	if (m_Brush->isChecked() && m_BrushParams->m_ShowGuide->isChecked())
 	{
 		int slice = static_cast<int>(m_Handler3D->ActiveSlice()) + m_BrushParams->m_GuideOffset->value();
-		unsigned slice_clamped = std::min(std::max(slice, 0), m_Handler3D->NumSlices() - 1);
+		unsigned slice_clamped = std::min(std::max(slice, 0), static_cast<int>(m_Handler3D->NumSlices()) - 1);
 		if (slice == slice_clamped)
 		{
 			std::vector<Mark> marks;
@@ -212,6 +212,7 @@ void OutlineCorrectionWidget::DrawGuide()
 			else
 			{
 				Mark m(m_Tissuenr);
+				TissuesPin pin(m_Handler3D);
 				marks = extract_boundary<Mark, tissues_size_t>(m_Handler3D->TissueSlices(0).at(slice_clamped), w, h, m, [this](tissues_size_t v) { return (v == m_Tissuenr); });
 			}
 
@@ -228,7 +229,7 @@ void OutlineCorrectionWidget::DrawGuide()
 void OutlineCorrectionWidget::CopyGuide(Point* p)
 {
 	int slice = static_cast<int>(m_Handler3D->ActiveSlice()) + m_BrushParams->m_GuideOffset->value();
-	unsigned slice_clamped = std::min(std::max(slice, 0), m_Handler3D->NumSlices() - 1);
+	unsigned slice_clamped = std::min(std::max(slice, 0), static_cast<int>(m_Handler3D->NumSlices()) - 1);
 	if (slice == slice_clamped)
 	{
 		unsigned w = m_Handler3D->Width();
@@ -257,6 +258,7 @@ void OutlineCorrectionWidget::CopyGuide(Point* p)
 		}
 		else
 		{
+			TissuesPin pin(m_Handler3D);
 			auto ref = m_Handler3D->TissueSlices(0).at(slice_clamped);
 			auto current = m_Handler3D->TissueSlices(0).at(m_Handler3D->ActiveSlice());
 
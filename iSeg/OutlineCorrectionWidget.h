@@ -98,7 +98,7 @@ private:
 	bool m_Selectobj;
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 	Vec3 m_Spacing;
 	Point m_LastPt;
 
@@ -32,6 +32,11 @@ Settings::Settings(QWidget* parent)
 	this->m_Ui->checkBoxContiguousMemory->setChecked(m_MainWindow->m_Handler3D->GetContiguousMemory());
 	this->m_Ui->checkBoxEnableBlosc->setChecked(BloscEnabled());
 	this->m_Ui->checkBoxSaveTarget->setChecked(m_MainWindow->m_Handler3D->SaveTarget());
+	this->m_Ui->checkBoxContiguousStorage->setChecked(m_MainWindow->m_Handler3D->GetContiguousStorage());
+	this->m_Ui->checkBoxCompressedTissues->setChecked(m_MainWindow->m_Handler3D->GetCompressedTissues());
+	this->m_Ui->spinBoxPagingBudget->setValue(static_cast<int>(m_MainWindow->m_Handler3D->GetPagingBudget() / (1024 * 1024)));
+	this->m_Ui->spinBoxStackBudget->setValue(static_cast<int>(m_MainWindow->m_Handler3D->GetStackBudget() / (1024 * 1024)));
+	this->m_Ui->labelCacheStatisticsValue->setText(QString("%1 / %2").arg(m_MainWindow->m_Handler3D->GetCacheHits()).arg(m_MainWindow->m_Handler3D->GetCacheMisses()));
 }
 
 Settings::~Settings() { delete m_Ui; }
@@ -43,6 +48,10 @@ void Settings::accept()
 	m_MainWindow->m_Handler3D->SetContiguousMemory(this->m_Ui->checkBoxContiguousMemory->isChecked());
 	SetBloscEnabled(this->m_Ui->checkBoxEnableBlosc->isChecked());
 	m_MainWindow->m_Handler3D->SetSaveTarget(this->m_Ui->checkBoxSaveTarget->isChecked());
+	m_MainWindow->m_Handler3D->SetContiguousStorage(this->m_Ui->checkBoxContiguousStorage->isChecked());
+	m_MainWindow->m_Handler3D->SetCompressedTissues(this->m_Ui->checkBoxCompressedTissues->isChecked());
+	m_MainWindow->m_Handler3D->SetPagingBudget(static_cast<size_t>(this->m_Ui->spinBoxPagingBudget->value()) * 1024 * 1024);
+	m_MainWindow->m_Handler3D->SetStackBudget(static_cast<size_t>(this->m_Ui->spinBoxStackBudget->value()) * 1024 * 1024);
 
 	m_MainWindow->SaveSettings();
 	this->hide();
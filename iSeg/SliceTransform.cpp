@@ -159,7 +159,7 @@ void SliceTransform::Execute(bool allSlices)
 {
 	if (allSlices)
 	{
-		for (unsigned short slice = m_Handler3D->StartSlice();
+		for (unsigned slice = m_Handler3D->StartSlice();
 				 slice < m_Handler3D->EndSlice(); ++slice)
 		{
 			// Active slice has already been transformed
@@ -428,7 +428,7 @@ void SliceTransform::ResetTransformMatrix()
 
 void SliceTransform::GetTransformMatrix(double* copyToMatrix)
 {
-	for (unsigned short i = 0; i < 9; ++i)
+	for (unsigned i = 0; i < 9; ++i)
 	{
 		copyToMatrix[i] = m_TransformMatrix[i];
 	}
@@ -496,8 +496,8 @@ void SliceTransform::ApplyTransform(bool source, bool target, bool tissues)
 	// transformMatrix * original --> preview
 	double a, b, c;
 	int x_tr, y_tr;
-	unsigned short width = m_Bmphand->ReturnWidth();
-	unsigned short height = m_Bmphand->ReturnHeight();
+	unsigned width = m_Bmphand->ReturnWidth();
+	unsigned height = m_Bmphand->ReturnHeight();
 	float* source_ptr = m_Bmphand->ReturnBmp();
 	float* target_ptr = m_Bmphand->ReturnWork();
 	tissues_size_t* tissues_ptr =
@@ -558,8 +558,8 @@ void SliceTransform::ApplyTransformAll()
 	// transformMatrix * original --> preview
 	double a, b, c;
 	int x_tr, y_tr;
-	unsigned short width = m_Bmphand->ReturnWidth();
-	unsigned short height = m_Bmphand->ReturnHeight();
+	unsigned width = m_Bmphand->ReturnWidth();
+	unsigned height = m_Bmphand->ReturnHeight();
 	float* source_ptr = m_Bmphand->ReturnBmp();
 	float* target_ptr = m_Bmphand->ReturnWork();
 	tissues_size_t* tissues_ptr =
@@ -107,7 +107,7 @@ void Bmptissuesliceshower::WorkChanged()
 void Bmptissuesliceshower::update()
 {
 	ISEG_DEBUG("SliceViewerWidget::update (slice:" << m_Handler3D->ActiveSlice() << ")");
-	unsigned short w, h;
+	unsigned w, h;
 
 	if (m_DirectionX)
 	{
@@ -312,7 +312,7 @@ void Bmptissuesliceshower::SetTissuevisible(bool on)
 
 void Bmptissuesliceshower::SlicenrChanged(int i)
 {
-	m_Slicenr = (unsigned short)i;
+	m_Slicenr = (unsigned)i;
 	update();
 }
 
@@ -481,7 +481,7 @@ void SliceViewerWidget::BmpChanged()
 {
 	if (m_RbBmp->isChecked())
 	{
-		unsigned short nrslicesnew;
+		unsigned nrslicesnew;
 		if (m_DirectionX)
 			nrslicesnew = m_Handler3D->Width();
 		else
@@ -505,7 +505,7 @@ void SliceViewerWidget::WorkChanged()
 {
 	if (m_RbWork->isChecked())
 	{
-		unsigned short nrslicesnew;
+		unsigned nrslicesnew;
 		if (m_DirectionX)
 			nrslicesnew = m_Handler3D->Width();
 		else
@@ -42,7 +42,7 @@ private:
 	void ReloadBits();
 	QImage m_Image;
 	unsigned short m_Width, m_Height;
-	unsigned short m_Nrslices, m_Slicenr;
+	unsigned m_Nrslices, m_Slicenr;
 	float* m_Bmpbits;
 	tissues_size_t* m_Tissue;
 	bool m_Tissuevisible;
@@ -99,7 +99,7 @@ private:
 	QButtonGroup* m_BgBmporwork;
 	SlicesHandler* m_Handler3D;
 
-	unsigned short m_Nrslices;
+	unsigned m_Nrslices;
 	bool m_Tissuevisible;
 	bool m_DirectionX;
 	bool m_Xyexists;
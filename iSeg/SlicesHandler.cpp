@@ -29,17 +29,21 @@
 
 #include "Data/ItkProgressObserver.h"
 #include "Data/ScopeExit.h"
+#include "Data/ScopedTimer.h"
 #include "Data/SlicesHandlerITKInterface.h"
 #include "Data/Transform.h"
 
+#include "Core/AxisPermutation.h"
 #include "Core/ColorLookupTable.h"
 #include "Core/ConnectedShapeBasedInterpolation.h"
+#include "Core/DicomHeaderIndex.h"
 #include "Core/ExpectationMaximization.h"
 #include "Core/HDF5Writer.h"
 #include "Core/ImageForestingTransform.h"
 #include "Core/ImageReader.h"
 #include "Core/ImageWriter.h"
 #include "Core/KMeans.h"
+#include "Core/LabelFieldWriter.h"
 #include "Core/MatlabExport.h"
 #include "Core/MultidimensionalGamma.h"
 #include "Core/Outline.h"
@@ -47,9 +51,13 @@
 #include "Core/RTDoseIODModule.h"
 #include "Core/RTDoseReader.h"
 #include "Core/RTDoseWriter.h"
+#include "Core/RawVolumeReader.h"
+#include "Core/SlicePageFile.h"
 #include "Core/SliceProvider.h"
 #include "Core/SmoothSteps.h"
 #include "Core/Treaps.h"
+#include "Core/VolumePyramid.h"
+#include "Core/VolumeStorage.h"
 #include "Core/VoxelSurface.h"
 
 #include "vtkMyGDCMPolyDataReader.h"
@@ -77,11 +85,16 @@
 #include <boost/format.hpp>
 
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QMessageBox>
 #include <QProgressDialog>
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <map>
+#include <numeric>
 
 #ifndef NO_OPENMP_SUPPORT
 #	include <omp.h>
@@ -97,17 +110,32 @@ namespace // PROJECT VERSION NUMBERS
 // version 3: ?
 // version 4: added dc[6], ...?
 // version 5: removed dc[6] and displacement[3], added transform[4][4]
+//            if the (16-bit) number of slices is 0, the actual number of slices follows the transform as 32-bit value
 int const project_version = 5;
 
 // version 0: tissues_size_t=unsigned char
-// version 1: tissues_size_t=unsigned short, ...?
+// version 1: tissues_size_t=unsigned, ...?
 int const tissue_version = 1;
+
+unsigned ReadProjectNumberOfSlices(FILE* fp)
+{
+	unsigned short nr_slices16 = 0;
+	fread(&nr_slices16, sizeof(unsigned short), 1, fp);
+	if (nr_slices16 != 0)
+		return nr_slices16;
+
+	// skip thickness, pixel size, version and transform
+	fseek(fp, 3 * sizeof(float) + sizeof(int) + 16 * sizeof(float), SEEK_CUR);
+	std::uint32_t nr_slices32 = 0;
+	fread(&nr_slices32, sizeof(std::uint32_t), 1, fp);
+	return nr_slices32;
+}
 } // namespace
 
 struct Posit
 {
 	unsigned m_Pxy;
-	unsigned short m_Pz;
+	unsigned m_Pz;
 	inline bool operator<(const Posit& a) const
 	{
 		if (m_Pz < a.m_Pz || ((m_Pz == a.m_Pz) && (m_Pxy < a.m_Pxy)))
@@ -141,44 +169,48 @@ SlicesHandler::SlicesHandler()
 	m_Undo3D = true;
 }
 
-SlicesHandler::~SlicesHandler() { delete m_TissueHierachy; }
+SlicesHandler::~SlicesHandler()
+{
+	FinishBackgroundSave();
+	delete m_TissueHierachy;
+}
 
-float SlicesHandler::GetWorkPt(Point p, unsigned short slicenr)
+float SlicesHandler::GetWorkPt(Point p, unsigned slicenr)
 {
-	return m_ImageSlices[slicenr].WorkPt(p);
+	return ImageSlice(slicenr).WorkPt(p);
 }
 
-void SlicesHandler::SetWorkPt(Point p, unsigned short slicenr, float f)
+void SlicesHandler::SetWorkPt(Point p, unsigned slicenr, float f)
 {
-	m_ImageSlices[slicenr].SetWorkPt(p, f);
+	ImageSlice(slicenr).SetWorkPt(p, f);
 }
 
-float SlicesHandler::GetBmpPt(Point p, unsigned short slicenr)
+float SlicesHandler::GetBmpPt(Point p, unsigned slicenr)
 {
-	return m_ImageSlices[slicenr].BmpPt(p);
+	return ImageSlice(slicenr).BmpPt(p);
 }
 
-void SlicesHandler::SetBmpPt(Point p, unsigned short slicenr, float f)
+void SlicesHandler::SetBmpPt(Point p, unsigned slicenr, float f)
 {
-	m_ImageSlices[slicenr].SetBmpPt(p, f);
+	ImageSlice(slicenr).SetBmpPt(p, f);
 }
 
-tissues_size_t SlicesHandler::GetTissuePt(Point p, unsigned short slicenr)
+tissues_size_t SlicesHandler::GetTissuePt(Point p, unsigned slicenr)
 {
-	return m_ImageSlices[slicenr].TissuesPt(m_ActiveTissuelayer, p);
+	return ImageSlice(slicenr).TissuesPt(m_ActiveTissuelayer, p);
 }
 
-void SlicesHandler::SetTissuePt(Point p, unsigned short slicenr, tissues_size_t f)
+void SlicesHandler::SetTissuePt(Point p, unsigned slicenr, tissues_size_t f)
 {
-	m_ImageSlices[slicenr].SetTissuePt(m_ActiveTissuelayer, p, f);
+	ImageSlice(slicenr).SetTissuePt(m_ActiveTissuelayer, p, f);
 }
 
 std::vector<const float*> SlicesHandler::SourceSlices() const
 {
 	std::vector<const float*> ptrs(m_Nrslices);
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		ptrs[i] = m_ImageSlices[i].ReturnBmp();
+		ptrs[i] = ImageSlice(i).ReturnBmp();
 	}
 	return ptrs;
 }
@@ -186,9 +218,9 @@ std::vector<const float*> SlicesHandler::SourceSlices() const
 std::vector<float*> SlicesHandler::SourceSlices()
 {
 	std::vector<float*> ptrs(m_Nrslices);
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		ptrs[i] = m_ImageSlices[i].ReturnBmp();
+		ptrs[i] = ImageSlice(i).ReturnBmp();
 	}
 	return ptrs;
 }
@@ -196,9 +228,9 @@ std::vector<float*> SlicesHandler::SourceSlices()
 std::vector<const float*> SlicesHandler::TargetSlices() const
 {
 	std::vector<const float*> ptrs(m_Nrslices);
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		ptrs[i] = m_ImageSlices[i].ReturnWork();
+		ptrs[i] = ImageSlice(i).ReturnWork();
 	}
 	return ptrs;
 }
@@ -206,9 +238,9 @@ std::vector<const float*> SlicesHandler::TargetSlices() const
 std::vector<float*> SlicesHandler::TargetSlices()
 {
 	std::vector<float*> ptrs(m_Nrslices);
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		ptrs[i] = m_ImageSlices[i].ReturnWork();
+		ptrs[i] = ImageSlice(i).ReturnWork();
 	}
 	return ptrs;
 }
@@ -216,9 +248,9 @@ std::vector<float*> SlicesHandler::TargetSlices()
 std::vector<const tissues_size_t*> SlicesHandler::TissueSlices(tissuelayers_size_t layeridx) const
 {
 	std::vector<const tissues_size_t*> ptrs(m_Nrslices);
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		ptrs[i] = m_ImageSlices[i].ReturnTissues(layeridx);
+		ptrs[i] = ImageSlice(i).ReturnTissues(layeridx);
 	}
 	return ptrs;
 }
@@ -226,13 +258,29 @@ std::vector<const tissues_size_t*> SlicesHandler::TissueSlices(tissuelayers_size
 std::vector<tissues_size_t*> SlicesHandler::TissueSlices(tissuelayers_size_t layeridx)
 {
 	std::vector<tissues_size_t*> ptrs(m_Nrslices);
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		ptrs[i] = m_ImageSlices[i].ReturnTissues(layeridx);
+		ptrs[i] = ImageSlice(i).ReturnTissues(layeridx);
 	}
 	return ptrs;
 }
 
+void SlicesHandler::PinTissues()
+{
+	for (unsigned i = 0; i < m_Nrslices; i++)
+	{
+		ImageSlice(i).PinTissues();
+	}
+}
+
+void SlicesHandler::UnpinTissues()
+{
+	for (auto& slice : m_ImageSlices)
+	{
+		slice.UnpinTissues();
+	}
+}
+
 std::vector<std::string> SlicesHandler::TissueNames() const
 {
 	std::vector<std::string> names(TissueInfos::GetTissueCount() + 1);
@@ -254,237 +302,115 @@ std::vector<bool> SlicesHandler::TissueLocks() const
 	return locks;
 }
 
-float* SlicesHandler::ReturnBmp(unsigned short slicenr1)
+float* SlicesHandler::ReturnBmp(unsigned slicenr1)
 {
-	return m_ImageSlices[slicenr1].ReturnBmp();
+	return ImageSlice(slicenr1).ReturnBmp();
 }
 
-float* SlicesHandler::ReturnWork(unsigned short slicenr1)
+float* SlicesHandler::ReturnWork(unsigned slicenr1)
 {
-	return m_ImageSlices[slicenr1].ReturnWork();
+	return ImageSlice(slicenr1).ReturnWork();
 }
 
-tissues_size_t* SlicesHandler::ReturnTissues(tissuelayers_size_t layeridx, unsigned short slicenr1)
+tissues_size_t* SlicesHandler::ReturnTissues(tissuelayers_size_t layeridx, unsigned slicenr1)
 {
-	return m_ImageSlices[slicenr1].ReturnTissues(layeridx);
+	return ImageSlice(slicenr1).ReturnTissues(layeridx);
 }
 
 float* SlicesHandler::ReturnOverlay() { return m_Overlay; }
 
 int SlicesHandler::LoadDIBitmap(const std::vector<std::string>& filenames)
 {
-	UpdateColorLookupTable(nullptr);
-	m_Activeslice = 0;
-	m_ActiveTissuelayer = 0;
-	m_Startslice = 0;
-	m_Endslice = m_Nrslices = (unsigned short)filenames.size();
-	m_Os.SetSizenr(m_Nrslices);
-	m_ImageSlices.resize(m_Nrslices);
-
-	int j = 0;
-	for (unsigned short i = 0; i < m_Nrslices; i++)
-	{
-		j += m_ImageSlices[i].LoadDIBitmap(filenames[i].c_str());
-	}
-
-	m_Width = m_ImageSlices[0].ReturnWidth();
-	m_Height = m_ImageSlices[0].ReturnHeight();
-	m_Area = m_Height * (unsigned int)m_Width;
-
-	NewOverlay();
-
-	for (unsigned short i = 0; i < m_Nrslices; i++)
-	{
-		if (m_Width != m_ImageSlices[i].ReturnWidth() ||
-				m_Height != m_ImageSlices[i].ReturnHeight())
-			j = m_Nrslices + 1;
-	}
-
-	if (j == m_Nrslices)
-	{
-		// Ranges
-		Pair dummy;
-		m_SliceRanges.resize(m_Nrslices);
-		m_SliceBmpranges.resize(m_Nrslices);
-		ComputeRangeMode1(&dummy);
-		ComputeBmprangeMode1(&dummy);
-
-		m_Loaded = true;
-		return 1;
-	}
-	else
-	{
-		Newbmp(m_Width, m_Height, m_Nrslices);
-		return 0;
-	}
+	return LoadImageStack(filenames, [](Bmphandler& slice, const char* filename) {
+		return slice.LoadDIBitmap(filename);
+	});
 }
 
-int SlicesHandler::LoadDIBitmap(const std::vector<std::string>& filenames, Point p, unsigned short dx, unsigned short dy)
+int SlicesHandler::LoadDIBitmap(const std::vector<std::string>& filenames, Point p, unsigned dx, unsigned dy)
 {
-	UpdateColorLookupTable(nullptr);
-
-	m_Activeslice = 0;
-	m_ActiveTissuelayer = 0;
-	m_Nrslices = (unsigned short)filenames.size();
-	m_Os.SetSizenr(m_Nrslices);
-
-	m_ImageSlices.resize(m_Nrslices);
-	int j = 0;
-
-	for (unsigned short i = 0; i < m_Nrslices; i++)
-	{
-		j += m_ImageSlices[i].LoadDIBitmap(filenames[i].c_str(), p, dx, dy);
-	}
-
-	if (j == m_Nrslices)
-	{
-		// Ranges
-		Pair dummy;
-		m_SliceRanges.resize(m_Nrslices);
-		m_SliceBmpranges.resize(m_Nrslices);
-		ComputeRangeMode1(&dummy);
-		ComputeBmprangeMode1(&dummy);
-
-		m_Loaded = true;
-		m_Width = dx;
-		m_Height = dy;
-		m_Area = m_Height * (unsigned int)m_Width;
-
-		NewOverlay();
-		return 1;
-	}
-	else
-	{
-		Newbmp(m_Width, m_Height, m_Nrslices);
-		return 0;
-	}
+	return LoadImageStack(filenames, [p, dx, dy](Bmphandler& slice, const char* filename) {
+		return slice.LoadDIBitmap(filename, p, dx, dy);
+	});
 }
 
 void SlicesHandler::SetRgbFactors(int redFactor, int greenFactor, int blueFactor)
 {
-	for (unsigned short i = 0; i < m_Nrslices; i++)
-	{
-		m_ImageSlices[i].SetConverterFactors(redFactor, greenFactor, blueFactor);
-	}
+	// applied to the slices of the next color image stack
+	m_RgbFactors[0] = redFactor;
+	m_RgbFactors[1] = greenFactor;
+	m_RgbFactors[2] = blueFactor;
 }
 
-// TODO BL this function has a terrible impl, e.g. using member variables rgb, width/height, etc.
 int SlicesHandler::LoadPng(const std::vector<std::string>& filenames)
 {
-	UpdateColorLookupTable(nullptr); // BL: here we could quantize colors instead and build color
-
-	m_Activeslice = 0;
-	m_ActiveTissuelayer = 0;
-	m_Startslice = 0;
-	m_Endslice = m_Nrslices = (unsigned short)filenames.size();
-	m_Os.SetSizenr(m_Nrslices);
-	m_ImageSlices.resize(m_Nrslices);
-
-	int j = 0;
-	for (unsigned short i = 0; i < m_Nrslices; i++)
-	{
-		j += m_ImageSlices[i].LoadPNGBitmap(filenames[i].c_str());
-	}
-
-	m_Width = m_ImageSlices[0].ReturnWidth();
-	m_Height = m_ImageSlices[0].ReturnHeight();
-	m_Area = m_Height * (unsigned int)m_Width;
-
-	NewOverlay();
+	return LoadImageStack(filenames, [](Bmphandler& slice, const char* filename) {
+		return slice.LoadPNGBitmap(filename);
+	});
+}
 
-	for (unsigned short i = 0; i < m_Nrslices; i++)
-	{
-		if (m_Width != m_ImageSlices[i].ReturnWidth() ||
-				m_Height != m_ImageSlices[i].ReturnHeight())
-			j = m_Nrslices + 1;
-	}
+int SlicesHandler::LoadPng(const std::vector<std::string>& filenames, Point p, unsigned dx, unsigned dy)
+{
+	return LoadImageStack(filenames, [p, dx, dy](Bmphandler& slice, const char* filename) {
+		return slice.LoadDIBitmap(filename, p, dx, dy);
+	});
+}
 
-	// Ranges
-	Pair dummy;
-	m_SliceRanges.resize(m_Nrslices);
-	m_SliceBmpranges.resize(m_Nrslices);
-	ComputeRangeMode1(&dummy);
-	ComputeBmprangeMode1(&dummy);
+int SlicesHandler::LoadDIJpg(const std::vector<std::string>& filenames)
+{
+	return LoadImageStack(filenames, [](Bmphandler& slice, const char* filename) {
+		return slice.LoadDIBitmap(filename);
+	});
+}
 
-	if (j == m_Nrslices)
-	{
-		m_Loaded = true;
-		return 1;
-	}
-	else
-	{
-		Newbmp(m_Width, m_Height, m_Nrslices);
-		return 0;
-	}
+int SlicesHandler::LoadDIJpg(const std::vector<std::string>& filenames, Point p, unsigned dx, unsigned dy)
+{
+	return LoadImageStack(filenames, [p, dx, dy](Bmphandler& slice, const char* filename) {
+		return slice.LoadDIBitmap(filename, p, dx, dy);
+	});
 }
 
-int SlicesHandler::LoadPng(const std::vector<std::string>& filenames, Point p, unsigned short dx, unsigned short dy)
+int SlicesHandler::LoadImageStack(const std::vector<std::string>& filenames, const std::function<int(Bmphandler&, const char*)>& load)
 {
-	UpdateColorLookupTable(nullptr);
+	if (filenames.empty())
+		return 0;
+
+	UpdateColorLookupTable(nullptr); // BL: here we could quantize colors instead and build color
 
 	m_Activeslice = 0;
 	m_ActiveTissuelayer = 0;
-	m_Nrslices = (unsigned short)filenames.size();
+	m_Startslice = 0;
+	m_Endslice = m_Nrslices = (unsigned)filenames.size();
 	m_Os.SetSizenr(m_Nrslices);
-
 	m_ImageSlices.resize(m_Nrslices);
-	int j = 0;
-
-	for (unsigned short i = 0; i < m_Nrslices; i++)
-	{
-		j += m_ImageSlices[i].LoadDIBitmap(filenames[i].c_str(), p, dx, dy);
-	}
-
-	m_Width = dx;
-	m_Height = dy;
-	m_Area = m_Height * (unsigned int)m_Width;
-
-	NewOverlay();
-
-	// Ranges
-	Pair dummy;
-	m_SliceRanges.resize(m_Nrslices);
-	m_SliceBmpranges.resize(m_Nrslices);
-	ComputeRangeMode1(&dummy);
-	ComputeBmprangeMode1(&dummy);
 
-	if (j == m_Nrslices)
-	{
-		m_Loaded = true;
-		return 1;
-	}
-	else
+	// paging and unsharing are not thread-safe, so the slices are collected first
+	std::vector<Bmphandler*> slices(m_Nrslices);
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		Newbmp(m_Width, m_Height, m_Nrslices);
-		return 0;
+		slices[i] = &ImageSlice(i);
+		slices[i]->SetConverterFactors(m_RgbFactors[0], m_RgbFactors[1], m_RgbFactors[2]);
 	}
-}
-
-int SlicesHandler::LoadDIJpg(const std::vector<std::string>& filenames)
-{
-	UpdateColorLookupTable(nullptr);
-
-	m_Activeslice = 0;
-	m_ActiveTissuelayer = 0;
-	m_Startslice = 0;
-	m_Endslice = m_Nrslices = (unsigned short)filenames.size();
-	m_Os.SetSizenr(m_Nrslices);
 
-	m_ImageSlices.resize(m_Nrslices);
+	// each thread decodes one file at a time straight into its slice, i.e. at most one
+	// decoded image per thread is in flight. The slice provider is thread-safe.
+	auto const t_start = std::chrono::steady_clock::now();
+	int const n = static_cast<int>(m_Nrslices);
 	int j = 0;
-
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+#pragma omp parallel for schedule(dynamic) reduction(+ : j)
+	for (int i = 0; i < n; i++)
 	{
-		j += m_ImageSlices[i].LoadDIBitmap(filenames[i].c_str());
+		j += load(*slices[i], filenames[i].c_str());
 	}
+	double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+	ISEG_INFO("Loaded " << n << " image files in " << seconds << " s (" << (seconds > 0 ? n / seconds : 0.0) << " files/s)");
 
 	m_Width = m_ImageSlices[0].ReturnWidth();
 	m_Height = m_ImageSlices[0].ReturnHeight();
-	m_Area = m_Height * (unsigned int)m_Width;
+	m_Area = m_Height * (size_t)m_Width;
 
 	NewOverlay();
 
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
 		if (m_Width != m_ImageSlices[i].ReturnWidth() ||
 				m_Height != m_ImageSlices[i].ReturnHeight())
@@ -501,6 +427,7 @@ int SlicesHandler::LoadDIJpg(const std::vector<std::string>& filenames)
 	if (j == m_Nrslices)
 	{
 		m_Loaded = true;
+		UpdateVolumeStorage();
 		return 1;
 	}
 	else
@@ -510,89 +437,41 @@ int SlicesHandler::LoadDIJpg(const std::vector<std::string>& filenames)
 	}
 }
 
-int SlicesHandler::LoadDIJpg(const std::vector<std::string>& filenames, Point p, unsigned short dx, unsigned short dy)
+int SlicesHandler::ReadRaw(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, unsigned nrofslices)
 {
-	UpdateColorLookupTable(nullptr);
-
-	m_Activeslice = 0;
-	m_ActiveTissuelayer = 0;
-	m_Nrslices = (unsigned short)filenames.size();
-	m_Os.SetSizenr(m_Nrslices);
-
-	m_ImageSlices.resize(m_Nrslices);
-	int j = 0;
-
-	for (unsigned short i = 0; i < m_Nrslices; i++)
-	{
-		j += m_ImageSlices[i].LoadDIBitmap(filenames[i].c_str(), p, dx, dy);
-	}
-
-	m_Width = dx;
-	m_Height = dy;
-	m_Area = m_Height * (unsigned int)m_Width;
-
-	NewOverlay();
-
-	// Ranges
-	Pair dummy;
-	m_SliceRanges.resize(m_Nrslices);
-	m_SliceBmpranges.resize(m_Nrslices);
-	ComputeRangeMode1(&dummy);
-	ComputeBmprangeMode1(&dummy);
-
-	if (j == m_Nrslices)
-	{
-		m_Loaded = true;
-		return 1;
-	}
-	else
-	{
-		Newbmp(m_Width, m_Height, m_Nrslices);
-		return 0;
-	}
+	Point p;
+	p.px = p.py = 0;
+	return ReadRawVolume(filename, w, h, bitdepth, slicenr, nrofslices, p, w, h);
 }
 
-int SlicesHandler::ReadRaw(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned short slicenr, unsigned short nrofslices)
+int SlicesHandler::ReadRawVolume(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, unsigned nrofslices, Point p, unsigned dx, unsigned dy)
 {
 	UpdateColorLookupTable(nullptr);
 
-	m_Activeslice = 0;
-	m_ActiveTissuelayer = 0;
-	m_Width = w;
-	m_Height = h;
-	m_Area = m_Height * (unsigned int)m_Width;
-	m_Startslice = 0;
-	m_Endslice = m_Nrslices = nrofslices;
-	m_Os.SetSizenr(m_Nrslices);
+	// the slices are allocated up front and filled straight from the mapped file
+	Newbmp(dx, dy, nrofslices);
 
-	m_ImageSlices.resize(nrofslices);
-	int j = 0;
-	for (unsigned short i = 0; i < nrofslices; i++)
-		j += m_ImageSlices[i].ReadRaw(filename, w, h, bitdepth, slicenr + i);
+	RawVolumeReader reader(filename, w, h, bitdepth);
+	std::vector<float*> slices = SourceSlices();
+	if (!reader.Read(slices.data(), slicenr, nrofslices, p, dx, dy))
+	{
+		ISEG_WARNING_MSG("loading failed in 'ReadRaw'");
+		Newbmp(dx, dy, nrofslices);
+		return 0;
+	}
 
-	NewOverlay();
+	Bmp2workall();
 
 	// Ranges
 	Pair dummy;
-	m_SliceRanges.resize(nrofslices);
-	m_SliceBmpranges.resize(nrofslices);
 	ComputeRangeMode1(&dummy);
 	ComputeBmprangeMode1(&dummy);
 
-	if (j == nrofslices)
-	{
-		m_Loaded = true;
-		return 1;
-	}
-	else
-	{
-		ISEG_WARNING_MSG("loading failed in 'ReadRaw'");
-		Newbmp(m_Width, m_Height, nrofslices);
-		return 0;
-	}
+	UpdateVolumeStorage();
+	return 1;
 }
 
-int SlicesHandler::ReadRawOverlay(const char* filename, unsigned bitdepth, unsigned short slicenr)
+int SlicesHandler::ReadRawOverlay(const char* filename, unsigned bitdepth, unsigned slicenr)
 {
 	FILE* fp;							/* Open file pointer */
 	int bitsize = m_Area; /* Size of bitmap */
@@ -705,7 +584,7 @@ int SlicesHandler::ReadRawOverlay(const char* filename, unsigned bitdepth, unsig
 	return 1;
 }
 
-int SlicesHandler::ReadImage(const char* filename)
+int SlicesHandler::ReadImage(const char* filename, const VolumeRegion& region)
 {
 	UpdateColorLookupTable(nullptr);
 
@@ -714,18 +593,35 @@ int SlicesHandler::ReadImage(const char* filename)
 	Transform transform1;
 	if (ImageReader::GetInfo(filename, w, h, nrofslices, spacing1, transform1))
 	{
-		Newbmp(w, h, nrofslices);
+		unsigned const dims[3] = {w, h, nrofslices};
+		VolumeRegion clipped = region;
+		if (!clipped.Clip(dims))
+		{
+			ISEG_ERROR_MSG("ReadImage() : region lies outside of the image");
+			return 0;
+		}
+
+		Newbmp(clipped.Dim(0), clipped.Dim(1), clipped.Dim(2));
 		std::vector<float*> slices(m_Nrslices);
 		for (unsigned i = 0; i < m_Nrslices; i++)
 		{
-			slices[i] = m_ImageSlices[i].ReturnBmp();
+			slices[i] = ImageSlice(i).ReturnBmp();
+		}
+		if (clipped.IsWhole(dims))
+		{
+			ImageReader::GetVolume(filename, slices.data(), m_Nrslices, m_Width, m_Height);
+		}
+		else
+		{
+			ImageReader::GetVolume(filename, slices.data(), clipped);
+			clipped.Apply(spacing1, transform1);
 		}
-		ImageReader::GetVolume(filename, slices.data(), m_Nrslices, m_Width, m_Height);
 		m_Thickness = spacing1[2];
 		m_Dx = spacing1[0];
 		m_Dy = spacing1[1];
 		m_Transform = transform1;
 		m_Loaded = true;
+		UpdateVolumeStorage();
 
 		Bmp2workall();
 		return 1;
@@ -759,7 +655,7 @@ bool SlicesHandler::ReadVolume(const std::string& file_path, bool tissue)
 		std::vector<float*> slices(m_Nrslices);
 		for (unsigned i = 0; i < m_Nrslices; i++)
 		{
-			slices[i] = tissue ? m_ImageSlices[i].ReturnWork() : m_ImageSlices[i].ReturnBmp();
+			slices[i] = tissue ? ImageSlice(i).ReturnWork() : ImageSlice(i).ReturnBmp();
 		}
 
 		if (!ImageReader::GetVolume(file_path, slices.data(), m_Nrslices, m_Width, m_Height))
@@ -778,6 +674,7 @@ bool SlicesHandler::ReadVolume(const std::string& file_path, bool tissue)
 			ClearWork();
 		}
 		m_Loaded = true;
+		UpdateVolumeStorage();
 		return true;
 	}
 	return false;
@@ -810,7 +707,7 @@ bool SlicesHandler::ReadVolumeOrient(const std::string& file_path, bool tissue,
 		std::vector<float*> slices(m_Nrslices);
 		for (unsigned i = 0; i < m_Nrslices; i++)
 		{
-			slices[i] = tissue ? m_ImageSlices[i].ReturnWork() : m_ImageSlices[i].ReturnBmp();
+			slices[i] = tissue ? ImageSlice(i).ReturnWork() : ImageSlice(i).ReturnBmp();
 		}
 
 		if (!ImageReader::CopySlices(buffer, slices.data(), 0, m_Nrslices, m_Width, m_Height))
@@ -829,12 +726,13 @@ bool SlicesHandler::ReadVolumeOrient(const std::string& file_path, bool tissue,
 			ClearWork();
 		}
 		m_Loaded = true;
+		UpdateVolumeStorage();
 		return true;
 	}
 	return false;
 }
 
-int SlicesHandler::ReadOverlay(const char* filename, unsigned short slicenr)
+int SlicesHandler::ReadOverlay(const char* filename, unsigned slicenr)
 {
 	unsigned w, h, nrofslices;
 	float spacing1[3];
@@ -867,7 +765,7 @@ int SlicesHandler::ReadRTdose(const char* filename)
 	this->m_Activeslice = 0;
 	this->m_Width = dims[0];
 	this->m_Height = dims[1];
-	this->m_Area = m_Height * (unsigned int)m_Width;
+	this->m_Area = m_Height * (size_t)m_Width;
 	this->m_Nrslices = dims[2];
 	this->m_Startslice = 0;
 	this->m_Endslice = m_Nrslices;
@@ -881,9 +779,9 @@ int SlicesHandler::ReadRTdose(const char* filename)
 	this->m_Os.SetSizenr(m_Nrslices);
 	this->SetSlicethickness(m_Thickness);
 	this->m_Loaded = true;
-	for (unsigned short j = 0; j < m_Nrslices; j++)
+	for (unsigned j = 0; j < m_Nrslices; j++)
 	{
-		this->m_ImageSlices[j].Newbmp(m_Width, m_Height);
+		this->ImageSlice(j).Newbmp(m_Width, m_Height);
 	}
 
 	NewOverlay();
@@ -892,7 +790,7 @@ int SlicesHandler::ReadRTdose(const char* filename)
 	std::vector<float*> bmpslices(m_Nrslices);
 	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		bmpslices[i] = this->m_ImageSlices[i].ReturnBmp();
+		bmpslices[i] = this->ImageSlice(i).ReturnBmp();
 	}
 
 	// Read pixel data
@@ -900,6 +798,7 @@ int SlicesHandler::ReadRTdose(const char* filename)
 	if (res)
 	{
 		m_Loaded = true;
+		UpdateVolumeStorage();
 		Bmp2workall();
 	}
 	else
@@ -963,8 +862,10 @@ bool SlicesHandler::LoadSurface(const std::string& filename_in, bool overwrite_w
 	return (ret != VoxelSurface::kNone);
 }
 
-int SlicesHandler::LoadAllHDF(const char* filename)
+int SlicesHandler::LoadAllHDF(const char* filename, const VolumeRegion& region)
 {
+	WaitForBackgroundSave();
+
 	unsigned w, h, nrofslices;
 	float* pixsize;
 	float* tr_1d;
@@ -981,11 +882,20 @@ int SlicesHandler::LoadAllHDF(const char* filename)
 	pixsize = reader.GetPixelSize();
 	tr_1d = reader.GetImageTransform();
 
-	if ((w != m_Width) || (h != m_Height) || (m_Nrslices != nrofslices))
+	// the slices hold only the region
+	unsigned const dims[3] = {w, h, nrofslices};
+	VolumeRegion clipped = region;
+	if (!clipped.Clip(dims))
+	{
+		ISEG_ERROR_MSG("LoadAllHDF() : region lies outside of the volume");
+		return 0;
+	}
+	if ((clipped.Dim(0) != m_Width) || (clipped.Dim(1) != m_Height) || (m_Nrslices != clipped.Dim(2)))
 	{
 		ISEG_ERROR_MSG("LoadAllHDF() : inconsistent dimensions");
 		return 0;
 	}
+	reader.SetRegion(clipped);
 
 	for (int r = 0; r < 3; r++)
 	{
@@ -995,21 +905,32 @@ int SlicesHandler::LoadAllHDF(const char* filename)
 	// read colors if any
 	UpdateColorLookupTable(reader.ReadColorLookup());
 
-	std::vector<float*> bmpslices(m_Nrslices);
+	if (m_PageFile && clipped.IsWhole(dims))
+	{
+		auto const names = reader.GetMapArrayNames();
+		if (SetPagingOrigin(filename, names["Source"].toStdString(), names["Target"].toStdString(), names["Tissue"].toStdString()))
+		{
+			return 1;
+		}
+	}
+
+	std::vector<float*> bmpslices(m_Nrslices);
 	std::vector<float*> workslices(m_Nrslices);
 	std::vector<tissues_size_t*> tissueslices(m_Nrslices);
 	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		bmpslices[i] = this->m_ImageSlices[i].ReturnBmp();
-		workslices[i] = this->m_ImageSlices[i].ReturnWork();
-		tissueslices[i] = this->m_ImageSlices[i].ReturnTissues(0); // TODO
+		bmpslices[i] = this->ImageSlice(i).ReturnBmp();
+		workslices[i] = this->ImageSlice(i).ReturnWork();
+		tissueslices[i] = this->ImageSlice(i).ReturnTissues(0); // TODO
 	}
 
 	reader.SetImageSlices(bmpslices.data());
 	reader.SetWorkSlices(workslices.data());
 	reader.SetTissueSlices(tissueslices.data());
 
-	return reader.Read();
+	int code = reader.Read();
+	ReleaseZeroTargets();
+	return code;
 }
 
 void SlicesHandler::UpdateColorLookupTable(std::shared_ptr<ColorLookupTable> new_lut /*= nullptr*/)
@@ -1021,6 +942,8 @@ void SlicesHandler::UpdateColorLookupTable(std::shared_ptr<ColorLookupTable> new
 
 int SlicesHandler::LoadAllXdmf(const char* filename)
 {
+	WaitForBackgroundSave();
+
 	unsigned w, h, nrofslices;
 	QStringList array_names;
 
@@ -1040,15 +963,27 @@ int SlicesHandler::LoadAllXdmf(const char* filename)
 	float origin[3];
 	transform.GetOffset(origin);
 
+	if (m_PageFile)
+	{
+		auto const& names = reader.GetMapArrayNames();
+		QFileInfo file_info(filename);
+		std::string const h5file = file_info.dir().absoluteFilePath(file_info.completeBaseName() + ".h5").toStdString();
+		if (SetPagingOrigin(h5file, names["Source"].toStdString(), names["Target"].toStdString(), names["Tissue"].toStdString()))
+		{
+			UpdateColorLookupTable(reader.ReadColorLookup());
+			return 1;
+		}
+	}
+
 	std::vector<float*> bmpslices(m_Nrslices);
 	std::vector<float*> workslices(m_Nrslices);
 	std::vector<tissues_size_t*> tissueslices(m_Nrslices);
 
 	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		bmpslices[i] = this->m_ImageSlices[i].ReturnBmp();
-		workslices[i] = this->m_ImageSlices[i].ReturnWork();
-		tissueslices[i] = this->m_ImageSlices[i].ReturnTissues(0); // TODO
+		bmpslices[i] = this->ImageSlice(i).ReturnBmp();
+		workslices[i] = this->ImageSlice(i).ReturnWork();
+		tissueslices[i] = this->ImageSlice(i).ReturnTissues(0); // TODO
 	}
 
 	UpdateColorLookupTable(reader.ReadColorLookup());
@@ -1057,6 +992,20 @@ int SlicesHandler::LoadAllXdmf(const char* filename)
 	reader.SetWorkSlices(workslices.data());
 	reader.SetTissueSlices(tissueslices.data());
 	int code = reader.Read();
+	ReleaseZeroTargets();
+
+	// saving the project again only writes the slices modified after loading
+	m_SavedProject = SavedProject();
+	if (code)
+	{
+		for (unsigned i = 0; i < m_Nrslices; i++)
+		{
+			workslices[i] = WorkForReading(i);
+		}
+		QFileInfo file_info(filename);
+		std::string const h5file = file_info.dir().absoluteFilePath(file_info.completeBaseName() + ".h5").toStdString();
+		RecordSavedProject(FingerprintSlices(bmpslices, workslices, tissueslices, m_Width, m_Height), h5file, m_Hdf5Compression, m_SaveTarget);
+	}
 
 	return code;
 }
@@ -1065,22 +1014,21 @@ int SlicesHandler::SaveAllXdmf(const char* filename, int compression, bool save_
 {
 	float pixsize[3] = {m_Dx, m_Dy, m_Thickness};
 
+	WaitForBackgroundSave();
+	ReleasePagingOrigin();
+
 	std::vector<float*> bmpslices(m_Endslice - m_Startslice);
 	std::vector<float*> workslices(m_Endslice - m_Startslice);
 	std::vector<tissues_size_t*> tissueslices(m_Endslice - m_Startslice);
 	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		bmpslices[i - m_Startslice] = m_ImageSlices[i].ReturnBmp();
-		workslices[i - m_Startslice] = m_ImageSlices[i].ReturnWork();
-		tissueslices[i - m_Startslice] = m_ImageSlices[i].ReturnTissues(0); // TODO
+		bmpslices[i - m_Startslice] = ImageSlice(i).ReturnBmp();
+		workslices[i - m_Startslice] = WorkForReading(i);
+		tissueslices[i - m_Startslice] = ImageSlice(i).ReturnTissues(m_ActiveTissuelayer);
 	}
 
 	XdmfImageWriter writer;
-	writer.SetCopyToContiguousMemory(GetContiguousMemory());
 	writer.SetFileName(filename);
-	writer.SetImageSlices(bmpslices.data());
-	writer.SetWorkSlices(save_work ? workslices.data() : nullptr);
-	writer.SetTissueSlices(tissueslices.data());
 	writer.SetNumberOfSlices(m_Endslice - m_Startslice);
 	writer.SetWidth(m_Width);
 	writer.SetHeight(m_Height);
@@ -1090,14 +1038,244 @@ int SlicesHandler::SaveAllXdmf(const char* filename, int compression, bool save_
 
 	writer.SetImageTransform(active_slices_transform);
 	writer.SetCompression(compression);
-	bool ok = writer.Write(naked);
+
+	// if the project file holds the last saved volume, it is copied and only the modified slices are compressed and written
+	bool const whole_volume = !naked && m_Startslice == 0 && m_Endslice == m_Nrslices;
+	QFileInfo file_info(filename);
+	std::string const h5file = file_info.dir().absoluteFilePath(file_info.completeBaseName() + ".h5").toStdString();
+	SavedProject saved;
+	bool ok = false;
+	if (whole_volume)
+	{
+		ScopedTimer timer("Fingerprint slices");
+		saved = FingerprintSlices(bmpslices, workslices, tissueslices, m_Width, m_Height);
+	}
+	std::string from;
+	std::vector<bool> preview_modified;
+	if (whole_volume && PrepareIncrementalSave(h5file, compression, save_work, from) && XdmfImageWriter::PrepareFile(filename, true, m_Nrslices, m_Width, m_Height, from) &&
+			XdmfImageWriter::CopyVolume(filename, from))
+	{
+		std::vector<float*> bmp_modified = bmpslices;
+		std::vector<float*> work_modified = workslices;
+		std::vector<tissues_size_t*> tissue_modified = tissueslices;
+		std::vector<float> zeros;
+		size_t const modified = KeepModifiedSlices(saved, m_SavedProject, save_work, bmp_modified, work_modified, tissue_modified, zeros);
+
+		writer.SetImageSlices(bmp_modified.data());
+		writer.SetWorkSlices(save_work ? work_modified.data() : nullptr);
+		writer.SetTissueSlices(tissue_modified.data());
+		writer.SetAppend(true);
+		ok = writer.Write(naked);
+		writer.SetAppend(false);
+		if (ok)
+		{
+			ISEG_INFO("Updated " << modified << " modified slice arrays in " << h5file);
+			saved.m_Rewritten = m_SavedProject.m_Rewritten + modified;
+			preview_modified.resize(bmp_modified.size());
+			for (size_t i = 0; i < bmp_modified.size(); i++)
+			{
+				preview_modified[i] = bmp_modified[i] != nullptr || tissue_modified[i] != nullptr;
+			}
+		}
+	}
+	if (!ok)
+	{
+		writer.SetImageSlices(bmpslices.data());
+		writer.SetWorkSlices(save_work ? workslices.data() : nullptr);
+		writer.SetTissueSlices(tissueslices.data());
+		ok = writer.Write(naked);
+	}
+	if (ok && !naked)
+	{
+		size_t rewritten = 0;
+		ok = writer.WritePreview(bmpslices.data(), tissueslices.data(), preview_modified, &rewritten);
+		saved.m_Rewritten += rewritten;
+	}
 	ok &= writer.WriteColorLookup(m_ColorLookupTable.get(), naked);
 	ok &= TissueInfos::SaveTissuesHDF(filename, m_TissueHierachy->SelectedHierarchy(), naked, 0);
 	ok &= SaveMarkersHDF(filename, naked, 0);
+	if (whole_volume && ok)
+	{
+		RecordSavedProject(std::move(saved), h5file, compression, save_work);
+	}
+	else
+	{
+		// e.g. the active slices were saved into the project file
+		m_SavedProject = SavedProject();
+	}
+	TrimSliceCache();
 	return ok;
 }
 
-bool SlicesHandler::SaveMarkersHDF(const char* filename, bool naked, unsigned short version)
+bool SlicesHandler::CanSaveInBackground() const
+{
+	// with paging the slices would have to be paged in while the worker writes them
+	return m_Loaded && !m_PageFile && !m_ImageSlices.empty();
+}
+
+bool SlicesHandler::StartBackgroundSave(const char* filename, int compression, bool save_work, ProgressInfo* progress, std::function<void(bool)> done)
+{
+	if (!CanSaveInBackground())
+		return false;
+
+	// one save at a time
+	FinishBackgroundSave();
+
+	QFileInfo file_info(filename);
+	auto job = std::make_unique<BackgroundSave>();
+	job->m_File = file_info.absoluteFilePath().toStdString();
+	job->m_H5File = file_info.dir().absoluteFilePath(file_info.completeBaseName() + ".h5").toStdString();
+	job->m_Width = m_Width;
+	job->m_Height = m_Height;
+	job->m_PixelSize[0] = m_Dx;
+	job->m_PixelSize[1] = m_Dy;
+	job->m_PixelSize[2] = m_Thickness;
+	job->m_Transform = m_Transform;
+	job->m_Compression = compression;
+	job->m_SaveWork = save_work;
+
+	// the snapshot shares the buffers with the slices, which copy a buffer before modifying it (see ImageSlice)
+	unsigned const n = static_cast<unsigned>(m_ImageSlices.size());
+	job->m_Source.resize(n);
+	job->m_Target.resize(n, nullptr);
+	job->m_Tissue.resize(n);
+	for (unsigned i = 0; i < n; i++)
+	{
+		job->m_Source[i] = m_ImageSlices[i].ShareBmp();
+		if (save_work)
+			job->m_Target[i] = m_ImageSlices[i].ShareWork();
+		job->m_Tissue[i] = m_ImageSlices[i].ShareTissues(m_ActiveTissuelayer);
+	}
+	// the widgets modify the active slice through a pointer they keep, i.e. without ImageSlice
+	if (m_Activeslice < n)
+		m_ImageSlices[m_Activeslice].Unshare();
+	m_BackgroundSave = std::move(job);
+	auto job_ptr = m_BackgroundSave.get();
+
+	// the small objects are written right away, i.e. they match the snapshot. The volume of the last save is copied by the worker.
+	job_ptr->m_Update = PrepareIncrementalSave(job_ptr->m_H5File, compression, save_work, job_ptr->m_CopyFrom) &&
+											XdmfImageWriter::PrepareFile(filename, true, n, m_Width, m_Height, job_ptr->m_CopyFrom);
+	bool ok = job_ptr->m_Update || XdmfImageWriter::PrepareFile(filename, false, n, m_Width, m_Height);
+	if (ok)
+	{
+		if (job_ptr->m_Update)
+			job_ptr->m_Previous = m_SavedProject;
+
+		unsigned const startslice = m_Startslice;
+		unsigned const endslice = m_Endslice;
+		m_Startslice = 0;
+		m_Endslice = n;
+		XdmfImageWriter lut_writer(filename);
+		lut_writer.SetCompression(compression);
+		ok &= lut_writer.WriteColorLookup(m_ColorLookupTable.get(), false);
+		ok &= TissueInfos::SaveTissuesHDF(filename, m_TissueHierachy->SelectedHierarchy(), false, 0);
+		ok &= SaveMarkersHDF(filename, false, 0);
+		m_Startslice = startslice;
+		m_Endslice = endslice;
+	}
+	if (!ok)
+	{
+		FinishBackgroundSave();
+		return false;
+	}
+
+	job_ptr->m_Thread = std::thread([job_ptr, progress, done]() {
+		auto& job = *job_ptr;
+		{
+			ScopedTimer timer("Fingerprint slices");
+			job.m_Saved = FingerprintSlices(job.m_Source, job.m_Target, job.m_Tissue, job.m_Width, job.m_Height);
+		}
+
+		std::vector<float*> bmpslices = job.m_Source;
+		std::vector<float*> workslices = job.m_Target;
+		std::vector<tissues_size_t*> tissueslices = job.m_Tissue;
+		std::vector<float> zeros;
+		std::vector<bool> preview_modified;
+		size_t modified = 0;
+		if (job.m_Update && !XdmfImageWriter::CopyVolume(job.m_File.c_str(), job.m_CopyFrom))
+		{
+			job.m_Update = false;
+		}
+		if (job.m_Update)
+		{
+			modified = KeepModifiedSlices(job.m_Saved, job.m_Previous, job.m_SaveWork, bmpslices, workslices, tissueslices, zeros);
+			job.m_Saved.m_Rewritten = job.m_Previous.m_Rewritten + modified;
+			preview_modified.resize(bmpslices.size());
+			for (size_t i = 0; i < bmpslices.size(); i++)
+			{
+				preview_modified[i] = bmpslices[i] != nullptr || tissueslices[i] != nullptr;
+			}
+		}
+
+		XdmfImageWriter writer;
+		writer.SetFileName(job.m_File.c_str());
+		writer.SetNumberOfSlices(static_cast<unsigned>(bmpslices.size()));
+		writer.SetWidth(job.m_Width);
+		writer.SetHeight(job.m_Height);
+		writer.SetPixelSize(job.m_PixelSize);
+		writer.SetImageTransform(job.m_Transform);
+		writer.SetCompression(job.m_Compression);
+		writer.SetImageSlices(bmpslices.data());
+		writer.SetWorkSlices(job.m_SaveWork ? workslices.data() : nullptr);
+		writer.SetTissueSlices(tissueslices.data());
+		writer.SetAppend(true);
+		writer.SetProgress(progress);
+		size_t rewritten = 0;
+		job.m_Success = writer.Write(false) && writer.WritePreview(job.m_Source.data(), job.m_Tissue.data(), preview_modified, &rewritten);
+		job.m_Saved.m_Rewritten += rewritten;
+		if (job.m_Success && job.m_Update)
+		{
+			ISEG_INFO("Updated " << modified << " modified slice arrays in " << job.m_H5File);
+		}
+
+		if (done)
+			done(job.m_Success);
+	});
+	return true;
+}
+
+bool SlicesHandler::FinishBackgroundSave()
+{
+	if (!m_BackgroundSave)
+		return m_BackgroundSaveSuccess;
+
+	WaitForBackgroundSave();
+	std::unique_ptr<BackgroundSave> job = std::move(m_BackgroundSave);
+
+	// buffers which are still shared stay with the slices, the others are owned by the snapshot
+	for (size_t i = 0; i < job->m_Source.size(); i++)
+	{
+		Bmphandler* slice = i < m_ImageSlices.size() ? &m_ImageSlices[i] : nullptr;
+		if (slice == nullptr || !slice->EndShare(job->m_Source[i]))
+			free(job->m_Source[i]);
+		if (slice == nullptr || !slice->EndShare(job->m_Target[i]))
+			free(job->m_Target[i]);
+		if (slice == nullptr || !slice->EndShare(job->m_Tissue[i]))
+			free(job->m_Tissue[i]);
+	}
+
+	m_BackgroundSaveSuccess = job->m_Success;
+	if (job->m_Success)
+	{
+		// the fingerprints describe the file, not the slices, i.e. they are valid even if the volume changed meanwhile
+		RecordSavedProject(std::move(job->m_Saved), job->m_H5File, job->m_Compression, job->m_SaveWork);
+	}
+	else
+	{
+		m_SavedProject = SavedProject();
+	}
+	return m_BackgroundSaveSuccess;
+}
+
+void SlicesHandler::WaitForBackgroundSave()
+{
+	if (m_BackgroundSave && m_BackgroundSave->m_Thread.joinable())
+	{
+		m_BackgroundSave->m_Thread.join();
+	}
+}
+
+bool SlicesHandler::SaveMarkersHDF(const char* filename, bool naked, unsigned version)
 {
 	int compression = 1;
 
@@ -1186,10 +1364,13 @@ bool SlicesHandler::SaveMarkersHDF(const char* filename, bool naked, unsigned sh
 	return true;
 }
 
-int SlicesHandler::SaveMergeAllXdmf(const char* filename, std::vector<QString>& mergeImagefilenames, unsigned short nrslicesTotal, int compression)
+int SlicesHandler::SaveMergeAllXdmf(const char* filename, std::vector<QString>& mergeImagefilenames, unsigned nrslicesTotal, int compression)
 {
 	float pixsize[3];
 
+	WaitForBackgroundSave();
+	ReleasePagingOrigin();
+
 	auto active_slices_transform = GetTransformActiveSlices();
 
 	pixsize[0] = m_Dx;
@@ -1201,9 +1382,9 @@ int SlicesHandler::SaveMergeAllXdmf(const char* filename, std::vector<QString>&
 	std::vector<tissues_size_t*> tissueslices(m_Endslice - m_Startslice);
 	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		bmpslices[i - m_Startslice] = m_ImageSlices[i].ReturnBmp();
-		workslices[i - m_Startslice] = m_ImageSlices[i].ReturnWork();
-		tissueslices[i - m_Startslice] = m_ImageSlices[i].ReturnTissues(0);
+		bmpslices[i - m_Startslice] = ImageSlice(i).ReturnBmp();
+		workslices[i - m_Startslice] = WorkForReading(i);
+		tissueslices[i - m_Startslice] = ImageSlice(i).ReturnTissues(0);
 	}
 
 	XdmfImageMerger merger;
@@ -1238,7 +1419,7 @@ int SlicesHandler::ReadAvw(const char* filename)
 {
 	UpdateColorLookupTable(nullptr);
 
-	unsigned short w, h, nrofslices;
+	unsigned w, h, nrofslices;
 	avw::eDataType type;
 	float dx1, dy1, thickness1;
 	avw::ReadHeader(filename, w, h, nrofslices, dx1, dy1, thickness1, type);
@@ -1249,15 +1430,15 @@ int SlicesHandler::ReadAvw(const char* filename)
 	m_ActiveTissuelayer = 0;
 	m_Width = w;
 	m_Height = h;
-	m_Area = m_Height * (unsigned int)m_Width;
+	m_Area = m_Height * (size_t)m_Width;
 	m_Startslice = 0;
 	m_Endslice = m_Nrslices = nrofslices;
 	m_Os.SetSizenr(m_Nrslices);
 
 	m_ImageSlices.resize(nrofslices);
 	int j = 0;
-	for (unsigned short i = 0; i < nrofslices; i++)
-		j += m_ImageSlices[i].ReadAvw(filename, i);
+	for (unsigned i = 0; i < nrofslices; i++)
+		j += ImageSlice(i).ReadAvw(filename, i);
 
 	NewOverlay();
 
@@ -1271,6 +1452,7 @@ int SlicesHandler::ReadAvw(const char* filename)
 	if (j == nrofslices)
 	{
 		m_Loaded = true;
+		UpdateVolumeStorage();
 		return 1;
 	}
 	else
@@ -1280,124 +1462,21 @@ int SlicesHandler::ReadAvw(const char* filename)
 	}
 }
 
-int SlicesHandler::ReadRaw(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned short slicenr, unsigned short nrofslices, Point p, unsigned short dx, unsigned short dy)
+int SlicesHandler::ReadRaw(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, unsigned nrofslices, Point p, unsigned dx, unsigned dy)
 {
-	UpdateColorLookupTable(nullptr);
-
-	m_Activeslice = 0;
-	m_ActiveTissuelayer = 0;
-	m_Width = dx;
-	m_Height = dy;
-	m_Area = m_Height * (unsigned int)m_Width;
-	m_Startslice = 0;
-	m_Endslice = m_Nrslices = nrofslices;
-	m_Os.SetSizenr(m_Nrslices);
-
-	m_ImageSlices.resize(nrofslices);
-	int j = 0;
-	for (unsigned short i = 0; i < nrofslices; i++)
-		j += m_ImageSlices[i]
-						 .ReadRaw(filename, w, h, bitdepth, slicenr + i, p, dx, dy);
-
-	NewOverlay();
-
-	// Ranges
-	Pair dummy;
-	m_SliceRanges.resize(nrofslices);
-	m_SliceBmpranges.resize(nrofslices);
-	ComputeRangeMode1(&dummy);
-	ComputeBmprangeMode1(&dummy);
-
-	if (j == nrofslices)
-	{
-		m_Loaded = true;
-		return 1;
-	}
-	else
-	{
-		Newbmp(m_Width, m_Height, nrofslices);
-		return 0;
-	}
+	return ReadRawVolume(filename, w, h, bitdepth, slicenr, nrofslices, p, dx, dy);
 }
 
-int SlicesHandler::ReadRawFloat(const char* filename, short unsigned w, short unsigned h, unsigned short slicenr, unsigned short nrofslices)
+int SlicesHandler::ReadRawFloat(const char* filename, unsigned w, unsigned h, unsigned slicenr, unsigned nrofslices)
 {
-	UpdateColorLookupTable(nullptr);
-
-	m_Activeslice = 0;
-	m_ActiveTissuelayer = 0;
-	m_Width = w;
-	m_Height = h;
-	m_Area = m_Height * (unsigned int)m_Width;
-	m_Startslice = 0;
-	m_Endslice = m_Nrslices = nrofslices;
-	m_Os.SetSizenr(m_Nrslices);
-
-	m_ImageSlices.resize(nrofslices);
-	int j = 0;
-	for (unsigned short i = 0; i < nrofslices; i++)
-		j += m_ImageSlices[i].ReadRawFloat(filename, w, h, slicenr + i);
-
-	NewOverlay();
-
-	// Ranges
-	Pair dummy;
-	m_SliceRanges.resize(nrofslices);
-	m_SliceBmpranges.resize(nrofslices);
-	ComputeRangeMode1(&dummy);
-	ComputeBmprangeMode1(&dummy);
-
-	if (j == nrofslices)
-	{
-		m_Loaded = true;
-		return 1;
-	}
-	else
-	{
-		Newbmp(m_Width, m_Height, nrofslices);
-		return 0;
-	}
+	Point p;
+	p.px = p.py = 0;
+	return ReadRawVolume(filename, w, h, 32, slicenr, nrofslices, p, w, h);
 }
 
-int SlicesHandler::ReadRawFloat(const char* filename, short unsigned w, short unsigned h, unsigned short slicenr, unsigned short nrofslices, Point p, unsigned short dx, unsigned short dy)
+int SlicesHandler::ReadRawFloat(const char* filename, unsigned w, unsigned h, unsigned slicenr, unsigned nrofslices, Point p, unsigned dx, unsigned dy)
 {
-	UpdateColorLookupTable(nullptr);
-
-	m_Activeslice = 0;
-	m_ActiveTissuelayer = 0;
-	m_Width = dx;
-	m_Height = dy;
-	m_Area = m_Height * (unsigned int)m_Width;
-	m_Startslice = 0;
-	m_Endslice = m_Nrslices = nrofslices;
-	m_Os.SetSizenr(m_Nrslices);
-
-	m_ImageSlices.resize(nrofslices);
-	int j = 0;
-	for (unsigned short i = 0; i < nrofslices; i++)
-	{
-		j += m_ImageSlices[i].ReadRawFloat(filename, w, h, slicenr + i, p, dx, dy);
-	}
-
-	NewOverlay();
-
-	// Ranges
-	Pair dummy;
-	m_SliceRanges.resize(nrofslices);
-	m_SliceBmpranges.resize(nrofslices);
-	ComputeRangeMode1(&dummy);
-	ComputeBmprangeMode1(&dummy);
-
-	if (j == nrofslices)
-	{
-		m_Loaded = true;
-		return 1;
-	}
-	else
-	{
-		Newbmp(m_Width, m_Height, nrofslices);
-		return 0;
-	}
+	return ReadRawVolume(filename, w, h, 32, slicenr, nrofslices, p, dx, dy);
 }
 
 int SlicesHandler::ReloadDIBitmap(const std::vector<std::string>& filenames)
@@ -1408,12 +1487,12 @@ int SlicesHandler::ReloadDIBitmap(const std::vector<std::string>& filenames)
 
 	if (filenames.size() == m_Nrslices)
 	{
-		for (unsigned short i = 0; i < m_Nrslices; i++)
+		for (unsigned i = 0; i < m_Nrslices; i++)
 		{
-			j += m_ImageSlices[i].ReloadDIBitmap(filenames[i].c_str());
+			j += ImageSlice(i).ReloadDIBitmap(filenames[i].c_str());
 		}
 
-		for (unsigned short i = 0; i < m_Nrslices; i++)
+		for (unsigned i = 0; i < m_Nrslices; i++)
 		{
 			if (m_Width != m_ImageSlices[i].ReturnWidth() ||
 					m_Height != m_ImageSlices[i].ReturnHeight())
@@ -1430,12 +1509,12 @@ int SlicesHandler::ReloadDIBitmap(const std::vector<std::string>& filenames)
 	}
 	else if (filenames.size() == (m_Endslice - m_Startslice))
 	{
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
-			j += m_ImageSlices[i].ReloadDIBitmap(filenames[i - m_Startslice].c_str());
+			j += ImageSlice(i).ReloadDIBitmap(filenames[i - m_Startslice].c_str());
 		}
 
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
 			if (m_Width != m_ImageSlices[i].ReturnWidth() ||
 					m_Height != m_ImageSlices[i].ReturnHeight())
@@ -1462,9 +1541,9 @@ int SlicesHandler::ReloadDIBitmap(const std::vector<std::string>& filenames, Poi
 
 	if (filenames.size() == m_Nrslices)
 	{
-		for (unsigned short i = 0; i < m_Nrslices; i++)
+		for (unsigned i = 0; i < m_Nrslices; i++)
 		{
-			j += m_ImageSlices[i].ReloadDIBitmap(filenames[i].c_str(), p);
+			j += ImageSlice(i).ReloadDIBitmap(filenames[i].c_str(), p);
 		}
 
 		if (j == m_Nrslices)
@@ -1477,9 +1556,9 @@ int SlicesHandler::ReloadDIBitmap(const std::vector<std::string>& filenames, Poi
 	}
 	else if (filenames.size() == (m_Endslice - m_Startslice))
 	{
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
-			j += m_ImageSlices[i].ReloadDIBitmap(filenames[i - m_Startslice].c_str(), p);
+			j += ImageSlice(i).ReloadDIBitmap(filenames[i - m_Startslice].c_str(), p);
 		}
 
 		if (j == (m_Endslice - m_Startslice))
@@ -1494,22 +1573,35 @@ int SlicesHandler::ReloadDIBitmap(const std::vector<std::string>& filenames, Poi
 		return 0;
 }
 
-int SlicesHandler::ReloadRaw(const char* filename, unsigned bitdepth, unsigned short slicenr)
+int SlicesHandler::ReloadRaw(const char* filename, unsigned bitdepth, unsigned slicenr)
+{
+	Point p;
+	p.px = p.py = 0;
+	return ReloadRawVolume(filename, m_Width, m_Height, bitdepth, slicenr, p);
+}
+
+int SlicesHandler::ReloadRawVolume(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, Point p)
 {
 	UpdateColorLookupTable(nullptr);
 
-	int j = 0;
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		j += m_ImageSlices[i]
-						 .ReloadRaw(filename, bitdepth, (unsigned)slicenr + i - m_Startslice);
+	std::vector<float*> slices;
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+	{
+		slices.push_back(ImageSlice(i).ReturnBmp());
+	}
 
-	if (j == (m_Endslice - m_Startslice))
-		return 1;
-	else
+	RawVolumeReader reader(filename, w, h, bitdepth);
+	if (!reader.Read(slices.data(), slicenr, static_cast<unsigned>(slices.size()), p, m_Width, m_Height))
 		return 0;
+
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+	{
+		ImageSlice(i).SetMode(1, true);
+	}
+	return 1;
 }
 
-int SlicesHandler::ReloadImage(const char* filename, unsigned short slicenr)
+int SlicesHandler::ReloadImage(const char* filename, unsigned slicenr)
 {
 	UpdateColorLookupTable(nullptr);
 
@@ -1526,7 +1618,7 @@ int SlicesHandler::ReloadImage(const char* filename, unsigned short slicenr)
 		std::vector<float*> slices(m_Endslice - m_Startslice);
 		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
-			slices[i - m_Startslice] = m_ImageSlices[i].ReturnBmp();
+			slices[i - m_Startslice] = ImageSlice(i).ReturnBmp();
 		}
 		ImageReader::GetVolume(filename, slices.data(), slicenr, m_Endslice - m_Startslice, m_Width, m_Height);
 		return 1;
@@ -1534,7 +1626,7 @@ int SlicesHandler::ReloadImage(const char* filename, unsigned short slicenr)
 	return 0;
 }
 
-int SlicesHandler::ReloadRTdose(const char* filename, unsigned short slicenr)
+int SlicesHandler::ReloadRTdose(const char* filename, unsigned slicenr)
 {
 	UpdateColorLookupTable(nullptr);
 
@@ -1592,7 +1684,7 @@ int SlicesHandler::ReloadRTdose(const char* filename, unsigned short slicenr)
 	writer->SetNumberOfFrames(dims[2]);
 	writer->AddOperatorsName("John Doe");
 	writer->AddOperatorsName("Jack Smith");
-	unsigned short birthDate[3] = { 1948, 8, 30 };
+	unsigned birthDate[3] = { 1948, 8, 30 };
 	writer->SetPatientBirthDate(birthDate);
 	writer->SetPatientID("158463");
 	writer->SetPatientName("Balakc Yusuf");
@@ -1649,7 +1741,7 @@ int SlicesHandler::ReloadRTdose(const char* filename, unsigned short slicenr)
 	rtDose->SetNumberOfFrames(dims[2]);
 	rtDose->AddOperatorsName("John Doe");
 	rtDose->AddOperatorsName("Jack Smith");
-	unsigned short birthDate[3] = { 1948, 8, 30 };
+	unsigned birthDate[3] = { 1948, 8, 30 };
 	rtDose->SetPatientBirthDate(birthDate);
 	rtDose->SetPatientID("158463");
 	rtDose->SetPatientName("Balakc Yusuf");
@@ -1703,7 +1795,7 @@ int SlicesHandler::ReloadRTdose(const char* filename, unsigned short slicenr)
 	std::vector<float*> bmpslices(m_Endslice - m_Startslice);
 	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		bmpslices[i - m_Startslice] = this->m_ImageSlices[i].ReturnBmp();
+		bmpslices[i - m_Startslice] = this->ImageSlice(i).ReturnBmp();
 	}
 
 	// Read pixel data
@@ -1711,6 +1803,7 @@ int SlicesHandler::ReloadRTdose(const char* filename, unsigned short slicenr)
 	if (res)
 	{
 		m_Loaded = true;
+		UpdateVolumeStorage();
 	}
 	else
 	{
@@ -1722,11 +1815,11 @@ int SlicesHandler::ReloadRTdose(const char* filename, unsigned short slicenr)
 #endif
 }
 
-int SlicesHandler::ReloadAVW(const char* filename, unsigned short slicenr)
+int SlicesHandler::ReloadAVW(const char* filename, unsigned slicenr)
 {
 	UpdateColorLookupTable(nullptr);
 
-	unsigned short w, h, nrofslices;
+	unsigned w, h, nrofslices;
 	avw::eDataType type;
 	float dx1, dy1, thickness1;
 	avw::ReadHeader(filename, w, h, nrofslices, dx1, dy1, thickness1, type);
@@ -1736,77 +1829,54 @@ int SlicesHandler::ReloadAVW(const char* filename, unsigned short slicenr)
 		return 0;
 
 	int j = 0;
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		j += m_ImageSlices[i].ReadAvw(filename, i);
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		j += ImageSlice(i).ReadAvw(filename, i);
 
 	if (j == (m_Endslice - m_Startslice))
 		return 1;
 	return 0;
 }
 
-int SlicesHandler::ReloadRaw(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned short slicenr, Point p)
+int SlicesHandler::ReloadRaw(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, Point p)
 {
-	UpdateColorLookupTable(nullptr);
-
-	int j = 0;
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		j += m_ImageSlices[i]
-						 .ReloadRaw(filename, w, h, bitdepth, (unsigned)slicenr + i - m_Startslice, p);
-
-	if (j == (m_Endslice - m_Startslice))
-		return 1;
-	else
-		return 0;
+	return ReloadRawVolume(filename, w, h, bitdepth, slicenr, p);
 }
 
-std::vector<float*> SlicesHandler::LoadRawFloat(const char* filename, unsigned short startslice, unsigned short endslice, unsigned short slicenr, unsigned int area)
+std::vector<float*> SlicesHandler::LoadRawFloat(const char* filename, unsigned startslice, unsigned endslice, unsigned slicenr, unsigned int area)
 {
-	std::vector<float*> slices_red;
-	for (unsigned short i = startslice; i < endslice; i++)
+	// slices which are not in the file stay nullptr
+	RawVolumeReader reader(filename, area, 1, 32);
+	unsigned const available = reader.NumSlices() > slicenr ? reader.NumSlices() - slicenr : 0;
+	unsigned const count = std::min(endslice - startslice, available);
+
+	std::vector<float*> slices_red(endslice - startslice, nullptr);
+	for (unsigned i = 0; i < count; i++)
 	{
-		float* slice_red = Bmphandler::ReadRawFloat(filename, (unsigned)slicenr + i - startslice, area);
-		slices_red.push_back(slice_red);
+		slices_red[i] = static_cast<float*>(malloc(sizeof(float) * area));
 	}
+	reader.Read(slices_red.data(), slicenr, count);
 	return slices_red;
 }
 
-int SlicesHandler::ReloadRawFloat(const char* filename, unsigned short slicenr)
+int SlicesHandler::ReloadRawFloat(const char* filename, unsigned slicenr)
 {
-	UpdateColorLookupTable(nullptr);
-
-	int j = 0;
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		j += m_ImageSlices[i]
-						 .ReloadRawFloat(filename, (unsigned)slicenr + i - m_Startslice);
-
-	if (j == (m_Endslice - m_Startslice))
-		return 1;
-	else
-		return 0;
+	Point p;
+	p.px = p.py = 0;
+	return ReloadRawVolume(filename, m_Width, m_Height, 32, slicenr, p);
 }
 
-int SlicesHandler::ReloadRawFloat(const char* filename, short unsigned w, short unsigned h, unsigned short slicenr, Point p)
+int SlicesHandler::ReloadRawFloat(const char* filename, unsigned w, unsigned h, unsigned slicenr, Point p)
 {
-	UpdateColorLookupTable(nullptr);
-
-	int j = 0;
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		j += m_ImageSlices[i]
-						 .ReloadRawFloat(filename, w, h, (unsigned)slicenr + i - m_Startslice, p);
-
-	if (j == (m_Endslice - m_Startslice))
-		return 1;
-	else
-		return 0;
+	return ReloadRawVolume(filename, w, h, 32, slicenr, p);
 }
 
-int SlicesHandler::ReloadRawTissues(const char* filename, unsigned bitdepth, unsigned short slicenr)
+int SlicesHandler::ReloadRawTissues(const char* filename, unsigned bitdepth, unsigned slicenr)
 {
 	UpdateColorLookupTable(nullptr);
 
 	int j = 0;
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		j += m_ImageSlices[i]
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		j += ImageSlice(i)
 						 .ReloadRawTissues(filename, bitdepth, (unsigned)slicenr + i - m_Startslice);
 
 	if (j == (m_Endslice - m_Startslice))
@@ -1815,13 +1885,13 @@ int SlicesHandler::ReloadRawTissues(const char* filename, unsigned bitdepth, uns
 		return 0;
 }
 
-int SlicesHandler::ReloadRawTissues(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned short slicenr, Point p)
+int SlicesHandler::ReloadRawTissues(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, Point p)
 {
 	UpdateColorLookupTable(nullptr);
 
 	int j = 0;
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		j += m_ImageSlices[i]
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		j += ImageSlice(i)
 						 .ReloadRawTissues(filename, w, h, bitdepth, (unsigned)slicenr + i - m_Startslice, p);
 
 	if (j == (m_Endslice - m_Startslice))
@@ -1830,9 +1900,10 @@ int SlicesHandler::ReloadRawTissues(const char* filename, short unsigned w, shor
 		return 0;
 }
 
-FILE* SlicesHandler::SaveHeader(FILE* fp, short unsigned nr_slices_to_write, Transform transform_to_write)
+FILE* SlicesHandler::SaveHeader(FILE* fp, unsigned nr_slices_to_write, Transform transform_to_write)
 {
-	fwrite(&nr_slices_to_write, 1, sizeof(unsigned short), fp);
+	unsigned short nr_slices16 = (nr_slices_to_write > 0xFFFF) ? 0 : static_cast<unsigned short>(nr_slices_to_write);
+	fwrite(&nr_slices16, 1, sizeof(unsigned short), fp);
 	float thick = -m_Thickness;
 	if (thick > 0)
 		thick = -thick;
@@ -1851,11 +1922,16 @@ FILE* SlicesHandler::SaveHeader(FILE* fp, short unsigned nr_slices_to_write, Tra
 		fwrite(&(transform_r[2]), 1, sizeof(float), fp);
 		fwrite(&(transform_r[3]), 1, sizeof(float), fp);
 	}
+	if (nr_slices16 == 0)
+	{
+		std::uint32_t nr_slices32 = nr_slices_to_write;
+		fwrite(&nr_slices32, 1, sizeof(std::uint32_t), fp);
+	}
 
 	return fp;
 }
 
-FILE* SlicesHandler::SaveProject(const char* filename, const char* imageFileExtension)
+FILE* SlicesHandler::SaveProject(const char* filename, const char* imageFileExtension, ProgressInfo* progress, std::function<void(bool)> done)
 {
 	FILE* fp;
 
@@ -1864,15 +1940,15 @@ FILE* SlicesHandler::SaveProject(const char* filename, const char* imageFileExte
 
 	fp = SaveHeader(fp, m_Nrslices, m_Transform);
 
-	for (unsigned short j = 0; j < m_Nrslices; j++)
+	for (unsigned j = 0; j < m_Nrslices; j++)
 	{
-		fp = m_ImageSlices[j].SaveProj(fp, false);
+		fp = ImageSlice(j).SaveProj(fp, false);
 	}
-	fp = (m_ImageSlices[0]).SaveStack(fp);
+	fp = (ImageSlice(0)).SaveStack(fp);
 
 	// SaveAllXdmf uses startslice/endslice to decide what to write - here we want to override that behavior
-	unsigned short startslice1 = m_Startslice;
-	unsigned short endslice1 = m_Endslice;
+	unsigned startslice1 = m_Startslice;
+	unsigned endslice1 = m_Endslice;
 	m_Startslice = 0;
 	m_Endslice = m_Nrslices;
 	unsigned char length1 = 0;
@@ -1886,7 +1962,11 @@ FILE* SlicesHandler::SaveProject(const char* filename, const char* imageFileExte
 	image_file_name =
 			image_file_name.remove(after_dot, image_file_name.length() - after_dot) +
 			imageFileExtension;
-	SaveAllXdmf(QFileInfo(filename).dir().absoluteFilePath(image_file_name).toStdString().c_str(), this->m_Hdf5Compression, this->m_SaveTarget, false);
+	std::string const image_file_path = QFileInfo(filename).dir().absoluteFilePath(image_file_name).toStdString();
+	if (!done || !StartBackgroundSave(image_file_path.c_str(), this->m_Hdf5Compression, this->m_SaveTarget, progress, done))
+	{
+		SaveAllXdmf(image_file_path.c_str(), this->m_Hdf5Compression, this->m_SaveTarget, false);
+	}
 
 	m_Startslice = startslice1;
 	m_Endslice = endslice1;
@@ -1896,8 +1976,8 @@ FILE* SlicesHandler::SaveProject(const char* filename, const char* imageFileExte
 
 bool SlicesHandler::SaveCommunicationFile(const char* filename)
 {
-	unsigned short startslice1 = m_Startslice;
-	unsigned short endslice1 = m_Endslice;
+	unsigned startslice1 = m_Startslice;
+	unsigned endslice1 = m_Endslice;
 	m_Startslice = 0;
 	m_Endslice = m_Nrslices;
 
@@ -1916,15 +1996,15 @@ FILE* SlicesHandler::SaveActiveSlices(const char* filename, const char* imageFil
 	if ((fp = fopen(filename, "wb")) == nullptr)
 		return nullptr;
 
-	unsigned short slicecount = m_Endslice - m_Startslice;
+	unsigned slicecount = m_Endslice - m_Startslice;
 	Transform transform_corrected = GetTransformActiveSlices();
 	SaveHeader(fp, slicecount, transform_corrected);
 
-	for (unsigned short j = m_Startslice; j < m_Endslice; j++)
+	for (unsigned j = m_Startslice; j < m_Endslice; j++)
 	{
-		fp = m_ImageSlices[j].SaveProj(fp, false);
+		fp = ImageSlice(j).SaveProj(fp, false);
 	}
-	fp = (m_ImageSlices[0]).SaveStack(fp);
+	fp = (ImageSlice(0)).SaveStack(fp);
 	unsigned char length1 = 0;
 	while (imageFileExtension[length1] != '\0')
 		length1++;
@@ -1944,8 +2024,8 @@ FILE* SlicesHandler::SaveActiveSlices(const char* filename, const char* imageFil
 FILE* SlicesHandler::MergeProjects(const char* savefilename, std::vector<QString>& mergeFilenames)
 {
 	// Get number of slices to total
-	unsigned short nrslices_total = m_Nrslices;
-	for (unsigned short i = 0; i < mergeFilenames.size(); i++)
+	unsigned nrslices_total = m_Nrslices;
+	for (unsigned i = 0; i < mergeFilenames.size(); i++)
 	{
 		if (!mergeFilenames[i].endsWith(".prj"))
 		{
@@ -1954,10 +2034,9 @@ FILE* SlicesHandler::MergeProjects(const char* savefilename, std::vector<QString
 
 		FILE* fp_merge;
 		// Add number of slices to total
-		unsigned short nrslices_merge = 0;
 		if ((fp_merge = fopen(mergeFilenames[i].toStdString().c_str(), "rb")) == nullptr)
 			return nullptr;
-		fread(&nrslices_merge, sizeof(unsigned short), 1, fp_merge);
+		unsigned nrslices_merge = ReadProjectNumberOfSlices(fp_merge);
 		nrslices_total += nrslices_merge;
 		fclose(fp_merge);
 	}
@@ -1971,14 +2050,14 @@ FILE* SlicesHandler::MergeProjects(const char* savefilename, std::vector<QString
 	fp = SaveHeader(fp, nrslices_total, m_Transform);
 
 	// Save current project slices
-	for (unsigned short j = 0; j < m_Nrslices; j++)
+	for (unsigned j = 0; j < m_Nrslices; j++)
 	{
-		fp = m_ImageSlices[j].SaveProj(fp, false);
+		fp = ImageSlice(j).SaveProj(fp, false);
 	}
 
 	FILE* fp_merge;
 	// Save merged project slices
-	for (unsigned short i = 0; i < mergeFilenames.size(); i++)
+	for (unsigned i = 0; i < mergeFilenames.size(); i++)
 	{
 		if ((fp_merge = fopen(mergeFilenames[i].toStdString().c_str(), "rb")) == nullptr)
 		{
@@ -1991,12 +2070,12 @@ FILE* SlicesHandler::MergeProjects(const char* savefilename, std::vector<QString
 		SlicesHandler dummy_slices_handler;
 		dummy_slices_handler.LoadHeader(fp_merge, tissues_version, version);
 
-		unsigned short merge_nrslices = dummy_slices_handler.NumSlices();
+		unsigned merge_nrslices = dummy_slices_handler.NumSlices();
 		//float mergeThickness = dummy_SlicesHandler.get_slicethickness();
 
 		// Load input slices and save to merged project file
 		Bmphandler tmp_slice;
-		for (unsigned short j = 0; j < merge_nrslices; j++)
+		for (unsigned j = 0; j < merge_nrslices; j++)
 		{
 			fp_merge = tmp_slice.LoadProj(fp_merge, tissues_version, false);
 			fp = tmp_slice.SaveProj(fp, false);
@@ -2005,10 +2084,10 @@ FILE* SlicesHandler::MergeProjects(const char* savefilename, std::vector<QString
 		fclose(fp_merge);
 	}
 
-	fp = (m_ImageSlices[0]).SaveStack(fp);
+	fp = (ImageSlice(0)).SaveStack(fp);
 
-	unsigned short startslice1 = m_Startslice;
-	unsigned short endslice1 = m_Endslice;
+	unsigned startslice1 = m_Startslice;
+	unsigned endslice1 = m_Endslice;
 	m_Startslice = 0;
 	m_Endslice = m_Nrslices;
 	QString image_file_extension = "xmf";
@@ -2038,9 +2117,9 @@ void SlicesHandler::LoadHeader(FILE* fp, int& tissuesVersion, int& version)
 {
 	m_Activeslice = 0;
 
-	fread(&m_Nrslices, sizeof(unsigned short), 1, fp);
-	m_Startslice = 0;
-	m_Endslice = m_Nrslices;
+	unsigned short nr_slices16 = 0;
+	fread(&nr_slices16, sizeof(unsigned short), 1, fp);
+	m_Nrslices = nr_slices16;
 	fread(&m_Thickness, sizeof(float), 1, fp);
 
 	//    set_slicethickness(thickness);
@@ -2072,7 +2151,7 @@ void SlicesHandler::LoadHeader(FILE* fp, int& tissuesVersion, int& version)
 		}
 		if (version > 3)
 		{
-			for (unsigned short i = 0; i < 6; ++i)
+			for (unsigned i = 0; i < 6; ++i)
 			{
 				fread(&(direction_cosines[i]), sizeof(float), 1, fp);
 			}
@@ -2089,7 +2168,15 @@ void SlicesHandler::LoadHeader(FILE* fp, int& tissuesVersion, int& version)
 			fread(&(transform_r[2]), sizeof(float), 1, fp);
 			fread(&(transform_r[3]), sizeof(float), 1, fp);
 		}
+		if (nr_slices16 == 0)
+		{
+			std::uint32_t nr_slices32 = 0;
+			fread(&nr_slices32, sizeof(std::uint32_t), 1, fp);
+			m_Nrslices = nr_slices32;
+		}
 	}
+	m_Startslice = 0;
+	m_Endslice = m_Nrslices;
 }
 
 FILE* SlicesHandler::LoadProject(const char* filename, int& tissuesVersion)
@@ -2102,23 +2189,44 @@ FILE* SlicesHandler::LoadProject(const char* filename, int& tissuesVersion)
 	int version = 0;
 	LoadHeader(fp, tissuesVersion, version);
 
+	// all slices are replaced, the content of the page file is not needed anymore
+	if (m_PageFile)
+	{
+		for (auto& slice : m_ImageSlices)
+		{
+			if (slice.IsPagedOut())
+				slice.Freebmp();
+		}
+		m_PageFile.reset();
+	}
+
 	m_ImageSlices.resize(m_Nrslices);
 
 	m_Os.SetSizenr(m_Nrslices);
 
-	for (unsigned short j = 0; j < m_Nrslices; ++j)
+	// with paging, the images are read from the xmf file when the slices are accessed
+	bool paging = m_PagingBudget > 0 && !m_UseVolumeStorage && version > 1;
+	for (unsigned j = 0; j < m_Nrslices; ++j)
 	{
 		// skip initializing because we load real data into the arrays below
-		fp = m_ImageSlices[j].LoadProj(fp, tissuesVersion, version <= 1, false);
-	}
-
+		fp = ImageSlice(j).LoadProj(fp, tissuesVersion, version <= 1, false);
+		if (paging && j == 0)
+		{
+			paging = ResetPageFile();
+		}
+		if (paging)
+		{
+			m_ImageSlices[j].PageOut();
+		}
+	}
+
 	SetSlicethickness(m_Thickness);
 
-	fp = (m_ImageSlices[0]).LoadStack(fp);
+	fp = (ImageSlice(0)).LoadStack(fp);
 
-	m_Width = (m_ImageSlices[0]).ReturnWidth();
-	m_Height = (m_ImageSlices[0]).ReturnHeight();
-	m_Area = m_Height * (unsigned int)m_Width;
+	m_Width = (ImageSlice(0)).ReturnWidth();
+	m_Height = (ImageSlice(0)).ReturnHeight();
+	m_Area = m_Height * (size_t)m_Width;
 
 	NewOverlay();
 
@@ -2164,15 +2272,15 @@ FILE* SlicesHandler::LoadProject(const char* filename, int& tissuesVersion)
 	ComputeBmprangeMode1(&dummy);
 
 	m_Loaded = true;
+	UpdateVolumeStorage();
 
 	return fp;
 }
 
-bool SlicesHandler::LoadS4Llink(const char* filename, int& tissuesVersion)
+bool SlicesHandler::LoadS4Llink(const char* filename, int& tissuesVersion, const VolumeRegion& region)
 {
 	unsigned w, h, nrofslices;
-	float* pixsize;
-	float* tr_1d;
+	float pixsize[3];
 	QStringList array_names;
 
 	HDFImageReader reader;
@@ -2182,35 +2290,48 @@ bool SlicesHandler::LoadS4Llink(const char* filename, int& tissuesVersion)
 	w = reader.GetWidth();
 	h = reader.GetHeight();
 	nrofslices = reader.GetNumberOfSlices();
-	pixsize = reader.GetPixelSize();
-	tr_1d = reader.GetImageTransform();
+	std::copy(reader.GetPixelSize(), reader.GetPixelSize() + 3, pixsize);
+	float* tr_1d = reader.GetImageTransform();
+
+	float* transform_1d = m_Transform[0];
+	std::copy(tr_1d, tr_1d + 16, transform_1d);
+
+	// allocate only the region, with the spacing and origin of its first voxel
+	unsigned const dims[3] = {w, h, nrofslices};
+	VolumeRegion clipped = region;
+	if (!clipped.Clip(dims))
+	{
+		ISEG_ERROR_MSG("LoadS4Llink() : region lies outside of the volume");
+		return false;
+	}
+	clipped.Apply(pixsize, m_Transform);
+	w = clipped.Dim(0);
+	h = clipped.Dim(1);
+	nrofslices = clipped.Dim(2);
 
 	// taken from LoadProject()
 	m_Activeslice = 0;
 	this->m_Width = w;
 	this->m_Height = h;
-	this->m_Area = m_Height * (unsigned int)m_Width;
+	this->m_Area = m_Height * (size_t)m_Width;
 	this->m_Nrslices = nrofslices;
 	this->m_Startslice = 0;
 	this->m_Endslice = m_Nrslices;
 	this->SetPixelsize(pixsize[0], pixsize[1]);
 	this->m_Thickness = pixsize[2];
 
-	float* transform_1d = m_Transform[0];
-	std::copy(tr_1d, tr_1d + 16, transform_1d);
-
 	this->m_ImageSlices.resize(m_Nrslices);
 	this->m_Os.SetSizenr(m_Nrslices);
 	this->SetSlicethickness(m_Thickness);
 	this->m_Loaded = true;
-	for (unsigned short j = 0; j < m_Nrslices; j++)
+	for (unsigned j = 0; j < m_Nrslices; j++)
 	{
-		this->m_ImageSlices[j].Newbmp(w, h);
+		this->ImageSlice(j).Newbmp(w, h);
 	}
 
 	NewOverlay();
 
-	bool res = LoadAllHDF(filename);
+	bool res = LoadAllHDF(filename, clipped);
 
 	// Ranges
 	Pair dummy;
@@ -2220,10 +2341,77 @@ bool SlicesHandler::LoadS4Llink(const char* filename, int& tissuesVersion)
 	ComputeBmprangeMode1(&dummy);
 
 	SetActiveTissuelayer(0);
+	UpdateVolumeStorage();
 
 	return res;
 }
 
+bool SlicesHandler::LoadPreview(const char* filename, int level)
+{
+	WaitForBackgroundSave();
+
+	QFileInfo file_info(filename);
+	std::string const h5file = file_info.dir().absoluteFilePath(file_info.completeBaseName() + ".h5").toStdString();
+
+	HDFImageReader reader;
+	reader.SetFileName(h5file.c_str());
+	if (!reader.ParseHDF())
+	{
+		return false;
+	}
+	int const levels = reader.GetPreviewLevels();
+	if (levels == 0)
+	{
+		return false;
+	}
+	level = std::min(std::max(level, 1), levels);
+
+	unsigned const factor = 1u << level;
+	auto const dims = VolumePyramid::Dims({reader.GetWidth(), reader.GetHeight(), reader.GetNumberOfSlices()}, level);
+	float pixsize[3];
+	Transform transform;
+	std::copy(reader.GetImageTransform(), reader.GetImageTransform() + 16, transform[0]);
+	for (int i = 0; i < 3; i++)
+	{
+		pixsize[i] = reader.GetPixelSize()[i] * factor;
+	}
+	// a preview voxel lies at the center of the block it was reduced from
+	float offset[3];
+	transform.GetOffset(offset);
+	for (int r = 0; r < 3; r++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			offset[r] += transform[r][c] * 0.5f * (pixsize[c] - pixsize[c] / factor);
+		}
+	}
+	transform.SetOffset(offset);
+
+	UpdateColorLookupTable(reader.ReadColorLookup());
+	Newbmp(dims[0], dims[1], dims[2]);
+	SetPixelsize(pixsize[0], pixsize[1]);
+	m_Thickness = pixsize[2];
+	SetSlicethickness(m_Thickness);
+	m_Transform = transform;
+
+	std::vector<float*> bmpslices(m_Nrslices);
+	std::vector<tissues_size_t*> tissueslices(m_Nrslices);
+	for (unsigned i = 0; i < m_Nrslices; i++)
+	{
+		bmpslices[i] = ImageSlice(i).ReturnBmp();
+		tissueslices[i] = ImageSlice(i).ReturnTissues(0);
+	}
+	reader.SetImageSlices(bmpslices.data());
+	reader.SetTissueSlices(tissueslices.data());
+	bool const ok = reader.ReadPreview(level) != 0;
+
+	Pair dummy;
+	ComputeRangeMode1(&dummy);
+	ComputeBmprangeMode1(&dummy);
+	UpdateVolumeStorage();
+	return ok;
+}
+
 int SlicesHandler::SaveBmpRaw(const char* filename)
 {
 	return SaveRaw(filename, false);
@@ -2249,12 +2437,12 @@ int SlicesHandler::SaveRaw(const char* filename, bool work)
 
 	unsigned int bitsize = m_Width * (unsigned)m_Height;
 
-	for (unsigned short j = 0; j < m_Nrslices; j++)
+	for (unsigned j = 0; j < m_Nrslices; j++)
 	{
 		if (work)
-			p_bits = m_ImageSlices[j].ReturnWork();
+			p_bits = WorkForReading(j);
 		else
-			p_bits = m_ImageSlices[j].ReturnBmp();
+			p_bits = ImageSlice(j).ReturnBmp();
 		for (unsigned int i = 0; i < m_Area; i++)
 		{
 			bits_tmp[i] = (unsigned char)(std::min(255.0, std::max(0.0, p_bits[i] + 0.5)));
@@ -2286,9 +2474,9 @@ int SlicesHandler::SaveTissueRaw(const char* filename)
 			(sizeof(tissues_size_t) > sizeof(unsigned char)))
 	{
 		unsigned char* uchar_buffer = new unsigned char[bitsize];
-		for (unsigned short j = 0; j < m_Nrslices; j++)
+		for (unsigned j = 0; j < m_Nrslices; j++)
 		{
-			bits_tmp = m_ImageSlices[j].ReturnTissues(m_ActiveTissuelayer);
+			bits_tmp = ImageSlice(j).ReturnTissues(m_ActiveTissuelayer);
 			for (unsigned int i = 0; i < bitsize; ++i)
 			{
 				uchar_buffer[i] = (unsigned char)bits_tmp[i];
@@ -2304,9 +2492,9 @@ int SlicesHandler::SaveTissueRaw(const char* filename)
 	}
 	else
 	{
-		for (unsigned short j = 0; j < m_Nrslices; j++)
+		for (unsigned j = 0; j < m_Nrslices; j++)
 		{
-			bits_tmp = m_ImageSlices[j].ReturnTissues(m_ActiveTissuelayer);
+			bits_tmp = ImageSlice(j).ReturnTissues(m_ActiveTissuelayer);
 			if (fwrite(bits_tmp, sizeof(tissues_size_t), bitsize, fp) <
 					(unsigned int)bitsize)
 			{
@@ -2396,13 +2584,13 @@ int SlicesHandler::SaveRawResized(const char* filename, int dxm, int dxp, int dy
 	if (dyp < 0)
 		h1 += dyp;
 
-	for (unsigned short j = (unsigned short)std::max(0, -dzm);
-			 j < m_Nrslices - (unsigned short)std::max(0, -dzp); j++)
+	for (unsigned j = (unsigned)std::max(0, -dzm);
+			 j < m_Nrslices - (unsigned)std::max(0, -dzp); j++)
 	{
 		if (work)
-			p_bits = m_ImageSlices[j].ReturnWork();
+			p_bits = WorkForReading(j);
 		else
-			p_bits = m_ImageSlices[j].ReturnBmp();
+			p_bits = ImageSlice(j).ReturnBmp();
 
 		unsigned pos1, pos2;
 		pos1 = posstart1;
@@ -2520,11 +2708,11 @@ int SlicesHandler::SaveTissuesRawResized(const char* filename, int dxm, int dxp,
 	if (dyp < 0)
 		h1 += dyp;
 
-	for (unsigned short j = (unsigned short)std::max(0, -dzm);
-			 j < m_Nrslices - (unsigned short)std::max(0, -dzp); j++)
+	for (unsigned j = (unsigned)std::max(0, -dzm);
+			 j < m_Nrslices - (unsigned)std::max(0, -dzp); j++)
 	{
 		tissues_size_t* p_bits =
-				m_ImageSlices[j].ReturnTissues(m_ActiveTissuelayer);
+				ImageSlice(j).ReturnTissues(m_ActiveTissuelayer);
 		unsigned pos1, pos2;
 		pos1 = posstart1;
 		pos2 = posstart2;
@@ -2565,6 +2753,62 @@ int SlicesHandler::SaveTissuesRawResized(const char* filename, int dxm, int dxp,
 	return 0;
 }
 
+namespace {
+
+/// Writes the permuted volume slab by slab, i.e. only a few output slices are buffered
+template<typename T>
+int SavePermutedRaw(const char* filename, const std::vector<const T*>& slices, unsigned width, unsigned height, unsigned nrslices, const AxisPermutation::order_type& order)
+{
+	FILE* fp = fopen(filename, "wb");
+	if (fp == nullptr)
+		return (-1);
+
+	auto const dims = AxisPermutation::Dims(width, height, nrslices, order);
+	size_t const area = static_cast<size_t>(dims[0]) * dims[1];
+	unsigned const block_slices = AxisPermutation::kBlockSlices;
+	unsigned const slab = std::min(dims[2], block_slices);
+
+	std::vector<T> buffer(area * slab);
+	std::vector<T*> out(slab);
+	for (unsigned k = 0; k < slab; k++)
+	{
+		out[k] = buffer.data() + k * area;
+	}
+
+	for (unsigned first = 0; first < dims[2]; first += slab)
+	{
+		unsigned const count = std::min(slab, dims[2] - first);
+		AxisPermutation::Permute<T>(slices.data(), width, height, nrslices, order, out.data(), first, count);
+		if (fwrite(buffer.data(), sizeof(T), area * count, fp) < area * count)
+		{
+			fclose(fp);
+			return (-1);
+		}
+	}
+
+	fclose(fp);
+	return 0;
+}
+
+/// Reads a volume written by SavePermutedRaw back into the slices
+template<typename T>
+bool ReadPermutedRaw(const char* filename, const std::vector<T*>& slices, size_t area)
+{
+	FILE* fp = fopen(filename, "rb");
+	if (fp == nullptr)
+		return false;
+
+	bool ok = true;
+	for (size_t k = 0; k < slices.size() && ok; k++)
+	{
+		ok = fread(slices[k], sizeof(T), area, fp) == area;
+	}
+	fclose(fp);
+	return ok;
+}
+
+} // namespace
+
 void SlicesHandler::SwapAffine(const std::vector<unsigned int>& order)
 {
 	std::array<Vec3, 3> input_rot, output_rot;
@@ -2589,149 +2833,70 @@ void SlicesHandler::SwapAffine(const std::vector<unsigned int>& order)
 
 bool SlicesHandler::SwapXY()
 {
-	auto lut = GetColorLookupTable();
-
-	unsigned short w, h, nrslices;
-	w = Height();
-	h = Width();
-	nrslices = NumSlices();
-	QString str1;
-	bool ok = true;
-	unsigned char mode1 = GetActivebmphandler()->ReturnMode(true);
-	unsigned char mode2 = GetActivebmphandler()->ReturnMode(false);
-
-	str1 = QDir::temp().absoluteFilePath("bmp_float.raw");
-	if (SaveRawXySwapped(str1.toAscii(), false) != 0)
-		ok = false;
-	str1 = QDir::temp().absoluteFilePath("work_float.raw");
-	if (SaveRawXySwapped(str1.toAscii(), true) != 0)
-		ok = false;
-	str1 = QDir::temp().absoluteFilePath("tissues.raw");
-	if (SaveTissuesRawXySwapped(str1.toAscii()) != 0)
-		ok = false;
-
-	if (ok)
-	{
-		str1 = QDir::temp().absoluteFilePath("work_float.raw");
-		if (ReadRawFloat(str1.toAscii(), w, h, 0, nrslices) != 1)
-			ok = false;
-		SetModeall(mode1, true);
-	}
-	if (ok)
-	{
-		str1 = QDir::temp().absoluteFilePath("bmp_float.raw");
-		if (ReloadRawFloat(str1.toAscii(), 0) != 1)
-			ok = false;
-		SetModeall(mode2, false);
-	}
-	if (ok)
-	{
-		str1 = QDir::temp().absoluteFilePath("tissues.raw");
-		if (ReloadRawTissues(str1.toAscii(), sizeof(tissues_size_t) * 8, 0) != 1)
-			ok = false;
-	}
-
-	SwapAffine({1, 0, 2});
-
-	// add color lookup table again
-	UpdateColorLookupTable(lut);
-
-	SliceProviderInstaller::Getinst()->Report();
-
-	return ok;
+	return PermuteVolume({1, 0, 2});
 }
 
 bool SlicesHandler::SwapYZ()
 {
-	auto lut = GetColorLookupTable();
-
-	unsigned short w, h, nrslices;
-	w = Width();
-	h = NumSlices();
-	nrslices = Height();
-	QString str1;
-	bool ok = true;
-	str1 = QDir::temp().absoluteFilePath("bmp_floatto.raw");
-	if (SaveRawYzSwapped(str1.toAscii(), false) != 0)
-		ok = false;
-	str1 = QDir::temp().absoluteFilePath("work_floatto.raw");
-	if (SaveRawYzSwapped(str1.toAscii(), true) != 0)
-		ok = false;
-	str1 = QDir::temp().absoluteFilePath("tissuesto.raw");
-	if (SaveTissuesRawYzSwapped(str1.toAscii()) != 0)
-		ok = false;
-
-	if (ok)
-	{
-		str1 = QDir::temp().absoluteFilePath("work_floatto.raw");
-		if (ReadRawFloat(str1.toAscii(), w, h, 0, nrslices) != 1)
-			ok = false;
-	}
-	if (ok)
-	{
-		str1 = QDir::temp().absoluteFilePath("bmp_floatto.raw");
-		if (ReloadRawFloat(str1.toAscii(), 0) != 1)
-			ok = false;
-	}
-	if (ok)
-	{
-		str1 = QDir::temp().absoluteFilePath("tissuesto.raw");
-		if (ReloadRawTissues(str1.toAscii(), sizeof(tissues_size_t) * 8, 0) != 1)
-			ok = false;
-	}
-
-	SwapAffine({0, 2, 1});
-
-	// add color lookup table again
-	UpdateColorLookupTable(lut);
-
-	SliceProviderInstaller::Getinst()->Report();
-
-	return ok;
+	return PermuteVolume({0, 2, 1});
 }
 
 bool SlicesHandler::SwapXZ()
+{
+	return PermuteVolume({2, 1, 0});
+}
+
+bool SlicesHandler::PermuteVolume(const std::array<unsigned int, 3>& order)
 {
 	auto lut = GetColorLookupTable();
 
-	unsigned short w, h, nrslices;
-	w = NumSlices();
-	h = Height();
-	nrslices = Width();
-	//Pair p = get_pixelsize();
-	//float thick = get_slicethickness();
-	QString str1;
-	bool ok = true;
-	str1 = QDir::temp().absoluteFilePath("bmp_floatto.raw");
-	if (SaveRawXzSwapped(str1.toAscii(), false) != 0)
-		ok = false;
-	str1 = QDir::temp().absoluteFilePath("work_floatto.raw");
-	if (SaveRawXzSwapped(str1.toAscii(), true) != 0)
-		ok = false;
-	str1 = QDir::temp().absoluteFilePath("tissuesto.raw");
-	if (SaveTissuesRawXzSwapped(str1.toAscii()) != 0)
-		ok = false;
+	unsigned char mode1 = GetActivebmphandler()->ReturnMode(true);
+	unsigned char mode2 = GetActivebmphandler()->ReturnMode(false);
+
+	// the permuted images are staged on disk slab by slab, because the slices are reallocated for the new dimensions.
+	// Staged in memory, the source, target and tissues of both volumes would be allocated at the same time.
+	auto const dims = AxisPermutation::Dims(m_Width, m_Height, m_Nrslices, order);
+	size_t const area = static_cast<size_t>(dims[0]) * dims[1];
+	std::string const bmp_file = QDir::temp().absoluteFilePath("bmp_permuted.raw").toStdString();
+	std::string const work_file = QDir::temp().absoluteFilePath("work_permuted.raw").toStdString();
+	std::string const tissues_file = QDir::temp().absoluteFilePath("tissues_permuted.raw").toStdString();
+	auto remove_files = [&]() {
+		for (const auto& file : {bmp_file, work_file, tissues_file})
+		{
+			QFile::remove(QString::fromStdString(file));
+		}
+	};
 
-	if (ok)
-	{
-		str1 = QDir::temp().absoluteFilePath("work_floatto.raw");
-		if (ReadRawFloat(str1.toAscii(), w, h, 0, nrslices) != 1)
-			ok = false;
-	}
-	if (ok)
-	{
-		str1 = QDir::temp().absoluteFilePath("bmp_floatto.raw");
-		if (ReloadRawFloat(str1.toAscii(), 0) != 1)
-			ok = false;
-	}
-	if (ok)
 	{
-		str1 = QDir::temp().absoluteFilePath("tissuesto.raw");
-		if (ReloadRawTissues(str1.toAscii(), sizeof(tissues_size_t) * 8, 0) != 1)
-			ok = false;
+		const SlicesHandler& handler = *this;
+		if (SavePermutedRaw<float>(bmp_file.c_str(), handler.SourceSlices(), m_Width, m_Height, m_Nrslices, order) != 0 ||
+				SavePermutedRaw<float>(work_file.c_str(), handler.TargetSlices(), m_Width, m_Height, m_Nrslices, order) != 0 ||
+				SavePermutedRaw<tissues_size_t>(tissues_file.c_str(), handler.TissueSlices(m_ActiveTissuelayer), m_Width, m_Height, m_Nrslices, order) != 0)
+		{
+			// the volume is left as it is
+			remove_files();
+			return false;
+		}
 	}
 
-	SwapAffine({2, 1, 0});
+	UpdateColorLookupTable(nullptr);
+	Newbmp(dims[0], dims[1], dims[2]);
+
+	bool const ok = ReadPermutedRaw<float>(bmp_file.c_str(), SourceSlices(), area) &&
+									ReadPermutedRaw<float>(work_file.c_str(), TargetSlices(), area) &&
+									ReadPermutedRaw<tissues_size_t>(tissues_file.c_str(), TissueSlices(m_ActiveTissuelayer), area);
+	remove_files();
+	ReleaseZeroTargets();
+	SetModeall(mode1, true);
+	SetModeall(mode2, false);
+
+	// Ranges
+	Pair dummy;
+	ComputeRangeMode1(&dummy);
+	ComputeBmprangeMode1(&dummy);
+	UpdateVolumeStorage();
+
+	SwapAffine({order[0], order[1], order[2]});
 
 	// add color lookup table again
 	UpdateColorLookupTable(lut);
@@ -2743,145 +2908,35 @@ bool SlicesHandler::SwapXZ()
 
 int SlicesHandler::SaveRawXySwapped(const char* filename, bool work)
 {
-	return SaveRawXySwapped(filename, work ? TargetSlices() : SourceSlices(), m_Width, m_Height, m_Nrslices);
+	const SlicesHandler& handler = *this;
+	return SavePermutedRaw<float>(filename, work ? handler.TargetSlices() : handler.SourceSlices(), m_Width, m_Height, m_Nrslices, {1, 0, 2});
 }
 
-int SlicesHandler::SaveRawXySwapped(const char* filename, std::vector<float*> bits_to_swap, short unsigned width, short unsigned height, short unsigned nrslices)
+int SlicesHandler::SaveRawXySwapped(const char* filename, std::vector<float*> bits_to_swap, unsigned width, unsigned height, unsigned nrslices)
 {
-	FILE* fp;
-	float* bits_tmp;
-	float* p_bits;
-
-	const unsigned int bitsize = width * (unsigned)height;
-	bits_tmp = (float*)malloc(sizeof(float) * bitsize);
-	if (bits_tmp == nullptr)
-		return -1;
-
-	if ((fp = fopen(filename, "wb")) == nullptr)
-		return (-1);
-
-	for (unsigned short j = 0; j < nrslices; j++)
-	{
-		p_bits = bits_to_swap[j];
-		unsigned pos1, pos2;
-		pos1 = 0;
-		for (unsigned short y = 0; y < height; y++)
-		{
-			pos2 = y;
-			for (unsigned short x = 0; x < width; x++)
-			{
-				bits_tmp[pos2] = p_bits[pos1];
-				pos1++;
-				pos2 += height;
-			}
-		}
-		if (fwrite(bits_tmp, 1, sizeof(float) * bitsize, fp) < sizeof(float) * bitsize)
-		{
-			fclose(fp);
-			return (-1);
-		}
-	}
-
-	free(bits_tmp);
-
-	fclose(fp);
-	return 0;
+	return SavePermutedRaw<float>(filename, std::vector<const float*>(bits_to_swap.begin(), bits_to_swap.end()), width, height, nrslices, {1, 0, 2});
 }
 
 int SlicesHandler::SaveRawXzSwapped(const char* filename, bool work)
 {
-	return SaveRawXzSwapped(filename, work ? TargetSlices() : SourceSlices(), m_Width, m_Height, m_Nrslices);
+	const SlicesHandler& handler = *this;
+	return SavePermutedRaw<float>(filename, work ? handler.TargetSlices() : handler.SourceSlices(), m_Width, m_Height, m_Nrslices, {2, 1, 0});
 }
 
-int SlicesHandler::SaveRawXzSwapped(const char* filename, std::vector<float*> bits_to_swap, short unsigned width, short unsigned height, short unsigned nrslices)
+int SlicesHandler::SaveRawXzSwapped(const char* filename, std::vector<float*> bits_to_swap, unsigned width, unsigned height, unsigned nrslices)
 {
-	FILE* fp;
-	float* bits_tmp;
-	float* p_bits;
-
-	const unsigned int bitsize = nrslices * (unsigned)height;
-	bits_tmp = (float*)malloc(sizeof(float) * bitsize);
-	if (bits_tmp == nullptr)
-		return -1;
-
-	if ((fp = fopen(filename, "wb")) == nullptr)
-		return (-1);
-
-	for (unsigned short x = 0; x < width; x++)
-	{
-		unsigned pos1, pos2;
-		pos1 = 0;
-		for (unsigned short z = 0; z < nrslices; z++)
-		{
-			p_bits = bits_to_swap[z];
-			pos2 = z;
-			pos1 = x;
-			for (unsigned short y = 0; y < height; y++)
-			{
-				bits_tmp[pos2] = p_bits[pos1];
-				pos1 += width;
-				pos2 += nrslices;
-			}
-		}
-		if (fwrite(bits_tmp, 1, sizeof(float) * bitsize, fp) < sizeof(float) * bitsize)
-		{
-			fclose(fp);
-			return (-1);
-		}
-	}
-
-	free(bits_tmp);
-
-	fclose(fp);
-	return 0;
+	return SavePermutedRaw<float>(filename, std::vector<const float*>(bits_to_swap.begin(), bits_to_swap.end()), width, height, nrslices, {2, 1, 0});
 }
 
 int SlicesHandler::SaveRawYzSwapped(const char* filename, bool work)
 {
-	return SaveRawYzSwapped(filename, work ? TargetSlices() : SourceSlices(), m_Width, m_Height, m_Nrslices);
+	const SlicesHandler& handler = *this;
+	return SavePermutedRaw<float>(filename, work ? handler.TargetSlices() : handler.SourceSlices(), m_Width, m_Height, m_Nrslices, {0, 2, 1});
 }
 
-int SlicesHandler::SaveRawYzSwapped(const char* filename, std::vector<float*> bits_to_swap, short unsigned width, short unsigned height, short unsigned nrslices)
+int SlicesHandler::SaveRawYzSwapped(const char* filename, std::vector<float*> bits_to_swap, unsigned width, unsigned height, unsigned nrslices)
 {
-	FILE* fp;
-	float* bits_tmp;
-	float* p_bits;
-
-	const unsigned int bitsize = nrslices * (unsigned)width;
-	bits_tmp = (float*)malloc(sizeof(float) * bitsize);
-	if (bits_tmp == nullptr)
-		return -1;
-
-	if ((fp = fopen(filename, "wb")) == nullptr)
-		return (-1);
-
-	for (unsigned short y = 0; y < height; y++)
-	{
-		unsigned pos1, pos2;
-		pos1 = 0;
-		for (unsigned short z = 0; z < nrslices; z++)
-		{
-			p_bits = bits_to_swap[z];
-			pos2 = z * width;
-			pos1 = y * width;
-			for (unsigned short x = 0; x < width; x++)
-			{
-				bits_tmp[pos2] = p_bits[pos1];
-				pos1++;
-				pos2++;
-			}
-		}
-		if (fwrite(bits_tmp, 1, sizeof(float) * bitsize, fp) < sizeof(float) * bitsize)
-		{
-			fclose(fp);
-			return (-1);
-		}
-	}
-
-	free(bits_tmp);
-
-	fclose(fp);
-	return 0;
+	return SavePermutedRaw<float>(filename, std::vector<const float*>(bits_to_swap.begin(), bits_to_swap.end()), width, height, nrslices, {0, 2, 1});
 }
 
 int SlicesHandler::SaveTissuesRaw(const char* filename)
@@ -2895,9 +2950,9 @@ int SlicesHandler::SaveTissuesRaw(const char* filename)
 
 	unsigned int bitsize = m_Width * (unsigned)m_Height;
 
-	for (unsigned short j = 0; j < m_Nrslices; j++)
+	for (unsigned j = 0; j < m_Nrslices; j++)
 	{
-		bits_tmp = m_ImageSlices[j].ReturnTissues(m_ActiveTissuelayer);
+		bits_tmp = ImageSlice(j).ReturnTissues(m_ActiveTissuelayer);
 		if (fwrite(bits_tmp, sizeof(tissues_size_t), bitsize, fp) <
 				(unsigned int)bitsize)
 		{
@@ -2912,136 +2967,20 @@ int SlicesHandler::SaveTissuesRaw(const char* filename)
 
 int SlicesHandler::SaveTissuesRawXySwapped(const char* filename)
 {
-	FILE* fp;
-	tissues_size_t* bits_tmp;
-	tissues_size_t* p_bits;
+	const SlicesHandler& handler = *this;
+	return SavePermutedRaw<tissues_size_t>(filename, handler.TissueSlices(m_ActiveTissuelayer), m_Width, m_Height, m_Nrslices, {1, 0, 2});
+}
 
-	bits_tmp = (tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area);
-	if (bits_tmp == nullptr)
-		return -1;
-
-	if ((fp = fopen(filename, "wb")) == nullptr)
-		return (-1);
-
-	unsigned int bitsize = m_Width * (unsigned)m_Height;
-
-	for (unsigned short j = 0; j < m_Nrslices; j++)
-	{
-		p_bits = m_ImageSlices[j].ReturnTissues(m_ActiveTissuelayer); // TODO
-		unsigned pos1, pos2;
-		pos1 = 0;
-		for (unsigned short y = 0; y < m_Height; y++)
-		{
-			pos2 = y;
-			for (unsigned short x = 0; x < m_Width; x++)
-			{
-				bits_tmp[pos2] = p_bits[pos1];
-				pos1++;
-				pos2 += m_Height;
-			}
-		}
-		if (fwrite(bits_tmp, sizeof(tissues_size_t), bitsize, fp) <
-				(unsigned int)bitsize)
-		{
-			fclose(fp);
-			return (-1);
-		}
-	}
-
-	free(bits_tmp);
-
-	fclose(fp);
-	return 0;
-}
-
-int SlicesHandler::SaveTissuesRawXzSwapped(const char* filename)
-{
-	FILE* fp;
-	tissues_size_t* bits_tmp;
-	tissues_size_t* p_bits;
-
-	unsigned int bitsize = m_Nrslices * (unsigned)m_Height;
-	bits_tmp = (tissues_size_t*)malloc(sizeof(tissues_size_t) * bitsize);
-	if (bits_tmp == nullptr)
-		return -1;
-
-	if ((fp = fopen(filename, "wb")) == nullptr)
-		return (-1);
-
-	for (unsigned short x = 0; x < m_Width; x++)
-	{
-		unsigned pos1, pos2;
-		pos1 = 0;
-		for (unsigned short z = 0; z < m_Nrslices; z++)
-		{
-			p_bits =
-					(m_ImageSlices[z]).ReturnTissues(m_ActiveTissuelayer); // TODO
-			pos2 = z;
-			pos1 = x;
-			for (unsigned short y = 0; y < m_Height; y++)
-			{
-				bits_tmp[pos2] = p_bits[pos1];
-				pos1 += m_Width;
-				pos2 += m_Nrslices;
-			}
-		}
-		if (fwrite(bits_tmp, sizeof(tissues_size_t), bitsize, fp) <
-				(unsigned int)bitsize)
-		{
-			fclose(fp);
-			return (-1);
-		}
-	}
-
-	free(bits_tmp);
-
-	fclose(fp);
-	return 0;
-}
+int SlicesHandler::SaveTissuesRawXzSwapped(const char* filename)
+{
+	const SlicesHandler& handler = *this;
+	return SavePermutedRaw<tissues_size_t>(filename, handler.TissueSlices(m_ActiveTissuelayer), m_Width, m_Height, m_Nrslices, {2, 1, 0});
+}
 
 int SlicesHandler::SaveTissuesRawYzSwapped(const char* filename)
 {
-	FILE* fp;
-	tissues_size_t* bits_tmp;
-	tissues_size_t* p_bits;
-
-	unsigned int bitsize = m_Nrslices * (unsigned)m_Width;
-	bits_tmp = (tissues_size_t*)malloc(sizeof(tissues_size_t) * bitsize);
-	if (bits_tmp == nullptr)
-		return -1;
-
-	if ((fp = fopen(filename, "wb")) == nullptr)
-		return (-1);
-
-	for (unsigned short y = 0; y < m_Height; y++)
-	{
-		unsigned pos1, pos2;
-		pos1 = 0;
-		for (unsigned short z = 0; z < m_Nrslices; z++)
-		{
-			p_bits =
-					(m_ImageSlices[z]).ReturnTissues(m_ActiveTissuelayer); // TODO
-			pos2 = z * m_Width;
-			pos1 = y * m_Width;
-			for (unsigned short x = 0; x < m_Width; x++)
-			{
-				bits_tmp[pos2] = p_bits[pos1];
-				pos1++;
-				pos2++;
-			}
-		}
-		if (fwrite(bits_tmp, sizeof(tissues_size_t), bitsize, fp) <
-				(unsigned int)bitsize)
-		{
-			fclose(fp);
-			return (-1);
-		}
-	}
-
-	free(bits_tmp);
-
-	fclose(fp);
-	return 0;
+	const SlicesHandler& handler = *this;
+	return SavePermutedRaw<tissues_size_t>(filename, handler.TissueSlices(m_ActiveTissuelayer), m_Width, m_Height, m_Nrslices, {0, 2, 1});
 }
 
 int SlicesHandler::SaveBmpBitmap(const char* filename)
@@ -3049,10 +2988,10 @@ int SlicesHandler::SaveBmpBitmap(const char* filename)
 	char name[100];
 	int j = 0;
 
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
 		sprintf(name, "%s%u.bmp", filename, i);
-		j += m_ImageSlices[i].SaveDIBitmap(name);
+		j += ImageSlice(i).SaveDIBitmap(name);
 	}
 
 	if (j == 0)
@@ -3068,10 +3007,10 @@ int SlicesHandler::SaveWorkBitmap(const char* filename)
 	char name[100];
 	int j = 0;
 
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
 		sprintf(name, "%s%u.bmp", filename, i);
-		j += m_ImageSlices[i].SaveWorkBitmap(name);
+		j += ImageSlice(i).SaveWorkBitmap(name);
 	}
 
 	if (j == 0)
@@ -3087,10 +3026,10 @@ int SlicesHandler::SaveTissueBitmap(const char* filename)
 	char name[100];
 	int j = 0;
 
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
 		sprintf(name, "%s%u.bmp", filename, i);
-		j += m_ImageSlices[i].SaveTissueBitmap(m_ActiveTissuelayer, name);
+		j += ImageSlice(i).SaveTissueBitmap(m_ActiveTissuelayer, name);
 	}
 
 	if (j == 0)
@@ -3101,337 +3040,837 @@ int SlicesHandler::SaveTissueBitmap(const char* filename)
 		return 0;
 }
 
-void SlicesHandler::Work2bmp() { (m_ImageSlices[m_Activeslice]).Work2bmp(); }
+void SlicesHandler::Work2bmp() { (ImageSlice(m_Activeslice)).Work2bmp(); }
 
-void SlicesHandler::Bmp2work() { (m_ImageSlices[m_Activeslice]).Bmp2work(); }
+void SlicesHandler::Bmp2work() { (ImageSlice(m_Activeslice)).Bmp2work(); }
 
 void SlicesHandler::SwapBmpwork()
 {
-	(m_ImageSlices[m_Activeslice]).SwapBmpwork();
+	(ImageSlice(m_Activeslice)).SwapBmpwork();
 }
 
 void SlicesHandler::Work2bmpall()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].Work2bmp();
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).Work2bmp();
 }
 
 void SlicesHandler::Bmp2workall()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].Bmp2work();
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).Bmp2work();
 }
 
 void SlicesHandler::Work2tissueall()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].Work2tissue(m_ActiveTissuelayer);
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).Work2tissue(m_ActiveTissuelayer);
 }
 
 void SlicesHandler::Mergetissues(tissues_size_t tissuetype)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].Mergetissue(tissuetype, m_ActiveTissuelayer);
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).Mergetissue(tissuetype, m_ActiveTissuelayer);
 }
 
 void SlicesHandler::Tissue2workall()
 {
-	m_ImageSlices[m_Activeslice].Tissue2work(m_ActiveTissuelayer);
+	ImageSlice(m_Activeslice).Tissue2work(m_ActiveTissuelayer);
 }
 
 void SlicesHandler::Tissue2workall3D()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].Tissue2work(m_ActiveTissuelayer);
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).Tissue2work(m_ActiveTissuelayer);
 }
 
 void SlicesHandler::SwapBmpworkall()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].SwapBmpwork();
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).SwapBmpwork();
 }
 
 void SlicesHandler::AddMark(Point p, unsigned label, std::string str)
 {
-	(m_ImageSlices[m_Activeslice]).AddMark(p, label, str);
+	(ImageSlice(m_Activeslice)).AddMark(p, label, str);
 }
 
 void SlicesHandler::ClearMarks()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		(m_ImageSlices[i]).ClearMarks();
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		(ImageSlice(i)).ClearMarks();
 }
 
 bool SlicesHandler::RemoveMark(Point p, unsigned radius)
 {
-	return (m_ImageSlices[m_Activeslice]).RemoveMark(p, radius);
+	return (ImageSlice(m_Activeslice)).RemoveMark(p, radius);
 }
 
-void SlicesHandler::AddMark(Point p, unsigned label, unsigned short slicenr, std::string str)
+void SlicesHandler::AddMark(Point p, unsigned label, unsigned slicenr, std::string str)
 {
 	if (slicenr < m_Nrslices && slicenr >= 0)
-		(m_ImageSlices[slicenr]).AddMark(p, label, str);
+		(ImageSlice(slicenr)).AddMark(p, label, str);
 }
 
-bool SlicesHandler::RemoveMark(Point p, unsigned radius, unsigned short slicenr)
+bool SlicesHandler::RemoveMark(Point p, unsigned radius, unsigned slicenr)
 {
 	if (slicenr < m_Nrslices && slicenr >= 0)
-		return (m_ImageSlices[slicenr]).RemoveMark(p, radius);
+		return (ImageSlice(slicenr)).RemoveMark(p, radius);
 	else
 		return false;
 }
 
-void SlicesHandler::GetLabels(std::vector<AugmentedMark>* labels)
+void SlicesHandler::GetLabels(std::vector<AugmentedMark>* labels)
+{
+	labels->clear();
+	std::vector<Mark> labels1;
+	for (unsigned i = 0; i < m_Nrslices; i++)
+	{
+		ImageSlice(i).GetLabels(&labels1);
+		for (size_t j = 0; j < labels1.size(); j++)
+		{
+			AugmentedMark am;
+			am.mark = labels1[j].mark;
+			am.p = labels1[j].p;
+			am.name = labels1[j].name;
+			am.slicenr = i;
+			labels->push_back(am);
+		}
+	}
+}
+
+bool SlicesHandler::ExportMarkers(const char* filename)
+{
+	const auto tx = ImageTransform();
+	const auto sp = Spacing();
+
+	std::vector<std::pair<Vec3, Mark>> points;
+
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+	{
+		const std::vector<Mark>& marks = *(m_ImageSlices[i].ReturnMarks());
+		for (const auto& mark : marks)
+		{
+			const Vec3 p = {mark.p.px * sp[0], mark.p.py * sp[1], i * sp[2]};
+			points.push_back({tx.RigidTransformPoint(p), mark});
+		}
+	}
+
+	auto fp = fopen(filename, "w");
+	if (fp)
+	{
+		const auto ext = boost::filesystem::path(filename).extension().string();
+		if (ext == ".csv")
+		{
+			fprintf(fp, "# X, Y, Z, Label\n");
+			for (const auto& m : points)
+			{
+				fprintf(fp, "%g, %g, %g, %d\n", m.first[0], m.first[1], m.first[2], m.second.mark);
+			}
+		}
+		else // .pts format
+		{
+			fprintf(fp, "Version 1.0\n");
+			fprintf(fp, "%d\n", static_cast<int>(points.size()));
+			for (size_t idx = 0; idx < points.size(); ++idx)
+			{
+				const auto& m = points[idx];
+				auto name = m.second.name;
+				if (name.empty())
+				{
+					name = "Point " + std::to_string(idx + 1);
+				}
+				fprintf(fp, "%s %g %g %g\n", name.c_str(), m.first[0], m.first[1], m.first[2]);
+			}
+		}
+
+		fclose(fp);
+		return true;
+	}
+	return false;
+}
+
+bool SlicesHandler::ImportMarkers(const char* filename)
+{
+	namespace alg = boost::algorithm;
+	namespace fs = boost::filesystem;
+
+	std::vector<std::pair<std::string, Vec3>> landmarks;
+
+	const auto file_path = fs::path(filename).string();
+	std::ifstream ifs(file_path);
+	if (ifs.is_open())
+	{
+		auto ifs_guard = MakeScopeExit([&ifs]() { ifs.close(); });
+
+		try
+		{
+			int num_landmarks = 0;
+			std::string line;
+			for (size_t line_idx = 0; std::getline(ifs, line); ++line_idx)
+			{
+				alg::trim(line);
+
+				std::vector<std::string> tokens;
+				boost::split(tokens, line, boost::is_any_of("\t "), boost::token_compress_on);
+				if (line_idx == 0)
+				{
+					std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+					if (tokens.size() != 2 || !alg::starts_with(line, "version 1"))
+						throw std::runtime_error("Expecting 'Version 1.0' on first line");
+				}
+				else if (line_idx == 1)
+				{
+					if (tokens.size() != 1)
+						throw std::runtime_error("Second line should contain the number of landmarks");
+
+					num_landmarks = atoi(tokens[0].c_str());
+				}
+				else
+				{
+					if (tokens.size() >= 4)
+					{
+						const auto n = tokens.size();
+						const auto x = atof(tokens[n - 3].c_str());
+						const auto y = atof(tokens[n - 2].c_str());
+						const auto z = atof(tokens[n - 1].c_str());
+
+						tokens.resize(n - 3);
+						const auto name = boost::join(tokens, " ");
+
+						landmarks.push_back(std::make_pair(name, Vec3(x, y, z)));
+					}
+				}
+			}
+		}
+		catch (const std::exception& e)
+		{
+			ISEG_ERROR("Failed to load markers: " << e.what());
+			return false;
+		}
+
+		const auto tx = ImageTransform();
+		const auto sp = Spacing();
+
+		auto m = tx.ToVector();
+		vtkNew<vtkTransform> inverse_transform;
+		inverse_transform->SetMatrix(m.data());
+		inverse_transform->Inverse();
+
+		for (const auto& p : landmarks)
+		{
+			const auto pt = inverse_transform->TransformFloatPoint(p.second.v);
+			const short idx[3] = {
+					static_cast<short>(std::min(static_cast<int>(Width()) - 1, std::max(0, static_cast<int>(std::round(pt[0] / sp[0]))))),
+					static_cast<short>(std::min(static_cast<int>(Height()) - 1, std::max(0, static_cast<int>(std::round(pt[1] / sp[1]))))),
+					static_cast<short>(std::min(static_cast<int>(NumSlices()) - 1, std::max(0, static_cast<int>(std::round(pt[2] / sp[2])))))};
+			AddMark({idx[0], idx[1]}, Mark::red, idx[2], p.first);
+		}
+		return true;
+	}
+	return false;
+}
+
+void SlicesHandler::AddVm(std::vector<Mark>* vm1)
+{
+	(ImageSlice(m_Activeslice)).AddVm(vm1);
+}
+
+bool SlicesHandler::RemoveVm(Point p, unsigned radius)
+{
+	return (ImageSlice(m_Activeslice)).DelVm(p, radius);
+}
+
+void SlicesHandler::AddVm(std::vector<Mark>* vm1, unsigned slicenr)
+{
+	if (slicenr < m_Nrslices && slicenr >= 0)
+		(ImageSlice(slicenr)).AddVm(vm1);
+}
+
+bool SlicesHandler::RemoveVm(Point p, unsigned radius, unsigned slicenr)
+{
+	if (slicenr < m_Nrslices && slicenr >= 0)
+		return (ImageSlice(slicenr)).DelVm(p, radius);
+	else
+		return false;
+}
+
+void SlicesHandler::AddLimit(std::vector<Point>* vp1)
+{
+	(ImageSlice(m_Activeslice)).AddLimit(vp1);
+}
+
+bool SlicesHandler::RemoveLimit(Point p, unsigned radius)
+{
+	return (ImageSlice(m_Activeslice)).DelLimit(p, radius);
+}
+
+void SlicesHandler::AddLimit(std::vector<Point>* vp1, unsigned slicenr)
+{
+	if (slicenr < m_Nrslices && slicenr >= 0)
+		(ImageSlice(slicenr)).AddLimit(vp1);
+}
+
+bool SlicesHandler::RemoveLimit(Point p, unsigned radius, unsigned slicenr)
+{
+	if (slicenr < m_Nrslices && slicenr >= 0)
+		return (ImageSlice(slicenr)).DelLimit(p, radius);
+	else
+		return false;
+}
+
+void SlicesHandler::Newbmp(unsigned width1, unsigned height1, unsigned nrofslices, const std::function<void(float**)>& init_callback)
+{
+	m_Activeslice = 0;
+	m_Startslice = 0;
+	m_Endslice = m_Nrslices = nrofslices;
+	m_Os.SetSizenr(m_Nrslices);
+	m_ImageSlices.resize(nrofslices);
+
+	for (unsigned i = 0; i < m_Nrslices; i++)
+		ImageSlice(i).Newbmp(width1, height1);
+
+	// now that memory is allocated give callback a chance to 'initialize' the data
+	if (init_callback)
+	{
+		init_callback(SourceSlices().data());
+	}
+
+	// Ranges
+	Pair dummy;
+	m_SliceRanges.resize(nrofslices);
+	m_SliceBmpranges.resize(nrofslices);
+	ComputeRangeMode1(&dummy);
+	ComputeBmprangeMode1(&dummy);
+
+	m_Loaded = true;
+
+	m_Width = width1;
+	m_Height = height1;
+	m_Area = m_Height * (size_t)m_Width;
+	SetActiveTissuelayer(0);
+	UpdateVolumeStorage();
+
+	NewOverlay();
+}
+
+void SlicesHandler::Freebmp()
+{
+	for (unsigned i = 0; i < m_Nrslices; i++)
+		m_ImageSlices[i].Freebmp();
+	m_VolumeStorage.reset();
+	m_PageFile.reset();
+
+	m_Loaded = false;
+}
+
+void SlicesHandler::SetContiguousStorage(bool v)
+{
+	m_UseVolumeStorage = v;
+	UpdateVolumeStorage();
+}
+
+void SlicesHandler::SetCompressedTissues(bool v)
+{
+	m_CompressTissues = v;
+	if (m_CompressTissues)
+	{
+		PackTissues();
+	}
+	else
+	{
+		for (auto& slice : m_ImageSlices)
+		{
+			slice.UnpackTissues();
+		}
+	}
+}
+
+void SlicesHandler::PackTissues()
+{
+	if (!m_Loaded || !m_CompressTissues)
+		return;
+
+	int const i_n = static_cast<int>(m_ImageSlices.size());
+
+#pragma omp parallel for
+	for (int i = 0; i < i_n; i++)
+	{
+		// the active slice is accessed by the viewers and tools all the time
+		if (i != static_cast<int>(m_Activeslice))
+			m_ImageSlices[i].PackTissues();
+	}
+}
+
+void SlicesHandler::UpdateVolumeStorage()
+{
+	if (!m_UseVolumeStorage || !m_Loaded || m_ImageSlices.empty())
+	{
+		if (m_VolumeStorage)
+		{
+			for (auto& slice : m_ImageSlices)
+			{
+				slice.DetachStorage();
+			}
+			m_VolumeStorage.reset();
+		}
+		UpdatePaging();
+		return;
+	}
+
+	unsigned const w = static_cast<unsigned>(m_ImageSlices[0].ReturnWidth());
+	unsigned const h = static_cast<unsigned>(m_ImageSlices[0].ReturnHeight());
+	unsigned const n = static_cast<unsigned>(m_ImageSlices.size());
+
+	if (m_VolumeStorage && m_VolumeStorage->Width() == w && m_VolumeStorage->Height() == h && m_VolumeStorage->NumSlices() == n)
+	{
+		bool attached = true;
+		for (unsigned i = 0; i < n && attached; i++)
+		{
+			attached = m_ImageSlices[i].HasStorage() && ImageSlice(i).ReturnBmp() == m_VolumeStorage->Source(i);
+		}
+		if (attached)
+		{
+			SyncVolumeStorage();
+			return;
+		}
+	}
+
+	auto storage = std::make_unique<VolumeStorage>(w, h, n);
+	if (!storage->Valid())
+	{
+		ISEG_WARNING("Could not allocate contiguous volume storage (" << storage->MemoryUsage() << " bytes)");
+		for (auto& slice : m_ImageSlices)
+		{
+			slice.DetachStorage();
+		}
+		m_VolumeStorage.reset();
+		return;
+	}
+
+	for (unsigned i = 0; i < n; i++)
+	{
+		ImageSlice(i).AttachStorage(storage->Source(i), storage->Target(i), {storage->Tissues(0, i)});
+	}
+	m_VolumeStorage = std::move(storage);
+
+	// slices in a contiguous storage cannot be paged out
+	UpdatePaging();
+}
+
+void SlicesHandler::SyncVolumeStorage()
+{
+	// only slices whose buffers were swapped or replaced since the last sync are copied back
+	std::vector<int> modified;
+	for (size_t i = 0; i < m_ImageSlices.size(); i++)
+	{
+		if (!m_ImageSlices[i].StorageInSync())
+			modified.push_back(static_cast<int>(i));
+	}
+
+	int const i_n = static_cast<int>(modified.size());
+#pragma omp parallel for
+	for (int i = 0; i < i_n; i++)
+	{
+		m_ImageSlices[modified[i]].SyncStorage();
+	}
+}
+
+float* SlicesHandler::SourceVolume()
+{
+	if (!m_VolumeStorage)
+		return nullptr;
+	SyncVolumeStorage();
+	return m_VolumeStorage->Source();
+}
+
+float* SlicesHandler::TargetVolume()
+{
+	if (!m_VolumeStorage)
+		return nullptr;
+	SyncVolumeStorage();
+	return m_VolumeStorage->Target();
+}
+
+tissues_size_t* SlicesHandler::TissueVolume(tissuelayers_size_t layeridx)
+{
+	if (!m_VolumeStorage)
+		return nullptr;
+	SyncVolumeStorage();
+	return m_VolumeStorage->Tissues(layeridx);
+}
+
+Bmphandler& SlicesHandler::ImageSlice(unsigned slicenr)
+{
+	if (m_PageFile)
+	{
+		PageIn(slicenr);
+	}
+	// the caller may modify the slice, i.e. buffers shared with a save snapshot are copied now
+	m_ImageSlices[slicenr].Unshare();
+	return m_ImageSlices[slicenr];
+}
+
+const Bmphandler& SlicesHandler::ImageSlice(unsigned slicenr) const
+{
+	if (m_PageFile)
+	{
+		// paging in does not modify the volume
+		const_cast<SlicesHandler*>(this)->PageIn(slicenr);
+	}
+	return m_ImageSlices[slicenr];
+}
+
+void SlicesHandler::ReleaseZeroTargets()
+{
+	for (auto& slice : m_ImageSlices)
+	{
+		if (!slice.IsPagedOut())
+			slice.ReleaseWorkIfZero();
+	}
+}
+
+float* SlicesHandler::WorkForReading(unsigned slicenr) const
+{
+	// an unallocated target is not materialized, the savers only read from the slices
+	return const_cast<float*>(ImageSlice(slicenr).ReturnWork());
+}
+
+void SlicesHandler::SetPagingBudget(size_t bytes)
+{
+	m_PagingBudget = bytes;
+	UpdatePaging();
+}
+
+size_t SlicesHandler::GetStackBudget() const
+{
+	return Bmphandler::Stack().MemoryBudget();
+}
+
+void SlicesHandler::SetStackBudget(size_t bytes)
+{
+	Bmphandler::Stack().SetMemoryBudget(bytes);
+}
+
+void SlicesHandler::ResetCacheCounters()
+{
+	m_CacheHits = m_CacheMisses = 0;
+}
+
+void SlicesHandler::PageIn(unsigned slicenr)
 {
-	labels->clear();
-	std::vector<Mark> labels1;
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	std::lock_guard<std::mutex> lock(m_PagingMutex);
+
+	// slices added after the page file was created are not paged yet
+	if (slicenr >= m_SliceLastUse.size())
+		return;
+
+	m_SliceLastUse[slicenr] = ++m_SliceUseCounter;
+	auto& slice = m_ImageSlices[slicenr];
+	if (!slice.IsPagedOut())
 	{
-		m_ImageSlices[i].GetLabels(&labels1);
-		for (size_t j = 0; j < labels1.size(); j++)
+		++m_CacheHits;
+		return;
+	}
+	++m_CacheMisses;
+	++m_ResidentSlices;
+
+	// only slices with a single tissue layer are paged out, see Bmphandler::CanPageOut
+	slice.PageIn();
+	float* bmp = slice.ReturnBmp();
+	float* work = slice.ReturnWork();
+	tissues_size_t* tissues = slice.ReturnTissues(0);
+	size_t const area = slice.ReturnArea();
+	if (m_PageFile->Read(slicenr, bmp, work, tissues))
+	{
+		m_SliceHash[slicenr] = SlicePageFile::Hash(bmp, work, tissues, area);
+	}
+	else
+	{
+		if (m_PageFile->Contains(slicenr))
 		{
-			AugmentedMark am;
-			am.mark = labels1[j].mark;
-			am.p = labels1[j].p;
-			am.name = labels1[j].name;
-			am.slicenr = i;
-			labels->push_back(am);
+			ISEG_ERROR("could not read slice " << slicenr << " from " << m_PageFile->FileName());
 		}
+		std::fill(bmp, bmp + area, 0.f);
+		std::fill(work, work + area, 0.f);
+		std::fill(tissues, tissues + area, 0);
+		m_SliceHash[slicenr] = 0;
 	}
+	slice.ReleaseWorkIfZero();
 }
 
-bool SlicesHandler::ExportMarkers(const char* filename)
+void SlicesHandler::PageOut(unsigned slicenr)
 {
-	const auto tx = ImageTransform();
-	const auto sp = Spacing();
-
-	std::vector<std::pair<Vec3, Mark>> points;
+	auto& slice = m_ImageSlices[slicenr];
+	if (!slice.CanPageOut())
+		return;
 
-	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+	// only modified slices need to be written, the others are still in the page file or the origin
+	const auto& cslice = slice;
+	const float* bmp = cslice.ReturnBmp();
+	const float* work = cslice.ReturnWork();
+	const tissues_size_t* tissues = cslice.ReturnTissues(0);
+	if (m_SliceHash[slicenr] == 0 || !m_PageFile->Contains(slicenr) ||
+			m_SliceHash[slicenr] != SlicePageFile::Hash(bmp, work, tissues, slice.ReturnArea()))
 	{
-		const std::vector<Mark>& marks = *(m_ImageSlices[i].ReturnMarks());
-		for (const auto& mark : marks)
+		if (!m_PageFile->Write(slicenr, bmp, work, tissues))
 		{
-			const Vec3 p = {mark.p.px * sp[0], mark.p.py * sp[1], i * sp[2]};
-			points.push_back({tx.RigidTransformPoint(p), mark});
+			ISEG_ERROR("could not write slice " << slicenr << " to " << m_PageFile->FileName());
+			return;
 		}
 	}
+	slice.PageOut();
+	--m_ResidentSlices;
+}
 
-	auto fp = fopen(filename, "w");
-	if (fp)
+bool SlicesHandler::ResetPageFile()
+{
+	m_PageFile.reset();
+
+	unsigned const n = static_cast<unsigned>(m_ImageSlices.size());
+	auto page_file = std::make_unique<SlicePageFile>(m_ImageSlices[0].ReturnWidth(), m_ImageSlices[0].ReturnHeight(), n);
+	if (!page_file->Valid())
 	{
-		const auto ext = boost::filesystem::path(filename).extension().string();
-		if (ext == ".csv")
+		ISEG_WARNING_MSG("could not create page file, all slices are kept in memory");
+		return false;
+	}
+
+	m_PageFile = std::move(page_file);
+	m_SliceLastUse.assign(n, 0);
+	m_SliceHash.assign(n, 0);
+	return true;
+}
+
+void SlicesHandler::UpdatePaging()
+{
+	if (m_PagingBudget == 0 || !m_Loaded || m_ImageSlices.empty() || m_VolumeStorage)
+	{
+		if (m_PageFile)
 		{
-			fprintf(fp, "# X, Y, Z, Label\n");
-			for (const auto& m : points)
+			for (unsigned i = 0; i < m_ImageSlices.size(); i++)
 			{
-				fprintf(fp, "%g, %g, %g, %d\n", m.first[0], m.first[1], m.first[2], m.second.mark);
+				PageIn(i);
 			}
+			m_PageFile.reset();
 		}
-		else // .pts format
+		return;
+	}
+
+	if (!m_PageFile || m_PageFile->NumSlices() != m_ImageSlices.size() ||
+			m_PageFile->Width() != m_ImageSlices[0].ReturnWidth() || m_PageFile->Height() != m_ImageSlices[0].ReturnHeight())
+	{
+		// slices paged out to the old page file are needed again
+		if (m_PageFile)
 		{
-			fprintf(fp, "Version 1.0\n");
-			fprintf(fp, "%d\n", static_cast<int>(points.size()));
-			for (size_t idx = 0; idx < points.size(); ++idx)
+			for (unsigned i = 0; i < m_ImageSlices.size(); i++)
 			{
-				const auto& m = points[idx];
-				auto name = m.second.name;
-				if (name.empty())
-				{
-					name = "Point " + std::to_string(idx + 1);
-				}
-				fprintf(fp, "%s %g %g %g\n", name.c_str(), m.first[0], m.first[1], m.first[2]);
+				PageIn(i);
 			}
 		}
-
-		fclose(fp);
-		return true;
+		if (!ResetPageFile())
+			return;
 	}
-	return false;
+	m_ResidentSlices = std::count_if(m_ImageSlices.begin(), m_ImageSlices.end(), [](const Bmphandler& slice) { return !slice.IsPagedOut(); });
+	TrimSliceCache();
 }
 
-bool SlicesHandler::ImportMarkers(const char* filename)
+void SlicesHandler::ReleasePagingOrigin()
 {
-	namespace alg = boost::algorithm;
-	namespace fs = boost::filesystem;
-
-	std::vector<std::pair<std::string, Vec3>> landmarks;
+	if (!m_PageFile || !m_PageFile->HasOrigin())
+		return;
 
-	const auto file_path = fs::path(filename).string();
-	std::ifstream ifs(file_path);
-	if (ifs.is_open())
+	// the file might be overwritten, restore the slices which have not been modified since loading
+	for (unsigned i = 0; i < m_ImageSlices.size(); i++)
 	{
-		auto ifs_guard = MakeScopeExit([&ifs]() { ifs.close(); });
-
-		try
-		{
-			int num_landmarks = 0;
-			std::string line;
-			for (size_t line_idx = 0; std::getline(ifs, line); ++line_idx)
-			{
-				alg::trim(line);
+		PageIn(i);
+	}
+	m_PageFile->ResetOrigin();
+}
 
-				std::vector<std::string> tokens;
-				boost::split(tokens, line, boost::is_any_of("\t "), boost::token_compress_on);
-				if (line_idx == 0)
-				{
-					std::transform(line.begin(), line.end(), line.begin(), ::tolower);
-					if (tokens.size() != 2 || !alg::starts_with(line, "version 1"))
-						throw std::runtime_error("Expecting 'Version 1.0' on first line");
-				}
-				else if (line_idx == 1)
-				{
-					if (tokens.size() != 1)
-						throw std::runtime_error("Second line should contain the number of landmarks");
+SlicesHandler::SavedProject SlicesHandler::FingerprintSlices(const std::vector<float*>& bmpslices, const std::vector<float*>& workslices, const std::vector<tissues_size_t*>& tissueslices, unsigned width, unsigned height)
+{
+	SavedProject saved;
+	saved.m_Width = width;
+	saved.m_Height = height;
+	saved.m_Source.resize(bmpslices.size());
+	saved.m_Target.resize(workslices.size());
+	saved.m_Tissue.resize(tissueslices.size());
 
-					num_landmarks = atoi(tokens[0].c_str());
-				}
-				else
-				{
-					if (tokens.size() >= 4)
-					{
-						const auto n = tokens.size();
-						const auto x = atof(tokens[n - 3].c_str());
-						const auto y = atof(tokens[n - 2].c_str());
-						const auto z = atof(tokens[n - 1].c_str());
+	size_t const area = static_cast<size_t>(width) * height;
+	int const n = static_cast<int>(bmpslices.size());
+#pragma omp parallel for
+	for (int i = 0; i < n; i++)
+	{
+		saved.m_Source[i] = SlicePageFile::Hash(bmpslices[i], nullptr, nullptr, area);
+		saved.m_Target[i] = SlicePageFile::Hash(nullptr, workslices[i], nullptr, area);
+		saved.m_Tissue[i] = SlicePageFile::Hash(nullptr, nullptr, tissueslices[i], area);
+	}
+	return saved;
+}
 
-						tokens.resize(n - 3);
-						const auto name = boost::join(tokens, " ");
+size_t SlicesHandler::KeepModifiedSlices(const SavedProject& saved, const SavedProject& previous, bool save_work, std::vector<float*>& bmpslices, std::vector<float*>& workslices, std::vector<tissues_size_t*>& tissueslices, std::vector<float>& zeros)
+{
+	size_t modified = 0;
+	for (size_t i = 0; i < bmpslices.size(); i++)
+	{
+		if (saved.m_Source[i] != previous.m_Source[i])
+			modified++;
+		else
+			bmpslices[i] = nullptr;
 
-						landmarks.push_back(std::make_pair(name, Vec3(x, y, z)));
-					}
-				}
-			}
-		}
-		catch (const std::exception& e)
+		if (save_work && saved.m_Target[i] != previous.m_Target[i])
 		{
-			ISEG_ERROR("Failed to load markers: " << e.what());
-			return false;
+			// an unallocated target replaces a written one
+			if (workslices[i] == nullptr && zeros.empty())
+				zeros.assign(static_cast<size_t>(saved.m_Width) * saved.m_Height, 0.f);
+			if (workslices[i] == nullptr)
+				workslices[i] = zeros.data();
+			modified++;
 		}
-
-		const auto tx = ImageTransform();
-		const auto sp = Spacing();
-
-		auto m = tx.ToVector();
-		vtkNew<vtkTransform> inverse_transform;
-		inverse_transform->SetMatrix(m.data());
-		inverse_transform->Inverse();
-
-		for (const auto& p : landmarks)
+		else
 		{
-			const auto pt = inverse_transform->TransformFloatPoint(p.second.v);
-			const short idx[3] = {
-					static_cast<short>(std::min(static_cast<int>(Width()) - 1, std::max(0, static_cast<int>(std::round(pt[0] / sp[0]))))),
-					static_cast<short>(std::min(static_cast<int>(Height()) - 1, std::max(0, static_cast<int>(std::round(pt[1] / sp[1]))))),
-					static_cast<short>(std::min(static_cast<int>(NumSlices()) - 1, std::max(0, static_cast<int>(std::round(pt[2] / sp[2])))))};
-			AddMark({idx[0], idx[1]}, Mark::red, idx[2], p.first);
+			workslices[i] = nullptr;
 		}
-		return true;
-	}
-	return false;
-}
 
-void SlicesHandler::AddVm(std::vector<Mark>* vm1)
-{
-	(m_ImageSlices[m_Activeslice]).AddVm(vm1);
-}
-
-bool SlicesHandler::RemoveVm(Point p, unsigned radius)
-{
-	return (m_ImageSlices[m_Activeslice]).DelVm(p, radius);
+		if (saved.m_Tissue[i] != previous.m_Tissue[i])
+			modified++;
+		else
+			tissueslices[i] = nullptr;
+	}
+	return modified;
 }
 
-void SlicesHandler::AddVm(std::vector<Mark>* vm1, unsigned short slicenr)
+bool SlicesHandler::PrepareIncrementalSave(const std::string& h5file, int compression, bool save_work, std::string& from)
 {
-	if (slicenr < m_Nrslices && slicenr >= 0)
-		(m_ImageSlices[slicenr]).AddVm(vm1);
-}
+	auto const& saved = m_SavedProject;
+	if (saved.m_File.empty() || saved.m_Width != m_Width || saved.m_Height != m_Height || saved.m_Source.size() != m_Nrslices ||
+			saved.m_Compression != compression || saved.m_SaveWork != save_work)
+	{
+		return false;
+	}
+	// the copy of an uncompressed volume writes as much as writing it
+	if (compression == 0)
+	{
+		return false;
+	}
+	// chunks which grow are appended to the file, writing it completely compacts it again
+	if (saved.m_Rewritten >= 3 * static_cast<size_t>(m_Nrslices))
+	{
+		return false;
+	}
 
-bool SlicesHandler::RemoveVm(Point p, unsigned radius, unsigned short slicenr)
-{
-	if (slicenr < m_Nrslices && slicenr >= 0)
-		return (m_ImageSlices[slicenr]).DelVm(p, radius);
-	else
+	// the project is saved into a 'Temp' file, which replaces the project file afterwards
+	auto real_name = [](const QString& path) {
+		QFileInfo info(path);
+		QString basename = info.completeBaseName();
+		if (basename.endsWith("Temp"))
+			basename.chop(4);
+		return info.dir().absoluteFilePath(basename + "." + info.suffix());
+	};
+	QString const target = QString::fromStdString(h5file);
+	QString location = QString::fromStdString(saved.m_File);
+	if (!QFileInfo(location).exists())
+	{
+		location = real_name(location);
+	}
+	if (real_name(location) != real_name(target))
+	{
 		return false;
-}
+	}
 
-void SlicesHandler::AddLimit(std::vector<Point>* vp1)
-{
-	(m_ImageSlices[m_Activeslice]).AddLimit(vp1);
+	// the file must not have been changed since
+	QFileInfo info(location);
+	if (!info.exists() || info.size() != saved.m_FileSize || info.lastModified().toTime_t() != saved.m_FileTime)
+	{
+		return false;
+	}
+	// the project file stays as it is until the 'Temp' file replaces it, i.e. a failed or canceled save keeps it intact
+	from = location.toStdString();
+	return true;
 }
 
-bool SlicesHandler::RemoveLimit(Point p, unsigned radius)
+void SlicesHandler::RecordSavedProject(SavedProject&& saved, const std::string& h5file, int compression, bool save_work)
 {
-	return (m_ImageSlices[m_Activeslice]).DelLimit(p, radius);
-}
+	QFileInfo info(QString::fromStdString(h5file));
+	if (!info.exists())
+	{
+		m_SavedProject = SavedProject();
+		return;
+	}
 
-void SlicesHandler::AddLimit(std::vector<Point>* vp1, unsigned short slicenr)
-{
-	if (slicenr < m_Nrslices && slicenr >= 0)
-		(m_ImageSlices[slicenr]).AddLimit(vp1);
+	m_SavedProject = std::move(saved);
+	m_SavedProject.m_File = h5file;
+	m_SavedProject.m_FileSize = info.size();
+	m_SavedProject.m_FileTime = info.lastModified().toTime_t();
+	m_SavedProject.m_Compression = compression;
+	m_SavedProject.m_SaveWork = save_work;
 }
 
-bool SlicesHandler::RemoveLimit(Point p, unsigned radius, unsigned short slicenr)
+void SlicesHandler::TrimSliceCache()
 {
-	if (slicenr < m_Nrslices && slicenr >= 0)
-		return (m_ImageSlices[slicenr]).DelLimit(p, radius);
-	else
-		return false;
-}
+	if (!m_PageFile)
+		return;
 
-void SlicesHandler::Newbmp(unsigned short width1, unsigned short height1, unsigned short nrofslices, const std::function<void(float**)>& init_callback)
-{
-	m_Activeslice = 0;
-	m_Startslice = 0;
-	m_Endslice = m_Nrslices = nrofslices;
-	m_Os.SetSizenr(m_Nrslices);
-	m_ImageSlices.resize(nrofslices);
+	std::lock_guard<std::mutex> lock(m_PagingMutex);
 
-	for (unsigned short i = 0; i < m_Nrslices; i++)
-		m_ImageSlices[i].Newbmp(width1, height1);
+	size_t const slice_bytes = m_ImageSlices[0].ReturnArea() * (3 * sizeof(float) + sizeof(tissues_size_t));
+	size_t const max_resident = std::max<size_t>(m_PagingBudget / std::max<size_t>(slice_bytes, 1), 2 * m_PagingReadAhead + 1);
+	if (m_ResidentSlices <= max_resident)
+		return;
 
-	// now that memory is allocated give callback a chance to 'initialize' the data
-	if (init_callback)
+	std::vector<unsigned> candidates;
+	for (unsigned i = 0; i < m_ImageSlices.size(); i++)
 	{
-		init_callback(SourceSlices().data());
+		unsigned const distance = i > m_Activeslice ? i - m_Activeslice : m_Activeslice - i;
+		if (distance > m_PagingReadAhead && m_ImageSlices[i].CanPageOut())
+		{
+			candidates.push_back(i);
+		}
 	}
+	std::sort(candidates.begin(), candidates.end(), [this](unsigned a, unsigned b) { return m_SliceLastUse[a] < m_SliceLastUse[b]; });
 
-	// Ranges
-	Pair dummy;
-	m_SliceRanges.resize(nrofslices);
-	m_SliceBmpranges.resize(nrofslices);
-	ComputeRangeMode1(&dummy);
-	ComputeBmprangeMode1(&dummy);
-
-	m_Loaded = true;
-
-	m_Width = width1;
-	m_Height = height1;
-	m_Area = m_Height * (unsigned int)m_Width;
-	SetActiveTissuelayer(0);
-
-	NewOverlay();
+	for (auto i : candidates)
+	{
+		if (m_ResidentSlices <= max_resident)
+			break;
+		PageOut(i);
+	}
 }
 
-void SlicesHandler::Freebmp()
+bool SlicesHandler::SetPagingOrigin(const std::string& filename, const std::string& source, const std::string& target, const std::string& tissue)
 {
-	for (unsigned short i = 0; i < m_Nrslices; i++)
-		m_ImageSlices[i].Freebmp();
+	if (!m_PageFile || !m_PageFile->SetOrigin(filename, source, target, tissue))
+		return false;
 
-	m_Loaded = false;
+	std::lock_guard<std::mutex> lock(m_PagingMutex);
+
+	// slices which are in memory are replaced by the file content as well. The project
+	// file holds the first tissue layer only, additional layers are kept.
+	for (unsigned i = 0; i < m_ImageSlices.size(); i++)
+	{
+		auto& slice = m_ImageSlices[i];
+		if (!slice.IsPagedOut())
+		{
+			float* bmp = slice.ReturnBmp();
+			float* work = slice.ReturnWork();
+			tissues_size_t* tissues = slice.ReturnTissues(0);
+			m_PageFile->Read(i, bmp, work, tissues);
+			m_SliceHash[i] = SlicePageFile::Hash(bmp, work, tissues, slice.ReturnArea());
+		}
+	}
+	return true;
 }
 
 void SlicesHandler::ClearBmp()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].ClearBmp();
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).ClearBmp();
 }
 
 void SlicesHandler::ClearWork()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].ClearWork();
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).ClearWork();
 }
 
 void SlicesHandler::ClearOverlay()
@@ -3448,61 +3887,61 @@ void SlicesHandler::NewOverlay()
 	ClearOverlay();
 }
 
-void SlicesHandler::SetBmp(unsigned short slicenr, float* bits, unsigned char mode)
+void SlicesHandler::SetBmp(unsigned slicenr, float* bits, unsigned char mode)
 {
-	(m_ImageSlices[slicenr]).SetBmp(bits, mode);
+	(ImageSlice(slicenr)).SetBmp(bits, mode);
 }
 
-void SlicesHandler::SetWork(unsigned short slicenr, float* bits, unsigned char mode)
+void SlicesHandler::SetWork(unsigned slicenr, float* bits, unsigned char mode)
 {
-	(m_ImageSlices[slicenr]).SetWork(bits, mode);
+	(ImageSlice(slicenr)).SetWork(bits, mode);
 }
 
-void SlicesHandler::SetTissue(unsigned short slicenr, tissues_size_t* bits)
+void SlicesHandler::SetTissue(unsigned slicenr, tissues_size_t* bits)
 {
-	(m_ImageSlices[slicenr]).SetTissue(m_ActiveTissuelayer, bits);
+	(ImageSlice(slicenr)).SetTissue(m_ActiveTissuelayer, bits);
 }
 
-void SlicesHandler::Copy2bmp(unsigned short slicenr, float* bits, unsigned char mode)
+void SlicesHandler::Copy2bmp(unsigned slicenr, float* bits, unsigned char mode)
 {
-	(m_ImageSlices[slicenr]).Copy2bmp(bits, mode);
+	(ImageSlice(slicenr)).Copy2bmp(bits, mode);
 }
 
-void SlicesHandler::Copy2work(unsigned short slicenr, float* bits, unsigned char mode)
+void SlicesHandler::Copy2work(unsigned slicenr, float* bits, unsigned char mode)
 {
-	(m_ImageSlices[slicenr]).Copy2work(bits, mode);
+	(ImageSlice(slicenr)).Copy2work(bits, mode);
 }
 
-void SlicesHandler::Copy2tissue(unsigned short slicenr, tissues_size_t* bits)
+void SlicesHandler::Copy2tissue(unsigned slicenr, tissues_size_t* bits)
 {
-	(m_ImageSlices[slicenr]).Copy2tissue(m_ActiveTissuelayer, bits);
+	(ImageSlice(slicenr)).Copy2tissue(m_ActiveTissuelayer, bits);
 }
 
-void SlicesHandler::Copyfrombmp(unsigned short slicenr, float* bits)
+void SlicesHandler::Copyfrombmp(unsigned slicenr, float* bits)
 {
-	(m_ImageSlices[slicenr]).Copyfrombmp(bits);
+	(ImageSlice(slicenr)).Copyfrombmp(bits);
 }
 
-void SlicesHandler::Copyfromwork(unsigned short slicenr, float* bits)
+void SlicesHandler::Copyfromwork(unsigned slicenr, float* bits)
 {
-	(m_ImageSlices[slicenr]).Copyfromwork(bits);
+	(ImageSlice(slicenr)).Copyfromwork(bits);
 }
 
-void SlicesHandler::Copyfromtissue(unsigned short slicenr, tissues_size_t* bits)
+void SlicesHandler::Copyfromtissue(unsigned slicenr, tissues_size_t* bits)
 {
-	(m_ImageSlices[slicenr]).Copyfromtissue(m_ActiveTissuelayer, bits);
+	(ImageSlice(slicenr)).Copyfromtissue(m_ActiveTissuelayer, bits);
 }
 
 #ifdef TISSUES_SIZE_TYPEDEF
-void SlicesHandler::Copyfromtissue(unsigned short slicenr, unsigned char* bits)
+void SlicesHandler::Copyfromtissue(unsigned slicenr, unsigned char* bits)
 {
-	(m_ImageSlices[slicenr]).Copyfromtissue(m_ActiveTissuelayer, bits);
+	(ImageSlice(slicenr)).Copyfromtissue(m_ActiveTissuelayer, bits);
 }
 #endif // TISSUES_SIZE_TYPEDEF
 
-void SlicesHandler::Copyfromtissuepadded(unsigned short slicenr, tissues_size_t* bits, unsigned short padding)
+void SlicesHandler::Copyfromtissuepadded(unsigned slicenr, tissues_size_t* bits, unsigned padding)
 {
-	(m_ImageSlices[slicenr])
+	(ImageSlice(slicenr))
 			.Copyfromtissuepadded(m_ActiveTissuelayer, bits, padding);
 }
 
@@ -3513,17 +3952,17 @@ unsigned int SlicesHandler::MakeHistogram(bool includeoutofrange)
 	unsigned int* dummy;
 	unsigned int l = 0;
 
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		l += m_ImageSlices[i].MakeHistogram(includeoutofrange);
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		l += ImageSlice(i).MakeHistogram(includeoutofrange);
 
-	dummy = (m_ImageSlices[m_Startslice]).ReturnHistogram();
-	for (unsigned short i = 0; i < 255; i++)
+	dummy = (ImageSlice(m_Startslice)).ReturnHistogram();
+	for (unsigned i = 0; i < 255; i++)
 		histogram[i] = dummy[i];
 
-	for (unsigned short j = m_Startslice + 1; j < m_Endslice; j++)
+	for (unsigned j = m_Startslice + 1; j < m_Endslice; j++)
 	{
-		dummy = m_ImageSlices[j].ReturnHistogram();
-		for (unsigned short i = 0; i < 255; i++)
+		dummy = ImageSlice(j).ReturnHistogram();
+		for (unsigned i = 0; i < 255; i++)
 			histogram[i] += dummy[i];
 	}
 
@@ -3532,25 +3971,25 @@ unsigned int SlicesHandler::MakeHistogram(bool includeoutofrange)
 
 unsigned int SlicesHandler::ReturnArea()
 {
-	return (m_ImageSlices[0]).ReturnArea();
+	return (ImageSlice(0)).ReturnArea();
 }
 
-unsigned short SlicesHandler::Width() const { return m_Width; }
+unsigned SlicesHandler::Width() const { return m_Width; }
 
-unsigned short SlicesHandler::Height() const { return m_Height; }
+unsigned SlicesHandler::Height() const { return m_Height; }
 
-unsigned short SlicesHandler::NumSlices() const { return m_Nrslices; }
+unsigned SlicesHandler::NumSlices() const { return m_Nrslices; }
 
-unsigned short SlicesHandler::StartSlice() const { return m_Startslice; }
+unsigned SlicesHandler::StartSlice() const { return m_Startslice; }
 
-unsigned short SlicesHandler::EndSlice() const { return m_Endslice; }
+unsigned SlicesHandler::EndSlice() const { return m_Endslice; }
 
-void SlicesHandler::SetStartslice(unsigned short startslice1)
+void SlicesHandler::SetStartslice(unsigned startslice1)
 {
 	m_Startslice = startslice1;
 }
 
-void SlicesHandler::SetEndslice(unsigned short endslice1)
+void SlicesHandler::SetEndslice(unsigned endslice1)
 {
 	m_Endslice = endslice1;
 }
@@ -3559,8 +3998,8 @@ bool SlicesHandler::Isloaded() const { return m_Loaded; }
 
 void SlicesHandler::Gaussian(float sigma)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].Gaussian(sigma);
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).Gaussian(sigma);
 }
 
 void SlicesHandler::FillHoles(float f, int minsize)
@@ -3570,7 +4009,7 @@ void SlicesHandler::FillHoles(float f, int minsize)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].FillHoles(f, minsize);
+		ImageSlice(i).FillHoles(f, minsize);
 	}
 }
 
@@ -3581,7 +4020,7 @@ void SlicesHandler::FillHolestissue(tissues_size_t f, int minsize)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].FillHolestissue(m_ActiveTissuelayer, f, minsize);
+		ImageSlice(i).FillHolestissue(m_ActiveTissuelayer, f, minsize);
 	}
 }
 
@@ -3592,7 +4031,7 @@ void SlicesHandler::RemoveIslands(float f, int minsize)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].RemoveIslands(f, minsize);
+		ImageSlice(i).RemoveIslands(f, minsize);
 	}
 }
 
@@ -3603,7 +4042,7 @@ void SlicesHandler::RemoveIslandstissue(tissues_size_t f, int minsize)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].RemoveIslandstissue(m_ActiveTissuelayer, f, minsize);
+		ImageSlice(i).RemoveIslandstissue(m_ActiveTissuelayer, f, minsize);
 	}
 }
 
@@ -3614,7 +4053,7 @@ void SlicesHandler::FillGaps(int minsize, bool connectivity)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].FillGaps(minsize, connectivity);
+		ImageSlice(i).FillGaps(minsize, connectivity);
 	}
 }
 
@@ -3625,14 +4064,14 @@ void SlicesHandler::FillGapstissue(int minsize, bool connectivity)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].FillGapstissue(m_ActiveTissuelayer, minsize, connectivity);
+		ImageSlice(i).FillGapstissue(m_ActiveTissuelayer, minsize, connectivity);
 	}
 }
 
 bool SlicesHandler::ValueAtBoundary3D(float value)
 {
 	// Top
-	float* tmp = &(m_ImageSlices[m_Startslice].ReturnWork()[0]);
+	float* tmp = &(ImageSlice(m_Startslice).ReturnWork()[0]);
 	for (unsigned pos = 0; pos < m_Area; pos++, tmp++)
 	{
 		if (*tmp == value)
@@ -3642,16 +4081,16 @@ bool SlicesHandler::ValueAtBoundary3D(float value)
 	}
 
 	// Sides
-	for (unsigned short i = m_Startslice + 1; i < m_Endslice - 1; i++)
+	for (unsigned i = m_Startslice + 1; i < m_Endslice - 1; i++)
 	{
-		if (m_ImageSlices[i].ValueAtBoundary(value))
+		if (ImageSlice(i).ValueAtBoundary(value))
 		{
 			return true;
 		}
 	}
 
 	// Bottom
-	tmp = &(m_ImageSlices[m_Endslice - 1].ReturnWork()[0]);
+	tmp = &(ImageSlice(m_Endslice - 1).ReturnWork()[0]);
 	for (unsigned pos = 0; pos < m_Area; pos++, tmp++)
 	{
 		if (*tmp == value)
@@ -3666,7 +4105,7 @@ bool SlicesHandler::ValueAtBoundary3D(float value)
 bool SlicesHandler::TissuevalueAtBoundary3D(tissues_size_t value)
 {
 	// Top
-	tissues_size_t* tmp = &(m_ImageSlices[m_Startslice].ReturnTissues(m_ActiveTissuelayer)[0]);
+	tissues_size_t* tmp = &(ImageSlice(m_Startslice).ReturnTissues(m_ActiveTissuelayer)[0]);
 	for (unsigned pos = 0; pos < m_Area; pos++, tmp++)
 	{
 		if (*tmp == value)
@@ -3676,9 +4115,9 @@ bool SlicesHandler::TissuevalueAtBoundary3D(tissues_size_t value)
 	}
 
 	// Sides
-	for (unsigned short i = m_Startslice + 1; i < m_Endslice - 1; i++)
+	for (unsigned i = m_Startslice + 1; i < m_Endslice - 1; i++)
 	{
-		if (m_ImageSlices[i]
+		if (ImageSlice(i)
 						.TissuevalueAtBoundary(m_ActiveTissuelayer, value))
 		{
 			return true;
@@ -3686,7 +4125,7 @@ bool SlicesHandler::TissuevalueAtBoundary3D(tissues_size_t value)
 	}
 
 	// Bottom
-	tmp = &(m_ImageSlices[m_Endslice - 1].ReturnTissues(m_ActiveTissuelayer)[0]);
+	tmp = &(ImageSlice(m_Endslice - 1).ReturnTissues(m_ActiveTissuelayer)[0]);
 	for (unsigned pos = 0; pos < m_Area; pos++, tmp++)
 	{
 		if (*tmp == value)
@@ -3711,9 +4150,9 @@ float SlicesHandler::AddSkin(int i1)
 	{
 		setto = p.low;
 
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
-			float* bits = m_ImageSlices[i].ReturnWork();
+			float* bits = ImageSlice(i).ReturnWork();
 			for (unsigned pos = 0; pos < m_Area; pos++)
 			{
 				if (bits[pos] != p.high)
@@ -3728,7 +4167,7 @@ float SlicesHandler::AddSkin(int i1)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].AddSkin(i1, setto);
+		ImageSlice(i).AddSkin(i1, setto);
 	}
 
 	return setto;
@@ -3747,9 +4186,9 @@ float SlicesHandler::AddSkinOutside(int i1)
 	{
 		setto = p.low;
 
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
-			float* bits = m_ImageSlices[i].ReturnWork();
+			float* bits = ImageSlice(i).ReturnWork();
 			for (unsigned pos = 0; pos < m_Area; pos++)
 			{
 				if (bits[pos] != p.high)
@@ -3764,7 +4203,7 @@ float SlicesHandler::AddSkinOutside(int i1)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].AddSkinOutside(i1, setto);
+		ImageSlice(i).AddSkinOutside(i1, setto);
 	}
 
 	return setto;
@@ -3777,7 +4216,7 @@ void SlicesHandler::AddSkintissue(int i1, tissues_size_t f)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].AddSkintissue(m_ActiveTissuelayer, i1, f);
+		ImageSlice(i).AddSkintissue(m_ActiveTissuelayer, i1, f);
 	}
 }
 
@@ -3788,7 +4227,7 @@ void SlicesHandler::AddSkintissueOutside(int i1, tissues_size_t f)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].AddSkintissueOutside(m_ActiveTissuelayer, i1, f);
+		ImageSlice(i).AddSkintissueOutside(m_ActiveTissuelayer, i1, f);
 	}
 }
 
@@ -3805,9 +4244,9 @@ void SlicesHandler::FillUnassigned()
 	{
 		setto = p.low;
 
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
-			float* bits = m_ImageSlices[i].ReturnWork();
+			float* bits = ImageSlice(i).ReturnWork();
 			for (unsigned pos = 0; pos < m_Area; pos++)
 			{
 				if (bits[pos] != p.high)
@@ -3822,7 +4261,7 @@ void SlicesHandler::FillUnassigned()
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].FillUnassigned(setto);
+		ImageSlice(i).FillUnassigned(setto);
 	}
 }
 
@@ -3833,40 +4272,40 @@ void SlicesHandler::FillUnassignedtissue(tissues_size_t f)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].FillUnassignedtissue(m_ActiveTissuelayer, f);
+		ImageSlice(i).FillUnassignedtissue(m_ActiveTissuelayer, f);
 	}
 }
 
-void SlicesHandler::Kmeans(unsigned short slicenr, short nrtissues, unsigned int iternr, unsigned int converge)
+void SlicesHandler::Kmeans(unsigned slicenr, short nrtissues, unsigned int iternr, unsigned int converge)
 {
 	if (slicenr >= m_Startslice && slicenr < m_Endslice)
 	{
 		KMeans kmeans;
 		float* bits[1];
-		bits[0] = m_ImageSlices[slicenr].ReturnBmp();
+		bits[0] = ImageSlice(slicenr).ReturnBmp();
 		float weights[1];
 		weights[0] = 1;
 		kmeans.Init(m_Width, m_Height, nrtissues, 1, bits, weights);
 		kmeans.MakeIter(iternr, converge);
-		kmeans.ReturnM(m_ImageSlices[slicenr].ReturnWork());
+		kmeans.ReturnM(ImageSlice(slicenr).ReturnWork());
 		m_ImageSlices[slicenr].SetMode(2, false);
 
-		for (unsigned short i = m_Startslice; i < slicenr; i++)
+		for (unsigned i = m_Startslice; i < slicenr; i++)
 		{
-			bits[0] = m_ImageSlices[i].ReturnBmp();
-			kmeans.ApplyTo(bits, m_ImageSlices[i].ReturnWork());
+			bits[0] = ImageSlice(i).ReturnBmp();
+			kmeans.ApplyTo(bits, ImageSlice(i).ReturnWork());
 			m_ImageSlices[i].SetMode(2, false);
 		}
-		for (unsigned short i = slicenr + 1; i < m_Endslice; i++)
+		for (unsigned i = slicenr + 1; i < m_Endslice; i++)
 		{
-			bits[0] = m_ImageSlices[i].ReturnBmp();
-			kmeans.ApplyTo(bits, m_ImageSlices[i].ReturnWork());
+			bits[0] = ImageSlice(i).ReturnBmp();
+			kmeans.ApplyTo(bits, ImageSlice(i).ReturnWork());
 			m_ImageSlices[i].SetMode(2, false);
 		}
 	}
 }
 
-void SlicesHandler::KmeansMhd(unsigned short slicenr, short nrtissues, short dim, std::vector<std::string> mhdfiles, float* weights, unsigned int iternr, unsigned int converge)
+void SlicesHandler::KmeansMhd(unsigned slicenr, short nrtissues, short dim, std::vector<std::string> mhdfiles, float* weights, unsigned int iternr, unsigned int converge)
 {
 	if (mhdfiles.size() + 1 < dim)
 		return;
@@ -3874,24 +4313,24 @@ void SlicesHandler::KmeansMhd(unsigned short slicenr, short nrtissues, short dim
 	{
 		KMeans kmeans;
 		float** bits = new float*[dim];
-		for (unsigned short j = 0; j + 1 < dim; j++)
+		for (unsigned j = 0; j + 1 < dim; j++)
 		{
 			bits[j + 1] = new float[m_Area];
 			if (bits[j + 1] == nullptr)
 			{
-				for (unsigned short i = 1; i < j; i++)
+				for (unsigned i = 1; i < j; i++)
 					delete[] bits[i];
 				delete[] bits;
 				return;
 			}
 		}
 
-		bits[0] = m_ImageSlices[slicenr].ReturnBmp();
-		for (unsigned short i = 0; i + 1 < dim; i++)
+		bits[0] = ImageSlice(slicenr).ReturnBmp();
+		for (unsigned i = 0; i + 1 < dim; i++)
 		{
 			if (!ImageReader::GetSlice(mhdfiles[i].c_str(), bits[i + 1], slicenr, m_Width, m_Height))
 			{
-				for (unsigned short j = 1; j < dim; j++)
+				for (unsigned j = 1; j < dim; j++)
 					delete[] bits[j];
 				delete[] bits;
 				return;
@@ -3899,73 +4338,73 @@ void SlicesHandler::KmeansMhd(unsigned short slicenr, short nrtissues, short dim
 		}
 		kmeans.Init(m_Width, m_Height, nrtissues, dim, bits, weights);
 		kmeans.MakeIter(iternr, converge);
-		kmeans.ReturnM(m_ImageSlices[slicenr].ReturnWork());
+		kmeans.ReturnM(ImageSlice(slicenr).ReturnWork());
 		m_ImageSlices[slicenr].SetMode(2, false);
 
-		for (unsigned short i = m_Startslice; i < slicenr; i++)
+		for (unsigned i = m_Startslice; i < slicenr; i++)
 		{
-			bits[0] = m_ImageSlices[i].ReturnBmp();
-			for (unsigned short k = 0; k + 1 < dim; k++)
+			bits[0] = ImageSlice(i).ReturnBmp();
+			for (unsigned k = 0; k + 1 < dim; k++)
 			{
 				if (!ImageReader::GetSlice(mhdfiles[k].c_str(), bits[k + 1], i, m_Width, m_Height))
 				{
-					for (unsigned short j = 1; j < dim; j++)
+					for (unsigned j = 1; j < dim; j++)
 						delete[] bits[j];
 					delete[] bits;
 					return;
 				}
 			}
-			kmeans.ApplyTo(bits, m_ImageSlices[i].ReturnWork());
+			kmeans.ApplyTo(bits, ImageSlice(i).ReturnWork());
 			m_ImageSlices[i].SetMode(2, false);
 		}
-		for (unsigned short i = slicenr + 1; i < m_Endslice; i++)
+		for (unsigned i = slicenr + 1; i < m_Endslice; i++)
 		{
-			bits[0] = m_ImageSlices[i].ReturnBmp();
-			for (unsigned short k = 0; k + 1 < dim; k++)
+			bits[0] = ImageSlice(i).ReturnBmp();
+			for (unsigned k = 0; k + 1 < dim; k++)
 			{
 				if (!ImageReader::GetSlice(mhdfiles[k].c_str(), bits[k + 1], i, m_Width, m_Height))
 				{
-					for (unsigned short j = 1; j < dim; j++)
+					for (unsigned j = 1; j < dim; j++)
 						delete[] bits[j];
 					delete[] bits;
 					return;
 				}
 			}
-			kmeans.ApplyTo(bits, m_ImageSlices[i].ReturnWork());
+			kmeans.ApplyTo(bits, ImageSlice(i).ReturnWork());
 			m_ImageSlices[i].SetMode(2, false);
 		}
 
-		for (unsigned short j = 1; j < dim; j++)
+		for (unsigned j = 1; j < dim; j++)
 			delete[] bits[j];
 		delete[] bits;
 	}
 }
 
-void SlicesHandler::KmeansPng(unsigned short slicenr, short nrtissues, short dim, std::vector<std::string> pngfiles, std::vector<int> exctractChannel, float* weights, unsigned int iternr, unsigned int converge, const std::string initCentersFile)
+void SlicesHandler::KmeansPng(unsigned slicenr, short nrtissues, short dim, std::vector<std::string> pngfiles, std::vector<int> exctractChannel, float* weights, unsigned int iternr, unsigned int converge, const std::string initCentersFile)
 {
 	if (pngfiles.size() + 1 < dim)
 		return;
 	if (slicenr >= m_Startslice && slicenr < m_Endslice)
 	{
 		float** bits = new float*[dim];
-		for (unsigned short j = 0; j + 1 < dim; j++)
+		for (unsigned j = 0; j + 1 < dim; j++)
 		{
 			bits[j + 1] = new float[m_Area];
 			if (bits[j + 1] == nullptr)
 			{
-				for (unsigned short i = 1; i < j; i++)
+				for (unsigned i = 1; i < j; i++)
 					delete[] bits[i];
 				delete[] bits;
 				return;
 			}
 		}
 
-		bits[0] = m_ImageSlices[slicenr].ReturnBmp();
-		for (unsigned short i = 0; i + 1 < dim; i++)
+		bits[0] = ImageSlice(slicenr).ReturnBmp();
+		for (unsigned i = 0; i + 1 < dim; i++)
 		{
 			if (!ChannelExtractor::getSlice(pngfiles[0].c_str(), bits[i + 1], exctractChannel[i], slicenr, m_Width, m_Height))
 			{
-				for (unsigned short j = 1; j < dim; j++)
+				for (unsigned j = 1; j < dim; j++)
 					delete[] bits[j];
 				delete[] bits;
 				return;
@@ -3997,72 +4436,72 @@ void SlicesHandler::KmeansPng(unsigned short slicenr, short nrtissues, short dim
 			kmeans.Init(m_Width, m_Height, nrtissues, dim, bits, weights);
 		}
 		kmeans.MakeIter(iternr, converge);
-		kmeans.ReturnM(m_ImageSlices[slicenr].ReturnWork());
+		kmeans.ReturnM(ImageSlice(slicenr).ReturnWork());
 		m_ImageSlices[slicenr].SetMode(2, false);
 
-		for (unsigned short i = m_Startslice; i < slicenr; i++)
+		for (unsigned i = m_Startslice; i < slicenr; i++)
 		{
-			bits[0] = m_ImageSlices[i].ReturnBmp();
-			for (unsigned short k = 0; k + 1 < dim; k++)
+			bits[0] = ImageSlice(i).ReturnBmp();
+			for (unsigned k = 0; k + 1 < dim; k++)
 			{
 				if (!ChannelExtractor::getSlice(pngfiles[0].c_str(), bits[i + 1], exctractChannel[i], i, m_Width, m_Height))
 				{
-					for (unsigned short j = 1; j < dim; j++)
+					for (unsigned j = 1; j < dim; j++)
 						delete[] bits[j];
 					delete[] bits;
 					return;
 				}
 			}
-			kmeans.ApplyTo(bits, m_ImageSlices[i].ReturnWork());
+			kmeans.ApplyTo(bits, ImageSlice(i).ReturnWork());
 			m_ImageSlices[i].SetMode(2, false);
 		}
-		for (unsigned short i = slicenr + 1; i < m_Endslice; i++)
+		for (unsigned i = slicenr + 1; i < m_Endslice; i++)
 		{
-			bits[0] = m_ImageSlices[i].ReturnBmp();
-			for (unsigned short k = 0; k + 1 < dim; k++)
+			bits[0] = ImageSlice(i).ReturnBmp();
+			for (unsigned k = 0; k + 1 < dim; k++)
 			{
 				if (!ChannelExtractor::getSlice(pngfiles[0].c_str(), bits[i + 1], exctractChannel[i], i, m_Width, m_Height))
 				{
-					for (unsigned short j = 1; j < dim; j++)
+					for (unsigned j = 1; j < dim; j++)
 						delete[] bits[j];
 					delete[] bits;
 					return;
 				}
 			}
-			kmeans.ApplyTo(bits, m_ImageSlices[i].ReturnWork());
+			kmeans.ApplyTo(bits, ImageSlice(i).ReturnWork());
 			m_ImageSlices[i].SetMode(2, false);
 		}
 
-		for (unsigned short j = 1; j < dim; j++)
+		for (unsigned j = 1; j < dim; j++)
 			delete[] bits[j];
 		delete[] bits;
 	}
 }
 
-void SlicesHandler::Em(unsigned short slicenr, short nrtissues, unsigned int iternr, unsigned int converge)
+void SlicesHandler::Em(unsigned slicenr, short nrtissues, unsigned int iternr, unsigned int converge)
 {
 	if (slicenr >= m_Startslice && slicenr < m_Endslice)
 	{
 		ExpectationMaximization em;
 		float* bits[1];
-		bits[0] = m_ImageSlices[slicenr].ReturnBmp();
+		bits[0] = ImageSlice(slicenr).ReturnBmp();
 		float weights[1];
 		weights[0] = 1;
 		em.Init(m_Width, m_Height, nrtissues, 1, bits, weights);
 		em.MakeIter(iternr, converge);
-		em.Classify(m_ImageSlices[slicenr].ReturnWork());
+		em.Classify(ImageSlice(slicenr).ReturnWork());
 		m_ImageSlices[slicenr].SetMode(2, false);
 
-		for (unsigned short i = m_Startslice; i < slicenr; i++)
+		for (unsigned i = m_Startslice; i < slicenr; i++)
 		{
-			bits[0] = m_ImageSlices[i].ReturnBmp();
-			em.ApplyTo(bits, m_ImageSlices[i].ReturnWork());
+			bits[0] = ImageSlice(i).ReturnBmp();
+			em.ApplyTo(bits, ImageSlice(i).ReturnWork());
 			m_ImageSlices[i].SetMode(2, false);
 		}
-		for (unsigned short i = slicenr + 1; i < m_Endslice; i++)
+		for (unsigned i = slicenr + 1; i < m_Endslice; i++)
 		{
-			bits[0] = m_ImageSlices[i].ReturnBmp();
-			em.ApplyTo(bits, m_ImageSlices[i].ReturnWork());
+			bits[0] = ImageSlice(i).ReturnBmp();
+			em.ApplyTo(bits, ImageSlice(i).ReturnWork());
 			m_ImageSlices[i].SetMode(2, false);
 		}
 	}
@@ -4070,32 +4509,32 @@ void SlicesHandler::Em(unsigned short slicenr, short nrtissues, unsigned int ite
 
 void SlicesHandler::AnisoDiff(float dt, int n, float (*f)(float, float), float k, float restraint)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].AnisoDiff(dt, n, f, k, restraint);
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).AnisoDiff(dt, n, f, k, restraint);
 }
 
 void SlicesHandler::ContAnisodiff(float dt, int n, float (*f)(float, float), float k, float restraint)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].ContAnisodiff(dt, n, f, k, restraint);
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).ContAnisodiff(dt, n, f, k, restraint);
 }
 
 void SlicesHandler::MedianInterquartile(bool median)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].MedianInterquartile(median);
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).MedianInterquartile(median);
 }
 
-void SlicesHandler::Average(unsigned short n)
+void SlicesHandler::Average(unsigned n)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].Average(n);
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).Average(n);
 }
 
-void SlicesHandler::Sigmafilter(float sigma, unsigned short nx, unsigned short ny)
+void SlicesHandler::Sigmafilter(float sigma, unsigned nx, unsigned ny)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
-		m_ImageSlices[i].Sigmafilter(sigma, nx, ny);
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
+		ImageSlice(i).Sigmafilter(sigma, nx, ny);
 }
 
 void SlicesHandler::Threshold(float* thresholds)
@@ -4105,11 +4544,11 @@ void SlicesHandler::Threshold(float* thresholds)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].Threshold(thresholds);
+		ImageSlice(i).Threshold(thresholds);
 	}
 }
 
-void SlicesHandler::ExtractinterpolatesaveContours(int minsize, std::vector<tissues_size_t>& tissuevec, unsigned short between, bool dp, float epsilon, const char* filename)
+void SlicesHandler::ExtractinterpolatesaveContours(int minsize, std::vector<tissues_size_t>& tissuevec, unsigned between, bool dp, float epsilon, const char* filename)
 {
 	/*	os.clear();
 	os.set_sizenr((between+1)*nrslices-between);
@@ -4119,17 +4558,17 @@ void SlicesHandler::ExtractinterpolatesaveContours(int minsize, std::vector<tiss
 	std::vector<point_type> v_p;
 
 	SlicesHandler dummy3_d;
-	dummy3_d.Newbmp((unsigned short)(m_ImageSlices[0].ReturnWidth()), (unsigned short)(m_ImageSlices[0].ReturnHeight()), between + 2);
+	dummy3_d.Newbmp((unsigned)(m_ImageSlices[0].ReturnWidth()), (unsigned)(m_ImageSlices[0].ReturnHeight()), between + 2);
 	dummy3_d.SetSlicethickness(m_Thickness / (between + 1));
 	Pair pair1 = GetPixelsize();
 	dummy3_d.SetPixelsize(pair1.high, pair1.low);
 
 	FILE* fp = dummy3_d.SaveContourprologue(filename, (between + 1) * m_Nrslices - between);
 
-	for (unsigned short j = 0; j + 1 < m_Nrslices; j++)
+	for (unsigned j = 0; j + 1 < m_Nrslices; j++)
 	{
-		dummy3_d.Copy2tissue(0, m_ImageSlices[j].ReturnTissues(m_ActiveTissuelayer));
-		dummy3_d.Copy2tissue(between + 1, m_ImageSlices[j + 1].ReturnTissues(m_ActiveTissuelayer));
+		dummy3_d.Copy2tissue(0, ImageSlice(j).ReturnTissues(m_ActiveTissuelayer));
+		dummy3_d.Copy2tissue(between + 1, ImageSlice(j + 1).ReturnTissues(m_ActiveTissuelayer));
 		dummy3_d.Interpolatetissuegrey(0, between + 1); // TODO: Use interpolatetissuegrey_medianset?
 
 		dummy3_d.ExtractContours(minsize, tissuevec);
@@ -4145,23 +4584,23 @@ void SlicesHandler::ExtractinterpolatesaveContours(int minsize, std::vector<tiss
 	fclose(fp);
 }
 
-void SlicesHandler::ExtractinterpolatesaveContours2Xmirrored(int minsize, std::vector<tissues_size_t>& tissuevec, unsigned short between, bool dp, float epsilon, const char* filename)
+void SlicesHandler::ExtractinterpolatesaveContours2Xmirrored(int minsize, std::vector<tissues_size_t>& tissuevec, unsigned between, bool dp, float epsilon, const char* filename)
 {
 	std::vector<std::vector<Point>> v1, v2;
 	std::vector<point_type> v_p;
 
 	SlicesHandler dummy3_d;
-	dummy3_d.Newbmp((unsigned short)(m_ImageSlices[0].ReturnWidth()), (unsigned short)(m_ImageSlices[0].ReturnHeight()), between + 2);
+	dummy3_d.Newbmp((unsigned)(m_ImageSlices[0].ReturnWidth()), (unsigned)(m_ImageSlices[0].ReturnHeight()), between + 2);
 	dummy3_d.SetSlicethickness(m_Thickness / (between + 1));
 	Pair pair1 = GetPixelsize();
 	dummy3_d.SetPixelsize(pair1.high / 2, pair1.low / 2);
 
 	FILE* fp = dummy3_d.SaveContourprologue(filename, (between + 1) * m_Nrslices - between);
 
-	for (unsigned short j = 0; j + 1 < m_Nrslices; j++)
+	for (unsigned j = 0; j + 1 < m_Nrslices; j++)
 	{
-		dummy3_d.Copy2tissue(0, m_ImageSlices[j].ReturnTissues(m_ActiveTissuelayer));
-		dummy3_d.Copy2tissue(between + 1, m_ImageSlices[j + 1].ReturnTissues(m_ActiveTissuelayer));
+		dummy3_d.Copy2tissue(0, ImageSlice(j).ReturnTissues(m_ActiveTissuelayer));
+		dummy3_d.Copy2tissue(between + 1, ImageSlice(j + 1).ReturnTissues(m_ActiveTissuelayer));
 		dummy3_d.Interpolatetissuegrey(0, between + 1); // TODO: Use interpolatetissuegrey_medianset?
 
 		//		dummy3D.extract_contours2(minsize, tissuevec);
@@ -4194,11 +4633,11 @@ void SlicesHandler::ExtractContours(int minsize, std::vector<tissues_size_t>& ti
 	for (std::vector<tissues_size_t>::iterator it1 = tissuevec.begin();
 			 it1 != tissuevec.end(); it1++)
 	{
-		for (unsigned short i = 0; i < m_Nrslices; i++)
+		for (unsigned i = 0; i < m_Nrslices; i++)
 		{
 			v1.clear();
 			v2.clear();
-			m_ImageSlices[i]
+			ImageSlice(i)
 					.GetTissuecontours(m_ActiveTissuelayer, *it1, &v1, &v2, minsize);
 			for (std::vector<std::vector<Point>>::iterator it = v1.begin();
 					 it != v1.end(); it++)
@@ -4225,11 +4664,11 @@ void SlicesHandler::ExtractContours2Xmirrored(int minsize, std::vector<tissues_s
 
 	for (auto tissue_label : tissuevec)
 	{
-		for (unsigned short i = 0; i < m_Nrslices; i++)
+		for (unsigned i = 0; i < m_Nrslices; i++)
 		{
 			v1.clear();
 			v2.clear();
-			m_ImageSlices[i].GetTissuecontours2Xmirrored(m_ActiveTissuelayer, tissue_label, &v1, &v2, minsize);
+			ImageSlice(i).GetTissuecontours2Xmirrored(m_ActiveTissuelayer, tissue_label, &v1, &v2, minsize);
 			for (auto& line : v1)
 			{
 				m_Os.AddLine(i, tissue_label, &line, true);
@@ -4249,11 +4688,11 @@ void SlicesHandler::ExtractContours2Xmirrored(int minsize, std::vector<tissues_s
 
 	for (auto tissue_label : tissuevec)
 	{
-		for (unsigned short i = 0; i < m_Nrslices; i++)
+		for (unsigned i = 0; i < m_Nrslices; i++)
 		{
 			v1.clear();
 			v2.clear();
-			m_ImageSlices[i].GetTissuecontours2Xmirrored(m_ActiveTissuelayer, tissue_label, &v1, &v2, minsize, epsilon);
+			ImageSlice(i).GetTissuecontours2Xmirrored(m_ActiveTissuelayer, tissue_label, &v1, &v2, minsize, epsilon);
 			for (auto& line : v1)
 			{
 				m_Os.AddLine(i, tissue_label, &line, true);
@@ -4268,92 +4707,92 @@ void SlicesHandler::ExtractContours2Xmirrored(int minsize, std::vector<tissues_s
 
 void SlicesHandler::BmpSum()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].BmpSum();
+		ImageSlice(i).BmpSum();
 	}
 }
 
 void SlicesHandler::BmpAdd(float f)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].BmpAdd(f);
+		ImageSlice(i).BmpAdd(f);
 	}
 }
 
 void SlicesHandler::BmpDiff()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].BmpDiff();
+		ImageSlice(i).BmpDiff();
 	}
 }
 
 void SlicesHandler::BmpMult()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].BmpMult();
+		ImageSlice(i).BmpMult();
 	}
 }
 
 void SlicesHandler::BmpMult(float f)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].BmpMult(f);
+		ImageSlice(i).BmpMult(f);
 	}
 }
 
 void SlicesHandler::BmpOverlay(float alpha)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].BmpOverlay(alpha);
+		ImageSlice(i).BmpOverlay(alpha);
 	}
 }
 
 void SlicesHandler::BmpAbs()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].BmpAbs();
+		ImageSlice(i).BmpAbs();
 	}
 }
 
 void SlicesHandler::BmpNeg()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].BmpNeg();
+		ImageSlice(i).BmpNeg();
 	}
 }
 
 void SlicesHandler::ScaleColors(Pair p)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].ScaleColors(p);
+		ImageSlice(i).ScaleColors(p);
 	}
 }
 
 void SlicesHandler::CropColors()
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].CropColors();
+		ImageSlice(i).CropColors();
 	}
 }
 
 void SlicesHandler::GetRange(Pair* pp)
 {
 	Pair p;
-	m_ImageSlices[m_Startslice].GetRange(pp);
+	ImageSlice(m_Startslice).GetRange(pp);
 
-	for (unsigned short i = m_Startslice + 1; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice + 1; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].GetRange(&p);
+		ImageSlice(i).GetRange(&p);
 		if ((*pp).high < p.high)
 			(*pp).high = p.high;
 		if ((*pp).low > p.low)
@@ -4367,7 +4806,8 @@ void SlicesHandler::ComputeRangeMode1(Pair* pp)
 	pp->low = FLT_MAX;
 	pp->high = 0.f;
 
-#pragma omp parallel
+	// with paging, visit the slices one at a time such that they can be paged out again
+#pragma omp parallel if (!m_PageFile)
 	{
 		// this data is thread private
 		Pair p;
@@ -4380,8 +4820,9 @@ void SlicesHandler::ComputeRangeMode1(Pair* pp)
 		{
 			if (m_ImageSlices[i].ReturnMode(false) == 1)
 			{
-				m_ImageSlices[i].GetRange(&p);
+				ImageSlice(i).GetRange(&p);
 				m_SliceRanges[i] = p;
+				TrimSliceCache();
 				if (high < p.high)
 					high = p.high;
 				if (low > p.low)
@@ -4405,18 +4846,18 @@ void SlicesHandler::ComputeRangeMode1(Pair* pp)
 	}
 }
 
-void SlicesHandler::ComputeRangeMode1(unsigned short updateSlicenr, Pair* pp)
+void SlicesHandler::ComputeRangeMode1(unsigned updateSlicenr, Pair* pp)
 {
 	// Update range for single mode 1 slice
 	if (m_ImageSlices[updateSlicenr].ReturnMode(false) == 1)
 	{
-		m_ImageSlices[updateSlicenr].GetRange(&m_SliceRanges[updateSlicenr]);
+		ImageSlice(updateSlicenr).GetRange(&m_SliceRanges[updateSlicenr]);
 	}
 
 	// Compute total range
 	pp->high = 0.0f;
 	pp->low = FLT_MAX;
-	for (unsigned short i = 0; i < m_Nrslices; ++i)
+	for (unsigned i = 0; i < m_Nrslices; ++i)
 	{
 		if (m_ImageSlices[i].ReturnMode(false) != 1)
 			continue;
@@ -4437,11 +4878,11 @@ void SlicesHandler::ComputeRangeMode1(unsigned short updateSlicenr, Pair* pp)
 void SlicesHandler::GetBmprange(Pair* pp)
 {
 	Pair p;
-	m_ImageSlices[m_Startslice].GetBmprange(pp);
+	ImageSlice(m_Startslice).GetBmprange(pp);
 
-	for (unsigned short i = m_Startslice + 1; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice + 1; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].GetBmprange(&p);
+		ImageSlice(i).GetBmprange(&p);
 		if ((*pp).high < p.high)
 			(*pp).high = p.high;
 		if ((*pp).low > p.low)
@@ -4455,7 +4896,8 @@ void SlicesHandler::ComputeBmprangeMode1(Pair* pp)
 	pp->low = FLT_MAX;
 	pp->high = 0.f;
 
-#pragma omp parallel
+	// with paging, visit the slices one at a time such that they can be paged out again
+#pragma omp parallel if (!m_PageFile)
 	{
 		// this data is thread private
 		Pair p;
@@ -4468,8 +4910,9 @@ void SlicesHandler::ComputeBmprangeMode1(Pair* pp)
 		{
 			if (m_ImageSlices[i].ReturnMode(true) == 1)
 			{
-				m_ImageSlices[i].GetBmprange(&p);
+				ImageSlice(i).GetBmprange(&p);
 				m_SliceBmpranges[i] = p;
+				TrimSliceCache();
 
 				high = std::max(high, p.high);
 				low = std::min(low, p.low);
@@ -4492,18 +4935,18 @@ void SlicesHandler::ComputeBmprangeMode1(Pair* pp)
 	}
 }
 
-void SlicesHandler::ComputeBmprangeMode1(unsigned short updateSlicenr, Pair* pp)
+void SlicesHandler::ComputeBmprangeMode1(unsigned updateSlicenr, Pair* pp)
 {
 	// Update range for single mode 1 slice
 	if (m_ImageSlices[updateSlicenr].ReturnMode(true) == 1)
 	{
-		m_ImageSlices[updateSlicenr].GetBmprange(&m_SliceBmpranges[updateSlicenr]);
+		ImageSlice(updateSlicenr).GetBmprange(&m_SliceBmpranges[updateSlicenr]);
 	}
 
 	// Compute total range
 	pp->high = 0.0f;
 	pp->low = FLT_MAX;
-	for (unsigned short i = 0; i < m_Nrslices; ++i)
+	for (unsigned i = 0; i < m_Nrslices; ++i)
 	{
 		if (m_ImageSlices[i].ReturnMode(true) != 1)
 			continue;
@@ -4524,11 +4967,11 @@ void SlicesHandler::ComputeBmprangeMode1(unsigned short updateSlicenr, Pair* pp)
 void SlicesHandler::GetRangetissue(tissues_size_t* pp)
 {
 	tissues_size_t p;
-	m_ImageSlices[m_Startslice].GetRangetissue(m_ActiveTissuelayer, pp);
+	ImageSlice(m_Startslice).GetRangetissue(m_ActiveTissuelayer, pp);
 
-	for (unsigned short i = m_Startslice + 1; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice + 1; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].GetRangetissue(m_ActiveTissuelayer, &p);
+		ImageSlice(i).GetRangetissue(m_ActiveTissuelayer, &p);
 		if ((*pp) < p)
 			(*pp) = p;
 	}
@@ -4536,9 +4979,9 @@ void SlicesHandler::GetRangetissue(tissues_size_t* pp)
 
 void SlicesHandler::ZeroCrossings(bool connectivity)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].ZeroCrossings(connectivity);
+		ImageSlice(i).ZeroCrossings(connectivity);
 	}
 }
 
@@ -4623,25 +5066,25 @@ void SlicesHandler::DougpeuckLine(float epsilon)
 	m_Os.DougPeuck(epsilon, true);
 }
 
-void SlicesHandler::Hysteretic(float thresh_low, float thresh_high, bool connectivity, unsigned short nrpasses)
+void SlicesHandler::Hysteretic(float thresh_low, float thresh_high, bool connectivity, unsigned nrpasses)
 {
 	float setvalue = 255;
-	unsigned short slicenr = m_Startslice;
+	unsigned slicenr = m_Startslice;
 
 	ClearWork();
 
-	m_ImageSlices[slicenr].Hysteretic(thresh_low, thresh_high, connectivity, setvalue);
-	for (unsigned short i = 0; i < nrpasses; i++)
+	ImageSlice(slicenr).Hysteretic(thresh_low, thresh_high, connectivity, setvalue);
+	for (unsigned i = 0; i < nrpasses; i++)
 	{
 		while (++slicenr < m_Endslice)
 		{
-			m_ImageSlices[slicenr].Hysteretic(thresh_low, thresh_high, connectivity, m_ImageSlices[slicenr - 1].ReturnWork(), setvalue - 1, setvalue);
+			ImageSlice(slicenr).Hysteretic(thresh_low, thresh_high, connectivity, ImageSlice(slicenr - 1).ReturnWork(), setvalue - 1, setvalue);
 		}
 		setvalue++;
 		slicenr--;
 		while (slicenr-- > m_Startslice)
 		{
-			m_ImageSlices[slicenr].Hysteretic(thresh_low, thresh_high, connectivity, m_ImageSlices[slicenr + 1].ReturnWork(), setvalue - 1, setvalue);
+			ImageSlice(slicenr).Hysteretic(thresh_low, thresh_high, connectivity, ImageSlice(slicenr + 1).ReturnWork(), setvalue - 1, setvalue);
 		}
 		setvalue++;
 		slicenr = m_Startslice;
@@ -4654,7 +5097,7 @@ void SlicesHandler::Hysteretic(float thresh_low, float thresh_high, bool connect
 	Threshold(thresh);
 }
 
-void SlicesHandler::ThresholdedGrowing(short unsigned slicenr, Point p, float threshfactor_low, float threshfactor_high, bool connectivity, unsigned short nrpasses)
+void SlicesHandler::ThresholdedGrowing(unsigned slicenr, Point p, float threshfactor_low, float threshfactor_high, bool connectivity, unsigned nrpasses)
 {
 	if (slicenr < m_Endslice && slicenr >= m_Startslice)
 	{
@@ -4663,19 +5106,19 @@ void SlicesHandler::ThresholdedGrowing(short unsigned slicenr, Point p, float th
 
 		ClearWork();
 
-		m_ImageSlices[slicenr].ThresholdedGrowing(p, threshfactor_low, threshfactor_high, connectivity, setvalue, &tp);
+		ImageSlice(slicenr).ThresholdedGrowing(p, threshfactor_low, threshfactor_high, connectivity, setvalue, &tp);
 
-		for (unsigned short i = 0; i < nrpasses; i++)
+		for (unsigned i = 0; i < nrpasses; i++)
 		{
 			while (++slicenr < m_Endslice)
 			{
-				m_ImageSlices[slicenr].ThresholdedGrowing(tp.low, tp.high, connectivity, m_ImageSlices[slicenr - 1].ReturnWork(), setvalue - 1, setvalue);
+				ImageSlice(slicenr).ThresholdedGrowing(tp.low, tp.high, connectivity, ImageSlice(slicenr - 1).ReturnWork(), setvalue - 1, setvalue);
 			}
 			setvalue++;
 			slicenr--;
 			while (slicenr-- > m_Startslice)
 			{
-				m_ImageSlices[slicenr].ThresholdedGrowing(tp.low, tp.high, connectivity, m_ImageSlices[slicenr + 1].ReturnWork(), setvalue - 1, setvalue);
+				ImageSlice(slicenr).ThresholdedGrowing(tp.low, tp.high, connectivity, ImageSlice(slicenr + 1).ReturnWork(), setvalue - 1, setvalue);
 			}
 			setvalue++;
 			slicenr = m_Startslice;
@@ -4689,7 +5132,7 @@ void SlicesHandler::ThresholdedGrowing(short unsigned slicenr, Point p, float th
 	}
 }
 
-void SlicesHandler::ThresholdedGrowing(short unsigned slicenr, Point p, float thresh_low, float thresh_high, float set_to) //bool connectivity,float set_to)
+void SlicesHandler::ThresholdedGrowing(unsigned slicenr, Point p, float thresh_low, float thresh_high, float set_to) //bool connectivity,float set_to)
 {
 	if (slicenr >= m_Startslice && slicenr < m_Endslice)
 	{
@@ -4697,14 +5140,14 @@ void SlicesHandler::ThresholdedGrowing(short unsigned slicenr, Point p, float th
 		std::vector<Posit> s;
 		Posit p1;
 
-		for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+		for (unsigned z = m_Startslice; z < m_Endslice; z++)
 		{
-			float* work = m_ImageSlices[z].ReturnWork();
-			float* bmp = m_ImageSlices[z].ReturnBmp();
+			float* work = ImageSlice(z).ReturnWork();
+			float* bmp = ImageSlice(z).ReturnBmp();
 			int i = 0;
-			for (unsigned short j = 0; j < m_Height; j++)
+			for (unsigned j = 0; j < m_Height; j++)
 			{
-				for (unsigned short k = 0; k < m_Width; k++)
+				for (unsigned k = 0; k < m_Width; k++)
 				{
 					if (bmp[i] > thresh_high || bmp[i] < thresh_low)
 						work[i] = 0;
@@ -4719,7 +5162,7 @@ void SlicesHandler::ThresholdedGrowing(short unsigned slicenr, Point p, float th
 		p1.m_Pz = slicenr;
 
 		s.push_back(p1);
-		float* work = m_ImageSlices[slicenr].ReturnWork();
+		float* work = ImageSlice(slicenr).ReturnWork();
 		work[position] = set_to;
 
 		//	hysteretic_growth(results,&s,width+2,height+2,connectivity,set_to);
@@ -4730,7 +5173,7 @@ void SlicesHandler::ThresholdedGrowing(short unsigned slicenr, Point p, float th
 			i = s.back();
 			s.pop_back();
 
-			work = m_ImageSlices[i.m_Pz].ReturnWork();
+			work = ImageSlice(i.m_Pz).ReturnWork();
 			if (i.m_Pxy % m_Width != 0 && work[i.m_Pxy - 1] == -1)
 			{
 				work[i.m_Pxy - 1] = set_to;
@@ -4761,7 +5204,7 @@ void SlicesHandler::ThresholdedGrowing(short unsigned slicenr, Point p, float th
 			}
 			if (i.m_Pz > m_Startslice)
 			{
-				work = m_ImageSlices[i.m_Pz - 1].ReturnWork();
+				work = ImageSlice(i.m_Pz - 1).ReturnWork();
 				if (work[i.m_Pxy] == -1)
 				{
 					work[i.m_Pxy] = set_to;
@@ -4774,7 +5217,7 @@ void SlicesHandler::ThresholdedGrowing(short unsigned slicenr, Point p, float th
 			}
 			if (i.m_Pz + 1 < m_Endslice)
 			{
-				work = m_ImageSlices[i.m_Pz + 1].ReturnWork();
+				work = ImageSlice(i.m_Pz + 1).ReturnWork();
 				if (work[i.m_Pxy] == -1)
 				{
 					work[i.m_Pxy] = set_to;
@@ -4793,9 +5236,9 @@ void SlicesHandler::ThresholdedGrowing(short unsigned slicenr, Point p, float th
 			}*/
 		}
 
-		for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+		for (unsigned z = m_Startslice; z < m_Endslice; z++)
 		{
-			work = m_ImageSlices[z].ReturnWork();
+			work = ImageSlice(z).ReturnWork();
 			for (unsigned i1 = 0; i1 < m_Area; i1++)
 				if (work[i1] == -1)
 					work[i1] = 0;
@@ -4817,10 +5260,10 @@ void SlicesHandler::Add2tissueallConnected(tissues_size_t tissuetype, Point p, b
 		p1.m_Pz = m_Activeslice;
 
 		s.push_back(p1);
-		float* work = m_ImageSlices[m_Activeslice].ReturnWork();
+		float* work = ImageSlice(m_Activeslice).ReturnWork();
 		float f = work[position];
 		tissues_size_t* tissue =
-				m_ImageSlices[m_Activeslice].ReturnTissues(m_ActiveTissuelayer);
+				ImageSlice(m_Activeslice).ReturnTissues(m_ActiveTissuelayer);
 		bool tissue_locked = TissueInfos::GetTissueLocked(tissue[position]);
 		if (tissue[position] == 0 || (override && tissue_locked == false))
 			tissue[position] = tissuetype;
@@ -4834,8 +5277,8 @@ void SlicesHandler::Add2tissueallConnected(tissues_size_t tissuetype, Point p, b
 			i = s.back();
 			s.pop_back();
 
-			work = m_ImageSlices[i.m_Pz].ReturnWork();
-			tissue = m_ImageSlices[i.m_Pz].ReturnTissues(m_ActiveTissuelayer);
+			work = ImageSlice(i.m_Pz).ReturnWork();
+			tissue = ImageSlice(i.m_Pz).ReturnTissues(m_ActiveTissuelayer);
 			//if(i.pxy%width!=0&&work[i.pxy-1]==f&&(override||tissue[i.pxy-1]==0)) {
 			if (i.m_Pxy % m_Width != 0 && work[i.m_Pxy - 1] == f &&
 					(tissue[i.m_Pxy - 1] == 0 ||
@@ -4884,9 +5327,9 @@ void SlicesHandler::Add2tissueallConnected(tissues_size_t tissuetype, Point p, b
 			}
 			if (i.m_Pz > m_Startslice)
 			{
-				work = m_ImageSlices[i.m_Pz - 1].ReturnWork();
+				work = ImageSlice(i.m_Pz - 1).ReturnWork();
 				tissue =
-						m_ImageSlices[i.m_Pz - 1].ReturnTissues(m_ActiveTissuelayer);
+						ImageSlice(i.m_Pz - 1).ReturnTissues(m_ActiveTissuelayer);
 				//if(work[i.pxy]==f&&(override||tissue[i.pxy]==0)) {
 				if (work[i.m_Pxy] == f &&
 						(tissue[i.m_Pxy] == 0 ||
@@ -4902,9 +5345,9 @@ void SlicesHandler::Add2tissueallConnected(tissues_size_t tissuetype, Point p, b
 			}
 			if (i.m_Pz + 1 < m_Endslice)
 			{
-				work = m_ImageSlices[i.m_Pz + 1].ReturnWork();
+				work = ImageSlice(i.m_Pz + 1).ReturnWork();
 				tissue =
-						m_ImageSlices[i.m_Pz + 1].ReturnTissues(m_ActiveTissuelayer);
+						ImageSlice(i.m_Pz + 1).ReturnTissues(m_ActiveTissuelayer);
 				//if(work[i.pxy]==f&&(override||tissue[i.pxy]==0)) {
 				if (work[i.m_Pxy] == f &&
 						(tissue[i.m_Pxy] == 0 ||
@@ -4920,9 +5363,9 @@ void SlicesHandler::Add2tissueallConnected(tissues_size_t tissuetype, Point p, b
 			}
 		}
 
-		for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+		for (unsigned z = m_Startslice; z < m_Endslice; z++)
 		{
-			work = m_ImageSlices[z].ReturnWork();
+			work = ImageSlice(z).ReturnWork();
 			for (unsigned i1 = 0; i1 < m_Area; i1++)
 				if (work[i1] == set_to)
 					work[i1] = f;
@@ -4943,10 +5386,10 @@ void SlicesHandler::SubtractTissueallConnected(tissues_size_t tissuetype, Point
 		p1.m_Pz = m_Activeslice;
 
 		s.push_back(p1);
-		float* work = m_ImageSlices[m_Activeslice].ReturnWork();
+		float* work = ImageSlice(m_Activeslice).ReturnWork();
 		float f = work[position];
 		tissues_size_t* tissue =
-				m_ImageSlices[m_Activeslice].ReturnTissues(m_ActiveTissuelayer);
+				ImageSlice(m_Activeslice).ReturnTissues(m_ActiveTissuelayer);
 		if (tissue[position] == tissuetype)
 			tissue[position] = tissuetype;
 		if (tissue[position] == tissuetype)
@@ -4959,8 +5402,8 @@ void SlicesHandler::SubtractTissueallConnected(tissues_size_t tissuetype, Point
 			i = s.back();
 			s.pop_back();
 
-			work = m_ImageSlices[i.m_Pz].ReturnWork();
-			tissue = m_ImageSlices[i.m_Pz].ReturnTissues(m_ActiveTissuelayer);
+			work = ImageSlice(i.m_Pz).ReturnWork();
+			tissue = ImageSlice(i.m_Pz).ReturnTissues(m_ActiveTissuelayer);
 			if (i.m_Pxy % m_Width != 0 && work[i.m_Pxy - 1] == f &&
 					tissue[i.m_Pxy - 1] == tissuetype)
 			{
@@ -4999,9 +5442,9 @@ void SlicesHandler::SubtractTissueallConnected(tissues_size_t tissuetype, Point
 			}
 			if (i.m_Pz > m_Startslice)
 			{
-				work = m_ImageSlices[i.m_Pz - 1].ReturnWork();
+				work = ImageSlice(i.m_Pz - 1).ReturnWork();
 				tissue =
-						m_ImageSlices[i.m_Pz - 1].ReturnTissues(m_ActiveTissuelayer);
+						ImageSlice(i.m_Pz - 1).ReturnTissues(m_ActiveTissuelayer);
 				if (work[i.m_Pxy] == f && tissue[i.m_Pxy] == tissuetype)
 				{
 					work[i.m_Pxy] = set_to;
@@ -5015,9 +5458,9 @@ void SlicesHandler::SubtractTissueallConnected(tissues_size_t tissuetype, Point
 			}
 			if (i.m_Pz + 1 < m_Endslice)
 			{
-				work = m_ImageSlices[i.m_Pz + 1].ReturnWork();
+				work = ImageSlice(i.m_Pz + 1).ReturnWork();
 				tissue =
-						m_ImageSlices[i.m_Pz + 1].ReturnTissues(m_ActiveTissuelayer);
+						ImageSlice(i.m_Pz + 1).ReturnTissues(m_ActiveTissuelayer);
 				if (work[i.m_Pxy] == f && tissue[i.m_Pxy] == tissuetype)
 				{
 					work[i.m_Pxy] = set_to;
@@ -5031,9 +5474,9 @@ void SlicesHandler::SubtractTissueallConnected(tissues_size_t tissuetype, Point
 			}
 		}
 
-		for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+		for (unsigned z = m_Startslice; z < m_Endslice; z++)
 		{
-			work = m_ImageSlices[z].ReturnWork();
+			work = ImageSlice(z).ReturnWork();
 			for (unsigned i1 = 0; i1 < m_Area; i1++)
 				if (work[i1] == set_to)
 					work[i1] = f;
@@ -5041,26 +5484,26 @@ void SlicesHandler::SubtractTissueallConnected(tissues_size_t tissuetype, Point
 	}
 }
 
-void SlicesHandler::DoubleHysteretic(float thresh_low_l, float thresh_low_h, float thresh_high_l, float thresh_high_h, bool connectivity, unsigned short nrpasses)
+void SlicesHandler::DoubleHysteretic(float thresh_low_l, float thresh_low_h, float thresh_high_l, float thresh_high_h, bool connectivity, unsigned nrpasses)
 {
 	float setvalue = 255;
-	unsigned short slicenr = m_Startslice;
+	unsigned slicenr = m_Startslice;
 
 	ClearWork();
 
-	m_ImageSlices[slicenr].DoubleHysteretic(thresh_low_l, thresh_low_h, thresh_high_l, thresh_high_h, connectivity, setvalue);
+	ImageSlice(slicenr).DoubleHysteretic(thresh_low_l, thresh_low_h, thresh_high_l, thresh_high_h, connectivity, setvalue);
 	//	if(nrslices>1) {
-	for (unsigned short i = 0; i < nrpasses; i++)
+	for (unsigned i = 0; i < nrpasses; i++)
 	{
 		while (++slicenr < m_Endslice)
 		{
-			m_ImageSlices[slicenr].DoubleHysteretic(thresh_low_l, thresh_low_h, thresh_high_l, thresh_high_h, connectivity, m_ImageSlices[slicenr - 1].ReturnWork(), setvalue - 1, setvalue);
+			ImageSlice(slicenr).DoubleHysteretic(thresh_low_l, thresh_low_h, thresh_high_l, thresh_high_h, connectivity, ImageSlice(slicenr - 1).ReturnWork(), setvalue - 1, setvalue);
 		}
 		setvalue++;
 		slicenr--;
 		while (slicenr-- > m_Startslice)
 		{
-			m_ImageSlices[slicenr].DoubleHysteretic(thresh_low_l, thresh_low_h, thresh_high_l, thresh_high_h, connectivity, m_ImageSlices[slicenr + 1].ReturnWork(), setvalue - 1, setvalue);
+			ImageSlice(slicenr).DoubleHysteretic(thresh_low_l, thresh_low_h, thresh_high_l, thresh_high_h, connectivity, ImageSlice(slicenr + 1).ReturnWork(), setvalue - 1, setvalue);
 		}
 		setvalue++;
 		slicenr = 0;
@@ -5078,13 +5521,13 @@ void SlicesHandler::DoubleHysteretic(float thresh_low_l, float thresh_low_h, flo
 
 void SlicesHandler::DoubleHystereticAllslices(float thresh_low_l, float thresh_low_h, float thresh_high_l, float thresh_high_h, bool connectivity, float set_to)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		m_ImageSlices[i].DoubleHysteretic(thresh_low_l, thresh_low_h, thresh_high_l, thresh_high_h, connectivity, set_to);
+		ImageSlice(i).DoubleHysteretic(thresh_low_l, thresh_low_h, thresh_high_l, thresh_high_h, connectivity, set_to);
 	}
 }
 
-void SlicesHandler::Interpolateworkgrey(unsigned short slice1, unsigned short slice2, bool connected)
+void SlicesHandler::Interpolateworkgrey(unsigned slice1, unsigned slice2, bool connected)
 {
 	if (slice2 < slice1)
 	{
@@ -5098,23 +5541,23 @@ void SlicesHandler::Interpolateworkgrey(unsigned short slice1, unsigned short sl
 	const short n = slice2 - slice1;
 	if (!connected)
 	{
-		m_ImageSlices[slice1].PushstackBmp();
-		m_ImageSlices[slice2].PushstackBmp();
+		ImageSlice(slice1).PushstackBmp();
+		ImageSlice(slice2).PushstackBmp();
 
-		m_ImageSlices[slice1].SwapBmpwork();
-		m_ImageSlices[slice2].SwapBmpwork();
+		ImageSlice(slice1).SwapBmpwork();
+		ImageSlice(slice2).SwapBmpwork();
 
-		m_ImageSlices[slice2].DeadReckoning();
-		m_ImageSlices[slice1].DeadReckoning();
+		ImageSlice(slice2).DeadReckoning();
+		ImageSlice(slice1).DeadReckoning();
 
-		float* bmp1 = m_ImageSlices[slice1].ReturnBmp();
-		float* bmp2 = m_ImageSlices[slice2].ReturnBmp();
-		float* work1 = m_ImageSlices[slice1].ReturnWork();
-		float* work2 = m_ImageSlices[slice2].ReturnWork();
+		float* bmp1 = ImageSlice(slice1).ReturnBmp();
+		float* bmp2 = ImageSlice(slice2).ReturnBmp();
+		float* work1 = ImageSlice(slice1).ReturnWork();
+		float* work2 = ImageSlice(slice2).ReturnWork();
 
 		Point p;
 		float prop;
-		unsigned short n1;
+		unsigned n1;
 		unsigned i1 = 0;
 
 		for (p.py = 0; p.py < m_Height; p.py++)
@@ -5125,29 +5568,29 @@ void SlicesHandler::Interpolateworkgrey(unsigned short slice1, unsigned short sl
 					prop = work1[i1] / (work2[i1] + work1[i1]);
 				else
 					prop = 0.5f;
-				n1 = (unsigned short)n * prop;
-				for (unsigned short j = 1; j <= n1 && j < n; j++)
+				n1 = (unsigned)n * prop;
+				for (unsigned j = 1; j <= n1 && j < n; j++)
 				{
-					m_ImageSlices[slice1 + j].SetWorkPt(p, bmp1[i1]);
+					ImageSlice(slice1 + j).SetWorkPt(p, bmp1[i1]);
 				}
-				for (unsigned short j = n1 + 1; j < n; j++)
+				for (unsigned j = n1 + 1; j < n; j++)
 				{
-					m_ImageSlices[slice1 + j].SetWorkPt(p, bmp2[i1]);
+					ImageSlice(slice1 + j).SetWorkPt(p, bmp2[i1]);
 				}
 				i1++;
 			}
 		}
 
-		m_ImageSlices[slice1].SwapBmpwork();
-		m_ImageSlices[slice2].SwapBmpwork();
+		ImageSlice(slice1).SwapBmpwork();
+		ImageSlice(slice2).SwapBmpwork();
 
-		for (unsigned short j = 1; j < n; j++)
+		for (unsigned j = 1; j < n; j++)
 		{
 			m_ImageSlices[slice1 + j].SetMode(2, false);
 		}
 
-		m_ImageSlices[slice2].PopstackBmp();
-		m_ImageSlices[slice1].PopstackBmp();
+		ImageSlice(slice2).PopstackBmp();
+		ImageSlice(slice1).PopstackBmp();
 	}
 	else
 	{
@@ -5166,7 +5609,7 @@ void SlicesHandler::Interpolateworkgrey(unsigned short slice1, unsigned short sl
 				const float* source = slice->GetPixelContainer()->GetImportPointer();
 				size_t source_len = slice->GetPixelContainer()->Size();
 				// copy to target (idx = slice1 + i + 1)
-				float* target = m_ImageSlices[slice1 + i + 1].ReturnWork();
+				float* target = ImageSlice(slice1 + i + 1).ReturnWork();
 				std::copy(source, source + source_len, target);
 			}
 		}
@@ -5177,14 +5620,14 @@ void SlicesHandler::Interpolateworkgrey(unsigned short slice1, unsigned short sl
 	}
 }
 
-void SlicesHandler::InterpolateworkgreyMedianset(unsigned short slice1, unsigned short slice2, bool connectivity, bool handleVanishingComp)
+void SlicesHandler::InterpolateworkgreyMedianset(unsigned slice1, unsigned slice2, bool connectivity, bool handleVanishingComp)
 {
 	// Beucher et al.: "Sets, Partitions and Functions Interpolations"
 	// Modified algorithm: Do not interplate vanishing components
 
 	if (slice2 < slice1)
 	{
-		unsigned short dummy = slice1;
+		unsigned dummy = slice1;
 		slice1 = slice2;
 		slice2 = dummy;
 	}
@@ -5196,27 +5639,27 @@ void SlicesHandler::InterpolateworkgreyMedianset(unsigned short slice1, unsigned
 		const short slicehalf = slice1 + (short)(0.5f * n);
 		unsigned int n_cells = 0;
 		Pair work_range;
-		m_ImageSlices[slice1].GetRange(&work_range);
+		ImageSlice(slice1).GetRange(&work_range);
 		n_cells = std::max(n_cells, (unsigned int)(work_range.high + 0.5f));
-		m_ImageSlices[slice2].GetRange(&work_range);
+		ImageSlice(slice2).GetRange(&work_range);
 		n_cells = std::max(n_cells, (unsigned int)(work_range.high + 0.5f));
-		unsigned short max_iterations =
-				(unsigned short)std::sqrt((float)(m_Width * m_Width + m_Height * m_Height));
+		unsigned max_iterations =
+				(unsigned)std::sqrt((float)(m_Width * m_Width + m_Height * m_Height));
 
 		// Backup images
-		m_ImageSlices[slice1].PushstackWork();
-		m_ImageSlices[slice2].PushstackWork();
-		m_ImageSlices[slice1].PushstackBmp();
-		m_ImageSlices[slicehalf].PushstackBmp();
-		m_ImageSlices[slice2].PushstackBmp();
+		ImageSlice(slice1).PushstackWork();
+		ImageSlice(slice2).PushstackWork();
+		ImageSlice(slice1).PushstackBmp();
+		ImageSlice(slicehalf).PushstackBmp();
+		ImageSlice(slice2).PushstackBmp();
 
 		// Interplation input to bmp
-		m_ImageSlices[slice1].SwapBmpwork();
-		m_ImageSlices[slice2].SwapBmpwork();
+		ImageSlice(slice1).SwapBmpwork();
+		ImageSlice(slice2).SwapBmpwork();
 
 		// Input images
-		float* f_1 = m_ImageSlices[slice1].ReturnBmp();
-		float* f_2 = m_ImageSlices[slice2].ReturnBmp();
+		float* f_1 = ImageSlice(slice1).ReturnBmp();
+		float* f_2 = ImageSlice(slice2).ReturnBmp();
 
 		if (handleVanishingComp)
 		{
@@ -5228,11 +5671,11 @@ void SlicesHandler::InterpolateworkgreyMedianset(unsigned short slice1, unsigned
 			float* connected_comp_backward =
 					(float*)malloc(sizeof(float) * m_Area);
 
-			m_ImageSlices[slice1].ConnectedComponents(false, vanishing_comp_forward); // TODO: connectivity?
-			m_ImageSlices[slice1].Copyfromwork(connected_comp_forward);
+			ImageSlice(slice1).ConnectedComponents(false, vanishing_comp_forward); // TODO: connectivity?
+			ImageSlice(slice1).Copyfromwork(connected_comp_forward);
 
-			m_ImageSlices[slice2].ConnectedComponents(false, vanishing_comp_backward); // TODO: connectivity?
-			m_ImageSlices[slice2].Copyfromwork(connected_comp_backward);
+			ImageSlice(slice2).ConnectedComponents(false, vanishing_comp_backward); // TODO: connectivity?
+			ImageSlice(slice2).Copyfromwork(connected_comp_backward);
 
 			for (unsigned int i = 0; i < m_Area; ++i)
 			{
@@ -5275,8 +5718,8 @@ void SlicesHandler::InterpolateworkgreyMedianset(unsigned short slice1, unsigned
 		}
 
 		// Interpolation results
-		float* g_i = m_ImageSlices[slicehalf].ReturnWork();
-		float* gp_i = m_ImageSlices[slicehalf].ReturnBmp();
+		float* g_i = ImageSlice(slicehalf).ReturnWork();
+		float* gp_i = ImageSlice(slicehalf).ReturnBmp();
 
 		// Initialize g_0 and gp_0
 		for (unsigned int i = 0; i < m_Area; ++i)
@@ -5295,22 +5738,22 @@ void SlicesHandler::InterpolateworkgreyMedianset(unsigned short slice1, unsigned
 
 		// Interpolation
 		bool idempotence = false;
-		for (unsigned short iter = 0; iter < max_iterations && !idempotence;
+		for (unsigned iter = 0; iter < max_iterations && !idempotence;
 				 iter++)
 		{
 			// Dilate g_i and gp_i --> g_i_B and gp_i_B
 			if (iter % 2 == 0)
 			{
-				m_ImageSlices[slice1].Copy2work(g_i, 1);
-				m_ImageSlices[slice1].Dilation(1, connectivity);
+				ImageSlice(slice1).Copy2work(g_i, 1);
+				ImageSlice(slice1).Dilation(1, connectivity);
 			}
 			else
 			{
-				m_ImageSlices[slice2].Copy2work(gp_i, 1);
-				m_ImageSlices[slice2].Dilation(1, connectivity);
+				ImageSlice(slice2).Copy2work(gp_i, 1);
+				ImageSlice(slice2).Dilation(1, connectivity);
 			}
-			float* g_i_b = m_ImageSlices[slice1].ReturnWork();
-			float* gp_i_b = m_ImageSlices[slice2].ReturnWork();
+			float* g_i_b = ImageSlice(slice1).ReturnWork();
+			float* gp_i_b = ImageSlice(slice2).ReturnWork();
 
 			// Compute g_i+1 and gp_i+1
 			idempotence = true;
@@ -5342,30 +5785,30 @@ void SlicesHandler::InterpolateworkgreyMedianset(unsigned short slice1, unsigned
 
 		if (handleVanishingComp)
 		{
-			m_ImageSlices[slice1].Copy2work(f_1, 1);
-			m_ImageSlices[slice2].Copy2work(f_2, 1);
+			ImageSlice(slice1).Copy2work(f_1, 1);
+			ImageSlice(slice2).Copy2work(f_2, 1);
 
 			// Restore images
-			m_ImageSlices[slice2].PopstackBmp();
-			m_ImageSlices[slicehalf].PopstackBmp();
-			m_ImageSlices[slice1].PopstackBmp();
+			ImageSlice(slice2).PopstackBmp();
+			ImageSlice(slicehalf).PopstackBmp();
+			ImageSlice(slice1).PopstackBmp();
 
 			// Recursion
 			InterpolateworkgreyMedianset(slice1, slicehalf, connectivity, false);
 			InterpolateworkgreyMedianset(slicehalf, slice2, connectivity, false);
 
 			// Restore images
-			m_ImageSlices[slice2].PopstackWork();
-			m_ImageSlices[slice1].PopstackWork();
+			ImageSlice(slice2).PopstackWork();
+			ImageSlice(slice1).PopstackWork();
 		}
 		else
 		{
 			// Restore images
-			m_ImageSlices[slice2].PopstackBmp();
-			m_ImageSlices[slicehalf].PopstackBmp();
-			m_ImageSlices[slice1].PopstackBmp();
-			m_ImageSlices[slice2].PopstackWork();
-			m_ImageSlices[slice1].PopstackWork();
+			ImageSlice(slice2).PopstackBmp();
+			ImageSlice(slicehalf).PopstackBmp();
+			ImageSlice(slice1).PopstackBmp();
+			ImageSlice(slice2).PopstackWork();
+			ImageSlice(slice1).PopstackWork();
 
 			// Recursion
 			InterpolateworkgreyMedianset(slice1, slicehalf, connectivity, false);
@@ -5374,11 +5817,11 @@ void SlicesHandler::InterpolateworkgreyMedianset(unsigned short slice1, unsigned
 	}
 }
 
-void SlicesHandler::Interpolatetissuegrey(unsigned short slice1, unsigned short slice2)
+void SlicesHandler::Interpolatetissuegrey(unsigned slice1, unsigned slice2)
 {
 	if (slice2 < slice1)
 	{
-		unsigned short dummy = slice1;
+		unsigned dummy = slice1;
 		slice1 = slice2;
 		slice2 = dummy;
 	}
@@ -5387,30 +5830,30 @@ void SlicesHandler::Interpolatetissuegrey(unsigned short slice1, unsigned short
 
 	if (n > 0)
 	{
-		m_ImageSlices[slice1].PushstackBmp();
-		m_ImageSlices[slice2].PushstackBmp();
-		m_ImageSlices[slice1].PushstackWork();
-		m_ImageSlices[slice2].PushstackWork();
+		ImageSlice(slice1).PushstackBmp();
+		ImageSlice(slice2).PushstackBmp();
+		ImageSlice(slice1).PushstackWork();
+		ImageSlice(slice2).PushstackWork();
 
-		m_ImageSlices[slice1].Tissue2work(m_ActiveTissuelayer);
-		m_ImageSlices[slice2].Tissue2work(m_ActiveTissuelayer);
+		ImageSlice(slice1).Tissue2work(m_ActiveTissuelayer);
+		ImageSlice(slice2).Tissue2work(m_ActiveTissuelayer);
 
-		m_ImageSlices[slice1].SwapBmpwork();
-		m_ImageSlices[slice2].SwapBmpwork();
+		ImageSlice(slice1).SwapBmpwork();
+		ImageSlice(slice2).SwapBmpwork();
 
-		m_ImageSlices[slice2].DeadReckoning();
-		m_ImageSlices[slice1].DeadReckoning();
+		ImageSlice(slice2).DeadReckoning();
+		ImageSlice(slice1).DeadReckoning();
 
 		tissues_size_t* bmp1 =
-				m_ImageSlices[slice1].ReturnTissues(m_ActiveTissuelayer);
+				ImageSlice(slice1).ReturnTissues(m_ActiveTissuelayer);
 		tissues_size_t* bmp2 =
-				m_ImageSlices[slice2].ReturnTissues(m_ActiveTissuelayer);
-		float* work1 = m_ImageSlices[slice1].ReturnWork();
-		float* work2 = m_ImageSlices[slice2].ReturnWork();
+				ImageSlice(slice2).ReturnTissues(m_ActiveTissuelayer);
+		float* work1 = ImageSlice(slice1).ReturnWork();
+		float* work2 = ImageSlice(slice2).ReturnWork();
 
 		Point p;
 		float prop;
-		unsigned short n1;
+		unsigned n1;
 		unsigned i1 = 0;
 
 		for (p.py = 0; p.py < m_Height; p.py++)
@@ -5421,39 +5864,39 @@ void SlicesHandler::Interpolatetissuegrey(unsigned short slice1, unsigned short
 					prop = work1[i1] / (work2[i1] + work1[i1]);
 				else
 					prop = 0.5f;
-				n1 = (unsigned short)n * prop;
-				for (unsigned short j = 1; j <= n1 && j < n; j++)
+				n1 = (unsigned)n * prop;
+				for (unsigned j = 1; j <= n1 && j < n; j++)
 				{
-					m_ImageSlices[slice1 + j].SetTissuePt(m_ActiveTissuelayer, p, bmp1[i1]);
+					ImageSlice(slice1 + j).SetTissuePt(m_ActiveTissuelayer, p, bmp1[i1]);
 				}
-				for (unsigned short j = n1 + 1; j < n; j++)
+				for (unsigned j = n1 + 1; j < n; j++)
 				{
-					m_ImageSlices[slice1 + j].SetTissuePt(m_ActiveTissuelayer, p, bmp2[i1]);
+					ImageSlice(slice1 + j).SetTissuePt(m_ActiveTissuelayer, p, bmp2[i1]);
 				}
 				i1++;
 			}
 		}
 
-		for (unsigned short j = 1; j < n; j++)
+		for (unsigned j = 1; j < n; j++)
 		{
 			m_ImageSlices[slice1 + j].SetMode(2, false);
 		}
 
-		m_ImageSlices[slice1].PopstackWork();
-		m_ImageSlices[slice2].PopstackWork();
-		m_ImageSlices[slice2].PopstackBmp();
-		m_ImageSlices[slice1].PopstackBmp();
+		ImageSlice(slice1).PopstackWork();
+		ImageSlice(slice2).PopstackWork();
+		ImageSlice(slice2).PopstackBmp();
+		ImageSlice(slice1).PopstackBmp();
 	}
 }
 
 #if 0
-void SlicesHandler::interpolatetissuegrey_medianset(unsigned short slice1, unsigned short slice2, bool connectivity)
+void SlicesHandler::interpolatetissuegrey_medianset(unsigned slice1, unsigned slice2, bool connectivity)
 {
 	// Beucher et al.: "Sets, Partitions and Functions Interpolations"
 	// Original algorithm: Unsound interpolation of vanishing components
 
 	if(slice2<slice1){
-		unsigned short dummy=slice1;
+		unsigned dummy=slice1;
 		slice1=slice2;
 		slice2=dummy;
 	}
@@ -5463,7 +5906,7 @@ void SlicesHandler::interpolatetissuegrey_medianset(unsigned short slice1, unsig
 	if(n>1){
 		const short slicehalf = slice1 + (short)(0.5f*n);
 		unsigned int nCells = TISSUES_SIZE_MAX;
-		unsigned short max_iterations = (unsigned short)std::sqrt((float)(width*width+height*height));
+		unsigned max_iterations = (unsigned)std::sqrt((float)(width*width+height*height));
 
 		// Backup images
 		image_slices[slice1].pushstack_work();
@@ -5498,7 +5941,7 @@ void SlicesHandler::interpolatetissuegrey_medianset(unsigned short slice1, unsig
 
 		// Interpolation
 		bool idempotence = false;
-		for(unsigned short iter = 0; iter < max_iterations && !idempotence; iter++) {
+		for(unsigned iter = 0; iter < max_iterations && !idempotence; iter++) {
 
 			// Dilate g_i and gp_i --> g_i_B and gp_i_B
 			if (iter%2 == 0) {
@@ -5550,14 +5993,14 @@ void SlicesHandler::interpolatetissuegrey_medianset(unsigned short slice1, unsig
 }
 #endif
 
-void SlicesHandler::InterpolatetissuegreyMedianset(unsigned short slice1, unsigned short slice2, bool connectivity, bool handleVanishingComp)
+void SlicesHandler::InterpolatetissuegreyMedianset(unsigned slice1, unsigned slice2, bool connectivity, bool handleVanishingComp)
 {
 	// Beucher et al.: "Sets, Partitions and Functions Interpolations"
 	// Modified algorithm: Do not interplate vanishing components
 
 	if (slice2 < slice1)
 	{
-		unsigned short dummy = slice1;
+		unsigned dummy = slice1;
 		slice1 = slice2;
 		slice2 = dummy;
 	}
@@ -5568,37 +6011,37 @@ void SlicesHandler::InterpolatetissuegreyMedianset(unsigned short slice1, unsign
 	{
 		const short slicehalf = slice1 + (short)(0.5f * n);
 		unsigned int n_cells = TISSUES_SIZE_MAX;
-		unsigned short max_iterations =
-				(unsigned short)std::sqrt((float)(m_Width * m_Width + m_Height * m_Height));
+		unsigned max_iterations =
+				(unsigned)std::sqrt((float)(m_Width * m_Width + m_Height * m_Height));
 
 		// Backup images
-		m_ImageSlices[slice1].PushstackWork();
-		m_ImageSlices[slicehalf].PushstackWork();
-		m_ImageSlices[slice2].PushstackWork();
-		m_ImageSlices[slice1].PushstackBmp();
-		m_ImageSlices[slicehalf].PushstackBmp();
-		m_ImageSlices[slice2].PushstackBmp();
+		ImageSlice(slice1).PushstackWork();
+		ImageSlice(slicehalf).PushstackWork();
+		ImageSlice(slice2).PushstackWork();
+		ImageSlice(slice1).PushstackBmp();
+		ImageSlice(slicehalf).PushstackBmp();
+		ImageSlice(slice2).PushstackBmp();
 		tissues_size_t* tissue1_copy = nullptr;
 		tissues_size_t* tissue2_copy = nullptr;
 		if (handleVanishingComp)
 		{
 			tissue1_copy =
 					(tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area);
-			m_ImageSlices[slice1].Copyfromtissue(m_ActiveTissuelayer, tissue1_copy);
+			ImageSlice(slice1).Copyfromtissue(m_ActiveTissuelayer, tissue1_copy);
 			tissue2_copy =
 					(tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area);
-			m_ImageSlices[slice2].Copyfromtissue(m_ActiveTissuelayer, tissue2_copy);
+			ImageSlice(slice2).Copyfromtissue(m_ActiveTissuelayer, tissue2_copy);
 		}
 
 		// Interplation input to bmp
-		m_ImageSlices[slice1].Tissue2work(m_ActiveTissuelayer);
-		m_ImageSlices[slice2].Tissue2work(m_ActiveTissuelayer);
-		m_ImageSlices[slice1].SwapBmpwork();
-		m_ImageSlices[slice2].SwapBmpwork();
+		ImageSlice(slice1).Tissue2work(m_ActiveTissuelayer);
+		ImageSlice(slice2).Tissue2work(m_ActiveTissuelayer);
+		ImageSlice(slice1).SwapBmpwork();
+		ImageSlice(slice2).SwapBmpwork();
 
 		// Input images
-		float* f_1 = m_ImageSlices[slice1].ReturnBmp();
-		float* f_2 = m_ImageSlices[slice2].ReturnBmp();
+		float* f_1 = ImageSlice(slice1).ReturnBmp();
+		float* f_2 = ImageSlice(slice2).ReturnBmp();
 
 		if (handleVanishingComp)
 		{
@@ -5610,11 +6053,11 @@ void SlicesHandler::InterpolatetissuegreyMedianset(unsigned short slice1, unsign
 			float* connected_comp_backward =
 					(float*)malloc(sizeof(float) * m_Area);
 
-			m_ImageSlices[slice1].ConnectedComponents(false, vanishing_comp_forward); // TODO: connectivity?
-			m_ImageSlices[slice1].Copyfromwork(connected_comp_forward);
+			ImageSlice(slice1).ConnectedComponents(false, vanishing_comp_forward); // TODO: connectivity?
+			ImageSlice(slice1).Copyfromwork(connected_comp_forward);
 
-			m_ImageSlices[slice2].ConnectedComponents(false, vanishing_comp_backward); // TODO: connectivity?
-			m_ImageSlices[slice2].Copyfromwork(connected_comp_backward);
+			ImageSlice(slice2).ConnectedComponents(false, vanishing_comp_backward); // TODO: connectivity?
+			ImageSlice(slice2).Copyfromwork(connected_comp_backward);
 
 			for (unsigned int i = 0; i < m_Area; ++i)
 			{
@@ -5636,9 +6079,9 @@ void SlicesHandler::InterpolatetissuegreyMedianset(unsigned short slice1, unsign
 
 			// Remove vanishing components for interpolation
 			tissues_size_t* tissue1 =
-					m_ImageSlices[slice1].ReturnTissues(m_ActiveTissuelayer);
+					ImageSlice(slice1).ReturnTissues(m_ActiveTissuelayer);
 			tissues_size_t* tissue2 =
-					m_ImageSlices[slice2].ReturnTissues(m_ActiveTissuelayer);
+					ImageSlice(slice2).ReturnTissues(m_ActiveTissuelayer);
 			for (unsigned int i = 0; i < m_Area; ++i)
 			{
 				std::set<float>::iterator iter =
@@ -5661,19 +6104,19 @@ void SlicesHandler::InterpolatetissuegreyMedianset(unsigned short slice1, unsign
 			free(connected_comp_backward);
 
 			// Interplation modified input to bmp
-			m_ImageSlices[slice1].Tissue2work(m_ActiveTissuelayer);
-			m_ImageSlices[slice2].Tissue2work(m_ActiveTissuelayer);
-			m_ImageSlices[slice1].SwapBmpwork();
-			m_ImageSlices[slice2].SwapBmpwork();
+			ImageSlice(slice1).Tissue2work(m_ActiveTissuelayer);
+			ImageSlice(slice2).Tissue2work(m_ActiveTissuelayer);
+			ImageSlice(slice1).SwapBmpwork();
+			ImageSlice(slice2).SwapBmpwork();
 
 			// Input images
-			f_1 = m_ImageSlices[slice1].ReturnBmp();
-			f_2 = m_ImageSlices[slice2].ReturnBmp();
+			f_1 = ImageSlice(slice1).ReturnBmp();
+			f_2 = ImageSlice(slice2).ReturnBmp();
 		}
 
 		// Interpolation results
-		float* g_i = m_ImageSlices[slicehalf].ReturnWork();
-		float* gp_i = m_ImageSlices[slicehalf].ReturnBmp();
+		float* g_i = ImageSlice(slicehalf).ReturnWork();
+		float* gp_i = ImageSlice(slicehalf).ReturnBmp();
 
 		// Initialize g_0 and gp_0
 		for (unsigned int i = 0; i < m_Area; ++i)
@@ -5692,22 +6135,22 @@ void SlicesHandler::InterpolatetissuegreyMedianset(unsigned short slice1, unsign
 
 		// Interpolation
 		bool idempotence = false;
-		for (unsigned short iter = 0; iter < max_iterations && !idempotence;
+		for (unsigned iter = 0; iter < max_iterations && !idempotence;
 				 iter++)
 		{
 			// Dilate g_i and gp_i --> g_i_B and gp_i_B
 			if (iter % 2 == 0)
 			{
-				m_ImageSlices[slice1].Copy2work(g_i, 1);
-				m_ImageSlices[slice1].Dilation(1, connectivity);
+				ImageSlice(slice1).Copy2work(g_i, 1);
+				ImageSlice(slice1).Dilation(1, connectivity);
 			}
 			else
 			{
-				m_ImageSlices[slice2].Copy2work(gp_i, 1);
-				m_ImageSlices[slice2].Dilation(1, connectivity);
+				ImageSlice(slice2).Copy2work(gp_i, 1);
+				ImageSlice(slice2).Dilation(1, connectivity);
 			}
-			float* g_i_b = m_ImageSlices[slice1].ReturnWork();
-			float* gp_i_b = m_ImageSlices[slice2].ReturnWork();
+			float* g_i_b = ImageSlice(slice1).ReturnWork();
+			float* gp_i_b = ImageSlice(slice2).ReturnWork();
 
 			// Compute g_i+1 and gp_i+1
 			idempotence = true;
@@ -5738,15 +6181,15 @@ void SlicesHandler::InterpolatetissuegreyMedianset(unsigned short slice1, unsign
 		}
 
 		// Assign tissues
-		m_ImageSlices[slicehalf].Work2tissue(m_ActiveTissuelayer);
+		ImageSlice(slicehalf).Work2tissue(m_ActiveTissuelayer);
 
 		// Restore images
-		m_ImageSlices[slice2].PopstackBmp();
-		m_ImageSlices[slicehalf].PopstackBmp();
-		m_ImageSlices[slice1].PopstackBmp();
-		m_ImageSlices[slice2].PopstackWork();
-		m_ImageSlices[slicehalf].PopstackWork();
-		m_ImageSlices[slice1].PopstackWork();
+		ImageSlice(slice2).PopstackBmp();
+		ImageSlice(slicehalf).PopstackBmp();
+		ImageSlice(slice1).PopstackBmp();
+		ImageSlice(slice2).PopstackWork();
+		ImageSlice(slicehalf).PopstackWork();
+		ImageSlice(slice1).PopstackWork();
 
 		// Recursion
 		InterpolatetissuegreyMedianset(slice1, slicehalf, connectivity, false);
@@ -5755,15 +6198,15 @@ void SlicesHandler::InterpolatetissuegreyMedianset(unsigned short slice1, unsign
 		// Restore tissues
 		if (handleVanishingComp)
 		{
-			m_ImageSlices[slice1].Copy2tissue(m_ActiveTissuelayer, tissue1_copy);
-			m_ImageSlices[slice2].Copy2tissue(m_ActiveTissuelayer, tissue2_copy);
+			ImageSlice(slice1).Copy2tissue(m_ActiveTissuelayer, tissue1_copy);
+			ImageSlice(slice2).Copy2tissue(m_ActiveTissuelayer, tissue2_copy);
 			free(tissue1_copy);
 			free(tissue2_copy);
 		}
 	}
 }
 
-void SlicesHandler::Interpolatetissue(unsigned short slice1, unsigned short slice2, tissues_size_t tissuetype, bool connected)
+void SlicesHandler::Interpolatetissue(unsigned slice1, unsigned slice2, tissues_size_t tissuetype, bool connected)
 {
 	if (slice2 < slice1)
 	{
@@ -5777,23 +6220,23 @@ void SlicesHandler::Interpolatetissue(unsigned short slice1, unsigned short slic
 	const short n = slice2 - slice1;
 	if (!connected)
 	{
-		tissues_size_t* tissue1 = m_ImageSlices[slice1].ReturnTissues(m_ActiveTissuelayer);
-		tissues_size_t* tissue2 = m_ImageSlices[slice2].ReturnTissues(m_ActiveTissuelayer);
-		m_ImageSlices[slice1].PushstackBmp();
-		m_ImageSlices[slice2].PushstackBmp();
-		float* bmp1 = m_ImageSlices[slice1].ReturnBmp();
-		float* bmp2 = m_ImageSlices[slice2].ReturnBmp();
+		tissues_size_t* tissue1 = ImageSlice(slice1).ReturnTissues(m_ActiveTissuelayer);
+		tissues_size_t* tissue2 = ImageSlice(slice2).ReturnTissues(m_ActiveTissuelayer);
+		ImageSlice(slice1).PushstackBmp();
+		ImageSlice(slice2).PushstackBmp();
+		float* bmp1 = ImageSlice(slice1).ReturnBmp();
+		float* bmp2 = ImageSlice(slice2).ReturnBmp();
 		for (unsigned int i = 0; i < m_Area; i++)
 		{
 			bmp1[i] = (float)tissue1[i];
 			bmp2[i] = (float)tissue2[i];
 		}
 
-		m_ImageSlices[slice2].DeadReckoning((float)tissuetype);
-		m_ImageSlices[slice1].DeadReckoning((float)tissuetype);
+		ImageSlice(slice2).DeadReckoning((float)tissuetype);
+		ImageSlice(slice1).DeadReckoning((float)tissuetype);
 
-		bmp1 = m_ImageSlices[slice1].ReturnWork();
-		bmp2 = m_ImageSlices[slice2].ReturnWork();
+		bmp1 = ImageSlice(slice1).ReturnWork();
+		bmp2 = ImageSlice(slice2).ReturnWork();
 		const short n = slice2 - slice1;
 		Point p;
 		float delta;
@@ -5804,12 +6247,12 @@ void SlicesHandler::Interpolatetissue(unsigned short slice1, unsigned short slic
 			for (p.px = 0; p.px < m_Width; p.px++)
 			{
 				delta = (bmp2[i1] - bmp1[i1]) / n;
-				for (unsigned short j = 1; j < n; j++)
+				for (unsigned j = 1; j < n; j++)
 				{
 					if (bmp1[i1] + delta * j >= 0)
-						m_ImageSlices[slice1 + j].SetWorkPt(p, 255.0f);
+						ImageSlice(slice1 + j).SetWorkPt(p, 255.0f);
 					else
-						m_ImageSlices[slice1 + j].SetWorkPt(p, 0.0f);
+						ImageSlice(slice1 + j).SetWorkPt(p, 0.0f);
 				}
 				i1++;
 			}
@@ -5827,13 +6270,13 @@ void SlicesHandler::Interpolatetissue(unsigned short slice1, unsigned short slic
 				bmp2[i] = 255.0f;
 		}
 
-		for (unsigned short j = 1; j < n; j++)
+		for (unsigned j = 1; j < n; j++)
 		{
 			m_ImageSlices[slice1 + j].SetMode(2, false);
 		}
 
-		m_ImageSlices[slice2].PopstackBmp();
-		m_ImageSlices[slice1].PopstackBmp();
+		ImageSlice(slice2).PopstackBmp();
+		ImageSlice(slice1).PopstackBmp();
 	}
 	else
 	{
@@ -5852,7 +6295,7 @@ void SlicesHandler::Interpolatetissue(unsigned short slice1, unsigned short slic
 				const float* source = slice->GetPixelContainer()->GetImportPointer();
 				size_t source_len = slice->GetPixelContainer()->Size();
 				// copy to target (idx = slice1 + i), slice1 is included
-				float* target = m_ImageSlices[slice1 + i].ReturnWork();
+				float* target = ImageSlice(slice1 + i).ReturnWork();
 				std::copy(source, source + source_len, target);
 			}
 		}
@@ -5863,46 +6306,46 @@ void SlicesHandler::Interpolatetissue(unsigned short slice1, unsigned short slic
 	}
 }
 
-void SlicesHandler::InterpolatetissueMedianset(unsigned short slice1, unsigned short slice2, tissues_size_t tissuetype, bool connectivity, bool handleVanishingComp)
+void SlicesHandler::InterpolatetissueMedianset(unsigned slice1, unsigned slice2, tissues_size_t tissuetype, bool connectivity, bool handleVanishingComp)
 {
 	std::vector<float> mask(TissueLocks().size() + 1, 0.0f);
 	mask.at(tissuetype) = 255.0f;
 
-	m_ImageSlices[slice1].Tissue2work(m_ActiveTissuelayer, mask);
-	m_ImageSlices[slice2].Tissue2work(m_ActiveTissuelayer, mask);
+	ImageSlice(slice1).Tissue2work(m_ActiveTissuelayer, mask);
+	ImageSlice(slice2).Tissue2work(m_ActiveTissuelayer, mask);
 	InterpolateworkgreyMedianset(slice1, slice2, connectivity, true);
 }
 
-void SlicesHandler::Extrapolatetissue(unsigned short origin1, unsigned short origin2, unsigned short target, tissues_size_t tissuetype)
+void SlicesHandler::Extrapolatetissue(unsigned origin1, unsigned origin2, unsigned target, tissues_size_t tissuetype)
 {
 	if (origin2 < origin1)
 	{
-		unsigned short dummy = origin1;
+		unsigned dummy = origin1;
 		origin1 = origin2;
 		origin2 = dummy;
 	}
 
 	tissues_size_t* tissue1 =
-			m_ImageSlices[origin1].ReturnTissues(m_ActiveTissuelayer);
+			ImageSlice(origin1).ReturnTissues(m_ActiveTissuelayer);
 	tissues_size_t* tissue2 =
-			m_ImageSlices[origin2].ReturnTissues(m_ActiveTissuelayer);
-	m_ImageSlices[origin1].PushstackBmp();
-	m_ImageSlices[origin2].PushstackBmp();
-	m_ImageSlices[origin1].PushstackWork();
-	m_ImageSlices[origin2].PushstackWork();
-	float* bmp1 = m_ImageSlices[origin1].ReturnBmp();
-	float* bmp2 = m_ImageSlices[origin2].ReturnBmp();
+			ImageSlice(origin2).ReturnTissues(m_ActiveTissuelayer);
+	ImageSlice(origin1).PushstackBmp();
+	ImageSlice(origin2).PushstackBmp();
+	ImageSlice(origin1).PushstackWork();
+	ImageSlice(origin2).PushstackWork();
+	float* bmp1 = ImageSlice(origin1).ReturnBmp();
+	float* bmp2 = ImageSlice(origin2).ReturnBmp();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
 		bmp1[i] = (float)tissue1[i];
 		bmp2[i] = (float)tissue2[i];
 	}
 
-	m_ImageSlices[origin1].DeadReckoning((float)tissuetype);
-	m_ImageSlices[origin2].DeadReckoning((float)tissuetype);
+	ImageSlice(origin1).DeadReckoning((float)tissuetype);
+	ImageSlice(origin2).DeadReckoning((float)tissuetype);
 
-	bmp1 = m_ImageSlices[origin1].ReturnWork();
-	bmp2 = m_ImageSlices[origin2].ReturnWork();
+	bmp1 = ImageSlice(origin1).ReturnWork();
+	bmp2 = ImageSlice(origin2).ReturnWork();
 	const short n = origin2 - origin1;
 	Point p;
 	float delta;
@@ -5915,10 +6358,10 @@ void SlicesHandler::Extrapolatetissue(unsigned short origin1, unsigned short ori
 			for (p.px = 0; p.px < m_Width; p.px++)
 			{
 				delta = (bmp2[i1] - bmp1[i1]) / n;
-				if (bmp1[i1] + delta * (target - origin1) >= 0)
-					m_ImageSlices[target].SetWorkPt(p, 255.0f);
+				if (bmp1[i1] + delta * ((int)target - (int)origin1) >= 0)
+					ImageSlice(target).SetWorkPt(p, 255.0f);
 				else
-					m_ImageSlices[target].SetWorkPt(p, 0.0f);
+					ImageSlice(target).SetWorkPt(p, 0.0f);
 				i1++;
 			}
 		}
@@ -5933,29 +6376,29 @@ void SlicesHandler::Extrapolatetissue(unsigned short origin1, unsigned short ori
 
 	m_ImageSlices[target].SetMode(2, false);
 
-	m_ImageSlices[origin2].PopstackWork();
-	m_ImageSlices[origin1].PopstackWork();
-	m_ImageSlices[origin2].PopstackBmp();
-	m_ImageSlices[origin1].PopstackBmp();
+	ImageSlice(origin2).PopstackWork();
+	ImageSlice(origin1).PopstackWork();
+	ImageSlice(origin2).PopstackBmp();
+	ImageSlice(origin1).PopstackBmp();
 }
 
-void SlicesHandler::Interpolatework(unsigned short slice1, unsigned short slice2)
+void SlicesHandler::Interpolatework(unsigned slice1, unsigned slice2)
 {
 	if (slice2 < slice1)
 	{
-		unsigned short dummy = slice1;
+		unsigned dummy = slice1;
 		slice1 = slice2;
 		slice2 = dummy;
 	}
 
 	//tissues_size_t *tissue1=image_slices[slice1].return_tissues(active_tissuelayer);
 	//tissues_size_t *tissue2=image_slices[slice2].return_tissues(active_tissuelayer);
-	m_ImageSlices[slice1].PushstackBmp();
-	m_ImageSlices[slice2].PushstackBmp();
-	float* bmp1 = m_ImageSlices[slice1].ReturnBmp();
-	float* bmp2 = m_ImageSlices[slice2].ReturnBmp();
-	float* work1 = m_ImageSlices[slice1].ReturnWork();
-	float* work2 = m_ImageSlices[slice2].ReturnWork();
+	ImageSlice(slice1).PushstackBmp();
+	ImageSlice(slice2).PushstackBmp();
+	float* bmp1 = ImageSlice(slice1).ReturnBmp();
+	float* bmp2 = ImageSlice(slice2).ReturnBmp();
+	float* work1 = ImageSlice(slice1).ReturnWork();
+	float* work2 = ImageSlice(slice2).ReturnWork();
 
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
@@ -5969,11 +6412,11 @@ void SlicesHandler::Interpolatework(unsigned short slice1, unsigned short slice2
 			bmp2[i] = 0.0f;
 	}
 
-	m_ImageSlices[slice2].DeadReckoning(255.0f);
-	m_ImageSlices[slice1].DeadReckoning(255.0f);
+	ImageSlice(slice2).DeadReckoning(255.0f);
+	ImageSlice(slice1).DeadReckoning(255.0f);
 
-	bmp1 = m_ImageSlices[slice1].ReturnWork();
-	bmp2 = m_ImageSlices[slice2].ReturnWork();
+	bmp1 = ImageSlice(slice1).ReturnWork();
+	bmp2 = ImageSlice(slice2).ReturnWork();
 	const short n = slice2 - slice1;
 	Point p;
 	float delta;
@@ -5986,12 +6429,12 @@ void SlicesHandler::Interpolatework(unsigned short slice1, unsigned short slice2
 			for (p.px = 0; p.px < m_Width; p.px++)
 			{
 				delta = (bmp2[i1] - bmp1[i1]) / n;
-				for (unsigned short j = 1; j < n; j++)
+				for (unsigned j = 1; j < n; j++)
 				{
 					if (bmp1[i1] + delta * j >= 0)
-						m_ImageSlices[slice1 + j].SetWorkPt(p, 255.0f);
+						ImageSlice(slice1 + j).SetWorkPt(p, 255.0f);
 					else
-						m_ImageSlices[slice1 + j].SetWorkPt(p, 0.0f);
+						ImageSlice(slice1 + j).SetWorkPt(p, 0.0f);
 				}
 				i1++;
 			}
@@ -6010,34 +6453,34 @@ void SlicesHandler::Interpolatework(unsigned short slice1, unsigned short slice2
 			bmp2[i] = 255.0f;
 	}
 
-	for (unsigned short j = 1; j < n; j++)
+	for (unsigned j = 1; j < n; j++)
 	{
 		m_ImageSlices[slice1 + j].SetMode(2, false);
 	}
 
-	m_ImageSlices[slice2].PopstackBmp();
-	m_ImageSlices[slice1].PopstackBmp();
+	ImageSlice(slice2).PopstackBmp();
+	ImageSlice(slice1).PopstackBmp();
 }
 
-void SlicesHandler::Extrapolatework(unsigned short origin1, unsigned short origin2, unsigned short target)
+void SlicesHandler::Extrapolatework(unsigned origin1, unsigned origin2, unsigned target)
 {
 	if (origin2 < origin1)
 	{
-		unsigned short dummy = origin1;
+		unsigned dummy = origin1;
 		origin1 = origin2;
 		origin2 = dummy;
 	}
 
 	//tissues_size_t *tissue1=image_slices[origin1].return_tissues(active_tissuelayer);
 	//tissues_size_t *tissue2=image_slices[origin2].return_tissues(active_tissuelayer);
-	m_ImageSlices[origin1].PushstackBmp();
-	m_ImageSlices[origin2].PushstackBmp();
-	m_ImageSlices[origin1].PushstackWork();
-	m_ImageSlices[origin2].PushstackWork();
-	float* bmp1 = m_ImageSlices[origin1].ReturnBmp();
-	float* bmp2 = m_ImageSlices[origin2].ReturnBmp();
-	float* work1 = m_ImageSlices[origin1].ReturnWork();
-	float* work2 = m_ImageSlices[origin2].ReturnWork();
+	ImageSlice(origin1).PushstackBmp();
+	ImageSlice(origin2).PushstackBmp();
+	ImageSlice(origin1).PushstackWork();
+	ImageSlice(origin2).PushstackWork();
+	float* bmp1 = ImageSlice(origin1).ReturnBmp();
+	float* bmp2 = ImageSlice(origin2).ReturnBmp();
+	float* work1 = ImageSlice(origin1).ReturnWork();
+	float* work2 = ImageSlice(origin2).ReturnWork();
 
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
@@ -6051,11 +6494,11 @@ void SlicesHandler::Extrapolatework(unsigned short origin1, unsigned short origi
 			bmp2[i] = 0.0f;
 	}
 
-	m_ImageSlices[origin2].DeadReckoning(255.0f);
-	m_ImageSlices[origin1].DeadReckoning(255.0f);
+	ImageSlice(origin2).DeadReckoning(255.0f);
+	ImageSlice(origin1).DeadReckoning(255.0f);
 
-	bmp1 = m_ImageSlices[origin1].ReturnWork();
-	bmp2 = m_ImageSlices[origin2].ReturnWork();
+	bmp1 = ImageSlice(origin1).ReturnWork();
+	bmp2 = ImageSlice(origin2).ReturnWork();
 	const short n = origin2 - origin1;
 	Point p;
 	float delta;
@@ -6068,10 +6511,10 @@ void SlicesHandler::Extrapolatework(unsigned short origin1, unsigned short origi
 			for (p.px = 0; p.px < m_Width; p.px++)
 			{
 				delta = (bmp2[i1] - bmp1[i1]) / n;
-				if (bmp1[i1] + delta * (target - origin1) >= 0)
-					m_ImageSlices[target].SetWorkPt(p, 255.0f);
+				if (bmp1[i1] + delta * ((int)target - (int)origin1) >= 0)
+					ImageSlice(target).SetWorkPt(p, 255.0f);
 				else
-					m_ImageSlices[target].SetWorkPt(p, 0.0f);
+					ImageSlice(target).SetWorkPt(p, 0.0f);
 				i1++;
 			}
 		}
@@ -6086,16 +6529,16 @@ void SlicesHandler::Extrapolatework(unsigned short origin1, unsigned short origi
 
 	m_ImageSlices[target].SetMode(2, false);
 
-	m_ImageSlices[origin2].PopstackWork();
-	m_ImageSlices[origin1].PopstackWork();
-	m_ImageSlices[origin2].PopstackBmp();
-	m_ImageSlices[origin1].PopstackBmp();
+	ImageSlice(origin2).PopstackWork();
+	ImageSlice(origin1).PopstackWork();
+	ImageSlice(origin2).PopstackBmp();
+	ImageSlice(origin1).PopstackBmp();
 }
 
-void SlicesHandler::Interpolate(unsigned short slice1, unsigned short slice2)
+void SlicesHandler::Interpolate(unsigned slice1, unsigned slice2)
 {
-	float* bmp1 = m_ImageSlices[slice1].ReturnWork();
-	float* bmp2 = m_ImageSlices[slice2].ReturnWork();
+	float* bmp1 = ImageSlice(slice1).ReturnWork();
+	float* bmp2 = ImageSlice(slice2).ReturnWork();
 	const short n = slice2 - slice1;
 	Point p;
 	float delta;
@@ -6108,23 +6551,23 @@ void SlicesHandler::Interpolate(unsigned short slice1, unsigned short slice2)
 			for (p.px = 0; p.px < m_Width; p.px++)
 			{
 				delta = (bmp2[i] - bmp1[i]) / n;
-				for (unsigned short j = 1; j < n; j++)
-					m_ImageSlices[slice1 + j].SetWorkPt(p, bmp1[i] + delta * j);
+				for (unsigned j = 1; j < n; j++)
+					ImageSlice(slice1 + j).SetWorkPt(p, bmp1[i] + delta * j);
 				i++;
 			}
 		}
 	}
 
-	for (unsigned short j = 1; j < n; j++)
+	for (unsigned j = 1; j < n; j++)
 	{
 		m_ImageSlices[slice1 + j].SetMode(1, false);
 	}
 }
 
-void SlicesHandler::Extrapolate(unsigned short origin1, unsigned short origin2, unsigned short target)
+void SlicesHandler::Extrapolate(unsigned origin1, unsigned origin2, unsigned target)
 {
-	float* bmp1 = m_ImageSlices[origin1].ReturnWork();
-	float* bmp2 = m_ImageSlices[origin2].ReturnWork();
+	float* bmp1 = ImageSlice(origin1).ReturnWork();
+	float* bmp2 = ImageSlice(origin2).ReturnWork();
 	const short n = origin2 - origin1;
 	Point p;
 	float delta;
@@ -6135,8 +6578,8 @@ void SlicesHandler::Extrapolate(unsigned short origin1, unsigned short origin2,
 		for (p.px = 0; p.px < m_Width; p.px++)
 		{
 			delta = (bmp2[i] - bmp1[i]) / n;
-			m_ImageSlices[target].SetWorkPt(p, bmp1[i] +
-																						 delta * (target - origin1));
+			ImageSlice(target).SetWorkPt(p, bmp1[i] +
+																						 delta * ((int)target - (int)origin1));
 			i++;
 		}
 	}
@@ -6144,7 +6587,7 @@ void SlicesHandler::Extrapolate(unsigned short origin1, unsigned short origin2,
 	m_ImageSlices[target].SetMode(1, false);
 }
 
-void SlicesHandler::Interpolate(unsigned short slice1, unsigned short slice2, float* bmp1, float* bmp2)
+void SlicesHandler::Interpolate(unsigned slice1, unsigned slice2, float* bmp1, float* bmp2)
 {
 	const short n = slice2 - slice1;
 	Point p;
@@ -6156,13 +6599,13 @@ void SlicesHandler::Interpolate(unsigned short slice1, unsigned short slice2, fl
 		for (p.px = 0; p.px < m_Width; p.px++)
 		{
 			delta = (bmp2[i] - bmp1[i]) / n;
-			for (unsigned short j = 0; j <= n; j++)
-				m_ImageSlices[slice1 + j].SetWorkPt(p, bmp1[i] + delta * j);
+			for (unsigned j = 0; j <= n; j++)
+				ImageSlice(slice1 + j).SetWorkPt(p, bmp1[i] + delta * j);
 			i++;
 		}
 	}
 
-	for (unsigned short j = 1; j < n; j++)
+	for (unsigned j = 1; j < n; j++)
 	{
 		m_ImageSlices[slice1 + j].SetMode(1, false);
 	}
@@ -6171,7 +6614,7 @@ void SlicesHandler::Interpolate(unsigned short slice1, unsigned short slice2, fl
 void SlicesHandler::SetSlicethickness(float t)
 {
 	m_Thickness = t;
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
 		m_Os.SetThickness(t, i);
 	}
@@ -6231,7 +6674,7 @@ void SlicesHandler::SetDisplacement(const float disp[3])
 
 void SlicesHandler::GetDirectionCosines(float dc[6]) const
 {
-	for (unsigned short i = 0; i < 3; i++)
+	for (unsigned i = 0; i < 3; i++)
 	{
 		dc[i] = m_Transform[i][0];
 		dc[i + 3] = m_Transform[i][1];
@@ -6245,15 +6688,15 @@ void SlicesHandler::SetDirectionCosines(const float dc[6])
 	m_Transform.SetTransform(offset, dc);
 }
 
-void SlicesHandler::SlicebmpX(float* return_bits, unsigned short xcoord)
+void SlicesHandler::SlicebmpX(float* return_bits, unsigned xcoord)
 {
 	unsigned n = 0;
 	float* dummy;
 
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		dummy = m_ImageSlices[i].ReturnBmp();
-		for (unsigned short j = 0; j < m_Height; j++)
+		dummy = ImageSlice(i).ReturnBmp();
+		for (unsigned j = 0; j < m_Height; j++)
 		{
 			return_bits[n] = dummy[j * m_Width + xcoord];
 			n++;
@@ -6261,15 +6704,15 @@ void SlicesHandler::SlicebmpX(float* return_bits, unsigned short xcoord)
 	}
 }
 
-void SlicesHandler::SlicebmpY(float* return_bits, unsigned short ycoord)
+void SlicesHandler::SlicebmpY(float* return_bits, unsigned ycoord)
 {
 	unsigned n = 0;
 	float* dummy;
 
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		dummy = m_ImageSlices[i].ReturnBmp();
-		for (unsigned short j = 0; j < m_Width; j++)
+		dummy = ImageSlice(i).ReturnBmp();
+		for (unsigned j = 0; j < m_Width; j++)
 		{
 			return_bits[n] = dummy[j + ycoord * m_Width];
 			n++;
@@ -6277,7 +6720,7 @@ void SlicesHandler::SlicebmpY(float* return_bits, unsigned short ycoord)
 	}
 }
 
-float* SlicesHandler::SlicebmpX(unsigned short xcoord)
+float* SlicesHandler::SlicebmpX(unsigned xcoord)
 {
 	float* result = (float*)malloc(sizeof(float) * unsigned(m_Height) * m_Nrslices);
 	SlicebmpX(result, xcoord);
@@ -6285,7 +6728,7 @@ float* SlicesHandler::SlicebmpX(unsigned short xcoord)
 	return result;
 }
 
-float* SlicesHandler::SlicebmpY(unsigned short ycoord)
+float* SlicesHandler::SlicebmpY(unsigned ycoord)
 {
 	float* result = (float*)malloc(sizeof(float) * unsigned(m_Width) * m_Nrslices);
 	SlicebmpY(result, ycoord);
@@ -6293,15 +6736,15 @@ float* SlicesHandler::SlicebmpY(unsigned short ycoord)
 	return result;
 }
 
-void SlicesHandler::SliceworkX(float* return_bits, unsigned short xcoord)
+void SlicesHandler::SliceworkX(float* return_bits, unsigned xcoord)
 {
 	unsigned n = 0;
 	float* dummy;
 
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		dummy = m_ImageSlices[i].ReturnWork();
-		for (unsigned short j = 0; j < m_Height; j++)
+		dummy = ImageSlice(i).ReturnWork();
+		for (unsigned j = 0; j < m_Height; j++)
 		{
 			return_bits[n] = dummy[j * m_Width + xcoord];
 			n++;
@@ -6309,15 +6752,15 @@ void SlicesHandler::SliceworkX(float* return_bits, unsigned short xcoord)
 	}
 }
 
-void SlicesHandler::SliceworkY(float* return_bits, unsigned short ycoord)
+void SlicesHandler::SliceworkY(float* return_bits, unsigned ycoord)
 {
 	unsigned n = 0;
 	float* dummy;
 
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		dummy = m_ImageSlices[i].ReturnWork();
-		for (unsigned short j = 0; j < m_Width; j++)
+		dummy = ImageSlice(i).ReturnWork();
+		for (unsigned j = 0; j < m_Width; j++)
 		{
 			return_bits[n] = dummy[j + ycoord * m_Width];
 			n++;
@@ -6325,7 +6768,7 @@ void SlicesHandler::SliceworkY(float* return_bits, unsigned short ycoord)
 	}
 }
 
-float* SlicesHandler::SliceworkX(unsigned short xcoord)
+float* SlicesHandler::SliceworkX(unsigned xcoord)
 {
 	float* result = (float*)malloc(sizeof(float) * unsigned(m_Height) * m_Nrslices);
 	SliceworkX(result, xcoord);
@@ -6333,7 +6776,7 @@ float* SlicesHandler::SliceworkX(unsigned short xcoord)
 	return result;
 }
 
-float* SlicesHandler::SliceworkY(unsigned short ycoord)
+float* SlicesHandler::SliceworkY(unsigned ycoord)
 {
 	float* result = (float*)malloc(sizeof(float) * unsigned(m_Width) * m_Nrslices);
 	SliceworkY(result, ycoord);
@@ -6341,15 +6784,15 @@ float* SlicesHandler::SliceworkY(unsigned short ycoord)
 	return result;
 }
 
-void SlicesHandler::SlicetissueX(tissues_size_t* return_bits, unsigned short xcoord)
+void SlicesHandler::SlicetissueX(tissues_size_t* return_bits, unsigned xcoord)
 {
 	unsigned n = 0;
 	tissues_size_t* dummy;
 
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		dummy = m_ImageSlices[i].ReturnTissues(m_ActiveTissuelayer);
-		for (unsigned short j = 0; j < m_Height; j++)
+		dummy = ImageSlice(i).ReturnTissues(m_ActiveTissuelayer);
+		for (unsigned j = 0; j < m_Height; j++)
 		{
 			return_bits[n] = dummy[j * m_Width + xcoord];
 			n++;
@@ -6357,15 +6800,15 @@ void SlicesHandler::SlicetissueX(tissues_size_t* return_bits, unsigned short xco
 	}
 }
 
-void SlicesHandler::SlicetissueY(tissues_size_t* return_bits, unsigned short ycoord)
+void SlicesHandler::SlicetissueY(tissues_size_t* return_bits, unsigned ycoord)
 {
 	unsigned n = 0;
 	tissues_size_t* dummy;
 
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		dummy = m_ImageSlices[i].ReturnTissues(m_ActiveTissuelayer);
-		for (unsigned short j = 0; j < m_Width; j++)
+		dummy = ImageSlice(i).ReturnTissues(m_ActiveTissuelayer);
+		for (unsigned j = 0; j < m_Width; j++)
 		{
 			return_bits[n] = dummy[j + ycoord * m_Width];
 			n++;
@@ -6373,7 +6816,7 @@ void SlicesHandler::SlicetissueY(tissues_size_t* return_bits, unsigned short yco
 	}
 }
 
-tissues_size_t* SlicesHandler::SlicetissueX(unsigned short xcoord)
+tissues_size_t* SlicesHandler::SlicetissueX(unsigned xcoord)
 {
 	tissues_size_t* result = (tissues_size_t*)malloc(sizeof(tissues_size_t) * unsigned(m_Height) * m_Nrslices);
 	SlicetissueX(result, xcoord);
@@ -6381,7 +6824,7 @@ tissues_size_t* SlicesHandler::SlicetissueX(unsigned short xcoord)
 	return result;
 }
 
-tissues_size_t* SlicesHandler::SlicetissueY(unsigned short ycoord)
+tissues_size_t* SlicesHandler::SlicetissueY(unsigned ycoord)
 {
 	tissues_size_t* result = (tissues_size_t*)malloc(sizeof(tissues_size_t) * unsigned(m_Width) * m_Nrslices);
 	SlicetissueY(result, ycoord);
@@ -6389,9 +6832,9 @@ tissues_size_t* SlicesHandler::SlicetissueY(unsigned short ycoord)
 	return result;
 }
 
-void SlicesHandler::SliceworkZ(unsigned short slicenr)
+void SlicesHandler::SliceworkZ(unsigned slicenr)
 {
-	m_ImageSlices[slicenr].ReturnWork();
+	ImageSlice(slicenr).ReturnWork();
 }
 
 template<typename TScalarType>
@@ -6470,8 +6913,8 @@ int SlicesHandler::ExtractTissueSurfaces(const std::string& filename, std::vecto
 
 	int const padding = 1;
 	//labelField is already cropped
-	unsigned short nr_slice = 0;
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++, nr_slice++)
+	unsigned nr_slice = 0;
+	for (unsigned i = m_Startslice; i < m_Endslice; i++, nr_slice++)
 	{
 		Copyfromtissuepadded(i, &(field[(nr_slice + 1) * (unsigned long long)(Width() + 2) * (Height() + 2)]), padding);
 	}
@@ -6649,46 +7092,46 @@ int SlicesHandler::ExtractTissueSurfaces(const std::string& filename, std::vecto
 
 void SlicesHandler::Add2tissue(tissues_size_t tissuetype, Point p, bool override)
 {
-	m_ImageSlices[m_Activeslice].Add2tissue(m_ActiveTissuelayer, tissuetype, p, override);
+	ImageSlice(m_Activeslice).Add2tissue(m_ActiveTissuelayer, tissuetype, p, override);
 }
 
-void SlicesHandler::Add2tissue(tissues_size_t tissuetype, bool* mask, unsigned short slicenr, bool override)
+void SlicesHandler::Add2tissue(tissues_size_t tissuetype, bool* mask, unsigned slicenr, bool override)
 {
-	m_ImageSlices[slicenr].Add2tissue(m_ActiveTissuelayer, tissuetype, mask, override);
+	ImageSlice(slicenr).Add2tissue(m_ActiveTissuelayer, tissuetype, mask, override);
 }
 
 void SlicesHandler::Add2tissueall(tissues_size_t tissuetype, Point p, bool override)
 {
-	float f = m_ImageSlices[m_Activeslice].WorkPt(p);
+	float f = ImageSlice(m_Activeslice).WorkPt(p);
 	Add2tissueall(tissuetype, f, override);
 }
 
 void SlicesHandler::Add2tissueConnected(tissues_size_t tissuetype, Point p, bool override)
 {
-	m_ImageSlices[m_Activeslice].Add2tissueConnected(m_ActiveTissuelayer, tissuetype, p, override);
+	ImageSlice(m_Activeslice).Add2tissueConnected(m_ActiveTissuelayer, tissuetype, p, override);
 }
 
 void SlicesHandler::Add2tissueThresh(tissues_size_t tissuetype, Point p)
 {
-	m_ImageSlices[m_Activeslice].Add2tissueThresh(m_ActiveTissuelayer, tissuetype, p);
+	ImageSlice(m_Activeslice).Add2tissueThresh(m_ActiveTissuelayer, tissuetype, p);
 }
 
 void SlicesHandler::SubtractTissue(tissues_size_t tissuetype, Point p)
 {
-	m_ImageSlices[m_Activeslice].SubtractTissue(m_ActiveTissuelayer, tissuetype, p);
+	ImageSlice(m_Activeslice).SubtractTissue(m_ActiveTissuelayer, tissuetype, p);
 }
 
 void SlicesHandler::SubtractTissueall(tissues_size_t tissuetype, Point p)
 {
-	float f = m_ImageSlices[m_Activeslice].WorkPt(p);
+	float f = ImageSlice(m_Activeslice).WorkPt(p);
 	SubtractTissueall(tissuetype, f);
 }
 
-void SlicesHandler::SubtractTissueall(tissues_size_t tissuetype, Point p, unsigned short slicenr)
+void SlicesHandler::SubtractTissueall(tissues_size_t tissuetype, Point p, unsigned slicenr)
 {
 	if (slicenr >= 0 && slicenr < m_Nrslices)
 	{
-		float f = m_ImageSlices[slicenr].WorkPt(p);
+		float f = ImageSlice(slicenr).WorkPt(p);
 		SubtractTissueall(tissuetype, f);
 	}
 }
@@ -6700,13 +7143,13 @@ void SlicesHandler::SubtractTissueall(tissues_size_t tissuetype, float f)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].SubtractTissue(m_ActiveTissuelayer, tissuetype, f);
+		ImageSlice(i).SubtractTissue(m_ActiveTissuelayer, tissuetype, f);
 	}
 }
 
 void SlicesHandler::SubtractTissueConnected(tissues_size_t tissuetype, Point p)
 {
-	m_ImageSlices[m_Activeslice].SubtractTissueConnected(m_ActiveTissuelayer, tissuetype, p);
+	ImageSlice(m_Activeslice).SubtractTissueConnected(m_ActiveTissuelayer, tissuetype, p);
 }
 
 void SlicesHandler::Selectedtissue2work(const std::vector<tissues_size_t>& tissuetype)
@@ -6717,7 +7160,7 @@ void SlicesHandler::Selectedtissue2work(const std::vector<tissues_size_t>& tissu
 		mask.at(label) = 255.0f;
 	}
 
-	m_ImageSlices[m_Activeslice].Tissue2work(m_ActiveTissuelayer, mask);
+	ImageSlice(m_Activeslice).Tissue2work(m_ActiveTissuelayer, mask);
 }
 
 void SlicesHandler::Selectedtissue2work3D(const std::vector<tissues_size_t>& tissuetype)
@@ -6733,13 +7176,13 @@ void SlicesHandler::Selectedtissue2work3D(const std::vector<tissues_size_t>& tis
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].Tissue2work(m_ActiveTissuelayer, mask);
+		ImageSlice(i).Tissue2work(m_ActiveTissuelayer, mask);
 	}
 }
 
 void SlicesHandler::Cleartissue(tissues_size_t tissuetype)
 {
-	m_ImageSlices[m_Activeslice].Cleartissue(m_ActiveTissuelayer, tissuetype);
+	ImageSlice(m_Activeslice).Cleartissue(m_ActiveTissuelayer, tissuetype);
 }
 
 void SlicesHandler::Cleartissue3D(tissues_size_t tissuetype)
@@ -6749,13 +7192,13 @@ void SlicesHandler::Cleartissue3D(tissues_size_t tissuetype)
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].Cleartissue(m_ActiveTissuelayer, tissuetype);
+		ImageSlice(i).Cleartissue(m_ActiveTissuelayer, tissuetype);
 	}
 }
 
 void SlicesHandler::Cleartissues()
 {
-	m_ImageSlices[m_Activeslice].Cleartissues(m_ActiveTissuelayer);
+	ImageSlice(m_Activeslice).Cleartissues(m_ActiveTissuelayer);
 }
 
 void SlicesHandler::Cleartissues3D()
@@ -6765,15 +7208,15 @@ void SlicesHandler::Cleartissues3D()
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].Cleartissues(m_ActiveTissuelayer);
+		ImageSlice(i).Cleartissues(m_ActiveTissuelayer);
 	}
 }
 
-void SlicesHandler::Add2tissueall(tissues_size_t tissuetype, Point p, unsigned short slicenr, bool override)
+void SlicesHandler::Add2tissueall(tissues_size_t tissuetype, Point p, unsigned slicenr, bool override)
 {
 	if (slicenr >= 0 && slicenr < m_Nrslices)
 	{
-		float f = m_ImageSlices[slicenr].WorkPt(p);
+		float f = ImageSlice(slicenr).WorkPt(p);
 		Add2tissueall(tissuetype, f, override);
 	}
 }
@@ -6785,7 +7228,7 @@ void SlicesHandler::Add2tissueall(tissues_size_t tissuetype, float f, bool overr
 #pragma omp parallel for
 	for (int i = m_Startslice; i < i_n; i++)
 	{
-		m_ImageSlices[i].Add2tissue(m_ActiveTissuelayer, tissuetype, f, override);
+		ImageSlice(i).Add2tissue(m_ActiveTissuelayer, tissuetype, f, override);
 	}
 }
 
@@ -6797,19 +7240,19 @@ void SlicesHandler::PrevSlice()
 		SetActiveSlice(m_Activeslice - 1);
 }
 
-unsigned short SlicesHandler::GetNextFeaturingSlice(tissues_size_t type, bool& found)
+unsigned SlicesHandler::GetNextFeaturingSlice(tissues_size_t type, bool& found)
 {
 	found = true;
 	for (unsigned i = m_Activeslice + 1; i < m_Nrslices; i++)
 	{
-		if (m_ImageSlices[i].HasTissue(m_ActiveTissuelayer, type))
+		if (ImageSlice(i).HasTissue(m_ActiveTissuelayer, type))
 		{
 			return i;
 		}
 	}
 	for (unsigned i = 0; i <= m_Activeslice; i++)
 	{
-		if (m_ImageSlices[i].HasTissue(m_ActiveTissuelayer, type))
+		if (ImageSlice(i).HasTissue(m_ActiveTissuelayer, type))
 		{
 			return i;
 		}
@@ -6819,14 +7262,26 @@ unsigned short SlicesHandler::GetNextFeaturingSlice(tissues_size_t type, bool& f
 	return m_Activeslice;
 }
 
-unsigned short SlicesHandler::ActiveSlice() const { return m_Activeslice; }
+unsigned SlicesHandler::ActiveSlice() const { return m_Activeslice; }
 
-void SlicesHandler::SetActiveSlice(unsigned short slice, bool signal_change)
+void SlicesHandler::SetActiveSlice(unsigned slice, bool signal_change)
 {
 	if (slice < m_Nrslices && slice != m_Activeslice)
 	{
 		m_Activeslice = slice;
 
+		if (m_PageFile)
+		{
+			// read ahead around the active slice
+			unsigned const first = slice > m_PagingReadAhead ? slice - m_PagingReadAhead : 0;
+			unsigned const last = std::min(slice + m_PagingReadAhead, m_Nrslices - 1);
+			for (unsigned i = first; i <= last; i++)
+			{
+				PageIn(i);
+			}
+			TrimSliceCache();
+		}
+
 		// notify observers that slice changed
 		if (signal_change)
 		{
@@ -6837,7 +7292,7 @@ void SlicesHandler::SetActiveSlice(unsigned short slice, bool signal_change)
 
 Bmphandler* SlicesHandler::GetActivebmphandler()
 {
-	return &(m_ImageSlices[m_Activeslice]);
+	return &(ImageSlice(m_Activeslice));
 }
 
 tissuelayers_size_t SlicesHandler::ActiveTissuelayer() const
@@ -6858,7 +7313,7 @@ unsigned SlicesHandler::PushstackBmp()
 
 unsigned SlicesHandler::PushstackBmp(unsigned int slice)
 {
-	return m_ImageSlices[slice].PushstackBmp();
+	return ImageSlice(slice).PushstackBmp();
 }
 
 unsigned SlicesHandler::PushstackWork()
@@ -6868,7 +7323,7 @@ unsigned SlicesHandler::PushstackWork()
 
 unsigned SlicesHandler::PushstackWork(unsigned int slice)
 {
-	return m_ImageSlices[slice].PushstackWork();
+	return ImageSlice(slice).PushstackWork();
 }
 
 unsigned SlicesHandler::PushstackTissue(tissues_size_t i)
@@ -6878,7 +7333,41 @@ unsigned SlicesHandler::PushstackTissue(tissues_size_t i)
 
 unsigned SlicesHandler::PushstackTissue(tissues_size_t i, unsigned int slice)
 {
-	return m_ImageSlices[slice].PushstackTissue(m_ActiveTissuelayer, i);
+	return ImageSlice(slice).PushstackTissue(m_ActiveTissuelayer, i);
+}
+
+unsigned SlicesHandler::PushstackBmp(unsigned startslice, unsigned endslice)
+{
+	// one entry for the whole range, the slices get consecutive ids
+	unsigned const first = Bmphandler::Stack().Push(endslice - startslice + 1, m_Area, 1, [this, startslice](unsigned k) {
+		return ImageSlice(startslice + k).ReturnBmp();
+	});
+	for (unsigned slice = startslice; slice <= endslice; ++slice)
+	{
+		Bmphandler::Stack().SetMode(first + slice - startslice, ImageSlice(slice).ReturnMode(true));
+	}
+	return first;
+}
+
+unsigned SlicesHandler::PushstackWork(unsigned startslice, unsigned endslice)
+{
+	unsigned const first = Bmphandler::Stack().Push(endslice - startslice + 1, m_Area, 2, [this, startslice](unsigned k) {
+		return static_cast<const Bmphandler&>(ImageSlice(startslice + k)).ReturnWork();
+	});
+	for (unsigned slice = startslice; slice <= endslice; ++slice)
+	{
+		Bmphandler::Stack().SetMode(first + slice - startslice, ImageSlice(slice).ReturnMode(false));
+	}
+	return first;
+}
+
+unsigned SlicesHandler::PushstackTissue(tissues_size_t i, unsigned startslice, unsigned endslice)
+{
+	std::vector<float> bits(m_Area);
+	return Bmphandler::Stack().Push(endslice - startslice + 1, m_Area, 2, [&](unsigned k) {
+		ImageSlice(startslice + k).TissueMask(m_ActiveTissuelayer, i, bits.data());
+		return bits.data();
+	});
 }
 
 unsigned SlicesHandler::PushstackHelp()
@@ -6900,7 +7389,7 @@ void SlicesHandler::GetstackBmp(unsigned i)
 
 void SlicesHandler::GetstackBmp(unsigned int slice, unsigned i)
 {
-	m_ImageSlices[slice].GetstackBmp(i);
+	ImageSlice(slice).GetstackBmp(i);
 }
 
 void SlicesHandler::GetstackWork(unsigned i)
@@ -6910,7 +7399,7 @@ void SlicesHandler::GetstackWork(unsigned i)
 
 void SlicesHandler::GetstackWork(unsigned int slice, unsigned i)
 {
-	m_ImageSlices[slice].GetstackWork(i);
+	ImageSlice(slice).GetstackWork(i);
 }
 
 void SlicesHandler::GetstackHelp(unsigned i)
@@ -6925,12 +7414,12 @@ void SlicesHandler::GetstackTissue(unsigned i, tissues_size_t tissuenr, bool ove
 
 void SlicesHandler::GetstackTissue(unsigned int slice, unsigned i, tissues_size_t tissuenr, bool override)
 {
-	m_ImageSlices[slice].GetstackTissue(m_ActiveTissuelayer, i, tissuenr, override);
+	ImageSlice(slice).GetstackTissue(m_ActiveTissuelayer, i, tissuenr, override);
 }
 
-float* SlicesHandler::Getstack(unsigned i, unsigned char& mode)
+bool SlicesHandler::Getstack(unsigned i, float* bits, unsigned char& mode)
 {
-	return GetActivebmphandler()->Getstack(i, mode);
+	return GetActivebmphandler()->Getstack(i, bits, mode);
 }
 
 void SlicesHandler::PopstackBmp() { GetActivebmphandler()->PopstackBmp(); }
@@ -6955,10 +7444,11 @@ void SlicesHandler::StartUndo(DataSelection& dataSelection)
 	{
 		m_Uelem = new UndoElem;
 		m_Uelem->m_DataSelection = dataSelection;
+		m_Uelem->m_Area = m_Area;
 
 		if (dataSelection.bmp)
 		{
-			m_Uelem->m_BmpOld = m_ImageSlices[dataSelection.sliceNr].CopyBmp();
+			m_Uelem->m_BmpOld = ImageSlice(dataSelection.sliceNr).CopyBmp();
 			m_Uelem->m_Mode1Old = m_ImageSlices[dataSelection.sliceNr].ReturnMode(true);
 		}
 		else
@@ -6968,7 +7458,7 @@ void SlicesHandler::StartUndo(DataSelection& dataSelection)
 
 		if (dataSelection.work)
 		{
-			m_Uelem->m_WorkOld = m_ImageSlices[dataSelection.sliceNr].CopyWork();
+			m_Uelem->m_WorkOld = ImageSlice(dataSelection.sliceNr).CopyWork();
 			m_Uelem->m_Mode2Old = m_ImageSlices[dataSelection.sliceNr].ReturnMode(false);
 		}
 		else
@@ -6978,7 +7468,7 @@ void SlicesHandler::StartUndo(DataSelection& dataSelection)
 
 		if (dataSelection.tissues)
 		{
-			m_Uelem->m_TissueOld = m_ImageSlices[dataSelection.sliceNr].CopyTissue(m_ActiveTissuelayer);
+			m_Uelem->m_TissueOld = ImageSlice(dataSelection.sliceNr).CopyTissue(m_ActiveTissuelayer);
 		}
 		else
 		{
@@ -7025,52 +7515,52 @@ bool SlicesHandler::StartUndo(DataSelection& dataSelection, std::vector<unsigned
 		//		uelem=new MultiUndoElem;
 		//		MultiUndoElem *uelem1=dynamic_cast<MultiUndoElem *>(uelem);
 		m_Uelem->m_DataSelection = dataSelection;
+		m_Uelem->m_Area = m_Area;
 		uelem1->m_Vslicenr = vslicenr1;
 
-		if (m_Uelem->Arraynr() < this->m_UndoQueue.ReturnNrundoarraysmax())
-		{
-			//abcd std::vector<unsigned short>::iterator it;
-			std::vector<unsigned>::iterator it;
-			uelem1->m_VbmpOld.clear();
-			uelem1->m_Vmode1Old.clear();
+		// The old images only live until EndUndo, where they are replaced by the differences. They are copied
+		// rather than shared with the slices, since tools write through slice pointers they fetched before the
+		// undo step started, i.e. not through ImageSlice.
+		int const n = static_cast<int>(vslicenr1.size());
+		uelem1->m_VbmpOld.assign(dataSelection.bmp ? n : 0, nullptr);
+		uelem1->m_Vmode1Old.assign(dataSelection.bmp ? n : 0, 0);
+		uelem1->m_VworkOld.assign(dataSelection.work ? n : 0, nullptr);
+		uelem1->m_Vmode2Old.assign(dataSelection.work ? n : 0, 0);
+		uelem1->m_VtissueOld.assign(dataSelection.tissues ? n : 0, nullptr);
+#pragma omp parallel for if (!m_PageFile)
+		for (int i = 0; i < n; i++)
+		{
+			Bmphandler& slice = m_PageFile ? ImageSlice(vslicenr1[i]) : m_ImageSlices[vslicenr1[i]];
 			if (dataSelection.bmp)
-				for (it = vslicenr1.begin(); it != vslicenr1.end(); it++)
-				{
-					uelem1->m_VbmpOld.push_back(m_ImageSlices[*it].CopyBmp());
-					uelem1->m_Vmode1Old.push_back(m_ImageSlices[*it].ReturnMode(true));
-				}
-			uelem1->m_VworkOld.clear();
-			uelem1->m_Vmode2Old.clear();
+			{
+				uelem1->m_VbmpOld[i] = slice.CopyBmp();
+				uelem1->m_Vmode1Old[i] = slice.ReturnMode(true);
+			}
 			if (dataSelection.work)
-				for (it = vslicenr1.begin(); it != vslicenr1.end(); it++)
-				{
-					uelem1->m_VworkOld.push_back(m_ImageSlices[*it].CopyWork());
-					uelem1->m_Vmode2Old.push_back(m_ImageSlices[*it].ReturnMode(false));
-				}
-			uelem1->m_VtissueOld.clear();
+			{
+				// a target which is not allocated is zero, see EndUndo
+				uelem1->m_VworkOld[i] = slice.HasWork() ? slice.CopyWork() : nullptr;
+				uelem1->m_Vmode2Old[i] = slice.ReturnMode(false);
+			}
 			if (dataSelection.tissues)
-				for (it = vslicenr1.begin(); it != vslicenr1.end(); it++)
-					uelem1->m_VtissueOld.push_back(m_ImageSlices[*it].CopyTissue(m_ActiveTissuelayer));
-			uelem1->m_VvvmOld.clear();
-			if (dataSelection.vvm)
-				for (it = vslicenr1.begin(); it != vslicenr1.end(); it++)
-					uelem1->m_VvvmOld.push_back(*(m_ImageSlices[*it].ReturnVvm()));
-			uelem1->m_VlimitsOld.clear();
-			if (dataSelection.limits)
-				for (it = vslicenr1.begin(); it != vslicenr1.end(); it++)
-					uelem1->m_VlimitsOld.push_back(*(m_ImageSlices[*it].ReturnLimits()));
-			uelem1->m_MarksOld.clear();
-			if (dataSelection.marks)
-				for (it = vslicenr1.begin(); it != vslicenr1.end(); it++)
-					uelem1->m_VmarksOld.push_back(*(m_ImageSlices[*it].ReturnMarks()));
-
-			return true;
-		}
-		else
-		{
-			delete m_Uelem;
-			m_Uelem = nullptr;
+				uelem1->m_VtissueOld[i] = slice.CopyTissue(m_ActiveTissuelayer);
 		}
+		//abcd std::vector<unsigned short>::iterator it;
+		std::vector<unsigned>::iterator it;
+		uelem1->m_VvvmOld.clear();
+		if (dataSelection.vvm)
+			for (it = vslicenr1.begin(); it != vslicenr1.end(); it++)
+				uelem1->m_VvvmOld.push_back(*(m_ImageSlices[*it].ReturnVvm()));
+		uelem1->m_VlimitsOld.clear();
+		if (dataSelection.limits)
+			for (it = vslicenr1.begin(); it != vslicenr1.end(); it++)
+				uelem1->m_VlimitsOld.push_back(*(m_ImageSlices[*it].ReturnLimits()));
+		uelem1->m_MarksOld.clear();
+		if (dataSelection.marks)
+			for (it = vslicenr1.begin(); it != vslicenr1.end(); it++)
+				uelem1->m_VmarksOld.push_back(*(m_ImageSlices[*it].ReturnMarks()));
+
+		return true;
 	}
 
 	return false;
@@ -7092,22 +7582,61 @@ void SlicesHandler::EndUndo()
 		if (m_Uelem->Multi())
 		{
 			MultiUndoElem* uelem1 = dynamic_cast<MultiUndoElem*>(m_Uelem);
+			DataSelection const& data_selection = uelem1->m_DataSelection;
 
 			uelem1->m_VbmpNew.clear();
-			uelem1->m_Vmode1New.clear();
-
 			uelem1->m_VworkNew.clear();
-			uelem1->m_Vmode2New.clear();
-
 			uelem1->m_VtissueNew.clear();
-
 			uelem1->m_VvvmNew.clear();
-
 			uelem1->m_VlimitsNew.clear();
-
 			uelem1->m_MarksNew.clear();
 
-			this->m_UndoQueue.AddUndo(uelem1);
+			// replace the old images by their differences to the new images
+			int const n = static_cast<int>(uelem1->m_Vslicenr.size());
+			uelem1->m_Vmode1New.assign(data_selection.bmp ? n : 0, 0);
+			uelem1->m_Vmode2New.assign(data_selection.work ? n : 0, 0);
+			uelem1->m_VbmpDelta.resize(data_selection.bmp ? n : 0);
+			uelem1->m_VworkDelta.resize(data_selection.work ? n : 0);
+			uelem1->m_VtissueDelta.resize(data_selection.tissues ? n : 0);
+			// a target which was not allocated at the start is zero
+			std::vector<float> zeros(data_selection.work ? m_Area : 0, 0.f);
+			const SlicesHandler& self = *this;
+#pragma omp parallel for if (!m_PageFile)
+			for (int i = 0; i < n; i++)
+			{
+				const Bmphandler& slice = self.ImageSlice(uelem1->m_Vslicenr[i]);
+				if (data_selection.bmp)
+				{
+					uelem1->m_VbmpDelta[i].Encode(uelem1->m_VbmpOld[i], slice.ReturnBmp(), m_Area * sizeof(float));
+					free(uelem1->m_VbmpOld[i]);
+					uelem1->m_Vmode1New[i] = slice.ReturnMode(true);
+				}
+				if (data_selection.work)
+				{
+					float* old = uelem1->m_VworkOld[i];
+					uelem1->m_VworkDelta[i].Encode(old ? old : zeros.data(), slice.ReturnWork(), m_Area * sizeof(float));
+					free(old);
+					uelem1->m_Vmode2New[i] = slice.ReturnMode(false);
+				}
+				if (data_selection.tissues)
+				{
+					uelem1->m_VtissueDelta[i].Encode(uelem1->m_VtissueOld[i], slice.ReturnTissues(m_ActiveTissuelayer), m_Area * sizeof(tissues_size_t));
+					free(uelem1->m_VtissueOld[i]);
+				}
+				TrimSliceCache();
+			}
+			uelem1->m_VbmpOld.clear();
+			uelem1->m_VworkOld.clear();
+			uelem1->m_VtissueOld.clear();
+			uelem1->m_Deltas = true;
+			uelem1->RemoveUnchanged();
+
+			if (!this->m_UndoQueue.AddUndo(uelem1))
+			{
+				// the older steps cannot be applied on top of this change
+				delete uelem1;
+				this->m_UndoQueue.ClearUndo();
+			}
 
 			m_Uelem = nullptr;
 		}
@@ -7138,68 +7667,54 @@ void SlicesHandler::MergeUndo()
 {
 	if (m_Uelem != nullptr && !m_Uelem->Multi())
 	{
-		DataSelection data_selection = m_Uelem->m_DataSelection;
-
+		// the merged step takes over the images, the rest is released with the element
 		this->m_UndoQueue.MergeUndo(m_Uelem);
 
-		if (data_selection.bmp)
-		{
-			m_Uelem->m_BmpNew = nullptr;
-			m_Uelem->m_BmpOld = nullptr;
-		}
-		if (data_selection.work)
-		{
-			m_Uelem->m_WorkNew = nullptr;
-			m_Uelem->m_WorkOld = nullptr;
-		}
-		if (data_selection.tissues)
-		{
-			m_Uelem->m_TissueNew = nullptr;
-			m_Uelem->m_TissueOld = nullptr;
-		}
-
 		delete m_Uelem;
 		m_Uelem = nullptr;
 	}
 }
 
+void SlicesHandler::ApplyUndoDeltas(const MultiUndoElem& uelem, unsigned i, bool redo)
+{
+	Bmphandler& slice = ImageSlice(uelem.m_Vslicenr[i]);
+	if (uelem.m_DataSelection.bmp)
+	{
+		uelem.m_VbmpDelta[i].Apply(slice.ReturnBmp());
+		slice.SetMode(redo ? uelem.m_Vmode1New[i] : uelem.m_Vmode1Old[i], true);
+	}
+	if (uelem.m_DataSelection.work)
+	{
+		if (!uelem.m_VworkDelta[i].Empty())
+			uelem.m_VworkDelta[i].Apply(slice.ReturnWork());
+		slice.SetMode(redo ? uelem.m_Vmode2New[i] : uelem.m_Vmode2Old[i], false);
+	}
+	if (uelem.m_DataSelection.tissues)
+	{
+		uelem.m_VtissueDelta[i].Apply(slice.ReturnTissues(m_ActiveTissuelayer));
+	}
+}
+
 DataSelection SlicesHandler::Undo()
 {
 	if (m_Uelem == nullptr)
 	{
 		m_Uelem = this->m_UndoQueue.Undo();
+		if (m_Uelem == nullptr)
+			return {};
 		if (m_Uelem->Multi())
 		{
 			MultiUndoElem* uelem1 = dynamic_cast<MultiUndoElem*>(m_Uelem);
 
 			if (uelem1 != nullptr)
 			{
-				unsigned short current_slice;
+				unsigned current_slice;
 				DataSelection data_selection = m_Uelem->m_DataSelection;
 
 				for (unsigned i = 0; i < uelem1->m_Vslicenr.size(); i++)
 				{
 					current_slice = uelem1->m_Vslicenr[i];
-					if (data_selection.bmp)
-					{
-						uelem1->m_VbmpNew.push_back(m_ImageSlices[current_slice].CopyBmp());
-						uelem1->m_Vmode1New.push_back(m_ImageSlices[current_slice].ReturnMode(true));
-						m_ImageSlices[current_slice].Copy2bmp(uelem1->m_VbmpOld[i], uelem1->m_Vmode1Old[i]);
-						free(uelem1->m_VbmpOld[i]);
-					}
-					if (data_selection.work)
-					{
-						uelem1->m_VworkNew.push_back(m_ImageSlices[current_slice].CopyWork());
-						uelem1->m_Vmode2New.push_back(m_ImageSlices[current_slice].ReturnMode(false));
-						m_ImageSlices[current_slice].Copy2work(uelem1->m_VworkOld[i], uelem1->m_Vmode2Old[i]);
-						free(uelem1->m_VworkOld[i]);
-					}
-					if (data_selection.tissues)
-					{
-						uelem1->m_VtissueNew.push_back(m_ImageSlices[current_slice].CopyTissue(m_ActiveTissuelayer));
-						m_ImageSlices[current_slice].Copy2tissue(m_ActiveTissuelayer, uelem1->m_VtissueOld[i]);
-						free(uelem1->m_VtissueOld[i]);
-					}
+					ApplyUndoDeltas(*uelem1, i, false);
 					if (data_selection.vvm)
 					{
 						uelem1->m_VvvmNew.push_back(*(m_ImageSlices[current_slice].ReturnVvm()));
@@ -7216,11 +7731,6 @@ DataSelection SlicesHandler::Undo()
 						m_ImageSlices[current_slice].Copy2marks(&(uelem1->m_VmarksOld[i]));
 					}
 				}
-				uelem1->m_VbmpOld.clear();
-				uelem1->m_Vmode1Old.clear();
-				uelem1->m_VworkOld.clear();
-				uelem1->m_Vmode2Old.clear();
-				uelem1->m_VtissueOld.clear();
 				uelem1->m_VvvmOld.clear();
 				uelem1->m_VlimitsOld.clear();
 				uelem1->m_VmarksOld.clear();
@@ -7238,29 +7748,27 @@ DataSelection SlicesHandler::Undo()
 			{
 				DataSelection data_selection = m_Uelem->m_DataSelection;
 
+				// the stored images are swapped in, the current ones are kept for redo
+				Bmphandler& slice = ImageSlice(data_selection.sliceNr);
 				if (data_selection.bmp)
 				{
-					m_Uelem->m_BmpNew = m_ImageSlices[data_selection.sliceNr].CopyBmp();
-					m_Uelem->m_Mode1New = m_ImageSlices[data_selection.sliceNr].ReturnMode(true);
-					m_ImageSlices[data_selection.sliceNr].Copy2bmp(m_Uelem->m_BmpOld, m_Uelem->m_Mode1Old);
-					free(m_Uelem->m_BmpOld);
+					m_Uelem->m_Mode1New = slice.ReturnMode(true);
+					m_Uelem->m_BmpNew = slice.SwapBmpPointer(m_Uelem->m_BmpOld);
+					slice.SetMode(m_Uelem->m_Mode1Old, true);
 					m_Uelem->m_BmpOld = nullptr;
 				}
 
 				if (data_selection.work)
 				{
-					m_Uelem->m_WorkNew = m_ImageSlices[data_selection.sliceNr].CopyWork();
-					m_Uelem->m_Mode2New = m_ImageSlices[data_selection.sliceNr].ReturnMode(false);
-					m_ImageSlices[data_selection.sliceNr].Copy2work(m_Uelem->m_WorkOld, m_Uelem->m_Mode2Old);
-					free(m_Uelem->m_WorkOld);
+					m_Uelem->m_Mode2New = slice.ReturnMode(false);
+					m_Uelem->m_WorkNew = slice.SwapWorkPointer(m_Uelem->m_WorkOld);
+					slice.SetMode(m_Uelem->m_Mode2Old, false);
 					m_Uelem->m_WorkOld = nullptr;
 				}
 
 				if (data_selection.tissues)
 				{
-					m_Uelem->m_TissueNew = m_ImageSlices[data_selection.sliceNr].CopyTissue(m_ActiveTissuelayer);
-					m_ImageSlices[data_selection.sliceNr].Copy2tissue(m_ActiveTissuelayer, m_Uelem->m_TissueOld);
-					free(m_Uelem->m_TissueOld);
+					m_Uelem->m_TissueNew = slice.SwapTissuesPointer(m_ActiveTissuelayer, m_Uelem->m_TissueOld);
 					m_Uelem->m_TissueOld = nullptr;
 				}
 
@@ -7315,31 +7823,12 @@ DataSelection SlicesHandler::Redo()
 
 			if (uelem1 != nullptr)
 			{
-				unsigned short current_slice;
+				unsigned current_slice;
 				DataSelection data_selection = m_Uelem->m_DataSelection;
 				for (unsigned i = 0; i < uelem1->m_Vslicenr.size(); i++)
 				{
 					current_slice = uelem1->m_Vslicenr[i];
-					if (data_selection.bmp)
-					{
-						uelem1->m_VbmpOld.push_back(m_ImageSlices[current_slice].CopyBmp());
-						uelem1->m_Vmode1Old.push_back(m_ImageSlices[current_slice].ReturnMode(true));
-						m_ImageSlices[current_slice].Copy2bmp(uelem1->m_VbmpNew[i], uelem1->m_Vmode1New[i]);
-						free(uelem1->m_VbmpNew[i]);
-					}
-					if (data_selection.work)
-					{
-						uelem1->m_VworkOld.push_back(m_ImageSlices[current_slice].CopyWork());
-						uelem1->m_Vmode2Old.push_back(m_ImageSlices[current_slice].ReturnMode(false));
-						m_ImageSlices[current_slice].Copy2work(uelem1->m_VworkNew[i], uelem1->m_Vmode2New[i]);
-						free(uelem1->m_VworkNew[i]);
-					}
-					if (data_selection.tissues)
-					{
-						uelem1->m_VtissueOld.push_back(m_ImageSlices[current_slice].CopyTissue(m_ActiveTissuelayer));
-						m_ImageSlices[current_slice].Copy2tissue(m_ActiveTissuelayer, uelem1->m_VtissueNew[i]);
-						free(uelem1->m_VtissueNew[i]);
-					}
+					ApplyUndoDeltas(*uelem1, i, true);
 					if (data_selection.vvm)
 					{
 						uelem1->m_VvvmOld.push_back(*(m_ImageSlices[current_slice].ReturnVvm()));
@@ -7356,9 +7845,6 @@ DataSelection SlicesHandler::Redo()
 						m_ImageSlices[current_slice].Copy2marks(&(uelem1->m_VmarksNew[i]));
 					}
 				}
-				uelem1->m_VbmpNew.clear();
-				uelem1->m_VworkNew.clear();
-				uelem1->m_VtissueNew.clear();
 				uelem1->m_VvvmNew.clear();
 				uelem1->m_VlimitsNew.clear();
 				uelem1->m_VmarksNew.clear();
@@ -7376,34 +7862,27 @@ DataSelection SlicesHandler::Redo()
 			{
 				DataSelection data_selection = m_Uelem->m_DataSelection;
 
+				// the stored images are swapped in, the current ones are kept for undo
+				Bmphandler& slice = ImageSlice(data_selection.sliceNr);
 				if (data_selection.bmp)
 				{
-					m_Uelem->m_BmpOld =
-							m_ImageSlices[data_selection.sliceNr].CopyBmp();
-					m_Uelem->m_Mode1Old =
-							m_ImageSlices[data_selection.sliceNr].ReturnMode(true);
-					m_ImageSlices[data_selection.sliceNr].Copy2bmp(m_Uelem->m_BmpNew, m_Uelem->m_Mode1New);
-					free(m_Uelem->m_BmpNew);
+					m_Uelem->m_Mode1Old = slice.ReturnMode(true);
+					m_Uelem->m_BmpOld = slice.SwapBmpPointer(m_Uelem->m_BmpNew);
+					slice.SetMode(m_Uelem->m_Mode1New, true);
 					m_Uelem->m_BmpNew = nullptr;
 				}
 
 				if (data_selection.work)
 				{
-					m_Uelem->m_WorkOld =
-							m_ImageSlices[data_selection.sliceNr].CopyWork();
-					m_Uelem->m_Mode2Old =
-							m_ImageSlices[data_selection.sliceNr].ReturnMode(false);
-					m_ImageSlices[data_selection.sliceNr].Copy2work(m_Uelem->m_WorkNew, m_Uelem->m_Mode2New);
-					free(m_Uelem->m_WorkNew);
+					m_Uelem->m_Mode2Old = slice.ReturnMode(false);
+					m_Uelem->m_WorkOld = slice.SwapWorkPointer(m_Uelem->m_WorkNew);
+					slice.SetMode(m_Uelem->m_Mode2New, false);
 					m_Uelem->m_WorkNew = nullptr;
 				}
 
 				if (data_selection.tissues)
 				{
-					m_Uelem->m_TissueOld =
-							m_ImageSlices[data_selection.sliceNr].CopyTissue(m_ActiveTissuelayer);
-					m_ImageSlices[data_selection.sliceNr].Copy2tissue(m_ActiveTissuelayer, m_Uelem->m_TissueNew);
-					free(m_Uelem->m_TissueNew);
+					m_Uelem->m_TissueOld = slice.SwapTissuesPointer(m_ActiveTissuelayer, m_Uelem->m_TissueNew);
 					m_Uelem->m_TissueNew = nullptr;
 				}
 
@@ -7451,8 +7930,7 @@ DataSelection SlicesHandler::Redo()
 void SlicesHandler::ClearUndo()
 {
 	this->m_UndoQueue.ClearUndo();
-	if (m_Uelem != nullptr)
-		delete (m_Uelem);
+	AbortUndo();
 
 	m_Uelem = nullptr;
 }
@@ -7483,24 +7961,16 @@ unsigned SlicesHandler::ReturnNrundosteps()
 	return this->m_UndoQueue.ReturnNrundomax();
 }
 
-unsigned SlicesHandler::ReturnNrundoarrays()
-{
-	return this->m_UndoQueue.ReturnNrundoarraysmax();
-}
-
 void SlicesHandler::SetUndo3D(bool undo3D1) { m_Undo3D = undo3D1; }
 
 void SlicesHandler::SetUndonr(unsigned nr) { this->m_UndoQueue.SetNrundo(nr); }
 
-void SlicesHandler::SetUndoarraynr(unsigned nr)
-{
-	this->m_UndoQueue.SetNrundoarraysmax(nr);
-}
-
 int SlicesHandler::LoadDICOM(const std::vector<std::string>& filenames_unsorted)
 {
 	if (!filenames_unsorted.empty())
 	{
+		auto const t_start = std::chrono::steady_clock::now();
+
 		// make sure files are sorted according to z-position
 		std::vector<std::string> files(filenames_unsorted);
 		if (files.size() > 1)
@@ -7508,30 +7978,29 @@ int SlicesHandler::LoadDICOM(const std::vector<std::string>& filenames_unsorted)
 			DICOMsort(&files);
 		}
 
-		m_Endslice = m_Nrslices = (unsigned short)files.size();
-		m_Os.SetSizenr(m_Nrslices);
-		m_ImageSlices.resize(m_Nrslices);
-
-		m_Activeslice = 0;
-		m_ActiveTissuelayer = 0;
-		m_Startslice = 0;
-
 		unsigned short a, b, c;
 		float d, e, thick1;
 		float disp1[3];
 		float rot[3][3]; // rotation matrix
-		if (gdcmvtk_rtstruct::GetSizeUsingGDCM(files, a, b, c, d, e, thick1, disp1, rot[0], rot[1], rot[2]))
+		if (!gdcmvtk_rtstruct::GetSizeUsingGDCM(files, a, b, c, d, e, thick1, disp1, rot[0], rot[1], rot[2]))
 		{
-			ISEG_INFO("Dicom series slice thickness: " << thick1)
-			Transform tr;
-			tr.SetRotation(rot[0], rot[1], rot[2]);
-			tr.SetOffset(disp1);
-
-			SetPixelsize(d, e);
-			SetSlicethickness(thick1);
-			SetTransform(tr);
+			return 0;
 		}
 
+		// all slices are allocated up front and decoded concurrently straight into the source
+		Newbmp(a, b, static_cast<unsigned>(files.size()));
+		std::vector<float*> slices = SourceSlices();
+		size_t const area = static_cast<size_t>(a) * b;
+
+		ISEG_INFO("Dicom series slice thickness: " << thick1)
+		Transform tr;
+		tr.SetRotation(rot[0], rot[1], rot[2]);
+		tr.SetOffset(disp1);
+
+		SetPixelsize(d, e);
+		SetSlicethickness(thick1);
+		SetTransform(tr);
+
 		if (files.size() > 1)
 		{
 			double new_thick = gdcmvtk_rtstruct::GetZSPacing(files);
@@ -7546,54 +8015,60 @@ int SlicesHandler::LoadDICOM(const std::vector<std::string>& filenames_unsorted)
 			}
 		}
 
-		for (int i = 0; i < files.size(); i++)
+		std::atomic<bool> ok(true);
+		int const n = static_cast<int>(files.size());
+#pragma omp parallel for schedule(dynamic)
+		for (int i = 0; i < n; i++)
 		{
-			float dc1[6]; // not used
-			if (gdcmvtk_rtstruct::GetSizeUsingGDCM(files[i].c_str(), a, b, c, d, e, thick1, disp1, dc1))
-			{
-				if (c >= 1)
-				{
-					size_t totsize = static_cast<size_t>(a) * b * c;
-					std::vector<float> bits(totsize);
-
-					if (bits.empty())
-						return 0;
+			if (!ok)
+				continue;
 
-					bool canload = gdcmvtk_rtstruct::GetDicomUsingGDCM(files[i].c_str(), bits.data(), a, b, c);
-					if (!canload)
-					{
-						return 0;
-					}
-
-					m_ImageSlices[i].LoadArray(&(bits[0]), a, b);
-				}
+			unsigned short w, h, nrslices;
+			float dx, dy, dz;
+			float disp[3];
+			float dc[6]; // not used
+			if (!gdcmvtk_rtstruct::GetSizeUsingGDCM(files[i].c_str(), w, h, nrslices, dx, dy, dz, disp, dc) || w != a || h != b || nrslices < 1)
+			{
+				ISEG_ERROR("Dicom file " << files[i] << " does not match the series");
+				ok = false;
+			}
+			else if (nrslices == 1)
+			{
+				ok = ok && gdcmvtk_rtstruct::GetDicomUsingGDCM(files[i].c_str(), slices[i], w, h, nrslices);
+			}
+			else
+			{
+				// multi-frame files contribute their first frame
+				std::vector<float> bits(area * nrslices);
+				if (gdcmvtk_rtstruct::GetDicomUsingGDCM(files[i].c_str(), bits.data(), w, h, nrslices))
+					std::copy(bits.begin(), bits.begin() + area, slices[i]);
+				else
+					ok = false;
 			}
 		}
+		if (!ok)
+		{
+			return 0;
+		}
 
-		m_Endslice = m_Nrslices = (unsigned short)(files.size());
-		m_Os.SetSizenr(m_Nrslices);
+		Bmp2workall();
 
 		// Ranges
 		Pair dummy;
-		m_SliceRanges.resize(m_Nrslices);
-		m_SliceBmpranges.resize(m_Nrslices);
 		ComputeRangeMode1(&dummy);
 		ComputeBmprangeMode1(&dummy);
 
-		m_Width = m_ImageSlices[0].ReturnWidth();
-		m_Height = m_ImageSlices[0].ReturnHeight();
-		m_Area = m_Height * static_cast<unsigned int>(m_Width);
-
-		NewOverlay();
+		UpdateVolumeStorage();
 
-		m_Loaded = true;
+		double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+		ISEG_INFO("Loaded " << n << " Dicom files in " << seconds << " s (" << (seconds > 0 ? n / seconds : 0.0) << " files/s)");
 
-		return true;
+		return 1;
 	}
-	return false;
+	return 0;
 }
 
-int SlicesHandler::LoadDICOM(const std::vector<std::string>& filenames_unsorted, Point p, unsigned short dx, unsigned short dy)
+int SlicesHandler::LoadDICOM(const std::vector<std::string>& filenames_unsorted, Point p, unsigned dx, unsigned dy)
 {
 	std::vector<std::string> files(filenames_unsorted);
 
@@ -7610,7 +8085,7 @@ int SlicesHandler::LoadDICOM(const std::vector<std::string>& filenames_unsorted,
 		gdcmvtk_rtstruct::GetSizeUsingGDCM(files[0].c_str(), a, b, c, d, e, thick1, disp1, dc1);
 		if (c > 1)
 		{
-			unsigned long totsize = (unsigned long)(a)*b * c;
+			size_t totsize = static_cast<size_t>(a) * b * c;
 			float* bits = (float*)malloc(sizeof(float) * totsize);
 			if (bits == nullptr)
 				return 0;
@@ -7621,14 +8096,14 @@ int SlicesHandler::LoadDICOM(const std::vector<std::string>& filenames_unsorted,
 				return 0;
 			}
 
-			m_Endslice = m_Nrslices = (unsigned short)c;
+			m_Endslice = m_Nrslices = (unsigned)c;
 			m_Os.SetSizenr(m_Nrslices);
 			m_ImageSlices.resize(m_Nrslices);
 
 			int j = 0;
-			for (unsigned short i = 0; i < m_Nrslices; i++)
+			for (unsigned i = 0; i < m_Nrslices; i++)
 			{
-				if (m_ImageSlices[i].LoadArray(&(bits[(unsigned long)(a)*b * i]), a, b, p, dx, dy))
+				if (ImageSlice(i).LoadArray(&(bits[static_cast<size_t>(a) * b * i]), a, b, p, dx, dy))
 					j++;
 			}
 
@@ -7646,11 +8121,12 @@ int SlicesHandler::LoadDICOM(const std::vector<std::string>& filenames_unsorted,
 
 			m_Width = m_ImageSlices[0].ReturnWidth();
 			m_Height = m_ImageSlices[0].ReturnHeight();
-			m_Area = m_Height * (unsigned int)m_Width;
+			m_Area = m_Height * (size_t)m_Width;
 
 			NewOverlay();
 
 			m_Loaded = true;
+			UpdateVolumeStorage();
 
 			Transform tr(disp1, dc1);
 
@@ -7662,28 +8138,29 @@ int SlicesHandler::LoadDICOM(const std::vector<std::string>& filenames_unsorted,
 		}
 	}
 
-	m_Endslice = m_Nrslices = (unsigned short)(files.size());
+	m_Endslice = m_Nrslices = (unsigned)(files.size());
 	m_Os.SetSizenr(m_Nrslices);
 
 	m_ImageSlices.resize(m_Nrslices);
 	int j = 0;
 
 	float thick1 = DICOMsort(&files);
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		if (m_ImageSlices[i].LoadDICOM(files[i].c_str(), p, dx, dy))
+		if (ImageSlice(i).LoadDICOM(files[i].c_str(), p, dx, dy))
 			j++;
 	}
 
 	m_Width = m_ImageSlices[0].ReturnWidth();
 	m_Height = m_ImageSlices[0].ReturnHeight();
-	m_Area = m_Height * (unsigned int)m_Width;
+	m_Area = m_Height * (size_t)m_Width;
 
 	NewOverlay();
 
 	if (j == m_Nrslices)
 	{
 		m_Loaded = true;
+		UpdateVolumeStorage();
 
 		DicomReader dcmr;
 		if (dcmr.Opendicom(files[0].c_str()))
@@ -7727,14 +8204,14 @@ int SlicesHandler::ReloadDICOM(const std::vector<std::string>& filenames_unsorte
 {
 	std::vector<std::string> files(filenames_unsorted);
 
-	if ((m_Endslice - m_Startslice) == (unsigned short)files.size())
+	if ((m_Endslice - m_Startslice) == (unsigned)files.size())
 	{
 		int j = 0;
 
 		DICOMsort(&files);
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
-			if (m_ImageSlices[i].ReloadDICOM(files[i - m_Startslice].c_str()))
+			if (ImageSlice(i).ReloadDICOM(files[i - m_Startslice].c_str()))
 				j++;
 		}
 
@@ -7743,14 +8220,14 @@ int SlicesHandler::ReloadDICOM(const std::vector<std::string>& filenames_unsorte
 		else
 			return 0;
 	}
-	else if (m_Nrslices <= (unsigned short)files.size())
+	else if (m_Nrslices <= (unsigned)files.size())
 	{
 		int j = 0;
 
 		DICOMsort(&files);
-		for (unsigned short i = 0; i < m_Nrslices; i++)
+		for (unsigned i = 0; i < m_Nrslices; i++)
 		{
-			if (m_ImageSlices[i].ReloadDICOM(files[i].c_str()))
+			if (ImageSlice(i).ReloadDICOM(files[i].c_str()))
 				j++;
 		}
 
@@ -7768,7 +8245,7 @@ int SlicesHandler::ReloadDICOM(const std::vector<std::string>& filenames_unsorte
 		gdcmvtk_rtstruct::GetSizeUsingGDCM(files[0].c_str(), a, b, c, d, e, thick1, disp1, dc1);
 		if (m_Nrslices == c)
 		{
-			unsigned long totsize = (unsigned long)(a)*b * c;
+			size_t totsize = static_cast<size_t>(a) * b * c;
 			float* bits = (float*)malloc(sizeof(float) * totsize);
 			if (bits == nullptr)
 				return 0;
@@ -7780,9 +8257,9 @@ int SlicesHandler::ReloadDICOM(const std::vector<std::string>& filenames_unsorte
 			}
 
 			int j = 0;
-			for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+			for (unsigned i = m_Startslice; i < m_Endslice; i++)
 			{
-				if (m_ImageSlices[i].LoadArray(&(bits[(unsigned long)(a)*b * i]), a, b))
+				if (ImageSlice(i).LoadArray(&(bits[static_cast<size_t>(a) * b * i]), a, b))
 					j++;
 			}
 
@@ -7799,14 +8276,14 @@ int SlicesHandler::ReloadDICOM(const std::vector<std::string>& filenames_unsorte
 {
 	std::vector<std::string> files(filenames_unsorted);
 
-	if ((m_Endslice - m_Startslice) == (unsigned short)files.size())
+	if ((m_Endslice - m_Startslice) == (unsigned)files.size())
 	{
 		int j = 0;
 
 		DICOMsort(&files);
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
-			if (m_ImageSlices[i].ReloadDICOM(files[i - m_Startslice].c_str(), p))
+			if (ImageSlice(i).ReloadDICOM(files[i - m_Startslice].c_str(), p))
 				j++;
 		}
 
@@ -7815,14 +8292,14 @@ int SlicesHandler::ReloadDICOM(const std::vector<std::string>& filenames_unsorte
 		else
 			return 0;
 	}
-	else if (m_Nrslices <= (unsigned short)files.size())
+	else if (m_Nrslices <= (unsigned)files.size())
 	{
 		int j = 0;
 
 		DICOMsort(&files);
-		for (unsigned short i = 0; i < m_Nrslices; i++)
+		for (unsigned i = 0; i < m_Nrslices; i++)
 		{
-			if (m_ImageSlices[i].ReloadDICOM(files[i].c_str(), p))
+			if (ImageSlice(i).ReloadDICOM(files[i].c_str(), p))
 				j++;
 		}
 
@@ -7840,7 +8317,7 @@ int SlicesHandler::ReloadDICOM(const std::vector<std::string>& filenames_unsorte
 		gdcmvtk_rtstruct::GetSizeUsingGDCM(files[0].c_str(), a, b, c, d, e, thick1, disp1, dc1);
 		if (m_Nrslices == c)
 		{
-			unsigned long totsize = (unsigned long)(a)*b * c;
+			size_t totsize = static_cast<size_t>(a) * b * c;
 			float* bits = (float*)malloc(sizeof(float) * totsize);
 			if (bits == nullptr)
 				return 0;
@@ -7852,9 +8329,9 @@ int SlicesHandler::ReloadDICOM(const std::vector<std::string>& filenames_unsorte
 			}
 
 			int j = 0;
-			for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+			for (unsigned i = m_Startslice; i < m_Endslice; i++)
 			{
-				if (m_ImageSlices[i].LoadArray(&(bits[(unsigned long)(a)*b * i]), a, b, p, m_Width, m_Height))
+				if (ImageSlice(i).LoadArray(&(bits[static_cast<size_t>(a) * b * i]), a, b, p, m_Width, m_Height))
 					j++;
 			}
 
@@ -7870,36 +8347,82 @@ int SlicesHandler::ReloadDICOM(const std::vector<std::string>& filenames_unsorte
 	return 0;
 }
 
+namespace {
+
+/// Series number and slice position of the files, the headers are cached in an index per directory
+std::vector<DicomHeaderIndex::Header> ReadDicomHeaders(const std::vector<std::string>& files)
+{
+	auto parse = [](const std::string& fname) {
+		DicomHeaderIndex::Header header;
+		DicomReader dcmread;
+		if (dcmread.Opendicom(fname.c_str()))
+		{
+			header.m_SeriesNr = dcmread.Seriesnr();
+			header.m_SlicePos = dcmread.Slicepos();
+			dcmread.Closedicom();
+		}
+		return header;
+	};
+
+	std::map<std::string, std::vector<size_t>> directories;
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		directories[boost::filesystem::path(files[i]).parent_path().string()].push_back(i);
+	}
+
+	std::vector<DicomHeaderIndex::Header> headers(files.size());
+	for (const auto& dir : directories)
+	{
+		std::vector<std::string> dir_files;
+		for (size_t i : dir.second)
+		{
+			dir_files.push_back(files[i]);
+		}
+
+		DicomHeaderIndex index(dir.first.empty() ? "." : dir.first);
+		auto const dir_headers = index.Lookup(dir_files, parse);
+		for (size_t k = 0; k < dir.second.size(); k++)
+		{
+			headers[dir.second[k]] = dir_headers[k];
+		}
+		ISEG_INFO("Parsed " << index.NumParsed() << " of " << dir_files.size() << " DICOM headers in " << dir.first);
+		if (!index.Save())
+		{
+			ISEG_WARNING("Could not write the DICOM index of " << dir.first);
+		}
+	}
+	return headers;
+}
+
+} // namespace
+
 float SlicesHandler::DICOMsort(std::vector<std::string>* lfilename)
 {
 	float retval = -1.0f;
-	DicomReader dcmread;
-	std::vector<float> vpos;
+	int const nrelem = static_cast<int>(lfilename->size());
+	std::vector<float> vpos(nrelem, 0.f);
 
-	for (const auto& fname : *lfilename)
+	auto const headers = ReadDicomHeaders(*lfilename);
+	for (int i = 0; i < nrelem; i++)
 	{
-		dcmread.Opendicom(fname.c_str());
-		vpos.push_back(dcmread.Slicepos());
-		dcmread.Closedicom();
+		vpos[i] = headers[i].m_SlicePos;
 	}
 
-	short nrelem = (short)lfilename->size();
+	// descending position, files at the same position keep their order
+	std::vector<int> order(nrelem);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&vpos](int l, int r) { return vpos[l] > vpos[r]; });
 
-	for (short i = 0; i < nrelem - 1; i++)
+	std::vector<std::string> sorted(nrelem);
+	for (int i = 0; i < nrelem; i++)
 	{
-		for (short j = nrelem - 1; j > i; j--)
-		{
-			if (vpos[j] > vpos[j - 1])
-			{
-				std::swap(vpos[j], vpos[j - 1]);
-				std::swap((*lfilename)[j], (*lfilename)[j - 1]);
-			}
-		}
+		sorted[i] = std::move((*lfilename)[order[i]]);
 	}
+	lfilename->swap(sorted);
 
 	if (nrelem > 1)
 	{
-		retval = (vpos[0] - vpos[nrelem - 1]) / (nrelem - 1);
+		retval = (vpos[order[0]] - vpos[order[nrelem - 1]]) / (nrelem - 1);
 	}
 
 	return retval;
@@ -7907,15 +8430,12 @@ float SlicesHandler::DICOMsort(std::vector<std::string>* lfilename)
 
 void SlicesHandler::GetDICOMseriesnr(std::vector<std::string>* vnames, std::vector<unsigned>* dicomseriesnr, std::vector<unsigned>* dicomseriesnrlist)
 {
-	DicomReader dcmread;
+	auto const headers = ReadDicomHeaders(*vnames);
 
 	dicomseriesnr->clear();
-	for (const auto& fname : *vnames)
+	for (const auto& header : headers)
 	{
-		dcmread.Opendicom(fname.c_str());
-		unsigned u = dcmread.Seriesnr();
-		dcmread.Closedicom();
-
+		unsigned const u = header.m_SeriesNr;
 		dicomseriesnrlist->push_back(u);
 
 		if (std::find(dicomseriesnr->begin(), dicomseriesnr->end(), u) == dicomseriesnr->end())
@@ -7936,6 +8456,7 @@ void SlicesHandler::MaskSource(bool all_slices, float maskvalue)
 		mask.at(label) = true;
 	}
 
+	TissuesPin pin(this);
 	auto sources = SourceSlices();
 	auto tissues = TissueSlices(0);
 
@@ -7975,7 +8496,7 @@ void SlicesHandler::MapTissueIndices(const std::vector<tissues_size_t>& indexMap
 #pragma omp parallel for
 	for (int i = 0; i < i_n; i++)
 	{
-		m_ImageSlices[i].MapTissueIndices(indexMap);
+		ImageSlice(i).MapTissueIndices(indexMap);
 	}
 }
 
@@ -7986,7 +8507,7 @@ void SlicesHandler::RemoveTissue(tissues_size_t tissuenr)
 #pragma omp parallel for
 	for (int i = 0; i < i_n; i++)
 	{
-		m_ImageSlices[i].RemoveTissue(tissuenr);
+		ImageSlice(i).RemoveTissue(tissuenr);
 	}
 	TissueInfos::RemoveTissue(tissuenr);
 }
@@ -8015,9 +8536,9 @@ void SlicesHandler::RemoveTissues(const std::set<tissues_size_t>& tissuenrs)
 
 void SlicesHandler::RemoveTissueall()
 {
-	for (short unsigned i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		m_ImageSlices[i].Cleartissuesall();
+		ImageSlice(i).Cleartissuesall();
 	}
 	TissueInfos::RemoveAllTissues();
 	TissueInfo tissue;
@@ -8029,9 +8550,9 @@ void SlicesHandler::RemoveTissueall()
 
 void SlicesHandler::CapTissue(tissues_size_t maxval)
 {
-	for (short unsigned i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		m_ImageSlices[i].CapTissue(maxval);
+		ImageSlice(i).CapTissue(maxval);
 	}
 }
 
@@ -8060,7 +8581,7 @@ std::vector<tissues_size_t> SlicesHandler::FindUnusedTissues()
 
 	for (int i = 0, i_n = m_Nrslices; i < i_n; i++)
 	{
-		auto tissues = m_ImageSlices[i].ReturnTissues(m_ActiveTissuelayer);
+		auto tissues = ImageSlice(i).ReturnTissues(m_ActiveTissuelayer);
 		for (unsigned k = 0; k < m_Area; ++k)
 		{
 			is_used[tissues[k]] = 1;
@@ -8087,39 +8608,46 @@ void SlicesHandler::GroupTissues(std::vector<tissues_size_t>& olds, std::vector<
 #pragma omp parallel for
 	for (int i = 0; i < i_n; i++)
 	{
-		m_ImageSlices[i].GroupTissues(m_ActiveTissuelayer, olds, news);
+		ImageSlice(i).GroupTissues(m_ActiveTissuelayer, olds, news);
 	}
 }
 void SlicesHandler::SetModeall(unsigned char mode, bool bmporwork)
 {
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		m_ImageSlices[i].SetMode(mode, bmporwork);
 }
 
-bool SlicesHandler::PrintTissuemat(const char* filename)
+bool SlicesHandler::PrintTissuemat(const char* filename, ProgressInfo* progress)
 {
+	// large volumes are written as MAT-files of version 7.3, which are HDF5 files
+	WaitForBackgroundSave();
+
 	std::vector<tissues_size_t*> matrix(m_Nrslices);
-	for (unsigned short i = 0; i < m_Nrslices; i++)
-		matrix[i] = m_ImageSlices[i].ReturnTissues(m_ActiveTissuelayer);
-	bool ok = matexport::print_matslices(filename, matrix.data(), int(m_Width), int(m_Height), int(m_Nrslices), "iSeg tissue data v1.0", 21, "tissuedistrib", 13);
+	for (unsigned i = 0; i < m_Nrslices; i++)
+		matrix[i] = ImageSlice(i).ReturnTissues(m_ActiveTissuelayer);
+	bool ok = matexport::print_matslices(filename, matrix.data(), int(m_Width), int(m_Height), int(m_Nrslices), "iSeg tissue data v1.0", 21, "tissuedistrib", 13, progress);
 	return ok;
 }
 
-bool SlicesHandler::PrintBmpmat(const char* filename)
+bool SlicesHandler::PrintBmpmat(const char* filename, ProgressInfo* progress)
 {
+	WaitForBackgroundSave();
+
 	std::vector<float*> matrix(m_Nrslices);
-	for (unsigned short i = 0; i < m_Nrslices; i++)
-		matrix[i] = m_ImageSlices[i].ReturnBmp();
-	bool ok = matexport::print_matslices(filename, matrix.data(), int(m_Width), int(m_Height), int(m_Nrslices), "iSeg source data v1.0", 21, "sourcedistrib", 13);
+	for (unsigned i = 0; i < m_Nrslices; i++)
+		matrix[i] = ImageSlice(i).ReturnBmp();
+	bool ok = matexport::print_matslices(filename, matrix.data(), int(m_Width), int(m_Height), int(m_Nrslices), "iSeg source data v1.0", 21, "sourcedistrib", 13, false, progress);
 	return ok;
 }
 
-bool SlicesHandler::PrintWorkmat(const char* filename)
+bool SlicesHandler::PrintWorkmat(const char* filename, ProgressInfo* progress)
 {
+	WaitForBackgroundSave();
+
 	std::vector<float*> matrix(m_Nrslices);
-	for (unsigned short i = 0; i < m_Nrslices; i++)
-		matrix[i] = m_ImageSlices[i].ReturnWork();
-	bool ok = matexport::print_matslices(filename, matrix.data(), int(m_Width), int(m_Height), int(m_Nrslices), "iSeg target data v1.0", 21, "targetdistrib", 13);
+	for (unsigned i = 0; i < m_Nrslices; i++)
+		matrix[i] = ImageSlice(i).ReturnWork();
+	bool ok = matexport::print_matslices(filename, matrix.data(), int(m_Width), int(m_Height), int(m_Nrslices), "iSeg target data v1.0", 21, "targetdistrib", 13, false, progress);
 	return ok;
 }
 
@@ -8146,91 +8674,59 @@ bool SlicesHandler::PrintAtlas(const char* filename)
 		tissue_info = TissueInfos::GetTissueInfo(tissuenr);
 		out << ToQ(tissue_info->m_Name) << tissue_info->m_Color[0] << tissue_info->m_Color[1] << tissue_info->m_Color[2];
 	}
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
-		out.writeRawData((char*)m_ImageSlices[i].ReturnBmp(), (int)m_Area * sizeof(float));
-		out.writeRawData((char*)m_ImageSlices[i].ReturnTissues(m_ActiveTissuelayer), (int)m_Area * sizeof(tissues_size_t));
+		out.writeRawData((char*)ImageSlice(i).ReturnBmp(), (int)m_Area * sizeof(float));
+		out.writeRawData((char*)ImageSlice(i).ReturnTissues(m_ActiveTissuelayer), (int)m_Area * sizeof(tissues_size_t));
 	}
 
 	return true;
 }
 
-bool SlicesHandler::PrintAmascii(const char* filename)
+namespace {
+
+/// Tissues as materials of an AmiraMesh file, with names Amira accepts
+std::vector<LabelFieldWriter::Material> AmiraMaterials()
 {
-	std::ofstream streamname;
-	streamname.open(filename, std::ios_base::binary);
-	if (streamname.good())
+	tissues_size_t tissue_count = TissueInfos::GetTissueCount();
+	std::vector<LabelFieldWriter::Material> materials(tissue_count);
+	for (tissues_size_t tc = 0; tc < tissue_count; tc++)
 	{
-		bool ok = true;
-		streamname << "# AmiraMesh 3D ASCII 2.0" << endl
-							 << endl;
-		streamname << "# CreationDate: Fri Jun 16 14:24:32 2006" << endl
-							 << endl
-							 << endl;
-		streamname << "define Lattice " << m_Width << " " << m_Height << " "
-							 << m_Nrslices << endl
-							 << endl;
-		streamname << "Parameters {" << endl;
-		streamname << "    Materials {" << endl;
-		streamname << "        Exterior {" << endl;
-		streamname << "            Id 1" << endl;
-		streamname << "        }" << endl;
-		tissues_size_t tissue_count = TissueInfos::GetTissueCount();
-		TissueInfo* tissue_info;
-		for (tissues_size_t tc = 0; tc < tissue_count; tc++)
-		{
-			tissue_info = TissueInfos::GetTissueInfo(tc + 1);
-			QString name_cpy = ToQ(tissue_info->m_Name);
-			name_cpy = name_cpy.replace("�", "ae");
-			name_cpy = name_cpy.replace("�", "Ae");
-			name_cpy = name_cpy.replace("�", "oe");
-			name_cpy = name_cpy.replace("�", "Oe");
-			name_cpy = name_cpy.replace("�", "ue");
-			name_cpy = name_cpy.replace("�", "Ue");
-			streamname << "        " << name_cpy.toStdString() << " {" << endl;
-			streamname << "            Color " << tissue_info->m_Color[0] << " "
-								 << tissue_info->m_Color[1] << " " << tissue_info->m_Color[2]
-								 << "," << endl;
-			streamname << "            Id " << tc + 2 << endl;
-			streamname << "        }" << endl;
-		}
-		streamname << "    }" << endl;
-		if (tissue_count <= 255)
-		{
-			streamname << "    Content \"" << m_Width << "x" << m_Height << "x"
-								 << m_Nrslices << " byte, uniform coordinates\"," << endl;
-		}
-		else
-		{
-			streamname << "    Content \"" << m_Width << "x" << m_Height << "x"
-								 << m_Nrslices << " ushort, uniform coordinates\"," << endl;
-		}
-		streamname << "    BoundingBox 0 " << m_Width * m_Dx << " 0 " << m_Height * m_Dy
-							 << " 0 " << m_Nrslices * m_Thickness << "," << endl;
-		streamname << "    CoordType \"uniform\"" << endl;
-		streamname << "}" << endl
-							 << endl;
-		if (tissue_count <= 255)
-		{
-			streamname << "Lattice { byte Labels } @1" << endl
-								 << endl;
-		}
-		else
-		{
-			streamname << "Lattice { ushort Labels } @1" << endl
-								 << endl;
-		}
-		streamname << "# Data section follows" << endl;
-		streamname << "@1" << endl;
-		for (unsigned short i = 0; i < m_Nrslices; i++)
-			ok &= m_ImageSlices[i].PrintAmasciiSlice(m_ActiveTissuelayer, streamname);
-		streamname << endl;
-
-		streamname.close();
-		return ok;
+		TissueInfo* tissue_info = TissueInfos::GetTissueInfo(tc + 1);
+		QString name_cpy = ToQ(tissue_info->m_Name);
+		// umlauts as code points, the source is not necessarily read as UTF-8
+		name_cpy = name_cpy.replace(QChar(0xe4), "ae");
+		name_cpy = name_cpy.replace(QChar(0xc4), "Ae");
+		name_cpy = name_cpy.replace(QChar(0xf6), "oe");
+		name_cpy = name_cpy.replace(QChar(0xd6), "Oe");
+		name_cpy = name_cpy.replace(QChar(0xfc), "ue");
+		name_cpy = name_cpy.replace(QChar(0xdc), "Ue");
+		materials[tc].m_Name = name_cpy.toStdString();
+		for (int c = 0; c < 3; c++)
+			materials[tc].m_Color[c] = tissue_info->m_Color[c];
 	}
-	else
-		return false;
+	return materials;
+}
+
+} // namespace
+
+bool SlicesHandler::PrintAmascii(const char* filename)
+{
+	return ExportLabelField(filename, true);
+}
+
+bool SlicesHandler::ExportLabelField(const char* filename, bool ascii, ProgressInfo* progress)
+{
+	std::vector<const tissues_size_t*> slices(m_Nrslices);
+	for (unsigned i = 0; i < m_Nrslices; i++)
+		slices[i] = ImageSlice(i).ReturnTissues(m_ActiveTissuelayer);
+
+	float const spacing[3] = {m_Dx, m_Dy, m_Thickness};
+	LabelFieldWriter writer(slices.data(), m_Width, m_Height, m_Nrslices, spacing, TissueInfos::GetTissueCount());
+	writer.SetProgress(progress);
+	if (ascii)
+		return writer.WriteAmiraMesh(filename, AmiraMaterials(), true);
+	return writer.Write(filename, AmiraMaterials());
 }
 
 /// This function returns a pointer to a vtkImageData
@@ -8253,7 +8749,7 @@ vtkImageData* SlicesHandler::MakeVtktissueimage()
 		label_field->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
 		unsigned char* field =
 				(unsigned char*)label_field->GetScalarPointer(0, 0, 0);
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
 			Copyfromtissue(i, &(field[i * (unsigned long long)ReturnArea()]));
 		}
@@ -8262,7 +8758,7 @@ vtkImageData* SlicesHandler::MakeVtktissueimage()
 	{
 		label_field->AllocateScalars(VTK_UNSIGNED_SHORT, 1);
 		tissues_size_t* field = (tissues_size_t*)label_field->GetScalarPointer(0, 0, 0);
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
 			Copyfromtissue(i, &(field[i * (unsigned long long)ReturnArea()]));
 		}
@@ -8301,6 +8797,7 @@ vtkImageData* SlicesHandler::MakeVtktissueimage()
 
 bool SlicesHandler::ExportTissue(const char* filename, bool binary) const
 {
+	TissuesPin pin(const_cast<SlicesHandler*>(this));
 	auto slices = const_cast<SlicesHandler*>(this)->TissueSlices(m_ActiveTissuelayer);
 	return ImageWriter(binary).WriteVolume(filename, slices, ImageWriter::kActiveSlices, this);
 }
@@ -8329,7 +8826,7 @@ bool SlicesHandler::PrintXmlregionextent(const char* filename, bool onlyactivesl
 		bool ok = true;
 		streamname << "<?xml version=\"1.0\"?>" << endl;
 		streamname << "<IndexFile type=\"Extent\" version=\"0.1\">" << endl;
-		unsigned short extent[3][2];
+		unsigned extent[3][2];
 		tissues_size_t tissue_count = TissueInfos::GetTissueCount();
 		TissueInfo* tissue_info;
 		for (tissues_size_t tissuenr = 1; tissuenr <= tissue_count; tissuenr++)
@@ -8393,11 +8890,11 @@ bool SlicesHandler::PrintTissueindex(const char* filename, bool onlyactiveslices
 		return false;
 }
 
-bool SlicesHandler::GetExtent(tissues_size_t tissuenr, bool onlyactiveslices, unsigned short extent[3][2])
+bool SlicesHandler::GetExtent(tissues_size_t tissuenr, bool onlyactiveslices, unsigned extent[3][2])
 {
 	bool found = false;
-	unsigned short extent1[2][2];
-	unsigned short startslice1, endslice1;
+	unsigned extent1[2][2];
+	unsigned startslice1, endslice1;
 	startslice1 = 0;
 	endslice1 = m_Nrslices;
 	if (onlyactiveslices)
@@ -8405,11 +8902,11 @@ bool SlicesHandler::GetExtent(tissues_size_t tissuenr, bool onlyactiveslices, un
 		startslice1 = m_Startslice;
 		endslice1 = m_Endslice;
 	}
-	for (unsigned short i = startslice1; i < endslice1; i++)
+	for (unsigned i = startslice1; i < endslice1; i++)
 	{
 		if (!found)
 		{
-			found = m_ImageSlices[i].GetExtent(m_ActiveTissuelayer, tissuenr, extent1);
+			found = ImageSlice(i).GetExtent(m_ActiveTissuelayer, tissuenr, extent1);
 			if (found)
 			{
 				extent[2][0] = i;
@@ -8422,7 +8919,7 @@ bool SlicesHandler::GetExtent(tissues_size_t tissuenr, bool onlyactiveslices, un
 		}
 		else
 		{
-			if (m_ImageSlices[i].GetExtent(m_ActiveTissuelayer, tissuenr, extent1))
+			if (ImageSlice(i).GetExtent(m_ActiveTissuelayer, tissuenr, extent1))
 			{
 				if (extent1[0][0] < extent[0][0])
 					extent[0][0] = extent1[0][0];
@@ -8445,10 +8942,10 @@ void SlicesHandler::AddSkin3D(int ix, int iy, int iz, float setto)
 	// ix,iy,iz are in pixels
 
 	//Create skin in each slice as same way is done in the 2D AddSkin process
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
 		float* work;
-		work = m_ImageSlices[z].ReturnWork();
+		work = ImageSlice(z).ReturnWork();
 		unsigned i = 0, pos, y, x;
 
 		//Create a binary vector noTissue/Tissue
@@ -8555,12 +9052,12 @@ void SlicesHandler::AddSkin3D(int ix, int iy, int iz, float setto)
 	//int checkSliceDistance = int(iz/thickness);
 	int check_slice_distance = iz;
 
-	for (unsigned short z = m_Startslice; z < m_Endslice - check_slice_distance; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice - check_slice_distance; z++)
 	{
 		float* work1;
 		float* work2;
-		work1 = m_ImageSlices[z].ReturnWork();
-		work2 = m_ImageSlices[z + check_slice_distance].ReturnWork();
+		work1 = ImageSlice(z).ReturnWork();
+		work2 = ImageSlice(z + check_slice_distance).ReturnWork();
 
 		unsigned i = 0;
 		for (int j = 0; j < m_Height; j++)
@@ -8575,13 +9072,13 @@ void SlicesHandler::AddSkin3D(int ix, int iy, int iz, float setto)
 		}
 	}
 
-	for (unsigned short z = m_Endslice - 1; z > m_Startslice + check_slice_distance;
+	for (unsigned z = m_Endslice - 1; z > m_Startslice + check_slice_distance;
 			 z--)
 	{
 		float* work1;
 		float* work2;
-		work1 = m_ImageSlices[z].ReturnWork();
-		work2 = m_ImageSlices[z - check_slice_distance].ReturnWork();
+		work1 = ImageSlice(z).ReturnWork();
+		work2 = ImageSlice(z - check_slice_distance).ReturnWork();
 
 		unsigned i = 0;
 		for (int j = 0; j < m_Height; j++)
@@ -8600,9 +9097,9 @@ void SlicesHandler::AddSkin3D(int ix, int iy, int iz, float setto)
 void SlicesHandler::AddSkin3DOutside(int ix, int iy, int iz, float setto)
 {
 	float set_to = (float)123E10;
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		m_ImageSlices[z].FloodExterior(set_to);
+		ImageSlice(z).FloodExterior(set_to);
 	}
 
 	std::vector<Posit> s;
@@ -8612,10 +9109,10 @@ void SlicesHandler::AddSkin3DOutside(int ix, int iy, int iz, float setto)
 
 	float* work1;
 	float* work2;
-	for (unsigned short z = m_Startslice; z + 1 < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z + 1 < m_Endslice; z++)
 	{
-		work1 = m_ImageSlices[z].ReturnWork();
-		work2 = m_ImageSlices[z + 1].ReturnWork();
+		work1 = ImageSlice(z).ReturnWork();
+		work2 = ImageSlice(z + 1).ReturnWork();
 		for (unsigned long i = 0; i < m_Area; i++)
 		{
 			if (work1[i] == 0 && work2[i] == set_to)
@@ -8627,10 +9124,10 @@ void SlicesHandler::AddSkin3DOutside(int ix, int iy, int iz, float setto)
 			}
 		}
 	}
-	for (unsigned short z = m_Endslice - 1; z > m_Startslice; z--)
+	for (unsigned z = m_Endslice - 1; z > m_Startslice; z--)
 	{
-		work1 = m_ImageSlices[z].ReturnWork();
-		work2 = m_ImageSlices[z - 1].ReturnWork();
+		work1 = ImageSlice(z).ReturnWork();
+		work2 = ImageSlice(z - 1).ReturnWork();
 		for (unsigned long i = 0; i < m_Area; i++)
 		{
 			if (work1[i] == 0 && work2[i] == set_to)
@@ -8651,7 +9148,7 @@ void SlicesHandler::AddSkin3DOutside(int ix, int iy, int iz, float setto)
 		i = s.back();
 		s.pop_back();
 
-		work = m_ImageSlices[i.m_Pz].ReturnWork();
+		work = ImageSlice(i.m_Pz).ReturnWork();
 		if (i.m_Pxy % m_Width != 0 && work[i.m_Pxy - 1] == 0)
 		{
 			work[i.m_Pxy - 1] = set_to;
@@ -8682,7 +9179,7 @@ void SlicesHandler::AddSkin3DOutside(int ix, int iy, int iz, float setto)
 		}
 		if (i.m_Pz > m_Startslice)
 		{
-			work = m_ImageSlices[i.m_Pz - 1].ReturnWork();
+			work = ImageSlice(i.m_Pz - 1).ReturnWork();
 			if (work[i.m_Pxy] == 0)
 			{
 				work[i.m_Pxy] = set_to;
@@ -8693,7 +9190,7 @@ void SlicesHandler::AddSkin3DOutside(int ix, int iy, int iz, float setto)
 		}
 		if (i.m_Pz + 1 < m_Endslice)
 		{
-			work = m_ImageSlices[i.m_Pz + 1].ReturnWork();
+			work = ImageSlice(i.m_Pz + 1).ReturnWork();
 			if (work[i.m_Pxy] == 0)
 			{
 				work[i.m_Pxy] = set_to;
@@ -8704,12 +9201,12 @@ void SlicesHandler::AddSkin3DOutside(int ix, int iy, int iz, float setto)
 		}
 	}
 
-	unsigned short x, y;
+	unsigned x, y;
 	unsigned long pos;
-	unsigned short i1;
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	unsigned i1;
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		work = m_ImageSlices[z].ReturnWork();
+		work = ImageSlice(z).ReturnWork();
 
 		for (y = 0; y < m_Height; y++)
 		{
@@ -8815,9 +9312,9 @@ void SlicesHandler::AddSkin3DOutside(int ix, int iy, int iz, float setto)
 	unsigned short* counter = (unsigned short*)malloc(sizeof(unsigned short) * m_Area);
 	for (unsigned i1 = 0; i1 < m_Area; i1++)
 		counter[i1] = 0;
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		work = m_ImageSlices[z].ReturnWork();
+		work = ImageSlice(z).ReturnWork();
 		for (pos = 0; pos < m_Area; pos++)
 		{
 			if (work[pos] != set_to)
@@ -8834,9 +9331,9 @@ void SlicesHandler::AddSkin3DOutside(int ix, int iy, int iz, float setto)
 	}
 	for (unsigned i1 = 0; i1 < m_Area; i1++)
 		counter[i1] = 0;
-	for (unsigned short z = m_Endslice - 1; z > m_Startslice; z--)
+	for (unsigned z = m_Endslice - 1; z > m_Startslice; z--)
 	{
-		work = m_ImageSlices[z].ReturnWork();
+		work = ImageSlice(z).ReturnWork();
 		for (pos = 0; pos < m_Area; pos++)
 		{
 			if (work[pos] != set_to)
@@ -8851,7 +9348,7 @@ void SlicesHandler::AddSkin3DOutside(int ix, int iy, int iz, float setto)
 			}
 		}
 	}
-	work = m_ImageSlices[m_Startslice].ReturnWork();
+	work = ImageSlice(m_Startslice).ReturnWork();
 	for (pos = 0; pos < m_Area; pos++)
 	{
 		if (work[pos] != set_to)
@@ -8867,9 +9364,9 @@ void SlicesHandler::AddSkin3DOutside(int ix, int iy, int iz, float setto)
 	}
 	free(counter);
 
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		work = m_ImageSlices[z].ReturnWork();
+		work = ImageSlice(z).ReturnWork();
 		for (unsigned i1 = 0; i1 < m_Area; i1++)
 			if (work[i1] == set_to)
 				work[i1] = 0;
@@ -8880,9 +9377,9 @@ void SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz, float setto)
 {
 	float set_to = (float)123E10;
 	float set_to2 = (float)321E10;
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		m_ImageSlices[z].FloodExterior(set_to);
+		ImageSlice(z).FloodExterior(set_to);
 	}
 
 	//Point p;
@@ -8895,10 +9392,10 @@ void SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz, float setto)
 
 	float* work1;
 	float* work2;
-	for (unsigned short z = m_Startslice; z + 1 < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z + 1 < m_Endslice; z++)
 	{
-		work1 = m_ImageSlices[z].ReturnWork();
-		work2 = m_ImageSlices[z + 1].ReturnWork();
+		work1 = ImageSlice(z).ReturnWork();
+		work2 = ImageSlice(z + 1).ReturnWork();
 		for (unsigned long i = 0; i < m_Area; i++)
 		{
 			if (work1[i] == 0 && work2[i] == set_to)
@@ -8910,10 +9407,10 @@ void SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz, float setto)
 			}
 		}
 	}
-	for (unsigned short z = m_Endslice - 1; z > m_Startslice; z--)
+	for (unsigned z = m_Endslice - 1; z > m_Startslice; z--)
 	{
-		work1 = m_ImageSlices[z].ReturnWork();
-		work2 = m_ImageSlices[z - 1].ReturnWork();
+		work1 = ImageSlice(z).ReturnWork();
+		work2 = ImageSlice(z - 1).ReturnWork();
 		for (unsigned long i = 0; i < m_Area; i++)
 		{
 			if (work1[i] == 0 && work2[i] == set_to)
@@ -8934,7 +9431,7 @@ void SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz, float setto)
 		i = s.back();
 		s.pop_back();
 
-		work = m_ImageSlices[i.m_Pz].ReturnWork();
+		work = ImageSlice(i.m_Pz).ReturnWork();
 		if (i.m_Pxy % m_Width != 0 && work[i.m_Pxy - 1] == 0)
 		{
 			work[i.m_Pxy - 1] = set_to;
@@ -8965,7 +9462,7 @@ void SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz, float setto)
 		}
 		if (i.m_Pz > m_Startslice)
 		{
-			work = m_ImageSlices[i.m_Pz - 1].ReturnWork();
+			work = ImageSlice(i.m_Pz - 1).ReturnWork();
 			if (work[i.m_Pxy] == 0)
 			{
 				work[i.m_Pxy] = set_to;
@@ -8976,7 +9473,7 @@ void SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz, float setto)
 		}
 		if (i.m_Pz + 1 < m_Endslice)
 		{
-			work = m_ImageSlices[i.m_Pz + 1].ReturnWork();
+			work = ImageSlice(i.m_Pz + 1).ReturnWork();
 			if (work[i.m_Pxy] == 0)
 			{
 				work[i.m_Pxy] = set_to;
@@ -8995,10 +9492,10 @@ void SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz, float setto)
 	Treap<Posit, unsigned int> treap1;
 	if (iz > 0)
 	{
-		for (unsigned short z = m_Startslice; z + 1 < m_Endslice; z++)
+		for (unsigned z = m_Startslice; z + 1 < m_Endslice; z++)
 		{
-			work1 = m_ImageSlices[z].ReturnWork();
-			work2 = m_ImageSlices[z + 1].ReturnWork();
+			work1 = ImageSlice(z).ReturnWork();
+			work2 = ImageSlice(z + 1).ReturnWork();
 			for (unsigned long i = 0; i < m_Area; i++)
 			{
 				if (work1[i] == set_to)
@@ -9048,14 +9545,14 @@ void SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz, float setto)
 
 	if (ix > 0)
 	{
-		for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+		for (unsigned z = m_Startslice; z < m_Endslice; z++)
 		{
 			p1.m_Pz = z;
-			work1 = m_ImageSlices[z].ReturnWork();
+			work1 = ImageSlice(z).ReturnWork();
 			unsigned long i = 0;
-			for (unsigned short y = 0; y < m_Height; y++)
+			for (unsigned y = 0; y < m_Height; y++)
 			{
-				for (unsigned short x = 0; x + 1 < m_Width; x++)
+				for (unsigned x = 0; x + 1 < m_Width; x++)
 				{
 					if (work1[i] == set_to)
 					{
@@ -9107,14 +9604,14 @@ void SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz, float setto)
 
 	if (iy > 0)
 	{
-		for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+		for (unsigned z = m_Startslice; z < m_Endslice; z++)
 		{
 			p1.m_Pz = z;
-			work1 = m_ImageSlices[z].ReturnWork();
+			work1 = ImageSlice(z).ReturnWork();
 			unsigned long i = 0;
-			for (unsigned short y = 0; y + 1 < m_Height; y++)
+			for (unsigned y = 0; y + 1 < m_Height; y++)
 			{
-				for (unsigned short x = 0; x < m_Width; x++)
+				for (unsigned x = 0; x < m_Width; x++)
 				{
 					if (work1[i] == set_to)
 					{
@@ -9170,7 +9667,7 @@ void SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz, float setto)
 	{
 		p1 = n1->GetKey();
 		prior = n1->GetPriority();
-		work1 = m_ImageSlices[p1.m_Pz].ReturnWork();
+		work1 = ImageSlice(p1.m_Pz).ReturnWork();
 		work1[p1.m_Pxy] = setto;
 		if (p1.m_Pxy % m_Width != 0)
 		{
@@ -9262,7 +9759,7 @@ void SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz, float setto)
 		}
 		if (p1.m_Pz > m_Startslice)
 		{
-			work2 = m_ImageSlices[p1.m_Pz - 1].ReturnWork();
+			work2 = ImageSlice(p1.m_Pz - 1).ReturnWork();
 			if (work2[p1.m_Pxy] == set_to)
 			{
 				if (prior + 2 * subz <= totcount)
@@ -9285,7 +9782,7 @@ void SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz, float setto)
 		}
 		if (p1.m_Pz + 1 < m_Endslice)
 		{
-			work2 = m_ImageSlices[p1.m_Pz + 1].ReturnWork();
+			work2 = ImageSlice(p1.m_Pz + 1).ReturnWork();
 			if (work2[p1.m_Pxy] == set_to)
 			{
 				if (prior + 2 * subz <= totcount)
@@ -9310,9 +9807,9 @@ void SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz, float setto)
 		delete treap1.Remove(n1);
 	}
 
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		work = m_ImageSlices[z].ReturnWork();
+		work = ImageSlice(z).ReturnWork();
 		for (unsigned i1 = 0; i1 < m_Area; i1++)
 			if (work[i1] == set_to)
 				work[i1] = 0;
@@ -9323,9 +9820,9 @@ void SlicesHandler::AddSkintissue3DOutside2(int ix, int iy, int iz, tissues_size
 {
 	tissues_size_t set_to = TISSUES_SIZE_MAX;
 	tissues_size_t set_to2 = TISSUES_SIZE_MAX - 1;
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		m_ImageSlices[z].FloodExteriortissue(m_ActiveTissuelayer, set_to);
+		ImageSlice(z).FloodExteriortissue(m_ActiveTissuelayer, set_to);
 	}
 
 	std::vector<Posit> s;
@@ -9335,10 +9832,10 @@ void SlicesHandler::AddSkintissue3DOutside2(int ix, int iy, int iz, tissues_size
 
 	tissues_size_t* work1;
 	tissues_size_t* work2;
-	for (unsigned short z = m_Startslice; z + 1 < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z + 1 < m_Endslice; z++)
 	{
-		work1 = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
-		work2 = m_ImageSlices[z + 1].ReturnTissues(m_ActiveTissuelayer);
+		work1 = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
+		work2 = ImageSlice(z + 1).ReturnTissues(m_ActiveTissuelayer);
 		for (unsigned long i = 0; i < m_Area; i++)
 		{
 			if (work1[i] == 0 && work2[i] == set_to)
@@ -9350,10 +9847,10 @@ void SlicesHandler::AddSkintissue3DOutside2(int ix, int iy, int iz, tissues_size
 			}
 		}
 	}
-	for (unsigned short z = m_Endslice - 1; z > m_Startslice; z--)
+	for (unsigned z = m_Endslice - 1; z > m_Startslice; z--)
 	{
-		work1 = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
-		work2 = m_ImageSlices[z - 1].ReturnTissues(m_ActiveTissuelayer);
+		work1 = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
+		work2 = ImageSlice(z - 1).ReturnTissues(m_ActiveTissuelayer);
 		for (unsigned long i = 0; i < m_Area; i++)
 		{
 			if (work1[i] == 0 && work2[i] == set_to)
@@ -9374,7 +9871,7 @@ void SlicesHandler::AddSkintissue3DOutside2(int ix, int iy, int iz, tissues_size
 		i = s.back();
 		s.pop_back();
 
-		work = m_ImageSlices[i.m_Pz].ReturnTissues(m_ActiveTissuelayer);
+		work = ImageSlice(i.m_Pz).ReturnTissues(m_ActiveTissuelayer);
 		if (i.m_Pxy % m_Width != 0 && work[i.m_Pxy - 1] == 0)
 		{
 			work[i.m_Pxy - 1] = set_to;
@@ -9405,7 +9902,7 @@ void SlicesHandler::AddSkintissue3DOutside2(int ix, int iy, int iz, tissues_size
 		}
 		if (i.m_Pz > m_Startslice)
 		{
-			work = m_ImageSlices[i.m_Pz - 1].ReturnTissues(m_ActiveTissuelayer);
+			work = ImageSlice(i.m_Pz - 1).ReturnTissues(m_ActiveTissuelayer);
 			if (work[i.m_Pxy] == 0)
 			{
 				work[i.m_Pxy] = set_to;
@@ -9416,7 +9913,7 @@ void SlicesHandler::AddSkintissue3DOutside2(int ix, int iy, int iz, tissues_size
 		}
 		if (i.m_Pz + 1 < m_Endslice)
 		{
-			work = m_ImageSlices[i.m_Pz + 1].ReturnTissues(m_ActiveTissuelayer);
+			work = ImageSlice(i.m_Pz + 1).ReturnTissues(m_ActiveTissuelayer);
 			if (work[i.m_Pxy] == 0)
 			{
 				work[i.m_Pxy] = set_to;
@@ -9435,10 +9932,10 @@ void SlicesHandler::AddSkintissue3DOutside2(int ix, int iy, int iz, tissues_size
 	Treap<Posit, unsigned int> treap1;
 	if (iz > 0)
 	{
-		for (unsigned short z = m_Startslice; z + 1 < m_Endslice; z++)
+		for (unsigned z = m_Startslice; z + 1 < m_Endslice; z++)
 		{
-			work1 = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
-			work2 = m_ImageSlices[z + 1].ReturnTissues(m_ActiveTissuelayer);
+			work1 = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
+			work2 = ImageSlice(z + 1).ReturnTissues(m_ActiveTissuelayer);
 			for (unsigned long i = 0; i < m_Area; i++)
 			{
 				if (work1[i] == set_to)
@@ -9490,14 +9987,14 @@ void SlicesHandler::AddSkintissue3DOutside2(int ix, int iy, int iz, tissues_size
 
 	if (ix > 0)
 	{
-		for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+		for (unsigned z = m_Startslice; z < m_Endslice; z++)
 		{
 			p1.m_Pz = z;
-			work1 = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
+			work1 = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
 			unsigned long i = 0;
-			for (unsigned short y = 0; y < m_Height; y++)
+			for (unsigned y = 0; y < m_Height; y++)
 			{
-				for (unsigned short x = 0; x + 1 < m_Width; x++)
+				for (unsigned x = 0; x + 1 < m_Width; x++)
 				{
 					if (work1[i] == set_to)
 					{
@@ -9549,14 +10046,14 @@ void SlicesHandler::AddSkintissue3DOutside2(int ix, int iy, int iz, tissues_size
 
 	if (iy > 0)
 	{
-		for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+		for (unsigned z = m_Startslice; z < m_Endslice; z++)
 		{
 			p1.m_Pz = z;
-			work1 = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
+			work1 = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
 			unsigned long i = 0;
-			for (unsigned short y = 0; y + 1 < m_Height; y++)
+			for (unsigned y = 0; y + 1 < m_Height; y++)
 			{
-				for (unsigned short x = 0; x < m_Width; x++)
+				for (unsigned x = 0; x < m_Width; x++)
 				{
 					if (work1[i] == set_to)
 					{
@@ -9612,7 +10109,7 @@ void SlicesHandler::AddSkintissue3DOutside2(int ix, int iy, int iz, tissues_size
 	{
 		p1 = n1->GetKey();
 		prior = n1->GetPriority();
-		work1 = m_ImageSlices[p1.m_Pz].ReturnTissues(m_ActiveTissuelayer);
+		work1 = ImageSlice(p1.m_Pz).ReturnTissues(m_ActiveTissuelayer);
 		work1[p1.m_Pxy] = f;
 		if (p1.m_Pxy % m_Width != 0)
 		{
@@ -9704,7 +10201,7 @@ void SlicesHandler::AddSkintissue3DOutside2(int ix, int iy, int iz, tissues_size
 		}
 		if (p1.m_Pz > m_Startslice)
 		{
-			work2 = m_ImageSlices[p1.m_Pz - 1].ReturnTissues(m_ActiveTissuelayer);
+			work2 = ImageSlice(p1.m_Pz - 1).ReturnTissues(m_ActiveTissuelayer);
 			if (work2[p1.m_Pxy] == set_to)
 			{
 				if (prior + subz <= totcount)
@@ -9727,7 +10224,7 @@ void SlicesHandler::AddSkintissue3DOutside2(int ix, int iy, int iz, tissues_size
 		}
 		if (p1.m_Pz + 1 < m_Endslice)
 		{
-			work2 = m_ImageSlices[p1.m_Pz + 1].ReturnTissues(m_ActiveTissuelayer);
+			work2 = ImageSlice(p1.m_Pz + 1).ReturnTissues(m_ActiveTissuelayer);
 			if (work2[p1.m_Pxy] == set_to)
 			{
 				if (prior + subz <= totcount)
@@ -9752,9 +10249,9 @@ void SlicesHandler::AddSkintissue3DOutside2(int ix, int iy, int iz, tissues_size
 		delete treap1.Remove(n1);
 	}
 
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		work = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
+		work = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
 		for (unsigned i1 = 0; i1 < m_Area; i1++)
 			if (work[i1] == set_to)
 				work[i1] = 0;
@@ -9774,9 +10271,9 @@ float SlicesHandler::AddSkin3D(int i1)
 	{
 		setto = p.low;
 
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
-			float* bits = m_ImageSlices[i].ReturnWork();
+			float* bits = ImageSlice(i).ReturnWork();
 			for (unsigned pos = 0; pos < m_Area; pos++)
 			{
 				if (bits[pos] != p.high)
@@ -9804,9 +10301,9 @@ float SlicesHandler::AddSkin3D(int ix, int iy, int iz)
 	{
 		setto = p.low;
 
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
-			float* bits = m_ImageSlices[i].ReturnWork();
+			float* bits = ImageSlice(i).ReturnWork();
 			for (unsigned pos = 0; pos < m_Area; pos++)
 			{
 				if (bits[pos] != p.high)
@@ -9835,9 +10332,9 @@ float SlicesHandler::AddSkin3DOutside(int i1)
 	{
 		setto = p.low;
 
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
-			float* bits = m_ImageSlices[i].ReturnWork();
+			float* bits = ImageSlice(i).ReturnWork();
 			for (unsigned pos = 0; pos < m_Area; pos++)
 			{
 				if (bits[pos] != p.high)
@@ -9865,9 +10362,9 @@ float SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz)
 	{
 		setto = p.low;
 
-		for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice; i < m_Endslice; i++)
 		{
-			float* bits = m_ImageSlices[i].ReturnWork();
+			float* bits = ImageSlice(i).ReturnWork();
 			for (unsigned pos = 0; pos < m_Area; pos++)
 			{
 				if (bits[pos] != p.high)
@@ -9885,9 +10382,9 @@ float SlicesHandler::AddSkin3DOutside2(int ix, int iy, int iz)
 void SlicesHandler::AddSkintissue3D(int ix, int iy, int iz, tissues_size_t f)
 {
 	tissues_size_t set_to = TISSUES_SIZE_MAX;
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		m_ImageSlices[z].FloodExteriortissue(m_ActiveTissuelayer, set_to);
+		ImageSlice(z).FloodExteriortissue(m_ActiveTissuelayer, set_to);
 	}
 
 	//Point p;
@@ -9900,10 +10397,10 @@ void SlicesHandler::AddSkintissue3D(int ix, int iy, int iz, tissues_size_t f)
 
 	tissues_size_t* tissue1;
 	tissues_size_t* tissue2;
-	for (unsigned short z = m_Startslice; z + 1 < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z + 1 < m_Endslice; z++)
 	{
-		tissue1 = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
-		tissue2 = m_ImageSlices[z + 1].ReturnTissues(m_ActiveTissuelayer);
+		tissue1 = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
+		tissue2 = ImageSlice(z + 1).ReturnTissues(m_ActiveTissuelayer);
 		for (unsigned long i = 0; i < m_Area; i++)
 		{
 			if (tissue1[i] == 0 && tissue2[i] == set_to)
@@ -9915,10 +10412,10 @@ void SlicesHandler::AddSkintissue3D(int ix, int iy, int iz, tissues_size_t f)
 			}
 		}
 	}
-	for (unsigned short z = m_Endslice - 1; z > m_Startslice; z--)
+	for (unsigned z = m_Endslice - 1; z > m_Startslice; z--)
 	{
-		tissue1 = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
-		tissue2 = m_ImageSlices[z - 1].ReturnTissues(m_ActiveTissuelayer);
+		tissue1 = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
+		tissue2 = ImageSlice(z - 1).ReturnTissues(m_ActiveTissuelayer);
 		for (unsigned long i = 0; i < m_Area; i++)
 		{
 			if (tissue1[i] == 0 && tissue2[i] == set_to)
@@ -9939,7 +10436,7 @@ void SlicesHandler::AddSkintissue3D(int ix, int iy, int iz, tissues_size_t f)
 		i = s.back();
 		s.pop_back();
 
-		tissue = m_ImageSlices[i.m_Pz].ReturnTissues(m_ActiveTissuelayer);
+		tissue = ImageSlice(i.m_Pz).ReturnTissues(m_ActiveTissuelayer);
 		if (i.m_Pxy % m_Width != 0 && tissue[i.m_Pxy - 1] == 0)
 		{
 			tissue[i.m_Pxy - 1] = set_to;
@@ -9970,7 +10467,7 @@ void SlicesHandler::AddSkintissue3D(int ix, int iy, int iz, tissues_size_t f)
 		}
 		if (i.m_Pz > m_Startslice)
 		{
-			tissue = m_ImageSlices[i.m_Pz - 1].ReturnTissues(m_ActiveTissuelayer);
+			tissue = ImageSlice(i.m_Pz - 1).ReturnTissues(m_ActiveTissuelayer);
 			if (tissue[i.m_Pxy] == 0)
 			{
 				tissue[i.m_Pxy] = set_to;
@@ -9981,7 +10478,7 @@ void SlicesHandler::AddSkintissue3D(int ix, int iy, int iz, tissues_size_t f)
 		}
 		if (i.m_Pz + 1 < m_Endslice)
 		{
-			tissue = m_ImageSlices[i.m_Pz + 1].ReturnTissues(m_ActiveTissuelayer);
+			tissue = ImageSlice(i.m_Pz + 1).ReturnTissues(m_ActiveTissuelayer);
 			if (tissue[i.m_Pxy] == 0)
 			{
 				tissue[i.m_Pxy] = set_to;
@@ -9992,12 +10489,12 @@ void SlicesHandler::AddSkintissue3D(int ix, int iy, int iz, tissues_size_t f)
 		}
 	}
 
-	unsigned short x, y;
+	unsigned x, y;
 	unsigned long pos;
-	unsigned short i1;
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	unsigned i1;
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		tissue = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
+		tissue = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
 
 		for (y = 0; y < m_Height; y++)
 		{
@@ -10109,9 +10606,9 @@ void SlicesHandler::AddSkintissue3D(int ix, int iy, int iz, tissues_size_t f)
 			(unsigned short*)malloc(sizeof(unsigned short) * m_Area);
 	for (unsigned i1 = 0; i1 < m_Area; i1++)
 		counter[i1] = 0;
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		tissue = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
+		tissue = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
 		for (pos = 0; pos < m_Area; pos++)
 		{
 			if (tissue[pos] == set_to)
@@ -10129,9 +10626,9 @@ void SlicesHandler::AddSkintissue3D(int ix, int iy, int iz, tissues_size_t f)
 	}
 	for (unsigned i1 = 0; i1 < m_Area; i1++)
 		counter[i1] = 0;
-	for (unsigned short z = m_Endslice - 1; z > m_Startslice; z--)
+	for (unsigned z = m_Endslice - 1; z > m_Startslice; z--)
 	{
-		tissue = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
+		tissue = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
 		for (pos = 0; pos < m_Area; pos++)
 		{
 			if (tissue[pos] == set_to)
@@ -10147,7 +10644,7 @@ void SlicesHandler::AddSkintissue3D(int ix, int iy, int iz, tissues_size_t f)
 			}
 		}
 	}
-	tissue = m_ImageSlices[m_Startslice].ReturnTissues(m_ActiveTissuelayer);
+	tissue = ImageSlice(m_Startslice).ReturnTissues(m_ActiveTissuelayer);
 	for (pos = 0; pos < m_Area; pos++)
 	{
 		if (tissue[pos] == set_to)
@@ -10164,9 +10661,9 @@ void SlicesHandler::AddSkintissue3D(int ix, int iy, int iz, tissues_size_t f)
 	}
 	free(counter);
 
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		tissue = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
+		tissue = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
 		for (unsigned i1 = 0; i1 < m_Area; i1++)
 			if (tissue[i1] == set_to)
 				tissue[i1] = 0;
@@ -10176,9 +10673,9 @@ void SlicesHandler::AddSkintissue3D(int ix, int iy, int iz, tissues_size_t f)
 void SlicesHandler::AddSkintissue3DOutside(int ixyz, tissues_size_t f)
 {
 	tissues_size_t set_to = TISSUES_SIZE_MAX;
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		m_ImageSlices[z].FloodExteriortissue(m_ActiveTissuelayer, set_to);
+		ImageSlice(z).FloodExteriortissue(m_ActiveTissuelayer, set_to);
 	}
 
 	//Point p;
@@ -10194,10 +10691,10 @@ void SlicesHandler::AddSkintissue3DOutside(int ixyz, tissues_size_t f)
 
 	tissues_size_t* tissue1;
 	tissues_size_t* tissue2;
-	for (unsigned short z = m_Startslice; z + 1 < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z + 1 < m_Endslice; z++)
 	{
-		tissue1 = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
-		tissue2 = m_ImageSlices[z + 1].ReturnTissues(m_ActiveTissuelayer);
+		tissue1 = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
+		tissue2 = ImageSlice(z + 1).ReturnTissues(m_ActiveTissuelayer);
 		for (unsigned long i = 0; i < m_Area; i++)
 		{
 			if (tissue1[i] == 0 && tissue2[i] == set_to)
@@ -10209,10 +10706,10 @@ void SlicesHandler::AddSkintissue3DOutside(int ixyz, tissues_size_t f)
 			}
 		}
 	}
-	for (unsigned short z = m_Endslice - 1; z > m_Startslice; z--)
+	for (unsigned z = m_Endslice - 1; z > m_Startslice; z--)
 	{
-		tissue1 = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
-		tissue2 = m_ImageSlices[z - 1].ReturnTissues(m_ActiveTissuelayer);
+		tissue1 = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
+		tissue2 = ImageSlice(z - 1).ReturnTissues(m_ActiveTissuelayer);
 		for (unsigned long i = 0; i < m_Area; i++)
 		{
 			if (tissue1[i] == 0 && tissue2[i] == set_to)
@@ -10233,7 +10730,7 @@ void SlicesHandler::AddSkintissue3DOutside(int ixyz, tissues_size_t f)
 		i = s.back();
 		s.pop_back();
 
-		tissue = m_ImageSlices[i.m_Pz].ReturnTissues(m_ActiveTissuelayer);
+		tissue = ImageSlice(i.m_Pz).ReturnTissues(m_ActiveTissuelayer);
 		if (i.m_Pxy % m_Width != 0 && tissue[i.m_Pxy - 1] == 0)
 		{
 			tissue[i.m_Pxy - 1] = set_to;
@@ -10264,7 +10761,7 @@ void SlicesHandler::AddSkintissue3DOutside(int ixyz, tissues_size_t f)
 		}
 		if (i.m_Pz > m_Startslice)
 		{
-			tissue = m_ImageSlices[i.m_Pz - 1].ReturnTissues(m_ActiveTissuelayer);
+			tissue = ImageSlice(i.m_Pz - 1).ReturnTissues(m_ActiveTissuelayer);
 			if (tissue[i.m_Pxy] == 0)
 			{
 				tissue[i.m_Pxy] = set_to;
@@ -10275,7 +10772,7 @@ void SlicesHandler::AddSkintissue3DOutside(int ixyz, tissues_size_t f)
 		}
 		if (i.m_Pz + 1 < m_Endslice)
 		{
-			tissue = m_ImageSlices[i.m_Pz + 1].ReturnTissues(m_ActiveTissuelayer);
+			tissue = ImageSlice(i.m_Pz + 1).ReturnTissues(m_ActiveTissuelayer);
 			if (tissue[i.m_Pxy] == 0)
 			{
 				tissue[i.m_Pxy] = set_to;
@@ -10286,10 +10783,10 @@ void SlicesHandler::AddSkintissue3DOutside(int ixyz, tissues_size_t f)
 		}
 	}
 
-	for (unsigned short z = m_Startslice; z + 1 < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z + 1 < m_Endslice; z++)
 	{
-		tissue1 = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
-		tissue2 = m_ImageSlices[z + 1].ReturnTissues(m_ActiveTissuelayer);
+		tissue1 = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
+		tissue2 = ImageSlice(z + 1).ReturnTissues(m_ActiveTissuelayer);
 		for (unsigned long i = 0; i < m_Area; i++)
 		{
 			if (tissue1[i] == set_to)
@@ -10313,13 +10810,13 @@ void SlicesHandler::AddSkintissue3DOutside(int ixyz, tissues_size_t f)
 		}
 	}
 
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		tissue1 = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
+		tissue1 = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
 		unsigned long i = 0;
-		for (unsigned short y = 0; y < m_Height; y++)
+		for (unsigned y = 0; y < m_Height; y++)
 		{
-			for (unsigned short x = 0; x + 1 < m_Width; x++)
+			for (unsigned x = 0; x + 1 < m_Width; x++)
 			{
 				if (tissue1[i] == set_to)
 				{
@@ -10344,9 +10841,9 @@ void SlicesHandler::AddSkintissue3DOutside(int ixyz, tissues_size_t f)
 			i++;
 		}
 		i = 0;
-		for (unsigned short y = 0; y + 1 < m_Height; y++)
+		for (unsigned y = 0; y + 1 < m_Height; y++)
 		{
-			for (unsigned short x = 0; x < m_Width; x++)
+			for (unsigned x = 0; x < m_Width; x++)
 			{
 				if (tissue1[i] == set_to)
 				{
@@ -10378,7 +10875,7 @@ void SlicesHandler::AddSkintissue3DOutside(int ixyz, tissues_size_t f)
 			i = (*s2).back();
 			(*s2).pop_back();
 
-			tissue = m_ImageSlices[i.m_Pz].ReturnTissues(m_ActiveTissuelayer);
+			tissue = ImageSlice(i.m_Pz).ReturnTissues(m_ActiveTissuelayer);
 			if (i.m_Pxy % m_Width != 0 && tissue[i.m_Pxy - 1] == set_to)
 			{
 				tissue[i.m_Pxy - 1] = f;
@@ -10410,7 +10907,7 @@ void SlicesHandler::AddSkintissue3DOutside(int ixyz, tissues_size_t f)
 			if (i.m_Pz > m_Startslice)
 			{
 				tissue =
-						m_ImageSlices[i.m_Pz - 1].ReturnTissues(m_ActiveTissuelayer);
+						ImageSlice(i.m_Pz - 1).ReturnTissues(m_ActiveTissuelayer);
 				if (tissue[i.m_Pxy] == set_to)
 				{
 					tissue[i.m_Pxy] = f;
@@ -10422,7 +10919,7 @@ void SlicesHandler::AddSkintissue3DOutside(int ixyz, tissues_size_t f)
 			if (i.m_Pz + 1 < m_Endslice)
 			{
 				tissue =
-						m_ImageSlices[i.m_Pz + 1].ReturnTissues(m_ActiveTissuelayer);
+						ImageSlice(i.m_Pz + 1).ReturnTissues(m_ActiveTissuelayer);
 				if (tissue[i.m_Pxy] == set_to)
 				{
 					tissue[i.m_Pxy] = f;
@@ -10442,9 +10939,9 @@ void SlicesHandler::AddSkintissue3DOutside(int ixyz, tissues_size_t f)
 		(*s2).pop_back();
 	}
 
-	for (unsigned short z = m_Startslice; z < m_Endslice; z++)
+	for (unsigned z = m_Startslice; z < m_Endslice; z++)
 	{
-		tissue = m_ImageSlices[z].ReturnTissues(m_ActiveTissuelayer);
+		tissue = ImageSlice(z).ReturnTissues(m_ActiveTissuelayer);
 		for (unsigned i1 = 0; i1 < m_Area; i1++)
 			if (tissue[i1] == set_to)
 				tissue[i1] = 0;
@@ -10508,7 +11005,7 @@ void SlicesHandler::FillSkin3d(int thicknessX, int thicknessY, int thicknessZ, t
 	//unsigned long skinPixels=0;
 	for (int i = 0; i < dims[2]; i++)
 	{
-		tissues_size_t* tissues_main = m_ImageSlices[i].ReturnTissues(0);
+		tissues_size_t* tissues_main = ImageSlice(i).ReturnTissues(0);
 		for (int j = 0; j < m_Area && (!there_is_bg || !there_is_skin); j++)
 		{
 			tissues_size_t value = tissues_main[j];
@@ -10531,22 +11028,22 @@ void SlicesHandler::FillSkin3d(int thicknessX, int thicknessY, int thicknessZ, t
 
 	std::vector<tissues_size_t*> tissues_vector;
 	for (int i = 0; i < m_ImageSlices.size(); i++)
-		tissues_vector.push_back(m_ImageSlices[i].ReturnTissues(0));
+		tissues_vector.push_back(ImageSlice(i).ReturnTissues(0));
 
 	for (int i = 0; i < dims[2]; i++)
 	{
-		float* bmp1 = m_ImageSlices[i].ReturnBmp();
+		float* bmp1 = ImageSlice(i).ReturnBmp();
 
-		tissues_size_t* tissue1 = m_ImageSlices[i].ReturnTissues(0);
-		m_ImageSlices[i].PushstackBmp();
+		tissues_size_t* tissue1 = ImageSlice(i).ReturnTissues(0);
+		ImageSlice(i).PushstackBmp();
 
 		for (unsigned int j = 0; j < m_Area; j++)
 		{
 			bmp1[j] = (float)tissue1[j];
 		}
 
-		m_ImageSlices[i].DeadReckoning((float)0);
-		bmp1 = m_ImageSlices[i].ReturnWork();
+		ImageSlice(i).DeadReckoning((float)0);
+		bmp1 = ImageSlice(i).ReturnWork();
 	}
 
 #ifdef NO_OPENMP_SUPPORT
@@ -10657,13 +11154,13 @@ void SlicesHandler::FillSkin3d(int thicknessX, int thicknessY, int thicknessZ, t
 			{
 				size_t slice = partial_changes_threads[i][j].m_SliceNumber;
 				int pos = partial_changes_threads[i][j].m_PositionConvert;
-				m_ImageSlices[slice].ReturnWork()[pos] = 255.0f;
+				ImageSlice(slice).ReturnWork()[pos] = 255.0f;
 			}
 		}
 	}
 	for (int i = dims[2] - 1; i >= 0; i--)
 	{
-		float* bmp1 = m_ImageSlices[i].ReturnBmp();
+		float* bmp1 = ImageSlice(i).ReturnBmp();
 
 		for (unsigned k = 0; k < m_Area; k++)
 		{
@@ -10674,29 +11171,29 @@ void SlicesHandler::FillSkin3d(int thicknessX, int thicknessY, int thicknessZ, t
 		}
 
 		m_ImageSlices[i].SetMode(2, false);
-		m_ImageSlices[i].PopstackBmp();
+		ImageSlice(i).PopstackBmp();
 	}
 
 	progress.setValue(num_tasks);
 }
 
-float SlicesHandler::CalculateVolume(Point p, unsigned short slicenr)
+float SlicesHandler::CalculateVolume(Point p, unsigned slicenr)
 {
 	Pair p1 = GetPixelsize();
 	unsigned long count = 0;
 	float f = GetWorkPt(p, slicenr);
-	for (unsigned short j = m_Startslice; j < m_Endslice; j++)
-		count += m_ImageSlices[j].ReturnWorkpixelcount(f);
+	for (unsigned j = m_Startslice; j < m_Endslice; j++)
+		count += ImageSlice(j).ReturnWorkpixelcount(f);
 	return GetSlicethickness() * p1.high * p1.low * count;
 }
 
-float SlicesHandler::CalculateTissuevolume(Point p, unsigned short slicenr)
+float SlicesHandler::CalculateTissuevolume(Point p, unsigned slicenr)
 {
 	Pair p1 = GetPixelsize();
 	unsigned long count = 0;
 	tissues_size_t c = GetTissuePt(p, slicenr);
-	for (unsigned short j = m_Startslice; j < m_Endslice; j++)
-		count += m_ImageSlices[j].ReturnTissuepixelcount(m_ActiveTissuelayer, c);
+	for (unsigned j = m_Startslice; j < m_Endslice; j++)
+		count += ImageSlice(j).ReturnTissuepixelcount(m_ActiveTissuelayer, c);
 	return GetSlicethickness() * p1.high * p1.low * count;
 }
 
@@ -10705,10 +11202,10 @@ void SlicesHandler::Inversesliceorder()
 	if (m_Nrslices > 0)
 	{
 		//		Bmphandler dummy;
-		unsigned short rcounter = m_Nrslices - 1;
-		for (unsigned short i = 0; i < m_Nrslices / 2; i++, rcounter--)
+		unsigned rcounter = m_Nrslices - 1;
+		for (unsigned i = 0; i < m_Nrslices / 2; i++, rcounter--)
 		{
-			m_ImageSlices[i].Swap(m_ImageSlices[rcounter]);
+			ImageSlice(i).Swap(ImageSlice(rcounter));
 			/*dummy=image_slices[i];
 			image_slices[i]=image_slices[rcounter];
 			image_slices[rcounter]=dummy;*/
@@ -10717,32 +11214,32 @@ void SlicesHandler::Inversesliceorder()
 	}
 }
 
-void SlicesHandler::GammaMhd(unsigned short slicenr, short nrtissues, short dim, std::vector<std::string> mhdfiles, float* weights, float** centers, float* tol_f, float* tol_d)
+void SlicesHandler::GammaMhd(unsigned slicenr, short nrtissues, short dim, std::vector<std::string> mhdfiles, float* weights, float** centers, float* tol_f, float* tol_d)
 {
 	if (mhdfiles.size() + 1 < dim)
 		return;
 	//	if(slicenr>=startslice&&slicenr<endslice){
 	float** bits = new float*[dim];
-	for (unsigned short j = 0; j + 1 < dim; j++)
+	for (unsigned j = 0; j + 1 < dim; j++)
 	{
 		bits[j + 1] = new float[m_Area];
 		if (bits[j + 1] == nullptr)
 		{
-			for (unsigned short i = 1; i < j; i++)
+			for (unsigned i = 1; i < j; i++)
 				delete[] bits[i];
 			delete[] bits;
 			return;
 		}
 	}
 
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
-		bits[0] = m_ImageSlices[i].ReturnBmp();
-		for (unsigned short k = 0; k + 1 < dim; k++)
+		bits[0] = ImageSlice(i).ReturnBmp();
+		for (unsigned k = 0; k + 1 < dim; k++)
 		{
 			if (!ImageReader::GetSlice(mhdfiles[k].c_str(), bits[k + 1], i, m_Width, m_Height))
 			{
-				for (unsigned short j = 1; j < dim; j++)
+				for (unsigned j = 1; j < dim; j++)
 					delete[] bits[j];
 				delete[] bits;
 				return;
@@ -10752,60 +11249,60 @@ void SlicesHandler::GammaMhd(unsigned short slicenr, short nrtissues, short dim,
 		Pair pair1 = GetPixelsize();
 		mdg.Init(m_Width, m_Height, nrtissues, dim, bits, weights, centers, tol_f, tol_d, pair1.high, pair1.low);
 		mdg.Execute();
-		mdg.ReturnImage(m_ImageSlices[i].ReturnWork());
+		mdg.ReturnImage(ImageSlice(i).ReturnWork());
 		m_ImageSlices[i].SetMode(2, false);
 	}
 
-	for (unsigned short j = 1; j < dim; j++)
+	for (unsigned j = 1; j < dim; j++)
 		delete[] bits[j];
 	delete[] bits;
 	//	}
 }
 
-void SlicesHandler::StepsmoothZ(unsigned short n)
+void SlicesHandler::StepsmoothZ(unsigned n)
 {
 	if (n > (m_Endslice - m_Startslice))
 		return;
 	SmoothSteps stepsm;
-	unsigned short linelength1 = m_Endslice - m_Startslice;
+	unsigned linelength1 = m_Endslice - m_Startslice;
 	tissues_size_t* line = new tissues_size_t[linelength1];
 	stepsm.Init(n, linelength1, TissueInfos::GetTissueCount() + 1);
 	for (unsigned long i = 0; i < m_Area; i++)
 	{
-		unsigned short k = 0;
-		for (unsigned short j = m_Startslice; j < m_Endslice; j++, k++)
+		unsigned k = 0;
+		for (unsigned j = m_Startslice; j < m_Endslice; j++, k++)
 		{
-			line[k] = (m_ImageSlices[j].ReturnTissues(m_ActiveTissuelayer))[i];
+			line[k] = (ImageSlice(j).ReturnTissues(m_ActiveTissuelayer))[i];
 		}
 		stepsm.Dostepsmooth(line);
 		k = 0;
-		for (unsigned short j = m_Startslice; j < m_Endslice; j++, k++)
+		for (unsigned j = m_Startslice; j < m_Endslice; j++, k++)
 		{
-			(m_ImageSlices[j].ReturnTissues(m_ActiveTissuelayer))[i] = line[k];
+			(ImageSlice(j).ReturnTissues(m_ActiveTissuelayer))[i] = line[k];
 		}
 	}
 	delete[] line;
 }
 
-void SlicesHandler::SmoothTissues(unsigned short n)
+void SlicesHandler::SmoothTissues(unsigned n)
 {
 	// TODO: Implement criterion: Cells must be contiguous to the center of the specified filter
-	std::map<tissues_size_t, unsigned short> tissuecount;
+	std::map<tissues_size_t, unsigned> tissuecount;
 	tissues_size_t* tissuesnew =
 			(tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area);
 	if (n % 2 == 0)
 		n++;
-	unsigned short filtersize = n * n;
-	n = (unsigned short)(0.5f * n);
+	unsigned filtersize = n * n;
+	n = (unsigned)(0.5f * n);
 
-	for (unsigned short j = m_Startslice; j < m_Endslice; j++)
+	for (unsigned j = m_Startslice; j < m_Endslice; j++)
 	{
-		m_ImageSlices[j].Copyfromtissue(m_ActiveTissuelayer, tissuesnew);
+		ImageSlice(j).Copyfromtissue(m_ActiveTissuelayer, tissuesnew);
 		tissues_size_t* tissuesold =
-				m_ImageSlices[j].ReturnTissues(m_ActiveTissuelayer);
-		for (unsigned short y = n; y < m_Height - n; y++)
+				ImageSlice(j).ReturnTissues(m_ActiveTissuelayer);
+		for (unsigned y = n; y < m_Height - n; y++)
 		{
-			for (unsigned short x = n; x < m_Width - n; x++)
+			for (unsigned x = n; x < m_Width - n; x++)
 			{
 				// Tissue count within filter size
 				tissuecount.clear();
@@ -10817,7 +11314,7 @@ void SlicesHandler::SmoothTissues(unsigned short n)
 								tissuesold[(y + i) * m_Width + (x + j)];
 						if (tissuecount.find(currtissue) == tissuecount.end())
 						{
-							tissuecount.insert(std::pair<tissues_size_t, unsigned short>(currtissue, 1));
+							tissuecount.insert(std::pair<tissues_size_t, unsigned>(currtissue, 1));
 						}
 						else
 						{
@@ -10828,8 +11325,8 @@ void SlicesHandler::SmoothTissues(unsigned short n)
 #if 0 // Majority                                                              \
 			// Find tissue with majority
 				tissues_size_t tissuemajor = tissuesold[y*width+x];
-				unsigned short tissuemajorcount = tissuecount[tissuemajor];
-				for (std::map<tissues_size_t, unsigned short>::iterator iter = tissuecount.begin();
+				unsigned tissuemajorcount = tissuecount[tissuemajor];
+				for (std::map<tissues_size_t, unsigned>::iterator iter = tissuecount.begin();
 					iter != tissuecount.end(); ++iter) {
 					if (iter->second > tissuemajorcount) {
 						tissuemajor = iter->first;
@@ -10838,11 +11335,11 @@ void SlicesHandler::SmoothTissues(unsigned short n)
 				}
 #else // Majority and half or more                                             \
 			// Find tissue covering at least half of the pixels
-				unsigned short halffiltersize =
-						(unsigned short)(0.5f * filtersize + 0.5f);
+				unsigned halffiltersize =
+						(unsigned)(0.5f * filtersize + 0.5f);
 				tissues_size_t tissuemajor = tissuesold[y * m_Width + x];
-				unsigned short tissuemajorcount = tissuecount[tissuemajor];
-				for (std::map<tissues_size_t, unsigned short>::iterator iter =
+				unsigned tissuemajorcount = tissuecount[tissuemajor];
+				for (std::map<tissues_size_t, unsigned>::iterator iter =
 								 tissuecount.begin();
 						 iter != tissuecount.end(); ++iter)
 				{
@@ -10858,13 +11355,13 @@ void SlicesHandler::SmoothTissues(unsigned short n)
 				tissuesnew[y * m_Width + x] = tissuemajor;
 			}
 		}
-		m_ImageSlices[j].Copy2tissue(m_ActiveTissuelayer, tissuesnew);
+		ImageSlice(j).Copy2tissue(m_ActiveTissuelayer, tissuesnew);
 	}
 
 	free(tissuesnew);
 }
 
-void SlicesHandler::Regrow(unsigned short sourceslicenr, unsigned short targetslicenr, int n)
+void SlicesHandler::Regrow(unsigned sourceslicenr, unsigned targetslicenr, int n)
 {
 	float* lbmap = (float*)malloc(sizeof(float) * m_Area);
 	for (unsigned i = 0; i < m_Area; i++)
@@ -10876,7 +11373,7 @@ void SlicesHandler::Regrow(unsigned short sourceslicenr, unsigned short targetsl
 	tissues_size_t* results2 =
 			(tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area);
 	tissues_size_t* tissues1 =
-			m_ImageSlices[sourceslicenr].ReturnTissues(m_ActiveTissuelayer);
+			ImageSlice(sourceslicenr).ReturnTissues(m_ActiveTissuelayer);
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
 		if (tissues1[i] == 0)
@@ -10892,9 +11389,9 @@ void SlicesHandler::Regrow(unsigned short sourceslicenr, unsigned short targetsl
 
 		int i1 = 0;
 
-		for (unsigned short i = 0; i < (m_Height - 1); i++)
+		for (unsigned i = 0; i < (m_Height - 1); i++)
 		{
-			for (unsigned short j = 0; j < m_Width; j++)
+			for (unsigned j = 0; j < m_Width; j++)
 			{
 				if (results2[i1] != results2[i1 + m_Width])
 					results1[i1] = results1[i1 + m_Width] = 0;
@@ -10905,9 +11402,9 @@ void SlicesHandler::Regrow(unsigned short sourceslicenr, unsigned short targetsl
 
 		i1 = 0;
 
-		for (unsigned short i = 0; i < m_Height; i++)
+		for (unsigned i = 0; i < m_Height; i++)
 		{
-			for (unsigned short j = 0; j < (m_Width - 1); j++)
+			for (unsigned j = 0; j < (m_Width - 1); j++)
 			{
 				if (results2[i1] != results2[i1 + 1])
 					results1[i1] = results1[i1 + 1] = 0;
@@ -10929,7 +11426,7 @@ void SlicesHandler::Regrow(unsigned short sourceslicenr, unsigned short targetsl
 	delete results2;
 
 	ImageForestingTransformRegionGrowing* if_trg =
-			m_ImageSlices[sourceslicenr].IfTrgInit(lbmap);
+			ImageSlice(sourceslicenr).IfTrgInit(lbmap);
 	float thresh = 0;
 
 	float* f2 = if_trg->ReturnPf();
@@ -10945,7 +11442,7 @@ void SlicesHandler::Regrow(unsigned short sourceslicenr, unsigned short targetsl
 
 	float* f1 = if_trg->ReturnLb();
 	tissues_size_t* tissue_bits =
-			m_ImageSlices[targetslicenr].ReturnTissues(m_ActiveTissuelayer);
+			ImageSlice(targetslicenr).ReturnTissues(m_ActiveTissuelayer);
 
 	for (unsigned i = 0; i < m_Area; i++)
 	{
@@ -10967,32 +11464,32 @@ bool SlicesHandler::Unwrap(float jumpratio, float shift)
 	GetBmprange(&p);
 	float range = p.high - p.low;
 	float jumpabs = jumpratio * range;
-	for (unsigned short i = m_Startslice; i < m_Endslice; i++)
+	for (unsigned i = m_Startslice; i < m_Endslice; i++)
 	{
 		if (i > m_Startslice)
 		{
-			if ((m_ImageSlices[i - 1]).ReturnBmp()[0] -
-							m_ImageSlices[i].ReturnBmp()[0] >
+			if ((ImageSlice(i - 1)).ReturnBmp()[0] -
+							ImageSlice(i).ReturnBmp()[0] >
 					jumpabs)
 				shift += range;
-			else if (m_ImageSlices[i].ReturnBmp()[0] -
-									 (m_ImageSlices[i - 1]).ReturnBmp()[0] >
+			else if (ImageSlice(i).ReturnBmp()[0] -
+									 (ImageSlice(i - 1)).ReturnBmp()[0] >
 							 jumpabs)
 				shift -= range;
 		}
-		ok &= m_ImageSlices[i].Unwrap(jumpratio, range, shift);
+		ok &= ImageSlice(i).Unwrap(jumpratio, range, shift);
 		;
 	}
 	if (m_Area > 0)
 	{
-		for (unsigned short i = m_Startslice + 1; i < m_Endslice; i++)
+		for (unsigned i = m_Startslice + 1; i < m_Endslice; i++)
 		{
-			if ((m_ImageSlices[i - 1]).ReturnWork()[m_Area - 1] -
-							m_ImageSlices[i].ReturnWork()[m_Area - 1] >
+			if ((ImageSlice(i - 1)).ReturnWork()[m_Area - 1] -
+							ImageSlice(i).ReturnWork()[m_Area - 1] >
 					jumpabs)
 				return false;
-			if (m_ImageSlices[i].ReturnWork()[m_Area - 1] -
-							(m_ImageSlices[i - 1]).ReturnWork()[m_Area - 1] >
+			if (ImageSlice(i).ReturnWork()[m_Area - 1] -
+							(ImageSlice(i - 1)).ReturnWork()[m_Area - 1] >
 					jumpabs)
 				return false;
 		}
@@ -11010,14 +11507,37 @@ void SlicesHandler::SetNumberOfUndoSteps(unsigned n)
 	this->m_UndoQueue.SetNrundo(n);
 }
 
-unsigned SlicesHandler::GetNumberOfUndoArrays()
+size_t SlicesHandler::GetUndoMemoryBudget() const
+{
+	return this->m_UndoQueue.MemoryBudget();
+}
+
+void SlicesHandler::SetUndoMemoryBudget(size_t bytes)
+{
+	this->m_UndoQueue.SetMemoryBudget(bytes);
+}
+
+bool SlicesHandler::GetUndoSpillToDisk() const
+{
+	return this->m_UndoQueue.SpillToDisk();
+}
+
+void SlicesHandler::SetUndoSpillToDisk(bool on)
 {
-	return this->m_UndoQueue.ReturnNrundoarraysmax();
+	this->m_UndoQueue.SetSpillToDisk(on);
+}
+
+size_t SlicesHandler::GetUndoMemoryUsage() const
+{
+	size_t bytes = this->m_UndoQueue.MemoryUsage();
+	if (m_Uelem != nullptr)
+		bytes += m_Uelem->MemoryUsage();
+	return bytes;
 }
 
-void SlicesHandler::SetNumberOfUndoArrays(unsigned n)
+size_t SlicesHandler::GetUndoDiskUsage() const
 {
-	this->m_UndoQueue.SetNrundoarraysmax(n);
+	return this->m_UndoQueue.DiskUsage();
 }
 
 std::vector<iseg::tissues_size_t> SlicesHandler::TissueSelection() const
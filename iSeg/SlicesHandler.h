@@ -16,6 +16,7 @@
 #include "Core/RGB.h"
 #include "Core/UndoElem.h"
 #include "Core/UndoQueue.h"
+#include "Core/VolumeRegion.h"
 
 // boost 1.48, Qt and [Parse error at "BOOST_JOIN"] error
 // https://bugreports.qt.io/browse/QTBUG-22829
@@ -24,9 +25,12 @@
 #endif
 #include <boost/variant.hpp>
 
+#include <array>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 class QString;
 class vtkImageData;
@@ -38,6 +42,8 @@ class TissueHiearchy;
 class ColorLookupTable;
 class Bmphandler;
 class ProgressInfo;
+class VolumeStorage;
+class SlicePageFile;
 
 class SlicesHandler : public SlicesHandlerInterface
 {
@@ -45,36 +51,37 @@ public:
 	SlicesHandler();
 	~SlicesHandler();
 
-	void Newbmp(unsigned short width1, unsigned short height1, unsigned short nrofslices, const std::function<void(float**)>& init_callback = std::function<void(float**)>());
+	void Newbmp(unsigned width1, unsigned height1, unsigned nrofslices, const std::function<void(float**)>& init_callback = std::function<void(float**)>());
 	void Freebmp();
 	void ClearBmp();
 	void ClearWork();
 	void ClearOverlay();
 	void NewOverlay();
-	void SetBmp(unsigned short slicenr, float* bits, unsigned char mode);
-	void SetWork(unsigned short slicenr, float* bits, unsigned char mode);
-	void SetTissue(unsigned short slicenr, tissues_size_t* bits);
-	void Copy2bmp(unsigned short slicenr, float* bits, unsigned char mode);
-	void Copy2work(unsigned short slicenr, float* bits, unsigned char mode);
-	void Copy2tissue(unsigned short slicenr, tissues_size_t* bits);
-	void Copyfrombmp(unsigned short slicenr, float* bits);
-	void Copyfromwork(unsigned short slicenr, float* bits);
-	void Copyfromtissue(unsigned short slicenr, tissues_size_t* bits);
+	void SetBmp(unsigned slicenr, float* bits, unsigned char mode);
+	void SetWork(unsigned slicenr, float* bits, unsigned char mode);
+	void SetTissue(unsigned slicenr, tissues_size_t* bits);
+	void Copy2bmp(unsigned slicenr, float* bits, unsigned char mode);
+	void Copy2work(unsigned slicenr, float* bits, unsigned char mode);
+	void Copy2tissue(unsigned slicenr, tissues_size_t* bits);
+	void Copyfrombmp(unsigned slicenr, float* bits);
+	void Copyfromwork(unsigned slicenr, float* bits);
+	void Copyfromtissue(unsigned slicenr, tissues_size_t* bits);
 #ifdef TISSUES_SIZE_TYPEDEF
-	void Copyfromtissue(unsigned short slicenr, unsigned char* bits);
+	void Copyfromtissue(unsigned slicenr, unsigned char* bits);
 #endif // TISSUES_SIZE_TYPEDEF
-	void Copyfromtissuepadded(unsigned short slicenr, tissues_size_t* bits, unsigned short padding);
+	void Copyfromtissuepadded(unsigned slicenr, tissues_size_t* bits, unsigned padding);
 	void SetRgbFactors(int redFactor, int greenFactor, int blueFactor);
 	int LoadDIBitmap(const std::vector<std::string>& filenames);
-	int LoadDIBitmap(const std::vector<std::string>& filenames, Point p, unsigned short dx, unsigned short dy);
+	int LoadDIBitmap(const std::vector<std::string>& filenames, Point p, unsigned dx, unsigned dy);
 	int LoadPng(const std::vector<std::string>& filenames);
-	int LoadPng(const std::vector<std::string>& filenames, Point p, unsigned short dx, unsigned short dy);
+	int LoadPng(const std::vector<std::string>& filenames, Point p, unsigned dx, unsigned dy);
 	int LoadDIJpg(const std::vector<std::string>& filenames);
-	int LoadDIJpg(const std::vector<std::string>& filenames, Point p, unsigned short dx, unsigned short dy);
+	int LoadDIJpg(const std::vector<std::string>& filenames, Point p, unsigned dx, unsigned dy);
 	int LoadDICOM(const std::vector<std::string>& lfilename); //Assumption Filenames: fnxxx.bmp xxx: 3 digit number
-	int LoadDICOM(const std::vector<std::string>& lfilename, Point p, unsigned short dx, unsigned short dy);
-	int ReadImage(const char* filename);
-	int ReadOverlay(const char* filename, unsigned short slicenr);
+	int LoadDICOM(const std::vector<std::string>& lfilename, Point p, unsigned dx, unsigned dy);
+	/// Reads the region of the image, by default the whole image
+	int ReadImage(const char* filename, const VolumeRegion& region = VolumeRegion());
+	int ReadOverlay(const char* filename, unsigned slicenr);
 	int ReadAvw(const char* filename);
 	int ReadRTdose(const char* filename);
 	bool LoadSurface(const std::string& filename, bool overwrite_working, bool intersect);
@@ -85,20 +92,31 @@ public:
 	bool ImportMarkers(const char* filename);
 
 	int LoadAllXdmf(const char* filename);
-	int LoadAllHDF(const char* filename);
+	/// Loads the region of the volume into the allocated slices, which must have the region's dimensions
+	int LoadAllHDF(const char* filename, const VolumeRegion& region = VolumeRegion());
 
 	void UpdateColorLookupTable(std::shared_ptr<ColorLookupTable> new_lut = nullptr);
 	std::shared_ptr<ColorLookupTable> GetColorLookupTable() { return m_ColorLookupTable; }
 
 	// Description: write project data into an Xdmf file
 	int SaveAllXdmf(const char* filename, int compression, bool save_work, bool naked);
-	bool SaveMarkersHDF(const char* filename, bool naked, unsigned short version);
-	int SaveMergeAllXdmf(const char* filename, std::vector<QString>& mergeImagefilenames, unsigned short nrslicesTotal, int compression);
-	int ReadRaw(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned short slicenr, unsigned short nrofslices);
-	int ReadRaw(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned short slicenr, unsigned short nrofslices, Point p, unsigned short dx, unsigned short dy);
-	int ReadRawFloat(const char* filename, short unsigned w, short unsigned h, unsigned short slicenr, unsigned short nrofslices);
-	int ReadRawFloat(const char* filename, short unsigned w, short unsigned h, unsigned short slicenr, unsigned short nrofslices, Point p, unsigned short dx, unsigned short dy);
-	int ReadRawOverlay(const char* filename, unsigned bitdepth, unsigned short slicenr);
+	bool SaveMarkersHDF(const char* filename, bool naked, unsigned version);
+	/// Without paging the project can be written from a snapshot of the slices, see StartBackgroundSave
+	bool CanSaveInBackground() const;
+	/// Write the project like SaveAllXdmf, but the volume is written on a worker thread from a copy-on-write snapshot
+	/// of the slices, which may be modified meanwhile. done(success) is called from the worker thread when the file
+	/// is written. Returns false if nothing was started, e.g. with paging.
+	bool StartBackgroundSave(const char* filename, int compression, bool save_work, ProgressInfo* progress, std::function<void(bool)> done);
+	/// True from StartBackgroundSave until FinishBackgroundSave, also when the worker has already finished
+	bool BackgroundSavePending() const { return m_BackgroundSave != nullptr; }
+	/// Wait for the background save and release its snapshot. Returns whether the last background save succeeded.
+	bool FinishBackgroundSave();
+	int SaveMergeAllXdmf(const char* filename, std::vector<QString>& mergeImagefilenames, unsigned nrslicesTotal, int compression);
+	int ReadRaw(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, unsigned nrofslices);
+	int ReadRaw(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, unsigned nrofslices, Point p, unsigned dx, unsigned dy);
+	int ReadRawFloat(const char* filename, unsigned w, unsigned h, unsigned slicenr, unsigned nrofslices);
+	int ReadRawFloat(const char* filename, unsigned w, unsigned h, unsigned slicenr, unsigned nrofslices, Point p, unsigned dx, unsigned dy);
+	int ReadRawOverlay(const char* filename, unsigned bitdepth, unsigned slicenr);
 	int SaveRawResized(const char* filename, int dxm, int dxp, int dym, int dyp, int dzm, int dzp, bool work);
 	int SaveTissuesRawResized(const char* filename, int dxm, int dxp, int dym, int dyp, int dzm, int dzp);
 	void SwapAffine(const std::vector<unsigned int>& order);
@@ -106,11 +124,11 @@ public:
 	bool SwapYZ();
 	bool SwapXZ();
 	int SaveRawXySwapped(const char* filename, bool work);
-	static int SaveRawXySwapped(const char* filename, std::vector<float*> bits_to_swap, short unsigned width, short unsigned height, short unsigned nrslices);
+	static int SaveRawXySwapped(const char* filename, std::vector<float*> bits_to_swap, unsigned width, unsigned height, unsigned nrslices);
 	int SaveRawXzSwapped(const char* filename, bool work);
-	static int SaveRawXzSwapped(const char* filename, std::vector<float*> bits_to_swap, short unsigned width, short unsigned height, short unsigned nrslices);
+	static int SaveRawXzSwapped(const char* filename, std::vector<float*> bits_to_swap, unsigned width, unsigned height, unsigned nrslices);
 	int SaveRawYzSwapped(const char* filename, bool work);
-	static int SaveRawYzSwapped(const char* filename, std::vector<float*> bits_to_swap, short unsigned width, short unsigned height, short unsigned nrslices);
+	static int SaveRawYzSwapped(const char* filename, std::vector<float*> bits_to_swap, unsigned width, unsigned height, unsigned nrslices);
 	int SaveTissuesRaw(const char* filename);
 	int SaveTissuesRawXySwapped(const char* filename);
 	int SaveTissuesRawXzSwapped(const char* filename);
@@ -119,24 +137,30 @@ public:
 	int ReloadDIBitmap(const std::vector<std::string>& filenames, Point p);
 	int ReloadDICOM(const std::vector<std::string>& lfilename);
 	int ReloadDICOM(const std::vector<std::string>& lfilename, Point p);
-	int ReloadRaw(const char* filename, unsigned bitdepth, unsigned short slicenr);
-	int ReloadRaw(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned short slicenr, Point p);
-	int ReloadRawFloat(const char* filename, unsigned short slicenr);
-	int ReloadRawFloat(const char* filename, short unsigned w, short unsigned h, unsigned short slicenr, Point p);
-	static std::vector<float*> LoadRawFloat(const char* filename, unsigned short startslice, unsigned short endslice, unsigned short slicenr, unsigned int area);
-	int ReloadRawTissues(const char* filename, unsigned bitdepth, unsigned short slicenr);
-	int ReloadRawTissues(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned short slicenr, Point p);
-	int ReloadImage(const char* filename, unsigned short slicenr);
-	int ReloadRTdose(const char* filename, unsigned short slicenr);
-	int ReloadAVW(const char* filename, unsigned short slicenr);
-	FILE* SaveHeader(FILE* fp, short unsigned nr_slices_to_write, Transform transform_to_write);
-	FILE* SaveProject(const char* filename, const char* imageFileExtension);
+	int ReloadRaw(const char* filename, unsigned bitdepth, unsigned slicenr);
+	int ReloadRaw(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, Point p);
+	int ReloadRawFloat(const char* filename, unsigned slicenr);
+	int ReloadRawFloat(const char* filename, unsigned w, unsigned h, unsigned slicenr, Point p);
+	static std::vector<float*> LoadRawFloat(const char* filename, unsigned startslice, unsigned endslice, unsigned slicenr, unsigned int area);
+	int ReloadRawTissues(const char* filename, unsigned bitdepth, unsigned slicenr);
+	int ReloadRawTissues(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, Point p);
+	int ReloadImage(const char* filename, unsigned slicenr);
+	int ReloadRTdose(const char* filename, unsigned slicenr);
+	int ReloadAVW(const char* filename, unsigned slicenr);
+	FILE* SaveHeader(FILE* fp, unsigned nr_slices_to_write, Transform transform_to_write);
+	/// With done, the slices are written on a worker thread if possible (see StartBackgroundSave), i.e. after
+	/// this returns only while BackgroundSavePending, otherwise right away.
+	FILE* SaveProject(const char* filename, const char* imageFileExtension, ProgressInfo* progress = nullptr, std::function<void(bool)> done = nullptr);
 	bool SaveCommunicationFile(const char* filename);
 	FILE* SaveActiveSlices(const char* filename, const char* imageFileExtension);
 	void LoadHeader(FILE* fp, int& tissuesVersion, int& version);
 	FILE* MergeProjects(const char* savefilename, std::vector<QString>& mergeFilenames);
 	FILE* LoadProject(const char* filename, int& tissuesVersion);
-	bool LoadS4Llink(const char* filename, int& tissuesVersion);
+	/// Allocates and loads the region of the volume, e.g. a range of slices or a downsampled copy
+	bool LoadS4Llink(const char* filename, int& tissuesVersion, const VolumeRegion& region = VolumeRegion());
+	/// Replaces the volume by a downsampled level of the preview stored with the project, i.e. 2^level coarser
+	/// along each axis, with an empty target. Returns false if the project has no preview.
+	bool LoadPreview(const char* filename, int level);
 	int SaveBmpRaw(const char* filename);
 	int SaveWorkRaw(const char* filename);
 	int SaveTissueRaw(const char* filename);
@@ -164,6 +188,8 @@ public:
 	std::vector<float*> TargetSlices() override;
 	std::vector<const tissues_size_t*> TissueSlices(tissuelayers_size_t layeridx) const override;
 	std::vector<tissues_size_t*> TissueSlices(tissuelayers_size_t layeridx) override;
+	void PinTissues() override;
+	void UnpinTissues() override;
 
 	std::vector<std::string> TissueNames() const override;
 	std::vector<bool> TissueLocks() const override;
@@ -178,25 +204,25 @@ public:
 
 	void SetTargetFixedRange(bool on) override { SetModeall(on ? 2 : 1, false); }
 
-	float* ReturnBmp(unsigned short slicenr1);
-	float* ReturnWork(unsigned short slicenr1);
-	tissues_size_t* ReturnTissues(tissuelayers_size_t layeridx, unsigned short slicenr1);
+	float* ReturnBmp(unsigned slicenr1);
+	float* ReturnWork(unsigned slicenr1);
+	tissues_size_t* ReturnTissues(tissuelayers_size_t layeridx, unsigned slicenr1);
 	float* ReturnOverlay();
-	float GetWorkPt(Point p, unsigned short slicenr);
-	void SetWorkPt(Point p, unsigned short slicenr, float f);
-	float GetBmpPt(Point p, unsigned short slicenr);
-	void SetBmpPt(Point p, unsigned short slicenr, float f);
-	tissues_size_t GetTissuePt(Point p, unsigned short slicenr);
-	void SetTissuePt(Point p, unsigned short slicenr, tissues_size_t f);
+	float GetWorkPt(Point p, unsigned slicenr);
+	void SetWorkPt(Point p, unsigned slicenr, float f);
+	float GetBmpPt(Point p, unsigned slicenr);
+	void SetBmpPt(Point p, unsigned slicenr, float f);
+	tissues_size_t GetTissuePt(Point p, unsigned slicenr);
+	void SetTissuePt(Point p, unsigned slicenr, tissues_size_t f);
 	unsigned int MakeHistogram(bool includeoutofrange);
 	unsigned int ReturnArea();
-	unsigned short Width() const override;
-	unsigned short Height() const override;
-	unsigned short NumSlices() const override;
-	unsigned short StartSlice() const override;
-	unsigned short EndSlice() const override;
-	void SetStartslice(unsigned short startslice1);
-	void SetEndslice(unsigned short endslice1);
+	unsigned Width() const override;
+	unsigned Height() const override;
+	unsigned NumSlices() const override;
+	unsigned StartSlice() const override;
+	unsigned EndSlice() const override;
+	void SetStartslice(unsigned startslice1);
+	void SetEndslice(unsigned endslice1);
 	bool Isloaded() const;
 	void Threshold(float* thresholds);
 	void BmpSum();
@@ -211,60 +237,60 @@ public:
 	void CropColors();
 	void GetRange(Pair* pp);
 	void ComputeRangeMode1(Pair* pp);
-	void ComputeRangeMode1(unsigned short updateSlicenr, Pair* pp);
+	void ComputeRangeMode1(unsigned updateSlicenr, Pair* pp);
 	void GetBmprange(Pair* pp);
 	void ComputeBmprangeMode1(Pair* pp);
-	void ComputeBmprangeMode1(unsigned short updateSlicenr, Pair* pp);
+	void ComputeBmprangeMode1(unsigned updateSlicenr, Pair* pp);
 	void GetRangetissue(tissues_size_t* pp);
 	void Gaussian(float sigma);
-	void Average(unsigned short n);
+	void Average(unsigned n);
 	void MedianInterquartile(bool median);
 	void AnisoDiff(float dt, int n, float (*f)(float, float), float k, float restraint);
 	void ContAnisodiff(float dt, int n, float (*f)(float, float), float k, float restraint);
-	void StepsmoothZ(unsigned short n);
-	void SmoothTissues(unsigned short n);
-	void Sigmafilter(float sigma, unsigned short nx, unsigned short ny);
-	void Hysteretic(float thresh_low, float thresh_high, bool connectivity, unsigned short nrpasses);
-	void DoubleHysteretic(float thresh_low_l, float thresh_low_h, float thresh_high_l, float thresh_high_h, bool connectivity, unsigned short nrpasses);
+	void StepsmoothZ(unsigned n);
+	void SmoothTissues(unsigned n);
+	void Sigmafilter(float sigma, unsigned nx, unsigned ny);
+	void Hysteretic(float thresh_low, float thresh_high, bool connectivity, unsigned nrpasses);
+	void DoubleHysteretic(float thresh_low_l, float thresh_low_h, float thresh_high_l, float thresh_high_h, bool connectivity, unsigned nrpasses);
 	void DoubleHystereticAllslices(float thresh_low_l, float thresh_low_h, float thresh_high_l, float thresh_high_h, bool connectivity, float set_to);
-	void ThresholdedGrowing(short unsigned slicenr, Point p, float threshfactor_low, float threshfactor_high, bool connectivity, unsigned short nrpasses);
-	void ThresholdedGrowing(short unsigned slicenr, Point p, float thresh_low, float thresh_high, float set_to); //bool connectivity,float set_to);
+	void ThresholdedGrowing(unsigned slicenr, Point p, float threshfactor_low, float threshfactor_high, bool connectivity, unsigned nrpasses);
+	void ThresholdedGrowing(unsigned slicenr, Point p, float thresh_low, float thresh_high, float set_to); //bool connectivity,float set_to);
 	void AddMark(Point p, unsigned label, std::string str = "");
-	void AddMark(Point p, unsigned label, unsigned short slicenr, std::string str = "");
+	void AddMark(Point p, unsigned label, unsigned slicenr, std::string str = "");
 	bool RemoveMark(Point p, unsigned radius);
-	bool RemoveMark(Point p, unsigned radius, unsigned short slicenr);
+	bool RemoveMark(Point p, unsigned radius, unsigned slicenr);
 	void ClearMarks();
 	void GetLabels(std::vector<AugmentedMark>* labels);
 	void AddVm(std::vector<Mark>* vm1);
 	bool RemoveVm(Point p, unsigned radius);
-	void AddVm(std::vector<Mark>* vm1, unsigned short slicenr);
-	bool RemoveVm(Point p, unsigned radius, unsigned short slicenr);
+	void AddVm(std::vector<Mark>* vm1, unsigned slicenr);
+	bool RemoveVm(Point p, unsigned radius, unsigned slicenr);
 	void AddLimit(std::vector<Point>* vp1);
 	bool RemoveLimit(Point p, unsigned radius);
-	void AddLimit(std::vector<Point>* vp1, unsigned short slicenr);
-	bool RemoveLimit(Point p, unsigned radius, unsigned short slicenr);
+	void AddLimit(std::vector<Point>* vp1, unsigned slicenr);
+	bool RemoveLimit(Point p, unsigned radius, unsigned slicenr);
 	void ZeroCrossings(bool connectivity);
 	void DougpeuckLine(float epsilon);
-	void Kmeans(unsigned short slicenr, short nrtissues, unsigned int iternr, unsigned int converge);
-	void KmeansMhd(unsigned short slicenr, short nrtissues, short dim, std::vector<std::string> mhdfiles, float* weights, unsigned int iternr, unsigned int converge);
-	void KmeansPng(unsigned short slicenr, short nrtissues, short dim, std::vector<std::string> pngfiles, std::vector<int> exctractChannel, float* weights, unsigned int iternr, unsigned int converge, const std::string initCentersFile = "");
-	void Em(unsigned short slicenr, short nrtissues, unsigned int iternr, unsigned int converge);
+	void Kmeans(unsigned slicenr, short nrtissues, unsigned int iternr, unsigned int converge);
+	void KmeansMhd(unsigned slicenr, short nrtissues, short dim, std::vector<std::string> mhdfiles, float* weights, unsigned int iternr, unsigned int converge);
+	void KmeansPng(unsigned slicenr, short nrtissues, short dim, std::vector<std::string> pngfiles, std::vector<int> exctractChannel, float* weights, unsigned int iternr, unsigned int converge, const std::string initCentersFile = "");
+	void Em(unsigned slicenr, short nrtissues, unsigned int iternr, unsigned int converge);
 	void ExtractContours(int minsize, std::vector<tissues_size_t>& tissuevec);
 	void ExtractContours2Xmirrored(int minsize, std::vector<tissues_size_t>& tissuevec);
 	void ExtractContours2Xmirrored(int minsize, std::vector<tissues_size_t>& tissuevec, float epsilon);
-	void ExtractinterpolatesaveContours(int minsize, std::vector<tissues_size_t>& tissuevec, unsigned short between, bool dp, float epsilon, const char* filename);
-	void ExtractinterpolatesaveContours2Xmirrored(int minsize, std::vector<tissues_size_t>& tissuevec, unsigned short between, bool dp, float epsilon, const char* filename);
+	void ExtractinterpolatesaveContours(int minsize, std::vector<tissues_size_t>& tissuevec, unsigned between, bool dp, float epsilon, const char* filename);
+	void ExtractinterpolatesaveContours2Xmirrored(int minsize, std::vector<tissues_size_t>& tissuevec, unsigned between, bool dp, float epsilon, const char* filename);
 	void Add2tissue(tissues_size_t tissuetype, Point p, bool override);
 	void Add2tissueall(tissues_size_t tissuetype, Point p, bool override);
-	void Add2tissueall(tissues_size_t tissuetype, Point p, unsigned short slicenr, bool override);
+	void Add2tissueall(tissues_size_t tissuetype, Point p, unsigned slicenr, bool override);
 	void Add2tissueall(tissues_size_t tissuetype, float f, bool override);
 	void Add2tissueConnected(tissues_size_t tissuetype, Point p, bool override);
 	void Add2tissueallConnected(tissues_size_t tissuetype, Point p, bool override);
 	void Add2tissueThresh(tissues_size_t tissuetype, Point p);
-	void Add2tissue(tissues_size_t tissuetype, bool* mask, unsigned short slicenr, bool override);
+	void Add2tissue(tissues_size_t tissuetype, bool* mask, unsigned slicenr, bool override);
 	void SubtractTissue(tissues_size_t tissuetype, Point p);
 	void SubtractTissueall(tissues_size_t tissuetype, Point p);
-	void SubtractTissueall(tissues_size_t tissuetype, Point p, unsigned short slicenr);
+	void SubtractTissueall(tissues_size_t tissuetype, Point p, unsigned slicenr);
 	void SubtractTissueall(tissues_size_t tissuetype, float f);
 	void SubtractTissueConnected(tissues_size_t tissuetype, Point p);
 	void SubtractTissueallConnected(tissues_size_t tissuetype, Point p);
@@ -276,18 +302,18 @@ public:
 	void Cleartissue3D(tissues_size_t tissuetype);
 	void Cleartissues();
 	void Cleartissues3D();
-	void Interpolatetissue(unsigned short slice1, unsigned short slice2, tissues_size_t tissuetype, bool connected);
-	void InterpolatetissueMedianset(unsigned short slice1, unsigned short slice2, tissues_size_t tissuetype, bool connectivity, bool handleVanishingComp = true);
-	void Extrapolatetissue(unsigned short origin1, unsigned short origin2, unsigned short target, tissues_size_t tissuetype);
-	void Interpolatework(unsigned short slice1, unsigned short slice2);
-	void Extrapolatework(unsigned short origin1, unsigned short origin2, unsigned short target);
-	void Interpolatetissuegrey(unsigned short slice1, unsigned short slice2);
-	void InterpolatetissuegreyMedianset(unsigned short slice1, unsigned short slice2, bool connectivity, bool handleVanishingComp = true);
-	void Interpolateworkgrey(unsigned short slice1, unsigned short slice2, bool connected);
-	void InterpolateworkgreyMedianset(unsigned short slice1, unsigned short slice2, bool connectivity, bool handleVanishingComp = true);
-	void Interpolate(unsigned short slice1, unsigned short slice2);
-	void Extrapolate(unsigned short origin1, unsigned short origin2, unsigned short target);
-	void Interpolate(unsigned short slice1, unsigned short slice2, float* bmp1, float* bmp2);
+	void Interpolatetissue(unsigned slice1, unsigned slice2, tissues_size_t tissuetype, bool connected);
+	void InterpolatetissueMedianset(unsigned slice1, unsigned slice2, tissues_size_t tissuetype, bool connectivity, bool handleVanishingComp = true);
+	void Extrapolatetissue(unsigned origin1, unsigned origin2, unsigned target, tissues_size_t tissuetype);
+	void Interpolatework(unsigned slice1, unsigned slice2);
+	void Extrapolatework(unsigned origin1, unsigned origin2, unsigned target);
+	void Interpolatetissuegrey(unsigned slice1, unsigned slice2);
+	void InterpolatetissuegreyMedianset(unsigned slice1, unsigned slice2, bool connectivity, bool handleVanishingComp = true);
+	void Interpolateworkgrey(unsigned slice1, unsigned slice2, bool connected);
+	void InterpolateworkgreyMedianset(unsigned slice1, unsigned slice2, bool connectivity, bool handleVanishingComp = true);
+	void Interpolate(unsigned slice1, unsigned slice2);
+	void Extrapolate(unsigned origin1, unsigned origin2, unsigned target);
+	void Interpolate(unsigned slice1, unsigned slice2, float* bmp1, float* bmp2);
 
 	bool ComputeTargetConnectivity(ProgressInfo* progress = nullptr);
 	bool ComputeSplitTissues(tissues_size_t tissue, ProgressInfo* progress = nullptr);
@@ -296,28 +322,28 @@ public:
 	float GetSlicethickness() const;
 	void SetPixelsize(float dx1, float dy1);
 	Pair GetPixelsize() const;
-	void SlicebmpX(float* return_bits, unsigned short xcoord);
-	float* SlicebmpX(unsigned short xcoord);
-	void SlicebmpY(float* return_bits, unsigned short ycoord);
-	float* SlicebmpY(unsigned short ycoord);
-	void SliceworkX(float* return_bits, unsigned short xcoord);
-	float* SliceworkX(unsigned short xcoord);
-	void SliceworkY(float* return_bits, unsigned short ycoord);
-	float* SliceworkY(unsigned short ycoord);
-	void SlicetissueX(tissues_size_t* return_bits, unsigned short xcoord);
-	tissues_size_t* SlicetissueX(unsigned short xcoord);
-	void SlicetissueY(tissues_size_t* return_bits, unsigned short ycoord);
-	tissues_size_t* SlicetissueY(unsigned short ycoord);
-	void SliceworkZ(unsigned short slicenr);
+	void SlicebmpX(float* return_bits, unsigned xcoord);
+	float* SlicebmpX(unsigned xcoord);
+	void SlicebmpY(float* return_bits, unsigned ycoord);
+	float* SlicebmpY(unsigned ycoord);
+	void SliceworkX(float* return_bits, unsigned xcoord);
+	float* SliceworkX(unsigned xcoord);
+	void SliceworkY(float* return_bits, unsigned ycoord);
+	float* SliceworkY(unsigned ycoord);
+	void SlicetissueX(tissues_size_t* return_bits, unsigned xcoord);
+	tissues_size_t* SlicetissueX(unsigned xcoord);
+	void SlicetissueY(tissues_size_t* return_bits, unsigned ycoord);
+	tissues_size_t* SlicetissueY(unsigned ycoord);
+	void SliceworkZ(unsigned slicenr);
 	int ExtractTissueSurfaces(const std::string& filename, std::vector<tissues_size_t>& tissuevec, bool usediscretemc = false, float ratio = 1.0f, unsigned smoothingiterations = 15, float passBand = 0.1f, float featureAngle = 180);
 	void NextSlice();
 	void PrevSlice();
-	unsigned short GetNextFeaturingSlice(tissues_size_t type, bool& found);
+	unsigned GetNextFeaturingSlice(tissues_size_t type, bool& found);
 
-	unsigned short ActiveSlice() const override;
-	boost::signals2::signal<void(unsigned short)> m_OnActiveSliceChanged;
+	unsigned ActiveSlice() const override;
+	boost::signals2::signal<void(unsigned)> m_OnActiveSliceChanged;
 	boost::signals2::signal<void(bool)> m_OnVolumeChanged;
-	void SetActiveSlice(unsigned short slice, bool signal_change = false) override;
+	void SetActiveSlice(unsigned slice, bool signal_change = false) override;
 	void SignalVolumeChange(bool update_tissues) override { m_OnVolumeChanged(update_tissues); }
 
 	Bmphandler* GetActivebmphandler();
@@ -329,10 +355,14 @@ public:
 	unsigned PushstackWork(unsigned int slice);
 	unsigned PushstackTissue(tissues_size_t i);
 	unsigned PushstackTissue(tissues_size_t i, unsigned int slice);
+	/// Push the slices [startslice, endslice] as one stack entry, returns the id of startslice, the others follow consecutively
+	unsigned PushstackBmp(unsigned startslice, unsigned endslice);
+	unsigned PushstackWork(unsigned startslice, unsigned endslice);
+	unsigned PushstackTissue(tissues_size_t i, unsigned startslice, unsigned endslice);
 	unsigned PushstackHelp();
 	void Removestack(unsigned i);
 	void ClearStack();
-	float* Getstack(unsigned i, unsigned char& mode);
+	bool Getstack(unsigned i, float* bits, unsigned char& mode);
 	void GetstackBmp(unsigned i);
 	void GetstackBmp(unsigned int slice, unsigned i);
 	void GetstackWork(unsigned i);
@@ -368,7 +398,7 @@ public:
 	bool ValueAtBoundary3D(float value);
 	bool TissuevalueAtBoundary3D(tissues_size_t value);
 	void FillSkin3d(int thicknessX, int thicknessY, int thicknessZ, tissues_size_t backgroundID, tissues_size_t skinID);
-	void GammaMhd(unsigned short slicenr, short nrtissues, short dim, std::vector<std::string> mhdfiles, float* weights, float** centers, float* tol_f, float* tol_d);
+	void GammaMhd(unsigned slicenr, short nrtissues, short dim, std::vector<std::string> mhdfiles, float* weights, float** centers, float* tol_f, float* tol_d);
 	void FillUnassigned();
 	void FillUnassignedtissue(tissues_size_t f);
 	void StartUndo(DataSelection& dataSelection);
@@ -385,10 +415,8 @@ public:
 	unsigned ReturnNrredo();
 	bool ReturnUndo3D() const;
 	unsigned ReturnNrundosteps();
-	unsigned ReturnNrundoarrays();
 	void SetUndo3D(bool undo3D1);
 	void SetUndonr(unsigned nr);
-	void SetUndoarraynr(unsigned nr);
 	void MaskSource(bool all_slices, float maskvalue);
 	void MapTissueIndices(const std::vector<tissues_size_t>& indexMap);
 	void RemoveTissue(tissues_size_t tissuenr);
@@ -401,9 +429,11 @@ public:
 	void GetDICOMseriesnr(std::vector<std::string>* vnames, std::vector<unsigned>* dicomseriesnr, std::vector<unsigned>* dicomseriesnrlist);
 	void SetModeall(unsigned char mode, bool bmporwork);
 	bool PrintAmascii(const char* filename);
-	bool PrintTissuemat(const char* filename);
-	bool PrintBmpmat(const char* filename);
-	bool PrintWorkmat(const char* filename);
+	/// Writes the active tissue layer as binary AmiraMesh, VTK (.vtk) or VTK XML (.vti) file, see LabelFieldWriter
+	bool ExportLabelField(const char* filename, bool ascii = false, ProgressInfo* progress = nullptr);
+	bool PrintTissuemat(const char* filename, ProgressInfo* progress = nullptr);
+	bool PrintBmpmat(const char* filename, ProgressInfo* progress = nullptr);
+	bool PrintWorkmat(const char* filename, ProgressInfo* progress = nullptr);
 
 	bool ExportTissue(const char* filename, bool binary) const;
 	bool ExportBmp(const char* filename, bool binary) const;
@@ -413,8 +443,8 @@ public:
 	bool PrintTissueindex(const char* filename, bool onlyactiveslices, const char* projname = nullptr);
 	bool PrintAtlas(const char* filename);
 	vtkImageData* MakeVtktissueimage();
-	float CalculateVolume(Point p, unsigned short slicenr);
-	float CalculateTissuevolume(Point p, unsigned short slicenr);
+	float CalculateVolume(Point p, unsigned slicenr);
+	float CalculateTissuevolume(Point p, unsigned slicenr);
 	void Inversesliceorder();
 
 	Vec3 Spacing() const override;
@@ -427,19 +457,47 @@ public:
 	void GetDirectionCosines(float dc[6]) const;
 	void SetDirectionCosines(const float dc[6]);
 
-	bool GetExtent(tissues_size_t tissuenr, bool onlyactiveslices, unsigned short extent[3][2]);
-	void Regrow(unsigned short sourceslicenr, unsigned short targetslicenr, int n);
+	bool GetExtent(tissues_size_t tissuenr, bool onlyactiveslices, unsigned extent[3][2]);
+	void Regrow(unsigned sourceslicenr, unsigned targetslicenr, int n);
 	bool Unwrap(float jumpratio, float shift = 0);
 	unsigned GetNumberOfUndoSteps();
 	void SetNumberOfUndoSteps(unsigned);
-	unsigned GetNumberOfUndoArrays();
-	void SetNumberOfUndoArrays(unsigned);
+	// Description: keep at most this many bytes of undo data in memory, 0 means no limit
+	size_t GetUndoMemoryBudget() const;
+	void SetUndoMemoryBudget(size_t bytes);
+	// Description: move the oldest undo steps to a temporary file instead of discarding them when the budget is exceeded
+	bool GetUndoSpillToDisk() const;
+	void SetUndoSpillToDisk(bool on);
+	size_t GetUndoMemoryUsage() const;
+	size_t GetUndoDiskUsage() const;
 	int GetCompression() const { return this->m_Hdf5Compression; }
 	void SetCompression(int c) { this->m_Hdf5Compression = c; }
 	bool GetContiguousMemory() const { return m_ContiguousMemoryIo; }
 	void SetContiguousMemory(bool v) { m_ContiguousMemoryIo = v; }
 	bool SaveTarget() const { return m_SaveTarget; }
 	void SetSaveTarget(bool v) { m_SaveTarget = v; }
+	// Description: keep source, target and tissues in contiguous (aligned) volume buffers
+	bool GetContiguousStorage() const { return m_UseVolumeStorage; }
+	void SetContiguousStorage(bool v);
+	// Description: keep the tissue layers of slices, which are not being edited, compressed in memory
+	bool GetCompressedTissues() const { return m_CompressTissues; }
+	void SetCompressedTissues(bool v);
+	/// Compress the tissue layers of all slices except the active slice and the pinned slices (see TissuesPin).
+	/// This frees the raw tissue buffers of these slices.
+	void PackTissues();
+	// Description: keep at most this many bytes of slice data in memory, the other slices are paged to disk. 0 disables paging.
+	size_t GetPagingBudget() const { return m_PagingBudget; }
+	void SetPagingBudget(size_t bytes);
+	// Description: keep at most this many bytes of compressed image stack entries in memory, older entries are moved to disk. 0 means no limit.
+	size_t GetStackBudget() const;
+	void SetStackBudget(size_t bytes);
+	size_t GetCacheHits() const { return m_CacheHits; }
+	size_t GetCacheMisses() const { return m_CacheMisses; }
+	void ResetCacheCounters();
+
+	float* SourceVolume() override;
+	float* TargetVolume() override;
+	tissues_size_t* TissueVolume(tissuelayers_size_t layeridx) override;
 
 	int SaveRaw(const char* filename, bool work);
 	float DICOMsort(std::vector<std::string>* lfilename);
@@ -449,14 +507,96 @@ public:
 	void Mergetissues(tissues_size_t tissuetype);
 
 private:
-	unsigned short m_Activeslice;
+	/// Reads the dx x dy voxels at p of the raw slices of size w x h, bitdepth 32 is float
+	int ReadRawVolume(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, unsigned nrofslices, Point p, unsigned dx, unsigned dy);
+	int ReloadRawVolume(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, Point p);
+	/// Permutes the axes of the volume, axis j of the result is axis order[j]. The permuted volume is staged in temporary files.
+	bool PermuteVolume(const std::array<unsigned int, 3>& order);
+	/// Decodes one 2D image per slice in parallel, load returns 1 on success
+	int LoadImageStack(const std::vector<std::string>& filenames, const std::function<int(Bmphandler&, const char*)>& load);
+
+	/// Content of the project file as last written or read, used to write only the modified slices on the next save
+	struct SavedProject
+	{
+		std::string m_File;
+		std::int64_t m_FileSize = -1;
+		unsigned m_FileTime = 0;
+		unsigned m_Width = 0;
+		unsigned m_Height = 0;
+		int m_Compression = 0;
+		bool m_SaveWork = false;
+		std::vector<std::uint64_t> m_Source;
+		std::vector<std::uint64_t> m_Target;
+		std::vector<std::uint64_t> m_Tissue;
+		/// number of chunks rewritten since the file was written completely, preview chunks counted in slices of the volume
+		size_t m_Rewritten = 0;
+	};
+
+	/// Snapshot of the slices written by the worker thread of StartBackgroundSave
+	struct BackgroundSave
+	{
+		std::thread m_Thread;
+		std::string m_File;
+		std::string m_H5File;
+		unsigned m_Width = 0;
+		unsigned m_Height = 0;
+		float m_PixelSize[3] = {1.f, 1.f, 1.f};
+		Transform m_Transform;
+		int m_Compression = 0;
+		bool m_SaveWork = false;
+		bool m_Update = false;
+		/// h5 file of the last save, whose volume is copied into m_H5File before it is updated
+		std::string m_CopyFrom;
+		std::vector<float*> m_Source;
+		std::vector<float*> m_Target;
+		std::vector<tissues_size_t*> m_Tissue;
+		/// fingerprints of the last save, and of the snapshot computed by the worker
+		SavedProject m_Previous;
+		SavedProject m_Saved;
+		bool m_Success = false;
+	};
+
+	void UpdateVolumeStorage();
+	/// Copy the slices, whose buffers no longer point into the contiguous storage, back into it
+	void SyncVolumeStorage();
+	/// Slice access, which pages the slice in if necessary
+	Bmphandler& ImageSlice(unsigned slicenr);
+	const Bmphandler& ImageSlice(unsigned slicenr) const;
+	/// Target of a slice for writing it to a file, without allocating an unused target
+	float* WorkForReading(unsigned slicenr) const;
+	/// Release the targets which are zero everywhere, e.g. after loading
+	void ReleaseZeroTargets();
+	/// Restore the old (or for redo the new) images of the i-th slice of a 3D undo step
+	void ApplyUndoDeltas(const MultiUndoElem& uelem, unsigned i, bool redo);
+	void PageIn(unsigned slicenr);
+	void PageOut(unsigned slicenr);
+	void UpdatePaging();
+	bool ResetPageFile();
+	/// Page out least recently used slices until the paging budget is met. Slices close to the active slice are kept.
+	void TrimSliceCache();
+	bool SetPagingOrigin(const std::string& filename, const std::string& source, const std::string& target, const std::string& tissue);
+	/// Page in all slices which are read from the origin file, before the file is overwritten
+	void ReleasePagingOrigin();
+	/// Fingerprints of the slices of the whole volume, as they are written to a project file
+	static SavedProject FingerprintSlices(const std::vector<float*>& bmpslices, const std::vector<float*>& workslices, const std::vector<tissues_size_t*>& tissueslices, unsigned width, unsigned height);
+	/// Replace the slices which did not change since the previous save by nullptr. An unallocated target, which replaces a written one, points to zeros. Returns the number of modified slice arrays.
+	static size_t KeepModifiedSlices(const SavedProject& saved, const SavedProject& previous, bool save_work, std::vector<float*>& bmpslices, std::vector<float*>& workslices, std::vector<tissues_size_t*>& tissueslices, std::vector<float>& zeros);
+	/// Returns true if the h5 file of the last save still holds the project, i.e. h5file can be updated. The file is returned in 'from',
+	/// e.g. the project file which the 'Temp' file h5file replaces. Its volume is copied completely, see XdmfImageWriter::CopyVolume,
+	/// i.e. only compressing the unmodified slices is saved. Uncompressed projects are therefore always written completely.
+	bool PrepareIncrementalSave(const std::string& h5file, int compression, bool save_work, std::string& from);
+	void RecordSavedProject(SavedProject&& saved, const std::string& h5file, int compression, bool save_work);
+	/// The worker of a background save must be done before HDF5 is used on this thread, the library is not thread-safe
+	void WaitForBackgroundSave();
+
+	unsigned m_Activeslice;
 	std::vector<Bmphandler> m_ImageSlices;
-	short unsigned m_Width;
-	short unsigned m_Height;
-	short unsigned m_Startslice;
-	short unsigned m_Endslice;
-	short unsigned m_Nrslices;
-	unsigned int m_Area;
+	unsigned m_Width;
+	unsigned m_Height;
+	unsigned m_Startslice;
+	unsigned m_Endslice;
+	unsigned m_Nrslices;
+	size_t m_Area;
 	float m_Thickness;
 	float m_Dx;
 	float m_Dy;
@@ -476,6 +616,23 @@ private:
 	int m_Hdf5Compression = 1;
 	bool m_ContiguousMemoryIo = false; // Default: slice-by-slice
 	bool m_SaveTarget = false;
+	bool m_UseVolumeStorage = false;
+	int m_RgbFactors[3] = {30, 59, 11};
+	std::unique_ptr<VolumeStorage> m_VolumeStorage;
+	bool m_CompressTissues = false;
+	size_t m_PagingBudget = 0;
+	unsigned m_PagingReadAhead = 2;
+	std::unique_ptr<SlicePageFile> m_PageFile;
+	std::vector<std::uint64_t> m_SliceLastUse;
+	std::vector<std::uint64_t> m_SliceHash;
+	SavedProject m_SavedProject;
+	std::unique_ptr<BackgroundSave> m_BackgroundSave;
+	bool m_BackgroundSaveSuccess = true;
+	std::uint64_t m_SliceUseCounter = 0;
+	size_t m_ResidentSlices = 0;
+	size_t m_CacheHits = 0;
+	size_t m_CacheMisses = 0;
+	std::mutex m_PagingMutex;
 };
 
 } // namespace iseg
@@ -49,7 +49,7 @@ private:
 
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	PropertySlider_ptr m_SlSigma;
 	PropertySlider_ptr m_SlK;
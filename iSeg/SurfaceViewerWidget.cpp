@@ -255,6 +255,7 @@ void SurfaceViewerWidget::Load()
 	}
 	else if (tissue_selection.size() > 254) // all tissues
 	{
+		TissuesPin pin(m_Hand3D);
 		auto slices = m_Hand3D->TissueSlices(0);
 		m_Input->AllocateScalars(VTK_UNSIGNED_SHORT, 1);
 		auto field = static_cast<tissues_size_t*>(m_Input->GetScalarPointer());
@@ -276,6 +277,7 @@ void SurfaceViewerWidget::Load()
 			tissue_index_map[tissue_type] = count++;
 		}
 
+		TissuesPin pin(m_Hand3D);
 		auto slices = m_Hand3D->TissueSlices(0);
 		m_Input->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
 		auto field = static_cast<unsigned char*>(m_Input->GetScalarPointer());
@@ -25,6 +25,8 @@
 #include <QFileDialog>
 #include <QSignalMapper>
 
+#include <vector>
+
 namespace iseg {
 
 ThresholdWidgetQt4::ThresholdWidgetQt4(SlicesHandler* hand3D)
@@ -788,12 +790,19 @@ void ThresholdWidgetQt4::on_mExecutePushButton_clicked()
 	else
 	{
 		//		EM em;
+		// stack images are compressed, decompress them for the duration of the segmentation
+		std::vector<std::vector<float>> stack_images(m_Ui.mKMeansDimsSpinBox->value());
 		for (int i = 0; i < m_Ui.mKMeansDimsSpinBox->value(); i++)
 		{
 			if (m_Bits1[i] == 0)
+			{
 				m_Bits[i] = m_Handler3D->GetActivebmphandler()->ReturnBmp();
+			}
 			else
-				m_Bits[i] = m_Handler3D->GetActivebmphandler()->Getstack(m_Bits1[i], modedummy);
+			{
+				stack_images[i].resize(m_Handler3D->ReturnArea());
+				m_Bits[i] = m_Handler3D->GetActivebmphandler()->Getstack(m_Bits1[i], stack_images[i].data(), modedummy) ? stack_images[i].data() : nullptr;
+			}
 		}
 
 		if (m_Ui.mAllSlicesCheckBox->isChecked())
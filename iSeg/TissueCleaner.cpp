@@ -65,7 +65,7 @@ void TissueCleaner::ConnectedComponents()
 	newest++;
 	i1++;
 	// init first row
-	for (unsigned short k = 1; k < m_Width; k++)
+	for (unsigned k = 1; k < m_Width; k++)
 	{
 		if (m_Slices[0][i1] == m_Slices[0][i1 - 1])
 		{
@@ -81,7 +81,7 @@ void TissueCleaner::ConnectedComponents()
 		i1++;
 	}
 	// init first slice
-	for (unsigned short j = 1; j < m_Height; j++)
+	for (unsigned j = 1; j < m_Height; j++)
 	{
 		if (m_Slices[0][i1] == m_Slices[0][i1 - m_Width])
 		{
@@ -95,7 +95,7 @@ void TissueCleaner::ConnectedComponents()
 			newest++;
 		}
 		i1++;
-		for (unsigned short k = 1; k < m_Width; k++)
+		for (unsigned k = 1; k < m_Width; k++)
 		{
 			if (m_Slices[0][i1] == m_Slices[0][i1 - 1])
 			{
@@ -123,7 +123,7 @@ void TissueCleaner::ConnectedComponents()
 		}
 	}
 	// for each slice >= 1
-	for (unsigned short i = 1; i < m_Nrslices; i++)
+	for (unsigned i = 1; i < m_Nrslices; i++)
 	{
 		i2 = 0;
 		if (m_Slices[i][i2] == m_Slices[i - 1][i2])
@@ -137,7 +137,7 @@ void TissueCleaner::ConnectedComponents()
 		}
 		i1++;
 		i2++;
-		for (unsigned short k = 1; k < m_Width; k++)
+		for (unsigned k = 1; k < m_Width; k++)
 		{
 			if (m_Slices[i][i2] == m_Slices[i][i2 - 1])
 			{
@@ -163,7 +163,7 @@ void TissueCleaner::ConnectedComponents()
 			i1++;
 			i2++;
 		}
-		for (unsigned short j = 1; j < m_Height; j++)
+		for (unsigned j = 1; j < m_Height; j++)
 		{
 			if (m_Slices[i][i2] == m_Slices[i][i2 - m_Width])
 			{
@@ -188,7 +188,7 @@ void TissueCleaner::ConnectedComponents()
 			}
 			i1++;
 			i2++;
-			for (unsigned short k = 1; k < m_Width; k++)
+			for (unsigned k = 1; k < m_Width; k++)
 			{
 				if (m_Slices[i][i2] == m_Slices[i][i2 - 1])
 				{
@@ -279,10 +279,10 @@ void TissueCleaner::Clean(float ratio, unsigned minsize)
 
 	tissues_size_t curchar = 0;
 	size_t postot = 0;
-	for (unsigned short i = 0; i < m_Nrslices; i++)
+	for (unsigned i = 0; i < m_Nrslices; i++)
 	{
 		size_t pos = 0;
-		for (unsigned short j = 0; j < m_Height; j++)
+		for (unsigned j = 0; j < m_Height; j++)
 		{
 			unsigned short k = 0;
 			while (k < m_Width && erasemap[m_Volume[postot]])
@@ -390,7 +390,7 @@ FILE* TissueHiearchy::SaveParams(FILE* fp, int version)
 		fwrite(&len, sizeof(unsigned char), 1, fp);
 
 		// Write hierarchies (excluding default)
-		for (unsigned short i = 1; i <= len; ++i)
+		for (unsigned i = 1; i <= len; ++i)
 		{
 			fp = SaveHierarchy(fp, i);
 		}
@@ -424,7 +424,7 @@ FILE* TissueHiearchy::LoadParams(FILE* fp, int version)
 		fread(&len, sizeof(unsigned char), 1, fp);
 
 		// Read hierarchies (excluding default)
-		for (unsigned short i = 1; i <= len; ++i)
+		for (unsigned i = 1; i <= len; ++i)
 		{
 			fp = LoadHierarchy(fp);
 		}
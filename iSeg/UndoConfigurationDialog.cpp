@@ -33,21 +33,34 @@ UndoConfigurationDialog::UndoConfigurationDialog(SlicesHandler* hand3D, QWidget*
 
 	m_SbNrundo = new QSpinBox(1, 100, 1, nullptr);
 	m_SbNrundo->setValue(m_Handler3D->GetNumberOfUndoSteps());
-	m_SbNrundoarrays = new QSpinBox(6, 10000, 1, nullptr);
-	m_SbNrundoarrays->setValue(m_Handler3D->GetNumberOfUndoArrays());
+	m_SbMemoryBudget = new QSpinBox(16, 1024 * 1024, 64, nullptr);
+	m_SbMemoryBudget->setSuffix(" MB");
+	m_SbMemoryBudget->setValue(static_cast<int>(m_Handler3D->GetUndoMemoryBudget() / (1024 * 1024)));
+	m_CbSpillToDisk = new QCheckBox;
+	m_CbSpillToDisk->setChecked(m_Handler3D->GetUndoSpillToDisk());
+	m_CbSpillToDisk->setToolTip(tr("Move the oldest undo steps to a temporary file instead of discarding them when the memory budget is exceeded."));
+
+	m_LbUsage = new QLabel;
+	UpdateUsage();
+
+	m_Timer = new QTimer(this);
+	m_Timer->start(500);
 
 	m_PbClose = new QPushButton("Accept");
 
 	// layout
 	layout->addRow(tr("Enable 3D Undo"), m_CbUndo3D);
 	layout->addRow(tr("Maximal nr of undo steps"), m_SbNrundo);
-	layout->addRow(tr("Maximal nr of stored images"), m_SbNrundoarrays);
+	layout->addRow(tr("Memory budget"), m_SbMemoryBudget);
+	layout->addRow(tr("Page older steps to disk"), m_CbSpillToDisk);
+	layout->addRow(tr("Current usage"), m_LbUsage);
 	layout->addRow(m_PbClose);
 
 	setLayout(layout);
 
 	// connections
 	QObject_connect(m_PbClose, SIGNAL(clicked()), this, SLOT(OkPressed()));
+	QObject_connect(m_Timer, SIGNAL(timeout()), this, SLOT(UpdateUsage()));
 }
 
 UndoConfigurationDialog::~UndoConfigurationDialog()
@@ -56,10 +69,19 @@ UndoConfigurationDialog::~UndoConfigurationDialog()
 void UndoConfigurationDialog::OkPressed()
 {
 	m_Handler3D->SetUndo3D(m_CbUndo3D->isChecked());
-	m_Handler3D->SetNumberOfUndoArrays((unsigned)m_SbNrundoarrays->value());
 	m_Handler3D->SetNumberOfUndoSteps((unsigned)m_SbNrundo->value());
+	m_Handler3D->SetUndoSpillToDisk(m_CbSpillToDisk->isChecked());
+	m_Handler3D->SetUndoMemoryBudget(static_cast<size_t>(m_SbMemoryBudget->value()) * 1024 * 1024);
 
 	close();
 }
 
+void UndoConfigurationDialog::UpdateUsage()
+{
+	double const mb = 1024.0 * 1024.0;
+	m_LbUsage->setText(tr("%1 MB in memory, %2 MB on disk")
+												 .arg(m_Handler3D->GetUndoMemoryUsage() / mb, 0, 'f', 1)
+												 .arg(m_Handler3D->GetUndoDiskUsage() / mb, 0, 'f', 1));
+}
+
 } // namespace iseg
@@ -13,8 +13,10 @@
 
 #include <QCheckBox>
 #include <QDialog>
+#include <QLabel>
 #include <QPushButton>
 #include <QSpinBox>
+#include <QTimer>
 
 namespace iseg {
 
@@ -29,11 +31,15 @@ private:
 	SlicesHandler* m_Handler3D;
 	QCheckBox* m_CbUndo3D;
 	QSpinBox* m_SbNrundo;
-	QSpinBox* m_SbNrundoarrays;
+	QSpinBox* m_SbMemoryBudget;
+	QCheckBox* m_CbSpillToDisk;
+	QLabel* m_LbUsage;
+	QTimer* m_Timer;
 	QPushButton* m_PbClose;
 
 private slots:
 	void OkPressed();
+	void UpdateUsage();
 };
 
 } // namespace iseg
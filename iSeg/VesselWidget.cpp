@@ -336,8 +336,8 @@ void VesselWidget::Savevessel()
 		m_BranchTree.GetItem()->DougPeuckInclchildren(epsilon, pair1.high, pair1.low, thick, vp);
 		FILE* fp = fopen(savefilename.toAscii(), "w");
 		int version = 2;
-		unsigned short w = m_Handler3D->Width();
-		unsigned short h = m_Handler3D->Height();
+		unsigned w = m_Handler3D->Width();
+		unsigned h = m_Handler3D->Height();
 		fprintf(fp, "V%i\n", version);
 		fprintf(fp, "NS%i\n", (int)m_Handler3D->NumSlices());
 		fprintf(fp, "VoxelSize: %f %f %f\n", pair1.high / 2, pair1.low / 2, thick);
@@ -146,7 +146,7 @@ VolumeViewerWidget::VolumeViewerWidget(SlicesHandler* hand3D1, bool bmportissue1
 		m_Input->SetSpacing(ps.high, ps.low, m_Hand3D->GetSlicethickness());
 		m_Input->AllocateScalars(VTK_FLOAT, 1);
 		float* field = (float*)m_Input->GetScalarPointer(0, 0, 0);
-		for (unsigned short i = 0; i < m_Hand3D->NumSlices(); i++)
+		for (unsigned i = 0; i < m_Hand3D->NumSlices(); i++)
 		{
 			m_Hand3D->Copyfrombmp(i, &(field[i * (unsigned long long)m_Hand3D->ReturnArea()]));
 		}
@@ -165,7 +165,7 @@ VolumeViewerWidget::VolumeViewerWidget(SlicesHandler* hand3D1, bool bmportissue1
 		m_Input->SetSpacing(ps.high, ps.low, m_Hand3D->GetSlicethickness());
 		tissues_size_t* field =
 				(tissues_size_t*)m_Input->GetScalarPointer(0, 0, 0);
-		for (unsigned short i = 0; i < m_Hand3D->NumSlices(); i++)
+		for (unsigned i = 0; i < m_Hand3D->NumSlices(); i++)
 		{
 			m_Hand3D->Copyfromtissue(i, &(field[i * (unsigned long long)m_Hand3D->ReturnArea()]));
 		}
@@ -668,7 +668,7 @@ void VolumeViewerWidget::Reload()
 	if (m_Bmportissue)
 	{
 		float* field = (float*)m_Input->GetScalarPointer(0, 0, 0);
-		for (unsigned short i = 0; i < m_Hand3D->NumSlices(); i++)
+		for (unsigned i = 0; i < m_Hand3D->NumSlices(); i++)
 		{
 			m_Hand3D->Copyfrombmp(i, &(field[i * (unsigned long long)m_Hand3D->ReturnArea()]));
 		}
@@ -677,7 +677,7 @@ void VolumeViewerWidget::Reload()
 	{
 		tissues_size_t* field =
 				(tissues_size_t*)m_Input->GetScalarPointer(0, 0, 0);
-		for (unsigned short i = 0; i < m_Hand3D->NumSlices(); i++)
+		for (unsigned i = 0; i < m_Hand3D->NumSlices(); i++)
 		{
 			m_Hand3D->Copyfromtissue(i, &(field[i * (unsigned long long)m_Hand3D->ReturnArea()]));
 		}
@@ -43,7 +43,7 @@ private:
 	int m_SbhOld;
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	QSpinBox* m_SbH;
 	QSlider* m_SlH;
@@ -1165,24 +1165,24 @@ void BitsStack::PushHelper(bool source, bool target, bool tissue)
 		}
 		if (ok)
 		{
+			unsigned first = 0;
+			if (source)
+			{
+				first = m_Handler3D->PushstackBmp(startslice - 1, endslice - 1);
+			}
+			else if (target)
+			{
+				first = m_Handler3D->PushstackWork(startslice - 1, endslice - 1);
+			}
+			else if (tissue)
+			{
+				first = m_Handler3D->PushstackTissue(m_Tissuenr, startslice - 1, endslice - 1);
+			}
 			for (unsigned int slice = startslice; slice <= endslice; ++slice)
 			{
 				QString new_text_ext = new_text + QString(" (") +
 															 QString::number(slice) + QString(")");
-				unsigned dummy;
-				if (source)
-				{
-					dummy = m_Handler3D->PushstackBmp(slice - 1);
-				}
-				else if (target)
-				{
-					dummy = m_Handler3D->PushstackWork(slice - 1);
-				}
-				else if (tissue)
-				{
-					dummy = m_Handler3D->PushstackTissue(m_Tissuenr, slice - 1);
-				}
-				m_BitsNr[new_text_ext] = dummy;
+				m_BitsNr[new_text_ext] = first + slice - startslice;
 				m_BitsNames->addItem(new_text_ext);
 			}
 			emit StackChanged();
@@ -2592,10 +2592,10 @@ void CheckBoneConnectivityDialog::LookForConnections()
 {
 	m_FoundConnections.clear();
 
-	unsigned short width = m_Handler3D->Width();
-	unsigned short height = m_Handler3D->Height();
-	unsigned short start_sl = m_Handler3D->StartSlice();
-	unsigned short end_sl = m_Handler3D->EndSlice();
+	unsigned width = m_Handler3D->Width();
+	unsigned height = m_Handler3D->Height();
+	unsigned start_sl = m_Handler3D->StartSlice();
+	unsigned end_sl = m_Handler3D->EndSlice();
 
 	int num_tasks = end_sl - start_sl;
 	QProgressDialog progress("Looking for connected bones...", "Cancel", 0, num_tasks, this);
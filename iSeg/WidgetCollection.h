@@ -50,7 +50,7 @@ public:
 private:
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	float m_Minval, m_Maxval;
 	float m_Minval1, m_Maxval1;
@@ -92,7 +92,7 @@ public:
 private:
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 	float m_Val;
 
 	QPushButton* m_DoAdd;
@@ -137,7 +137,7 @@ protected:
 private:
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	QSlider* m_SlAlpha;
 	QLineEdit* m_LeAlpha;
@@ -190,7 +190,7 @@ public:
 private:
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	HistoWin* m_Histwindow;
 	QPushButton* m_CloseButton;
@@ -412,7 +412,7 @@ public:
 private:
 	Bmphandler* m_Bmphand;
 	SlicesHandler* m_Handler3D;
-	unsigned short m_Activeslice;
+	unsigned m_Activeslice;
 
 	unsigned short m_SelectedDataset;
 	std::vector<QString> m_DatasetNames;
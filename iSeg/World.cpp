@@ -111,7 +111,7 @@ bool World::Init(Vec3 bbStart, Vec3 bbEnd, SlicesHandler* handler3D)
 		Point p;
 		p.px = (short)(i + bbStart[0]);
 		p.py = (short)(j + bbStart[1]);
-		unsigned short slicenr = (unsigned short)(k + bbStart[2]);
+		unsigned slicenr = (unsigned)(k + bbStart[2]);
 		intens = m_Handler3D->GetBmpPt(p, slicenr);
 
 		if (intens > 1250 && intens < 1300)
@@ -11,8 +11,11 @@
 
 #include "XdmfImageMerger.h"
 
+#include "Data/ScopedTimer.h"
+
 #include "Core/HDF5Reader.h"
 #include "Core/HDF5Writer.h"
+#include "Core/VolumeRegion.h"
 
 #include <QDir>
 #include <QDomDocument>
@@ -25,11 +28,86 @@
 
 #include <vtkSmartPointer.h>
 
-#include <stdexcept>
+#include <algorithm>
+#include <string>
 #include <vector>
 
 namespace iseg {
 
+namespace {
+/// Number of slices copied at once from a merged project
+unsigned const kMergeSlabSlices = 32;
+
+template<typename T>
+bool ReadSlab(HDF5Reader& reader, const std::string& name, T** slices, unsigned first, unsigned count, unsigned width, unsigned height, unsigned nrslices)
+{
+	size_t const slice_size = static_cast<size_t>(width) * height;
+	if (reader.ReadChunks(slices, count, slice_size, name, first * slice_size))
+	{
+		return true;
+	}
+
+	// another layout or type, e.g. tissues stored as unsigned char, which HDF5 converts while reading
+	unsigned const dims[3] = {width, height, nrslices};
+	VolumeRegion region;
+	region.m_Start[2] = first;
+	region.m_Size[2] = count;
+	return region.Clip(dims) && reader.Read(slices, dims, region, name) != 0;
+}
+} // namespace
+
+template<typename T>
+bool XdmfImageMerger::MergeDataset(HDF5Writer& writer, const std::string& name, T** slices, unsigned nrslices, unsigned nrslicesTotal, unsigned width, unsigned height, const std::vector<MergeInput>& inputs) const
+{
+	size_t const slice_size = static_cast<size_t>(width) * height;
+
+	// allocate in file, slices which are not written read as 0
+	T** const null = nullptr;
+	if (!writer.Write(null, nrslicesTotal, slice_size, name))
+	{
+		return false;
+	}
+
+	// Current project
+	bool ok = writer.Write(slices, nrslices, slice_size, name, 0) != 0;
+	size_t offset = nrslices * slice_size;
+
+	// Merged projects
+	unsigned const slab_slices = kMergeSlabSlices;
+	std::vector<T> buffer(slab_slices * slice_size);
+	std::vector<T*> slab(slab_slices);
+	for (unsigned k = 0; k < slab_slices; ++k)
+	{
+		slab[k] = buffer.data() + k * slice_size;
+	}
+
+	for (const auto& input : inputs)
+	{
+		std::string const dataset = input.m_ArrayNames.value(QString::fromStdString(name)).toStdString();
+		HDF5Reader reader;
+		if (dataset.empty() || !reader.Open(input.m_H5File) || !reader.Exists(dataset))
+		{
+			ISEG_WARNING("no " << name << " array in " << input.m_H5File << ", will initialize to 0...");
+			offset += input.m_NumberOfSlices * slice_size;
+			continue;
+		}
+
+		for (unsigned first = 0; first < input.m_NumberOfSlices && ok; first += slab_slices)
+		{
+			unsigned const count = std::min(slab_slices, input.m_NumberOfSlices - first);
+			ok = ReadSlab(reader, dataset, slab.data(), first, count, width, height, input.m_NumberOfSlices);
+			if (!ok)
+			{
+				ISEG_ERROR("reading " << name << " dataset of " << input.m_H5File);
+			}
+			ok = ok && writer.Write(slab.data(), count, slice_size, name, offset) != 0;
+			offset += count * slice_size;
+		}
+		reader.Close();
+	}
+	return ok;
+}
+
 XdmfImageMerger::XdmfImageMerger()
 {
 	this->m_NumberOfSlices = 0;
@@ -53,43 +131,47 @@ int XdmfImageMerger::Write()
 int XdmfImageMerger::InternalWrite(const char* filename, std::vector<QString>& mergefilenames, float** slicesbmp, float** sliceswork, tissues_size_t** slicestissue, unsigned nrslices, unsigned nrslicesTotal, unsigned width, unsigned height, float* pixelsize, const Transform& transform, int compression)
 {
 	// Parse xml files of merged projects
-	std::vector<XdmfImageReader*> image_readers;
-	std::vector<QString>::iterator iter_filename;
-	for (iter_filename = mergefilenames.begin(); iter_filename != mergefilenames.end(); ++iter_filename)
+	std::vector<MergeInput> inputs;
+	for (const auto& merge_filename : mergefilenames)
 	{
-		XdmfImageReader* reader = new XdmfImageReader();
-		QString image_filename = QFileInfo(*iter_filename).completeBaseName() + ".xmf";
-		reader->SetFileName(QFileInfo(*iter_filename).dir().absoluteFilePath(image_filename).toStdString().c_str());
-		if (reader->ParseXML() == 0)
+		QFileInfo merge_info(merge_filename);
+		QString image_filename = merge_info.dir().absoluteFilePath(merge_info.completeBaseName() + ".xmf");
+		XdmfImageReader reader;
+		reader.SetFileName(image_filename.toStdString().c_str());
+		if (reader.ParseXML() == 0)
 		{
 			ISEG_ERROR_MSG("XdmfImageMerger::InternalWrite while parsing xmls");
 			return 0;
 		}
-		image_readers.push_back(reader);
+		if (reader.GetWidth() != width || reader.GetHeight() != height)
+		{
+			ISEG_ERROR("XdmfImageMerger::InternalWrite " << image_filename.toStdString() << " has another slice size");
+			return 0;
+		}
+
+		MergeInput input;
+		input.m_H5File = merge_info.dir().absoluteFilePath(merge_info.completeBaseName() + ".h5").toStdString();
+		input.m_ArrayNames = reader.GetMapArrayNames();
+		input.m_NumberOfSlices = reader.GetNumberOfSlices();
+		inputs.push_back(input);
 	}
 
 	QString q_file_name(filename);
 	QFileInfo file_info(q_file_name);
 	QString basename = file_info.completeBaseName();
 
-	// save working directory
-	QDir oldcwd = QDir::current();
-
-	// enter the xmf file folder so relative names for hdf5 files work
-	QDir::setCurrent(file_info.absolutePath());
-
-	const size_t slice_size = static_cast<size_t>(width) * height;
-
 	float offset[3];
 	transform.GetOffset(offset);
 
 	ISEG_INFO("Writing " << width << " x " << height << " x " << nrslicesTotal);
 
+	// absolute paths instead of changing the working directory
 	HDF5Writer writer;
-	const QString fname = basename + ".h5";
-	if (!writer.Open(fname.toStdString()))
+	const std::string fname = file_info.dir().absoluteFilePath(basename + ".h5").toStdString();
+	if (!writer.Open(fname))
 	{
-		ISEG_ERROR("opening " << fname.toStdString());
+		ISEG_ERROR("opening " << fname);
+		return 0;
 	}
 	writer.m_Compression = compression;
 
@@ -140,121 +222,39 @@ int XdmfImageMerger::InternalWrite(const char* filename, std::vector<QString>& m
 		}
 	}
 
-	// The slices are not contiguous in memory so we need to copy.
-
-	// Source
+	// The merged projects are copied in slabs of a few slices, i.e. the memory does not depend on their size
+	bool ok = true;
 	{
-		ISEG_INFO_MSG("writing Source");
-		// allocate in file
-		float** const null = nullptr;
-		if (writer.Write(null, nrslicesTotal, slice_size, "Source"))
+		ScopedTimer timer("Merge Source");
+		if (!MergeDataset(writer, "Source", slicesbmp, nrslices, nrslicesTotal, width, height, inputs))
 		{
-			size_t offset = 0;
-
-			// Current project
-			writer.Write(slicesbmp, nrslices, slice_size, "Source", offset);
-			offset += nrslices * slice_size;
-
-			// Merged projects
-			std::vector<float> project_buffer;
-			std::vector<XdmfImageReader*>::iterator iter_reader;
-			for (iter_filename = mergefilenames.begin(), iter_reader = image_readers.begin();
-					 iter_filename != mergefilenames.end();
-					 ++iter_filename, ++iter_reader)
-			{
-				size_t junk = 0;
-				size_t const project_slices =
-						(*iter_reader)->GetNumberOfSlices();
-				project_buffer.resize(slice_size * project_slices);
-				ReadSource(*iter_reader, (*iter_filename).toStdString().c_str(), project_buffer, junk);
-
-				std::vector<float*> slices(project_slices, nullptr);
-				for (size_t i = 0; i < project_slices; ++i)
-				{
-					slices[i] = &project_buffer[i * slice_size];
-				}
-				writer.Write(slices.data(), project_slices, slice_size, "Source", offset);
-				offset += project_slices * slice_size;
-			}
+			ISEG_ERROR_MSG("writing Source");
+			ok = false;
 		}
-	}
-
-	// Target
-	{
-		ISEG_INFO_MSG("writing Target");
-		// allocate in file
-		float** const null = nullptr;
-		if (writer.Write(null, nrslicesTotal, slice_size, "Target"))
+		timer.NewScope("Merge Target");
+		if (ok && !MergeDataset(writer, "Target", sliceswork, nrslices, nrslicesTotal, width, height, inputs))
 		{
-			size_t offset = 0;
-
-			// Current project
-			writer.Write(sliceswork, nrslices, slice_size, "Target", offset);
-			offset += nrslices * slice_size;
-
-			// Merged projects
-			std::vector<float> project_buffer;
-			std::vector<XdmfImageReader*>::iterator iter_reader;
-			for (iter_filename = mergefilenames.begin(), iter_reader = image_readers.begin();
-					 iter_filename != mergefilenames.end();
-					 ++iter_filename, ++iter_reader)
-			{
-				size_t junk = 0;
-				size_t const project_slices =
-						(*iter_reader)->GetNumberOfSlices();
-				project_buffer.resize(slice_size * project_slices);
-				ReadTarget(*iter_reader, (*iter_filename).toStdString().c_str(), project_buffer, junk);
-
-				std::vector<float*> slices(project_slices, nullptr);
-				for (size_t i = 0; i < project_slices; ++i)
-				{
-					slices[i] = &project_buffer[i * slice_size];
-				}
-				writer.Write(slices.data(), project_slices, slice_size, "Target", offset);
-				offset += project_slices * slice_size;
-			}
+			ISEG_ERROR_MSG("writing Target");
+			ok = false;
 		}
-	}
-
-	// Tissue
-	{
-		ISEG_INFO_MSG("writing Tissue");
-		// allocate in file
-		tissues_size_t** const null = nullptr;
-		if (writer.Write(null, nrslicesTotal, slice_size, "Tissue"))
+		timer.NewScope("Merge Tissue");
+		if (ok && !MergeDataset(writer, "Tissue", slicestissue, nrslices, nrslicesTotal, width, height, inputs))
 		{
-			size_t offset = 0;
-
-			// Current project
-			writer.Write(slicestissue, nrslices, slice_size, "Tissue", offset);
-			offset += nrslices * slice_size;
-
-			// Merged projects
-			std::vector<tissues_size_t> project_buffer;
-			std::vector<XdmfImageReader*>::iterator iter_reader;
-			for (iter_filename = mergefilenames.begin(), iter_reader = image_readers.begin();
-					 iter_filename != mergefilenames.end();
-					 ++iter_filename, ++iter_reader)
-			{
-				size_t junk = 0;
-				size_t const project_slices =
-						(*iter_reader)->GetNumberOfSlices();
-				project_buffer.resize(slice_size * project_slices);
-				ReadTissues(*iter_reader, (*iter_filename).toStdString().c_str(), project_buffer, junk);
-
-				std::vector<tissues_size_t*> slices(project_slices, nullptr);
-				for (size_t i = 0; i < project_slices; ++i)
-				{
-					slices[i] = &project_buffer[i * slice_size];
-				}
-				writer.Write(slices.data(), project_slices, slice_size, "Tissue", offset);
-				offset += project_slices * slice_size;
-			}
+			ISEG_ERROR_MSG("writing Tissue");
+			ok = false;
 		}
 	}
 
 	writer.Close();
 
+	if (!ok)
+	{
+		// do not leave a half-written project behind
+		QFile::remove(QString::fromStdString(fname));
+		QFile::remove(q_file_name);
+		return 0;
+	}
+
 	// Write XML file
 	QDomElement dataitem, attribute;
 	QDomText text;
@@ -364,232 +364,6 @@ int XdmfImageMerger::InternalWrite(const char* filename, std::vector<QString>& m
 	out << doc;
 	file.close();
 
-	// restore working directory
-	QDir::setCurrent(oldcwd.absolutePath());
-
-	for (XdmfImageReader* r : image_readers)
-	{
-		delete r;
-	}
-
-	return 1;
-}
-
-int XdmfImageMerger::ReadSource(XdmfImageReader* imageReader, const char* filename, std::vector<float>& bufferFloat, size_t& sliceoffset) const
-{
-	QFileInfo file_info(filename);
-	QString basename = file_info.completeBaseName();
-
-	// save working directory
-	QDir oldcwd = QDir::current();
-
-	// enter the xmf file folder so relative names for hdf5 files work
-	QDir::setCurrent(file_info.absolutePath());
-
-	HDF5Reader reader;
-	reader.m_Loud = true;
-	const QString fname = basename + ".h5";
-	if (!reader.Open(fname.toStdString()))
-	{
-		ISEG_ERROR("opening " << fname.toStdString());
-		return 0;
-	}
-
-	// Source
-	QString map_source_name = imageReader->GetMapArrayNames()["Source"];
-	if (map_source_name.isEmpty())
-	{
-		ISEG_ERROR_MSG("no Source array...");
-		return 0;
-	}
-	if (!reader.Read(&bufferFloat[sliceoffset * this->m_Width * this->m_Height], map_source_name.toStdString()))
-	{
-		ISEG_ERROR_MSG("reading Source dataset...");
-		return 0;
-	}
-	sliceoffset += imageReader->GetNumberOfSlices();
-
-	// restore working directory
-	QDir::setCurrent(oldcwd.absolutePath());
-
-	return 1;
-}
-
-int XdmfImageMerger::ReadTarget(XdmfImageReader* imageReader, const char* filename, std::vector<float>& bufferFloat, size_t& sliceoffset) const
-{
-	QFileInfo file_info(filename);
-	QString basename = file_info.completeBaseName();
-
-	// save working directory
-	QDir oldcwd = QDir::current();
-
-	// enter the xmf file folder so relative names for hdf5 files work
-	QDir::setCurrent(file_info.absolutePath());
-
-	HDF5Reader reader;
-	reader.m_Loud = true;
-	const QString fname = basename + ".h5";
-	if (!reader.Open(fname.toStdString()))
-	{
-		ISEG_ERROR("opening " << fname.toStdString());
-		return 0;
-	}
-
-	// Target
-	auto map_target_name = imageReader->GetMapArrayNames()["Target"].toStdString();
-	if (map_target_name.empty())
-	{
-		ISEG_WARNING_MSG("no Target array, will initialize to 0...");
-		bufferFloat.assign(bufferFloat.size(), 0.0f);
-	}
-	else
-	{
-		if (!reader.Read(&bufferFloat[sliceoffset * this->m_Width * this->m_Height], map_target_name))
-		{
-			ISEG_ERROR_MSG("reading Target dataset...");
-			return 0;
-		}
-	}
-	sliceoffset += imageReader->GetNumberOfSlices();
-
-	// restore working directory
-	QDir::setCurrent(oldcwd.absolutePath());
-
-	return 1;
-}
-
-int XdmfImageMerger::ReadTissues(XdmfImageReader* imageReader, const char* filename, std::vector<tissues_size_t>& bufferTissuesSizeT, size_t& sliceoffset) const
-{
-	QFileInfo file_info(filename);
-	QString basename = file_info.completeBaseName();
-
-	// save working directory
-	QDir oldcwd = QDir::current();
-
-	// enter the xmf file folder so relative names for hdf5 files work
-	QDir::setCurrent(file_info.absolutePath());
-
-	HDF5Reader reader;
-	const QString fname = basename + ".h5";
-	if (!reader.Open(fname.toStdString()))
-	{
-		ISEG_ERROR("opening " << fname.toStdString());
-		return 0;
-	}
-
-	// Tissue
-	auto map_tissue_name = imageReader->GetMapArrayNames()["Tissue"].toStdString();
-	std::string type;
-	std::vector<HDF5Reader::size_type> dims;
-	if (!reader.GetDatasetInfo(type, dims, map_tissue_name))
-	{
-		ISEG_ERROR_MSG("reading Tissue data type...");
-		return 0;
-	}
-
-	size_t const curr_nrslices = imageReader->GetNumberOfSlices();
-	size_t const n = (curr_nrslices * this->m_Width) * this->m_Height;
-
-	if (type == "unsigned char")
-	{
-		std::vector<unsigned char> buffer_u_char;
-		try
-		{
-			buffer_u_char.resize(n);
-		}
-		catch (std::length_error& le)
-		{
-			std::cerr << "bufferUChar length error: " << le.what();
-			return 0;
-		}
-		if (map_tissue_name.empty())
-		{
-			ISEG_ERROR_MSG("no Tissue array...");
-			return 0;
-		}
-		if (!reader.Read(&buffer_u_char[0], map_tissue_name))
-		{
-			ISEG_ERROR_MSG("reading Tissue dataset...");
-			return 0;
-		}
-		std::vector<unsigned char>::iterator iter_from = buffer_u_char.begin();
-		std::vector<tissues_size_t>::iterator iter_to =
-				bufferTissuesSizeT.begin() +
-				(sliceoffset * this->m_Width) * this->m_Height;
-		for (unsigned int k = 0; k < curr_nrslices; k++)
-		{
-			for (unsigned int j = 0; j < this->m_Height; j++)
-			{
-				for (unsigned int i = 0; i < this->m_Width; i++)
-				{
-					(*iter_to++) = (tissues_size_t)(*iter_from++);
-				}
-			}
-		}
-		buffer_u_char.clear();
-	}
-	else if (type == "unsigned short")
-	{
-		static_assert(std::is_same<unsigned short, tissues_size_t>::value, "Special case we read directly into the buffer.");
-		if (map_tissue_name.empty())
-		{
-			ISEG_ERROR_MSG("no Tissue array...");
-			return 0;
-		}
-		if (!reader.Read(&bufferTissuesSizeT[(sliceoffset * this->m_Width) * this->m_Height], map_tissue_name))
-		{
-			ISEG_ERROR_MSG("reading Tissue dataset...");
-			return 0;
-		}
-	}
-	else if (type == "unsigned int")
-	{
-		std::vector<unsigned int> buffer_u_int;
-		try
-		{
-			buffer_u_int.resize(n);
-		}
-		catch (std::length_error& le)
-		{
-			ISEG_ERROR("bufferUInt length error: " << le.what());
-			return 0;
-		}
-		if (map_tissue_name.empty())
-		{
-			ISEG_ERROR_MSG("no Tissue array...");
-			return 0;
-		}
-		if (!reader.Read(&buffer_u_int[0], map_tissue_name))
-		{
-			ISEG_ERROR_MSG("reading Tissue dataset...");
-			return 0;
-		}
-		std::vector<unsigned int>::iterator iter_from = buffer_u_int.begin();
-		std::vector<tissues_size_t>::iterator iter_to =
-				bufferTissuesSizeT.begin() +
-				sliceoffset * this->m_Width * this->m_Height;
-		for (unsigned int k = 0; k < curr_nrslices; k++)
-		{
-			for (unsigned int j = 0; j < this->m_Height; j++)
-			{
-				for (unsigned int i = 0; i < this->m_Width; i++)
-				{
-					(*iter_to++) = (tissues_size_t)(*iter_from++);
-				}
-			}
-		}
-		buffer_u_int.clear();
-	}
-	else
-	{
-		ISEG_ERROR_MSG("Tissue data type not supported...");
-		return 0;
-	}
-	sliceoffset += imageReader->GetNumberOfSlices();
-
-	// restore working directory
-	QDir::setCurrent(oldcwd.absolutePath());
-
 	return 1;
 }
 
@@ -17,8 +17,13 @@
 
 #include "Core/SetGetMacros.h"
 
+#include <string>
+#include <vector>
+
 namespace iseg {
 
+class HDF5Writer;
+
 class XdmfImageMerger
 {
 public:
@@ -66,9 +71,17 @@ protected:
 
 private:
 	int InternalWrite(const char* filename, std::vector<QString>& mergefilenames, float** slicesbmp, float** sliceswork, tissues_size_t** slicestissue, unsigned nrslices, unsigned nrslicesTotal, unsigned width, unsigned height, float* pixelsize, const Transform& transform, int compression);
-	int ReadSource(XdmfImageReader* imageReader, const char* filename, std::vector<float>& bufferFloat, size_t& sliceoffset) const;
-	int ReadTarget(XdmfImageReader* imageReader, const char* filename, std::vector<float>& bufferFloat, size_t& sliceoffset) const;
-	int ReadTissues(XdmfImageReader* imageReader, const char* filename, std::vector<tissues_size_t>& bufferTissuesSizeT, size_t& sliceoffset) const;
+
+	struct MergeInput
+	{
+		std::string m_H5File;
+		QMap<QString, QString> m_ArrayNames;
+		unsigned m_NumberOfSlices = 0;
+	};
+
+	/// Writes the slices of this project followed by the dataset 'name' of each merged project, streamed in slabs
+	template<typename T>
+	bool MergeDataset(HDF5Writer& writer, const std::string& name, T** slices, unsigned nrslices, unsigned nrslicesTotal, unsigned width, unsigned height, const std::vector<MergeInput>& inputs) const;
 };
 
 } // namespace iseg
@@ -16,6 +16,7 @@
 
 #include "Core/ColorLookupTable.h"
 #include "Core/HDF5Reader.h"
+#include "Core/VolumePyramid.h"
 
 #include <boost/algorithm/string/replace.hpp>
 
@@ -30,6 +31,7 @@
 
 #include <vtkSmartPointer.h>
 
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 #include <vector>
@@ -42,7 +44,7 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 	if (!reader.Exists(source_dname))
 	{
 		ISEG_WARNING_MSG("no Source array, will initialize to 0...");
-		for (int k = 0; k < NumberOfSlices; k++)
+		for (size_t k = 0; k < NumberOfSlices; k++)
 		{
 			size_t pos = 0;
 			for (int j = 0; j < Height; j++)
@@ -57,7 +59,7 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 	if (!reader.Exists(target_dname))
 	{
 		ISEG_WARNING_MSG("no Target array, will initialize to 0...");
-		for (int k = 0; k < NumberOfSlices; k++)
+		for (size_t k = 0; k < NumberOfSlices; k++)
 		{
 			size_t pos = 0;
 			for (int j = 0; j < Height; j++)
@@ -72,7 +74,7 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 	if (!reader.Exists(tissue_dname))
 	{
 		ISEG_WARNING_MSG("no Tissue array, will initialize to 0...");
-		for (int k = 0; k < NumberOfSlices; k++)
+		for (size_t k = 0; k < NumberOfSlices; k++)
 		{
 			size_t pos = 0;
 			for (int j = 0; j < Height; j++)
@@ -85,6 +87,25 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 		}
 	}
 
+	// projects store one chunk per slice, these are read and decompressed in parallel
+	size_t const slice_size = Width * Height;
+	bool source_read = false, target_read = false, tissue_read = false;
+	if (reader.Exists(source_dname))
+	{
+		ScopedTimer timer("Read Source chunks");
+		source_read = reader.ReadChunks(ImageSlices, NumberOfSlices, slice_size, source_dname) != 0;
+	}
+	if (reader.Exists(target_dname))
+	{
+		ScopedTimer timer("Read Target chunks");
+		target_read = reader.ReadChunks(WorkSlices, NumberOfSlices, slice_size, target_dname) != 0;
+	}
+	if (reader.Exists(tissue_dname))
+	{
+		ScopedTimer timer("Read Tissue chunks");
+		tissue_read = reader.ReadChunks(TissueSlices, NumberOfSlices, slice_size, tissue_dname) != 0;
+	}
+
 	if (ReadContiguousMemory)
 	{
 		// allocate
@@ -93,7 +114,8 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 		try
 		{
 			ISEG_DEBUG("N = " << n << ", bufferFloat.max_size() = " << buffer_float.max_size());
-			buffer_float.resize(n);
+			if (!source_read || !target_read)
+				buffer_float.resize(n);
 		}
 		catch (std::length_error& le)
 		{
@@ -102,7 +124,7 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 		}
 
 		// Source
-		if (reader.Exists(source_dname))
+		if (!source_read && reader.Exists(source_dname))
 		{
 			ScopedTimer timer("Read Source");
 			if (!reader.Read(&buffer_float[0], source_dname))
@@ -112,7 +134,7 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 			else
 			{
 				size_t n = 0;
-				for (int k = 0; k < NumberOfSlices; k++)
+				for (size_t k = 0; k < NumberOfSlices; k++)
 				{
 					size_t pos = 0;
 					for (int j = 0; j < Height; j++)
@@ -128,7 +150,7 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 		}
 
 		// Target
-		if (reader.Exists(target_dname))
+		if (!target_read && reader.Exists(target_dname))
 		{
 			ScopedTimer timer("Read Target");
 			if (!reader.Read(&buffer_float[0], target_dname))
@@ -138,7 +160,7 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 			else
 			{
 				size_t n = 0;
-				for (int k = 0; k < NumberOfSlices; k++)
+				for (size_t k = 0; k < NumberOfSlices; k++)
 				{
 					size_t pos = 0;
 					for (int j = 0; j < Height; j++)
@@ -155,7 +177,7 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 		buffer_float.clear();
 
 		// Tissue
-		if (reader.Exists(tissue_dname))
+		if (!tissue_read && reader.Exists(tissue_dname))
 		{
 			ScopedTimer timer("Read Tissue");
 			std::string type;
@@ -187,7 +209,7 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 					return 0;
 				}
 				size_t n = 0;
-				for (int k = 0; k < NumberOfSlices; k++)
+				for (size_t k = 0; k < NumberOfSlices; k++)
 				{
 					size_t pos = 0;
 					for (int j = 0; j < Height; j++)
@@ -223,7 +245,7 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 					return 0;
 				}
 				size_t n = 0;
-				for (int k = 0; k < NumberOfSlices; k++)
+				for (size_t k = 0; k < NumberOfSlices; k++)
 				{
 					size_t pos = 0;
 					for (int j = 0; j < Height; j++)
@@ -259,7 +281,7 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 					return 0;
 				}
 				size_t n = 0;
-				for (int k = 0; k < NumberOfSlices; k++)
+				for (size_t k = 0; k < NumberOfSlices; k++)
 				{
 					size_t pos = 0;
 					for (int j = 0; j < Height; j++)
@@ -283,34 +305,32 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 	}
 	else
 	{
-		size_t const slice_size = Width * Height;
-
-		if (reader.Exists(source_dname))
+		if (!source_read && reader.Exists(source_dname))
 		{
 			ScopedTimer timer("Read Source");
 			bool ok = true;
 			size_t offset = 0;
-			for (int k = 0; k < NumberOfSlices; k++, offset += slice_size)
+			for (size_t k = 0; k < NumberOfSlices; k++, offset += slice_size)
 			{
 				ok = ok && reader.Read(ImageSlices[k], offset, slice_size, source_dname);
 			}
 		}
-		if (reader.Exists(target_dname))
+		if (!target_read && reader.Exists(target_dname))
 		{
 			ScopedTimer timer("Read Target");
 			bool ok = true;
 			size_t offset = 0;
-			for (int k = 0; k < NumberOfSlices; k++, offset += slice_size)
+			for (size_t k = 0; k < NumberOfSlices; k++, offset += slice_size)
 			{
 				ok = ok && reader.Read(WorkSlices[k], offset, slice_size, target_dname);
 			}
 		}
-		if (reader.Exists(tissue_dname))
+		if (!tissue_read && reader.Exists(tissue_dname))
 		{
 			ScopedTimer timer("Read Tissue");
 			bool ok = true;
 			size_t offset = 0;
-			for (int k = 0; k < NumberOfSlices; k++, offset += slice_size)
+			for (size_t k = 0; k < NumberOfSlices; k++, offset += slice_size)
 			{
 				ok = ok && reader.Read(TissueSlices[k], offset, slice_size, tissue_dname);
 			}
@@ -319,6 +339,60 @@ int _Read(HDF5Reader& reader, size_t NumberOfSlices, size_t Width, size_t Height
 
 	return 1;
 }
+
+template<typename T>
+void _Fill(T** slices, const VolumeRegion& region, T value)
+{
+	size_t const slice_size = region.Dim(0) * static_cast<size_t>(region.Dim(1));
+	for (unsigned k = 0; k < region.Dim(2); k++)
+	{
+		std::fill(slices[k], slices[k] + slice_size, value);
+	}
+}
+
+/// Reads only the hyperslabs of the region, instead of the full slices of the whole stack
+int _ReadRegion(HDF5Reader& reader, const unsigned dims[3], const VolumeRegion& region, const std::string& source_dname, float** ImageSlices, const std::string& target_dname, float** WorkSlices, const std::string& tissue_dname, tissues_size_t** TissueSlices)
+{
+	ISEG_INFO("Reading region " << region.m_Start[0] << " " << region.m_Start[1] << " " << region.m_Start[2] << " of size " << region.Dim(0) << " x " << region.Dim(1) << " x " << region.Dim(2));
+
+	bool ok = true;
+	if (reader.Exists(source_dname))
+	{
+		ScopedTimer timer("Read Source region");
+		ok = ok && reader.Read(ImageSlices, dims, region, source_dname) != 0;
+	}
+	else
+	{
+		ISEG_WARNING_MSG("no Source array, will initialize to 0...");
+		_Fill(ImageSlices, region, 0.0f);
+	}
+	if (reader.Exists(target_dname))
+	{
+		ScopedTimer timer("Read Target region");
+		ok = ok && reader.Read(WorkSlices, dims, region, target_dname) != 0;
+	}
+	else
+	{
+		ISEG_WARNING_MSG("no Target array, will initialize to 0...");
+		_Fill(WorkSlices, region, 0.0f);
+	}
+	if (reader.Exists(tissue_dname))
+	{
+		ScopedTimer timer("Read Tissue region");
+		ok = ok && reader.Read(TissueSlices, dims, region, tissue_dname) != 0;
+	}
+	else
+	{
+		ISEG_WARNING_MSG("no Tissue array, will initialize to 0...");
+		_Fill(TissueSlices, region, tissues_size_t(0));
+	}
+
+	if (!ok)
+	{
+		ISEG_ERROR_MSG("reading region of dataset...");
+	}
+	return ok ? 1 : 0;
+}
 } // namespace
 
 XdmfImageReader::XdmfImageReader()
@@ -493,7 +567,21 @@ int XdmfImageReader::Read()
 		return 0;
 	}
 
-	int r = _Read(reader, m_NumberOfSlices, m_Width, m_Height, m_ReadContiguousMemory, this->m_MapArrayNames["Source"].toStdString().c_str(), m_ImageSlices, this->m_MapArrayNames["Target"].toStdString().c_str(), m_WorkSlices, this->m_MapArrayNames["Tissue"].toStdString().c_str(), m_TissueSlices);
+	unsigned const dims[3] = {m_Width, m_Height, m_NumberOfSlices};
+	VolumeRegion region = m_Region;
+	int r = 0;
+	if (!region.Clip(dims))
+	{
+		ISEG_ERROR_MSG("region lies outside of the volume");
+	}
+	else if (region.IsWhole(dims))
+	{
+		r = _Read(reader, m_NumberOfSlices, m_Width, m_Height, m_ReadContiguousMemory, this->m_MapArrayNames["Source"].toStdString().c_str(), m_ImageSlices, this->m_MapArrayNames["Target"].toStdString().c_str(), m_WorkSlices, this->m_MapArrayNames["Tissue"].toStdString().c_str(), m_TissueSlices);
+	}
+	else
+	{
+		r = _ReadRegion(reader, dims, region, this->m_MapArrayNames["Source"].toStdString(), m_ImageSlices, this->m_MapArrayNames["Target"].toStdString(), m_WorkSlices, this->m_MapArrayNames["Tissue"].toStdString(), m_TissueSlices);
+	}
 
 	reader.Close();
 
@@ -551,7 +639,7 @@ int HDFImageReader::ParseHDF()
 	std::vector<float> pixelsize(3);
 	ok = ok && (reader.Read(pixelsize, "/pixelsize") != 0) &&
 			 (pixelsize.size() == 3);
-	for (unsigned short i = 0; i < 3; i++)
+	for (unsigned i = 0; i < 3; i++)
 		m_PixelSize[i] = pixelsize[i];
 
 	std::vector<float> offset(3);
@@ -630,14 +718,67 @@ int HDFImageReader::Read()
 		return 0;
 	}
 
-	_Read(reader, m_NumberOfSlices, m_Width, m_Height, m_ReadContiguousMemory, this->m_MapArrayNames["Source"].toStdString().c_str(), m_ImageSlices, this->m_MapArrayNames["Target"].toStdString().c_str(), m_WorkSlices, this->m_MapArrayNames["Tissue"].toStdString().c_str(), m_TissueSlices);
+	unsigned const dims[3] = {m_Width, m_Height, m_NumberOfSlices};
+	VolumeRegion region = m_Region;
+	int r = 1;
+	if (!region.Clip(dims))
+	{
+		ISEG_ERROR_MSG("region lies outside of the volume");
+		r = 0;
+	}
+	else if (region.IsWhole(dims))
+	{
+		_Read(reader, m_NumberOfSlices, m_Width, m_Height, m_ReadContiguousMemory, this->m_MapArrayNames["Source"].toStdString().c_str(), m_ImageSlices, this->m_MapArrayNames["Target"].toStdString().c_str(), m_WorkSlices, this->m_MapArrayNames["Tissue"].toStdString().c_str(), m_TissueSlices);
+	}
+	else
+	{
+		r = _ReadRegion(reader, dims, region, this->m_MapArrayNames["Source"].toStdString(), m_ImageSlices, this->m_MapArrayNames["Target"].toStdString(), m_WorkSlices, this->m_MapArrayNames["Tissue"].toStdString(), m_TissueSlices);
+	}
 
 	reader.Close();
 
 	// restore working directory
 	QDir::setCurrent(oldcwd.absolutePath());
 
-	return 1;
+	return r;
+}
+
+int HDFImageReader::GetPreviewLevels() const
+{
+	HDF5Reader reader;
+	int levels = 0;
+	if (reader.Open(m_FileName) && reader.Exists("/Preview/levels"))
+	{
+		if (!reader.Read(&levels, "/Preview/levels"))
+		{
+			levels = 0;
+		}
+	}
+	return levels;
+}
+
+int HDFImageReader::ReadPreview(int level)
+{
+	HDF5Reader reader;
+	if (!reader.Open(m_FileName))
+	{
+		ISEG_ERROR("opening " << m_FileName);
+		return 0;
+	}
+
+	auto const dims = VolumePyramid::Dims({m_Width, m_Height, m_NumberOfSlices}, level);
+	size_t const slice_size = static_cast<size_t>(dims[0]) * dims[1];
+	std::string const suffix = std::to_string(level);
+
+	// the levels are stored with one chunk per slice like the volume
+	ScopedTimer timer("Read preview");
+	bool ok = reader.ReadChunks(m_ImageSlices, dims[2], slice_size, "/Preview/Source" + suffix) != 0;
+	ok = ok && reader.ReadChunks(m_TissueSlices, dims[2], slice_size, "/Preview/Tissue" + suffix) != 0;
+	if (!ok)
+	{
+		ISEG_ERROR("reading preview level " << level << " of " << m_FileName);
+	}
+	return ok ? 1 : 0;
 }
 
 std::shared_ptr<ColorLookupTable> HDFImageReader::ReadColorLookup() const
@@ -14,6 +14,7 @@
 #include "Data/Types.h"
 
 #include "Core/SetGetMacros.h"
+#include "Core/VolumeRegion.h"
 
 #include <QMap>
 #include <QStringList>
@@ -45,6 +46,8 @@ public:
 	GetMacro(TissueSlices, tissues_size_t**);
 	SetMacro(ReadContiguousMemory, bool);
 	GetMacro(ReadContiguousMemory, bool);
+	/// Box of the volume to read, the slices must hold the clipped region's Dim(0) x Dim(1) x Dim(2) voxels
+	void SetRegion(const VolumeRegion& region) { m_Region = region; }
 
 	const QStringList& GetArrayNames() const { return this->m_ArrayNames; };
 	const QMap<QString, QString>& GetMapArrayNames() const { return this->m_MapArrayNames; }
@@ -66,6 +69,7 @@ private:
 	float** m_ImageSlices;
 	float** m_WorkSlices;
 	tissues_size_t** m_TissueSlices;
+	VolumeRegion m_Region;
 	QStringList m_ArrayNames;
 	QMap<QString, QString> m_MapArrayNames;
 };
@@ -84,6 +88,8 @@ public:
 	GetMacro(PixelSize, float*);
 	SetMacro(ReadContiguousMemory, bool);
 	GetMacro(ReadContiguousMemory, bool);
+	/// Box of the volume to read, the slices must hold the clipped region's Dim(0) x Dim(1) x Dim(2) voxels
+	void SetRegion(const VolumeRegion& region) { m_Region = region; }
 	/// returns array as if it were a float[16] array
 	/// transform is stored in row-major, i.e. column fastest
 	float* GetImageTransform() { return m_ImageTransform[0]; }
@@ -101,6 +107,12 @@ public:
 	int ParseHDF();
 	int Read();
 
+	/// Number of downsampled levels stored in the file, 0 if there is no preview, see XdmfImageWriter::WritePreview
+	int GetPreviewLevels() const;
+	/// Read the source and tissues of a preview level into the image and tissue slices, which must hold
+	/// the level's VolumePyramid::Dims. The target is not part of the preview.
+	int ReadPreview(int level);
+
 	std::shared_ptr<ColorLookupTable> ReadColorLookup() const;
 
 private:
@@ -115,6 +127,7 @@ private:
 	float** m_ImageSlices;
 	float** m_WorkSlices;
 	tissues_size_t** m_TissueSlices;
+	VolumeRegion m_Region;
 	QStringList m_ArrayNames;
 	QMap<QString, QString> m_MapArrayNames;
 };
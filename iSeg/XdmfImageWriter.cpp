@@ -11,10 +11,13 @@
 
 #include "XdmfImageWriter.h"
 
+#include "Data/ProgressInfo.h"
 #include "Data/ScopedTimer.h"
 
 #include "Core/ColorLookupTable.h"
+#include "Core/HDF5Reader.h"
 #include "Core/HDF5Writer.h"
+#include "Core/VolumePyramid.h"
 
 #include <QDir>
 #include <QDomDocument>
@@ -34,6 +37,70 @@
 
 namespace iseg {
 
+namespace {
+/// Checks that the file holds the volume datasets of a project and lists the other objects, which are written again
+bool CheckProjectFile(const std::string& fname, HDF5Reader::size_type num_values, std::vector<std::string>& others)
+{
+	HDF5Reader reader;
+	if (!reader.Open(fname))
+	{
+		return false;
+	}
+
+	std::string const tissue_type = sizeof(tissues_size_t) == 1 ? "unsigned char" : "unsigned short";
+	int found = 0;
+	for (const auto& name : reader.GetGroupInfo("/"))
+	{
+		if (name == "Preview")
+		{
+			// updated by WritePreview
+			continue;
+		}
+		if (name == "Source" || name == "Target" || name == "Tissue")
+		{
+			std::string type;
+			std::vector<HDF5Reader::size_type> dims;
+			if (!reader.GetDatasetInfo(type, dims, name) || HDF5Reader::TotalSize(dims) != num_values ||
+					type != (name == "Tissue" ? tissue_type : std::string("float")))
+			{
+				return false;
+			}
+			found++;
+		}
+		else
+		{
+			others.push_back(name);
+		}
+	}
+	return found == 3;
+}
+
+/// Checks that the file holds a preview of a volume of the given dimensions, see WritePreview
+bool CheckPreview(HDF5Reader& reader, const VolumePyramid::dims_type& dims, int levels)
+{
+	int stored = 0;
+	if (!reader.Exists("/Preview/levels") || !reader.Read(&stored, "/Preview/levels") || stored != levels)
+	{
+		return false;
+	}
+	for (int level = 1; level <= levels; level++)
+	{
+		auto const level_dims = VolumePyramid::Dims(dims, level);
+		auto const num_values = static_cast<HDF5Reader::size_type>(level_dims[0]) * level_dims[1] * level_dims[2];
+		for (const std::string& name : {"/Preview/Source", "/Preview/Tissue"})
+		{
+			std::string type;
+			std::vector<HDF5Reader::size_type> dataset_dims;
+			if (!reader.GetDatasetInfo(type, dataset_dims, name + std::to_string(level)) || HDF5Reader::TotalSize(dataset_dims) != num_values)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+} // namespace
+
 XdmfImageWriter::XdmfImageWriter()
 {
 	this->m_NumberOfSlices = 0;
@@ -44,8 +111,9 @@ XdmfImageWriter::XdmfImageWriter()
 	this->m_ImageSlices = nullptr;
 	this->m_WorkSlices = nullptr;
 	this->m_TissueSlices = nullptr;
+	this->m_Append = false;
+	this->m_Progress = nullptr;
 	this->m_FileName = nullptr;
-	this->m_CopyToContiguousMemory = false;
 }
 
 XdmfImageWriter::XdmfImageWriter(const char* filepath) : XdmfImageWriter()
@@ -130,135 +198,269 @@ bool XdmfImageWriter::WriteColorLookup(const ColorLookupTable* lut, bool naked)
 	return true;
 }
 
-int XdmfImageWriter::InternalWrite(const char* filename, float** slicesbmp, float** sliceswork, tissues_size_t** slicestissue, unsigned nrslices, unsigned width, unsigned height, float* pixelsize, Transform& transform, int compression, bool naked)
+bool XdmfImageWriter::WritePreview(float** slicesbmp, tissues_size_t** slicestissue, const std::vector<bool>& modified, size_t* rewritten)
 {
-	QString q_file_name(filename);
-	QFileInfo file_info(q_file_name);
-	QString basename = file_info.completeBaseName();
-	QString suffix = file_info.suffix();
-
-	// save working directory
-	QDir oldcwd = QDir::current();
-
-	std::string abc(file_info.absolutePath().toStdString());
-
-	// enter the xmf file folder so relative names for hdf5 files work
-	QDir::setCurrent(file_info.absolutePath());
-
-	const size_t n = (size_t)width * (size_t)height * (size_t)nrslices;
+	VolumePyramid::dims_type const dims = {m_Width, m_Height, m_NumberOfSlices};
+	int const levels = VolumePyramid::NumLevels(dims);
+	if (rewritten)
+	{
+		*rewritten = 0;
+	}
 
-	std::vector<HDF5Writer::size_type> dims(3);
-	dims[0] = width;
-	dims[1] = height;
-	dims[2] = nrslices;
+	ScopedTimer timer("WritePreview");
 
-	ISEG_INFO("Writing " << filename << ": " << width << " x " << height << " x " << nrslices);
+	QFileInfo file_info(m_FileName);
+	std::string const fname = file_info.dir().absoluteFilePath(file_info.completeBaseName() + ".h5").toStdString();
 
-	HDF5Writer writer;
-	writer.m_ChunkSize.resize(1, width * height);
-	QString fname;
-	if (naked)
-		fname = basename + "." + suffix;
-	else
-		fname = basename + ".h5";
-	if (!writer.Open(fname.toStdString().c_str()))
-	{
-		ISEG_ERROR("opening " << fname.toStdString());
-	}
-	writer.m_Compression = compression;
+	HDF5Reader reader;
+	bool const exists = reader.Open(fname) && reader.Exists("/Preview");
+	bool update = exists && modified.size() == m_NumberOfSlices && CheckPreview(reader, dims, levels);
 
-	// The slices are not contiguous in memory so we need to copy.
-	if (this->m_CopyToContiguousMemory)
-	{
-		// Source
-		std::vector<float> buffer_float;
-		try
-		{
-			// vector throws a length_error if resized above max_size
-			ISEG_INFO("N = " << n << ", bufferFloat.max_size() = " << buffer_float.max_size());
-			buffer_float.resize(n);
-		}
-		catch (std::exception& le)
-		{
-			ISEG_ERROR_MSG(le.what());
-			return 0;
-		}
+	// all levels are kept until they are written, a level is reduced from the previous one
+	std::vector<std::vector<float>> source_levels(levels + 1);
+	std::vector<std::vector<tissues_size_t>> tissue_levels(levels + 1);
+	std::vector<std::vector<float*>> source(levels + 1);
+	std::vector<std::vector<tissues_size_t*>> tissue(levels + 1);
+	std::vector<std::vector<bool>> dirty(levels + 1);
+	source[0].assign(slicesbmp, slicesbmp + m_NumberOfSlices);
+	tissue[0].assign(slicestissue, slicestissue + m_NumberOfSlices);
 
-		for (size_t n = 0, k = 0; k < nrslices; k++)
+	auto reduce = [&]() {
+		dirty[0] = update ? modified : std::vector<bool>(m_NumberOfSlices, true);
+		for (int level = 1; level <= levels; level++)
 		{
-			size_t pos = 0;
-			for (unsigned j = 0; j < height; j++)
+			auto const in_dims = VolumePyramid::Dims(dims, level - 1);
+			auto const out_dims = VolumePyramid::Dims(dims, level);
+			size_t const slice_size = static_cast<size_t>(out_dims[0]) * out_dims[1];
+			source_levels[level].resize(slice_size * out_dims[2]);
+			tissue_levels[level].resize(slice_size * out_dims[2]);
+			source[level].resize(out_dims[2]);
+			tissue[level].resize(out_dims[2]);
+			dirty[level].assign(out_dims[2], false);
+			std::vector<int> todo;
+			for (unsigned k = 0; k < out_dims[2]; k++)
 			{
-				for (unsigned i = 0; i < width; i++, pos++)
-				{
-					buffer_float[n] = slicesbmp[k][pos];
-					n++;
-				}
+				source[level][k] = source_levels[level].data() + k * slice_size;
+				tissue[level][k] = tissue_levels[level].data() + k * slice_size;
+				dirty[level][k] = dirty[level - 1][2 * k] || (2 * k + 1 < in_dims[2] && dirty[level - 1][2 * k + 1]);
+				if (dirty[level][k])
+					todo.push_back(static_cast<int>(k));
 			}
-		}
 
-		if (!writer.Write(buffer_float, "Source"))
-		{
-			ISEG_ERROR_MSG("writing Source");
-		}
-
-		// Target
-		if (sliceswork != nullptr)
-		{
-			for (size_t n = 0, k = 0; k < nrslices; k++)
+			// slices of the previous level, which did not change but are reduced with a modified one, are read from the file
+			if (update && level > 1)
 			{
-				size_t pos = 0;
-				for (unsigned j = 0; j < height; j++)
+				size_t const in_slice_size = static_cast<size_t>(in_dims[0]) * in_dims[1];
+				std::vector<float*> source_in(in_dims[2], nullptr);
+				std::vector<tissues_size_t*> tissue_in(in_dims[2], nullptr);
+				for (int k : todo)
 				{
-					for (unsigned i = 0; i < width; i++, pos++)
+					for (unsigned z = 2 * k; z < std::min(2 * k + 2u, in_dims[2]); z++)
 					{
-						buffer_float[n] = sliceswork[k][pos];
-						n++;
+						if (!dirty[level - 1][z])
+						{
+							source_in[z] = source[level - 1][z];
+							tissue_in[z] = tissue[level - 1][z];
+						}
 					}
 				}
+				std::string const suffix = std::to_string(level - 1);
+				if (!reader.ReadChunks(source_in.data(), in_dims[2], in_slice_size, "/Preview/Source" + suffix) ||
+						!reader.ReadChunks(tissue_in.data(), in_dims[2], in_slice_size, "/Preview/Tissue" + suffix))
+				{
+					return false;
+				}
 			}
 
-			if (!writer.Write(buffer_float, "Target"))
+			if (!update)
 			{
-				ISEG_ERROR_MSG("writing Target");
+				VolumePyramid::Average(source[level - 1].data(), in_dims, source[level].data());
+				VolumePyramid::Mode(tissue[level - 1].data(), in_dims, tissue[level].data());
+				continue;
+			}
+#pragma omp parallel for
+			for (int i = 0; i < static_cast<int>(todo.size()); i++)
+			{
+				unsigned const z0 = 2 * todo[i];
+				VolumePyramid::dims_type const block = {in_dims[0], in_dims[1], std::min(2u, in_dims[2] - z0)};
+				VolumePyramid::Average(source[level - 1].data() + z0, block, source[level].data() + todo[i]);
+				VolumePyramid::Mode(tissue[level - 1].data() + z0, block, tissue[level].data() + todo[i]);
 			}
 		}
+		return true;
+	};
+	if (!reduce())
+	{
+		// e.g. the preview cannot be read chunk by chunk
+		update = false;
+		reduce();
+	}
+	reader.Close();
 
-		buffer_float.clear();
+	HDF5Writer writer;
+	if (!writer.Open(fname, "append"))
+	{
+		ISEG_ERROR("opening " << fname);
+		return false;
+	}
+	writer.m_Compression = m_Compression;
 
-		// Tissue
-		std::vector<tissues_size_t> buffer_tissues_size_t;
-		try
-		{
-			// vector throws a length_error if resized above max_size
-			ISEG_INFO("N = " << n << ", bufferTissuesSizeT.max_size() = " << buffer_tissues_size_t.max_size());
-			buffer_tissues_size_t.resize(n);
-		}
-		catch (std::exception& le)
-		{
-			ISEG_ERROR_MSG(le.what());
-			return 0;
-		}
+	bool ok = true;
+	if (!update)
+	{
+		// e.g. the preview of a volume with other dimensions
+		if (exists)
+			writer.Remove("/Preview");
+		ok = writer.CreateGroup("/Preview") != 0;
+		std::vector<HDF5Writer::size_type> dim_scalar(1, 1);
+		ok = ok && writer.Write(&levels, dim_scalar, "/Preview/levels");
+	}
 
-		for (size_t n = 0, k = 0; k < nrslices; k++)
+	// only the modified slices of each level are written, the others are kept in the file
+	size_t written = 0;
+	for (int level = 1; level <= levels && ok; level++)
+	{
+		auto const out_dims = VolumePyramid::Dims(dims, level);
+		size_t const slice_size = static_cast<size_t>(out_dims[0]) * out_dims[1];
+		for (unsigned k = 0; k < out_dims[2]; k++)
 		{
-			size_t pos = 0;
-			for (unsigned j = 0; j < height; j++)
+			if (!dirty[level][k])
 			{
-				for (unsigned i = 0; i < width; i++, pos++)
-				{
-					buffer_tissues_size_t[n] = slicestissue[k][pos];
-					n++;
-				}
+				source[level][k] = nullptr;
+				tissue[level][k] = nullptr;
+			}
+			else
+			{
+				written += 2 * slice_size;
 			}
 		}
 
-		if (!writer.Write(buffer_tissues_size_t, "Tissue"))
+		std::string const suffix = std::to_string(level);
+		ok = ok && writer.Write(source[level].data(), out_dims[2], slice_size, "/Preview/Source" + suffix);
+		ok = ok && writer.Write(tissue[level].data(), out_dims[2], slice_size, "/Preview/Tissue" + suffix);
+	}
+	writer.Close();
+
+	// rewritten chunks may be appended to the file like modified slices of the volume, see SlicesHandler::PrepareIncrementalSave
+	size_t const area = static_cast<size_t>(m_Width) * m_Height;
+	if (update && rewritten && area > 0)
+	{
+		*rewritten = (written + area - 1) / area;
+	}
+
+	if (!ok)
+	{
+		ISEG_ERROR("writing preview into " << fname);
+	}
+	return ok;
+}
+
+bool XdmfImageWriter::PrepareFile(const char* filename, bool update, unsigned nrslices, unsigned width, unsigned height, const std::string& from)
+{
+	QFileInfo file_info(filename);
+	std::string const fname = file_info.dir().absoluteFilePath(file_info.completeBaseName() + ".h5").toStdString();
+	bool const copy = update && !from.empty() && from != fname;
+
+	std::vector<std::string> others;
+	if (update && !CheckProjectFile(copy ? from : fname, static_cast<HDF5Reader::size_type>(width) * height * nrslices, others))
+	{
+		ISEG_WARNING("cannot update " << (copy ? from : fname) << ", it does not hold this volume");
+		return false;
+	}
+	if (copy)
+	{
+		others.clear();
+	}
+
+	HDF5Writer writer;
+	if (!writer.Open(fname, update && !copy ? "append" : "overwrite"))
+	{
+		ISEG_ERROR("opening " << fname);
+		return false;
+	}
+	// only the modified slices are written, the remaining small objects are written again
+	for (const auto& name : others)
+	{
+		writer.Remove(name);
+	}
+	writer.Close();
+	return true;
+}
+
+bool XdmfImageWriter::CopyVolume(const char* filename, const std::string& from)
+{
+	QFileInfo file_info(filename);
+	std::string const fname = file_info.dir().absoluteFilePath(file_info.completeBaseName() + ".h5").toStdString();
+	if (from.empty() || from == fname)
+		return true;
+
+	ScopedTimer timer("Copy volume");
+	HDF5Writer writer;
+	if (!writer.Open(fname, "append"))
+	{
+		ISEG_ERROR("opening " << fname);
+		return false;
+	}
+	std::vector<std::string> copied;
+	for (std::string name : {"Source", "Target", "Tissue"})
+	{
+		if (!writer.Copy(from, name))
 		{
-			ISEG_ERROR_MSG("writing Tissue");
+			// the volume is written completely instead
+			for (const auto& c : copied)
+			{
+				writer.Remove(c);
+			}
+			return false;
 		}
+		copied.push_back(name);
+	}
+
+	// the preview is written completely if it is missing
+	HDF5Reader reader;
+	bool const has_preview = reader.Open(from) && reader.Exists("/Preview");
+	reader.Close();
+	if (has_preview)
+	{
+		writer.Copy(from, "/Preview");
+	}
+	return true;
+}
+
+int XdmfImageWriter::InternalWrite(const char* filename, float** slicesbmp, float** sliceswork, tissues_size_t** slicestissue, unsigned nrslices, unsigned width, unsigned height, float* pixelsize, Transform& transform, int compression, bool naked)
+{
+	QString q_file_name(filename);
+	QFileInfo file_info(q_file_name);
+	QString basename = file_info.completeBaseName();
+
+	std::vector<HDF5Writer::size_type> dims(3);
+	dims[0] = width;
+	dims[1] = height;
+	dims[2] = nrslices;
+
+	ISEG_INFO("Writing " << filename << ": " << width << " x " << height << " x " << nrslices);
+
+	// absolute paths instead of changing the working directory, the writer may run on a worker thread
+	HDF5Writer writer;
+	writer.m_ChunkSize.resize(1, width * height);
+	QString fname;
+	if (naked)
+		fname = file_info.absoluteFilePath();
+	else
+		fname = file_info.dir().absoluteFilePath(basename + ".h5");
+
+	if (!writer.Open(fname.toStdString().c_str(), m_Append ? "append" : "overwrite"))
+	{
+		ISEG_ERROR("opening " << fname.toStdString());
+	}
+	writer.m_Compression = compression;
+	writer.m_Progress = m_Progress;
+	if (m_Progress)
+	{
+		m_Progress->SetNumberOfSteps(static_cast<int>(nrslices * (sliceswork ? 3 : 2)));
 	}
-	else // write slice-by-slice
+
+	// the slices are compressed in parallel and written chunk by chunk, i.e. they need not be contiguous
 	{
 		ScopedTimer timer("Write Source");
 		if (!writer.Write(slicesbmp, nrslices, dims[0] * dims[1], "Source"))
@@ -279,7 +481,7 @@ int XdmfImageWriter::InternalWrite(const char* filename, float** slicesbmp, floa
 
 	float offset[3], dc[6];
 	transform.GetOffset(offset);
-	for (unsigned short i = 0; i < 3; i++)
+	for (unsigned i = 0; i < 3; i++)
 	{
 		dc[i] = transform[i][0];
 		dc[i + 3] = transform[i][1];
@@ -435,7 +637,7 @@ int XdmfImageWriter::InternalWrite(const char* filename, float** slicesbmp, floa
 		attribute.appendChild(dataitem);
 		grid.appendChild(attribute);
 
-		QFile file(q_file_name);
+		QFile file(file_info.absoluteFilePath());
 		if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
 			return 0;
 
@@ -444,9 +646,6 @@ int XdmfImageWriter::InternalWrite(const char* filename, float** slicesbmp, floa
 		file.close();
 	}
 
-	// restore working directory
-	QDir::setCurrent(oldcwd.absolutePath());
-
 	return 1;
 }
 
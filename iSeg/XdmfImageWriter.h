@@ -15,9 +15,13 @@
 
 #include "Core/SetGetMacros.h"
 
+#include <string>
+#include <vector>
+
 namespace iseg {
 
 class ColorLookupTable;
+class ProgressInfo;
 
 class XdmfImageWriter
 {
@@ -45,12 +49,31 @@ public:
 	GetMacro(WorkSlices, float**);
 	SetMacro(TissueSlices, tissues_size_t**);
 	GetMacro(TissueSlices, tissues_size_t**);
-	SetMacro(CopyToContiguousMemory, bool);
-	GetMacro(CopyToContiguousMemory, bool);
+	/// Write the volume into the existing file, e.g. prepared by PrepareFile. Slices which are nullptr are kept.
+	SetMacro(Append, bool);
+	GetMacro(Append, bool);
+	/// Incremented for every slice written, may be used from a worker thread
+	SetMacro(Progress, ProgressInfo*);
+	GetMacro(Progress, ProgressInfo*);
 	bool Write(bool naked = false);
 
+	/// Prepare the h5 file of the project 'filename' for writing the volume with Append. With update the volume datasets,
+	/// which must be of the same size, are kept and all other objects are removed, otherwise the file is truncated.
+	/// With update and a file 'from', the volume datasets are checked in 'from' and the file is truncated, see CopyVolume.
+	static bool PrepareFile(const char* filename, bool update, unsigned nrslices, unsigned width, unsigned height, const std::string& from = std::string());
+	/// Copy the volume datasets of the h5 file 'from' into the h5 file of the project 'filename', e.g. after PrepareFile.
+	/// The compressed chunks are copied as they are, i.e. the whole volume is read and written, but not compressed again.
+	/// Does nothing if 'from' is empty or the h5 file itself.
+	static bool CopyVolume(const char* filename, const std::string& from);
+
 	bool WriteColorLookup(const ColorLookupTable* lut, bool naked = false);
 
+	/// Write downsampled copies of the source and tissues into the group /Preview of the project's h5 file, see VolumePyramid.
+	/// The slices must all be given, i.e. also when the volume itself is written with Append. If the file holds a preview of
+	/// this volume, only the blocks of the slices flagged in modified are reduced and written again. The number of slices
+	/// rewritten in the existing preview, in slice arrays of the volume, is returned in rewritten.
+	bool WritePreview(float** slicesbmp, tissues_size_t** slicestissue, const std::vector<bool>& modified = std::vector<bool>(), size_t* rewritten = nullptr);
+
 protected:
 	char* m_FileName;
 	unsigned m_NumberOfSlices;
@@ -62,7 +85,8 @@ protected:
 	float** m_ImageSlices;
 	float** m_WorkSlices;
 	tissues_size_t** m_TissueSlices;
-	bool m_CopyToContiguousMemory;
+	bool m_Append;
+	ProgressInfo* m_Progress;
 
 private:
 	int InternalWrite(const char* filename, float** slicesbmp, float** sliceswork, tissues_size_t** slicestissue, unsigned nrslices, unsigned width, unsigned height, float* pixelsize, Transform& transform, int compression, bool naked);
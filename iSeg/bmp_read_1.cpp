@@ -37,6 +37,7 @@
 #include <QImage>
 #include <QMessageBox>
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <cmath>
@@ -45,6 +46,8 @@
 #include <fstream>
 #include <iostream>
 #include <list>
+#include <map>
+#include <mutex>
 #include <queue>
 #include <stack>
 #include <vector>
@@ -61,10 +64,10 @@ namespace iseg {
 #ifndef WIN32
 struct BITMAPFILEHEADER /**** BMP file header structure ****/
 {
-	unsigned short bfType;			/* Magic number for file */
+	unsigned bfType;			/* Magic number for file */
 	unsigned int bfSize;				/* Size of file */
-	unsigned short bfReserved1; /* Reserved */
-	unsigned short bfReserved2; /* ... */
+	unsigned bfReserved1; /* Reserved */
+	unsigned bfReserved2; /* ... */
 	unsigned int bfOffBits;			/* Offset to bitmap data */
 };
 
@@ -75,8 +78,8 @@ struct BITMAPINFOHEADER /**** BMP file info structure ****/
 	unsigned int biSize;				 /* Size of info header */
 	int biWidth;								 /* Width of image */
 	int biHeight;								 /* Height of image */
-	unsigned short biPlanes;		 /* Number of color planes */
-	unsigned short biBitCount;	 /* Number of bits per pixel */
+	unsigned biPlanes;		 /* Number of color planes */
+	unsigned biBitCount;	 /* Number of bits per pixel */
 	unsigned int biCompression;	 /* Type of compression to use */
 	unsigned int biSizeImage;		 /* Size of image data */
 	int biXPelsPerMeter;				 /* X pixels per meter */
@@ -114,10 +117,7 @@ inline void swap_maps(T const*& Tp1, T const*& Tp2)
 	Tp2 = dummy;
 }
 
-std::list<unsigned> Bmphandler::stackindex;
-unsigned Bmphandler::stackcounter;
-std::list<float*> Bmphandler::bits_stack;
-std::list<unsigned char> Bmphandler::mode_stack;
+ImageStack Bmphandler::image_stack;
 //bool Bmphandler::lockedtissues[TISSUES_SIZE_MAX+1];
 
 Bmphandler::Bmphandler()
@@ -126,7 +126,6 @@ Bmphandler::Bmphandler()
 	m_Loaded = false;
 	m_Ownsliceprovider = false;
 	m_SliceprovideInstaller = SliceProviderInstaller::Getinst();
-	stackcounter = 1;
 	m_Mode1 = m_Mode2 = 1;
 }
 
@@ -136,7 +135,6 @@ Bmphandler::Bmphandler(const Bmphandler&)
 	m_Loaded = false;
 	m_Ownsliceprovider = false;
 	m_SliceprovideInstaller = SliceProviderInstaller::Getinst();
-	stackcounter = 1;
 	m_Mode1 = m_Mode2 = 1;
 
 	m_RedFactor = 0.299;
@@ -148,46 +146,391 @@ Bmphandler::~Bmphandler()
 {
 	if (m_Loaded)
 	{
-		ClearStack();
-		m_Sliceprovide->TakeBack(m_BmpBits);
-		m_Sliceprovide->TakeBack(m_WorkBits);
-		m_Sliceprovide->TakeBack(m_HelpBits);
-		for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-		{
-			free(m_Tissuelayers[idx]);
-		}
-		m_Tissuelayers.clear();
-		//		if(ownsliceprovider)
-		m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
-		//		free(bmpinfo);
+		ReleaseBits();
 	}
 	m_SliceprovideInstaller->ReturnInstance();
 	if (m_SliceprovideInstaller->Unused())
 		delete m_SliceprovideInstaller;
 }
 
+void Bmphandler::Recycle(float* bits)
+{
+	// a shared buffer is owned by the snapshot once the slice drops it
+	if (bits != nullptr && (bits == m_SharedBmp || bits == m_SharedWork))
+	{
+		(bits == m_SharedBmp ? m_SharedBmp : m_SharedWork) = nullptr;
+		return;
+	}
+	// memory of an attached storage is not owned by the slice provider
+	if (!IsStorage(bits))
+		m_Sliceprovide->TakeBack(bits);
+}
+
+bool Bmphandler::IsStorage(const tissues_size_t* bits) const
+{
+	return bits != nullptr && std::find(m_TissueViews.begin(), m_TissueViews.end(), bits) != m_TissueViews.end();
+}
+
+void Bmphandler::FreeTissues(tissues_size_t* bits)
+{
+	if (bits != nullptr && bits == m_SharedTissues)
+	{
+		m_SharedTissues = nullptr;
+		return;
+	}
+	if (!IsStorage(bits))
+		free(bits);
+}
+
+float* Bmphandler::ShareBmp()
+{
+	// a buffer is shared with one snapshot only, a second one gets its own copy
+	if (IsStorage(m_BmpBits) || m_SharedBmp != nullptr)
+		return CopyBmp();
+	m_SharedBmp = m_BmpBits;
+	return m_BmpBits;
+}
+
+float* Bmphandler::ShareWork()
+{
+	if (m_WorkBits == nullptr)
+		return nullptr;
+	if (IsStorage(m_WorkBits) || m_SharedWork != nullptr)
+		return CopyWork();
+	m_SharedWork = m_WorkBits;
+	return m_WorkBits;
+}
+
+tissues_size_t* Bmphandler::ShareTissues(tissuelayers_size_t idx)
+{
+	tissues_size_t* tissues = TissueLayer(idx);
+	if (IsStorage(tissues) || m_SharedTissues != nullptr)
+		return CopyTissue(idx);
+	m_SharedTissues = tissues;
+	return tissues;
+}
+
+bool Bmphandler::EndShare(const void* bits)
+{
+	if (bits == nullptr)
+		return false;
+	if (bits == m_SharedBmp)
+	{
+		m_SharedBmp = nullptr;
+		return true;
+	}
+	if (bits == m_SharedWork)
+	{
+		m_SharedWork = nullptr;
+		return true;
+	}
+	if (bits == m_SharedTissues)
+	{
+		m_SharedTissues = nullptr;
+		return true;
+	}
+	return false;
+}
+
+void Bmphandler::CopyShared()
+{
+	// the snapshot keeps the old buffer, the slice continues on a copy
+	if (m_SharedBmp != nullptr)
+	{
+		if (m_BmpBits == m_SharedBmp)
+		{
+			m_BmpBits = m_Sliceprovide->GiveMe();
+			std::copy(m_SharedBmp, m_SharedBmp + m_Area, m_BmpBits);
+		}
+		m_SharedBmp = nullptr;
+	}
+	if (m_SharedWork != nullptr)
+	{
+		if (m_WorkBits == m_SharedWork)
+		{
+			m_WorkBits = m_Sliceprovide->GiveMe();
+			std::copy(m_SharedWork, m_SharedWork + m_Area, m_WorkBits);
+		}
+		m_SharedWork = nullptr;
+	}
+	if (m_SharedTissues != nullptr)
+	{
+		for (auto& tissues : m_Tissuelayers)
+		{
+			if (tissues == m_SharedTissues)
+			{
+				tissues = (tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area);
+				std::copy(m_SharedTissues, m_SharedTissues + m_Area, tissues);
+			}
+		}
+		m_SharedTissues = nullptr;
+	}
+}
+
+void Bmphandler::FreeBits()
+{
+	Recycle(m_BmpBits);
+	Recycle(m_WorkBits);
+	Recycle(m_HelpBits);
+	m_BmpBits = m_WorkBits = m_HelpBits = nullptr;
+	for (auto tissues : m_Tissuelayers)
+	{
+		FreeTissues(tissues);
+	}
+	m_Tissuelayers.clear();
+	m_PackedTissues.clear();
+	m_PagedOut = false;
+	m_BmpView = m_WorkView = nullptr;
+	m_TissueViews.clear();
+}
+
+void Bmphandler::ReleaseBits()
+{
+	ClearStack();
+	FreeBits();
+	m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
+}
+
+void Bmphandler::AttachStorage(float* bmp, float* work, const std::vector<tissues_size_t*>& tissues)
+{
+	if (!m_Loaded)
+		return;
+
+	// if already attached, the data is moved from the old to the new storage
+	SyncStorage();
+	UnpackTissues();
+
+	std::copy(m_BmpBits, m_BmpBits + m_Area, bmp);
+	if (m_WorkBits)
+		std::copy(m_WorkBits, m_WorkBits + m_Area, work);
+	else
+		std::fill(work, work + m_Area, 0.f);
+	Recycle(m_BmpBits);
+	Recycle(m_WorkBits);
+
+	std::vector<tissues_size_t*> tissue_views;
+	for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size() && idx < tissues.size(); ++idx)
+	{
+		std::copy(m_Tissuelayers[idx], m_Tissuelayers[idx] + m_Area, tissues[idx]);
+		FreeTissues(m_Tissuelayers[idx]);
+		m_Tissuelayers[idx] = tissues[idx];
+		tissue_views.push_back(tissues[idx]);
+	}
+
+	m_BmpBits = m_BmpView = bmp;
+	m_WorkBits = m_WorkView = work;
+	m_TissueViews = tissue_views;
+}
+
+void Bmphandler::DetachStorage()
+{
+	if (!HasStorage())
+		return;
+
+	SyncStorage();
+
+	m_BmpBits = m_Sliceprovide->GiveMe();
+	std::copy(m_BmpView, m_BmpView + m_Area, m_BmpBits);
+	m_WorkBits = m_Sliceprovide->GiveMe();
+	std::copy(m_WorkView, m_WorkView + m_Area, m_WorkBits);
+	for (tissuelayers_size_t idx = 0; idx < m_TissueViews.size(); ++idx)
+	{
+		m_Tissuelayers[idx] = (tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area);
+		std::copy(m_TissueViews[idx], m_TissueViews[idx] + m_Area, m_Tissuelayers[idx]);
+	}
+
+	m_BmpView = m_WorkView = nullptr;
+	m_TissueViews.clear();
+}
+
+bool Bmphandler::StorageInSync() const
+{
+	if (!HasStorage())
+		return true;
+	if (m_BmpBits != m_BmpView || m_WorkBits != m_WorkView)
+		return false;
+	for (tissuelayers_size_t idx = 0; idx < m_TissueViews.size(); ++idx)
+	{
+		if (m_Tissuelayers[idx] != m_TissueViews[idx])
+			return false;
+	}
+	return true;
+}
+
+void Bmphandler::SyncStorage()
+{
+	if (StorageInSync())
+		return;
+
+	// Many filters swap or replace the bmp/work/help pointers. Move the data back into
+	// the storage, such that source and target are contiguous again.
+	float** slots[] = {&m_BmpBits, &m_WorkBits, &m_HelpBits};
+	float* views[] = {m_BmpView, m_WorkView};
+	for (int k = 0; k < 2; ++k)
+	{
+		float*& bits = *slots[k];
+		if (bits == views[k])
+			continue;
+
+		auto holder = std::find_if(std::begin(slots), std::end(slots), [&](float** s) { return *s == views[k]; });
+		if (holder != std::end(slots))
+		{
+			std::swap_ranges(bits, bits + m_Area, views[k]);
+			**holder = bits;
+		}
+		else
+		{
+			std::copy(bits, bits + m_Area, views[k]);
+			Recycle(bits);
+		}
+		bits = views[k];
+	}
+
+	for (tissuelayers_size_t idx = 0; idx < m_TissueViews.size(); ++idx)
+	{
+		if (m_Tissuelayers[idx] != m_TissueViews[idx])
+		{
+			std::copy(m_Tissuelayers[idx], m_Tissuelayers[idx] + m_Area, m_TissueViews[idx]);
+			free(m_Tissuelayers[idx]);
+			m_Tissuelayers[idx] = m_TissueViews[idx];
+		}
+	}
+}
+
+bool Bmphandler::PackTissues()
+{
+	if (!m_Loaded || m_PagedOut || HasStorage() || m_TissuePins > 0 || m_SharedTissues != nullptr)
+		return false;
+	if (TissuesPacked())
+		return true;
+
+	std::vector<CompressedLabelSlice> packed(m_Tissuelayers.size());
+	for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
+	{
+		packed[idx].Compress(m_Tissuelayers[idx], m_Width, m_Height);
+		free(m_Tissuelayers[idx]);
+		m_Tissuelayers[idx] = nullptr;
+	}
+	m_PackedTissues.swap(packed);
+	return true;
+}
+
+void Bmphandler::UnpackTissues() const
+{
+	for (tissuelayers_size_t idx = 0; idx < m_PackedTissues.size(); ++idx)
+	{
+		m_Tissuelayers[idx] = (tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area);
+		m_PackedTissues[idx].Decompress(m_Tissuelayers[idx]);
+	}
+	m_PackedTissues.clear();
+}
+
+void Bmphandler::PinTissues()
+{
+	UnpackTissues();
+	++m_TissuePins;
+}
+
+void Bmphandler::UnpinTissues()
+{
+	if (m_TissuePins > 0)
+		--m_TissuePins;
+}
+
+size_t Bmphandler::TissuesMemoryUsage() const
+{
+	if (TissuesPacked())
+	{
+		size_t bytes = 0;
+		for (const auto& packed : m_PackedTissues)
+			bytes += packed.MemoryUsage();
+		return bytes;
+	}
+	return m_Tissuelayers.size() * m_Area * sizeof(tissues_size_t);
+}
+
+void Bmphandler::PageOut()
+{
+	if (!CanPageOut())
+		return;
+
+	// free instead of returning the buffers to the slice provider, which would keep the memory
+	free(m_BmpBits);
+	free(m_WorkBits);
+	free(m_HelpBits);
+	m_BmpBits = m_WorkBits = m_HelpBits = nullptr;
+	for (auto& tissues : m_Tissuelayers)
+	{
+		free(tissues);
+		tissues = nullptr;
+	}
+	m_PackedTissues.clear();
+	m_PagedOut = true;
+}
+
+void Bmphandler::PageIn()
+{
+	if (!m_PagedOut)
+		return;
+
+	// target and help are allocated by the caller, if they are not zero
+	m_BmpBits = (float*)malloc(sizeof(float) * m_Area);
+	for (auto& tissues : m_Tissuelayers)
+	{
+		tissues = (tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area);
+	}
+	m_PagedOut = false;
+}
+
+float* Bmphandler::ZeroedBits()
+{
+	float* bits = m_Sliceprovide->GiveMe();
+	std::fill(bits, bits + m_Area, 0.f);
+	return bits;
+}
+
+const float* Bmphandler::ZeroSlice() const
+{
+	static std::mutex zero_slices_mutex;
+	static std::map<size_t, std::vector<float>> zero_slices;
+
+	std::lock_guard<std::mutex> lock(zero_slices_mutex);
+	auto& zeros = zero_slices[m_Area];
+	if (zeros.size() != m_Area)
+		zeros.assign(m_Area, 0.f);
+	return zeros.data();
+}
+
+bool Bmphandler::ReleaseWorkIfZero()
+{
+	if (m_WorkBits == nullptr)
+		return true;
+	if (IsStorage(m_WorkBits) || std::any_of(m_WorkBits, m_WorkBits + m_Area, [](float v) { return v != 0.f; }))
+		return false;
+
+	Recycle(m_WorkBits);
+	m_WorkBits = nullptr;
+	return true;
+}
+
 void Bmphandler::ClearStack()
 {
-	for (auto& b : bits_stack)
-		m_Sliceprovide->TakeBack(b);
-	bits_stack.clear();
-	stackindex.clear();
-	mode_stack.clear();
-	stackcounter = 1;
+	image_stack.Clear();
+	image_stack.SetNextId(1);
 }
 
 float* Bmphandler::ReturnBmp() { return m_BmpBits; }
 
 const float* Bmphandler::ReturnBmp() const { return m_BmpBits; }
 
-float* Bmphandler::ReturnWork() { return m_WorkBits; }
+float* Bmphandler::ReturnWork() { return WorkBits(); }
 
-const float* Bmphandler::ReturnWork() const { return m_WorkBits; }
+const float* Bmphandler::ReturnWork() const { return ReadWork(); }
 
 tissues_size_t* Bmphandler::ReturnTissues(tissuelayers_size_t idx)
 {
 	if (idx < m_Tissuelayers.size())
-		return m_Tissuelayers[idx];
+		return TissueLayer(idx);
 	else
 		return nullptr;
 }
@@ -195,20 +538,20 @@ tissues_size_t* Bmphandler::ReturnTissues(tissuelayers_size_t idx)
 const tissues_size_t* Bmphandler::ReturnTissues(tissuelayers_size_t idx) const
 {
 	if (idx < m_Tissuelayers.size())
-		return m_Tissuelayers[idx];
+		return TissueLayer(idx);
 	else
 		return nullptr;
 }
 
-float* Bmphandler::ReturnHelp() { return m_HelpBits; }
+float* Bmphandler::ReturnHelp() { return HelpBits(); }
 
 float** Bmphandler::ReturnBmpfield() { return &m_BmpBits; }
 
-float** Bmphandler::ReturnWorkfield() { return &m_WorkBits; }
+float** Bmphandler::ReturnWorkfield() { return &WorkBits(); }
 
 tissues_size_t** Bmphandler::ReturnTissuefield(tissuelayers_size_t idx)
 {
-	return &m_Tissuelayers[idx];
+	return &TissueLayer(idx);
 }
 
 std::vector<Mark>* Bmphandler::ReturnMarks() { return &m_Marks; }
@@ -236,8 +579,16 @@ void Bmphandler::SetBmp(float* bits, unsigned char mode)
 	{
 		if (m_BmpBits != bits)
 		{
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_BmpBits = bits;
+			if (IsStorage(m_BmpBits))
+			{
+				std::copy(bits, bits + m_Area, m_BmpBits);
+				Recycle(bits);
+			}
+			else
+			{
+				Recycle(m_BmpBits);
+				m_BmpBits = bits;
+			}
 			m_Mode1 = mode;
 		}
 	}
@@ -248,8 +599,16 @@ void Bmphandler::SetWork(float* bits, unsigned char mode)
 	{
 		if (m_WorkBits != bits)
 		{
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_WorkBits = bits;
+			if (IsStorage(m_WorkBits))
+			{
+				std::copy(bits, bits + m_Area, m_WorkBits);
+				Recycle(bits);
+			}
+			else
+			{
+				Recycle(m_WorkBits);
+				m_WorkBits = bits;
+			}
 			m_Mode2 = mode;
 		}
 	}
@@ -259,16 +618,30 @@ void Bmphandler::SetTissue(tissuelayers_size_t idx, tissues_size_t* bits)
 {
 	if (m_Loaded)
 	{
-		if (m_Tissuelayers[idx] != bits)
+		if (TissueLayer(idx) != bits)
 		{
-			free(m_Tissuelayers[idx]);
-			m_Tissuelayers[idx] = bits;
+			if (IsStorage(TissueLayer(idx)))
+			{
+				std::copy(bits, bits + m_Area, TissueLayer(idx));
+				free(bits);
+			}
+			else
+			{
+				FreeTissues(TissueLayer(idx));
+				TissueLayer(idx) = bits;
+			}
 		}
 	}
 }
 
 float* Bmphandler::SwapBmpPointer(float* bits)
 {
+	if (IsStorage(m_BmpBits))
+	{
+		// caller owns 'bits', so exchange the content instead
+		std::swap_ranges(bits, bits + m_Area, m_BmpBits);
+		return bits;
+	}
 	float* tmp = m_BmpBits;
 	m_BmpBits = bits;
 	return tmp;
@@ -276,15 +649,25 @@ float* Bmphandler::SwapBmpPointer(float* bits)
 
 float* Bmphandler::SwapWorkPointer(float* bits)
 {
-	float* tmp = m_WorkBits;
+	if (IsStorage(m_WorkBits))
+	{
+		std::swap_ranges(bits, bits + m_Area, m_WorkBits);
+		return bits;
+	}
+	float* tmp = WorkBits();
 	m_WorkBits = bits;
 	return tmp;
 }
 
 tissues_size_t* Bmphandler::SwapTissuesPointer(tissuelayers_size_t idx, tissues_size_t* bits)
 {
-	tissues_size_t* tmp = m_Tissuelayers[idx];
-	m_Tissuelayers[idx] = bits;
+	if (IsStorage(TissueLayer(idx)))
+	{
+		std::swap_ranges(bits, bits + m_Area, TissueLayer(idx));
+		return bits;
+	}
+	tissues_size_t* tmp = TissueLayer(idx);
+	TissueLayer(idx) = bits;
 	return tmp;
 }
 
@@ -302,8 +685,9 @@ void Bmphandler::Copy2work(float* bits, unsigned char mode)
 {
 	if (m_Loaded)
 	{
+		float* work = WorkBits();
 		for (unsigned i = 0; i < m_Area; i++)
-			m_WorkBits[i] = bits[i];
+			work[i] = bits[i];
 		m_Mode2 = mode;
 	}
 }
@@ -312,10 +696,11 @@ void Bmphandler::Copy2work(float* bits, bool* mask, unsigned char mode)
 {
 	if (m_Loaded)
 	{
+		float* work = WorkBits();
 		for (unsigned i = 0; i < m_Area; i++)
 		{
 			if (mask[i])
-				m_WorkBits[i] = bits[i];
+				work[i] = bits[i];
 		}
 		if (mode == 1)
 			m_Mode2 = 1;
@@ -326,7 +711,7 @@ void Bmphandler::Copy2tissue(tissuelayers_size_t idx, tissues_size_t* bits, bool
 {
 	if (m_Loaded)
 	{
-		tissues_size_t* tissues = m_Tissuelayers[idx];
+		tissues_size_t* tissues = TissueLayer(idx);
 		for (unsigned i = 0; i < m_Area; i++)
 		{
 			if (mask[i] && (!TissueInfos::GetTissueLocked(tissues[i])))
@@ -339,7 +724,7 @@ void Bmphandler::Copy2tissue(tissuelayers_size_t idx, tissues_size_t* bits)
 {
 	if (m_Loaded)
 	{
-		tissues_size_t* tissues = m_Tissuelayers[idx];
+		tissues_size_t* tissues = TissueLayer(idx);
 		for (unsigned i = 0; i < m_Area; i++)
 			tissues[i] = bits[i];
 	}
@@ -358,8 +743,9 @@ void Bmphandler::Copyfromwork(float* bits)
 {
 	if (m_Loaded)
 	{
+		float* work = WorkBits();
 		for (unsigned i = 0; i < m_Area; i++)
-			bits[i] = m_WorkBits[i];
+			bits[i] = work[i];
 	}
 }
 
@@ -367,7 +753,7 @@ void Bmphandler::Copyfromtissue(tissuelayers_size_t idx, tissues_size_t* bits)
 {
 	if (m_Loaded)
 	{
-		tissues_size_t* tissues = m_Tissuelayers[idx];
+		tissues_size_t* tissues = TissueLayer(idx);
 		for (unsigned i = 0; i < m_Area; i++)
 			bits[i] = tissues[i];
 	}
@@ -378,14 +764,14 @@ void Bmphandler::Copyfromtissue(tissuelayers_size_t idx, unsigned char* bits)
 {
 	if (m_Loaded)
 	{
-		tissues_size_t* tissues = m_Tissuelayers[idx];
+		tissues_size_t* tissues = TissueLayer(idx);
 		for (unsigned i = 0; i < m_Area; i++)
 			bits[i] = (unsigned char)tissues[i];
 	}
 }
 #endif // TISSUES_SIZE_TYPEDEF
 
-void Bmphandler::Copyfromtissuepadded(tissuelayers_size_t idx, tissues_size_t* bits, unsigned short padding)
+void Bmphandler::Copyfromtissuepadded(tissuelayers_size_t idx, tissues_size_t* bits, unsigned padding)
 {
 	if (m_Loaded)
 	{
@@ -394,14 +780,14 @@ void Bmphandler::Copyfromtissuepadded(tissuelayers_size_t idx, tissues_size_t* b
 		for (; pos1 < (unsigned int)(m_Width + 2 * padding) * padding + padding;
 				 pos1++)
 			bits[pos1] = 0;
-		tissues_size_t* tissues = m_Tissuelayers[idx];
-		for (unsigned short j = 0; j < m_Height; j++)
+		tissues_size_t* tissues = TissueLayer(idx);
+		for (unsigned j = 0; j < m_Height; j++)
 		{
-			for (unsigned short i = 0; i < m_Width; i++, pos1++, pos2++)
+			for (unsigned i = 0; i < m_Width; i++, pos1++, pos2++)
 			{
 				bits[pos1] = tissues[pos2];
 			}
-			for (unsigned short i = 0; i < 2 * padding; i++, pos1++)
+			for (unsigned i = 0; i < 2 * padding; i++, pos1++)
 				bits[pos1] = 0;
 		}
 		unsigned int maxval = m_Area + 2 * padding * m_Width +
@@ -415,14 +801,13 @@ void Bmphandler::ClearBmp()
 {
 	for (unsigned int i = 0; i < m_Area; i++)
 		m_BmpBits[i] = 0;
-
-	delete m_BmpBits;
 }
 
 void Bmphandler::ClearWork()
 {
-	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] = 0;
+	// an unallocated target is zero already
+	if (m_WorkBits)
+		std::fill(m_WorkBits, m_WorkBits + m_Area, 0.f);
 }
 
 inline unsigned Bmphandler::Pt2coord(Point p) const
@@ -432,66 +817,76 @@ inline unsigned Bmphandler::Pt2coord(Point p) const
 
 void Bmphandler::BmpAbs()
 {
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] = abs(m_WorkBits[i]);
+		work[i] = abs(work[i]);
 }
 
 void Bmphandler::BmpNeg()
 {
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] = 255 - m_WorkBits[i];
+		work[i] = 255 - work[i];
 }
 
 void Bmphandler::BmpSum()
 {
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] = m_WorkBits[i] + m_BmpBits[i];
+		work[i] = work[i] + m_BmpBits[i];
 }
 
 void Bmphandler::BmpDiff()
 {
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] = m_WorkBits[i] - m_BmpBits[i];
+		work[i] = work[i] - m_BmpBits[i];
 }
 
 void Bmphandler::BmpAdd(float f)
 {
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] = m_WorkBits[i] + f;
+		work[i] = work[i] + f;
 }
 
 void Bmphandler::BmpMult()
 {
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] *= m_BmpBits[i];
+		work[i] *= m_BmpBits[i];
 }
 
 void Bmphandler::BmpMult(float f)
 {
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] = f * m_WorkBits[i];
+		work[i] = f * work[i];
 }
 
 void Bmphandler::BmpOverlay(float alpha)
 {
 	float tmp = 1.0f - alpha;
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] = alpha * m_BmpBits[i] + tmp * m_WorkBits[i];
+		work[i] = alpha * m_BmpBits[i] + tmp * work[i];
 	m_Mode2 = 2;
 }
 
 void Bmphandler::TransparentAdd(float* pict2)
 {
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		if (m_WorkBits[i] == 0)
-			m_WorkBits[i] = pict2[i];
+		if (work[i] == 0)
+			work[i] = pict2[i];
 }
 
 float* Bmphandler::CopyWork()
 {
 	float* results = m_Sliceprovide->GiveMe();
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
-		results[i] = m_WorkBits[i];
+		results[i] = work[i];
 
 	return results;
 }
@@ -509,7 +904,7 @@ tissues_size_t* Bmphandler::CopyTissue(tissuelayers_size_t idx)
 {
 	tissues_size_t* results =
 			(tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area);
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (unsigned i = 0; i < m_Area; i++)
 		results[i] = tissues[i];
 
@@ -518,8 +913,8 @@ tissues_size_t* Bmphandler::CopyTissue(tissuelayers_size_t idx)
 
 void Bmphandler::CopyWork(float* output)
 {
-	for (unsigned i = 0; i < m_Area; i++)
-		output[i] = m_WorkBits[i];
+	const float* work = ReadWork();
+	std::copy(work, work + m_Area, output);
 }
 
 void Bmphandler::CopyBmp(float* output)
@@ -533,12 +928,12 @@ void Bmphandler::CopyTissue(tissuelayers_size_t idx, tissues_size_t* output)
 	if (m_Tissuelayers.size() <= idx)
 		return;
 
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (unsigned i = 0; i < m_Area; i++)
 		output[i] = tissues[i];
 }
 
-void Bmphandler::Newbmp(unsigned short width1, unsigned short height1, bool init)
+void Bmphandler::Newbmp(unsigned width1, unsigned height1, bool init)
 {
 	unsigned areanew = unsigned(width1) * height1;
 	m_Width = width1;
@@ -547,22 +942,11 @@ void Bmphandler::Newbmp(unsigned short width1, unsigned short height1, bool init
 	{
 		if (m_Loaded)
 		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
+			ReleaseBits();
 		}
 		m_Area = areanew;
 		m_Sliceprovide = m_SliceprovideInstaller->Install(m_Area);
 		m_BmpBits = m_Sliceprovide->GiveMe();
-		m_WorkBits = m_Sliceprovide->GiveMe();
-		m_HelpBits = m_Sliceprovide->GiveMe();
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 		ClearTissue(0);
 	}
@@ -572,20 +956,19 @@ void Bmphandler::Newbmp(unsigned short width1, unsigned short height1, bool init
 		{
 			m_Sliceprovide = m_SliceprovideInstaller->Install(m_Area);
 			m_BmpBits = m_Sliceprovide->GiveMe();
-			m_WorkBits = m_Sliceprovide->GiveMe();
-			m_HelpBits = m_Sliceprovide->GiveMe();
 			m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 			ClearTissue(0);
 		}
 	}
 
-	tissues_size_t* tissues = m_Tissuelayers[0];
+	tissues_size_t* tissues = TissueLayer(0);
 
 	if (init)
 	{
 		std::fill(m_BmpBits, m_BmpBits + m_Area, 0.f);
-		std::fill(m_WorkBits, m_WorkBits + m_Area, 0.f);
-		std::fill(m_HelpBits, m_HelpBits + m_Area, 0.f);
+		ClearWork();
+		if (m_HelpBits)
+			std::fill(m_HelpBits, m_HelpBits + m_Area, 0.f);
 		std::fill(tissues, tissues + m_Area, 0);
 	}
 
@@ -595,7 +978,7 @@ void Bmphandler::Newbmp(unsigned short width1, unsigned short height1, bool init
 	ClearLimits();
 }
 
-void Bmphandler::Newbmp(unsigned short width1, unsigned short height1, float* bits)
+void Bmphandler::Newbmp(unsigned width1, unsigned height1, float* bits)
 {
 	unsigned areanew = unsigned(width1) * height1;
 	m_Width = width1;
@@ -604,22 +987,11 @@ void Bmphandler::Newbmp(unsigned short width1, unsigned short height1, float* bi
 	{
 		if (m_Loaded)
 		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
+			ReleaseBits();
 		}
 		m_Area = areanew;
 		m_Sliceprovide = m_SliceprovideInstaller->Install(m_Area);
 		m_BmpBits = bits;
-		m_WorkBits = m_Sliceprovide->GiveMe();
-		m_HelpBits = m_Sliceprovide->GiveMe();
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 		ClearTissue(0);
 	}
@@ -629,8 +1001,6 @@ void Bmphandler::Newbmp(unsigned short width1, unsigned short height1, float* bi
 		{
 			m_Sliceprovide = m_SliceprovideInstaller->Install(m_Area);
 			m_BmpBits = bits;
-			m_WorkBits = m_Sliceprovide->GiveMe();
-			m_HelpBits = m_Sliceprovide->GiveMe();
 			m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 			ClearTissue(0);
 		}
@@ -646,16 +1016,7 @@ void Bmphandler::Freebmp()
 {
 	if (m_Loaded)
 	{
-		ClearStack();
-		m_Sliceprovide->TakeBack(m_BmpBits);
-		m_Sliceprovide->TakeBack(m_WorkBits);
-		m_Sliceprovide->TakeBack(m_HelpBits);
-		for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-		{
-			free(m_Tissuelayers[idx]);
-		}
-		m_Tissuelayers.clear();
-		m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
+		ReleaseBits();
 	}
 
 	m_Area = 0;
@@ -772,8 +1133,8 @@ int Bmphandler::LoadDIBitmap(const char* filename) /* I - File to load */
 		return 0;
 	}
 
-	m_Width = (short unsigned)bmpinfo->bmiHeader.biWidth;
-	m_Height = (short unsigned)abs(bmpinfo->bmiHeader.biHeight);
+	m_Width = (unsigned)bmpinfo->bmiHeader.biWidth;
+	m_Height = (unsigned)abs(bmpinfo->bmiHeader.biHeight);
 	unsigned newarea = m_Height * (unsigned int)m_Width;
 
 	if ((bitsize = bmpinfo->bmiHeader.biSizeImage) == 0)
@@ -788,16 +1149,7 @@ int Bmphandler::LoadDIBitmap(const char* filename) /* I - File to load */
 	{
 		if (m_Loaded)
 		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
+			ReleaseBits();
 		}
 
 		m_Area = newarea;
@@ -813,24 +1165,6 @@ int Bmphandler::LoadDIBitmap(const char* filename) /* I - File to load */
 			return 0;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			free(bmpinfo);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			free(bmpinfo);
-			return 0;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 	else if (!m_Loaded)
@@ -846,24 +1180,6 @@ int Bmphandler::LoadDIBitmap(const char* filename) /* I - File to load */
 			return 0;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			free(bmpinfo);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			free(bmpinfo);
-			return 0;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 
@@ -892,7 +1208,8 @@ int Bmphandler::LoadDIBitmap(const char* filename) /* I - File to load */
 			free(bmpinfo);
 			return 0;
 		}
-		bitsize /= (bmpinfo->bmiHeader.biBitCount / 8);
+		// the converted rows are not padded
+		bitsize = newarea;
 	}
 	else
 	{
@@ -908,11 +1225,12 @@ int Bmphandler::LoadDIBitmap(const char* filename) /* I - File to load */
 		}
 	}
 
+	float* work = WorkBits();
 	if (bitsize == newarea)
 	{
 		for (unsigned int i = 0; i < bitsize; i++)
 		{
-			m_WorkBits[i] = m_BmpBits[i] = (float)bits_tmp[i];
+			work[i] = m_BmpBits[i] = (float)bits_tmp[i];
 		}
 	}
 	else
@@ -926,7 +1244,7 @@ int Bmphandler::LoadDIBitmap(const char* filename) /* I - File to load */
 		{
 			for (unsigned j1 = 0; j1 < m_Width; j1++)
 			{
-				m_WorkBits[i] = m_BmpBits[i] = (float)bits_tmp[j];
+				work[i] = m_BmpBits[i] = (float)bits_tmp[j];
 				i++;
 				j++;
 			}
@@ -947,7 +1265,7 @@ int Bmphandler::LoadDIBitmap(const char* filename) /* I - File to load */
 	return 1;
 }
 
-int Bmphandler::LoadDIBitmap(const char* filename, Point p, unsigned short dx, unsigned short dy) /* I - File to load */
+int Bmphandler::LoadDIBitmap(const char* filename, Point p, unsigned dx, unsigned dy) /* I - File to load */
 {
 	FILE* fp; /* Open file pointer */
 	unsigned char* bits_tmp;
@@ -957,7 +1275,7 @@ int Bmphandler::LoadDIBitmap(const char* filename, Point p, unsigned short dx, u
 	m_Width = dx;
 	m_Height = dy;
 	unsigned newarea = unsigned(dx) * dy;
-	unsigned short w, h;
+	unsigned w, h;
 
 	/* Try opening the file; use "rb" mode to read this *binary* file. */
 	if ((fp = fopen(filename, "rb")) == nullptr)
@@ -1014,9 +1332,9 @@ int Bmphandler::LoadDIBitmap(const char* filename, Point p, unsigned short dx, u
 		return 0;
 	}
 
-	w = (short unsigned)bmpinfo->bmiHeader.biWidth;
+	w = (unsigned)bmpinfo->bmiHeader.biWidth;
 	//	bmpinfo->bmiHeader.biWidth=(int)dx;
-	h = (short unsigned)abs(bmpinfo->bmiHeader.biHeight);
+	h = (unsigned)abs(bmpinfo->bmiHeader.biHeight);
 	//	bmpinfo->bmiHeader.biHeight=(int)dy;
 
 	bitsize = newarea;
@@ -1029,16 +1347,7 @@ int Bmphandler::LoadDIBitmap(const char* filename, Point p, unsigned short dx, u
 	{
 		if (m_Loaded)
 		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
+			ReleaseBits();
 		}
 
 		m_Area = newarea;
@@ -1054,24 +1363,6 @@ int Bmphandler::LoadDIBitmap(const char* filename, Point p, unsigned short dx, u
 			return 0;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			free(bmpinfo);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			free(bmpinfo);
-			return 0;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 	else if (!m_Loaded)
@@ -1087,24 +1378,6 @@ int Bmphandler::LoadDIBitmap(const char* filename, Point p, unsigned short dx, u
 			return 0;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			free(bmpinfo);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			free(bmpinfo);
-			return 0;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 
@@ -1127,33 +1400,17 @@ int Bmphandler::LoadDIBitmap(const char* filename, Point p, unsigned short dx, u
 #endif
 	if (result)
 	{
-		m_Sliceprovide->TakeBack(m_BmpBits);
-		m_Sliceprovide->TakeBack(m_WorkBits);
-		m_Sliceprovide->TakeBack(m_HelpBits);
-		for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-		{
-			free(m_Tissuelayers[idx]);
-		}
-		m_Tissuelayers.clear();
 		free(bits_tmp);
 		fclose(fp);
 		free(bmpinfo);
 		return 0;
 	}
 
-	for (unsigned short n = 0; n < dy; n++)
+	for (unsigned n = 0; n < dy; n++)
 	{
-		if ((unsigned short)fread(bits_tmp + n * dx, 1, dx, fp) < dx)
+		if ((unsigned)fread(bits_tmp + n * dx, 1, dx, fp) < dx)
 		{
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			free(bits_tmp);
+				free(bits_tmp);
 			fclose(fp);
 			free(bmpinfo);
 			return 0;
@@ -1167,15 +1424,6 @@ int Bmphandler::LoadDIBitmap(const char* filename, Point p, unsigned short dx, u
 #endif
 			if (result)
 			{
-				m_Sliceprovide->TakeBack(m_BmpBits);
-				m_Sliceprovide->TakeBack(m_WorkBits);
-				m_Sliceprovide->TakeBack(m_HelpBits);
-				for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size();
-						 ++idx)
-				{
-					free(m_Tissuelayers[idx]);
-				}
-				m_Tissuelayers.clear();
 				free(bits_tmp);
 				fclose(fp);
 				free(bmpinfo);
@@ -1184,9 +1432,10 @@ int Bmphandler::LoadDIBitmap(const char* filename, Point p, unsigned short dx, u
 		}
 	}
 
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = m_BmpBits[i] = (float)bits_tmp[i];
+		work[i] = m_BmpBits[i] = (float)bits_tmp[i];
 	}
 
 	free(bits_tmp);
@@ -1218,39 +1467,44 @@ int Bmphandler::ConvertImageTo8BitBMP(const char* filename, unsigned char*& bits
 	int width = src.width();
 	int height = src.height();
 
-	// convert RGB image to gray scale image
-	double r, g, b;
-	int counter = 0;
-	for (int j = height - 1; j > 0; j--) // flipped ?
+	// the channels are stored as planes, i.e. a row of each channel is contiguous
+	int const g_channel = std::min(1, src.spectrum() - 1);
+	int const b_channel = std::min(2, src.spectrum() - 1);
+	float const rf = static_cast<float>(m_RedFactor);
+	float const gf = static_cast<float>(m_GreenFactor);
+	float const bf = static_cast<float>(m_BlueFactor);
+
+	unsigned char* out = bits_tmp;
+	for (int j = height - 1; j >= 0; j--, out += width) // flipped ?
 	{
-		for (int i = 0; i < width; i++, counter++)
+		const unsigned char* r = src.data(0, j, 0, 0);
+		const unsigned char* g = src.data(0, j, 0, g_channel);
+		const unsigned char* b = src.data(0, j, 0, b_channel);
+		for (int i = 0; i < width; i++)
 		{
-			r = src(i, j, 0, 0); // First channel RED
-			g = src(i, j, 0, 1); // Second channel GREEN
-			b = src(i, j, 0, 2); // Third channel BLUE
-
-			bits_tmp[counter] = (unsigned char)(m_RedFactor * r + m_GreenFactor * g + m_BlueFactor * b);
+			out[i] = static_cast<unsigned char>(rf * r[i] + gf * g[i] + bf * b[i]);
 		}
 	}
 
 	return 1;
 }
 
-int Bmphandler::ConvertPNGImageTo8BitBMP(const char* filename, unsigned char*& bits_tmp) const
+int Bmphandler::ConvertPNGImageTo8BitBMP(const QImage& image, unsigned char* bits_tmp) const
 {
-	QImage source_image(filename);
+	QImage const source_image = image.convertToFormat(QImage::Format_RGB32);
+
+	float const rf = static_cast<float>(m_RedFactor);
+	float const gf = static_cast<float>(m_GreenFactor);
+	float const bf = static_cast<float>(m_BlueFactor);
 
-	unsigned int counter = 0;
-	QColor old_color;
-	for (int y = source_image.height() - 1; y >= 0; y--)
+	int const width = source_image.width();
+	unsigned char* out = bits_tmp;
+	for (int y = source_image.height() - 1; y >= 0; y--, out += width)
 	{
-		for (int x = 0; x < source_image.width(); x++)
+		const QRgb* line = reinterpret_cast<const QRgb*>(source_image.constScanLine(y));
+		for (int x = 0; x < width; x++)
 		{
-			old_color = QColor(source_image.pixel(x, y));
-			bits_tmp[counter] = (unsigned char)(m_RedFactor * old_color.red() +
-																					m_GreenFactor * old_color.green() +
-																					m_BlueFactor * old_color.blue());
-			counter++;
+			out[x] = static_cast<unsigned char>(rf * qRed(line[x]) + gf * qGreen(line[x]) + bf * qBlue(line[x]));
 		}
 	}
 
@@ -1323,8 +1577,8 @@ int Bmphandler::ReloadDIBitmap(const char* filename) /* I - File to load */
 		return 0;
 	}
 
-	if (m_Width != (short unsigned)bmpinfo->bmiHeader.biWidth ||
-			m_Height != (short unsigned)abs(bmpinfo->bmiHeader.biHeight))
+	if (m_Width != (unsigned)bmpinfo->bmiHeader.biWidth ||
+			m_Height != (unsigned)abs(bmpinfo->bmiHeader.biHeight))
 	{
 		free(bmpinfo);
 		fclose(fp);
@@ -1406,7 +1660,7 @@ int Bmphandler::ReloadDIBitmap(const char* filename, Point p)
 	unsigned char* bits_tmp;
 	unsigned int bitsize;		 /* Size of bitmap */
 	BITMAPFILEHEADER header; /* File header */
-	unsigned short w, h;
+	unsigned w, h;
 
 	/* Try opening the file; use "rb" mode to read this *binary* file. */
 	if ((fp = fopen(filename, "rb")) == nullptr)
@@ -1452,9 +1706,9 @@ int Bmphandler::ReloadDIBitmap(const char* filename, Point p)
 		return 0;
 	}
 
-	h = (unsigned short)bmpinfo->bmiHeader.biHeight;
+	h = (unsigned)bmpinfo->bmiHeader.biHeight;
 	//	bmpinfo->bmiHeader.biHeight = height;
-	w = (unsigned short)bmpinfo->bmiHeader.biWidth;
+	w = (unsigned)bmpinfo->bmiHeader.biWidth;
 	//	bmpinfo->bmiHeader.biWidth = width;
 
 	/* Now that we have all the header info read in, allocate memory for *
@@ -1501,9 +1755,9 @@ int Bmphandler::ReloadDIBitmap(const char* filename, Point p)
 		return 0;
 	}
 
-	for (unsigned short n = 0; n < m_Height; n++)
+	for (unsigned n = 0; n < m_Height; n++)
 	{
-		if ((unsigned short)fread(bits_tmp + n * m_Width, 1, m_Width, fp) < m_Width)
+		if ((unsigned)fread(bits_tmp + n * m_Width, 1, m_Width, fp) < m_Width)
 		{
 			/*			free(bmp_bits);
 			free(work_bits);
@@ -1564,8 +1818,8 @@ int Bmphandler::LoadPNGBitmap(const char* filename)
 	{
 		return 0;
 	}
-	m_Width = (short unsigned)image.width();
-	m_Height = (short unsigned)image.height();
+	m_Width = (unsigned)image.width();
+	m_Height = (unsigned)image.height();
 	unsigned newarea = m_Height * (unsigned int)m_Width;
 	bitsize = (unsigned int)(m_Width * m_Height);
 
@@ -1573,16 +1827,7 @@ int Bmphandler::LoadPNGBitmap(const char* filename)
 	{
 		if (m_Loaded)
 		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
+			ReleaseBits();
 		}
 
 		m_Area = newarea;
@@ -1595,18 +1840,6 @@ int Bmphandler::LoadPNGBitmap(const char* filename)
 			return 0;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			return 0;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 	else if (!m_Loaded)
@@ -1619,18 +1852,6 @@ int Bmphandler::LoadPNGBitmap(const char* filename)
 			return 0;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			return 0;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 
@@ -1642,18 +1863,19 @@ int Bmphandler::LoadPNGBitmap(const char* filename)
 		return 0;
 	}
 
-	int result = ConvertPNGImageTo8BitBMP(filename, bits_tmp);
+	int result = ConvertPNGImageTo8BitBMP(image, bits_tmp);
 	if (result == 0)
 	{
 		free(bits_tmp);
 		return 0;
 	}
 
+	float* work = WorkBits();
 	if (bitsize == newarea)
 	{
 		for (unsigned int i = 0; i < bitsize; i++)
 		{
-			m_WorkBits[i] = m_BmpBits[i] = (float)bits_tmp[i];
+			work[i] = m_BmpBits[i] = (float)bits_tmp[i];
 		}
 	}
 	else
@@ -1667,7 +1889,7 @@ int Bmphandler::LoadPNGBitmap(const char* filename)
 		{
 			for (unsigned j1 = 0; j1 < m_Width; j1++)
 			{
-				m_WorkBits[i] = m_BmpBits[i] = (float)bits_tmp[j];
+				work[i] = m_BmpBits[i] = (float)bits_tmp[j];
 				i++;
 				j++;
 			}
@@ -1686,7 +1908,7 @@ int Bmphandler::LoadPNGBitmap(const char* filename)
 	return 1;
 }
 
-bool Bmphandler::LoadArray(float* bits, unsigned short w1, unsigned short h1)
+bool Bmphandler::LoadArray(float* bits, unsigned w1, unsigned h1)
 {
 	m_Width = w1;
 	m_Height = h1;
@@ -1700,16 +1922,7 @@ bool Bmphandler::LoadArray(float* bits, unsigned short w1, unsigned short h1)
 	{
 		if (m_Loaded)
 		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
+			ReleaseBits();
 		}
 
 		m_Area = newarea;
@@ -1723,20 +1936,6 @@ bool Bmphandler::LoadArray(float* bits, unsigned short w1, unsigned short h1)
 			return false;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			return false;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			return false;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 	else if (!m_Loaded)
@@ -1750,28 +1949,15 @@ bool Bmphandler::LoadArray(float* bits, unsigned short w1, unsigned short h1)
 			return false;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			return false;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			return false;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 
 	ClearTissue(0);
 
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = m_BmpBits[i] = bits[i];
+		work[i] = m_BmpBits[i] = bits[i];
 	}
 
 	/* OK, everything went fine - return the allocated bitmap... */
@@ -1785,7 +1971,7 @@ bool Bmphandler::LoadArray(float* bits, unsigned short w1, unsigned short h1)
 	return true;
 }
 
-bool Bmphandler::LoadArray(float* bits, unsigned short w, unsigned short h, Point p, unsigned short dx, unsigned short dy)
+bool Bmphandler::LoadArray(float* bits, unsigned w, unsigned h, Point p, unsigned dx, unsigned dy)
 {
 	if (p.px > w)
 	{
@@ -1814,16 +2000,7 @@ bool Bmphandler::LoadArray(float* bits, unsigned short w, unsigned short h, Poin
 	{
 		if (m_Loaded)
 		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
+			ReleaseBits();
 		}
 
 		m_Area = newarea;
@@ -1837,20 +2014,6 @@ bool Bmphandler::LoadArray(float* bits, unsigned short w, unsigned short h, Poin
 			return false;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			return false;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			return false;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 	else if (!m_Loaded)
@@ -1864,20 +2027,6 @@ bool Bmphandler::LoadArray(float* bits, unsigned short w, unsigned short h, Poin
 			return false;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			return false;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			return false;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 
@@ -1885,12 +2034,13 @@ bool Bmphandler::LoadArray(float* bits, unsigned short w, unsigned short h, Poin
 
 	unsigned int pos1;
 	unsigned int pos2 = 0;
-	for (unsigned short j = 0; j < dy; j++)
+	float* work = WorkBits();
+	for (unsigned j = 0; j < dy; j++)
 	{
 		pos1 = (p.py + j) * (unsigned int)(w) + p.px;
-		for (unsigned short i = 0; i < dx; i++, pos1++, pos2++)
+		for (unsigned i = 0; i < dx; i++, pos1++, pos2++)
 		{
-			m_WorkBits[pos2] = m_BmpBits[pos2] = bits[pos1];
+			work[pos2] = m_BmpBits[pos2] = bits[pos1];
 		}
 	}
 
@@ -1919,7 +2069,7 @@ bool Bmphandler::ReloadArray(float* bits)
 	return true;
 }
 
-bool Bmphandler::ReloadArray(float* bits, unsigned short w1, unsigned short h1, Point p)
+bool Bmphandler::ReloadArray(float* bits, unsigned w1, unsigned h1, Point p)
 {
 	if (!m_Loaded)
 		return false;
@@ -1931,12 +2081,13 @@ bool Bmphandler::ReloadArray(float* bits, unsigned short w1, unsigned short h1,
 
 	unsigned int pos1;
 	unsigned int pos2 = 0;
-	for (unsigned short j = 0; j < m_Height; j++)
+	float* work = WorkBits();
+	for (unsigned j = 0; j < m_Height; j++)
 	{
 		pos1 = (p.py + j) * (unsigned int)(w1) + p.px;
-		for (unsigned short i = 0; i < m_Width; i++, pos1++, pos2++)
+		for (unsigned i = 0; i < m_Width; i++, pos1++, pos2++)
 		{
-			m_WorkBits[pos2] = m_BmpBits[pos2] = bits[pos1];
+			work[pos2] = m_BmpBits[pos2] = bits[pos1];
 		}
 	}
 
@@ -1965,16 +2116,7 @@ bool Bmphandler::LoadDICOM(const char* filename)
 	{
 		if (m_Loaded)
 		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
+			ReleaseBits();
 		}
 
 		m_Area = newarea;
@@ -1989,22 +2131,6 @@ bool Bmphandler::LoadDICOM(const char* filename)
 			return false;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			dcmread.Closedicom();
-			return false;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			dcmread.Closedicom();
-			return false;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 	else if (!m_Loaded)
@@ -2019,22 +2145,6 @@ bool Bmphandler::LoadDICOM(const char* filename)
 			return false;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			dcmread.Closedicom();
-			return false;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			dcmread.Closedicom();
-			return false;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 
@@ -2049,9 +2159,10 @@ bool Bmphandler::LoadDICOM(const char* filename)
 		}
 	}
 
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = m_BmpBits[i];
+		work[i] = m_BmpBits[i];
 	}
 
 	/* OK, everything went fine - return the allocated bitmap... */
@@ -2066,13 +2177,13 @@ bool Bmphandler::LoadDICOM(const char* filename)
 	return true;
 }
 
-bool Bmphandler::LoadDICOM(const char* filename, Point p, unsigned short dx, unsigned short dy)
+bool Bmphandler::LoadDICOM(const char* filename, Point p, unsigned dx, unsigned dy)
 {
 	DicomReader dcmread;
 	dcmread.Opendicom(filename);
 
-	unsigned short w = dcmread.GetWidth();
-	unsigned short h = dcmread.GetHeight();
+	unsigned w = dcmread.GetWidth();
+	unsigned h = dcmread.GetHeight();
 	if (p.px > w)
 	{
 		p.px = 0;
@@ -2100,16 +2211,7 @@ bool Bmphandler::LoadDICOM(const char* filename, Point p, unsigned short dx, uns
 	{
 		if (m_Loaded)
 		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
+			ReleaseBits();
 		}
 
 		m_Area = newarea;
@@ -2124,22 +2226,6 @@ bool Bmphandler::LoadDICOM(const char* filename, Point p, unsigned short dx, uns
 			return false;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			dcmread.Closedicom();
-			return false;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			dcmread.Closedicom();
-			return false;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 	else if (!m_Loaded)
@@ -2154,22 +2240,6 @@ bool Bmphandler::LoadDICOM(const char* filename, Point p, unsigned short dx, uns
 			return false;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			dcmread.Closedicom();
-			return false;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			dcmread.Closedicom();
-			return false;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 	}
 
@@ -2177,9 +2247,10 @@ bool Bmphandler::LoadDICOM(const char* filename, Point p, unsigned short dx, uns
 
 	dcmread.LoadPicture(m_BmpBits, p, dx, dy);
 
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = m_BmpBits[i];
+		work[i] = m_BmpBits[i];
 	}
 
 	/* OK, everything went fine - return the allocated bitmap... */
@@ -2335,13 +2406,16 @@ FILE* Bmphandler::SaveProj(FILE* fp, bool inclpics)
 {
 	if (m_Loaded)
 	{
-		fwrite(&m_Width, 1, sizeof(unsigned short), fp);
-		fwrite(&m_Height, 1, sizeof(unsigned short), fp);
+		// the project file stores the slice extents as 16-bit values
+		unsigned short width16 = static_cast<unsigned short>(m_Width);
+		unsigned short height16 = static_cast<unsigned short>(m_Height);
+		fwrite(&width16, 1, sizeof(unsigned short), fp);
+		fwrite(&height16, 1, sizeof(unsigned short), fp);
 		if (inclpics)
 		{
 			fwrite(m_BmpBits, 1, m_Area * sizeof(float), fp);
-			fwrite(m_WorkBits, 1, m_Area * sizeof(float), fp);
-			fwrite(m_Tissuelayers[0], 1, m_Area * sizeof(tissues_size_t), fp); // TODO
+			fwrite(ReadWork(), 1, m_Area * sizeof(float), fp);
+			fwrite(TissueLayer(0), 1, m_Area * sizeof(tissues_size_t), fp); // TODO
 		}
 		int size = -1 - int(m_Marks.size());
 		fwrite(&size, 1, sizeof(int), fp);
@@ -2396,32 +2470,34 @@ FILE* Bmphandler::SaveStack(FILE* fp) const
 {
 	if (m_Loaded)
 	{
+		// the project format stores the stack uncompressed
+		unsigned const stackcounter = image_stack.NextId();
 		fwrite(&stackcounter, 1, sizeof(unsigned), fp);
 
-		int size = -int(stackindex.size()) - 1;
+		auto const ids = image_stack.Ids();
+		int size = -int(ids.size()) - 1;
 		fwrite(&size, 1, sizeof(int), fp);
 		int stack_version = 1;
 		fwrite(&stack_version, 1, sizeof(int), fp);
-		for (std::list<unsigned>::iterator it = stackindex.begin();
-				 it != stackindex.end(); it++)
+		for (auto id : ids)
 		{
-			fwrite(&(*it), 1, sizeof(unsigned), fp);
+			fwrite(&id, 1, sizeof(unsigned), fp);
 		}
 
-		size = int(bits_stack.size());
+		std::vector<unsigned char> modes(ids.size(), 0);
+		std::vector<float> bits(m_Area, 0.f);
+		size = int(ids.size());
 		fwrite(&size, 1, sizeof(int), fp);
-		for (std::list<float*>::iterator it = bits_stack.begin();
-				 it != bits_stack.end(); it++)
+		for (size_t i = 0; i < ids.size(); i++)
 		{
-			fwrite(*it, 1, sizeof(float) * m_Area, fp);
+			image_stack.Get(ids[i], bits.data(), modes[i]);
+			fwrite(bits.data(), 1, sizeof(float) * m_Area, fp);
 		}
 
-		size = int(mode_stack.size());
 		fwrite(&size, 1, sizeof(int), fp);
-		for (std::list<unsigned char>::iterator it = mode_stack.begin();
-				 it != mode_stack.end(); it++)
+		for (auto mode : modes)
 		{
-			fwrite(&(*it), 1, sizeof(unsigned char), fp);
+			fwrite(&mode, 1, sizeof(unsigned char), fp);
 		}
 	}
 	return fp;
@@ -2429,7 +2505,7 @@ FILE* Bmphandler::SaveStack(FILE* fp) const
 
 FILE* Bmphandler::LoadProj(FILE* fp, int tissuesVersion, bool inclpics, bool init)
 {
-	unsigned short width1, height1;
+	unsigned short width1 = 0, height1 = 0;
 	fread(&width1, sizeof(unsigned short), 1, fp);
 	fread(&height1, sizeof(unsigned short), 1, fp);
 
@@ -2438,8 +2514,9 @@ FILE* Bmphandler::LoadProj(FILE* fp, int tissuesVersion, bool inclpics, bool ini
 	if (inclpics)
 	{
 		fread(m_BmpBits, m_Area * sizeof(float), 1, fp);
-		fread(m_WorkBits, m_Area * sizeof(float), 1, fp);
-		tissues_size_t* tissues = m_Tissuelayers[0]; // TODO
+		fread(WorkBits(), m_Area * sizeof(float), 1, fp);
+		ReleaseWorkIfZero();
+		tissues_size_t* tissues = TissueLayer(0); // TODO
 		if (tissuesVersion > 0)
 		{
 			fread(tissues, m_Area * sizeof(tissues_size_t), 1, fp);
@@ -2537,6 +2614,7 @@ FILE* Bmphandler::LoadProj(FILE* fp, int tissuesVersion, bool inclpics, bool ini
 
 FILE* Bmphandler::LoadStack(FILE* fp)
 {
+	unsigned stackcounter = 1;
 	fread(&stackcounter, sizeof(unsigned), 1, fp);
 
 	int size1;
@@ -2549,34 +2627,37 @@ FILE* Bmphandler::LoadStack(FILE* fp)
 		//		if(stackVersion<1) fseek(fp,-1, SEEK_CUR);
 	}
 
-	stackindex.clear();
-	unsigned dummy;
+	image_stack.Clear();
+	std::vector<unsigned> ids(size1, 0);
 	for (int i = 0; i < size1; i++)
 	{
-		fread(&dummy, sizeof(unsigned), 1, fp);
-		stackindex.push_back(dummy);
+		fread(&ids[i], sizeof(unsigned), 1, fp);
 	}
 
 	int size;
 	fread(&size, sizeof(int), 1, fp);
-	bits_stack.clear();
-	float* f;
+	std::vector<float> bits(m_Area, 0.f);
 	for (int i = 0; i < size; i++)
 	{
-		f = m_Sliceprovide->GiveMe();
-		fread(f, sizeof(float) * m_Area, 1, fp);
-		bits_stack.push_back(f);
+		fread(bits.data(), sizeof(float) * m_Area, 1, fp);
+		if (i < size1)
+		{
+			image_stack.Insert(ids[i], bits.data(), m_Area, 0);
+		}
 	}
+	image_stack.SetNextId(stackcounter);
 
 	if (stack_version > 0)
 	{
 		fread(&size, sizeof(int), 1, fp);
-		mode_stack.clear();
 		unsigned char dummymode;
 		for (int i = 0; i < size; i++)
 		{
 			fread(&dummymode, sizeof(unsigned char), 1, fp);
-			mode_stack.push_back(dummymode);
+			if (i < size1)
+			{
+				image_stack.SetMode(ids[i], dummymode);
+			}
 		}
 	}
 
@@ -2720,9 +2801,9 @@ int																																/* O - 0 = success, -1 = failure */
 
 	unsigned long pos = 0;
 	unsigned long pos2 = 0;
-	for (unsigned short j = 0; j < m_Height; j++)
+	for (unsigned j = 0; j < m_Height; j++)
 	{
-		for (unsigned short i = 0; i < m_Width; i++, pos++, pos2++)
+		for (unsigned i = 0; i < m_Width; i++, pos++, pos2++)
 		{
 			bits_tmp[pos] =
 					(unsigned char)(std::min(255.0, std::max(0.0, p_bits[pos2] + 0.5)));
@@ -2913,7 +2994,7 @@ int Bmphandler::SaveTissueBitmap(tissuelayers_size_t idx, const char *filename)
 		} else {
 			tissues_size_t pad[4];
 			pad[0]=pad[1]=pad[2]=pad[3]=0;
-			for(unsigned short i=0;i<height;i++) {
+			for(unsigned i=0;i<height;i++) {
 				if (fwrite(&(tissuelayers[idx][int(i)*width]), 1, width, fp) < (unsigned int)width)
 				{
 					/* Couldn't write the bitmap - return... */
@@ -2985,7 +3066,7 @@ int Bmphandler::SaveTissueBitmap(tissuelayers_size_t idx, const char *filename)
 		} else {
 			tissues_size_t pad[4];
 			pad[0]=pad[1]=pad[2]=pad[3]=0;
-			for(unsigned short i=0;i<height;i++) {
+			for(unsigned i=0;i<height;i++) {
 				if (fwrite(&(tissuelayers[idx][int(i)*width]), sizeof(tissues_size_t), width, fp) < (unsigned int)width)
 				{
 					/* Couldn't write the bitmap - return... */
@@ -3027,7 +3108,7 @@ int Bmphandler::SaveTissueBitmap(tissuelayers_size_t idx, const char* filename)
 	unsigned char* field =
 			(unsigned char*)image_source->GetScalarPointer(0, 0, 0);
 
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (unsigned int i = 0; i < (unsigned int)m_Width * m_Height; ++i)
 	{
 		auto tissue_color = TissueInfos::GetTissueColor(tissues[i]);
@@ -3054,14 +3135,14 @@ int Bmphandler::SaveDIBitmap(const char* filename)
 
 int Bmphandler::SaveWorkBitmap(const char* filename)
 {
-	return SaveDIBitmap(filename, m_WorkBits);
+	return SaveDIBitmap(filename, WorkBits());
 }
 
-int Bmphandler::ReadAvw(const char* filename, short unsigned slicenr)
+int Bmphandler::ReadAvw(const char* filename, unsigned slicenr)
 {
 	unsigned int bitsize; /* Size of bitmap */
 
-	unsigned short w, h;
+	unsigned w, h;
 	avw::eDataType type;
 
 	void* data = avw::ReadData(filename, slicenr, w, h, type);
@@ -3080,16 +3161,7 @@ int Bmphandler::ReadAvw(const char* filename, short unsigned slicenr)
 	{
 		if (m_Loaded)
 		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
+			ReleaseBits();
 		}
 
 		m_Area = newarea;
@@ -3102,18 +3174,6 @@ int Bmphandler::ReadAvw(const char* filename, short unsigned slicenr)
 			return 0;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			free(data);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			free(data);
-			return 0;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 		ClearTissue(0);
 	}
@@ -3127,1189 +3187,66 @@ int Bmphandler::ReadAvw(const char* filename, short unsigned slicenr)
 			return 0;
 		}
 
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			free(data);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			free(data);
-			return 0;
-		}
-
 		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
 		ClearTissue(0);
 	}
 
 	m_Loaded = true;
 
+	float* work = WorkBits();
 	if (type == avw::schar)
 	{
 		char* bits_tmp = (char*)data;
 
 		for (unsigned int i = 0; i < bitsize; i++)
 		{
-			m_WorkBits[i] = m_BmpBits[i] = (float)bits_tmp[i];
+			work[i] = m_BmpBits[i] = (float)bits_tmp[i];
 		}
 
 		free(data);
 	}
 	else if (type == avw::uchar)
 	{
-		unsigned char* bits_tmp = (unsigned char*)data;
-
-		for (unsigned int i = 0; i < bitsize; i++)
-		{
-			m_WorkBits[i] = m_BmpBits[i] = (float)bits_tmp[i];
-		}
-
-		free(data);
-	}
-	else if (type == avw::ushort)
-	{
-		unsigned short* bits_tmp = (unsigned short*)data;
-
-		for (unsigned int i = 0; i < bitsize; i++)
-		{
-			m_WorkBits[i] = m_BmpBits[i] = (float)bits_tmp[i];
-		}
-
-		free(data);
-	}
-	else if (type == avw::sshort)
-	{
-		short* bits_tmp = (short*)data;
-
-		for (unsigned int i = 0; i < bitsize; i++)
-		{
-			m_WorkBits[i] = m_BmpBits[i] = (float)bits_tmp[i];
-		}
-
-		free(data);
-	}
-	else
-	{
-		return 0;
-	}
-
-	ClearMarks();
-	ClearVvm();
-	ClearLimits();
-	m_Mode1 = m_Mode2 = 2;
-	return 1;
-}
-
-int Bmphandler::ReadRaw(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned short slicenr)
-{
-	FILE* fp;							/* Open file pointer */
-	unsigned int bitsize; /* Size of bitmap */
-
-	if ((fp = fopen(filename, "rb")) == nullptr)
-		return 0;
-
-	m_Width = w;
-	m_Height = h;
-	unsigned newarea = m_Height * (unsigned int)m_Width;
-
-	bitsize = newarea;
-
-	if (m_Area != newarea)
-	{
-		if (m_Loaded)
-		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
-		}
-
-		m_Area = newarea;
-
-		m_Sliceprovide = m_SliceprovideInstaller->Install(m_Area);
-
-		if ((m_BmpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			std::cerr << "Bmphandler::ReadRaw() : error, allocation failed" << endl;
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			std::cerr << "Bmphandler::ReadRaw() : error, allocation failed" << endl;
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			std::cerr << "Bmphandler::ReadRaw() : error, allocation failed" << endl;
-			fclose(fp);
-			return 0;
-		}
-
-		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
-		if (!m_Tissuelayers[0])
-		{
-			std::cerr << "Bmphandler::ReadRaw() : error, allocation failed" << endl;
-			fclose(fp);
-			return 0;
-		}
-		ClearTissue(0);
-	}
-	else if (!m_Loaded)
-	{
-		m_Sliceprovide = m_SliceprovideInstaller->Install(m_Area);
-
-		if ((m_BmpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			std::cerr << "Bmphandler::ReadRaw() : error, allocation failed" << endl;
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			std::cerr << "Bmphandler::ReadRaw() : error, allocation failed" << endl;
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			std::cerr << "Bmphandler::ReadRaw() : error, allocation failed" << endl;
-			fclose(fp);
-			return 0;
-		}
-
-		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
-		if (!m_Tissuelayers[0])
-		{
-			std::cerr << "Bmphandler::ReadRaw() : error, allocation failed" << endl;
-			fclose(fp);
-			return 0;
-		}
-		ClearTissue(0);
-	}
-
-	m_Loaded = true;
-
-	unsigned bytedepth = (bitdepth + 7) / 8;
-
-	if (bytedepth == 1)
-	{
-		unsigned char* bits_tmp;
-
-		if ((bits_tmp = (unsigned char*)malloc(bitsize)) == nullptr)
-		{
-			/*			sliceprovide->take_back(bmp_bits);
-			sliceprovide->take_back(work_bits);
-			sliceprovide->take_back(help_bits);*/
-			std::cerr << "Bmphandler::ReadRaw() : error, allocation failed" << endl;
-			fclose(fp);
-			return 0;
-		}
-
-		// int result = fseek(fp, (size_t)(bitsize)*slicenr, SEEK_SET);
-		// const fpos_t pos = (fpos_t)(bitsize)*slicenr;
-		// int result = fsetpos(fp, &pos);
-#ifdef _MSC_VER
-		int result = _fseeki64(fp, (__int64)(bitsize)*slicenr, SEEK_SET);
-#else
-		int result = fseek(fp, (size_t)(bitsize)*slicenr, SEEK_SET);
-#endif
-		if (result)
-		{
-			/*			sliceprovide->take_back(bmp_bits);
-			sliceprovide->take_back(work_bits);
-			sliceprovide->take_back(help_bits);*/
-			std::cerr << "Bmphandler::ReadRaw() : error, file operation failed"
-								<< endl;
-			free(bits_tmp);
-			fclose(fp);
-			return 0;
-		}
-
-		if (fread(bits_tmp, 1, bitsize, fp) < m_Area)
-		{
-			/*			sliceprovide->take_back(bmp_bits);
-			sliceprovide->take_back(work_bits);
-			sliceprovide->take_back(help_bits);*/
-			std::cerr << "Bmphandler::ReadRaw() : error, file operation failed"
-								<< endl;
-			free(bits_tmp);
-			fclose(fp);
-			return 0;
-		}
-
-		for (unsigned int i = 0; i < bitsize; i++)
-		{
-			m_WorkBits[i] = m_BmpBits[i] = (float)bits_tmp[i];
-		}
-
-		free(bits_tmp);
-	}
-	else if (bytedepth == 2)
-	{
-		unsigned short* bits_tmp;
-
-		if ((bits_tmp = (unsigned short*)malloc(bitsize * 2)) == nullptr)
-		{
-			/*			sliceprovide->take_back(bmp_bits);
-			sliceprovide->take_back(work_bits);
-			sliceprovide->take_back(help_bits);*/
-			std::cerr << "Bmphandler::ReadRaw() : error, allocation failed" << endl;
-			fclose(fp);
-			return 0;
-		}
-
-		// int result = fseek(fp, (size_t)(bitsize)*2*slicenr, SEEK_SET);
-		// const fpos_t pos = (fpos_t)(bitsize)*2*slicenr;
-		// int result = fsetpos(fp, &pos);
-#ifdef _MSC_VER
-		int result = _fseeki64(fp, (__int64)(bitsize)*2 * slicenr, SEEK_SET);
-#else
-		int result = fseek(fp, (size_t)(bitsize)*2 * slicenr, SEEK_SET);
-#endif
-		if (result)
-		{
-			/*			sliceprovide->take_back(bmp_bits);
-			sliceprovide->take_back(work_bits);
-			sliceprovide->take_back(help_bits);*/
-			std::cerr << "Bmphandler::ReadRaw() : error, file operation failed"
-								<< endl;
-			free(bits_tmp);
-			fclose(fp);
-			return 0;
-		}
-
-		if (fread(bits_tmp, 1, (size_t)(bitsize)*2, fp) < m_Area * 2)
-		{
-			/*			sliceprovide->take_back(bmp_bits);
-			sliceprovide->take_back(work_bits);
-			sliceprovide->take_back(help_bits);*/
-			std::cerr << "Bmphandler::ReadRaw() : error, file operation failed"
-								<< endl;
-			free(bits_tmp);
-			fclose(fp);
-			return 0;
-		}
-
-		for (unsigned int i = 0; i < bitsize; i++)
-		{
-			m_WorkBits[i] = m_BmpBits[i] = (float)bits_tmp[i];
-		}
-
-		free(bits_tmp);
-	}
-	else
-	{
-		/*		sliceprovide->take_back(bmp_bits);
-		sliceprovide->take_back(work_bits);
-		sliceprovide->take_back(help_bits);*/
-		std::cerr << "Bmphandler::ReadRaw() : error, unsupported depth..." << endl;
-		fclose(fp);
-		return 0;
-	}
-
-	fclose(fp);
-	ClearMarks();
-	ClearVvm();
-	ClearLimits();
-	m_Mode1 = m_Mode2 = 1;
-	return 1;
-}
-
-int Bmphandler::ReadRaw(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned short slicenr, Point p, unsigned short dx, unsigned short dy)
-{
-	FILE* fp;							/* Open file pointer */
-	unsigned int bitsize; /* Size of bitmap */
-
-	if ((fp = fopen(filename, "rb")) == nullptr)
-		return 0;
-
-	m_Width = dx;
-	m_Height = dy;
-	unsigned newarea = m_Height * (unsigned int)m_Width;
-	unsigned int area2 = h * (unsigned int)w;
-
-	bitsize = newarea;
-
-	if (m_Area != newarea)
-	{
-		if (m_Loaded)
-		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
-		}
-
-		m_Area = newarea;
-
-		m_Sliceprovide = m_SliceprovideInstaller->Install(m_Area);
-
-		if ((m_BmpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
-		ClearTissue(0);
-	}
-	else if (!m_Loaded)
-	{
-		m_Sliceprovide = m_SliceprovideInstaller->Install(m_Area);
-
-		if ((m_BmpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
-		ClearTissue(0);
-	}
-
-	m_Loaded = true;
-
-	unsigned bytedepth = (bitdepth + 7) / 8;
-
-	if (bytedepth == 1)
-	{
-		unsigned char* bits_tmp;
-
-		if ((bits_tmp = (unsigned char*)malloc(bitsize)) == nullptr)
-		{
-			/*			free(bmp_bits);
-			free(work_bits);
-			free(help_bits);*/
-			fclose(fp);
-			return 0;
-		}
-
-#ifdef _MSC_VER
-		int result = _fseeki64(fp, (__int64)(area2)*slicenr + (__int64)(w)*p.py + p.px, SEEK_SET);
-#else
-		int result = fseek(fp, (size_t)(area2)*slicenr + (size_t)(w)*p.py + p.px, SEEK_SET);
-#endif
-		if (result)
-		{
-			/*			free(bmp_bits);
-			free(work_bits);
-			free(help_bits);*/
-			free(bits_tmp);
-			fclose(fp);
-			return 0;
-		}
-
-		for (unsigned short n = 0; n < dy; n++)
-		{
-			if ((unsigned short)fread(bits_tmp + n * dx, 1, dx, fp) < dx)
-			{
-				/*				free(bmp_bits);
-				free(work_bits);
-				free(help_bits);*/
-				free(bits_tmp);
-				fclose(fp);
-
-				return 0;
-			}
-#ifdef _MSC_VER
-			result = _fseeki64(fp, (__int64)w - dx, SEEK_CUR);
-#else
-			result = fseek(fp, (size_t)w - dx, SEEK_CUR);
-#endif
-			if (result)
-			{
-				/*				free(bmp_bits);
-				free(work_bits);
-				free(help_bits);*/
-				free(bits_tmp);
-				fclose(fp);
-				return 0;
-			}
-		}
-
-		for (unsigned int i = 0; i < bitsize; i++)
-		{
-			m_WorkBits[i] = m_BmpBits[i] = (float)bits_tmp[i];
-		}
-
-		free(bits_tmp);
-	}
-	else if (bytedepth == 2)
-	{
-		unsigned short* bits_tmp;
-
-		if ((bits_tmp = (unsigned short*)malloc(bitsize * 2)) == nullptr)
-		{
-			/*			free(bmp_bits);
-			free(work_bits);
-			free(help_bits);*/
-			fclose(fp);
-			return 0;
-		}
-
-#ifdef _MSC_VER
-		int result = _fseeki64(fp, ((__int64)(area2)*slicenr + (__int64)(w)*p.py + p.px) * 2, SEEK_SET);
-#else
-		int result =
-				fseek(fp, ((size_t)(area2)*slicenr + (size_t)(w)*p.py + p.px) * 2, SEEK_SET);
-#endif
-		if (result)
-		{
-			/*			free(bmp_bits);
-			free(work_bits);
-			free(help_bits);*/
-			free(bits_tmp);
-			fclose(fp);
-			return 0;
-		}
-
-		for (unsigned short n = 0; n < dy; n++)
-		{
-			if ((unsigned short)fread(bits_tmp + n * dx, 1, dx * 2, fp) <
-					2 * dx)
-			{
-				/*				free(bmp_bits);
-				free(work_bits);
-				free(help_bits);*/
-				free(bits_tmp);
-				fclose(fp);
-				return 0;
-			}
-#ifdef _MSC_VER
-			result = _fseeki64(fp, (__int64)(w - dx) * 2, SEEK_CUR);
-#else
-			result = fseek(fp, (size_t)(w - dx) * 2, SEEK_CUR);
-#endif
-			if (result)
-			{
-				/*				free(bmp_bits);
-				free(work_bits);
-				free(help_bits);*/
-				free(bits_tmp);
-				fclose(fp);
-				return 0;
-			}
-		}
-
-		for (unsigned int i = 0; i < bitsize; i++)
-		{
-			m_WorkBits[i] = m_BmpBits[i] = (float)bits_tmp[i];
-		}
-
-		free(bits_tmp);
-	}
-	else
-	{
-		/*		free(bmp_bits);
-		free(work_bits);
-		free(help_bits);*/
-		fclose(fp);
-		return 0;
-	}
-
-	fclose(fp);
-	ClearMarks();
-	ClearVvm();
-	ClearLimits();
-	m_Mode1 = m_Mode2 = 1;
-	return 1;
-}
-
-int Bmphandler::ReadRawFloat(const char* filename, short unsigned w, short unsigned h, unsigned short slicenr)
-{
-	FILE* fp;							/* Open file pointer */
-	unsigned int bitsize; /* Size of bitmap */
-
-	if ((fp = fopen(filename, "rb")) == nullptr)
-		return 0;
-
-	m_Width = w;
-	m_Height = h;
-	unsigned newarea = m_Height * (unsigned int)m_Width;
-
-	bitsize = newarea;
-
-	if (m_Area != newarea)
-	{
-		if (m_Loaded)
-		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
-		}
-
-		m_Area = newarea;
-
-		m_Sliceprovide = m_SliceprovideInstaller->Install(m_Area);
-
-		if ((m_BmpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
-		ClearTissue(0);
-	}
-	else if (!m_Loaded)
-	{
-		m_Sliceprovide = m_SliceprovideInstaller->Install(m_Area);
-
-		if ((m_BmpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
-		ClearTissue(0);
-	}
-
-	m_Loaded = true;
-
-#ifdef _MSC_VER
-	int result =
-			_fseeki64(fp, (__int64)(bitsize) * sizeof(float) * slicenr, SEEK_SET);
-#else
-	int result =
-			fseek(fp, (size_t)(bitsize) * sizeof(float) * slicenr, SEEK_SET);
-#endif
-	if (result)
-	{
-		/*			sliceprovide->take_back(bmp_bits);
-		sliceprovide->take_back(work_bits);
-		sliceprovide->take_back(help_bits);*/
-		fclose(fp);
-		return 0;
-	}
-
-	if (fread(m_BmpBits, 1, bitsize * sizeof(float), fp) < m_Area * sizeof(float))
-	{
-		/*			sliceprovide->take_back(bmp_bits);
-		sliceprovide->take_back(work_bits);
-		sliceprovide->take_back(help_bits);*/
-		fclose(fp);
-		return 0;
-	}
-
-	for (unsigned int i = 0; i < bitsize; i++)
-	{
-		m_WorkBits[i] = m_BmpBits[i];
-	}
-
-	fclose(fp);
-	ClearMarks();
-	ClearVvm();
-	ClearLimits();
-	m_Mode1 = m_Mode2 = 1;
-	return 1;
-}
-
-int Bmphandler::ReadRawFloat(const char* filename, short unsigned w, short unsigned h, unsigned short slicenr, Point p, unsigned short dx, unsigned short dy)
-{
-	FILE* fp;							/* Open file pointer */
-	unsigned int bitsize; /* Size of bitmap */
-
-	if ((fp = fopen(filename, "rb")) == nullptr)
-		return 0;
-
-	m_Width = dx;
-	m_Height = dy;
-	unsigned newarea = m_Height * (unsigned int)m_Width;
-	unsigned int area2 = h * (unsigned int)w;
-
-	bitsize = newarea;
-
-	if (m_Area != newarea)
-	{
-		if (m_Loaded)
-		{
-			ClearStack();
-			m_Sliceprovide->TakeBack(m_BmpBits);
-			m_Sliceprovide->TakeBack(m_WorkBits);
-			m_Sliceprovide->TakeBack(m_HelpBits);
-			for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
-			{
-				free(m_Tissuelayers[idx]);
-			}
-			m_Tissuelayers.clear();
-			m_SliceprovideInstaller->Uninstall(m_Sliceprovide);
-		}
-
-		m_Area = newarea;
-
-		m_Sliceprovide = m_SliceprovideInstaller->Install(m_Area);
-
-		if ((m_BmpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
-		ClearTissue(0);
-	}
-	else if (!m_Loaded)
-	{
-		m_Sliceprovide = m_SliceprovideInstaller->Install(m_Area);
-
-		if ((m_BmpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_WorkBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		if ((m_HelpBits = m_Sliceprovide->GiveMe()) == nullptr)
-		{
-			/* Couldn't allocate memory - return nullptr! */
-			//       free(*info);
-			fclose(fp);
-			return 0;
-		}
-
-		m_Tissuelayers.push_back((tissues_size_t*)malloc(sizeof(tissues_size_t) * m_Area));
-		ClearTissue(0);
-	}
-
-	m_Loaded = true;
-
-#ifdef _MSC_VER
-	int result = _fseeki64(fp, ((__int64)(area2)*slicenr + (__int64)(w)*p.py + p.px) * sizeof(float), SEEK_SET);
-#else
-	int result = fseek(fp, ((size_t)(area2)*slicenr + (size_t)(w)*p.py + p.px) * sizeof(float), SEEK_SET);
-#endif
-	if (result)
-	{
-		/*			free(bmp_bits);
-		free(work_bits);
-		free(help_bits);*/
-		fclose(fp);
-		return 0;
-	}
-
-	for (unsigned short n = 0; n < dy; n++)
-	{
-		if ((unsigned short)fread(m_BmpBits + n * dx, 1, dx * sizeof(float), fp) < sizeof(float) * dx)
-		{
-			/*				free(bmp_bits);
-			free(work_bits);
-			free(help_bits);*/
-			fclose(fp);
-			return 0;
-		}
-#ifdef _MSC_VER
-		result = _fseeki64(fp, (__int64)(w - dx) * sizeof(float), SEEK_CUR);
-#else
-		result = fseek(fp, (size_t)(w - dx) * sizeof(float), SEEK_CUR);
-#endif
-		if (result)
-		{
-			/*				free(bmp_bits);
-			free(work_bits);
-			free(help_bits);*/
-			fclose(fp);
-			return 0;
-		}
-	}
-
-	for (unsigned int i = 0; i < bitsize; i++)
-	{
-		m_WorkBits[i] = m_BmpBits[i];
-	}
-
-	fclose(fp);
-	ClearMarks();
-	ClearVvm();
-	ClearLimits();
-	m_Mode1 = m_Mode2 = 1;
-	return 1;
-}
-
-int Bmphandler::ReloadRaw(const char* filename, unsigned bitdepth, unsigned slicenr)
-{
-	if (!m_Loaded)
-		return 0;
-
-	FILE* fp;							/* Open file pointer */
-	unsigned int bitsize; /* Size of bitmap */
-
-	if ((fp = fopen(filename, "rb")) == nullptr)
-		return 0;
-
-	bitsize = m_Area;
-
-	unsigned bytedepth = (bitdepth + 7) / 8;
-
-	if (bytedepth == 1)
-	{
-		unsigned char* bits_tmp;
-
-		if ((bits_tmp = (unsigned char*)malloc(bitsize)) == nullptr)
-		{
-			fclose(fp);
-			return 0;
-		}
-
-#ifdef _MSC_VER
-		int result = _fseeki64(fp, (__int64)(bitsize)*slicenr, SEEK_SET);
-#else
-		int result = fseek(fp, (size_t)(bitsize)*slicenr, SEEK_SET);
-#endif
-		if (result)
-		{
-			free(bits_tmp);
-			fclose(fp);
-			return 0;
-		}
-
-		if (fread(bits_tmp, 1, bitsize, fp) < m_Area)
-		{
-			free(bits_tmp);
-			fclose(fp);
-			return 0;
-		}
-
-		for (unsigned int i = 0; i < bitsize; i++)
-		{
-			m_BmpBits[i] = (float)bits_tmp[i];
-		}
-
-		free(bits_tmp);
-	}
-	else if (bytedepth == 2)
-	{
-		unsigned short* bits_tmp;
-
-		if ((bits_tmp = (unsigned short*)malloc(bitsize * 2)) == nullptr)
-		{
-			fclose(fp);
-			return 0;
-		}
-
-#ifdef _MSC_VER
-		int result = _fseeki64(fp, (__int64)(bitsize)*2 * slicenr, SEEK_SET);
-#else
-		int result = fseek(fp, (size_t)(bitsize)*2 * slicenr, SEEK_SET);
-#endif
-		if (result)
-		{
-			free(bits_tmp);
-			fclose(fp);
-			return 0;
-		}
-
-		if (fread(bits_tmp, 1, bitsize * 2, fp) < m_Area * 2)
-		{
-			free(bits_tmp);
-			fclose(fp);
-			return 0;
-		}
-
-		for (unsigned int i = 0; i < bitsize; i++)
-		{
-			m_BmpBits[i] = (float)bits_tmp[i];
-		}
-
-		free(bits_tmp);
-	}
-	else
-	{
-		fclose(fp);
-		return 0;
-	}
-
-	fclose(fp);
-	m_Mode1 = 1;
-	return 1;
-}
-
-int Bmphandler::ReloadRaw(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned slicenr, Point p)
-{
-	if (!m_Loaded)
-		return 0;
-
-	FILE* fp;							/* Open file pointer */
-	unsigned int bitsize; /* Size of bitmap */
-
-	if ((fp = fopen(filename, "rb")) == nullptr)
-		return 0;
-
-	bitsize = m_Area;
-	unsigned long area2 = (unsigned long)(w)*h;
-
-	unsigned bytedepth = (bitdepth + 7) / 8;
-
-	if (bytedepth == 1)
-	{
-		unsigned char* bits_tmp;
-
-		if ((bits_tmp = (unsigned char*)malloc(bitsize)) == nullptr)
-		{
-			fclose(fp);
-			return 0;
-		}
-
-#ifdef _MSC_VER
-		int result = _fseeki64(fp, (__int64)(area2)*slicenr + (__int64)(w)*p.py + p.px, SEEK_SET);
-#else
-		int result = fseek(fp, (size_t)(area2)*slicenr + (size_t)(w)*p.py + p.px, SEEK_SET);
-#endif
-		if (result)
-		{
-			free(bits_tmp);
-			fclose(fp);
-			return 0;
-		}
-
-		for (unsigned short n = 0; n < m_Height; n++)
-		{
-			if ((unsigned short)fread(bits_tmp + n * m_Width, 1, m_Width, fp) <
-					m_Width)
-			{
-				free(bits_tmp);
-				fclose(fp);
-				return 0;
-			}
-#ifdef _MSC_VER
-			result = _fseeki64(fp, (__int64)w - m_Width, SEEK_CUR);
-#else
-			result = fseek(fp, (size_t)w - m_Width, SEEK_CUR);
-#endif
-			if (result)
-			{
-				free(bits_tmp);
-				fclose(fp);
-				return 0;
-			}
-		}
-
-		for (unsigned int i = 0; i < bitsize; i++)
-		{
-			m_BmpBits[i] = (float)bits_tmp[i];
-		}
-
-		free(bits_tmp);
-	}
-	else if (bytedepth == 2)
-	{
-		unsigned short* bits_tmp;
-
-		if ((bits_tmp = (unsigned short*)malloc(bitsize * 2)) == nullptr)
-		{
-			fclose(fp);
-			return 0;
-		}
-
-#ifdef _MSC_VER
-		int result = _fseeki64(fp, ((__int64)(area2)*slicenr + (__int64)(w)*p.py + p.px) * 2, SEEK_SET);
-#else
-		int result = fseek(fp, ((size_t)(area2)*slicenr + (size_t)(w)*p.py + p.px) * 2, SEEK_SET);
-#endif
-		if (result)
-		{
-			free(bits_tmp);
-			fclose(fp);
-			return 0;
-		}
-
-		for (unsigned short n = 0; n < m_Height; n++)
-		{
-			if ((unsigned short)fread(bits_tmp + n * m_Width, 1, m_Width * 2, fp) <
-					2 * m_Width)
-			{
-				free(bits_tmp);
-				fclose(fp);
-				return 0;
-			}
-#ifdef _MSC_VER
-			result = _fseeki64(fp, ((__int64)(w)-m_Width) * 2, SEEK_CUR);
-#else
-			result = fseek(fp, ((size_t)(w)-m_Width) * 2, SEEK_CUR);
-#endif
-			if (result)
-			{
-				free(bits_tmp);
-				fclose(fp);
-				return 0;
-			}
-		}
-
-		for (unsigned int i = 0; i < bitsize; i++)
-		{
-			m_BmpBits[i] = (float)bits_tmp[i];
-		}
-
-		free(bits_tmp);
-	}
-	else
-	{
-		fclose(fp);
-		return 0;
-	}
-
-	fclose(fp);
-	m_Mode1 = 1;
-	return 1;
-}
-
-int Bmphandler::ReloadRawFloat(const char* filename, unsigned slicenr)
-{
-	if (!m_Loaded)
-		return 0;
-
-	FILE* fp;							/* Open file pointer */
-	unsigned int bitsize; /* Size of bitmap */
-
-	if ((fp = fopen(filename, "rb")) == nullptr)
-		return 0;
-
-	bitsize = m_Area;
-
-#ifdef _MSC_VER
-	int result =
-			_fseeki64(fp, (__int64)(bitsize) * sizeof(float) * slicenr, SEEK_SET);
-#else
-	int result =
-			fseek(fp, (size_t)(bitsize) * sizeof(float) * slicenr, SEEK_SET);
-#endif
-	if (result)
-	{
-		fclose(fp);
-		return 0;
-	}
-
-	if (fread(m_BmpBits, 1, bitsize * sizeof(float), fp) < m_Area * sizeof(float))
-	{
-		fclose(fp);
-		return 0;
-	}
-
-	fclose(fp);
-	m_Mode1 = 1;
-	return 1;
-}
-
-float* Bmphandler::ReadRawFloat(const char* filename, unsigned slicenr, unsigned int area)
-{
-	FILE* fp; /* Open file pointer */
-
-	if ((fp = fopen(filename, "rb")) == nullptr)
-		return nullptr;
-
-#ifdef _MSC_VER
-	int result =
-			_fseeki64(fp, (__int64)(area) * sizeof(float) * slicenr, SEEK_SET);
-#else
-	int result = fseek(fp, (size_t)(area) * sizeof(float) * slicenr, SEEK_SET);
-#endif
-	if (result)
-	{
-		fclose(fp);
-		return nullptr;
-	}
-
-	float* bits_red;
-
-	if ((bits_red = (float*)malloc(sizeof(float) * area)) == nullptr)
-	{
-		fclose(fp);
-		return nullptr;
-	}
-
-	if (fread(bits_red, 1, area * sizeof(float), fp) < area * sizeof(float))
-	{
-		fclose(fp);
-		return nullptr;
-	}
-
-	fclose(fp);
-	return bits_red;
-}
-
-int Bmphandler::ReloadRawFloat(const char* filename, short unsigned w, short unsigned h, unsigned slicenr, Point p)
-{
-	if (!m_Loaded)
-		return 0;
-
-	FILE* fp;							/* Open file pointer */
-	unsigned int bitsize; /* Size of bitmap */
-
-	if ((fp = fopen(filename, "rb")) == nullptr)
-		return 0;
-
-	bitsize = m_Area;
-	unsigned long area2 = (unsigned long)(w)*h;
-
-#ifdef _MSC_VER
-	int result = _fseeki64(fp, ((__int64)(area2)*slicenr + (__int64)(w)*p.py + p.px) * sizeof(float), SEEK_SET);
-#else
-	int result = fseek(fp, ((size_t)(area2)*slicenr + (size_t)(w)*p.py + p.px) * sizeof(float), SEEK_SET);
-#endif
-	if (result)
-	{
-		fclose(fp);
-		return 0;
-	}
+		unsigned char* bits_tmp = (unsigned char*)data;
+
+		for (unsigned int i = 0; i < bitsize; i++)
+		{
+			work[i] = m_BmpBits[i] = (float)bits_tmp[i];
+		}
 
-	for (unsigned short n = 0; n < m_Height; n++)
+		free(data);
+	}
+	else if (type == avw::ushort)
 	{
-		if ((unsigned short)fread(m_BmpBits + n * m_Width, 1, m_Width * sizeof(float), fp) < sizeof(float) * m_Width)
+		unsigned short* bits_tmp = (unsigned short*)data;
+
+		for (unsigned int i = 0; i < bitsize; i++)
 		{
-			fclose(fp);
-			return 0;
+			work[i] = m_BmpBits[i] = (float)bits_tmp[i];
 		}
-#ifdef _MSC_VER
-		result = _fseeki64(fp, (__int64)(w - m_Width) * sizeof(float), SEEK_CUR);
-#else
-		result = fseek(fp, (size_t)(w - m_Width) * sizeof(float), SEEK_CUR);
-#endif
-		if (result)
+
+		free(data);
+	}
+	else if (type == avw::sshort)
+	{
+		short* bits_tmp = (short*)data;
+
+		for (unsigned int i = 0; i < bitsize; i++)
 		{
-			fclose(fp);
-			return 0;
+			work[i] = m_BmpBits[i] = (float)bits_tmp[i];
 		}
+
+		free(data);
+	}
+	else
+	{
+		return 0;
 	}
 
-	fclose(fp);
-	m_Mode1 = 1;
+	ClearMarks();
+	ClearVvm();
+	ClearLimits();
+	m_Mode1 = m_Mode2 = 2;
 	return 1;
 }
 
@@ -4359,7 +3296,7 @@ int Bmphandler::ReloadRawTissues(const char* filename, unsigned bitdepth, unsign
 
 		for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
 		{
-			tissues_size_t* tissues = m_Tissuelayers[idx];
+			tissues_size_t* tissues = TissueLayer(idx);
 			for (unsigned int i = 0; i < m_Area; i++)
 			{
 				tissues[i] = (tissues_size_t)bits_tmp[i + idx * m_Area];
@@ -4399,7 +3336,7 @@ int Bmphandler::ReloadRawTissues(const char* filename, unsigned bitdepth, unsign
 
 		for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
 		{
-			tissues_size_t* tissues = m_Tissuelayers[idx];
+			tissues_size_t* tissues = TissueLayer(idx);
 			for (unsigned int i = 0; i < m_Area; i++)
 			{
 				tissues[i] = (tissues_size_t)bits_tmp[i + idx * m_Area];
@@ -4418,7 +3355,7 @@ int Bmphandler::ReloadRawTissues(const char* filename, unsigned bitdepth, unsign
 	return 1;
 }
 
-int Bmphandler::ReloadRawTissues(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned slicenr, Point p)
+int Bmphandler::ReloadRawTissues(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, Point p)
 {
 	if (!m_Loaded)
 		return 0;
@@ -4458,9 +3395,9 @@ int Bmphandler::ReloadRawTissues(const char* filename, short unsigned w, short u
 
 		for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
 		{
-			for (unsigned short n = 0; n < m_Height; n++)
+			for (unsigned n = 0; n < m_Height; n++)
 			{
-				if ((unsigned short)fread(bits_tmp + m_Area * idx + n * m_Width, 1, m_Width, fp) < m_Width)
+				if ((unsigned)fread(bits_tmp + m_Area * idx + n * m_Width, 1, m_Width, fp) < m_Width)
 				{
 					free(bits_tmp);
 					fclose(fp);
@@ -4493,7 +3430,7 @@ int Bmphandler::ReloadRawTissues(const char* filename, short unsigned w, short u
 
 		for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
 		{
-			tissues_size_t* tissues = m_Tissuelayers[idx];
+			tissues_size_t* tissues = TissueLayer(idx);
 			for (unsigned int i = 0; i < m_Area; i++)
 			{
 				tissues[i] = (tissues_size_t)bits_tmp[i + idx * m_Area];
@@ -4526,9 +3463,9 @@ int Bmphandler::ReloadRawTissues(const char* filename, short unsigned w, short u
 
 		for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
 		{
-			for (unsigned short n = 0; n < m_Height; n++)
+			for (unsigned n = 0; n < m_Height; n++)
 			{
-				if ((unsigned short)fread(bits_tmp + m_Area * idx + n * m_Width, 1, m_Width * 2, fp) < 2 * m_Width)
+				if ((unsigned)fread(bits_tmp + m_Area * idx + n * m_Width, 1, m_Width * 2, fp) < 2 * m_Width)
 				{
 					free(bits_tmp);
 					fclose(fp);
@@ -4561,7 +3498,7 @@ int Bmphandler::ReloadRawTissues(const char* filename, short unsigned w, short u
 
 		for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
 		{
-			tissues_size_t* tissues = m_Tissuelayers[idx];
+			tissues_size_t* tissues = TissueLayer(idx);
 			for (unsigned int i = 0; i < m_Area; i++)
 			{
 				tissues[i] = (tissues_size_t)bits_tmp[i + idx * m_Area];
@@ -4587,7 +3524,7 @@ int Bmphandler::SaveBmpRaw(const char* filename)
 
 int Bmphandler::SaveWorkRaw(const char* filename)
 {
-	return SaveRaw(filename, m_WorkBits);
+	return SaveRaw(filename, WorkBits());
 }
 
 int Bmphandler::SaveRaw(const char* filename, float* p_bits) const
@@ -4634,7 +3571,7 @@ int Bmphandler::SaveTissueRaw(tissuelayers_size_t idx, const char* filename)
 			(sizeof(tissues_size_t) > sizeof(unsigned char)))
 	{
 		unsigned char* uchar_buffer = new unsigned char[bitsize];
-		tissues_size_t* tissues = m_Tissuelayers[idx];
+		tissues_size_t* tissues = TissueLayer(idx);
 		for (unsigned int i = 0; i < bitsize; ++i)
 		{
 			uchar_buffer[i] = (unsigned char)tissues[i];
@@ -4649,7 +3586,7 @@ int Bmphandler::SaveTissueRaw(tissuelayers_size_t idx, const char* filename)
 	}
 	else
 	{
-		if (fwrite(m_Tissuelayers[idx], sizeof(tissues_size_t), bitsize, fp) <
+		if (fwrite(TissueLayer(idx), sizeof(tissues_size_t), bitsize, fp) <
 				bitsize)
 		{
 			fclose(fp);
@@ -4663,7 +3600,7 @@ int Bmphandler::SaveTissueRaw(tissuelayers_size_t idx, const char* filename)
 
 void Bmphandler::SetWorkPt(Point p, float f)
 {
-	m_WorkBits[m_Width * p.py + p.px] = f;
+	WorkBits()[m_Width * p.py + p.px] = f;
 }
 
 void Bmphandler::SetBmpPt(Point p, float f)
@@ -4673,16 +3610,19 @@ void Bmphandler::SetBmpPt(Point p, float f)
 
 void Bmphandler::SetTissuePt(tissuelayers_size_t idx, Point p, tissues_size_t f)
 {
-	m_Tissuelayers[idx][m_Width * p.py + p.px] = f;
+	TissueLayer(idx)[m_Width * p.py + p.px] = f;
 }
 
 float Bmphandler::BmpPt(Point p) { return m_BmpBits[m_Width * p.py + p.px]; }
 
-float Bmphandler::WorkPt(Point p) { return m_WorkBits[m_Width * p.py + p.px]; }
+float Bmphandler::WorkPt(Point p) { return ReadWork()[m_Width * p.py + p.px]; }
 
 tissues_size_t Bmphandler::TissuesPt(tissuelayers_size_t idx, Point p)
 {
-	return Bmphandler::m_Tissuelayers[idx][m_Width * p.py + p.px];
+	// reading a single label does not decompress the slice
+	if (idx < m_PackedTissues.size())
+		return m_PackedTissues[idx].Value(p.px, p.py);
+	return Bmphandler::TissueLayer(idx)[m_Width * p.py + p.px];
 }
 
 void Bmphandler::PrintInfo() const
@@ -4708,7 +3648,7 @@ void Bmphandler::PrintInfo() const
 	}*/
 }
 
-unsigned int Bmphandler::ReturnArea() const { return m_Area; }
+size_t Bmphandler::ReturnArea() const { return m_Area; }
 
 unsigned int Bmphandler::ReturnWidth() const { return m_Width; }
 
@@ -4720,9 +3660,10 @@ unsigned int Bmphandler::MakeHistogram(bool includeoutofrange)
 	float k;
 	for (int i = 0; i < 256; i++)
 		m_Histogram[i] = 0;
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
-		k = m_WorkBits[i];
+		k = work[i];
 		if (k < 0 || k >= 256)
 		{
 			if (includeoutofrange && k < 0)
@@ -4743,11 +3684,12 @@ unsigned int Bmphandler::MakeHistogram(float* mask, float f, bool includeoutofra
 	float k;
 	for (int i = 0; i < 256; i++)
 		m_Histogram[i] = 0;
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
 		if (mask[i] == f)
 		{
-			k = m_WorkBits[i];
+			k = work[i];
 			if (k < 0 || k >= 256)
 			{
 				if (includeoutofrange && k < 0)
@@ -4763,7 +3705,7 @@ unsigned int Bmphandler::MakeHistogram(float* mask, float f, bool includeoutofra
 	return j;
 }
 
-unsigned int Bmphandler::MakeHistogram(Point p, unsigned short dx, unsigned short dy, bool includeoutofrange)
+unsigned int Bmphandler::MakeHistogram(Point p, unsigned dx, unsigned dy, bool includeoutofrange)
 {
 	unsigned int i, l;
 	l = 0;
@@ -4771,15 +3713,16 @@ unsigned int Bmphandler::MakeHistogram(Point p, unsigned short dx, unsigned shor
 	for (i = 0; i < 256; i++)
 		m_Histogram[i] = 0;
 
-	dx = std::min(int(dx), m_Width - p.px);
-	dy = std::min(int(dy), m_Height - p.py);
+	dx = std::min(int(dx), static_cast<int>(m_Width) - p.px);
+	dy = std::min(int(dy), static_cast<int>(m_Height) - p.py);
 
 	i = Pt2coord(p);
+	float* work = WorkBits();
 	for (int j = 0; j < dy; j++)
 	{
 		for (int k = 0; k < dx; k++)
 		{
-			m = m_WorkBits[i];
+			m = work[i];
 			if (m < 0 || m >= 256)
 			{
 				if (includeoutofrange && k < 0)
@@ -4809,39 +3752,41 @@ void Bmphandler::PrintHistogram()
 
 void Bmphandler::Threshold(float* thresholds)
 {
-	const short unsigned n = (short unsigned)thresholds[0];
+	const unsigned n = (unsigned)thresholds[0];
 
 	if (n > 0)
 	{
 		const float leveldiff = 255.0f / n;
 
-		short unsigned j;
+		unsigned j;
 
+		float* work = WorkBits();
 		for (unsigned int i = 0; i < m_Area; i++)
 		{
 			j = 0;
 			while (j < n && m_BmpBits[i] > thresholds[j + 1])
 				j++;
-			m_WorkBits[i] = j * leveldiff;
+			work[i] = j * leveldiff;
 		}
 	}
 
 	m_Mode2 = 2;
 }
 
-void Bmphandler::Threshold(float* thresholds, Point p, unsigned short dx, unsigned short dy)
+void Bmphandler::Threshold(float* thresholds, Point p, unsigned dx, unsigned dy)
 {
-	dx = std::min(int(dx), m_Width - p.px);
-	dy = std::min(int(dy), m_Width - p.py);
+	dx = std::min(int(dx), static_cast<int>(m_Width) - p.px);
+	dy = std::min(int(dy), static_cast<int>(m_Width) - p.py);
 
-	short unsigned n = (short unsigned)thresholds[0];
+	unsigned n = (unsigned)thresholds[0];
 	if (n > 0)
 	{
 		const float leveldiff = 255.0f / n;
-		short unsigned l;
+		unsigned l;
 		unsigned int i;
 		i = Pt2coord(p);
 
+		float* work = WorkBits();
 		for (int j = 0; j < dy; j++)
 		{
 			for (int k = 0; k < dx; k++)
@@ -4849,7 +3794,7 @@ void Bmphandler::Threshold(float* thresholds, Point p, unsigned short dx, unsign
 				l = 0;
 				while (m_BmpBits[i] > thresholds[l + 1] && l < n)
 					l++;
-				m_WorkBits[i] = l * leveldiff;
+				work[i] = l * leveldiff;
 				i++;
 			}
 			i = i + m_Width - dx;
@@ -4861,58 +3806,86 @@ void Bmphandler::Threshold(float* thresholds, Point p, unsigned short dx, unsign
 
 void Bmphandler::Work2bmp()
 {
-	for (unsigned int i = 0; i < m_Area; i++)
-		m_BmpBits[i] = m_WorkBits[i];
+	const float* work = ReadWork();
+	std::copy(work, work + m_Area, m_BmpBits);
 
 	m_Mode1 = m_Mode2;
 }
 
 void Bmphandler::Bmp2work()
 {
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] = m_BmpBits[i];
+		work[i] = m_BmpBits[i];
 
 	m_Mode2 = m_Mode1;
 }
 
 void Bmphandler::Work2tissue(tissuelayers_size_t idx)
 {
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
+	if (m_WorkBits == nullptr)
+	{
+		std::fill(tissues, tissues + m_Area, 0);
+		return;
+	}
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
-		if (m_WorkBits[i] < 0.0f)
+		if (work[i] < 0.0f)
 			tissues[i] = 0;
-		else if (m_WorkBits[i] > (float)TISSUES_SIZE_MAX)
+		else if (work[i] > (float)TISSUES_SIZE_MAX)
 			tissues[i] = TISSUES_SIZE_MAX;
 		else
-			tissues[i] = (tissues_size_t)floor(m_WorkBits[i] + 0.5f);
+			tissues[i] = (tissues_size_t)floor(work[i] + 0.5f);
 	}
 }
 
 void Bmphandler::Mergetissue(tissues_size_t tissuetype, tissuelayers_size_t idx)
 {
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	if (m_WorkBits == nullptr)
+		return;
+
+	tissues_size_t* tissues = TissueLayer(idx);
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
-		if (m_WorkBits[i] > 0.0f)
+		if (work[i] > 0.0f)
 			tissues[i] = tissuetype;
 	}
 }
 
 void Bmphandler::SwapBmpwork()
 {
-	std::swap(m_BmpBits, m_WorkBits);
+	if (m_WorkBits == nullptr)
+	{
+		// the source must stay allocated, the target is allocated for the old source
+		m_WorkBits = m_BmpBits;
+		m_BmpBits = ZeroedBits();
+	}
+	else
+	{
+		std::swap(m_BmpBits, m_WorkBits);
+	}
 	std::swap(m_Mode1, m_Mode2);
 }
 
 void Bmphandler::SwapBmphelp()
 {
-	std::swap(m_HelpBits, m_BmpBits);
+	std::swap(HelpBits(), m_BmpBits);
 }
 
 void Bmphandler::SwapWorkhelp()
 {
-	std::swap(m_HelpBits, m_WorkBits);
+	if (HasStorage())
+	{
+		// the storage view must not be replaced by an unallocated buffer
+		std::swap(HelpBits(), WorkBits());
+	}
+	else
+	{
+		std::swap(m_HelpBits, m_WorkBits);
+	}
 }
 
 float* Bmphandler::MakeGaussfilter(float sigma, int n)
@@ -4951,10 +3924,11 @@ float* Bmphandler::MakeLaplacianfilter()
 	return filter;
 }
 
-void Bmphandler::Convolute(float* mask, unsigned short direction)
+void Bmphandler::Convolute(float* mask, unsigned direction)
 {
 	unsigned i, n;
 	float dummy;
+	float* work = WorkBits();
 	switch (direction)
 	{
 	case 0:
@@ -4967,7 +3941,7 @@ void Bmphandler::Convolute(float* mask, unsigned short direction)
 				dummy = 0;
 				for (unsigned l = 0; l < n; l++)
 					dummy += mask[l + 1] * m_BmpBits[i + l];
-				m_WorkBits[i + n / 2] = dummy;
+				work[i + n / 2] = dummy;
 				i++;
 			}
 			i += n - 1;
@@ -4976,7 +3950,7 @@ void Bmphandler::Convolute(float* mask, unsigned short direction)
 		i = 0;
 		for (unsigned j = 0; j < n / 2; j++)
 		{
-			m_WorkBits[i] = 0;
+			work[i] = 0;
 			i++;
 		}
 		i += m_Width - n + 1;
@@ -4984,13 +3958,13 @@ void Bmphandler::Convolute(float* mask, unsigned short direction)
 		{
 			for (unsigned j = 0; j < n - 1; j++)
 			{
-				m_WorkBits[i] = 0;
+				work[i] = 0;
 				i++;
 			}
 			i += m_Width - n + 1;
 		}
 		for (; i < m_Area; i++)
-			m_WorkBits[i] = 0;
+			work[i] = 0;
 		break;
 	case 1:
 		n = (unsigned)mask[0];
@@ -5000,14 +3974,14 @@ void Bmphandler::Convolute(float* mask, unsigned short direction)
 			dummy = 0;
 			for (unsigned l = 0; l < n; l++)
 				dummy += mask[l + 1] * m_BmpBits[i + l * m_Width];
-			m_WorkBits[i + (n / 2) * m_Width] = dummy;
+			work[i + (n / 2) * m_Width] = dummy;
 			i++;
 		}
 
 		for (i = 0; i < (n / 2) * m_Width; i++)
-			m_WorkBits[i] = 0;
+			work[i] = 0;
 		for (i = m_Area - (n / 2) * m_Width; i < m_Area; i++)
-			m_WorkBits[i] = 0;
+			work[i] = 0;
 		break;
 	case 2:
 		n = (unsigned)mask[0];
@@ -5026,7 +4000,7 @@ void Bmphandler::Convolute(float* mask, unsigned short direction)
 								mask[l + n * o + 2] * m_BmpBits[i + l + o * m_Width];
 					}
 				}
-				m_WorkBits[i + n / 2 + (m / 2) * m_Width] = dummy;
+				work[i + n / 2 + (m / 2) * m_Width] = dummy;
 				i++;
 			}
 			i += n - 1;
@@ -5035,7 +4009,7 @@ void Bmphandler::Convolute(float* mask, unsigned short direction)
 		i = 0;
 		for (unsigned j = 0; j < n / 2 + (m / 2) * m_Width; j++)
 		{
-			m_WorkBits[i] = 0;
+			work[i] = 0;
 			i++;
 		}
 		i += m_Width - n + 1;
@@ -5043,13 +4017,13 @@ void Bmphandler::Convolute(float* mask, unsigned short direction)
 		{
 			for (unsigned j = 0; j < n - 1; j++)
 			{
-				m_WorkBits[i] = 0;
+				work[i] = 0;
 				i++;
 			}
 			i += m_Width - n + 1;
 		}
 		for (; i < m_Area; i++)
-			m_WorkBits[i] = 0;
+			work[i] = 0;
 		break;
 	}
 }
@@ -5111,7 +4085,8 @@ void Bmphandler::GetRange(Pair* pp)
 {
 	if (m_Area > 0)
 	{
-		auto range = std::minmax_element(m_WorkBits, m_WorkBits + m_Area);
+		const float* work = ReadWork();
+		auto range = std::minmax_element(work, work + m_Area);
 		pp->low = *range.first;
 		pp->high = *range.second;
 	}
@@ -5121,7 +4096,7 @@ void Bmphandler::GetRangetissue(tissuelayers_size_t idx, tissues_size_t* pp)
 {
 	if (m_Area > 0)
 	{
-		tissues_size_t* tissues = m_Tissuelayers[idx];
+		tissues_size_t* tissues = TissueLayer(idx);
 		*pp = *std::max_element(tissues, tissues + m_Area);
 	}
 }
@@ -5140,14 +4115,16 @@ void Bmphandler::ScaleColors(Pair p)
 {
 	const float step = 255.0f / (p.high - p.low);
 
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] = (m_WorkBits[i] - p.low) * step;
+		work[i] = (work[i] - p.low) * step;
 }
 
 void Bmphandler::CropColors()
 {
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] = std::min(std::max(m_WorkBits[i], 0.0f), 255.0f);
+		work[i] = std::min(std::max(work[i], 0.0f), 255.0f);
 }
 
 void Bmphandler::Gaussian(float sigma)
@@ -5166,7 +4143,7 @@ void Bmphandler::Gaussian(float sigma)
 		m_BmpBits = m_Sliceprovide->GiveMe();
 		SwapBmpwork();
 		Convolute(dummy, 1);
-		m_Sliceprovide->TakeBack(m_BmpBits);
+		Recycle(m_BmpBits);
 		m_BmpBits = dummy1;
 
 		free(dummy);
@@ -5180,7 +4157,7 @@ void Bmphandler::Gaussian(float sigma)
 	m_Mode2 = 1;
 }
 
-void Bmphandler::Average(unsigned short n)
+void Bmphandler::Average(unsigned n)
 {
 	unsigned char dummymode1 = m_Mode1;
 	float* dummy1;
@@ -5190,7 +4167,7 @@ void Bmphandler::Average(unsigned short n)
 	float* filter = (float*)malloc((n + 1) * sizeof(float));
 
 	filter[0] = n;
-	for (short unsigned int i = 1; i <= n; i++)
+	for (unsigned int i = 1; i <= n; i++)
 		filter[i] = 1.0f / n;
 
 	Convolute(filter, 0);
@@ -5198,7 +4175,7 @@ void Bmphandler::Average(unsigned short n)
 	m_BmpBits = m_Sliceprovide->GiveMe();
 	SwapBmpwork();
 	Convolute(filter, 1);
-	m_Sliceprovide->TakeBack(m_BmpBits);
+	Recycle(m_BmpBits);
 	m_BmpBits = dummy1;
 
 	free(filter);
@@ -5218,7 +4195,7 @@ void Bmphandler::Laplacian()
 	m_BmpBits = m_Sliceprovide->GiveMe();
 	SwapBmpwork();
 	Convolute(dummy, 1);
-	m_Sliceprovide->TakeBack(m_BmpBits);
+	Recycle(m_BmpBits);
 	m_BmpBits = dummy1;
 	//	bmp_abs();
 
@@ -5318,42 +4295,43 @@ void Bmphandler::NonmaximumSupr(float* direct_map)
 	float* results = m_Sliceprovide->GiveMe();
 	float left_bit, right_bit;
 	int i = m_Width + 1;
+	float* work = WorkBits();
 	for (int j = 1; j < m_Height - 1; j++)
 	{
 		for (int k = 1; k < m_Width - 1; k++)
 		{
 			if (direct_map[i] < 22.5 || direct_map[i] >= 157.5)
 			{
-				left_bit = m_WorkBits[i - 1];
-				right_bit = m_WorkBits[i + 1];
+				left_bit = work[i - 1];
+				right_bit = work[i + 1];
 			}
 			else if (direct_map[i] < 67.5)
 			{
-				left_bit = m_WorkBits[i - 1 - m_Width];
-				right_bit = m_WorkBits[i + 1 + m_Width];
+				left_bit = work[i - 1 - m_Width];
+				right_bit = work[i + 1 + m_Width];
 			}
 			else if (direct_map[i] < 112.5)
 			{
-				left_bit = m_WorkBits[i + m_Width];
-				right_bit = m_WorkBits[i - m_Width];
+				left_bit = work[i + m_Width];
+				right_bit = work[i - m_Width];
 			}
 			else if (direct_map[i] < 157.5)
 			{
-				left_bit = m_WorkBits[i + m_Width - 1];
-				right_bit = m_WorkBits[i - m_Width + 1];
+				left_bit = work[i + m_Width - 1];
+				right_bit = work[i - m_Width + 1];
 			}
 
-			if (m_WorkBits[i] < left_bit || m_WorkBits[i] < right_bit)
+			if (work[i] < left_bit || work[i] < right_bit)
 				results[i] = 0;
 			else
-				results[i] = m_WorkBits[i];
+				results[i] = work[i];
 			i++;
 		}
 
 		i += 2;
 	}
 
-	m_Sliceprovide->TakeBack(m_WorkBits);
+	Recycle(m_WorkBits);
 	m_WorkBits = results;
 }
 
@@ -5378,11 +4356,11 @@ void Bmphandler::CannyLine(float sigma, float thresh_low, float thresh_high)
 	SwapBmpwork();
 	Hysteretic(thresh_low, thresh_high, true, 255);
 
-	m_Sliceprovide->TakeBack(dummy);
-	m_Sliceprovide->TakeBack(sobelx);
-	m_Sliceprovide->TakeBack(sobely);
+	Recycle(dummy);
+	Recycle(sobelx);
+	Recycle(sobely);
 
-	m_Sliceprovide->TakeBack(m_BmpBits);
+	Recycle(m_BmpBits);
 	m_BmpBits = tmp;
 
 	m_Mode1 = dummymode1;
@@ -5429,11 +4407,12 @@ void Bmphandler::Hysteretic(float thresh_low, float thresh_high, bool connectivi
 
 	i = m_Width + 3;
 	int i2 = 0;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			m_WorkBits[i2] = results[i];
+			work[i2] = results[i];
 			i++;
 			i2++;
 		}
@@ -5455,12 +4434,13 @@ void Bmphandler::Hysteretic(float thresh_low, float thresh_high, bool connectivi
 
 	int i = m_Width + 3;
 	int i1 = 0;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			if (m_WorkBits[i1] != 0)
-				results[i] = m_WorkBits[i1];
+			if (work[i1] != 0)
+				results[i] = work[i1];
 			else
 			{
 				if (m_BmpBits[i1] >= thresh_high)
@@ -5502,7 +4482,7 @@ void Bmphandler::Hysteretic(float thresh_low, float thresh_high, bool connectivi
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			m_WorkBits[i2] = results[i];
+			work[i2] = results[i];
 			i++;
 			i2++;
 		}
@@ -5558,11 +4538,12 @@ void Bmphandler::DoubleHysteretic(float thresh_low_l, float thresh_low_h, float
 
 	i = m_Width + 3;
 	int i2 = 0;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			m_WorkBits[i2] = results[i];
+			work[i2] = results[i];
 			i++;
 			i2++;
 		}
@@ -5584,12 +4565,13 @@ void Bmphandler::DoubleHysteretic(float thresh_low_l, float thresh_low_h, float
 
 	int i = m_Width + 3;
 	int i1 = 0;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			if (m_WorkBits[i1] != 0)
-				results[i] = m_WorkBits[i1];
+			if (work[i1] != 0)
+				results[i] = work[i1];
 			else
 			{
 				if (m_BmpBits[i1] > thresh_high_h)
@@ -5643,7 +4625,7 @@ void Bmphandler::DoubleHysteretic(float thresh_low_l, float thresh_low_h, float
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			m_WorkBits[i2] = results[i];
+			work[i2] = results[i];
 			i++;
 			i2++;
 		}
@@ -5697,11 +4679,12 @@ void Bmphandler::ThresholdedGrowing(Point p, float thresh_low, float thresh_high
 
 	i = m_Width + 3;
 	int i2 = 0;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			m_WorkBits[i2] = results[i];
+			work[i2] = results[i];
 			i++;
 			i2++;
 		}
@@ -5759,11 +4742,12 @@ void Bmphandler::ThresholdedGrowing(Point p, float thresh_low, float thresh_high
 
 	i = m_Width + 3;
 	int i2 = 0;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			m_WorkBits[i2] = results[i];
+			work[i2] = results[i];
 			i++;
 			i2++;
 		}
@@ -5825,11 +4809,12 @@ void Bmphandler::ThresholdedGrowinglimit(Point p, float thresh_low, float thresh
 
 	i = m_Width + 3;
 	int i2 = 0;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			m_WorkBits[i2] = results[i];
+			work[i2] = results[i];
 			i++;
 			i2++;
 		}
@@ -5888,11 +4873,12 @@ void Bmphandler::ThresholdedGrowing(Point p, float threshfactor_low, float thres
 
 	i = m_Width + 3;
 	int i2 = 0;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			m_WorkBits[i2] = results[i];
+			work[i2] = results[i];
 			i++;
 			i2++;
 		}
@@ -5917,12 +4903,13 @@ void Bmphandler::ThresholdedGrowing(float thresh_low, float thresh_high, bool co
 
 	int i = m_Width + 3;
 	int i1 = 0;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			if (m_WorkBits[i1] > 0)
-				results[i] = m_WorkBits[i1];
+			if (work[i1] > 0)
+				results[i] = work[i1];
 			else
 			{
 				if (m_BmpBits[i1] <= thresh_high && m_BmpBits[i1] >= thresh_low)
@@ -5961,7 +4948,7 @@ void Bmphandler::ThresholdedGrowing(float thresh_low, float thresh_high, bool co
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			m_WorkBits[i2] = results[i];
+			work[i2] = results[i];
 			i++;
 			i2++;
 		}
@@ -5975,7 +4962,7 @@ void Bmphandler::ThresholdedGrowing(float thresh_low, float thresh_high, bool co
 	m_Mode2 = 2;
 }
 
-void Bmphandler::HystereticGrowth(float* results, std::vector<int>* s, unsigned short w, unsigned short h, bool connectivity, float set_to)
+void Bmphandler::HystereticGrowth(float* results, std::vector<int>* s, unsigned w, unsigned h, bool connectivity, float set_to)
 {
 	unsigned char dummymode = m_Mode1;
 	int i;
@@ -6037,7 +5024,7 @@ void Bmphandler::HystereticGrowth(float* results, std::vector<int>* s, unsigned
 	m_Mode2 = 2;
 }
 
-void Bmphandler::HystereticGrowth(float* results, std::vector<int>* s, unsigned short w, unsigned short h, bool connectivity, float set_to, int nr)
+void Bmphandler::HystereticGrowth(float* results, std::vector<int>* s, unsigned w, unsigned h, bool connectivity, float set_to, int nr)
 {
 	std::vector<int> sta;
 	std::vector<int>* s1 = &sta;
@@ -6136,14 +5123,14 @@ void Bmphandler::Sobel()
 	m_BmpBits = tmp;
 	Convolute(mask1, 0);
 	tmp = m_BmpBits;
-	m_BmpBits = m_WorkBits;
+	m_BmpBits = WorkBits();
 	m_WorkBits = m_Sliceprovide->GiveMe();
 	Convolute(mask2, 1);
 	BmpAbs();
-	m_Sliceprovide->TakeBack(m_BmpBits);
+	Recycle(m_BmpBits);
 	m_BmpBits = dummy;
 	BmpSum();
-	m_Sliceprovide->TakeBack(m_BmpBits);
+	Recycle(m_BmpBits);
 	m_BmpBits = tmp;
 
 	m_Mode1 = dummymode;
@@ -6174,16 +5161,17 @@ void Bmphandler::SobelFiner()
 	m_BmpBits = tmp;
 	Convolute(mask1, 0);
 	tmp = m_BmpBits;
-	m_BmpBits = m_WorkBits;
+	m_BmpBits = WorkBits();
 	m_WorkBits = m_Sliceprovide->GiveMe();
 	Convolute(mask2, 1);
 	BmpAbs();
-	m_Sliceprovide->TakeBack(m_BmpBits);
+	Recycle(m_BmpBits);
 	m_BmpBits = dummy;
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
-		m_WorkBits[i] =
-				sqrt(m_WorkBits[i] * m_WorkBits[i] + m_BmpBits[i] * m_BmpBits[i]);
-	m_Sliceprovide->TakeBack(m_BmpBits);
+		work[i] =
+				sqrt(work[i] * work[i] + m_BmpBits[i] * m_BmpBits[i]);
+	Recycle(m_BmpBits);
 	m_BmpBits = tmp;
 
 	m_Mode1 = dummymode;
@@ -6197,14 +5185,15 @@ void Bmphandler::MedianInterquartile(bool median)
 
 	unsigned k = 0;
 
-	for (unsigned short i = 0; i < m_Height - 2; i++)
+	float* work = WorkBits();
+	for (unsigned i = 0; i < m_Height - 2; i++)
 	{
-		for (unsigned short j = 0; j < m_Width - 2; j++)
+		for (unsigned j = 0; j < m_Width - 2; j++)
 		{
 			fvec.clear();
-			for (unsigned short l = 0; l < 3; l++)
+			for (unsigned l = 0; l < 3; l++)
 			{
-				for (unsigned short m = 0; m < 3; m++)
+				for (unsigned m = 0; m < 3; m++)
 				{
 					fvec.push_back(m_BmpBits[k + l + m * m_Width]);
 				}
@@ -6212,9 +5201,9 @@ void Bmphandler::MedianInterquartile(bool median)
 
 			std::sort(fvec.begin(), fvec.end());
 			if (median)
-				m_WorkBits[k + 1 + m_Width] = fvec[4];
+				work[k + 1 + m_Width] = fvec[4];
 			else
-				m_WorkBits[k + 1 + m_Width] = fvec[7] - fvec[1];
+				work[k + 1 + m_Width] = fvec[7] - fvec[1];
 			k++;
 		}
 		k += 2;
@@ -6223,24 +5212,24 @@ void Bmphandler::MedianInterquartile(bool median)
 	if (median)
 	{
 		for (unsigned k = 0; k < m_Width; k++)
-			m_WorkBits[k] = m_BmpBits[k];
+			work[k] = m_BmpBits[k];
 		for (unsigned k = m_Area - m_Width; k < m_Area; k++)
-			m_WorkBits[k] = m_BmpBits[k];
+			work[k] = m_BmpBits[k];
 		for (unsigned k = 0; k < m_Area; k += m_Width)
-			m_WorkBits[k] = m_BmpBits[k];
+			work[k] = m_BmpBits[k];
 		for (unsigned k = m_Width - 1; k < m_Area; k += m_Width)
-			m_WorkBits[k] = m_BmpBits[k];
+			work[k] = m_BmpBits[k];
 	}
 	else
 	{
 		for (unsigned k = 0; k < m_Width; k++)
-			m_WorkBits[k] = 0;
+			work[k] = 0;
 		for (unsigned k = m_Area - m_Width; k < m_Area; k++)
-			m_WorkBits[k] = 0;
+			work[k] = 0;
 		for (unsigned k = 0; k < m_Area; k += m_Width)
-			m_WorkBits[k] = 0;
+			work[k] = 0;
 		for (unsigned k = m_Width - 1; k < m_Area; k += m_Width)
-			m_WorkBits[k] = 0;
+			work[k] = 0;
 	}
 
 	m_Mode1 = dummymode;
@@ -6254,14 +5243,14 @@ void Bmphandler::MedianInterquartile(float* median, float* iq)
 
 	unsigned k = 0;
 
-	for (unsigned short i = 0; i < m_Height - 2; i++)
+	for (unsigned i = 0; i < m_Height - 2; i++)
 	{
-		for (unsigned short j = 0; j < m_Width - 2; j++)
+		for (unsigned j = 0; j < m_Width - 2; j++)
 		{
 			fvec.clear();
-			for (unsigned short l = 0; l < 3; l++)
+			for (unsigned l = 0; l < 3; l++)
 			{
-				for (unsigned short m = 0; m < 3; m++)
+				for (unsigned m = 0; m < 3; m++)
 				{
 					fvec.push_back(m_BmpBits[k + l + m * m_Width]);
 				}
@@ -6296,7 +5285,7 @@ void Bmphandler::MedianInterquartile(float* median, float* iq)
 	m_Mode2 = 1;
 }
 
-void Bmphandler::Sigmafilter(float sigma, unsigned short nx, unsigned short ny)
+void Bmphandler::Sigmafilter(float sigma, unsigned nx, unsigned ny)
 {
 	unsigned char dummymode = m_Mode1;
 	if (nx % 2 == 0)
@@ -6304,12 +5293,13 @@ void Bmphandler::Sigmafilter(float sigma, unsigned short nx, unsigned short ny)
 	if (ny % 2 == 0)
 		ny++;
 
-	unsigned short counter;
+	unsigned counter;
 	float summa;
 	float dummy;
 
 	unsigned i = 0;
 
+	float* work = WorkBits();
 	for (int j = 0; j <= m_Height - ny; j++)
 	{
 		for (int k = 0; k <= m_Width - nx; k++)
@@ -6329,7 +5319,7 @@ void Bmphandler::Sigmafilter(float sigma, unsigned short nx, unsigned short ny)
 					}
 				}
 			}
-			m_WorkBits[i + nx / 2 + (ny / 2) * m_Width] = summa / counter;
+			work[i + nx / 2 + (ny / 2) * m_Width] = summa / counter;
 			i++;
 		}
 		i = i + nx - 1;
@@ -6351,21 +5341,22 @@ void Bmphandler::Sobelxy(float** sobelx, float** sobely)
 
 	Convolute(mask1, 1);
 	float* tmp = m_BmpBits;
-	m_BmpBits = m_WorkBits;
+	m_BmpBits = WorkBits();
 	m_WorkBits = *sobelx;
 	Convolute(mask2, 0);
 	m_WorkBits = m_BmpBits;
 	m_BmpBits = tmp;
 	Convolute(mask1, 0);
 	tmp = m_BmpBits;
-	m_BmpBits = m_WorkBits;
+	m_BmpBits = WorkBits();
 	m_WorkBits = *sobely;
 	Convolute(mask2, 1);
 	m_WorkBits = m_BmpBits;
 	m_BmpBits = tmp;
 
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] = abs((*sobelx)[i]) + abs((*sobely)[i]);
+		work[i] = abs((*sobelx)[i]) + abs((*sobely)[i]);
 }
 
 void Bmphandler::Compacthist()
@@ -6383,8 +5374,9 @@ void Bmphandler::Compacthist()
 	}
 	histmap[255] = dummy;
 
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		m_WorkBits[i] -= histmap[std::min((int)m_WorkBits[i], 255)];
+		work[i] -= histmap[std::min((int)work[i], 255)];
 }
 
 float* Bmphandler::FindModal(unsigned int thresh1, float thresh2)
@@ -6493,20 +5485,22 @@ void Bmphandler::Erosion1(int n, bool connectivity) // true for 8-, false for 4-
 
 	for (int l = 0; l < n; l++)
 	{
+		// the target is replaced by the result after each step
+		float* work = WorkBits();
 		for (unsigned int i = 0; i < m_Area; i++)
-			results[i] = m_WorkBits[i];
+			results[i] = work[i];
 
 		int i1 = 0;
 
-		for (unsigned short i = 0; i < (m_Height - 1); i++)
+		for (unsigned i = 0; i < (m_Height - 1); i++)
 		{
-			for (unsigned short j = 0; j < m_Width; j++)
+			for (unsigned j = 0; j < m_Width; j++)
 			{
-				if (m_WorkBits[i1] != m_WorkBits[i1 + m_Width])
+				if (work[i1] != work[i1 + m_Width])
 				{
-					if (m_WorkBits[i1] == 0)
+					if (work[i1] == 0)
 						results[i1 + m_Width] = 0;
-					else if (m_WorkBits[i1 + m_Width] == 0)
+					else if (work[i1 + m_Width] == 0)
 						results[i1] = 0;
 				}
 
@@ -6516,15 +5510,15 @@ void Bmphandler::Erosion1(int n, bool connectivity) // true for 8-, false for 4-
 
 		i1 = 0;
 
-		for (unsigned short i = 0; i < m_Height; i++)
+		for (unsigned i = 0; i < m_Height; i++)
 		{
-			for (unsigned short j = 0; j < (m_Width - 1); j++)
+			for (unsigned j = 0; j < (m_Width - 1); j++)
 			{
-				if (m_WorkBits[i1] != m_WorkBits[i1 + 1])
+				if (work[i1] != work[i1 + 1])
 				{
-					if (m_WorkBits[i1] == 0)
+					if (work[i1] == 0)
 						results[i1 + 1] = 0;
-					else if (m_WorkBits[i1 + 1] == 0)
+					else if (work[i1 + 1] == 0)
 						results[i1] = 0;
 				}
 
@@ -6536,22 +5530,22 @@ void Bmphandler::Erosion1(int n, bool connectivity) // true for 8-, false for 4-
 		if (connectivity)
 		{
 			i1 = 0;
-			for (unsigned short i = 0; i < (m_Height - 1); i++)
+			for (unsigned i = 0; i < (m_Height - 1); i++)
 			{
-				for (unsigned short j = 0; j < (m_Width - 1); j++)
+				for (unsigned j = 0; j < (m_Width - 1); j++)
 				{
-					if (m_WorkBits[i1] != m_WorkBits[i1 + m_Width + 1])
+					if (work[i1] != work[i1 + m_Width + 1])
 					{
-						if (m_WorkBits[i1] == 0)
+						if (work[i1] == 0)
 							results[i1 + 1 + m_Width] = 0;
-						else if (m_WorkBits[i1 + 1 + m_Width] == 0)
+						else if (work[i1 + 1 + m_Width] == 0)
 							results[i1] = 0;
 					}
-					if (m_WorkBits[i1 + 1] != m_WorkBits[i1 + m_Width])
+					if (work[i1 + 1] != work[i1 + m_Width])
 					{
-						if (m_WorkBits[i1 + 1] == 0)
+						if (work[i1 + 1] == 0)
 							results[i1 + m_Width] = 0;
-						else if (m_WorkBits[i1 + m_Width] == 0)
+						else if (work[i1 + m_Width] == 0)
 							results[i1 + 1] = 0;
 					}
 
@@ -6562,11 +5556,11 @@ void Bmphandler::Erosion1(int n, bool connectivity) // true for 8-, false for 4-
 		}
 
 		dummy = results;
-		results = m_WorkBits;
+		results = WorkBits();
 		m_WorkBits = dummy;
 	}
 
-	m_Sliceprovide->TakeBack(results);
+	Recycle(results);
 
 	m_Mode1 = dummymode1;
 	m_Mode2 = dummymode2;
@@ -6581,16 +5575,18 @@ void Bmphandler::Erosion(int n, bool connectivity) // true for 8-, false for 4-c
 
 	for (int l = 0; l < n; l++)
 	{
+		// the target is replaced by the result after each step
+		float* work = WorkBits();
 		for (unsigned int i = 0; i < m_Area; i++)
-			results[i] = m_WorkBits[i];
+			results[i] = work[i];
 
 		int i1 = 0;
 
-		for (unsigned short i = 0; i < (m_Height - 1); i++)
+		for (unsigned i = 0; i < (m_Height - 1); i++)
 		{
-			for (unsigned short j = 0; j < m_Width; j++)
+			for (unsigned j = 0; j < m_Width; j++)
 			{
-				if (m_WorkBits[i1] != m_WorkBits[i1 + m_Width])
+				if (work[i1] != work[i1 + m_Width])
 					results[i1] = results[i1 + m_Width] = 0;
 
 				i1++;
@@ -6599,11 +5595,11 @@ void Bmphandler::Erosion(int n, bool connectivity) // true for 8-, false for 4-c
 
 		i1 = 0;
 
-		for (unsigned short i = 0; i < m_Height; i++)
+		for (unsigned i = 0; i < m_Height; i++)
 		{
-			for (unsigned short j = 0; j < (m_Width - 1); j++)
+			for (unsigned j = 0; j < (m_Width - 1); j++)
 			{
-				if (m_WorkBits[i1] != m_WorkBits[i1 + 1])
+				if (work[i1] != work[i1 + 1])
 					results[i1] = results[i1 + 1] = 0;
 
 				i1++;
@@ -6614,13 +5610,13 @@ void Bmphandler::Erosion(int n, bool connectivity) // true for 8-, false for 4-c
 		if (connectivity)
 		{
 			i1 = 0;
-			for (unsigned short i = 0; i < (m_Height - 1); i++)
+			for (unsigned i = 0; i < (m_Height - 1); i++)
 			{
-				for (unsigned short j = 0; j < (m_Width - 1); j++)
+				for (unsigned j = 0; j < (m_Width - 1); j++)
 				{
-					if (m_WorkBits[i1] != m_WorkBits[i1 + m_Width + 1])
+					if (work[i1] != work[i1 + m_Width + 1])
 						results[i1] = results[i1 + m_Width + 1] = 0;
-					if (m_WorkBits[i1 + 1] != m_WorkBits[i1 + m_Width])
+					if (work[i1 + 1] != work[i1 + m_Width])
 						results[i1 + 1] = results[i1 + m_Width] = 0;
 
 					i1++;
@@ -6630,11 +5626,11 @@ void Bmphandler::Erosion(int n, bool connectivity) // true for 8-, false for 4-c
 		}
 
 		dummy = results;
-		results = m_WorkBits;
+		results = WorkBits();
 		m_WorkBits = dummy;
 	}
 
-	m_Sliceprovide->TakeBack(results);
+	Recycle(results);
 
 	m_Mode1 = dummymode1;
 	m_Mode2 = dummymode2;
@@ -6650,20 +5646,22 @@ void Bmphandler::Dilation(int n, bool connectivity) // true for 8-, false for 4-
 
 	for (int l = 0; l < n; l++)
 	{
+		// the target is replaced by the result after each step
+		float* work = WorkBits();
 		for (unsigned int i = 0; i < m_Area; i++)
-			results[i] = m_WorkBits[i];
+			results[i] = work[i];
 
 		int i1 = 0;
 
-		for (unsigned short i = 0; i < (m_Height - 1); i++)
+		for (unsigned i = 0; i < (m_Height - 1); i++)
 		{
-			for (unsigned short j = 0; j < m_Width; j++)
+			for (unsigned j = 0; j < m_Width; j++)
 			{
-				if (m_WorkBits[i1] != m_WorkBits[i1 + m_Width])
+				if (work[i1] != work[i1 + m_Width])
 				{
-					if (m_WorkBits[i1] == 0)
+					if (work[i1] == 0)
 						results[i1] = results[i1 + m_Width];
-					if (m_WorkBits[i1 + m_Width] == 0)
+					if (work[i1 + m_Width] == 0)
 						results[i1 + m_Width] = results[i1];
 				}
 
@@ -6673,15 +5671,15 @@ void Bmphandler::Dilation(int n, bool connectivity) // true for 8-, false for 4-
 
 		i1 = 0;
 
-		for (unsigned short i = 0; i < m_Height; i++)
+		for (unsigned i = 0; i < m_Height; i++)
 		{
-			for (unsigned short j = 0; j < (m_Width - 1); j++)
+			for (unsigned j = 0; j < (m_Width - 1); j++)
 			{
-				if (m_WorkBits[i1] != m_WorkBits[i1 + 1])
+				if (work[i1] != work[i1 + 1])
 				{
-					if (m_WorkBits[i1] == 0)
+					if (work[i1] == 0)
 						results[i1] = results[i1 + 1];
-					if (m_WorkBits[i1 + 1] == 0)
+					if (work[i1 + 1] == 0)
 						results[i1 + 1] = results[i1];
 				}
 
@@ -6693,22 +5691,22 @@ void Bmphandler::Dilation(int n, bool connectivity) // true for 8-, false for 4-
 		if (connectivity)
 		{
 			i1 = 0;
-			for (unsigned short i = 0; i < (m_Height - 1); i++)
+			for (unsigned i = 0; i < (m_Height - 1); i++)
 			{
-				for (unsigned short j = 0; j < (m_Width - 1); j++)
+				for (unsigned j = 0; j < (m_Width - 1); j++)
 				{
-					if (m_WorkBits[i1] != m_WorkBits[i1 + m_Width + 1])
+					if (work[i1] != work[i1 + m_Width + 1])
 					{
-						if (m_WorkBits[i1] == 0)
+						if (work[i1] == 0)
 							results[i1] = results[i1 + m_Width + 1];
-						if (m_WorkBits[i1 + m_Width + 1] == 0)
+						if (work[i1 + m_Width + 1] == 0)
 							results[i1 + m_Width + 1] = results[i1];
 					}
-					if (m_WorkBits[i1 + 1] != m_WorkBits[i1 + m_Width])
+					if (work[i1 + 1] != work[i1 + m_Width])
 					{
-						if (m_WorkBits[i1 + 1] == 0)
+						if (work[i1 + 1] == 0)
 							results[i1 + 1] = results[i1 + m_Width];
-						if (m_WorkBits[i1 + m_Width] == 0)
+						if (work[i1 + m_Width] == 0)
 							results[i1 + m_Width] = results[i1 + 1];
 					}
 
@@ -6719,11 +5717,11 @@ void Bmphandler::Dilation(int n, bool connectivity) // true for 8-, false for 4-
 		}
 
 		dummy = results;
-		results = m_WorkBits;
+		results = WorkBits();
 		m_WorkBits = dummy;
 	}
 
-	m_Sliceprovide->TakeBack(results);
+	Recycle(results);
 
 	m_Mode1 = dummymode1;
 	m_Mode2 = dummymode2;
@@ -6757,18 +5755,19 @@ void Bmphandler::MarkBorder(bool connectivity) // true for 8-, false for 4-conne
 {
 	float* results = m_Sliceprovide->GiveMe();
 
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		results[i] = m_WorkBits[i];
+		results[i] = work[i];
 
 	int i1 = 0;
 
-	for (unsigned short i = 0; i < (m_Height - 1); i++)
+	for (unsigned i = 0; i < (m_Height - 1); i++)
 	{
-		for (unsigned short j = 0; j < m_Width; j++)
+		for (unsigned j = 0; j < m_Width; j++)
 		{
-			if (m_WorkBits[i1] > m_WorkBits[i1 + m_Width])
+			if (work[i1] > work[i1 + m_Width])
 				results[i1] = -1;
-			else if (m_WorkBits[i1] < m_WorkBits[i1 + m_Width])
+			else if (work[i1] < work[i1 + m_Width])
 				results[i1 + m_Width] = -1;
 
 			i1++;
@@ -6777,13 +5776,13 @@ void Bmphandler::MarkBorder(bool connectivity) // true for 8-, false for 4-conne
 
 	i1 = 0;
 
-	for (unsigned short i = 0; i < m_Height; i++)
+	for (unsigned i = 0; i < m_Height; i++)
 	{
-		for (unsigned short j = 0; j < (m_Width - 1); j++)
+		for (unsigned j = 0; j < (m_Width - 1); j++)
 		{
-			if (m_WorkBits[i1] > m_WorkBits[i1 + 1])
+			if (work[i1] > work[i1 + 1])
 				results[i1] = -1;
-			else if (m_WorkBits[i1] < m_WorkBits[i1 + 1])
+			else if (work[i1] < work[i1 + 1])
 				results[i1 + 1] = -1;
 
 			i1++;
@@ -6795,17 +5794,17 @@ void Bmphandler::MarkBorder(bool connectivity) // true for 8-, false for 4-conne
 	{
 		i1 = 0;
 
-		for (unsigned short i = 0; i < (m_Height - 1); i++)
+		for (unsigned i = 0; i < (m_Height - 1); i++)
 		{
-			for (unsigned short j = 0; j < (m_Width - 1); j++)
+			for (unsigned j = 0; j < (m_Width - 1); j++)
 			{
-				if (m_WorkBits[i1] > m_WorkBits[i1 + m_Width + 1])
+				if (work[i1] > work[i1 + m_Width + 1])
 					results[i1] = -1;
-				else if (m_WorkBits[i1] < m_WorkBits[i1 + m_Width + 1])
+				else if (work[i1] < work[i1 + m_Width + 1])
 					results[i1 + m_Width + 1] = -1;
-				if (m_WorkBits[i1 + 1] > m_WorkBits[i1 + m_Width])
+				if (work[i1 + 1] > work[i1 + m_Width])
 					results[i1 + 1] = -1;
-				else if (m_WorkBits[i1 + 1] < m_WorkBits[i1 + m_Width])
+				else if (work[i1 + 1] < work[i1 + m_Width])
 					results[i1 + m_Width] = -1;
 
 				i1++;
@@ -6814,7 +5813,7 @@ void Bmphandler::MarkBorder(bool connectivity) // true for 8-, false for 4-conne
 		}
 	}
 
-	m_Sliceprovide->TakeBack(m_WorkBits);
+	Recycle(m_WorkBits);
 	m_WorkBits = results;
 }
 
@@ -6827,15 +5826,16 @@ void Bmphandler::ZeroCrossings(bool connectivity) // true for 8-, false for 4-co
 
 	int i1 = 0;
 
-	for (unsigned short i = 0; i < (m_Height - 1); i++)
+	float* work = WorkBits();
+	for (unsigned i = 0; i < (m_Height - 1); i++)
 	{
-		for (unsigned short j = 0; j < m_Width; j++)
+		for (unsigned j = 0; j < m_Width; j++)
 		{
-			if (m_WorkBits[i1] * m_WorkBits[i1 + m_Width] <= 0)
+			if (work[i1] * work[i1 + m_Width] <= 0)
 			{
-				if (m_WorkBits[i1] > 0)
+				if (work[i1] > 0)
 					results[i1 + m_Width] = -1;
-				else if (m_WorkBits[i1 + m_Width] > 0)
+				else if (work[i1 + m_Width] > 0)
 					results[i1] = -1;
 			}
 			i1++;
@@ -6844,15 +5844,15 @@ void Bmphandler::ZeroCrossings(bool connectivity) // true for 8-, false for 4-co
 
 	i1 = 0;
 
-	for (unsigned short i = 0; i < m_Height; i++)
+	for (unsigned i = 0; i < m_Height; i++)
 	{
-		for (unsigned short j = 0; j < (m_Width - 1); j++)
+		for (unsigned j = 0; j < (m_Width - 1); j++)
 		{
-			if (m_WorkBits[i1] * m_WorkBits[i1 + 1] <= 0)
+			if (work[i1] * work[i1 + 1] <= 0)
 			{
-				if (m_WorkBits[i1] > 0)
+				if (work[i1] > 0)
 					results[i1 + 1] = -1;
-				else if (m_WorkBits[i1 + 1] > 0)
+				else if (work[i1 + 1] > 0)
 					results[i1] = -1;
 			}
 			i1++;
@@ -6864,22 +5864,22 @@ void Bmphandler::ZeroCrossings(bool connectivity) // true for 8-, false for 4-co
 	{
 		i1 = 0;
 
-		for (unsigned short i = 0; i < (m_Height - 1); i++)
+		for (unsigned i = 0; i < (m_Height - 1); i++)
 		{
-			for (unsigned short j = 0; j < (m_Width - 1); j++)
+			for (unsigned j = 0; j < (m_Width - 1); j++)
 			{
-				if (m_WorkBits[i1] * m_WorkBits[i1 + m_Width + 1] <= 0)
+				if (work[i1] * work[i1 + m_Width + 1] <= 0)
 				{
-					if (m_WorkBits[i1] > 0)
+					if (work[i1] > 0)
 						results[i1 + m_Width + 1] = -1;
-					else if (m_WorkBits[i1 + m_Width + 1] > 0)
+					else if (work[i1 + m_Width + 1] > 0)
 						results[i1] = -1;
 				}
-				if (m_WorkBits[i1 + 1] * m_WorkBits[i1 + m_Width] <= 0)
+				if (work[i1 + 1] * work[i1 + m_Width] <= 0)
 				{
-					if (m_WorkBits[i1 + 1] > 0)
+					if (work[i1 + 1] > 0)
 						results[i1 + m_Width] = -1;
-					else if (m_WorkBits[i1 + m_Width] > 0)
+					else if (work[i1 + m_Width] > 0)
 						results[i1 + 1] = -1;
 				}
 				i1++;
@@ -6888,7 +5888,7 @@ void Bmphandler::ZeroCrossings(bool connectivity) // true for 8-, false for 4-co
 		}
 	}
 
-	m_Sliceprovide->TakeBack(m_WorkBits);
+	Recycle(m_WorkBits);
 	m_WorkBits = results;
 
 	m_Mode2 = 2;
@@ -6903,14 +5903,15 @@ void Bmphandler::ZeroCrossings(float thresh, bool connectivity) // true for 8-,
 
 	int i1 = 0;
 
-	for (unsigned short i = 0; i < (m_Height - 1); i++)
+	float* work = WorkBits();
+	for (unsigned i = 0; i < (m_Height - 1); i++)
 	{
-		for (unsigned short j = 0; j < m_Width; j++)
+		for (unsigned j = 0; j < m_Width; j++)
 		{
-			if (m_WorkBits[i1] * m_WorkBits[i1 + m_Width] < 0 &&
-					abs(m_WorkBits[i1] - m_WorkBits[i1 + m_Width]) > thresh)
+			if (work[i1] * work[i1 + m_Width] < 0 &&
+					abs(work[i1] - work[i1 + m_Width]) > thresh)
 			{
-				if (m_WorkBits[i1] > 0)
+				if (work[i1] > 0)
 					results[i1] = -1;
 				else
 					results[i1 + m_Width] = -1;
@@ -6921,14 +5922,14 @@ void Bmphandler::ZeroCrossings(float thresh, bool connectivity) // true for 8-,
 
 	i1 = 0;
 
-	for (unsigned short i = 0; i < m_Height; i++)
+	for (unsigned i = 0; i < m_Height; i++)
 	{
-		for (unsigned short j = 0; j < (m_Width - 1); j++)
+		for (unsigned j = 0; j < (m_Width - 1); j++)
 		{
-			if (m_WorkBits[i1] * m_WorkBits[i1 + 1] < 0 &&
-					abs(m_WorkBits[i1] - m_WorkBits[i1 + m_Width]) > thresh)
+			if (work[i1] * work[i1 + 1] < 0 &&
+					abs(work[i1] - work[i1 + m_Width]) > thresh)
 			{
-				if (m_WorkBits[i1] > 0)
+				if (work[i1] > 0)
 					results[i1] = -1;
 				else
 					results[i1 + 1] = -1;
@@ -6942,22 +5943,22 @@ void Bmphandler::ZeroCrossings(float thresh, bool connectivity) // true for 8-,
 	{
 		i1 = 0;
 
-		for (unsigned short i = 0; i < (m_Height - 1); i++)
+		for (unsigned i = 0; i < (m_Height - 1); i++)
 		{
-			for (unsigned short j = 0; j < (m_Width - 1); j++)
+			for (unsigned j = 0; j < (m_Width - 1); j++)
 			{
-				if (m_WorkBits[i1] * m_WorkBits[i1 + m_Width + 1] < 0 &&
-						abs(m_WorkBits[i1] - m_WorkBits[i1 + m_Width]) > thresh)
+				if (work[i1] * work[i1 + m_Width + 1] < 0 &&
+						abs(work[i1] - work[i1 + m_Width]) > thresh)
 				{
-					if (m_WorkBits[i1] > 0)
+					if (work[i1] > 0)
 						results[i1] = -1;
 					else
 						results[i1 + m_Width + 1] = -1;
 				}
-				if (m_WorkBits[i1 + 1] * m_WorkBits[i1 + m_Width] < 0 &&
-						abs(m_WorkBits[i1] - m_WorkBits[i1 + m_Width]) > thresh)
+				if (work[i1 + 1] * work[i1 + m_Width] < 0 &&
+						abs(work[i1] - work[i1 + m_Width]) > thresh)
 				{
-					if (m_WorkBits[i1 + 1] > 0)
+					if (work[i1 + 1] > 0)
 						results[i1 + 1] = -1;
 					else
 						results[i1 + m_Width] = -1;
@@ -6968,7 +5969,7 @@ void Bmphandler::ZeroCrossings(float thresh, bool connectivity) // true for 8-,
 		}
 	}
 
-	m_Sliceprovide->TakeBack(m_WorkBits);
+	Recycle(m_WorkBits);
 	m_WorkBits = results;
 
 	m_Mode2 = 2;
@@ -6983,11 +5984,11 @@ void Bmphandler::LaplacianZero(float sigma, float thresh, bool connectivity)
 
 	Gaussian(sigma);
 	tmp1 = m_BmpBits;
-	m_BmpBits = m_WorkBits;
+	m_BmpBits = WorkBits();
 	m_WorkBits = m_Sliceprovide->GiveMe();
 	//	swap_bmpwork();
 	Sobel();
-	tmp2 = m_WorkBits;
+	tmp2 = WorkBits();
 	m_WorkBits = m_Sliceprovide->GiveMe();
 	//	swap_workhelp();
 	Laplacian1();
@@ -6996,22 +5997,23 @@ void Bmphandler::LaplacianZero(float sigma, float thresh, bool connectivity)
 
 	ZeroCrossings(connectivity);
 
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
 	{
-		if (m_WorkBits[i] == -1 && tmp2[i] < thresh)
-			m_WorkBits[i] = 255;
+		if (work[i] == -1 && tmp2[i] < thresh)
+			work[i] = 255;
 		//		work_bits[i]=tmp2[i];
 	}
 
-	m_Sliceprovide->TakeBack(m_BmpBits);
+	Recycle(m_BmpBits);
 	m_BmpBits = tmp1;
-	m_Sliceprovide->TakeBack(tmp2);
+	Recycle(tmp2);
 
 	m_Mode1 = dummymode;
 	m_Mode2 = 2;
 }
 
-void Bmphandler::NMoment(short unsigned n, short unsigned p)
+void Bmphandler::NMoment(unsigned n, unsigned p)
 {
 	unsigned char dummymode = m_Mode1;
 
@@ -7024,17 +6026,18 @@ void Bmphandler::NMoment(short unsigned n, short unsigned p)
 	for (unsigned int i = 0; i < m_Area; i++)
 		results[i] = 0;
 
-	for (unsigned short i = 0; i <= m_Height - n; i++)
+	float* work = WorkBits();
+	for (unsigned i = 0; i <= m_Height - n; i++)
 	{
-		for (unsigned short j = 0; j <= m_Width - n; j++)
+		for (unsigned j = 0; j <= m_Width - n; j++)
 		{
-			for (unsigned short k = 0; k < n; k++)
+			for (unsigned k = 0; k < n; k++)
 			{
-				for (unsigned short l = 0; l < n; l++)
+				for (unsigned l = 0; l < n; l++)
 				{
 					results[(i + n / 2) * m_Width + j + n / 2] +=
 							pow(abs(m_BmpBits[(i + k) * m_Width + j + l] -
-											m_WorkBits[(i + n / 2) * m_Width + j + n / 2]),
+											work[(i + n / 2) * m_Width + j + n / 2]),
 									p);
 				}
 			}
@@ -7043,14 +6046,14 @@ void Bmphandler::NMoment(short unsigned n, short unsigned p)
 		}
 	}
 
-	m_Sliceprovide->TakeBack(m_WorkBits);
+	Recycle(m_WorkBits);
 	m_WorkBits = results;
 
 	m_Mode1 = dummymode;
 	m_Mode2 = 1;
 }
 
-void Bmphandler::NMomentSigma(short unsigned n, short unsigned p, float sigma)
+void Bmphandler::NMomentSigma(unsigned n, unsigned p, float sigma)
 {
 	unsigned char dummymode = m_Mode1;
 	float* results = m_Sliceprovide->GiveMe();
@@ -7065,17 +6068,18 @@ void Bmphandler::NMomentSigma(short unsigned n, short unsigned p, float sigma)
 	for (unsigned int i = 0; i < m_Area; i++)
 		results[i] = 0;
 
-	for (unsigned short i = 0; i <= m_Height - n; i++)
+	float* work = WorkBits();
+	for (unsigned i = 0; i <= m_Height - n; i++)
 	{
-		for (unsigned short j = 0; j <= m_Width - n; j++)
+		for (unsigned j = 0; j <= m_Width - n; j++)
 		{
 			count = 0;
-			for (unsigned short k = 0; k < n; k++)
+			for (unsigned k = 0; k < n; k++)
 			{
-				for (unsigned short l = 0; l < n; l++)
+				for (unsigned l = 0; l < n; l++)
 				{
 					dummy = abs(m_BmpBits[(i + k) * m_Width + j + l] -
-											m_WorkBits[(i + n / 2) * m_Width + j + n / 2]);
+											work[(i + n / 2) * m_Width + j + n / 2]);
 					if (dummy < sigma)
 					{
 						count++;
@@ -7089,7 +6093,7 @@ void Bmphandler::NMomentSigma(short unsigned n, short unsigned p, float sigma)
 		}
 	}
 
-	m_Sliceprovide->TakeBack(m_WorkBits);
+	Recycle(m_WorkBits);
 	m_WorkBits = results;
 
 	m_Mode1 = dummymode;
@@ -7112,52 +6116,53 @@ void Bmphandler::ContAnisodiff(float dt, int n, float (*f)(float, float), float
 
 	float dummy;
 
+	float* work = WorkBits();
 	for (int l = 0; l < n; l++)
 	{
-		for (unsigned short i = 0; i < m_Height; i++)
+		for (unsigned i = 0; i < m_Height; i++)
 		{
-			for (unsigned short j = 0; j < m_Width - 1; j++)
+			for (unsigned j = 0; j < m_Width - 1; j++)
 			{
 				dummy =
-						(m_WorkBits[i * m_Width + j + 1] - m_WorkBits[i * m_Width + j]);
+						(work[i * m_Width + j + 1] - work[i * m_Width + j]);
 				flowx[i * (m_Width - 1) + j] = f(dummy, k) * dummy;
 			}
 		}
 
-		for (unsigned short i = 0; i < m_Height - 1; i++)
+		for (unsigned i = 0; i < m_Height - 1; i++)
 		{
-			for (unsigned short j = 0; j < m_Width; j++)
+			for (unsigned j = 0; j < m_Width; j++)
 			{
 				dummy =
-						(m_WorkBits[(i + 1) * m_Width + j] - m_WorkBits[i * m_Width + j]);
+						(work[(i + 1) * m_Width + j] - work[i * m_Width + j]);
 				flowy[i * m_Width + j] = f(dummy, k) * dummy;
 			}
 		}
 
 		for (unsigned int i = 0; i < m_Area; i++)
-			m_WorkBits[i] += dt * restraint * (m_BmpBits[i] - m_WorkBits[i]);
+			work[i] += dt * restraint * (m_BmpBits[i] - work[i]);
 
-		for (unsigned short i = 0; i < m_Height; i++)
+		for (unsigned i = 0; i < m_Height; i++)
 		{
-			for (unsigned short j = 0; j < m_Width - 1; j++)
+			for (unsigned j = 0; j < m_Width - 1; j++)
 			{
-				m_WorkBits[i * m_Width + j] += dt * flowx[i * (m_Width - 1) + j];
-				m_WorkBits[i * m_Width + j + 1] -= dt * flowx[i * (m_Width - 1) + j];
+				work[i * m_Width + j] += dt * flowx[i * (m_Width - 1) + j];
+				work[i * m_Width + j + 1] -= dt * flowx[i * (m_Width - 1) + j];
 			}
 		}
 
-		for (unsigned short i = 0; i < m_Height - 1; i++)
+		for (unsigned i = 0; i < m_Height - 1; i++)
 		{
-			for (unsigned short j = 0; j < m_Width; j++)
+			for (unsigned j = 0; j < m_Width; j++)
 			{
-				m_WorkBits[i * m_Width + j] += dt * flowy[i * m_Width + j];
-				m_WorkBits[(i + 1) * m_Width + j] -= dt * flowy[i * m_Width + j];
+				work[i * m_Width + j] += dt * flowy[i * m_Width + j];
+				work[(i + 1) * m_Width + j] -= dt * flowy[i * m_Width + j];
 			}
 		}
 	}
 
-	m_Sliceprovide->TakeBack(flowx);
-	m_Sliceprovide->TakeBack(flowy);
+	Recycle(flowx);
+	Recycle(flowy);
 
 	m_Mode2 = 1;
 }
@@ -7401,8 +6406,9 @@ void Bmphandler::CondMerge(unsigned m, unsigned h)
 void Bmphandler::Wshed2work(unsigned* Y)
 {
 	float d = 255.0f / m_Wshedobj.m_B.size();
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
-		m_WorkBits[i] = Y[i] * d;
+		work[i] = Y[i] * d;
 
 	m_Mode2 = 2;
 }
@@ -7416,8 +6422,9 @@ void Bmphandler::Labels2work(unsigned* Y, unsigned /* lnr */)
 	}
 
 	float d = 255.0f / maxim;
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
-		m_WorkBits[i] = d * LabelLookup(i, Y);
+		work[i] = d * LabelLookup(i, Y);
 
 	m_Mode2 = 2;
 }
@@ -7460,6 +6467,7 @@ void Bmphandler::PlotLine() // very temporary solution...
 
 	unsigned n = (unsigned)m_Contour.ReturnN();
 
+	float* work = WorkBits();
 	for (unsigned i = 0; i < n - 1; i++)
 	{
 		dx = std::max(p_vec[i].px, p_vec[i + 1].px) -
@@ -7468,7 +6476,7 @@ void Bmphandler::PlotLine() // very temporary solution...
 				 std::min(p_vec[i].py, p_vec[i + 1].py);
 		p.px = p_vec[i].px;
 		p.py = p_vec[i].py;
-		m_WorkBits[Pt2coord(p)] = 0;
+		work[Pt2coord(p)] = 0;
 		if (dx > dy)
 		{
 			for (unsigned j = 1; j < dx; j++)
@@ -7481,7 +6489,7 @@ void Bmphandler::PlotLine() // very temporary solution...
 										 ((float)p_vec[i + 1].py - (float)p_vec[i].py) * j /
 												 dx +
 										 (float)p_vec[i].py);
-				m_WorkBits[Pt2coord(p)] = 255;
+				work[Pt2coord(p)] = 255;
 			}
 		}
 		else
@@ -7496,7 +6504,7 @@ void Bmphandler::PlotLine() // very temporary solution...
 										 ((float)p_vec[i + 1].py - (float)p_vec[i].py) * j /
 												 dy +
 										 (float)p_vec[i].py);
-				m_WorkBits[Pt2coord(p)] = 255;
+				work[Pt2coord(p)] = 255;
 			}
 		}
 	}
@@ -7505,7 +6513,7 @@ void Bmphandler::PlotLine() // very temporary solution...
 	dy = std::max(p_vec[n - 1].py, p_vec[0].py) - std::min(p_vec[n - 1].py, p_vec[0].py);
 	p.px = p_vec[n - 1].px;
 	p.py = p_vec[n - 1].py;
-	m_WorkBits[Pt2coord(p)] = 0;
+	work[Pt2coord(p)] = 0;
 	if (dx > dy)
 	{
 		for (unsigned j = 1; j < dx; j++)
@@ -7514,7 +6522,7 @@ void Bmphandler::PlotLine() // very temporary solution...
 									 (float)p_vec[n - 1].px);
 			p.py = short(0.5 + ((float)p_vec[0].py - (float)p_vec[n - 1].py) * j / dx +
 									 (float)p_vec[n - 1].py);
-			m_WorkBits[Pt2coord(p)] = 255;
+			work[Pt2coord(p)] = 255;
 		}
 	}
 	else
@@ -7525,7 +6533,7 @@ void Bmphandler::PlotLine() // very temporary solution...
 									 (float)p_vec[n - 1].px);
 			p.py = short(0.5 + ((float)p_vec[0].py - (float)p_vec[n - 1].py) * j / dy +
 									 (float)p_vec[n - 1].py);
-			m_WorkBits[Pt2coord(p)] = 255;
+			work[Pt2coord(p)] = 255;
 		}
 	}
 
@@ -7555,32 +6563,32 @@ void Bmphandler::ConnectedComponents(bool connectivity)
 		{
 			if (temp[i1] == temp[i1 - 1])
 			{
-				m_WorkBits[i2] = BaseConnection(m_WorkBits[i2 - 1], &maps);
+				work[i2] = BaseConnection(work[i2 - 1], &maps);
 				if (temp[i1] == temp[i1 - m_Width - 1])
 				{
-					maps[(int)BaseConnection(m_WorkBits[i2 - m_Width], &maps)] =
-							m_WorkBits[i2];
+					maps[(int)BaseConnection(work[i2 - m_Width], &maps)] =
+							work[i2];
 				}
 			}
 			else
 			{
 				if (temp[i1] == temp[i1 - m_Width - 1])
-					m_WorkBits[i2] =
-							BaseConnection(m_WorkBits[i2 - m_Width], &maps);
+					work[i2] =
+							BaseConnection(work[i2 - m_Width], &maps);
 				else if (connectivity && temp[i1] == temp[i1 - m_Width - 2])
-					m_WorkBits[i2] =
-							BaseConnection(m_WorkBits[i2 - m_Width - 1], &maps);
+					work[i2] =
+							BaseConnection(work[i2 - m_Width - 1], &maps);
 				else
 				{
 					maps.push_back(newest);
-					m_WorkBits[i2] = newest;
+					work[i2] = newest;
 					newest++;
 				}
 			}
 
 			if (connectivity && temp[i1 - 1] == temp[i1 - m_Width - 1])
-				maps[(int)BaseConnection(m_WorkBits[i2 - 1], &maps)] =
-						BaseConnection(m_WorkBits[i2 - m_Width], &maps);
+				maps[(int)BaseConnection(work[i2 - 1], &maps)] =
+						BaseConnection(work[i2 - m_Width], &maps);
 
 			i1++;
 			i2++;
@@ -7589,7 +6597,7 @@ void Bmphandler::ConnectedComponents(bool connectivity)
 	}
 
 	for (unsigned i = 0; i < m_Area; i++)
-		m_WorkBits[i] = BaseConnection(m_WorkBits[i], &maps);
+		work[i] = BaseConnection(work[i], &maps);
 
 	newest = 0.0f;
 	for (i1 = 0; i1 < (unsigned)maps.size(); i1++)
@@ -7600,7 +6608,7 @@ void Bmphandler::ConnectedComponents(bool connectivity)
 		}
 
 	for (unsigned i = 0; i < m_Area; i++)
-		m_WorkBits[i] = maps[(int)m_WorkBits[i]];
+		work[i] = maps[(int)work[i]];
 
 	free(temp);
 
@@ -7626,38 +6634,39 @@ void Bmphandler::ConnectedComponents(bool connectivity, std::set<float>& compone
 	unsigned i1 = m_Width + 2;
 	unsigned i2 = 0;
 
+	float* work = WorkBits();
 	for (short j = 0; j < m_Height; j++)
 	{
 		for (short k = 0; k < m_Width; k++)
 		{
 			if (temp[i1] == temp[i1 - 1])
 			{
-				m_WorkBits[i2] = BaseConnection(m_WorkBits[i2 - 1], &maps);
+				work[i2] = BaseConnection(work[i2 - 1], &maps);
 				if (temp[i1] == temp[i1 - m_Width - 1])
 				{
-					maps[(int)BaseConnection(m_WorkBits[i2 - m_Width], &maps)] =
-							m_WorkBits[i2];
+					maps[(int)BaseConnection(work[i2 - m_Width], &maps)] =
+							work[i2];
 				}
 			}
 			else
 			{
 				if (temp[i1] == temp[i1 - m_Width - 1])
-					m_WorkBits[i2] =
-							BaseConnection(m_WorkBits[i2 - m_Width], &maps);
+					work[i2] =
+							BaseConnection(work[i2 - m_Width], &maps);
 				else if (connectivity && temp[i1] == temp[i1 - m_Width - 2])
-					m_WorkBits[i2] =
-							BaseConnection(m_WorkBits[i2 - m_Width - 1], &maps);
+					work[i2] =
+							BaseConnection(work[i2 - m_Width - 1], &maps);
 				else
 				{
 					maps.push_back(newest);
-					m_WorkBits[i2] = newest;
+					work[i2] = newest;
 					newest++;
 				}
 			}
 
 			if (connectivity && temp[i1 - 1] == temp[i1 - m_Width - 1])
-				maps[(int)BaseConnection(m_WorkBits[i2 - 1], &maps)] =
-						BaseConnection(m_WorkBits[i2 - m_Width], &maps);
+				maps[(int)BaseConnection(work[i2 - 1], &maps)] =
+						BaseConnection(work[i2 - m_Width], &maps);
 
 			i1++;
 			i2++;
@@ -7666,7 +6675,7 @@ void Bmphandler::ConnectedComponents(bool connectivity, std::set<float>& compone
 	}
 
 	for (unsigned i = 0; i < m_Area; i++)
-		m_WorkBits[i] = BaseConnection(m_WorkBits[i], &maps);
+		work[i] = BaseConnection(work[i], &maps);
 
 	newest = 0.0f;
 	for (i1 = 0; i1 < (unsigned)maps.size(); i1++)
@@ -7678,8 +6687,8 @@ void Bmphandler::ConnectedComponents(bool connectivity, std::set<float>& compone
 
 	for (unsigned i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = maps[(int)m_WorkBits[i]];
-		components.insert(m_WorkBits[i]);
+		work[i] = maps[(int)work[i]];
+		components.insert(work[i]);
 	}
 
 	free(temp);
@@ -7696,7 +6705,7 @@ float Bmphandler::BaseConnection(float c, std::vector<float>* maps)
 		return (*maps)[(int)c] = BaseConnection((*maps)[(int)c], maps);
 }
 
-void Bmphandler::FillGaps(short unsigned n, bool connectivity)
+void Bmphandler::FillGaps(unsigned n, bool connectivity)
 {
 	unsigned char dummymode1 = m_Mode1;
 	unsigned char dummymode2 = m_Mode2;
@@ -7709,13 +6718,14 @@ void Bmphandler::FillGaps(short unsigned n, bool connectivity)
 	bool* isinterface = (bool*)malloc(sizeof(bool) * m_Area);
 	bool* isinterfaceold = (bool*)malloc(sizeof(bool) * m_Area);
 
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
-		tmp2[i] = m_WorkBits[i];
+		tmp2[i] = work[i];
 		isinterfaceold[i] = false;
 	}
 	Closure(int(ceil(float(n) / 2)), connectivity);
-	tmp1 = m_WorkBits;
+	tmp1 = WorkBits();
 	bmpstore = m_BmpBits;
 	m_BmpBits = tmp2;
 	tmp2 = m_Sliceprovide->GiveMe();
@@ -7723,36 +6733,39 @@ void Bmphandler::FillGaps(short unsigned n, bool connectivity)
 	ConnectedComponents(connectivity);
 
 	float f = -1;
+	work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
 		if (m_BmpBits[i] == 0)
-			m_WorkBits[i] = -1;
+			work[i] = -1;
 	}
 
 	for (int l = 0; l < (int)std::ceil(float(n + 1) / 2); l++)
 	{
+		// the target is swapped with tmp2 after each step
+		work = WorkBits();
 		for (unsigned int i = 0; i < m_Area; i++)
 		{
-			tmp2[i] = m_WorkBits[i];
+			tmp2[i] = work[i];
 			isinterface[i] = isinterfaceold[i];
 		}
 
 		int i1 = 0;
 
-		for (unsigned short i = 0; i < (m_Height - 1); i++)
+		for (unsigned i = 0; i < (m_Height - 1); i++)
 		{
-			for (unsigned short j = 0; j < m_Width; j++)
+			for (unsigned j = 0; j < m_Width; j++)
 			{
-				if (m_WorkBits[i1] != m_WorkBits[i1 + m_Width])
+				if (work[i1] != work[i1 + m_Width])
 				{
-					if (m_WorkBits[i1] == f)
+					if (work[i1] == f)
 					{
 						if (tmp2[i1] == f)
 							tmp2[i1] = tmp2[i1 + m_Width];
 						else if (tmp2[i1] != tmp2[i1 + m_Width])
 							isinterface[i1] = true;
 					}
-					else if (m_WorkBits[i1 + m_Width] == f)
+					else if (work[i1 + m_Width] == f)
 					{
 						if (tmp2[i1 + m_Width] == f)
 							tmp2[i1 + m_Width] = tmp2[i1];
@@ -7778,20 +6791,20 @@ void Bmphandler::FillGaps(short unsigned n, bool connectivity)
 
 		i1 = 0;
 
-		for (unsigned short i = 0; i < m_Height; i++)
+		for (unsigned i = 0; i < m_Height; i++)
 		{
-			for (unsigned short j = 0; j < (m_Width - 1); j++)
+			for (unsigned j = 0; j < (m_Width - 1); j++)
 			{
-				if (m_WorkBits[i1] != m_WorkBits[i1 + 1])
+				if (work[i1] != work[i1 + 1])
 				{
-					if (m_WorkBits[i1] == f)
+					if (work[i1] == f)
 					{
 						if (tmp2[i1] == f)
 							tmp2[i1] = tmp2[i1 + 1];
 						else if (tmp2[i1] != tmp2[i1 + 1])
 							isinterface[i1] = true;
 					}
-					else if (m_WorkBits[i1 + 1] == f)
+					else if (work[i1 + 1] == f)
 					{
 						if (tmp2[i1 + 1] == f)
 							tmp2[i1 + 1] = tmp2[i1];
@@ -7819,20 +6832,20 @@ void Bmphandler::FillGaps(short unsigned n, bool connectivity)
 		if (connectivity)
 		{
 			i1 = 0;
-			for (unsigned short i = 0; i < (m_Height - 1); i++)
+			for (unsigned i = 0; i < (m_Height - 1); i++)
 			{
-				for (unsigned short j = 0; j < (m_Width - 1); j++)
+				for (unsigned j = 0; j < (m_Width - 1); j++)
 				{
-					if (m_WorkBits[i1] != m_WorkBits[i1 + m_Width + 1])
+					if (work[i1] != work[i1 + m_Width + 1])
 					{
-						if (m_WorkBits[i1] == f)
+						if (work[i1] == f)
 						{
 							if (tmp2[i1] == f)
 								tmp2[i1] = tmp2[i1 + m_Width + 1];
 							else if (tmp2[i1] != tmp2[i1 + m_Width + 1])
 								isinterface[i1] = true;
 						}
-						else if (m_WorkBits[i1 + m_Width + 1] == f)
+						else if (work[i1 + m_Width + 1] == f)
 						{
 							if (tmp2[i1 + m_Width + 1] == f)
 								tmp2[i1 + m_Width + 1] = tmp2[i1];
@@ -7853,16 +6866,16 @@ void Bmphandler::FillGaps(short unsigned n, bool connectivity)
 									 (m_BmpBits[i1] == 0))
 						isinterface[i1] = true;
 
-					if (m_WorkBits[i1 + 1] != m_WorkBits[i1 + m_Width])
+					if (work[i1 + 1] != work[i1 + m_Width])
 					{
-						if (m_WorkBits[i1 + 1] == f)
+						if (work[i1 + 1] == f)
 						{
 							if (tmp2[i1 + 1] == f)
 								tmp2[i1 + 1] = tmp2[i1 + m_Width];
 							else if (tmp2[i1 + 1] != tmp2[i1 + m_Width])
 								isinterface[i1 + 1] = true;
 						}
-						else if (m_WorkBits[i1 + m_Width] == f)
+						else if (work[i1 + m_Width] == f)
 						{
 							if (tmp2[i1 + m_Width] == f)
 								tmp2[i1 + m_Width] = tmp2[i1 + 1];
@@ -7890,7 +6903,7 @@ void Bmphandler::FillGaps(short unsigned n, bool connectivity)
 		}
 
 		dummy = tmp2;
-		tmp2 = m_WorkBits;
+		tmp2 = WorkBits();
 		m_WorkBits = dummy;
 
 		dummybool = isinterface;
@@ -7907,9 +6920,9 @@ void Bmphandler::FillGaps(short unsigned n, bool connectivity)
 
 		int i1 = 0;
 
-		for (unsigned short i = 0; i < (m_Height - 1); i++)
+		for (unsigned i = 0; i < (m_Height - 1); i++)
 		{
-			for (unsigned short j = 0; j < m_Width; j++)
+			for (unsigned j = 0; j < m_Width; j++)
 			{
 				if (isinterfaceold[i1] && (m_BmpBits[i1 + m_Width] == 0))
 					isinterface[i1 + m_Width] = true;
@@ -7922,9 +6935,9 @@ void Bmphandler::FillGaps(short unsigned n, bool connectivity)
 
 		i1 = 0;
 
-		for (unsigned short i = 0; i < m_Height; i++)
+		for (unsigned i = 0; i < m_Height; i++)
 		{
-			for (unsigned short j = 0; j < (m_Width - 1); j++)
+			for (unsigned j = 0; j < (m_Width - 1); j++)
 			{
 				if (isinterfaceold[i1] && (m_BmpBits[i1 + 1] == 0))
 					isinterface[i1 + 1] = true;
@@ -7939,9 +6952,9 @@ void Bmphandler::FillGaps(short unsigned n, bool connectivity)
 		if (connectivity)
 		{
 			i1 = 0;
-			for (unsigned short i = 0; i < (m_Height - 1); i++)
+			for (unsigned i = 0; i < (m_Height - 1); i++)
 			{
-				for (unsigned short j = 0; j < (m_Width - 1); j++)
+				for (unsigned j = 0; j < (m_Width - 1); j++)
 				{
 					if (isinterfaceold[i1] && (m_BmpBits[i1 + m_Width + 1] == 0))
 						isinterface[i1 + m_Width + 1] = true;
@@ -7962,7 +6975,7 @@ void Bmphandler::FillGaps(short unsigned n, bool connectivity)
 		}
 
 		dummy = tmp2;
-		tmp2 = m_WorkBits;
+		tmp2 = WorkBits();
 		m_WorkBits = dummy;
 
 		dummybool = isinterface;
@@ -7980,9 +6993,9 @@ void Bmphandler::FillGaps(short unsigned n, bool connectivity)
 		//		bmp_bits[i]=tmp2[i];
 	}
 
-	m_Sliceprovide->TakeBack(tmp2);
-	m_Sliceprovide->TakeBack(m_WorkBits);
-	m_Sliceprovide->TakeBack(tmp1);
+	Recycle(tmp2);
+	Recycle(m_WorkBits);
+	Recycle(tmp1);
 	m_WorkBits = m_BmpBits;
 	m_BmpBits = bmpstore;
 	free(isinterface);
@@ -7992,26 +7005,29 @@ void Bmphandler::FillGaps(short unsigned n, bool connectivity)
 	m_Mode2 = dummymode2;
 }
 
-void Bmphandler::FillGapstissue(tissuelayers_size_t idx, short unsigned n, bool connectivity)
+void Bmphandler::FillGapstissue(tissuelayers_size_t idx, unsigned n, bool connectivity)
 {
 	unsigned char dummymode1 = m_Mode1;
 	unsigned char dummymode2 = m_Mode2;
 
-	float* workstore = m_WorkBits;
+	float* workstore = WorkBits();
 	m_WorkBits = m_Sliceprovide->GiveMe();
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = (float)tissues[i];
+		work[i] = (float)tissues[i];
 	}
 
 	FillGaps(n, connectivity);
 
+	// FillGaps replaces the target buffer
+	work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
-		tissues[i] = (tissues_size_t)m_WorkBits[i];
+		tissues[i] = (tissues_size_t)work[i];
 	}
-	m_Sliceprovide->TakeBack(m_WorkBits);
+	Recycle(m_WorkBits);
 	m_WorkBits = workstore;
 
 	m_Mode1 = dummymode1;
@@ -8045,7 +7061,7 @@ void Bmphandler::GetTissuecontours(tissuelayers_size_t idx, tissues_size_t f, st
 	float dx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
 	float bordervolume[8] = {1, 0.75f, 0.5f, 0.25f, 2, 1.75f, 1.5f, 1.25f};
 
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (unsigned i = 0; i < m_Height; i++)
 	{
 		for (unsigned j = 0; j < m_Width; j++)
@@ -8239,10 +7255,10 @@ void Bmphandler::GetTissuecontours2Xmirrored(tissuelayers_size_t idx, tissues_si
 	std::vector<Point> vec_pt;
 	float vol;
 
-	tissues_size_t* tissues = m_Tissuelayers[idx];
-	for (short unsigned i = 0; i < m_Height; i++)
+	tissues_size_t* tissues = TissueLayer(idx);
+	for (unsigned i = 0; i < m_Height; i++)
 	{
-		for (short unsigned j = 0; j < m_Width; j++)
+		for (unsigned j = 0; j < m_Width; j++)
 		{
 			tmp_bits[pos] = (unsigned)tissues[pos1];
 			pos++;
@@ -8266,9 +7282,9 @@ void Bmphandler::GetTissuecontours2Xmirrored(tissuelayers_size_t idx, tissues_si
 		nrlines[i] = 0;
 
 	pos = 0;
-	for (unsigned short i = 0; i < m_Height + 1; i++)
+	for (unsigned i = 0; i < m_Height + 1; i++)
 	{
-		for (unsigned short j = 0; j < m_Width + 1; j++)
+		for (unsigned j = 0; j < m_Width + 1; j++)
 		{
 			if ((tmp_bits[pos] != tmp_bits[pos + 1]) && (tmp_bits[pos] == f1 || tmp_bits[pos + 1] == f1))
 				nrlines[pos]++;
@@ -8283,7 +7299,7 @@ void Bmphandler::GetTissuecontours2Xmirrored(tissuelayers_size_t idx, tissues_si
 		pos++;
 	}
 
-	unsigned short direction;
+	unsigned direction;
 
 	pos = 0;
 
@@ -8731,10 +7747,10 @@ void Bmphandler::GetTissuecontours2Xmirrored(tissuelayers_size_t idx, tissues_si
 	std::vector<unsigned> vec_meetings;
 	float vol;
 
-	tissues_size_t* tissues = m_Tissuelayers[idx];
-	for (short unsigned i = 0; i < m_Height; i++)
+	tissues_size_t* tissues = TissueLayer(idx);
+	for (unsigned i = 0; i < m_Height; i++)
 	{
-		for (short unsigned j = 0; j < m_Width; j++)
+		for (unsigned j = 0; j < m_Width; j++)
 		{
 			tmp_bits[pos] = (unsigned)tissues[pos1];
 			pos++;
@@ -8758,9 +7774,9 @@ void Bmphandler::GetTissuecontours2Xmirrored(tissuelayers_size_t idx, tissues_si
 		nrlines[i] = 0;
 
 	pos = 0;
-	for (unsigned short i = 0; i < m_Height + 1; i++)
+	for (unsigned i = 0; i < m_Height + 1; i++)
 	{
-		for (unsigned short j = 0; j < m_Width + 1; j++)
+		for (unsigned j = 0; j < m_Width + 1; j++)
 		{
 			if ((tmp_bits[pos] != tmp_bits[pos + 1]) && (tmp_bits[pos] == f1 || tmp_bits[pos + 1] == f1))
 				nrlines[pos]++;
@@ -8775,7 +7791,7 @@ void Bmphandler::GetTissuecontours2Xmirrored(tissuelayers_size_t idx, tissues_si
 		pos++;
 	}
 
-	unsigned short direction;
+	unsigned direction;
 
 	pos = 0;
 
@@ -9329,11 +8345,12 @@ void Bmphandler::GetContours(float f, std::vector<std::vector<Point>>* outer_lin
 	float dx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
 	float bordervolume[8] = {1, 0.75f, 0.5f, 0.25f, 2, 1.75f, 1.5f, 1.25f};
 
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Height; i++)
 	{
 		for (unsigned j = 0; j < m_Width; j++)
 		{
-			tmp_bits[pos] = m_WorkBits[pos1];
+			tmp_bits[pos] = work[pos1];
 			pos++;
 			pos1++;
 		}
@@ -9523,11 +8540,12 @@ void Bmphandler::DistanceMap(bool connectivity)
 
 	float wbp;
 	unsigned p;
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
-		m_WorkBits[i] = 0;
+		work[i] = 0;
 	for (it = sorted[255].begin(); it != sorted[255].end(); it++)
 	{
-		m_WorkBits[*it] = m_BmpBits[*it];
+		work[*it] = m_BmpBits[*it];
 	}
 
 	for (unsigned i = 255; i > 0; i--)
@@ -9535,54 +8553,54 @@ void Bmphandler::DistanceMap(bool connectivity)
 		for (it = sorted[i].begin(); it != sorted[i].end(); it++)
 		{
 			p = *it;
-			wbp = m_WorkBits[p];
+			wbp = work[p];
 
 			if ((unsigned)floor(wbp + 0.5f) == i)
 			{
-				if (p % m_Width != 0 && m_WorkBits[p - 1] < wbp - 1)
+				if (p % m_Width != 0 && work[p - 1] < wbp - 1)
 				{
-					m_WorkBits[p - 1] = wbp - 1;
+					work[p - 1] = wbp - 1;
 					sorted[i - 1].push_back(p - 1);
 				}
-				if ((p + 1) % m_Width != 0 && m_WorkBits[p + 1] < wbp - 1)
+				if ((p + 1) % m_Width != 0 && work[p + 1] < wbp - 1)
 				{
-					m_WorkBits[p + 1] = wbp - 1;
+					work[p + 1] = wbp - 1;
 					sorted[i - 1].push_back(p + 1);
 				}
-				if (p >= m_Width && m_WorkBits[p - m_Width] < wbp - 1)
+				if (p >= m_Width && work[p - m_Width] < wbp - 1)
 				{
-					m_WorkBits[p - m_Width] = wbp - 1;
+					work[p - m_Width] = wbp - 1;
 					sorted[i - 1].push_back(p - m_Width);
 				}
-				if ((p + m_Width) < m_Area && m_WorkBits[p + m_Width] < wbp - 1)
+				if ((p + m_Width) < m_Area && work[p + m_Width] < wbp - 1)
 				{
-					m_WorkBits[p + m_Width] = wbp - 1;
+					work[p + m_Width] = wbp - 1;
 					sorted[i - 1].push_back(p + m_Width);
 				}
 				if (connectivity)
 				{
 					if (p % m_Width != 0 && p >= m_Width &&
-							m_WorkBits[p - 1 - m_Width] < wbp - 1)
+							work[p - 1 - m_Width] < wbp - 1)
 					{
-						m_WorkBits[p - 1 - m_Width] = wbp - 1;
+						work[p - 1 - m_Width] = wbp - 1;
 						sorted[i - 1].push_back(p - 1 - m_Width);
 					}
 					if (p % m_Width != 0 && (p + m_Width) < m_Area &&
-							m_WorkBits[p - 1 + m_Width] < wbp - 1)
+							work[p - 1 + m_Width] < wbp - 1)
 					{
-						m_WorkBits[p - 1 + m_Width] = wbp - 1;
+						work[p - 1 + m_Width] = wbp - 1;
 						sorted[i - 1].push_back(p - 1 + m_Width);
 					}
 					if ((p + 1) % m_Width != 0 && p >= m_Width &&
-							m_WorkBits[p - m_Width + 1] < wbp - 1)
+							work[p - m_Width + 1] < wbp - 1)
 					{
-						m_WorkBits[p - m_Width + 1] = wbp - 1;
+						work[p - m_Width + 1] = wbp - 1;
 						sorted[i - 1].push_back(p - m_Width + 1);
 					}
 					if ((p + 1) % m_Width != 0 && (p + m_Width) < m_Area &&
-							m_WorkBits[p + m_Width + 1] < wbp - 1)
+							work[p + m_Width + 1] < wbp - 1)
 					{
-						m_WorkBits[p + m_Width + 1] = wbp - 1;
+						work[p + m_Width + 1] = wbp - 1;
 						sorted[i - 1].push_back(p + m_Width + 1);
 					}
 				}
@@ -9594,7 +8612,7 @@ void Bmphandler::DistanceMap(bool connectivity)
 	m_Mode2 = 1;
 }
 
-void Bmphandler::DistanceMap(bool connectivity, float f, short unsigned levlset)
+void Bmphandler::DistanceMap(bool connectivity, float f, unsigned levlset)
 {
 	unsigned char dummymode = m_Mode1;
 	std::vector<unsigned> v1, v2;
@@ -9616,20 +8634,21 @@ void Bmphandler::DistanceMap(bool connectivity, float f, short unsigned levlset)
 		for (vpit = vi[i].begin(); vpit != vi[i].end(); vpit++)
 			v1.push_back(Pt2coord(*vpit));
 
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
-		m_WorkBits[i] = background;
+		work[i] = background;
 	for (vuit = v1.begin(); vuit != v1.end(); vuit++)
-		m_WorkBits[*vuit] = f;
+		work[*vuit] = f;
 
 	if (levlset == 0)
 		for (unsigned i = 0; i < m_Area; i++)
 			if (m_BmpBits[i] == f)
-				m_WorkBits[i] = f;
+				work[i] = f;
 
 	if (levlset == 1)
 		for (unsigned i = 0; i < m_Area; i++)
 			if (m_BmpBits[i] != f)
-				m_WorkBits[i] = f;
+				work[i] = f;
 
 	vp1 = &v1;
 	vp2 = &v2;
@@ -9642,60 +8661,60 @@ void Bmphandler::DistanceMap(bool connectivity, float f, short unsigned levlset)
 		for (vuit = (*vp1).begin(); vuit != (*vp1).end(); vuit++)
 		{
 			p = *vuit;
-			wbp = m_WorkBits[p];
+			wbp = work[p];
 
-			if (p % m_Width != 0 && m_WorkBits[p - 1] == background)
+			if (p % m_Width != 0 && work[p - 1] == background)
 			{
 				if (m_BmpBits[p - 1] == f)
 				{
-					m_WorkBits[p - 1] = wbp + 1;
+					work[p - 1] = wbp + 1;
 					(*vp2).push_back(p - 1);
 				}
 				else
 				{
-					m_WorkBits[p - 1] = wbp - 1;
+					work[p - 1] = wbp - 1;
 					(*vp2).push_back(p - 1);
 				}
 			}
 
-			if ((p + 1) % m_Width != 0 && m_WorkBits[p + 1] == background)
+			if ((p + 1) % m_Width != 0 && work[p + 1] == background)
 			{
 				if (m_BmpBits[p + 1] == f)
 				{
-					m_WorkBits[p + 1] = wbp + 1;
+					work[p + 1] = wbp + 1;
 					(*vp2).push_back(p + 1);
 				}
 				else
 				{
-					m_WorkBits[p + 1] = wbp - 1;
+					work[p + 1] = wbp - 1;
 					(*vp2).push_back(p + 1);
 				}
 			}
 
-			if (p >= m_Width && m_WorkBits[p - m_Width] == background)
+			if (p >= m_Width && work[p - m_Width] == background)
 			{
 				if (m_BmpBits[p - m_Width] == f)
 				{
-					m_WorkBits[p - m_Width] = wbp + 1;
+					work[p - m_Width] = wbp + 1;
 					(*vp2).push_back(p - m_Width);
 				}
 				else
 				{
-					m_WorkBits[p - m_Width] = wbp - 1;
+					work[p - m_Width] = wbp - 1;
 					(*vp2).push_back(p - m_Width);
 				}
 			}
 
-			if ((p + m_Width) < m_Area != 0 && m_WorkBits[p + m_Width] == background)
+			if ((p + m_Width) < m_Area != 0 && work[p + m_Width] == background)
 			{
 				if (m_BmpBits[p + m_Width] == f)
 				{
-					m_WorkBits[p + m_Width] = wbp + 1;
+					work[p + m_Width] = wbp + 1;
 					(*vp2).push_back(p + m_Width);
 				}
 				else
 				{
-					m_WorkBits[p + m_Width] = wbp - 1;
+					work[p + m_Width] = wbp - 1;
 					(*vp2).push_back(p + m_Width);
 				}
 			}
@@ -9703,61 +8722,61 @@ void Bmphandler::DistanceMap(bool connectivity, float f, short unsigned levlset)
 			if (connectivity)
 			{
 				if (p % m_Width != 0 && p >= m_Width &&
-						m_WorkBits[p - 1 - m_Width] == background)
+						work[p - 1 - m_Width] == background)
 				{
 					if (m_BmpBits[p - 1 - m_Width] == f)
 					{
-						m_WorkBits[p - 1 - m_Width] = wbp + 1;
+						work[p - 1 - m_Width] = wbp + 1;
 						(*vp2).push_back(p - 1 - m_Width);
 					}
 					else
 					{
-						m_WorkBits[p - 1 - m_Width] = wbp - 1;
+						work[p - 1 - m_Width] = wbp - 1;
 						(*vp2).push_back(p - 1 - m_Width);
 					}
 				}
 
 				if (p % m_Width != 0 && (p + m_Width) < m_Area &&
-						m_WorkBits[p - 1 + m_Width] == background)
+						work[p - 1 + m_Width] == background)
 				{
 					if (m_BmpBits[p - 1 + m_Width] == f)
 					{
-						m_WorkBits[p - 1 + m_Width] = wbp + 1;
+						work[p - 1 + m_Width] = wbp + 1;
 						(*vp2).push_back(p - 1 + m_Width);
 					}
 					else
 					{
-						m_WorkBits[p - 1 + m_Width] = wbp - 1;
+						work[p - 1 + m_Width] = wbp - 1;
 						(*vp2).push_back(p - 1 + m_Width);
 					}
 				}
 
 				if ((p + 1) % m_Width != 0 && p >= m_Width &&
-						m_WorkBits[p - m_Width + 1] == background)
+						work[p - m_Width + 1] == background)
 				{
 					if (m_BmpBits[p - m_Width + 1] == f)
 					{
-						m_WorkBits[p - m_Width + 1] = wbp + 1;
+						work[p - m_Width + 1] = wbp + 1;
 						(*vp2).push_back(p - m_Width + 1);
 					}
 					else
 					{
-						m_WorkBits[p - m_Width + 1] = wbp - 1;
+						work[p - m_Width + 1] = wbp - 1;
 						(*vp2).push_back(p - m_Width + 1);
 					}
 				}
 
 				if ((p + 1) % m_Width != 0 && (p + m_Width) < m_Area &&
-						m_WorkBits[p + m_Width + 1] == background)
+						work[p + m_Width + 1] == background)
 				{
 					if (m_BmpBits[p + m_Width + 1] == f)
 					{
-						m_WorkBits[p + m_Width + 1] = wbp + 1;
+						work[p + m_Width + 1] = wbp + 1;
 						(*vp2).push_back(p + m_Width + 1);
 					}
 					else
 					{
-						m_WorkBits[p + m_Width + 1] = wbp - 1;
+						work[p + m_Width + 1] = wbp - 1;
 						(*vp2).push_back(p + m_Width + 1);
 					}
 				}
@@ -9779,9 +8798,11 @@ unsigned* Bmphandler::DeadReckoning(float f)
 	unsigned char dummymode = m_Mode1;
 	unsigned* p = (unsigned*)malloc(m_Area * sizeof(unsigned));
 
+	// allocated here, the swaps around GetContours restore the pointer
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = float((m_Width + m_Height) * (m_Width + m_Height));
+		work[i] = float((m_Width + m_Height) * (m_Width + m_Height));
 		p[i] = m_Area;
 	}
 
@@ -9797,7 +8818,7 @@ unsigned* Bmphandler::DeadReckoning(float f)
 	{
 		for (vpit = vo[i].begin(); vpit != vo[i].end(); vpit++)
 		{
-			m_WorkBits[Pt2coord(*vpit)] = 0;
+			work[Pt2coord(*vpit)] = 0;
 			p[Pt2coord(*vpit)] = Pt2coord(*vpit);
 		}
 		//		cout << ";"<<vo[i].size();
@@ -9806,7 +8827,7 @@ unsigned* Bmphandler::DeadReckoning(float f)
 	{
 		for (vpit = vi[i].begin(); vpit != vi[i].end(); vpit++)
 		{
-			m_WorkBits[Pt2coord(*vpit)] = 0;
+			work[Pt2coord(*vpit)] = 0;
 			p[Pt2coord(*vpit)] = Pt2coord(*vpit);
 		}
 		//		cout << "."<<vi[i].size();
@@ -9817,42 +8838,42 @@ unsigned* Bmphandler::DeadReckoning(float f)
 	float d1 = 1;
 	float d2 = sqrt(2.0f);
 
-	for (unsigned short k = 0; k < m_Height; k++)
+	for (unsigned k = 0; k < m_Height; k++)
 	{
-		for (unsigned short l = 0; l < m_Width; l++)
+		for (unsigned l = 0; l < m_Width; l++)
 		{
 			if (k > 0)
 			{
-				if (l > 0 && m_WorkBits[j - 1 - m_Width] + d2 < m_WorkBits[j])
+				if (l > 0 && work[j - 1 - m_Width] + d2 < work[j])
 				{
 					p[j] = p[j - 1 - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
-				if (m_WorkBits[j - m_Width] + d1 < m_WorkBits[j])
+				if (work[j - m_Width] + d1 < work[j])
 				{
 					p[j] = p[j - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
 				if ((l + 1) != m_Width &&
-						m_WorkBits[j + 1 - m_Width] + d2 < m_WorkBits[j])
+						work[j + 1 - m_Width] + d2 < work[j])
 				{
 					p[j] = p[j + 1 - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 			}
 
-			if (l > 0 && m_WorkBits[j - 1] + d1 < m_WorkBits[j])
+			if (l > 0 && work[j - 1] + d1 < work[j])
 			{
 				p[j] = p[j - 1];
-				m_WorkBits[j] =
+				work[j] =
 						sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 											 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 			}
@@ -9867,37 +8888,37 @@ unsigned* Bmphandler::DeadReckoning(float f)
 	{
 		for (int l = m_Width - 1; l >= 0; l--)
 		{
-			if ((l + 1) != m_Width && m_WorkBits[j + 1] + d1 < m_WorkBits[j])
+			if ((l + 1) != m_Width && work[j + 1] + d1 < work[j])
 			{
 				p[j] = p[j + 1];
-				m_WorkBits[j] =
+				work[j] =
 						sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 											 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 			}
 
 			if ((k + 1) != m_Height)
 			{
-				if (l > 0 && m_WorkBits[j - 1 + m_Width] + d2 < m_WorkBits[j])
+				if (l > 0 && work[j - 1 + m_Width] + d2 < work[j])
 				{
 					p[j] = p[j - 1 + m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
-				if (m_WorkBits[j + m_Width] + d1 < m_WorkBits[j])
+				if (work[j + m_Width] + d1 < work[j])
 				{
 					p[j] = p[j + m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
 				if ((l + 1) != m_Width &&
-						m_WorkBits[j + 1 + m_Width] + d2 < m_WorkBits[j])
+						work[j + 1 + m_Width] + d2 < work[j])
 				{
 					p[j] = p[j + 1 + m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
@@ -9909,42 +8930,42 @@ unsigned* Bmphandler::DeadReckoning(float f)
 
 	j = 0;
 
-	for (unsigned short k = 0; k < m_Height; k++)
+	for (unsigned k = 0; k < m_Height; k++)
 	{
-		for (unsigned short l = 0; l < m_Width; l++)
+		for (unsigned l = 0; l < m_Width; l++)
 		{
 			if (k > 0)
 			{
-				if (l > 0 && m_WorkBits[j - 1 - m_Width] + d2 < m_WorkBits[j])
+				if (l > 0 && work[j - 1 - m_Width] + d2 < work[j])
 				{
 					p[j] = p[j - 1 - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
-				if (m_WorkBits[j - m_Width] + d1 < m_WorkBits[j])
+				if (work[j - m_Width] + d1 < work[j])
 				{
 					p[j] = p[j - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
 				if ((l + 1) != m_Width &&
-						m_WorkBits[j + 1 - m_Width] + d2 < m_WorkBits[j])
+						work[j + 1 - m_Width] + d2 < work[j])
 				{
 					p[j] = p[j + 1 - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 			}
 
-			if (l > 0 && m_WorkBits[j - 1] + d1 < m_WorkBits[j])
+			if (l > 0 && work[j - 1] + d1 < work[j])
 			{
 				p[j] = p[j - 1];
-				m_WorkBits[j] =
+				work[j] =
 						sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 											 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 			}
@@ -9955,7 +8976,7 @@ unsigned* Bmphandler::DeadReckoning(float f)
 
 	for (unsigned i = 0; i < m_Area; i++)
 		if (m_BmpBits[i] != f)
-			m_WorkBits[i] = -m_WorkBits[i];
+			work[i] = -work[i];
 
 	/*	for(unsigned i=0;i<(unsigned)vo.size();i++)
 		for(vpit=vo[i].begin();vpit!=vo[i].end();vpit++) {
@@ -9979,20 +9000,21 @@ void Bmphandler::DeadReckoning()
 	unsigned char dummymode = m_Mode1;
 	unsigned* p = (unsigned*)malloc(m_Area * sizeof(unsigned));
 
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = float((m_Width + m_Height) * (m_Width + m_Height));
+		work[i] = float((m_Width + m_Height) * (m_Width + m_Height));
 		p[i] = m_Area;
 	}
 
 	unsigned i1 = 0;
-	for (unsigned short h = 0; h < m_Height - 1; h++)
+	for (unsigned h = 0; h < m_Height - 1; h++)
 	{
-		for (unsigned short w = 0; w < m_Width; w++)
+		for (unsigned w = 0; w < m_Width; w++)
 		{
 			if (m_BmpBits[i1] != m_BmpBits[i1 + m_Width])
 			{
-				m_WorkBits[i1] = m_WorkBits[i1 + m_Width] = 0;
+				work[i1] = work[i1 + m_Width] = 0;
 				p[i1] = i1;
 				p[i1 + m_Width] = i1 + m_Width;
 			}
@@ -10001,13 +9023,13 @@ void Bmphandler::DeadReckoning()
 	}
 
 	i1 = 0;
-	for (unsigned short h = 0; h < m_Height; h++)
+	for (unsigned h = 0; h < m_Height; h++)
 	{
-		for (unsigned short w = 0; w < m_Width - 1; w++)
+		for (unsigned w = 0; w < m_Width - 1; w++)
 		{
 			if (m_BmpBits[i1] != m_BmpBits[i1 + 1])
 			{
-				m_WorkBits[i1] = m_WorkBits[i1 + 1] = 0;
+				work[i1] = work[i1 + 1] = 0;
 				p[i1] = i1;
 				p[i1 + 1] = i1 + 1;
 			}
@@ -10021,42 +9043,42 @@ void Bmphandler::DeadReckoning()
 	float d1 = 1;
 	float d2 = sqrt(2.0f);
 
-	for (unsigned short k = 0; k < m_Height; k++)
+	for (unsigned k = 0; k < m_Height; k++)
 	{
-		for (unsigned short l = 0; l < m_Width; l++)
+		for (unsigned l = 0; l < m_Width; l++)
 		{
 			if (k > 0)
 			{
-				if (l > 0 && m_WorkBits[j - 1 - m_Width] + d2 < m_WorkBits[j])
+				if (l > 0 && work[j - 1 - m_Width] + d2 < work[j])
 				{
 					p[j] = p[j - 1 - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
-				if (m_WorkBits[j - m_Width] + d1 < m_WorkBits[j])
+				if (work[j - m_Width] + d1 < work[j])
 				{
 					p[j] = p[j - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
 				if ((l + 1) != m_Width &&
-						m_WorkBits[j + 1 - m_Width] + d2 < m_WorkBits[j])
+						work[j + 1 - m_Width] + d2 < work[j])
 				{
 					p[j] = p[j + 1 - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 			}
 
-			if (l > 0 && m_WorkBits[j - 1] + d1 < m_WorkBits[j])
+			if (l > 0 && work[j - 1] + d1 < work[j])
 			{
 				p[j] = p[j - 1];
-				m_WorkBits[j] =
+				work[j] =
 						sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 											 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 			}
@@ -10071,37 +9093,37 @@ void Bmphandler::DeadReckoning()
 	{
 		for (int l = m_Width - 1; l >= 0; l--)
 		{
-			if ((l + 1) != m_Width && m_WorkBits[j + 1] + d1 < m_WorkBits[j])
+			if ((l + 1) != m_Width && work[j + 1] + d1 < work[j])
 			{
 				p[j] = p[j + 1];
-				m_WorkBits[j] =
+				work[j] =
 						sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 											 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 			}
 
 			if ((k + 1) != m_Height)
 			{
-				if (l > 0 && m_WorkBits[j - 1 + m_Width] + d2 < m_WorkBits[j])
+				if (l > 0 && work[j - 1 + m_Width] + d2 < work[j])
 				{
 					p[j] = p[j - 1 + m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
-				if (m_WorkBits[j + m_Width] + d1 < m_WorkBits[j])
+				if (work[j + m_Width] + d1 < work[j])
 				{
 					p[j] = p[j + m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
 				if ((l + 1) != m_Width &&
-						m_WorkBits[j + 1 + m_Width] + d2 < m_WorkBits[j])
+						work[j + 1 + m_Width] + d2 < work[j])
 				{
 					p[j] = p[j + 1 + m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
@@ -10113,42 +9135,42 @@ void Bmphandler::DeadReckoning()
 
 	j = 0;
 
-	for (unsigned short k = 0; k < m_Height; k++)
+	for (unsigned k = 0; k < m_Height; k++)
 	{
-		for (unsigned short l = 0; l < m_Width; l++)
+		for (unsigned l = 0; l < m_Width; l++)
 		{
 			if (k > 0)
 			{
-				if (l > 0 && m_WorkBits[j - 1 - m_Width] + d2 < m_WorkBits[j])
+				if (l > 0 && work[j - 1 - m_Width] + d2 < work[j])
 				{
 					p[j] = p[j - 1 - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
-				if (m_WorkBits[j - m_Width] + d1 < m_WorkBits[j])
+				if (work[j - m_Width] + d1 < work[j])
 				{
 					p[j] = p[j - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
 				if ((l + 1) != m_Width &&
-						m_WorkBits[j + 1 - m_Width] + d2 < m_WorkBits[j])
+						work[j + 1 - m_Width] + d2 < work[j])
 				{
 					p[j] = p[j + 1 - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 												 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 			}
 
-			if (l > 0 && m_WorkBits[j - 1] + d1 < m_WorkBits[j])
+			if (l > 0 && work[j - 1] + d1 < work[j])
 			{
 				p[j] = p[j - 1];
-				m_WorkBits[j] =
+				work[j] =
 						sqrt(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 											 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 			}
@@ -10171,9 +9193,11 @@ unsigned* Bmphandler::DeadReckoningSquared(float f)
 	unsigned char dummymode = m_Mode1;
 	unsigned* p = (unsigned*)malloc(m_Area * sizeof(unsigned));
 
+	// allocated here, the swaps around GetContours restore the pointer
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = float((m_Width + m_Height) * (m_Width + m_Height));
+		work[i] = float((m_Width + m_Height) * (m_Width + m_Height));
 		p[i] = m_Area;
 	}
 
@@ -10188,7 +9212,7 @@ unsigned* Bmphandler::DeadReckoningSquared(float f)
 	{
 		for (vpit = vo[i].begin(); vpit != vo[i].end(); vpit++)
 		{
-			m_WorkBits[Pt2coord(*vpit)] = 0;
+			work[Pt2coord(*vpit)] = 0;
 			p[Pt2coord(*vpit)] = Pt2coord(*vpit);
 		}
 	}
@@ -10196,7 +9220,7 @@ unsigned* Bmphandler::DeadReckoningSquared(float f)
 	{
 		for (vpit = vi[i].begin(); vpit != vi[i].end(); vpit++)
 		{
-			m_WorkBits[Pt2coord(*vpit)] = 0;
+			work[Pt2coord(*vpit)] = 0;
 			p[Pt2coord(*vpit)] = Pt2coord(*vpit);
 		}
 	}
@@ -10206,42 +9230,42 @@ unsigned* Bmphandler::DeadReckoningSquared(float f)
 	float d1 = 1;
 	float d2 = sqrt(2.0f);
 
-	for (unsigned short k = 0; k < m_Height; k++)
+	for (unsigned k = 0; k < m_Height; k++)
 	{
-		for (unsigned short l = 0; l < m_Width; l++)
+		for (unsigned l = 0; l < m_Width; l++)
 		{
 			if (k > 0)
 			{
-				if (l > 0 && m_WorkBits[j - 1 - m_Width] + d2 < m_WorkBits[j])
+				if (l > 0 && work[j - 1 - m_Width] + d2 < work[j])
 				{
 					p[j] = p[j - 1 - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 										 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
-				if (m_WorkBits[j - m_Width] + d1 < m_WorkBits[j])
+				if (work[j - m_Width] + d1 < work[j])
 				{
 					p[j] = p[j - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 										 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
 				if ((l + 1) != m_Width &&
-						m_WorkBits[j + 1 - m_Width] + d2 < m_WorkBits[j])
+						work[j + 1 - m_Width] + d2 < work[j])
 				{
 					p[j] = p[j + 1 - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 										 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 			}
 
-			if (l > 0 && m_WorkBits[j - 1] + d1 < m_WorkBits[j])
+			if (l > 0 && work[j - 1] + d1 < work[j])
 			{
 				p[j] = p[j - 1];
-				m_WorkBits[j] = (float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
+				work[j] = (float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 															 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 			}
 
@@ -10255,36 +9279,36 @@ unsigned* Bmphandler::DeadReckoningSquared(float f)
 	{
 		for (int l = m_Width - 1; l >= 0; l--)
 		{
-			if ((l + 1) != m_Width && m_WorkBits[j + 1] + d1 < m_WorkBits[j])
+			if ((l + 1) != m_Width && work[j + 1] + d1 < work[j])
 			{
 				p[j] = p[j + 1];
-				m_WorkBits[j] = (float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
+				work[j] = (float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 															 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 			}
 
 			if ((k + 1) != m_Height)
 			{
-				if (l > 0 && m_WorkBits[j - 1 + m_Width] + d2 < m_WorkBits[j])
+				if (l > 0 && work[j - 1 + m_Width] + d2 < work[j])
 				{
 					p[j] = p[j - 1 + m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 										 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
-				if (m_WorkBits[j + m_Width] + d1 < m_WorkBits[j])
+				if (work[j + m_Width] + d1 < work[j])
 				{
 					p[j] = p[j + m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 										 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
 				if ((l + 1) != m_Width &&
-						m_WorkBits[j + 1 + m_Width] + d2 < m_WorkBits[j])
+						work[j + 1 + m_Width] + d2 < work[j])
 				{
 					p[j] = p[j + 1 + m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 										 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
@@ -10296,42 +9320,42 @@ unsigned* Bmphandler::DeadReckoningSquared(float f)
 
 	j = 0;
 
-	for (unsigned short k = 0; k < m_Height; k++)
+	for (unsigned k = 0; k < m_Height; k++)
 	{
-		for (unsigned short l = 0; l < m_Width; l++)
+		for (unsigned l = 0; l < m_Width; l++)
 		{
 			if (k > 0)
 			{
-				if (l > 0 && m_WorkBits[j - 1 - m_Width] + d2 < m_WorkBits[j])
+				if (l > 0 && work[j - 1 - m_Width] + d2 < work[j])
 				{
 					p[j] = p[j - 1 - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 										 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
-				if (m_WorkBits[j - m_Width] + d1 < m_WorkBits[j])
+				if (work[j - m_Width] + d1 < work[j])
 				{
 					p[j] = p[j - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 										 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 
 				if ((l + 1) != m_Width &&
-						m_WorkBits[j + 1 - m_Width] + d2 < m_WorkBits[j])
+						work[j + 1 - m_Width] + d2 < work[j])
 				{
 					p[j] = p[j + 1 - m_Width];
-					m_WorkBits[j] =
+					work[j] =
 							(float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 										 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 				}
 			}
 
-			if (l > 0 && m_WorkBits[j - 1] + d1 < m_WorkBits[j])
+			if (l > 0 && work[j - 1] + d1 < work[j])
 			{
 				p[j] = p[j - 1];
-				m_WorkBits[j] = (float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
+				work[j] = (float((l - p[j] % m_Width) * (l - p[j] % m_Width) +
 															 (k - p[j] / m_Width) * (k - p[j] / m_Width)));
 			}
 
@@ -10341,7 +9365,7 @@ unsigned* Bmphandler::DeadReckoningSquared(float f)
 
 	for (unsigned i = 0; i < m_Area; i++)
 		if (m_BmpBits[i] != f)
-			m_WorkBits[i] = -m_WorkBits[i];
+			work[i] = -work[i];
 
 	/*	for(unsigned i=0;i<(unsigned)vo.size();i++)
 		for(vpit=vo[i].begin();vpit!=vo[i].end();vpit++) {
@@ -10366,12 +9390,13 @@ void Bmphandler::IftDistance1(float f)
 	ImageForestingTransformDistance if_tdist;
 	if_tdist.DistanceInit(m_Width, m_Height, f, m_BmpBits);
 	float* f1 = if_tdist.ReturnPf();
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
 	{
 		if (m_BmpBits[i] == f)
-			m_WorkBits[i] = f1[i];
+			work[i] = f1[i];
 		else
-			m_WorkBits[i] = -f1[i];
+			work[i] = -f1[i];
 	}
 	m_Mode1 = dummymode;
 	m_Mode2 = 1;
@@ -10390,12 +9415,13 @@ void Bmphandler::RgIft(float* lb_map, float thresh)
 	float* f1 = if_trg.ReturnLb();
 	float* f2 = if_trg.ReturnPf();
 
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
 	{
 		if (f2[i] < thresh)
-			m_WorkBits[i] = f1[i];
+			work[i] = f1[i];
 		else
-			m_WorkBits[i] = 0;
+			work[i] = 0;
 	}
 
 	m_Mode1 = dummymode;
@@ -10432,7 +9458,7 @@ ImageForestingTransformLivewire* Bmphandler::Livewireinit(Point pt)
 	float* tmp = m_Sliceprovide->GiveMe();
 	float* dummy;
 	float* dummy1;
-	float* grad = m_WorkBits;
+	float* grad = WorkBits();
 	m_WorkBits = m_Sliceprovide->GiveMe();
 
 	Gaussian(1);
@@ -10453,27 +9479,28 @@ ImageForestingTransformLivewire* Bmphandler::Livewireinit(Point pt)
 	//	grad=work_bits;
 	//	work_bits=sobelx;
 	dummy1 = sobely;
-	sobely = m_WorkBits;
+	sobely = WorkBits();
 	m_WorkBits = dummy1;
 
 	LaplacianZero(2.0f, 30, false);
 
+	float* work = WorkBits();
 	if (p.high != 0)
 		for (unsigned i = 0; i < m_Area; i++)
 			sobelx[i] = (0.43f * (1 - sobely[i] / p.high) +
-									 0.43f * ((m_WorkBits[i] + 1) / 256));
+									 0.43f * ((work[i] + 1) / 256));
 	else
 		for (unsigned i = 0; i < m_Area; i++)
-			sobelx[i] = 0.43f * ((m_WorkBits[i] + 1) / 256);
+			sobelx[i] = 0.43f * ((work[i] + 1) / 256);
 
 	ImageForestingTransformLivewire* lw = new ImageForestingTransformLivewire;
 	lw->LwInit(m_Width, m_Height, sobelx, dummy, pt);
 
-	m_Sliceprovide->TakeBack(sobelx);
-	m_Sliceprovide->TakeBack(sobely);
-	m_Sliceprovide->TakeBack(m_BmpBits);
-	m_Sliceprovide->TakeBack(m_WorkBits);
-	m_Sliceprovide->TakeBack(dummy);
+	Recycle(sobelx);
+	Recycle(sobely);
+	Recycle(m_BmpBits);
+	Recycle(m_WorkBits);
+	Recycle(dummy);
 	m_BmpBits = tmp;
 	m_WorkBits = grad;
 
@@ -10557,11 +9584,12 @@ void Bmphandler::FillContour(std::vector<Point>* vp, bool continuous)
 
 		i = m_Width + 3;
 		int i2 = 0;
+		float* work = WorkBits();
 		for (int j = 0; j < m_Height; j++)
 		{
 			for (int k = 0; k < m_Width; k++)
 			{
-				m_WorkBits[i2] = 255.0f - results[i];
+				work[i2] = 255.0f - results[i];
 				//				if(results[i]==0) 0;
 				//				work_bits[i2]=results[i];
 				i++;
@@ -10600,11 +9628,12 @@ void Bmphandler::AddSkin(unsigned i4, float setto)
 
 	//Create a binary std::vector noTissue/Tissue
 	std::vector<int> s;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			if (m_WorkBits[i] == 0)
+			if (work[i] == 0)
 				s.push_back(-1);
 			else
 				s.push_back(0);
@@ -10691,7 +9720,7 @@ void Bmphandler::AddSkin(unsigned i4, float setto)
 		for (int k = 0; k < m_Width; k++)
 		{
 			if (s[i] == 256)
-				m_WorkBits[i] = setto;
+				work[i] = setto;
 			i++;
 		}
 	}
@@ -10708,11 +9737,12 @@ void Bmphandler::AddSkinOutside(unsigned i4, float setto)
 
 	int i = m_Width + 3;
 	int i3 = 0;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			if (m_WorkBits[i3] == 0)
+			if (work[i3] == 0)
 				results[i] = -1;
 			else
 			{
@@ -10784,7 +9814,7 @@ void Bmphandler::AddSkinOutside(unsigned i4, float setto)
 		for (int k = 0; k < m_Width; k++)
 		{
 			if (results[i] == 255.0f)
-				m_WorkBits[i2] = setto;
+				work[i2] = setto;
 			//			work_bits[i2]=results[i];
 			i++;
 			i2++;
@@ -10806,7 +9836,7 @@ void Bmphandler::AddSkintissue(tissuelayers_size_t idx, unsigned i4, tissues_siz
 
 	int i = m_Width + 3;
 	int i3 = 0;
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
@@ -10865,7 +9895,7 @@ void Bmphandler::AddSkintissue(tissuelayers_size_t idx, unsigned i4, tissues_siz
 
 	HystereticGrowth(results, &s, m_Width + 2, m_Height + 2, false, 255.0f);
 
-	unsigned short x, y;
+	unsigned x, y;
 	unsigned pos;
 	unsigned i1;
 	unsigned w = (unsigned)(m_Width + 2);
@@ -10978,7 +10008,7 @@ void Bmphandler::AddSkintissueOutside(tissuelayers_size_t idx, unsigned i4, tiss
 
 	int i = m_Width + 3;
 	int i3 = 0;
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
@@ -11066,8 +10096,10 @@ void Bmphandler::AddSkintissueOutside(tissuelayers_size_t idx, unsigned i4, tiss
 
 bool Bmphandler::ValueAtBoundary(float value)
 {
+	const float* work = ReadWork();
+
 	// Top
-	float* tmp = &m_WorkBits[0];
+	const float* tmp = work;
 	for (unsigned pos = 0; pos < m_Width; pos++, tmp++)
 	{
 		if (*tmp == value)
@@ -11077,14 +10109,14 @@ bool Bmphandler::ValueAtBoundary(float value)
 	// Left & right
 	for (unsigned pos = 1; pos < (m_Height - 1); pos++)
 	{
-		if (m_WorkBits[pos * m_Width] == value)
+		if (work[pos * m_Width] == value)
 			return true;
-		else if (m_WorkBits[(pos + 1) * m_Width - 1] == value)
+		else if (work[(pos + 1) * m_Width - 1] == value)
 			return true;
 	}
 
 	// Bottom
-	tmp = &m_WorkBits[(m_Height - 1) * m_Width];
+	tmp = &work[(m_Height - 1) * m_Width];
 	for (unsigned pos = 0; pos < m_Width; pos++, tmp++)
 	{
 		if (*tmp == value)
@@ -11096,7 +10128,7 @@ bool Bmphandler::ValueAtBoundary(float value)
 bool Bmphandler::TissuevalueAtBoundary(tissuelayers_size_t idx, tissues_size_t value)
 {
 	// Top
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	tissues_size_t* tmp = &(tissues[0]);
 	for (unsigned pos = 0; pos < m_Width; pos++, tmp++)
 	{
@@ -11128,6 +10160,7 @@ float Bmphandler::AddSkin(unsigned i)
 	Pair p;
 	GetRange(&p);
 	float setto;
+	float* work = WorkBits();
 	if (p.high <= 254.0f)
 		setto = 255.0f;
 	else if (p.low >= 1.0f)
@@ -11137,8 +10170,8 @@ float Bmphandler::AddSkin(unsigned i)
 		setto = p.low;
 		for (unsigned pos = 0; pos < m_Area; pos++)
 		{
-			if (m_WorkBits[pos] != p.high)
-				setto = std::max(setto, m_WorkBits[pos]);
+			if (work[pos] != p.high)
+				setto = std::max(setto, work[pos]);
 		}
 		setto = (setto + p.high) / 2;
 	}
@@ -11152,6 +10185,7 @@ float Bmphandler::AddSkinOutside(unsigned i)
 	Pair p;
 	GetRange(&p);
 	float setto;
+	float* work = WorkBits();
 	if (p.high <= 254.0f)
 		setto = 255.0f;
 	else if (p.low >= 1.0f)
@@ -11161,8 +10195,8 @@ float Bmphandler::AddSkinOutside(unsigned i)
 		setto = p.low;
 		for (unsigned pos = 0; pos < m_Area; pos++)
 		{
-			if (m_WorkBits[pos] != p.high)
-				setto = std::max(setto, m_WorkBits[pos]);
+			if (work[pos] != p.high)
+				setto = std::max(setto, work[pos]);
 		}
 		setto = (setto + p.high) / 2;
 	}
@@ -11203,7 +10237,7 @@ void Bmphandler::FillSkin(int thicknessX, int thicknessY, tissues_size_t backgro
 
 	tissues_size_t* tissues;
 	if (!m_Tissuelayers.empty())
-		tissues = m_Tissuelayers[0];
+		tissues = TissueLayer(0);
 
 	bool preview_way = true;
 
@@ -11221,6 +10255,7 @@ void Bmphandler::FillSkin(int thicknessX, int thicknessY, tissues_size_t backgro
 		this->DeadReckoning((float)0);
 		bmp1 = this->ReturnWork();
 
+		float* work = WorkBits();
 		for (int j = skin_thick; j + skin_thick < dims[1]; j++)
 		{
 			for (int i = skin_thick; i + skin_thick < dims[0]; i++)
@@ -11247,7 +10282,7 @@ void Bmphandler::FillSkin(int thicknessX, int thicknessY, tissues_size_t backgro
 						*/
 						if (tissues[idx] != backgroundID &&
 								tissues[idx] != skinID)
-							m_WorkBits[pos] = 255.0f;
+							work[pos] = 255.0f;
 					}
 				}
 			}
@@ -11302,11 +10337,12 @@ void Bmphandler::FloodExterior(float setto)
 
 	int i = m_Width + 3;
 	int i3 = 0;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			if (m_WorkBits[i3] == 0)
+			if (work[i3] == 0)
 				results[i] = -1;
 			else
 				results[i] = 0;
@@ -11367,7 +10403,7 @@ void Bmphandler::FloodExterior(float setto)
 		for (int k = 0; k < m_Width; k++)
 		{
 			if (results[i] == 255.0f)
-				m_WorkBits[i3] = setto;
+				work[i3] = setto;
 			i++;
 			i3++;
 		}
@@ -11390,7 +10426,7 @@ void Bmphandler::FloodExteriortissue(tissuelayers_size_t idx, tissues_size_t set
 
 	int i = m_Width + 3;
 	int i3 = 0;
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
@@ -11475,6 +10511,7 @@ void Bmphandler::FillUnassigned()
 	Pair p;
 	GetRange(&p);
 	float setto;
+	float* work = WorkBits();
 	if (p.high <= 254.0f)
 		setto = 255.0f;
 	else if (p.low >= 1.0f)
@@ -11484,8 +10521,8 @@ void Bmphandler::FillUnassigned()
 		setto = p.low;
 		for (unsigned pos = 0; pos < m_Area; pos++)
 		{
-			if (m_WorkBits[pos] != p.high)
-				setto = std::max(setto, m_WorkBits[pos]);
+			if (work[pos] != p.high)
+				setto = std::max(setto, work[pos]);
 		}
 		setto = (setto + p.high) / 2;
 	}
@@ -11500,11 +10537,12 @@ void Bmphandler::FillUnassigned(float setto)
 
 	int i = m_Width + 3;
 	int i3 = 0;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			if (m_WorkBits[i3] == 0)
+			if (work[i3] == 0)
 				results[i] = -1;
 			else
 				results[i] = 0;
@@ -11561,12 +10599,12 @@ void Bmphandler::FillUnassigned(float setto)
 	unsigned pos = m_Width + 3;
 	unsigned long pos1 = 0;
 
-	for (unsigned short py = 0; py < m_Height; py++)
+	for (unsigned py = 0; py < m_Height; py++)
 	{
-		for (unsigned short px = 0; px < m_Width; px++)
+		for (unsigned px = 0; px < m_Width; px++)
 		{
-			if (results[pos] != 255.0f && m_WorkBits[pos1] == 0)
-				m_WorkBits[pos1] = setto;
+			if (results[pos] != 255.0f && work[pos1] == 0)
+				work[pos1] = setto;
 			pos++;
 			pos1++;
 		}
@@ -11584,7 +10622,7 @@ void Bmphandler::FillUnassignedtissue(tissuelayers_size_t idx, tissues_size_t se
 
 	int i = m_Width + 3;
 	int i3 = 0;
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
@@ -11646,9 +10684,9 @@ void Bmphandler::FillUnassignedtissue(tissuelayers_size_t idx, tissues_size_t se
 	unsigned pos = m_Width + 3;
 	unsigned long pos1 = 0;
 
-	for (unsigned short py = 0; py < m_Height; py++)
+	for (unsigned py = 0; py < m_Height; py++)
 	{
-		for (unsigned short px = 0; px < m_Width; px++)
+		for (unsigned px = 0; px < m_Width; px++)
 		{
 			if (results[pos] != 255.0f && tissues[pos1] == 0)
 				tissues[pos1] = setto;
@@ -11666,11 +10704,12 @@ void Bmphandler::AdaptiveFuzzy(Point p, float m1, float s1, float s2, float /* t
 	ImageForestingTransformAdaptFuzzy af;
 	af.FuzzyInit(m_Width, m_Height, m_BmpBits, p, m1, s1, s2);
 	float* pf = af.ReturnPf();
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
 	{
 		/*		if(pf[i]<1-thresh) work_bits[i]=255;
 		else work_bits[i]=0;*/
-		m_WorkBits[i] = pf[i] * 255;
+		work[i] = pf[i] * 255;
 	}
 	m_Mode2 = 1;
 }
@@ -11692,25 +10731,26 @@ void Bmphandler::FastMarching(Point p, float sigma, float thresh)
 	lbl = m_BmpBits;
 	m_BmpBits = dummy;
 
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = exp(-m_WorkBits[i] / thresh);
+		work[i] = exp(-work[i] / thresh);
 		lbl[i] = 0;
 	}
 	lbl[Pt2coord(p)] = 1;
 
-	fm.FastmarchInit(m_Width, m_Height, m_WorkBits, lbl);
+	fm.FastmarchInit(m_Width, m_Height, work, lbl);
 	float* pf = fm.ReturnPf();
 	for (unsigned i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = pf[i];
+		work[i] = pf[i];
 	}
 	Pair p1;
 	GetRange(&p1);
 	//	cout << p1.high << " " << p1.low << endl;
 	//	scale_colors(p1);
 
-	m_Sliceprovide->TakeBack(lbl);
+	Recycle(lbl);
 
 	m_Mode1 = dummymode;
 	m_Mode2 = 1;
@@ -11725,7 +10765,7 @@ ImageForestingTransformFastMarching*
 			new ImageForestingTransformFastMarching;
 
 	float* dummy;
-	float* work_store = m_WorkBits;
+	float* work_store = WorkBits();
 	m_WorkBits = m_Sliceprovide->GiveMe();
 	Gaussian(sigma);
 	float* lbl = m_BmpBits;
@@ -11736,17 +10776,18 @@ ImageForestingTransformFastMarching*
 	lbl = m_BmpBits;
 	m_BmpBits = dummy;
 
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = exp(-m_WorkBits[i] / thresh);
+		work[i] = exp(-work[i] / thresh);
 		lbl[i] = 0;
 	}
 	lbl[Pt2coord(p)] = 1;
 
-	fm->FastmarchInit(m_Width, m_Height, m_WorkBits, lbl);
+	fm->FastmarchInit(m_Width, m_Height, work, lbl);
 
-	m_Sliceprovide->TakeBack(lbl);
-	m_Sliceprovide->TakeBack(m_WorkBits);
+	Recycle(lbl);
+	Recycle(m_WorkBits);
 	m_WorkBits = work_store;
 
 	m_Mode1 = dummymode1;
@@ -11763,7 +10804,7 @@ float Bmphandler::ExtractFeature(Point p1, Point p2)
 
 float Bmphandler::ExtractFeaturework(Point p1, Point p2)
 {
-	m_Fextract.Init(m_WorkBits, p1, p2, m_Width, m_Height);
+	m_Fextract.Init(WorkBits(), p1, p2, m_Width, m_Height);
 	return m_Fextract.ReturnAverage();
 }
 
@@ -11785,8 +10826,9 @@ void Bmphandler::Classify(short nrclasses, short dim, float** bits, float* weigh
 	short k;
 	float dist, distmin;
 	maxdist = maxdist * maxdist;
-	short unsigned cindex;
+	unsigned cindex;
 
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
 	{
 		k = 0;
@@ -11814,9 +10856,9 @@ void Bmphandler::Classify(short nrclasses, short dim, float** bits, float* weigh
 			}
 		}
 		if (distmin < maxdist)
-			m_WorkBits[i] = 255.0f * (k + 1) / nrclasses;
+			work[i] = 255.0f * (k + 1) / nrclasses;
 		else
-			m_WorkBits[i] = 0;
+			work[i] = 0;
 	}
 
 	m_Mode2 = 2;
@@ -11837,26 +10879,26 @@ void Bmphandler::Kmeans(short nrtissues, short dim, float** bits, float* weights
 	KMeans kmeans;
 	kmeans.Init(m_Width, m_Height, nrtissues, dim, bits, weightsnew);
 	kmeans.MakeIter(iternr, converge);
-	kmeans.ReturnM(m_WorkBits);
+	kmeans.ReturnM(WorkBits());
 	free(weightsnew);
 	m_Mode2 = 2;
 }
 
-void Bmphandler::KmeansMhd(short nrtissues, short dim, std::vector<std::string> mhdfiles, unsigned short slicenr, float* weights, unsigned int iternr, unsigned int converge)
+void Bmphandler::KmeansMhd(short nrtissues, short dim, std::vector<std::string> mhdfiles, unsigned slicenr, float* weights, unsigned int iternr, unsigned int converge)
 {
 	float** bits = new float*[dim];
-	for (unsigned short j = 0; j + 1 < dim; j++)
+	for (unsigned j = 0; j + 1 < dim; j++)
 	{
 		bits[j + 1] = m_Sliceprovide->GiveMe();
 	}
 
 	bits[0] = m_BmpBits;
-	for (unsigned short i = 0; i + 1 < dim; i++)
+	for (unsigned i = 0; i + 1 < dim; i++)
 	{
 		if (!ImageReader::GetSlice(mhdfiles[i].c_str(), bits[i + 1], slicenr, m_Width, m_Height))
 		{
-			for (unsigned short j = 1; j < dim; j++)
-				m_Sliceprovide->TakeBack(bits[j]);
+			for (unsigned j = 1; j < dim; j++)
+				Recycle(bits[j]);
 			delete[] bits;
 			return;
 		}
@@ -11875,31 +10917,31 @@ void Bmphandler::KmeansMhd(short nrtissues, short dim, std::vector<std::string>
 	KMeans kmeans;
 	kmeans.Init(m_Width, m_Height, nrtissues, dim, bits, weightsnew);
 	kmeans.MakeIter(iternr, converge);
-	kmeans.ReturnM(m_WorkBits);
+	kmeans.ReturnM(WorkBits());
 	free(weightsnew);
 
-	for (unsigned short j = 1; j < dim; j++)
-		m_Sliceprovide->TakeBack(bits[j]);
+	for (unsigned j = 1; j < dim; j++)
+		Recycle(bits[j]);
 	delete[] bits;
 
 	m_Mode2 = 2;
 }
 
-void Bmphandler::KmeansPng(short nrtissues, short dim, std::vector<std::string> pngfiles, std::vector<int> exctractChannel, unsigned short slicenr, float* weights, unsigned int iternr, unsigned int converge, const std::string initCentersFile)
+void Bmphandler::KmeansPng(short nrtissues, short dim, std::vector<std::string> pngfiles, std::vector<int> exctractChannel, unsigned slicenr, float* weights, unsigned int iternr, unsigned int converge, const std::string initCentersFile)
 {
 	float** bits = new float*[dim];
-	for (unsigned short j = 0; j + 1 < dim; j++)
+	for (unsigned j = 0; j + 1 < dim; j++)
 	{
 		bits[j + 1] = m_Sliceprovide->GiveMe();
 	}
 
 	bits[0] = m_BmpBits;
-	for (unsigned short i = 0; i + 1 < dim; i++)
+	for (unsigned i = 0; i + 1 < dim; i++)
 	{
 		if (!ChannelExtractor::getSlice(pngfiles[0].c_str(), bits[i + 1], exctractChannel[i], slicenr, m_Width, m_Height))
 		{
-			for (unsigned short j = 1; j < dim; j++)
-				m_Sliceprovide->TakeBack(bits[j]);
+			for (unsigned j = 1; j < dim; j++)
+				Recycle(bits[j]);
 			delete[] bits;
 			return;
 		}
@@ -11941,31 +10983,31 @@ void Bmphandler::KmeansPng(short nrtissues, short dim, std::vector<std::string>
 		kmeans.Init(m_Width, m_Height, nrtissues, dim, bits, weightsnew);
 	}
 	kmeans.MakeIter(iternr, converge);
-	kmeans.ReturnM(m_WorkBits);
+	kmeans.ReturnM(WorkBits());
 	free(weightsnew);
 
-	for (unsigned short j = 1; j < dim; j++)
-		m_Sliceprovide->TakeBack(bits[j]);
+	for (unsigned j = 1; j < dim; j++)
+		Recycle(bits[j]);
 	delete[] bits;
 
 	m_Mode2 = 2;
 }
 
-void Bmphandler::GammaMhd(short nrtissues, short dim, std::vector<std::string> mhdfiles, unsigned short slicenr, float* weights, float** centers, float* tol_f, float* tol_d, Pair pixelsize)
+void Bmphandler::GammaMhd(short nrtissues, short dim, std::vector<std::string> mhdfiles, unsigned slicenr, float* weights, float** centers, float* tol_f, float* tol_d, Pair pixelsize)
 {
 	float** bits = new float*[dim];
-	for (unsigned short j = 0; j + 1 < dim; j++)
+	for (unsigned j = 0; j + 1 < dim; j++)
 	{
 		bits[j + 1] = m_Sliceprovide->GiveMe();
 	}
 
 	bits[0] = m_BmpBits;
-	for (unsigned short i = 0; i + 1 < dim; i++)
+	for (unsigned i = 0; i + 1 < dim; i++)
 	{
 		if (!ImageReader::GetSlice(mhdfiles[i].c_str(), bits[i + 1], slicenr, m_Width, m_Height))
 		{
-			for (unsigned short j = 1; j < dim; j++)
-				m_Sliceprovide->TakeBack(bits[j]);
+			for (unsigned j = 1; j < dim; j++)
+				Recycle(bits[j]);
 			delete[] bits;
 			return;
 		}
@@ -11974,10 +11016,10 @@ void Bmphandler::GammaMhd(short nrtissues, short dim, std::vector<std::string> m
 	MultidimensionalGamma mdg;
 	mdg.Init(m_Width, m_Height, nrtissues, dim, bits, weights, centers, tol_f, tol_d, pixelsize.high, pixelsize.low);
 	mdg.Execute();
-	mdg.ReturnImage(m_WorkBits);
+	mdg.ReturnImage(WorkBits());
 
-	for (unsigned short j = 1; j < dim; j++)
-		m_Sliceprovide->TakeBack(bits[j]);
+	for (unsigned j = 1; j < dim; j++)
+		Recycle(bits[j]);
 	delete[] bits;
 
 	m_Mode2 = 2;
@@ -11988,7 +11030,7 @@ void Bmphandler::Em(short nrtissues, short dim, float** bits, float* weights, un
 	ExpectationMaximization em;
 	em.Init(m_Width, m_Height, nrtissues, dim, bits, weights);
 	em.MakeIter(iternr, converge);
-	em.Classify(m_WorkBits);
+	em.Classify(WorkBits());
 	m_Mode2 = 2;
 }
 
@@ -12025,25 +11067,26 @@ void Bmphandler::Cannylevelset(float* initlev, float f, float sigma, float thres
 		tmp[i] = 1.0f;
 
 	Levelset levset;
-	levset.Init(m_Height, m_Width, initlev, f, tmp, m_WorkBits, 0.0f, epsilon, stepsize);
+	levset.Init(m_Height, m_Width, initlev, f, tmp, WorkBits(), 0.0f, epsilon, stepsize);
 	levset.Iterate(nrsteps, reinitfreq);
-	levset.ReturnLevelset(m_WorkBits);
+	levset.ReturnLevelset(WorkBits());
 	//	SaveWorkBitmap("D:\\Development\\segmentation\\sample images\\testdump1.bmp");
 
 	float thresh[2];
 	thresh[0] = 1;
 	thresh[1] = 0;
 	//	threshold(thresh);
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; i++)
 	{
-		if (m_WorkBits[i] < 0)
+		if (work[i] < 0)
 			//			work_bits[i]=tmp[i];
-			m_WorkBits[i] = 0;
+			work[i] = 0;
 		else
 			//			work_bits[i]=256-tmp[i];
-			m_WorkBits[i] = 256;
+			work[i] = 256;
 	}
-	m_Sliceprovide->TakeBack(tmp);
+	Recycle(tmp);
 
 	m_Mode1 = dummymode;
 	m_Mode2 = 2;
@@ -12053,8 +11096,9 @@ void Bmphandler::Threshlevelset(float thresh_low, float thresh_high, float epsil
 {
 	float mean = (thresh_high + thresh_low) / 2;
 	float halfdiff = (thresh_high - thresh_low) / 2;
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Area; ++i)
-		m_WorkBits[i] = 1 - abs(m_BmpBits[i] - mean) / halfdiff;
+		work[i] = 1 - abs(m_BmpBits[i] - mean) / halfdiff;
 
 	Levelset levset;
 	Point pt;
@@ -12065,104 +11109,64 @@ void Bmphandler::Threshlevelset(float thresh_low, float thresh_high, float epsil
 	float* tmp = m_Sliceprovide->GiveMe();
 	for (unsigned i = 0; i < m_Area; i++)
 		tmp[i] = 0;
-	levset.Init(m_Height, m_Width, pt, m_WorkBits, tmp, 1.0f, epsilon, stepsize);
+	levset.Init(m_Height, m_Width, pt, work, tmp, 1.0f, epsilon, stepsize);
 	levset.Iterate(nrsteps, reinitfreq);
-	levset.ReturnLevelset(m_WorkBits);
+	levset.ReturnLevelset(work);
 	float thresh[2];
 	thresh[0] = 1;
 	thresh[1] = 0;
 	for (unsigned i = 0; i < m_Area; i++)
 	{
-		if (m_WorkBits[i] < 0)
+		if (work[i] < 0)
 			//			work_bits[i]=tmp[i];
-			m_WorkBits[i] = 0.0f;
+			work[i] = 0.0f;
 		else
 			//			work_bits[i]=256-tmp[i];
-			m_WorkBits[i] = 256.0f;
+			work[i] = 256.0f;
 	}
 
-	m_Sliceprovide->TakeBack(tmp);
+	Recycle(tmp);
 
 	m_Mode2 = 2;
 }
 
 unsigned Bmphandler::PushstackBmp()
 {
-	float* bits = m_Sliceprovide->GiveMe();
-
-	for (unsigned i = 0; i < m_Area; ++i)
-	{
-		bits[i] = m_BmpBits[i];
-	}
-
-	bits_stack.push_back(bits);
-	stackindex.push_back(stackcounter);
-	mode_stack.push_back(m_Mode1);
-
-	return stackcounter++;
+	return image_stack.Push(m_BmpBits, m_Area, m_Mode1);
 }
 
 unsigned Bmphandler::PushstackWork()
 {
-	float* bits = m_Sliceprovide->GiveMe();
-
-	for (unsigned i = 0; i < m_Area; ++i)
-	{
-		bits[i] = m_WorkBits[i];
-	}
-
-	bits_stack.push_back(bits);
-	stackindex.push_back(stackcounter);
-	mode_stack.push_back(m_Mode2);
-
-	return stackcounter++;
+	return image_stack.Push(ReadWork(), m_Area, m_Mode2);
 }
 
 bool Bmphandler::Savestack(unsigned i, const char* filename)
 {
-	std::list<float*>::iterator it = bits_stack.begin();
-	std::list<unsigned>::iterator it1 = stackindex.begin();
-	std::list<unsigned char>::iterator it2 = mode_stack.begin();
-	while (it != bits_stack.end() && (*it1) != i)
-	{
-		it++;
-		it1++;
-		it2++;
-	}
-	if (it != bits_stack.end())
-	{
-		FILE* fp = fopen(filename, "wb");
-		if (fp == nullptr)
-			return false;
-		if (fwrite(&m_Width, 1, sizeof(short unsigned), fp) <
-				sizeof(short unsigned))
-		{
-			fclose(fp);
-			return false;
-		}
-		if (fwrite(&m_Height, 1, sizeof(short unsigned), fp) <
-				sizeof(short unsigned))
-		{
-			fclose(fp);
-			return false;
-		}
-		unsigned int bitsize = m_Width * (unsigned)m_Height * sizeof(float);
-		if (fwrite(*it, 1, bitsize, fp) < bitsize)
-		{
-			fclose(fp);
-			return false;
-		}
-		if (fwrite(&(*it2), 1, sizeof(unsigned char), fp) <
-				sizeof(unsigned char))
-		{
-			fclose(fp);
-			return false;
-		}
-		fclose(fp);
-		return true;
-	}
+	std::vector<float> bits(m_Area, 0.f);
+	unsigned char mode = 0;
+	if (!image_stack.Get(i, bits.data(), mode))
+		return false;
 
-	return false;
+	FILE* fp = fopen(filename, "wb");
+	if (fp == nullptr)
+		return false;
+
+	// a zero size marks the compressed format, which also supports slices larger than 65535
+	// compressed without Blosc, such that the file can be loaded by any build
+	auto data = ImageStack::Compress(bits.data(), m_Area, false);
+	unsigned short const marker16 = 0;
+	unsigned const version = 1;
+	std::uint64_t const datasize = data.size();
+	bool ok = fwrite(&marker16, sizeof(unsigned short), 1, fp) == 1 &&
+						fwrite(&marker16, sizeof(unsigned short), 1, fp) == 1 &&
+						fwrite(&version, sizeof(unsigned), 1, fp) == 1 &&
+						fwrite(&m_Width, sizeof(unsigned), 1, fp) == 1 &&
+						fwrite(&m_Height, sizeof(unsigned), 1, fp) == 1 &&
+						fwrite(&mode, sizeof(unsigned char), 1, fp) == 1 &&
+						fwrite(&datasize, sizeof(std::uint64_t), 1, fp) == 1 &&
+						fwrite(data.data(), 1, data.size(), fp) == data.size();
+	fclose(fp);
+	return ok;
 }
 
 unsigned Bmphandler::Loadstack(const char* filename)
@@ -12171,269 +11175,146 @@ unsigned Bmphandler::Loadstack(const char* filename)
 	if (fp == nullptr)
 		return 123456;
 
-	short unsigned width1, height1;
-	if (fread(&width1, 1, sizeof(short unsigned), fp) <
-					sizeof(short unsigned) ||
-			width1 != m_Width)
-	{
-		fclose(fp);
-		return 123456;
-	}
-	if (fread(&height1, 1, sizeof(short unsigned), fp) <
-					sizeof(short unsigned) ||
-			height1 != m_Height)
+	short unsigned width1 = 0, height1 = 0;
+	if (fread(&width1, 1, sizeof(short unsigned), fp) < sizeof(short unsigned) ||
+			fread(&height1, 1, sizeof(short unsigned), fp) < sizeof(short unsigned))
 	{
 		fclose(fp);
 		return 123456;
 	}
-	unsigned int bitsize = m_Width * (unsigned)m_Height * sizeof(float);
-	float* bits = m_Sliceprovide->GiveMe();
-	if (fread(bits, 1, bitsize, fp) < bitsize)
+
+	std::vector<float> bits(m_Area, 0.f);
+	unsigned char mode1 = 0;
+	if (width1 == 0 && height1 == 0)
 	{
-		fclose(fp);
-		return 123456;
+		unsigned version = 0, width = 0, height = 0;
+		std::uint64_t datasize = 0;
+		if (fread(&version, sizeof(unsigned), 1, fp) != 1 || version != 1 ||
+				fread(&width, sizeof(unsigned), 1, fp) != 1 || width != m_Width ||
+				fread(&height, sizeof(unsigned), 1, fp) != 1 || height != m_Height ||
+				fread(&mode1, sizeof(unsigned char), 1, fp) != 1 ||
+				fread(&datasize, sizeof(std::uint64_t), 1, fp) != 1)
+		{
+			fclose(fp);
+			return 123456;
+		}
+		std::vector<char> data(datasize);
+		if (fread(data.data(), 1, data.size(), fp) < data.size() ||
+				!ImageStack::Decompress(data.data(), data.size(), bits.data(), m_Area))
+		{
+			fclose(fp);
+			return 123456;
+		}
 	}
-	unsigned char mode1;
-	if (fread(&mode1, 1, sizeof(unsigned char), fp) < sizeof(unsigned char))
+	else
 	{
-		fclose(fp);
-		return 123456;
+		size_t bitsize = m_Area * sizeof(float);
+		if (width1 != m_Width || height1 != m_Height ||
+				fread(bits.data(), 1, bitsize, fp) < bitsize ||
+				fread(&mode1, 1, sizeof(unsigned char), fp) < sizeof(unsigned char))
+		{
+			fclose(fp);
+			return 123456;
+		}
 	}
 
-	bits_stack.push_back(bits);
-	stackindex.push_back(stackcounter);
-	mode_stack.push_back(mode1);
-
 	fclose(fp);
-	return stackcounter++;
+	return image_stack.Push(bits.data(), m_Area, mode1);
 }
 
-unsigned Bmphandler::PushstackTissue(tissuelayers_size_t idx, tissues_size_t tissuenr)
+void Bmphandler::TissueMask(tissuelayers_size_t idx, tissues_size_t tissuenr, float* bits) const
 {
-	float* bits = m_Sliceprovide->GiveMe();
-
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	const tissues_size_t* tissues = TissueLayer(idx);
 	for (unsigned i = 0; i < m_Area; ++i)
 	{
-		if (tissues[i] == tissuenr)
-			bits[i] = 255.0;
-		else
-			bits[i] = 0;
+		bits[i] = (tissues[i] == tissuenr) ? 255.0f : 0.0f;
 	}
+}
 
-	bits_stack.push_back(bits);
-	stackindex.push_back(stackcounter);
-	mode_stack.push_back(2);
-
-	return stackcounter++;
+unsigned Bmphandler::PushstackTissue(tissuelayers_size_t idx, tissues_size_t tissuenr)
+{
+	std::vector<float> bits(m_Area);
+	TissueMask(idx, tissuenr, bits.data());
+	return image_stack.Push(bits.data(), m_Area, 2);
 }
 
 unsigned Bmphandler::PushstackHelp()
 {
-	float* bits = m_Sliceprovide->GiveMe();
-
-	for (unsigned i = 0; i < m_Area; ++i)
-	{
-		bits[i] = m_HelpBits[i];
-	}
-
-	bits_stack.push_back(bits);
-	stackindex.push_back(stackcounter);
-	mode_stack.push_back(0);
-
-	return stackcounter++;
+	return image_stack.Push(HelpBits(), m_Area, 0);
 }
 
 void Bmphandler::Removestack(unsigned i)
 {
-	/*	if(i<bits_stack.size()){
-		std::list<float *>::iterator it=bits_stack.begin();
-		std::list<unsigned>::iterator it1=stackindex.begin();
-		while(i>0) {it++; it1++; i--;}
-		bits_stack.erase(it);
-		stackindex.erase(it1);
-	}*/
-
-	std::list<float*>::iterator it = bits_stack.begin();
-	std::list<unsigned>::iterator it1 = stackindex.begin();
-	std::list<unsigned char>::iterator it2 = mode_stack.begin();
-	while (it != bits_stack.end() && (*it1) != i)
-	{
-		it++;
-		it1++;
-		it2++;
-	}
-	if (it != bits_stack.end())
-	{
-		m_Sliceprovide->TakeBack(*it);
-		bits_stack.erase(it);
-		stackindex.erase(it1);
-		mode_stack.erase(it2);
-	}
+	image_stack.Remove(i);
 }
 
 void Bmphandler::GetstackBmp(unsigned i)
 {
-	//	sliceprovide->take_back(bmp_bits);
-
-	std::list<float*>::iterator it = bits_stack.begin();
-	std::list<unsigned>::iterator it1 = stackindex.begin();
-	std::list<unsigned char>::iterator it2 = mode_stack.begin();
-
-	while (it != bits_stack.end() && (*it1) != i)
-	{
-		it++;
-		it1++;
-		it2++;
-	}
-	if (it != bits_stack.end())
-	{
-		//		bmp_bits=*it;
-		for (unsigned i = 0; i < m_Area; i++)
-			m_BmpBits[i] = (*it)[i];
-	}
-
-	m_Mode1 = (*it2);
+	image_stack.Get(i, m_BmpBits, m_Mode1);
 }
 
 void Bmphandler::GetstackWork(unsigned i)
 {
-	std::list<float*>::iterator it = bits_stack.begin();
-	std::list<unsigned>::iterator it1 = stackindex.begin();
-	std::list<unsigned char>::iterator it2 = mode_stack.begin();
-
-	while (it != bits_stack.end() && (*it1) != i)
-	{
-		it++;
-		it1++;
-		it2++;
-	}
-	if (it != bits_stack.end())
-	{
-		//		work_bits=*it;
-		for (unsigned i = 0; i < m_Area; i++)
-			m_WorkBits[i] = (*it)[i];
-	}
-
-	m_Mode2 = (*it2);
+	image_stack.Get(i, WorkBits(), m_Mode2);
 }
 
 void Bmphandler::GetstackTissue(tissuelayers_size_t idx, unsigned i, tissues_size_t tissuenr, bool override)
 {
-	//	sliceprovide->take_back(work_bits);
-
-	std::list<float*>::iterator it = bits_stack.begin();
-	std::list<unsigned>::iterator it1 = stackindex.begin();
-	std::list<unsigned char>::iterator it2 = mode_stack.begin();
+	std::vector<float> bits(m_Area);
+	unsigned char mode;
+	if (!image_stack.Get(i, bits.data(), mode))
+		return;
 
-	while (it != bits_stack.end() && (*it1) != i)
-	{
-		it++;
-		it1++;
-		it2++;
-	}
-	tissues_size_t* tissues = m_Tissuelayers[idx];
-	if (it != bits_stack.end())
+	tissues_size_t* tissues = TissueLayer(idx);
+	if (override)
 	{
-		if (override)
+		for (unsigned i = 0; i < m_Area; i++)
 		{
-			for (unsigned i = 0; i < m_Area; i++)
-			{
-				if (((*it)[i] != 0) &&
-						(!TissueInfos::GetTissueLocked(tissues[i])))
-					tissues[i] = tissuenr;
-			}
+			if ((bits[i] != 0) &&
+					(!TissueInfos::GetTissueLocked(tissues[i])))
+				tissues[i] = tissuenr;
 		}
-		else
+	}
+	else
+	{
+		for (unsigned i = 0; i < m_Area; i++)
 		{
-			for (unsigned i = 0; i < m_Area; i++)
-			{
-				if (((*it)[i] != 0) && (tissues[i] == 0))
-					tissues[i] = tissuenr;
-			}
+			if ((bits[i] != 0) && (tissues[i] == 0))
+				tissues[i] = tissuenr;
 		}
 	}
 }
 
 void Bmphandler::GetstackHelp(unsigned i)
 {
-	//	sliceprovide->take_back(help_bits);
-
-	std::list<float*>::iterator it = bits_stack.begin();
-	std::list<unsigned>::iterator it1 = stackindex.begin();
-
-	while (it != bits_stack.end() && (*it1) != i)
-	{
-		it++;
-		it1++;
-	}
-	if (it != bits_stack.end())
-	{
-		//		help_bits=*it;
-		for (unsigned i = 0; i < m_Area; i++)
-			m_HelpBits[i] = (*it)[i];
-	}
+	unsigned char mode;
+	image_stack.Get(i, HelpBits(), mode);
 }
 
-float* Bmphandler::Getstack(unsigned i, unsigned char& mode)
+bool Bmphandler::Getstack(unsigned i, float* bits, unsigned char& mode) const
 {
-	std::list<float*>::iterator it = bits_stack.begin();
-	std::list<unsigned>::iterator it1 = stackindex.begin();
-	std::list<unsigned char>::iterator it2 = mode_stack.begin();
-
-	while (it != bits_stack.end() && (*it1) != i)
-	{
-		it++;
-		it1++;
-		it2++;
-	}
-
-	if (it != bits_stack.end())
-	{
-		mode = *it2;
-		return *it;
-	}
-	else
-	{
-		return nullptr;
-	}
+	return image_stack.Get(i, bits, mode);
 }
 
 void Bmphandler::PopstackBmp()
 {
-	if (!bits_stack.empty())
-	{
-		m_Sliceprovide->TakeBack(m_BmpBits);
-		m_BmpBits = bits_stack.back();
-		m_Mode1 = mode_stack.back();
-		bits_stack.pop_back();
-		stackindex.pop_back();
-		mode_stack.pop_back();
-	}
+	image_stack.Pop(m_BmpBits, m_Mode1);
 }
 
 void Bmphandler::PopstackWork()
 {
-	if (!bits_stack.empty())
+	if (!image_stack.Empty())
 	{
-		m_Sliceprovide->TakeBack(m_WorkBits);
-		m_WorkBits = bits_stack.back();
-		m_Mode2 = mode_stack.back();
-		bits_stack.pop_back();
-		stackindex.pop_back();
-		mode_stack.pop_back();
+		image_stack.Pop(WorkBits(), m_Mode2);
 	}
 }
 
 void Bmphandler::PopstackHelp()
 {
-	if (!bits_stack.empty())
+	unsigned char mode;
+	if (!image_stack.Empty())
 	{
-		m_Sliceprovide->TakeBack(m_HelpBits);
-		m_HelpBits = bits_stack.back();
-		bits_stack.pop_back();
-		stackindex.pop_back();
-		mode_stack.pop_back();
+		image_stack.Pop(HelpBits(), mode);
 	}
 }
 
@@ -12441,13 +11322,13 @@ bool Bmphandler::Isloaded() const { return m_Loaded; }
 
 void Bmphandler::ClearTissue(tissuelayers_size_t idx)
 {
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	std::fill(tissues, tissues + m_Area, 0);
 }
 
 bool Bmphandler::HasTissue(tissuelayers_size_t idx, tissues_size_t tissuetype)
 {
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
 		if (tissues[i] == tissuetype)
@@ -12460,11 +11341,12 @@ bool Bmphandler::HasTissue(tissuelayers_size_t idx, tissues_size_t tissuetype)
 
 void Bmphandler::Add2tissue(tissuelayers_size_t idx, tissues_size_t tissuetype, float f, bool override)
 {
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
+	float* work = WorkBits();
 	if (override)
 	{
 		for (unsigned int i = 0; i < m_Area; i++)
-			if (m_WorkBits[i] == f &&
+			if (work[i] == f &&
 					TissueInfos::GetTissueLocked(tissues[i]) == false)
 			{
 				tissues[i] = tissuetype;
@@ -12473,7 +11355,7 @@ void Bmphandler::Add2tissue(tissuelayers_size_t idx, tissues_size_t tissuetype,
 	else
 	{
 		for (unsigned int i = 0; i < m_Area; i++)
-			if (m_WorkBits[i] == f && tissues[i] == 0)
+			if (work[i] == f && tissues[i] == 0)
 			{
 				tissues[i] = tissuetype;
 			}
@@ -12483,7 +11365,7 @@ void Bmphandler::Add2tissue(tissuelayers_size_t idx, tissues_size_t tissuetype,
 
 void Bmphandler::Add2tissue(tissuelayers_size_t idx, tissues_size_t tissuetype, bool* mask, bool override)
 {
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	if (override)
 	{
 		for (unsigned int i = 0; i < m_Area; i++)
@@ -12506,17 +11388,18 @@ void Bmphandler::Add2tissue(tissuelayers_size_t idx, tissues_size_t tissuetype,
 void Bmphandler::Add2tissueConnected(tissuelayers_size_t idx, tissues_size_t tissuetype, Point p, bool override)
 {
 	unsigned position = Pt2coord(p);
-	float f = m_WorkBits[position];
+	float* work = WorkBits();
+	float f = work[position];
 	float* results = (float*)malloc(sizeof(float) * (m_Area + 2 * m_Width + 2 * m_Height + 4));
 
 	int i = m_Width + 3;
 	int i1 = 0;
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			if (m_WorkBits[i1] == f && (tissues[i1] == 0 || (override && !TissueInfos::GetTissueLocked(tissues[i1]))))
+			if (work[i1] == f && (tissues[i1] == 0 || (override && !TissueInfos::GetTissueLocked(tissues[i1]))))
 				results[i] = -1;
 			else
 				results[i] = 0;
@@ -12587,17 +11470,18 @@ void Bmphandler::Add2tissueConnected(tissuelayers_size_t idx, tissues_size_t tis
 void Bmphandler::Add2tissue(tissuelayers_size_t idx, tissues_size_t tissuetype, Point p, bool override)
 {
 	float f = WorkPt(p);
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
+	float* work = WorkBits();
 	if (override)
 	{
 		for (unsigned int i = 0; i < m_Area; i++)
-			if (m_WorkBits[i] == f && !TissueInfos::GetTissueLocked(tissues[i]))
+			if (work[i] == f && !TissueInfos::GetTissueLocked(tissues[i]))
 				tissues[i] = tissuetype;
 	}
 	else
 	{
 		for (unsigned int i = 0; i < m_Area; i++)
-			if (m_WorkBits[i] == f && tissues[i] == 0)
+			if (work[i] == f && tissues[i] == 0)
 				tissues[i] = tissuetype;
 	}
 }
@@ -12605,9 +11489,10 @@ void Bmphandler::Add2tissue(tissuelayers_size_t idx, tissues_size_t tissuetype,
 void Bmphandler::Add2tissueThresh(tissuelayers_size_t idx, tissues_size_t tissuetype, Point p)
 {
 	float f = WorkPt(p);
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		if (m_WorkBits[i] >= f)
+		if (work[i] >= f)
 			tissues[i] = tissuetype;
 }
 
@@ -12622,17 +11507,18 @@ void Bmphandler::SubtractTissueConnected(tissuelayers_size_t idx, tissues_size_t
 	unsigned position = Pt2coord(p);
 	std::vector<int> s;
 
-	float f = m_WorkBits[position];
+	float* work = WorkBits();
+	float f = work[position];
 	float* results = (float*)malloc(sizeof(float) * (m_Area + 2 * m_Width + 2 * m_Height + 4));
 
 	int i = m_Width + 3;
 	int i1 = 0;
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			if (m_WorkBits[i1] == f && tissues[i1] == tissuetype)
+			if (work[i1] == f && tissues[i1] == tissuetype)
 				results[i] = -1;
 			else
 				results[i] = 0;
@@ -12701,9 +11587,10 @@ void Bmphandler::SubtractTissueConnected(tissuelayers_size_t idx, tissues_size_t
 
 void Bmphandler::SubtractTissue(tissuelayers_size_t idx, tissues_size_t tissuetype, float f)
 {
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
-		if (m_WorkBits[i] == f && tissues[i] == tissuetype)
+		if (work[i] == f && tissues[i] == tissuetype)
 			tissues[i] = 0;
 }
 
@@ -12712,7 +11599,8 @@ void Bmphandler::Change2maskConnectedwork(bool* mask, Point p, bool addorsub)
 	unsigned position = Pt2coord(p);
 	std::vector<int> s;
 
-	float f = m_WorkBits[position];
+	float* work = WorkBits();
+	float f = work[position];
 	float* results = (float*)malloc(sizeof(float) * (m_Area + 2 * m_Width + 2 * m_Height + 4));
 
 	int i = m_Width + 3;
@@ -12721,7 +11609,7 @@ void Bmphandler::Change2maskConnectedwork(bool* mask, Point p, bool addorsub)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			if (m_WorkBits[i1] == f)
+			if (work[i1] == f)
 				results[i] = -1;
 			else
 				results[i] = 0;
@@ -12793,7 +11681,7 @@ void Bmphandler::Change2maskConnectedtissue(tissuelayers_size_t idx, bool* mask,
 	unsigned position = Pt2coord(p);
 	std::vector<int> s;
 
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	tissues_size_t f = tissues[position];
 	float* results = (float*)malloc(sizeof(float) * (m_Area + 2 * m_Width + 2 * m_Height + 4));
 
@@ -12872,10 +11760,11 @@ void Bmphandler::Change2maskConnectedtissue(tissuelayers_size_t idx, bool* mask,
 
 void Bmphandler::Tissue2work(tissuelayers_size_t idx, const std::vector<float>& mask)
 {
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = mask.at(tissues[i]);
+		work[i] = mask.at(tissues[i]);
 	}
 
 	m_Mode2 = 2;
@@ -12883,10 +11772,11 @@ void Bmphandler::Tissue2work(tissuelayers_size_t idx, const std::vector<float>&
 
 void Bmphandler::Tissue2work(tissuelayers_size_t idx)
 {
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
-		m_WorkBits[i] = (float)tissues[i];
+		work[i] = (float)tissues[i];
 	}
 
 	m_Mode2 = 2;
@@ -12894,7 +11784,7 @@ void Bmphandler::Tissue2work(tissuelayers_size_t idx)
 
 void Bmphandler::Cleartissue(tissuelayers_size_t idx, tissues_size_t tissuetype)
 {
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
 		if (tissues[i] == tissuetype)
@@ -12906,7 +11796,7 @@ void Bmphandler::CapTissue(tissues_size_t maxval)
 {
 	for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
 	{
-		tissues_size_t* tissues = m_Tissuelayers[idx];
+		tissues_size_t* tissues = TissueLayer(idx);
 		for (unsigned int i = 0; i < m_Area; i++)
 		{
 			if (tissues[i] > maxval)
@@ -12917,7 +11807,7 @@ void Bmphandler::CapTissue(tissues_size_t maxval)
 
 void Bmphandler::Cleartissues(tissuelayers_size_t idx)
 {
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
 		tissues[i] = 0;
@@ -12928,7 +11818,7 @@ void Bmphandler::Cleartissuesall()
 {
 	for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
 	{
-		tissues_size_t* tissues = m_Tissuelayers[idx];
+		tissues_size_t* tissues = TissueLayer(idx);
 		for (unsigned int i = 0; i < m_Area; i++)
 		{
 			tissues[i] = 0;
@@ -12938,16 +11828,17 @@ void Bmphandler::Cleartissuesall()
 
 void Bmphandler::Erasework(bool* mask)
 {
+	float* work = WorkBits();
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
 		if (mask[i])
-			m_WorkBits[i] = 0;
+			work[i] = 0;
 	}
 }
 
 void Bmphandler::Erasetissue(tissuelayers_size_t idx, bool* mask)
 {
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (unsigned int i = 0; i < m_Area; i++)
 	{
 		if (mask[i] && (!TissueInfos::GetTissueLocked(tissues[i])))
@@ -12965,11 +11856,12 @@ void Bmphandler::Floodwork(bool* mask)
 
 	int i = m_Width + 3;
 	int i1 = 0;
+	float* work = WorkBits();
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			values[i] = m_WorkBits[i1];
+			values[i] = work[i1];
 			bigmask[i] = mask[i1];
 			i++;
 			i1++;
@@ -13054,7 +11946,7 @@ void Bmphandler::Floodwork(bool* mask)
 		for (int k = 0; k < m_Width; k++)
 		{
 			if (mask[i2])
-				m_WorkBits[i2] = values[i];
+				work[i2] = values[i];
 			i++;
 			i2++;
 		}
@@ -13075,7 +11967,7 @@ void Bmphandler::Floodtissue(tissuelayers_size_t idx, bool* mask)
 
 	int i = m_Width + 3;
 	int i1 = 0;
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
@@ -13191,7 +12083,7 @@ void Bmphandler::CorrectOutline(float f, std::vector<Point>* newline)
 	vv_pouter.insert(vv_pouter.end(), vv_pinner.begin(), vv_pinner.end());
 
 	ImageForestingTransformDistance if_tdist;
-	if_tdist.DistanceInit(m_Width, m_Height, f, m_WorkBits);
+	if_tdist.DistanceInit(m_Width, m_Height, f, WorkBits());
 	if_tdist.ReturnPath(*(newline->begin()), &limit1);
 
 	it = newline->end();
@@ -13287,7 +12179,8 @@ void Bmphandler::CorrectOutline(float f, std::vector<Point>* newline)
 			Point p;
 			bool in, in1;
 			it = newline->begin();
-			in = (m_WorkBits[unsigned(m_Width) * it->py + it->px] == f);
+			float* work = WorkBits();
+			in = (work[unsigned(m_Width) * it->py + it->px] == f);
 			in1 = !in;
 			itold = it;
 			it++;
@@ -13296,7 +12189,7 @@ void Bmphandler::CorrectOutline(float f, std::vector<Point>* newline)
 
 			while (it != newline->end())
 			{
-				if ((m_WorkBits[unsigned(m_Width) * it->py + it->px] == f) != in)
+				if ((work[unsigned(m_Width) * it->py + it->px] == f) != in)
 				{
 					if (in)
 					{
@@ -13336,14 +12229,15 @@ void Bmphandler::CorrectOutline(float f, std::vector<Point>* newline)
 			change_pts.push_back(p);
 			change_pts.push_back(p);
 
-			float* bkp = m_WorkBits;
+			float* bkp = WorkBits();
 			m_WorkBits = m_Sliceprovide->GiveMe();
 
 			FillContour(&oldline, true);
+			work = WorkBits();
 
 			for (unsigned i = 0; i < m_Area; i++)
 			{
-				if (m_WorkBits[i] == 255.0f)
+				if (work[i] == 255.0f)
 				{
 					if (bkp[i] == f)
 						bkp[i] = 0.0;
@@ -13483,7 +12377,7 @@ void Bmphandler::CorrectOutline(float f, std::vector<Point>* newline)
 
 			//			fclose(fp3);
 
-			m_Sliceprovide->TakeBack(m_WorkBits);
+			Recycle(m_WorkBits);
 			m_WorkBits = bkp;
 		}
 	}
@@ -13499,9 +12393,10 @@ void Bmphandler::CorrectOutlinetissue(tissuelayers_size_t idx, tissues_size_t f1
 	float f = float(f1);
 
 	PushstackWork();
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
+	float* work = WorkBits();
 	for (unsigned ineu = 0; ineu < m_Area; ineu++)
-		m_WorkBits[ineu] = (float)tissues[ineu];
+		work[ineu] = (float)tissues[ineu];
 
 	std::vector<std::vector<Point>> vv_pouter, vv_pinner;
 	std::vector<Point> limit1, limit2;
@@ -13513,7 +12408,7 @@ void Bmphandler::CorrectOutlinetissue(tissuelayers_size_t idx, tissues_size_t f1
 	vv_pouter.insert(vv_pouter.end(), vv_pinner.begin(), vv_pinner.end());
 
 	ImageForestingTransformDistance if_tdist;
-	if_tdist.DistanceInit(m_Width, m_Height, f, m_WorkBits);
+	if_tdist.DistanceInit(m_Width, m_Height, f, WorkBits());
 	// BL here I think we get closest connection from start/end point
 	// to contour of selected tissue 'f'.
 	if_tdist.ReturnPath(newline->front(), &limit1);
@@ -13600,14 +12495,15 @@ void Bmphandler::CorrectOutlinetissue(tissuelayers_size_t idx, tissues_size_t f1
 			Point p;
 			bool in, in1;
 			it = newline->begin();
-			in = (m_WorkBits[unsigned(m_Width) * it->py + it->px] == f);
+			work = WorkBits();
+			in = (work[unsigned(m_Width) * it->py + it->px] == f);
 			in1 = !in;
 			itold = it;
 			it++;
 
 			while (it != newline->end())
 			{
-				if ((m_WorkBits[unsigned(m_Width) * it->py + it->px] == f) != in)
+				if ((work[unsigned(m_Width) * it->py + it->px] == f) != in)
 				{
 					if (in)
 					{
@@ -13636,14 +12532,15 @@ void Bmphandler::CorrectOutlinetissue(tissuelayers_size_t idx, tissues_size_t f1
 			change_pts.push_back(p);
 			change_pts.push_back(p);
 
-			float* bkp = m_WorkBits;
+			float* bkp = WorkBits();
 			m_WorkBits = m_Sliceprovide->GiveMe();
 
 			FillContour(&oldline, true);
+			work = WorkBits();
 
 			for (unsigned i = 0; i < m_Area; i++)
 			{
-				if (m_WorkBits[i] == 255.0f)
+				if (work[i] == 255.0f)
 				{
 					if (bkp[i] == f)
 						bkp[i] = 0.0;
@@ -13773,14 +12670,15 @@ void Bmphandler::CorrectOutlinetissue(tissuelayers_size_t idx, tissues_size_t f1
 				}
 			}
 
-			m_Sliceprovide->TakeBack(m_WorkBits);
+			Recycle(m_WorkBits);
 			m_WorkBits = bkp;
 		}
 	}
 
 	// copy temporary 'work' image to tissues
+	work = WorkBits();
 	for (unsigned ineu = 0; ineu < m_Area; ineu++)
-		tissues[ineu] = (tissues_size_t)(m_WorkBits[ineu] + 0.1f);
+		tissues[ineu] = (tissues_size_t)(work[ineu] + 0.1f);
 
 	PopstackWork();
 
@@ -13791,7 +12689,7 @@ void Bmphandler::CorrectOutlinetissue(tissuelayers_size_t idx, tissues_size_t f1
 template<typename T, typename F>
 void Bmphandler::Brush(T* data, T f, Point p, int radius, bool draw, T f1, F is_locked)
 {
-	unsigned short dist = radius * radius;
+	unsigned dist = radius * radius;
 
 	int xmin, xmax, ymin, ymax, d;
 	if (p.px < radius)
@@ -13864,22 +12762,22 @@ void Bmphandler::Brush(T* data, T f, Point p, float const radius, float dx, floa
 
 void Bmphandler::Brush(float f, Point p, int radius, bool draw)
 {
-	Brush(m_WorkBits, f, p, radius, draw, 0.f, [](float v) { return false; });
+	Brush(WorkBits(), f, p, radius, draw, 0.f, [](float v) { return false; });
 }
 
 void Bmphandler::Brush(float f, Point p, float radius, float dx, float dy, bool draw)
 {
-	Brush(m_WorkBits, f, p, radius, dx, dy, draw, 0.f, [](float v) { return false; });
+	Brush(WorkBits(), f, p, radius, dx, dy, draw, 0.f, [](float v) { return false; });
 }
 
 void Bmphandler::Brushtissue(tissuelayers_size_t idx, tissues_size_t f, Point p, int radius, bool draw, tissues_size_t f1)
 {
-	Brush(m_Tissuelayers[idx], f, p, radius, draw, f1, [](tissues_size_t v) { return TissueInfos::GetTissueLocked(v); });
+	Brush(TissueLayer(idx), f, p, radius, draw, f1, [](tissues_size_t v) { return TissueInfos::GetTissueLocked(v); });
 }
 
 void Bmphandler::Brushtissue(tissuelayers_size_t idx, tissues_size_t f, Point p, float radius, float dx, float dy, bool draw, tissues_size_t f1)
 {
-	Brush(m_Tissuelayers[idx], f, p, radius, dx, dy, draw, f1, [](tissues_size_t v) { return TissueInfos::GetTissueLocked(v); });
+	Brush(TissueLayer(idx), f, p, radius, dx, dy, draw, f1, [](tissues_size_t v) { return TissueInfos::GetTissueLocked(v); });
 }
 
 void Bmphandler::FillHoles(float f, int minsize)
@@ -13911,11 +12809,12 @@ void Bmphandler::FillHoles(float f, int minsize)
 	float dx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
 	float bordervolume[8] = {1, 0.75f, 0.5f, 0.25f, 2, 1.75f, 1.5f, 1.25f};
 
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Height; i++)
 	{
 		for (unsigned j = 0; j < m_Width; j++)
 		{
-			tmp_bits[pos] = m_WorkBits[pos1];
+			tmp_bits[pos] = work[pos1];
 			pos++;
 			pos1++;
 		}
@@ -14111,7 +13010,7 @@ void Bmphandler::FillHoles(float f, int minsize)
 		for (int k = 0; k < m_Width; k++)
 		{
 			if (tmp_bits[i4] == 0)
-				m_WorkBits[i2] = f;
+				work[i2] = f;
 			//			work_bits[i2]=tmp_bits[i4];
 			i4++;
 			i2++;
@@ -14151,7 +13050,7 @@ void Bmphandler::FillHolestissue(tissuelayers_size_t idx, tissues_size_t f, int
 	float dx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
 	float bordervolume[8] = {1, 0.75f, 0.5f, 0.25f, 2, 1.75f, 1.5f, 1.25f};
 
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (unsigned i = 0; i < m_Height; i++)
 	{
 		for (unsigned j = 0; j < m_Width; j++)
@@ -14433,11 +13332,12 @@ void Bmphandler::RemoveIslands(float f, int minsize)
 	float dx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
 	float bordervolume[8] = {1, 0.75f, 0.5f, 0.25f, 2, 1.75f, 1.5f, 1.25f};
 
+	float* work = WorkBits();
 	for (unsigned i = 0; i < m_Height; i++)
 	{
 		for (unsigned j = 0; j < m_Width; j++)
 		{
-			tmp_bits[pos] = m_WorkBits[pos1];
+			tmp_bits[pos] = work[pos1];
 			pos++;
 			pos1++;
 		}
@@ -14651,7 +13551,7 @@ void Bmphandler::RemoveIslands(float f, int minsize)
 		for (int k = 0; k < m_Width; k++)
 		{
 			if (tmp_bits[i4] == 0)
-				m_WorkBits[i2] = 0;
+				work[i2] = 0;
 			//			work_bits[i2]=tmp_bits[i4];
 			i4++;
 			i2++;
@@ -14664,7 +13564,7 @@ void Bmphandler::RemoveIslands(float f, int minsize)
 	{
 		for (std::vector<Point>::iterator it = it1->begin(); it != it1->end(); it++)
 		{
-			m_WorkBits[it->px + it->py * m_Width] = 0;
+			work[it->px + it->py * m_Width] = 0;
 		}
 	}
 
@@ -14699,7 +13599,7 @@ void Bmphandler::RemoveIslandstissue(tissuelayers_size_t idx, tissues_size_t f,
 	float dx[8] = {1, 1, 0, -1, -1, -1, 0, 1};
 	float bordervolume[8] = {1, 0.75f, 0.5f, 0.25f, 2, 1.75f, 1.5f, 1.25f};
 
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (unsigned i = 0; i < m_Height; i++)
 	{
 		for (unsigned j = 0; j < m_Width; j++)
@@ -14965,7 +13865,7 @@ void Bmphandler::RemoveIslandstissue(tissuelayers_size_t idx, tissues_size_t f,
 
 /*void Bmphandler::add_skin(unsigned i)
 {
-	unsigned short x,y;
+	unsigned x,y;
 	unsigned pos;
 	unsigned i1;
 	unsigned w=(unsigned)width;
@@ -15184,7 +14084,7 @@ void Bmphandler::MapTissueIndices(const std::vector<tissues_size_t>& indexMap)
 {
 	for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
 	{
-		tissues_size_t* tissues = m_Tissuelayers[idx];
+		tissues_size_t* tissues = TissueLayer(idx);
 		for (unsigned int i = 0; i < m_Area; ++i)
 		{
 			tissues[i] = indexMap[tissues[i]];
@@ -15196,7 +14096,7 @@ void Bmphandler::RemoveTissue(tissues_size_t tissuenr)
 {
 	for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
 	{
-		tissues_size_t* tissues = m_Tissuelayers[idx];
+		tissues_size_t* tissues = TissueLayer(idx);
 		for (unsigned int i = 0; i < m_Area; ++i)
 		{
 			if (tissues[i] > tissuenr)
@@ -15221,7 +14121,7 @@ void Bmphandler::GroupTissues(tissuelayers_size_t idx, std::vector<tissues_size_
 	for (unsigned int i = 0; i < count; i++)
 		crossref[olds[i]] = news[i];
 
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (unsigned int j = 0; j < m_Area; j++)
 	{
 		tissues[j] = crossref[tissues[j]];
@@ -15244,54 +14144,6 @@ void Bmphandler::SetMode(unsigned char mode, bool bmporwork)
 		m_Mode2 = mode;
 }
 
-bool Bmphandler::PrintAmasciiSlice(tissuelayers_size_t idx, std::ofstream& streamname)
-{
-	tissues_size_t* tissues = m_Tissuelayers[idx];
-	for (unsigned i = 0; i < m_Area; i++)
-	{
-		streamname << (int)tissues[i] << " " << std::endl;
-	}
-	return true;
-}
-
-bool Bmphandler::PrintVtkasciiSlice(tissuelayers_size_t idx, std::ofstream& streamname)
-{
-	tissues_size_t* tissues = m_Tissuelayers[idx];
-	for (unsigned i = 0; i < m_Area; i++)
-	{
-		streamname << (int)tissues[i] << " ";
-	}
-	streamname << std::endl;
-	return true;
-}
-
-bool Bmphandler::PrintVtkbinarySlice(tissuelayers_size_t idx, std::ofstream& streamname)
-{
-	tissues_size_t* tissues = m_Tissuelayers[idx];
-	if (TissueInfos::GetTissueCount() <= 255)
-	{
-		if (sizeof(tissues_size_t) == sizeof(unsigned char))
-		{
-			streamname.write((char*)(tissues), m_Area);
-		}
-		else
-		{
-			unsigned char* uchar_buffer = new unsigned char[m_Area];
-			for (unsigned int i = 0; i < m_Area; i++)
-			{
-				uchar_buffer[i] = (unsigned char)tissues[i];
-			}
-			streamname.write((char*)(uchar_buffer), m_Area);
-			delete[] uchar_buffer;
-		}
-	}
-	else
-	{
-		streamname.write((char*)(tissues), sizeof(tissues_size_t) * m_Area);
-	}
-	return true;
-}
-
 void Bmphandler::Shifttissue()
 {
 	int x, y;
@@ -15307,7 +14159,7 @@ void Bmphandler::Shifttissue()
 		long offset = (long)m_Width * y + x;
 		for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
 		{
-			tissues_size_t* tissues = m_Tissuelayers[idx];
+			tissues_size_t* tissues = TissueLayer(idx);
 			if (x >= 0 && y >= 0)
 			{
 				unsigned pos = m_Area;
@@ -15450,13 +14302,14 @@ void Bmphandler::Shiftbmp()
 
 unsigned long Bmphandler::ReturnWorkpixelcount(float f)
 {
+	const float* work = ReadWork();
 	unsigned long pos = 0;
 	unsigned long counter = 0;
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
 		{
-			if (m_WorkBits[pos] == f)
+			if (work[pos] == f)
 				counter++;
 			pos++;
 		}
@@ -15468,7 +14321,7 @@ unsigned long Bmphandler::ReturnTissuepixelcount(tissuelayers_size_t idx, tissue
 {
 	unsigned long pos = 0;
 	unsigned long counter = 0;
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	for (int j = 0; j < m_Height; j++)
 	{
 		for (int k = 0; k < m_Width; k++)
@@ -15481,14 +14334,14 @@ unsigned long Bmphandler::ReturnTissuepixelcount(tissuelayers_size_t idx, tissue
 	return counter;
 }
 
-bool Bmphandler::GetExtent(tissuelayers_size_t idx, tissues_size_t tissuenr, unsigned short extent[2][2])
+bool Bmphandler::GetExtent(tissuelayers_size_t idx, tissues_size_t tissuenr, unsigned extent[2][2])
 {
 	if (m_Area == 0)
 		return false;
 
 	bool found = false;
 	unsigned long pos = 0;
-	tissues_size_t* tissues = m_Tissuelayers[idx];
+	tissues_size_t* tissues = TissueLayer(idx);
 	while (!found && pos < m_Area)
 	{
 		if (tissues[pos] == tissuenr)
@@ -15518,16 +14371,16 @@ bool Bmphandler::GetExtent(tissuelayers_size_t idx, tissues_size_t tissuenr, uns
 			found = true;
 	}
 	extent[1][1] = pos / m_Width;
-	for (unsigned short i = extent[1][0] + 1; i <= extent[1][1]; i++)
+	for (unsigned i = extent[1][0] + 1; i <= extent[1][1]; i++)
 	{
 		pos = (unsigned long)(i)*m_Width;
-		for (unsigned short j = 0; j < extent[0][0]; j++, pos++)
+		for (unsigned j = 0; j < extent[0][0]; j++, pos++)
 		{
 			if (tissues[pos] == tissuenr)
 				extent[0][0] = j;
 		}
 		pos = (unsigned long)(i + 1) * m_Width - 1;
-		for (unsigned short j = m_Width - 1; j > extent[0][1]; j--, pos--)
+		for (unsigned j = m_Width - 1; j > extent[0][1]; j--, pos--)
 		{
 			if (tissues[pos] == tissuenr)
 				extent[0][1] = j;
@@ -15539,6 +14392,8 @@ bool Bmphandler::GetExtent(tissuelayers_size_t idx, tissues_size_t tissuenr, uns
 
 void Bmphandler::Swap(Bmphandler& bmph)
 {
+	Unshare();
+	bmph.Unshare();
 	Contour contourd;
 	contourd = m_Contour;
 	m_Contour = bmph.m_Contour;
@@ -15547,11 +14402,11 @@ void Bmphandler::Swap(Bmphandler& bmph)
 	marksd = m_Marks;
 	m_Marks = bmph.m_Marks;
 	bmph.m_Marks = marksd;
-	short unsigned widthd;
+	unsigned widthd;
 	widthd = m_Width;
 	m_Width = bmph.m_Width;
 	bmph.m_Width = widthd;
-	short unsigned heightd;
+	unsigned heightd;
 	heightd = m_Height;
 	m_Height = bmph.m_Height;
 	bmph.m_Height = heightd;
@@ -15559,25 +14414,28 @@ void Bmphandler::Swap(Bmphandler& bmph)
 	aread = m_Area;
 	m_Area = bmph.m_Area;
 	bmph.m_Area = aread;
-	float* bmp_bitsd;
-	bmp_bitsd = m_BmpBits;
-	m_BmpBits = bmph.m_BmpBits;
-	bmph.m_BmpBits = bmp_bitsd;
-	float* work_bitsd;
-	work_bitsd = m_WorkBits;
-	m_WorkBits = bmph.m_WorkBits;
-	bmph.m_WorkBits = work_bitsd;
-	float* help_bitsd;
-	help_bitsd = m_HelpBits;
-	m_HelpBits = bmph.m_HelpBits;
-	bmph.m_HelpBits = help_bitsd;
-	tissues_size_t* tissuesd;
-	for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
+	if (HasStorage() || bmph.HasStorage())
+	{
+		// slices are part of a contiguous volume, swap the content
+		SyncStorage();
+		bmph.SyncStorage();
+		std::swap_ranges(m_BmpBits, m_BmpBits + m_Area, bmph.m_BmpBits);
+		std::swap_ranges(WorkBits(), WorkBits() + m_Area, bmph.WorkBits());
+		for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
+		{
+			std::swap_ranges(TissueLayer(idx), TissueLayer(idx) + m_Area, bmph.TissueLayer(idx));
+		}
+	}
+	else
 	{
-		tissuesd = m_Tissuelayers[idx];
-		m_Tissuelayers[idx] = bmph.m_Tissuelayers[idx];
-		bmph.m_Tissuelayers[idx] = tissuesd;
+		std::swap(m_BmpBits, bmph.m_BmpBits);
+		std::swap(m_WorkBits, bmph.m_WorkBits);
+		for (tissuelayers_size_t idx = 0; idx < m_Tissuelayers.size(); ++idx)
+		{
+			std::swap(TissueLayer(idx), bmph.TissueLayer(idx));
+		}
 	}
+	std::swap(m_HelpBits, bmph.m_HelpBits);
 	WshedObj wshedobjd;
 	wshedobjd = m_Wshedobj;
 	m_Wshedobj = bmph.m_Wshedobj;
@@ -15602,14 +14460,6 @@ void Bmphandler::Swap(Bmphandler& bmph)
 	fextractd = m_Fextract;
 	m_Fextract = bmph.m_Fextract;
 	bmph.m_Fextract = fextractd;
-	std::list<float*> bits_stackd;
-	bits_stackd = bits_stack;
-	bits_stack = bmph.bits_stack;
-	bmph.bits_stack = bits_stackd;
-	std::list<unsigned char> mode_stackd;
-	mode_stackd = mode_stack;
-	mode_stack = bmph.mode_stack;
-	bmph.mode_stack = mode_stackd;
 	SliceProvider* sliceprovided;
 	sliceprovided = m_Sliceprovide;
 	m_Sliceprovide = bmph.m_Sliceprovide;
@@ -15647,7 +14497,8 @@ bool Bmphandler::Unwrap(float jumpratio, float range, float shift)
 	float jumpabs = jumpratio * range;
 	unsigned int pos = 0;
 	float shiftbegin = shift;
-	for (unsigned short i = 0; i < m_Height; i++)
+	float* work = WorkBits();
+	for (unsigned i = 0; i < m_Height; i++)
 	{
 		if (i != 0)
 		{
@@ -15657,24 +14508,24 @@ bool Bmphandler::Unwrap(float jumpratio, float range, float shift)
 				shiftbegin -= range;
 		}
 		shift = shiftbegin;
-		m_WorkBits[pos] = m_BmpBits[pos] + shift;
-		for (unsigned short j = 1; j < m_Width; j++)
+		work[pos] = m_BmpBits[pos] + shift;
+		for (unsigned j = 1; j < m_Width; j++)
 		{
 			if (m_BmpBits[pos] - m_BmpBits[pos + 1] > jumpabs)
 				shift += range;
 			else if (m_BmpBits[pos + 1] - m_BmpBits[pos] > jumpabs)
 				shift -= range;
 			pos++;
-			m_WorkBits[pos] = m_BmpBits[pos] + shift;
+			work[pos] = m_BmpBits[pos] + shift;
 		}
 		pos++;
 	}
 	m_Mode2 = m_Mode1;
 	for (pos = m_Width - 1; pos + m_Width < m_Area; pos += m_Width)
 	{
-		if (m_WorkBits[pos + m_Width] - m_WorkBits[pos] > jumpabs)
+		if (work[pos + m_Width] - work[pos] > jumpabs)
 			return false;
-		if (m_WorkBits[pos] - m_WorkBits[pos + m_Width] > jumpabs)
+		if (work[pos] - work[pos + m_Width] > jumpabs)
 			return false;
 	}
 	return true;
@@ -12,14 +12,18 @@
 #include "Data/Mark.h"
 #include "Data/Types.h"
 
+#include "Core/CompressedLabelSlice.h"
 #include "Core/Contour.h"
 #include "Core/FeatureExtractor.h"
+#include "Core/ImageStack.h"
 #include "Core/Pair.h"
 
 #include <list>
 #include <set>
 #include <vector>
 
+class QImage;
+
 namespace iseg {
 
 class ImageForestingTransformRegionGrowing;
@@ -116,7 +120,7 @@ public:
 #ifdef TISSUES_SIZE_TYPEDEF
 	void Copyfromtissue(tissuelayers_size_t idx, unsigned char* bits);
 #endif // TISSUES_SIZE_TYPEDEF
-	void Copyfromtissuepadded(tissuelayers_size_t idx, tissues_size_t* bits, unsigned short padding);
+	void Copyfromtissuepadded(tissuelayers_size_t idx, tissues_size_t* bits, unsigned padding);
 	void ClearBmp();
 	void ClearWork();
 	void BmpSum();
@@ -128,23 +132,70 @@ public:
 	void BmpNeg();
 	void BmpOverlay(float alpha);
 	void TransparentAdd(float* pict2);
-	void Newbmp(unsigned short width1, unsigned short height1, bool init = true);
-	void Newbmp(unsigned short width1, unsigned short height1, float* bits);
+	void Newbmp(unsigned width1, unsigned height1, bool init = true);
+	void Newbmp(unsigned width1, unsigned height1, float* bits);
 	void Freebmp();
+	/// Use externally owned memory (e.g. a VolumeStorage) for source, target and tissue layers. The current content is copied.
+	void AttachStorage(float* bmp, float* work, const std::vector<tissues_size_t*>& tissues);
+	/// Copy the data back into memory owned by this slice and release the external storage
+	void DetachStorage();
+	/// Make sure the source, target and tissue pointers refer to the attached storage again
+	void SyncStorage();
+	/// True if no pointer was replaced since the last sync, i.e. SyncStorage has nothing to do
+	bool StorageInSync() const;
+	bool HasStorage() const { return m_BmpView != nullptr; }
+	/// Compress the tissue layers, unless they are pinned, shared or part of an attached storage. Returns true if the layers are compressed.
+	/// Raw tissue pointers of this slice, which were handed out before without a pin, are invalid afterwards.
+	bool PackTissues();
+	/// Decompress the tissue layers. Any access to the tissues does this implicitly.
+	void UnpackTissues() const;
+	bool TissuesPacked() const { return !m_PackedTissues.empty(); }
+	/// Keep the tissue layers decompressed and in memory until UnpinTissues, i.e. raw tissue pointers stay valid
+	void PinTissues();
+	void UnpinTissues();
+	/// Memory used by the tissue layers in bytes
+	size_t TissuesMemoryUsage() const;
+	/// Release source, target, help and tissues. The content is restored by the caller after PageIn.
+	void PageOut();
+	/// Allocate the buffers of a paged out slice again
+	void PageIn();
+	bool IsPagedOut() const { return m_PagedOut; }
+	/// Target and help are allocated on first use and are zero until then
+	bool HasWork() const { return m_WorkBits != nullptr; }
+	bool HasHelp() const { return m_HelpBits != nullptr; }
+	/// Release the target if it is zero everywhere. Returns true if the target is not allocated afterwards.
+	bool ReleaseWorkIfZero();
+	/// The page file holds a single tissue layer, slices with additional layers stay in memory
+	bool CanPageOut() const { return m_Loaded && !m_PagedOut && !HasStorage() && !IsShared() && m_TissuePins == 0 && m_Tissuelayers.size() <= 1; }
+	/// Hand the current buffer to a snapshot, e.g. of a background save, without copying it. The slice copies the buffer
+	/// before it is modified again (see Unshare). Slices in an attached storage, or buffers already shared, return a copy instead.
+	float* ShareBmp();
+	/// Returns nullptr if the target is not allocated, i.e. zero
+	float* ShareWork();
+	tissues_size_t* ShareTissues(tissuelayers_size_t idx);
+	/// Ends sharing 'bits' with a snapshot. Returns true if the slice still uses 'bits' and keeps it, otherwise the snapshot owns 'bits'.
+	bool EndShare(const void* bits);
+	/// Copy the shared buffers, must be called before the slice is modified
+	void Unshare()
+	{
+		if (IsShared())
+			CopyShared();
+	}
+	bool IsShared() const { return m_SharedBmp != nullptr || m_SharedWork != nullptr || m_SharedTissues != nullptr; }
 	static int CheckBMPDepth(const char* filename);
 	void SetConverterFactors(int redFactor, int greenFactor, int blueFactor);
 	int LoadDIBitmap(const char* filename);
-	int LoadDIBitmap(const char* filename, Point p, unsigned short dx, unsigned short dy);
+	int LoadDIBitmap(const char* filename, Point p, unsigned dx, unsigned dy);
 	int ReloadDIBitmap(const char* filename);
 	int ReloadDIBitmap(const char* filename, Point p);
 	static int CheckPNGDepth(const char* filename);
 	int LoadPNGBitmap(const char* filename);
-	bool LoadArray(float* bits, unsigned short w1, unsigned short h1);
-	bool LoadArray(float* bits, unsigned short w1, unsigned short h1, Point p, unsigned short dx, unsigned short dy);
+	bool LoadArray(float* bits, unsigned w1, unsigned h1);
+	bool LoadArray(float* bits, unsigned w1, unsigned h1, Point p, unsigned dx, unsigned dy);
 	bool ReloadArray(float* bits);
-	bool ReloadArray(float* bits, unsigned short w1, unsigned short h1, Point p);
+	bool ReloadArray(float* bits, unsigned w1, unsigned h1, Point p);
 	bool LoadDICOM(const char* filename);
-	bool LoadDICOM(const char* filename, Point p, unsigned short dx, unsigned short dy);
+	bool LoadDICOM(const char* filename, Point p, unsigned dx, unsigned dy);
 	bool ReloadDICOM(const char* filename);
 	bool ReloadDICOM(const char* filename, Point p);
 	FILE* SaveProj(FILE* fp, bool inclpics = true);
@@ -154,21 +205,12 @@ public:
 	int SaveDIBitmap(const char* filename);
 	int SaveWorkBitmap(const char* filename);
 	int SaveTissueBitmap(tissuelayers_size_t idx, const char* filename);
-	int ReadRaw(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned short slicenr);
-	int ReadRaw(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned short slicenr, Point p, unsigned short dx, unsigned short dy);
-	int ReloadRaw(const char* filename, unsigned bitdepth, unsigned slicenr);
-	int ReloadRaw(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned slicenr, Point p);
-	int ReadRawFloat(const char* filename, short unsigned w, short unsigned h, unsigned short slicenr);
-	int ReadRawFloat(const char* filename, short unsigned w, short unsigned h, unsigned short slicenr, Point p, unsigned short dx, unsigned short dy);
-	int ReloadRawFloat(const char* filename, unsigned slicenr);
-	static float* ReadRawFloat(const char* filename, unsigned slicenr, unsigned int area);
-	int ReloadRawFloat(const char* filename, short unsigned w, short unsigned h, unsigned slicenr, Point p);
 	int ReloadRawTissues(const char* filename, unsigned bitdepth, unsigned slicenr);
-	int ReloadRawTissues(const char* filename, short unsigned w, short unsigned h, unsigned bitdepth, unsigned slicenr, Point p);
+	int ReloadRawTissues(const char* filename, unsigned w, unsigned h, unsigned bitdepth, unsigned slicenr, Point p);
 	int SaveBmpRaw(const char* filename);
 	int SaveWorkRaw(const char* filename);
 	int SaveTissueRaw(tissuelayers_size_t idx, const char* filename);
-	int ReadAvw(const char* filename, short unsigned i);
+	int ReadAvw(const char* filename, unsigned i);
 	void Work2bmp();
 	void Bmp2work();
 	void SwapBmpwork();
@@ -176,24 +218,24 @@ public:
 	void SwapWorkhelp();
 	unsigned int MakeHistogram(bool includeoutofrange);
 	unsigned int MakeHistogram(float* mask, float f, bool includeoutofrange);
-	unsigned int MakeHistogram(Point p, unsigned short dx, unsigned short dy, bool includeoutofrange);
+	unsigned int MakeHistogram(Point p, unsigned dx, unsigned dy, bool includeoutofrange);
 	unsigned int* ReturnHistogram();
 	float* FindModal(unsigned int thresh1, float thresh2);
 	void PrintInfo() const;
 	void PrintHistogram();
-	unsigned int ReturnArea() const;
+	size_t ReturnArea() const;
 	unsigned int ReturnWidth() const;
 	unsigned int ReturnHeight() const;
 	void Threshold(float* thresholds);
-	void Threshold(float* thresholds, Point p, unsigned short dx, unsigned short dy);
-	void Convolute(float* mask, unsigned short direction); // x: 0, y: 1, xy: 2
+	void Threshold(float* thresholds, Point p, unsigned dx, unsigned dy);
+	void Convolute(float* mask, unsigned direction); // x: 0, y: 1, xy: 2
 	void ScaleColors(Pair p);
 	void CropColors();
 	void GetRange(Pair* pp);
 	void GetRangetissue(tissuelayers_size_t idx, tissues_size_t* pp);
 	void GetBmprange(Pair* pp);
 	void Gaussian(float sigma);
-	void Average(unsigned short n);
+	void Average(unsigned n);
 	void Laplacian();
 	void Laplacian1();
 	void Sobel();
@@ -201,7 +243,7 @@ public:
 	void Sobelxy(float** sobelx, float** sobely);
 	void MedianInterquartile(bool median);
 	void MedianInterquartile(float* median, float* iq);
-	void Sigmafilter(float sigma, unsigned short nx, unsigned short ny);
+	void Sigmafilter(float sigma, unsigned nx, unsigned ny);
 	void Compacthist();
 	void MomentLine();
 	void GaussLine(float sigma);
@@ -222,7 +264,7 @@ public:
 	void ThresholdedGrowing(Point p, float threshfactor_low, float threshfactor_high, bool connectivity, float set_to, Pair* tp);
 	void ThresholdedGrowing(float thresh_low, float thresh_high, bool connectivity, float* mask, float f, float set_to);
 	void DistanceMap(bool connectivity);
-	void DistanceMap(bool connectivity, float f, short unsigned levlset); //0:outside,1:inside,2:both
+	void DistanceMap(bool connectivity, float f, unsigned levlset); //0:outside,1:inside,2:both
 	void DeadReckoning();
 	unsigned* DeadReckoning(float f);
 	unsigned* DeadReckoningSquared(float f);
@@ -245,16 +287,16 @@ public:
 	void AddMark(Point p, unsigned label, std::string str = "");
 	bool RemoveMark(Point p, unsigned radius);
 	void ClearMarks();
-	void NMoment(short unsigned n, short unsigned p);
-	void NMomentSigma(short unsigned n, short unsigned p, float sigma);
+	void NMoment(unsigned n, unsigned p);
+	void NMomentSigma(unsigned n, unsigned p, float sigma);
 	void ZeroCrossings(bool connectivity);
 	void ZeroCrossings(float thresh, bool connectivity);
 	void LaplacianZero(float sigma, float thresh, bool connectivity);
 	void ToBmpgrey(float* p_bits) const;
 	void ConnectedComponents(bool connectivity);
 	void ConnectedComponents(bool connectivity, std::set<float>& components);
-	void FillGaps(short unsigned n, bool connectivity);
-	void FillGapstissue(tissuelayers_size_t idx, short unsigned n, bool connectivity);
+	void FillGaps(unsigned n, bool connectivity);
+	void FillGapstissue(tissuelayers_size_t idx, unsigned n, bool connectivity);
 	void Wshed2work(unsigned* Y);
 	void Labels2work(unsigned* Y, unsigned lnr);
 	//		change_island, remove_island s. 3D-slicer
@@ -284,9 +326,9 @@ public:
 	void Classify(short nrclasses, short dim, float** bits, float* weights, float* centers, float maxdist);
 	void Em(short nrtissues, short dim, float** bits, float* weights, unsigned int iternr, unsigned int converge);
 	void Kmeans(short nrtissues, short dim, float** bits, float* weights, unsigned int iternr, unsigned int converge);
-	void KmeansMhd(short nrtissues, short dim, std::vector<std::string> mhdfiles, unsigned short slicenr, float* weights, unsigned int iternr, unsigned int converge);
-	void KmeansPng(short nrtissues, short dim, std::vector<std::string> pngfiles, std::vector<int> exctractChannel, unsigned short slicenr, float* weights, unsigned int iternr, unsigned int converge, const std::string initCentersFile = "");
-	void GammaMhd(short nrtissues, short dim, std::vector<std::string> mhdfiles, unsigned short slicenr, float* weights, float** centers, float* tol_f, float* tol_d, Pair pixelsize);
+	void KmeansMhd(short nrtissues, short dim, std::vector<std::string> mhdfiles, unsigned slicenr, float* weights, unsigned int iternr, unsigned int converge);
+	void KmeansPng(short nrtissues, short dim, std::vector<std::string> pngfiles, std::vector<int> exctractChannel, unsigned slicenr, float* weights, unsigned int iternr, unsigned int converge, const std::string initCentersFile = "");
+	void GammaMhd(short nrtissues, short dim, std::vector<std::string> mhdfiles, unsigned slicenr, float* weights, float** centers, float* tol_f, float* tol_d, Pair pixelsize);
 	void Cannylevelset(float* initlev, float f, float sigma, float thresh_low, float thresh_high, float epsilon, float stepsize, unsigned nrsteps, unsigned reinitfreq);
 	void Threshlevelset(float thresh_low, float thresh_high, float epsilon, float stepsize, unsigned nrsteps, unsigned reinitfreq);
 	float ExtractFeature(Point p1, Point p2);
@@ -297,10 +339,12 @@ public:
 	unsigned PushstackWork();
 	unsigned PushstackHelp();
 	unsigned PushstackTissue(tissuelayers_size_t idx, tissues_size_t tissuenr);
+	/// Binary image (255 for tissuenr, 0 otherwise) as pushed by PushstackTissue
+	void TissueMask(tissuelayers_size_t idx, tissues_size_t tissuenr, float* bits) const;
 	bool Savestack(unsigned i, const char* filename);
 	unsigned Loadstack(const char* filename);
 	void Removestack(unsigned i);
-	float* Getstack(unsigned i, unsigned char& mode);
+	bool Getstack(unsigned i, float* bits, unsigned char& mode) const;
 	void GetstackBmp(unsigned i);
 	void GetstackWork(unsigned i);
 	void GetstackHelp(unsigned i);
@@ -309,6 +353,8 @@ public:
 	void PopstackWork();
 	void PopstackHelp();
 	void ClearStack();
+	/// Image stack shared by all slices
+	static ImageStack& Stack() { return image_stack; }
 	bool Isloaded() const;
 	void CorrectOutline(float f, std::vector<Point>* newline);
 	void CorrectOutlinetissue(tissuelayers_size_t idx, tissues_size_t f1, std::vector<Point>* newline);
@@ -350,30 +396,25 @@ public:
 	void GroupTissues(tissuelayers_size_t idx, std::vector<tissues_size_t>& olds, std::vector<tissues_size_t>& news);
 	unsigned char ReturnMode(bool bmporwork) const;
 	void SetMode(unsigned char mode, bool bmporwork);
-	bool PrintAmasciiSlice(tissuelayers_size_t idx, std::ofstream& streamname);
-	bool PrintVtkasciiSlice(tissuelayers_size_t idx, std::ofstream& streamname);
-	bool PrintVtkbinarySlice(tissuelayers_size_t idx, std::ofstream& streamname);
 	void Shifttissue();
 	void Shiftbmp();
 	unsigned long ReturnWorkpixelcount(float f);
 	unsigned long ReturnTissuepixelcount(tissuelayers_size_t idx, tissues_size_t c);
 	void Swap(Bmphandler& bmph);
-	bool GetExtent(tissuelayers_size_t idx, tissues_size_t tissuenr, unsigned short extent[2][2]);
+	bool GetExtent(tissuelayers_size_t idx, tissues_size_t tissuenr, unsigned extent[2][2]);
 	bool Unwrap(float jumpratio, float range = 0, float shift = 0);
 
 	int ConvertImageTo8BitBMP(const char* filename, unsigned char*& bits_tmp) const;
-	int ConvertPNGImageTo8BitBMP(const char* filename, unsigned char*& bits_tmp) const;
+	int ConvertPNGImageTo8BitBMP(const QImage& image, unsigned char* bits_tmp) const;
 	void SetRGBtoGrayScaleFactors(double newRedFactor, double newGreenFactor, double newBlueFactor);
 	void Mergetissue(tissues_size_t tissuetype, tissuelayers_size_t idx);
 
 protected:
-	static std::list<unsigned> stackindex;
-	static unsigned stackcounter;
 	Contour m_Contour;
 	std::vector<Mark> m_Marks;
-	short unsigned m_Width;
-	short unsigned m_Height;
-	unsigned int m_Area;
+	unsigned m_Width;
+	unsigned m_Height;
+	size_t m_Area;
 	inline unsigned int Pt2coord(Point p) const;
 	float* MakeGaussfilter(float sigma, int n);
 	float* MakeLaplacianfilter();
@@ -385,27 +426,60 @@ protected:
 	void Bucketsort(std::vector<unsigned int>* sorted, float* p_bits) const;
 	void SetMarker(unsigned* wshed);
 	float BaseConnection(float c, std::vector<float>* maps);
-	void HystereticGrowth(float* pict, std::vector<int>* s, unsigned short w, unsigned short h, bool connectivity, float set_to);
-	void HystereticGrowth(float* pict, std::vector<int>* s, unsigned short w, unsigned short h, bool connectivity, float set_to, int nr);
+	void HystereticGrowth(float* pict, std::vector<int>* s, unsigned w, unsigned h, bool connectivity, float set_to);
+	void HystereticGrowth(float* pict, std::vector<int>* s, unsigned w, unsigned h, bool connectivity, float set_to, int nr);
 	template<typename T, typename F>
 	void Brush(T* data, T f, Point p, int radius, bool draw, T f1, F);
 	template<typename T, typename F>
 	void Brush(T* data, T f, Point p, float radius, float dx, float dy, bool draw, T f1, F);
 
 private:
+	void FreeBits();
+	void ReleaseBits();
+	void Recycle(float* bits);
+	void FreeTissues(tissues_size_t* bits);
+	void CopyShared();
+	bool IsStorage(const float* bits) const { return bits != nullptr && (bits == m_BmpView || bits == m_WorkView); }
+	bool IsStorage(const tissues_size_t* bits) const;
+	tissues_size_t*& TissueLayer(tissuelayers_size_t idx) const
+	{
+		if (!m_PackedTissues.empty())
+			UnpackTissues();
+		return m_Tissuelayers[idx];
+	}
+	float*& WorkBits()
+	{
+		if (m_WorkBits == nullptr)
+			m_WorkBits = ZeroedBits();
+		return m_WorkBits;
+	}
+	float*& HelpBits()
+	{
+		if (m_HelpBits == nullptr)
+			m_HelpBits = ZeroedBits();
+		return m_HelpBits;
+	}
+	const float* ReadWork() const { return m_WorkBits ? m_WorkBits : ZeroSlice(); }
+	float* ZeroedBits();
+	/// Read-only zero slice of size m_Area, shared by all slices of the same size
+	const float* ZeroSlice() const;
+
 	unsigned int m_Histogram[256];
-	float* m_BmpBits;
-	float* m_WorkBits;
-	float* m_HelpBits;
-	std::vector<tissues_size_t*> m_Tissuelayers;
+	float* m_BmpBits = nullptr;
+	float* m_WorkBits = nullptr;
+	float* m_HelpBits = nullptr;
+	// decompressing is transparent to the caller, therefore the tissue layers are mutable
+	mutable std::vector<tissues_size_t*> m_Tissuelayers;
+	mutable std::vector<CompressedLabelSlice> m_PackedTissues;
+	unsigned m_TissuePins = 0;
+	bool m_PagedOut = false;
 	WshedObj m_Wshedobj;
 	bool m_BmpIsGrey;
 	bool m_WorkIsGrey;
 	bool m_Loaded;
 	bool m_Ownsliceprovider;
 	FeatureExtractor m_Fextract;
-	static std::list<float*> bits_stack;
-	static std::list<unsigned char> mode_stack;
+	static ImageStack image_stack;
 	SliceProvider* m_Sliceprovide;
 	SliceProviderInstaller* m_SliceprovideInstaller;
 	std::vector<std::vector<Mark>> m_Vvm;
@@ -413,6 +487,13 @@ private:
 	std::vector<std::vector<Point>> m_Limits;
 	unsigned char m_Mode1;
 	unsigned char m_Mode2;
+	float* m_BmpView = nullptr;
+	float* m_WorkView = nullptr;
+	std::vector<tissues_size_t*> m_TissueViews;
+	// buffers which are also referenced by an undo snapshot
+	float* m_SharedBmp = nullptr;
+	float* m_SharedWork = nullptr;
+	tissues_size_t* m_SharedTissues = nullptr;
 
 	double m_RedFactor;
 	double m_GreenFactor;
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../SlicesHandler.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace iseg {
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(SlicesHandlerTissues_suite);
+
+// tools hold the tissue pointers across events, e.g. while the slices are compressed after a slice change
+BOOST_AUTO_TEST_CASE(PinnedTissuesAreNotPacked)
+{
+	unsigned const width = 8, height = 6, nrslices = 4;
+	size_t const area = static_cast<size_t>(width) * height;
+
+	SlicesHandler handler;
+	handler.Newbmp(width, height, nrslices);
+	handler.SetCompressedTissues(true);
+
+	{
+		TissuesPin pin(&handler);
+		auto tissues = handler.TissueSlices(0);
+
+		handler.PackTissues();
+		for (unsigned k = 0; k < nrslices; ++k)
+		{
+			std::fill(tissues[k], tissues[k] + area, static_cast<tissues_size_t>(k + 1));
+		}
+		handler.PackTissues();
+
+		BOOST_CHECK(handler.TissueSlices(0) == tissues);
+	}
+
+	// without a pin the slices are compressed again, the labels are kept
+	handler.PackTissues();
+	auto tissues = handler.TissueSlices(0);
+	for (unsigned k = 0; k < nrslices; ++k)
+	{
+		BOOST_CHECK(std::all_of(tissues[k], tissues[k] + area, [k](tissues_size_t v) { return v == k + 1; }));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg
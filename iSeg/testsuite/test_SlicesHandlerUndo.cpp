@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2021 The Foundation for Research on Information Technologies in Society (IT'IS).
+ *
+ * This file is part of iSEG
+ * (see https://github.com/ITISFoundation/osparc-iseg).
+ *
+ * This software is released under the MIT License.
+ *  https://opensource.org/licenses/MIT
+ */
+#include <boost/test/unit_test.hpp>
+
+#include "../SlicesHandler.h"
+
+#include "Data/DataSelection.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace iseg {
+
+BOOST_AUTO_TEST_SUITE(iSeg_suite);
+BOOST_AUTO_TEST_SUITE(SlicesHandlerUndo_suite);
+
+// 3D tools fetch the slice pointers before the undo step starts and write through them
+BOOST_AUTO_TEST_CASE(PointersFetchedBeforeStartUndo)
+{
+	unsigned const width = 8, height = 6, nrslices = 4;
+	size_t const area = static_cast<size_t>(width) * height;
+
+	SlicesHandler handler;
+	handler.Newbmp(width, height, nrslices);
+
+	auto source = handler.SourceSlices();
+	auto target = handler.TargetSlices();
+	for (unsigned k = 0; k < nrslices; ++k)
+	{
+		std::fill(source[k], source[k] + area, 1.f + k);
+		std::fill(target[k], target[k] + area, 10.f + k);
+	}
+
+	DataSelection data_selection;
+	data_selection.allSlices = true;
+	data_selection.bmp = true;
+	data_selection.work = true;
+	BOOST_REQUIRE(handler.StartUndoall(data_selection));
+	for (unsigned k = 0; k < nrslices; ++k)
+	{
+		std::fill(source[k], source[k] + area, -1.f);
+		std::fill(target[k], target[k] + area, -2.f);
+	}
+	handler.EndUndo();
+
+	BOOST_REQUIRE(handler.Undo().DataSelected());
+	auto undone_source = handler.SourceSlices();
+	auto undone_target = handler.TargetSlices();
+	for (unsigned k = 0; k < nrslices; ++k)
+	{
+		BOOST_CHECK(std::all_of(undone_source[k], undone_source[k] + area, [k](float v) { return v == 1.f + k; }));
+		BOOST_CHECK(std::all_of(undone_target[k], undone_target[k] + area, [k](float v) { return v == 10.f + k; }));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE_END();
+
+} // namespace iseg